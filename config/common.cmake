@@ -80,4 +80,10 @@ set(CMAKE_AUTOMOC ON)
 set(CMAKE_AUTOUIC ON)
 
 # Use current build dir as well for includes
-set(CMAKE_INCLUDE_CURRENT_DIR ON)
\ No newline at end of file
+set(CMAKE_INCLUDE_CURRENT_DIR ON)
+
+# Optionally optimize for the build machine's CPU (enables SSE/AVX auto-vectorization)
+option(GRAIPE_NATIVE_ARCH "Optimize for the native CPU architecture" OFF)
+if(GRAIPE_NATIVE_ARCH AND (CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang"))
+    add_compile_options(-march=native)
+endif()
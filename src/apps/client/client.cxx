@@ -196,9 +196,9 @@ void Client::sendModel(Model* model)
     QByteArray model_data;
     QBuffer out_buf(&model_data);
     
-    //Always use compressed transfer
-    QIOCompressor* compressor = new QIOCompressor(&out_buf);
-    compressor->setStreamFormat(QIOCompressor::GzipFormat);
+    //Always use compressed transfer, favor speed over ratio
+    QIOCompressor* compressor = new QIOCompressor(&out_buf, 1);
+    compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
     if (!compressor->open(QIODevice::WriteOnly))
     {
@@ -270,9 +270,9 @@ void Client::sendAlgorithm(Algorithm* alg)
     QByteArray alg_data;
     QBuffer out_buf(&alg_data);
     
-    //Always use compressed transfer
-    QIOCompressor* compressor = new QIOCompressor(&out_buf);
-    compressor->setStreamFormat(QIOCompressor::GzipFormat);
+    //Always use compressed transfer, favor speed over ratio
+    QIOCompressor* compressor = new QIOCompressor(&out_buf, 1);
+    compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
     if (!compressor->open(QIODevice::WriteOnly))
     {
@@ -340,7 +340,7 @@ void Client::readModel(int bytesToRead)
         
         //Always use compressed transfer
         QIOCompressor* compressor = new QIOCompressor(&buf);
-        compressor->setStreamFormat(QIOCompressor::GzipFormat);
+        compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
         if (!compressor->open(QIODevice::ReadOnly))
         {
@@ -67,7 +67,9 @@ MainWindow::MainWindow(QWidget* parent, const char* name, Qt::WindowFlags f) :
 	m_status_window(new StatusWindow),
     m_lblMemoryUsage(new QLabel("(Memory: 0 MB, max: 0 MB)")),
     m_recentFileCount(10),
-    m_workspace(new Workspace)
+    m_workspace(new Workspace),
+    m_async_impex(new AsyncImpex(m_workspace, this)),
+    m_btnCancelImpex(new QPushButton("Cancel I/O"))
 {	
     m_ui.setupUi(this);
     
@@ -213,6 +215,12 @@ MainWindow::MainWindow(QWidget* parent, const char* name, Qt::WindowFlags f) :
     this->statusBar()->addPermanentWidget(m_lblMemoryUsage);
     updateMemoryUsage();
     
+    //Background saving and loading
+    this->statusBar()->addPermanentWidget(m_btnCancelImpex);
+    m_btnCancelImpex->setVisible(false);
+    connect(m_btnCancelImpex, SIGNAL(clicked()), this, SLOT(cancelImpexTasks()));
+    connect(m_async_impex, SIGNAL(taskFinished(AsyncImpexTask*)), this, SLOT(impexTaskFinished(AsyncImpexTask*)));
+    
 	setWindowTitle(tr(name));
     setCentralWidget(m_view);
 	
@@ -238,6 +246,9 @@ MainWindow::~MainWindow()
     settings.setValue("view_m31", vc_t.m31());    settings.setValue("view_m32", vc_t.m32());    settings.setValue("view_m33", vc_t.m33());
 
 
+    //Finish all running saves and loads before the workspace is saved or deleted
+    m_async_impex->waitForDone();
+    
     if( QMessageBox::question(this,
                               "Save workspace?",
                              "Do you want to save the current workspace for the next start of GRAIPE?",
@@ -256,6 +267,9 @@ MainWindow::~MainWindow()
 
 void MainWindow::reset()
 {
+    if(m_async_impex->isRunning())
+        throw std::runtime_error("Models are being saved or loaded, reset is not possible");
+    
     //If at least one model is locked, give up:
     bool locked=false;
     for(int i=0;  i < m_ui.listModels->count(); ++i)
@@ -327,6 +341,25 @@ void MainWindow::loadRecentModel()
     }
 }
 
+void MainWindow::renderScene(QPainter* painter)
+{
+    QList<QGraphicsItem*> items = m_scene->items();
+    QVector<QGraphicsItem::CacheMode> cache_modes;
+    
+    for(QGraphicsItem* item : items)
+    {
+        cache_modes.push_back(item->cacheMode());
+        item->setCacheMode(QGraphicsItem::NoCache);
+    }
+    
+    m_scene->render(painter);
+    
+    for(int i=0; i<items.size(); ++i)
+    {
+        items[i]->setCacheMode(cache_modes[i]);
+    }
+}
+
 void MainWindow::print()
 {
     if ( !m_printer )
@@ -339,7 +372,7 @@ void MainWindow::print()
 	{
 		QPainter painter(m_printer);
 		painter.setRenderHint(QPainter::Antialiasing);
-		m_scene->render(&painter);
+		renderScene(&painter);
     }
 }
 
@@ -360,7 +393,7 @@ void MainWindow::saveAsPDF()
 			
 			QPainter painter(&printer);
 			painter.setRenderHint(QPainter::Antialiasing);
-			m_scene->render(&painter);
+			renderScene(&painter);
 		}
 		catch (std::exception & e)
 		{
@@ -388,7 +421,7 @@ void MainWindow::saveAsSVG()
 			QPainter painter;
 			painter.begin(&generator);
 			painter.setRenderHint(QPainter::Antialiasing);
-			m_scene->render(&painter);
+			renderScene(&painter);
 			painter.end();
 		}
 		catch (std::exception & e)
@@ -478,6 +511,12 @@ void MainWindow::runAlgorithm(int index)
 		//AND are available!
 		if( parameter_selection.result()!=0 )
 		{
+            //Load lazily restored models here, since the algorithm runs in another thread
+            for(Model* m : alg->parameters()->needsModels())
+            {
+                m->loadContent();
+            }
+            
 			QThread *thr = new QThread;
 			alg->moveToThread(thr);
 			
@@ -694,7 +733,23 @@ void MainWindow::showCurrentModel()
             //if index found: add view/controller
             if(vc_index != -1)
             {
-                ViewController* new_vc = vc_possibilities[vc_index].viewController_fptr(model_item->model());
+                Model* model = model_item->model();
+                
+                //The ViewController needs the model's content, which is loaded in background before
+                if(!model->isContentLoaded())
+                {
+                    if(loadContent(model))
+                    {
+                        m_pendingViewControllers.push_back(std::make_pair(model, vc_possibilities[vc_index]));
+                    }
+                    else
+                    {
+                        QMessageBox::about(this, tr("Error"), QString("The content of %1 could not be loaded!").arg(model->name()));
+                    }
+                    return;
+                }
+                
+                ViewController* new_vc = vc_possibilities[vc_index].viewController_fptr(model);
                 
                 //Always show and make current for new ViewControllers
                 new_vc->setVisible(true);
@@ -724,16 +779,10 @@ void MainWindow::saveCurrentModel()
 			
 			if(model_possibilities.size()==1)
 			{
-				bool compress =  (filename.right(2) == "gz");
-				
-				if(Impex::save(model, filename, compress))
-                {
-                    addToRecentActionList(filename);
-                }
-                else
-				{
-					QMessageBox::about(this, tr("Error"),filename + "\n was not saved!\n");
-				}
+				AsyncImpexTask* task = m_async_impex->saveModel(model, filename);
+                
+                connect(task, SIGNAL(progress(qint64)), this, SLOT(impexTaskProgress(qint64)));
+                m_btnCancelImpex->setVisible(true);
 			}
 		}
 	}
@@ -855,7 +904,16 @@ void MainWindow::saveWorkspace()
     
     if(!xmlFilename.isNull())
     {
-        saveWorkspace(xmlFilename);
+        AsyncImpexTask* task = m_async_impex->saveWorkspace(xmlFilename);
+        
+        if(task == NULL)
+        {
+            QMessageBox::about(this, tr("Error"), QString("Another workspace is currently being saved!\n"));
+            return;
+        }
+        
+        connect(task, SIGNAL(progress(qint64)), this, SLOT(impexTaskProgress(qint64)));
+        m_btnCancelImpex->setVisible(true);
     }
 }
 
@@ -870,6 +928,8 @@ void MainWindow::saveWorkspace(const QString& xmlFilename)
             QXmlStreamWriter xmlWriter(device);
             xmlWriter.setAutoFormatting(true);
             
+            //Store the models' contents in separate files for lazy restoring
+            m_workspace->setContentDirectory(Workspace::contentDirectoryForFile(xmlFilename));
             m_workspace->serialize(xmlWriter);
             
             device->close();
@@ -945,6 +1005,8 @@ void MainWindow::restoreWorkspace(const QString& xmlFilename)
         {
             QXmlStreamReader xmlReader(device);
             
+            //Only the models' headers are restored here, contents are loaded on demand
+            m_workspace->setContentDirectory(Workspace::contentDirectoryForFile(xmlFilename));
             m_workspace->deserialize(xmlReader);
             
             for(Model* model : m_workspace->models)
@@ -955,6 +1017,12 @@ void MainWindow::restoreWorkspace(const QString& xmlFilename)
             {
                 addViewControllerItemToSceneAndList(vc);
             }
+            
+            //The other ViewControllers are shown, after their models' contents have been loaded
+            for(const std::pair<Model*, QByteArray>& pending : m_workspace->pendingViewControllers)
+            {
+                loadContent(pending.first);
+            }
 
             device->close();
         }
@@ -1020,6 +1088,88 @@ void MainWindow::algorithmFinished()
     delete item;
 }
 
+void MainWindow::impexTaskProgress(qint64 bytes)
+{
+	AsyncImpexTask* task = static_cast<AsyncImpexTask*> (sender());
+    
+    const bool load = (task->type() == AsyncImpexTask::LoadModel || task->type() == AsyncImpexTask::LoadContent);
+    
+    QString action = load ? "Loading" : "Saving";
+    
+    updateStatusText(QString("%1 %2: %3 MB").arg(action).arg(task->filename()).arg(bytes>>20));
+}
+
+void MainWindow::impexTaskFinished(AsyncImpexTask* task)
+{
+    m_btnCancelImpex->setVisible(m_async_impex->isRunning());
+    
+    const bool load = (task->type() == AsyncImpexTask::LoadModel || task->type() == AsyncImpexTask::LoadContent);
+    
+    //New ViewControllers, which have been waiting for the content
+    std::vector<ViewControllerFactoryItem> pending_items;
+    
+    if(task->type() == AsyncImpexTask::LoadContent)
+    {
+        std::vector<std::pair<Model*, ViewControllerFactoryItem> > pending;
+        pending.swap(m_pendingViewControllers);
+        
+        for(const std::pair<Model*, ViewControllerFactoryItem>& p : pending)
+        {
+            if(p.first == task->model())
+            {
+                pending_items.push_back(p.second);
+            }
+            else
+            {
+                m_pendingViewControllers.push_back(p);
+            }
+        }
+    }
+    
+    if(task->successful())
+    {
+        if(task->type() == AsyncImpexTask::LoadModel)
+        {
+            addModelItemToList(task->model());
+        }
+        if(task->type() == AsyncImpexTask::LoadContent)
+        {
+            for(ViewController* vc : m_workspace->restorePendingViewControllers(task->model()))
+            {
+                addViewControllerItemToSceneAndList(vc);
+            }
+            for(const ViewControllerFactoryItem& item : pending_items)
+            {
+                ViewController* new_vc = item.viewController_fptr(task->model());
+                
+                new_vc->setVisible(true);
+                m_workspace->setCurrentViewController(new_vc);
+                addViewControllerItemToSceneAndList(new_vc);
+            }
+        }
+        if(task->type() == AsyncImpexTask::SaveModel || task->type() == AsyncImpexTask::LoadModel)
+        {
+            addToRecentActionList(task->filename());
+        }
+        updateStatusText(task->filename() + QString(" was %1.").arg(load ? "loaded" : "saved"));
+    }
+    else if(task->cancelled())
+    {
+        updateStatusText(task->filename() + " was cancelled.");
+    }
+    else
+    {
+        QMessageBox::about(this, tr("Error"), task->filename() + QString("\n was not %1!\n").arg(load ? "loaded" : "saved"));
+    }
+    
+    refreshModelNames();
+}
+
+void MainWindow::cancelImpexTasks()
+{
+    m_async_impex->cancelAll();
+}
+
 void MainWindow::updateStatusText(QString str)
 {
 	this->statusBar()->showMessage(str);
@@ -1091,12 +1241,12 @@ void MainWindow::loadModel(const QString& filename)
         throw std::runtime_error("Loading model from " + filename.toStdString() + " failed. File does not exists");
     }
     
-	Model* model = m_workspace->loadModel(filename);
+	AsyncImpexTask* task = m_async_impex->loadModel(filename);
     
-    if(model != NULL)
+    if(task != NULL)
     {
-        addModelItemToList(model);
-        addToRecentActionList(filename);
+        connect(task, SIGNAL(progress(qint64)), this, SLOT(impexTaskProgress(qint64)));
+        m_btnCancelImpex->setVisible(true);
     }
     else
     {
@@ -1104,6 +1254,19 @@ void MainWindow::loadModel(const QString& filename)
     }
 }
 
+bool MainWindow::loadContent(Model* model)
+{
+    AsyncImpexTask* task = m_async_impex->loadContent(model);
+    
+    if(task != NULL)
+    {
+        //Running tasks are returned again, connect them only once
+        connect(task, SIGNAL(progress(qint64)), this, SLOT(impexTaskProgress(qint64)), Qt::UniqueConnection);
+        m_btnCancelImpex->setVisible(true);
+    }
+    return task != NULL;
+}
+
 void MainWindow::initializeFactories()
 {
     QString status;
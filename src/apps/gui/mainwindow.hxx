@@ -47,6 +47,7 @@
 #include <QPrinter>
 #include <QList>
 #include <QMenu>
+#include <QPushButton>
 #include <QString>
 #include <QScrollBar>
 
@@ -216,11 +217,13 @@ protected slots:
     
     /**
      * This slot is called to save the complete workspace as a folder to the file system.
+     * The workspace is saved in the background.
      */
     void saveWorkspace();
     
     /**
      * This slot is called to save the complete workspace as a folder to the file system.
+     * In contrast to saveWorkspace(), this call blocks until the workspace is saved.
      *
      * \param dirname The dirname of the Workspace serialization.
      */
@@ -276,6 +279,25 @@ public slots:
      */
     void algorithmFinished();
     
+    /**
+     * This slot is called from a running import/export task to report its progress.
+     *
+     * \param bytes The count of bytes, which have been processed so far.
+     */
+    void impexTaskProgress(qint64 bytes);
+    
+    /**
+     * This slot is called, when an import/export task has been finished.
+     *
+     * \param task The finished task.
+     */
+    void impexTaskFinished(AsyncImpexTask* task);
+    
+    /**
+     * This slot cancels all running import/export tasks.
+     */
+    void cancelImpexTasks();
+    
     /**
      * This slot is called, whenever the text in the status bar needs to be updated.
      *
@@ -296,6 +318,15 @@ protected:
      */
     void updateMemoryUsage();
     
+    /**
+     * Renders the complete scene onto a painter (e.g. for printing or exporting).
+     * The pixmap caches of the items are bypassed for the rendering, to keep
+     * vector-based outputs free of rasterized items.
+     *
+     * \param painter The painter, which is used for rendering.
+     */
+    void renderScene(QPainter* painter);
+    
     /**
      * Updates the recently used models list from GRAIPE settings file.
      */
@@ -309,11 +340,21 @@ protected:
     void addToRecentActionList(const QString& filename);
     
     /**
-     * Load a Model, given by its filename, from the file system.
+     * Load a Model, given by its filename, from the file system. The Model is
+     * loaded in the background and added to the list of Models, when finished.
      * 
      * \param filename The filename of the model.
      */
     void loadModel(const QString& filename);
+    
+    /**
+     * Loads the content of a lazily restored Model in the background. When finished,
+     * the ViewControllers, which are waiting for the content, are created.
+     *
+     * \param model The Model.
+     * \return True, if the content is being loaded.
+     */
+    bool loadContent(Model* model);
 
     /**
      * Uses the graipe::core function to find and load all modules into the global factories.
@@ -421,6 +462,15 @@ private:
     
     /** The currently used workspace **/
     Workspace* m_workspace;
+    
+    /** The service for background saving and loading **/
+    AsyncImpex* m_async_impex;
+    
+    /** Button for the cancellation of running import/export tasks **/
+    QPushButton* m_btnCancelImpex;
+    
+    /** New ViewControllers, which are created after the content of their Model has been loaded **/
+    std::vector<std::pair<Model*, ViewControllerFactoryItem> > m_pendingViewControllers;
 };
 
 /**
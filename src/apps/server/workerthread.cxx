@@ -202,7 +202,7 @@ void WorkerThread::readModel()
         
         //Always use compressed transfer
         QIOCompressor* in_compressor = new QIOCompressor(&in_buf);
-        in_compressor->setStreamFormat(QIOCompressor::GzipFormat);
+        in_compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
         if (!in_compressor->open(QIODevice::ReadOnly))
         {
@@ -252,7 +252,7 @@ void WorkerThread::readAndRunAlgorithm()
         
         //Always use compressed transfer
         QIOCompressor* in_compressor = new QIOCompressor(&in_buf);
-        in_compressor->setStreamFormat(QIOCompressor::GzipFormat);
+        in_compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
         if (!in_compressor->open(QIODevice::ReadOnly))
         {
@@ -279,9 +279,9 @@ void WorkerThread::readAndRunAlgorithm()
             QByteArray out_model_data;
             QBuffer out_buf(&out_model_data);
             
-            //Always use compressed transfer
-            QIOCompressor* out_compressor = new QIOCompressor(&out_buf);
-            out_compressor->setStreamFormat(QIOCompressor::GzipFormat);
+            //Always use compressed transfer, favor speed over ratio
+            QIOCompressor* out_compressor = new QIOCompressor(&out_buf, 1);
+            out_compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
             if (!out_compressor->open(QIODevice::WriteOnly))
             {
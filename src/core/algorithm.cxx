@@ -34,6 +34,7 @@
 /************************************************************************/
 
 #include "core/algorithm.hxx"
+#include "core/workspace.hxx"
 
 namespace graipe {
 
@@ -145,6 +146,12 @@ void Algorithm::lockModels()
 	{
         item.second->lock();
     }
+    
+    //Reuse the temporary buffers of the workspace during the run
+    if(m_workspace != NULL)
+    {
+        BufferPool::setCurrent(&m_workspace->bufferPool());
+    }
 }
 
 void Algorithm::unlockModels()
@@ -153,6 +160,8 @@ void Algorithm::unlockModels()
     {
         item.second->unlock();
     }
+    
+    BufferPool::setCurrent(NULL);
 }
 
 void Algorithm::status_update(float percent)
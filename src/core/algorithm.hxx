@@ -145,7 +145,9 @@ class GRAIPE_CORE_EXPORT Algorithm
          * Model types) need to be locked, to prevent instable states during
          * the processes.
          *
-         * This method locks each parameter.
+         * This method locks each parameter. Since it is called at the beginning
+         * of each run, it also makes the workspace's BufferPool the current pool
+         * of the running thread.
          */
         void lockModels();
     
@@ -154,7 +156,8 @@ class GRAIPE_CORE_EXPORT Algorithm
          * Model types) need to be locked, to prevent instable states during
          * the processes.
          *
-         * This method unlocks each parameter.
+         * This method unlocks each parameter and resets the current BufferPool
+         * of the running thread.
          */
      	void unlockModels();
 
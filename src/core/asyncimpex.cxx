@@ -0,0 +1,530 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#include "core/asyncimpex.hxx"
+#include "core/impex.hxx"
+#include "core/workspace.hxx"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFile>
+#include <QThread>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include <algorithm>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *     @file
+ *     @brief Implementation file for the asynchronous import/export of Models and Workspaces
+ * @}
+ */
+
+/**
+ * A (sequential) I/O device, which passes all reads and writes to another device.
+ * It counts the processed bytes for the task and fails, if the task has been cancelled.
+ */
+class AsyncImpexDevice
+:   public QIODevice
+{
+    public:
+        /**
+         * Constructor of the device.
+         *
+         * \param device The (opened) device, where the data is read from or written to.
+         * \param task   The task, which uses the device.
+         */
+        AsyncImpexDevice(QIODevice* device, AsyncImpexTask* task)
+        :   m_device(device),
+            m_task(task)
+        {
+        }
+    
+        /**
+         * Is always true, since the underlying devices may be sequential.
+         */
+        bool isSequential() const
+        {
+            return true;
+        }
+    
+        /**
+         * Passes the position of the underlying device, which is needed by
+         * Model::serialize() to detect the beginning of a file.
+         *
+         * \return The position of the underlying device.
+         */
+        qint64 pos() const
+        {
+            return m_device->pos();
+        }
+    
+    protected:
+        /**
+         * Reads data from the underlying device.
+         *
+         * \param data    Byte pointer to the data.
+         * \param maxSize The max length to be read.
+         * \return The length of the read data or -1 on errors and cancellation.
+         */
+        qint64 readData(char * data, qint64 maxSize)
+        {
+            if(m_task->cancelled())
+                return -1;
+            
+            qint64 bytes = m_device->read(data, maxSize);
+            
+            if(bytes > 0)
+                m_task->addProcessedBytes(bytes);
+            
+            return bytes;
+        }
+    
+        /**
+         * Writes data to the underlying device.
+         *
+         * \param data    Byte pointer to the data.
+         * \param maxSize The length of the data.
+         * \return The length of the written data or -1 on errors and cancellation.
+         */
+        qint64 writeData(const char * data, qint64 maxSize)
+        {
+            if(m_task->cancelled())
+                return -1;
+            
+            qint64 bytes = m_device->write(data, maxSize);
+            
+            if(bytes > 0)
+                m_task->addProcessedBytes(bytes);
+            
+            return bytes;
+        }
+    
+    private:
+        /** The underlying device **/
+        QIODevice* m_device;
+        /** The task using this device **/
+        AsyncImpexTask* m_task;
+};
+
+
+
+
+AsyncImpexTask::AsyncImpexTask(TaskType type, const QString& filename, Model* model, Workspace* workspace)
+:   m_type(type),
+    m_filename(filename),
+    m_model(model),
+    m_content_model(NULL),
+    m_workspace(workspace),
+    m_bytes(0),
+    m_reported_bytes(0),
+    m_successful(false),
+    m_cancelled(0),
+    m_device(NULL),
+    m_io(NULL),
+    m_reader(NULL)
+{
+}
+
+AsyncImpexTask::~AsyncImpexTask()
+{
+    closeDevice();
+}
+
+AsyncImpexTask::TaskType AsyncImpexTask::type() const
+{
+    return m_type;
+}
+
+QString AsyncImpexTask::filename() const
+{
+    return m_filename;
+}
+
+Model* AsyncImpexTask::model() const
+{
+    return m_model;
+}
+
+qint64 AsyncImpexTask::bytesProcessed() const
+{
+    return m_bytes.load();
+}
+
+bool AsyncImpexTask::successful() const
+{
+    return m_successful;
+}
+
+bool AsyncImpexTask::cancelled() const
+{
+    return m_cancelled.load() != 0;
+}
+
+void AsyncImpexTask::cancel()
+{
+    m_cancelled.store(1);
+}
+
+void AsyncImpexTask::addProcessedBytes(qint64 bytes)
+{
+    const qint64 processed = m_bytes.fetchAndAddOrdered(bytes) + bytes;
+    
+    if(processed - m_reported_bytes >= (1<<20))
+    {
+        m_reported_bytes = processed;
+        emit progress(processed);
+    }
+}
+
+bool AsyncImpexTask::openDevice(QIODevice::OpenModeFlag mode)
+{
+    m_device = Impex::openFile(m_filename, mode);
+    
+    if(m_device == NULL)
+        return false;
+    
+    m_io = new AsyncImpexDevice(m_device, this);
+    m_io->open(mode);
+    
+    if(mode == QIODevice::ReadOnly)
+    {
+        m_reader = new QXmlStreamReader(m_io);
+    }
+    return true;
+}
+
+void AsyncImpexTask::closeDevice()
+{
+    delete m_reader;
+    m_reader = NULL;
+    
+    if(m_io != NULL)
+    {
+        m_io->close();
+        delete m_io;
+        m_io = NULL;
+    }
+    
+    if(m_device != NULL)
+    {
+        m_device->close();
+        delete m_device;
+        m_device = NULL;
+    }
+}
+
+void AsyncImpexTask::run()
+{
+    const bool write = (m_type != LoadModel && m_type != LoadContent);
+    
+    //Files to be read have already been opened by AsyncImpex::loadModel() or loadContent()
+    if(write)
+    {
+        openDevice(QIODevice::WriteOnly);
+    }
+    
+    if(m_io != NULL)
+    {
+        try
+        {
+            if(write)
+            {
+                QXmlStreamWriter xmlWriter(m_io);
+                
+                if(m_type == SaveModel)
+                {
+                    m_model->serialize(xmlWriter);
+                }
+                else
+                {
+                    m_workspace->serialize(xmlWriter, m_snapshot);
+                }
+                m_successful = !xmlWriter.hasError();
+            }
+            else
+            {
+                //The reader is already located at the Model's first element
+                Model* model = (m_type == LoadContent) ? m_content_model : m_model;
+                m_successful = model->deserialize(*m_reader);
+            }
+        }
+        catch(...)
+        {
+            m_successful = false;
+        }
+    }
+    
+    closeDevice();
+    
+    m_successful = m_successful && !cancelled();
+    
+    if(write && !m_successful)
+    {
+        QFile::remove(m_filename);
+    }
+    
+    emit progress(m_bytes.load());
+    emit finished();
+}
+
+
+
+
+AsyncImpex::AsyncImpex(Workspace* workspace, QObject* parent)
+:   QObject(parent),
+    m_workspace(workspace)
+{
+}
+
+AsyncImpex::~AsyncImpex()
+{
+    waitForDone();
+}
+
+AsyncImpexTask* AsyncImpex::saveModel(Model* model, const QString& filename)
+{
+    //Loading needs to be performed in this thread (see Model::loadContent)
+    model->loadContent();
+    
+    AsyncImpexTask* task = new AsyncImpexTask(AsyncImpexTask::SaveModel, filename, model, NULL);
+    task->m_locks.push_back(std::make_pair(model, model->lock()));
+    
+    startTask(task);
+    return task;
+}
+
+AsyncImpexTask* AsyncImpex::saveWorkspace(const QString& filename)
+{
+    for(AsyncImpexTask* task : m_tasks)
+    {
+        if(task->type() == AsyncImpexTask::SaveWorkspace)
+        {
+            return NULL;
+        }
+    }
+    
+    //Store the models' contents in separate files
+    m_workspace->setContentDirectory(Workspace::contentDirectoryForFile(filename));
+    
+    AsyncImpexTask* task = new AsyncImpexTask(AsyncImpexTask::SaveWorkspace, filename, NULL, m_workspace);
+    
+    //The task only accesses this snapshot, not the (changing) Workspace.
+    //It also holds the content files of the unloaded Models, which may still
+    //be loaded (despite the locks) while the task is running.
+    task->m_snapshot = m_workspace->snapshot();
+    
+    for(Model* model : task->m_snapshot.models)
+    {
+        task->m_locks.push_back(std::make_pair(model, model->lock()));
+    }
+    
+    startTask(task);
+    return task;
+}
+
+AsyncImpexTask* AsyncImpex::loadModel(const QString& filename)
+{
+    AsyncImpexTask* task = new AsyncImpexTask(AsyncImpexTask::LoadModel, filename, NULL, NULL);
+    
+    //Determine the Model's type by its first XML element.
+    //The task continues reading from there.
+    QString model_type;
+    
+    if(     task->openDevice(QIODevice::ReadOnly)
+        &&  task->m_reader->readNextStartElement())
+    {
+        model_type = task->m_reader->name().toString();
+    }
+    
+    //Create the Model in this thread
+    Model* model = NULL;
+    
+    for(const ModelFactoryItem& item : m_workspace->modelFactory())
+    {
+        if(item.model_type == model_type)
+        {
+            model = item.model_fptr(m_workspace);
+            break;
+        }
+    }
+    
+    if(model == NULL)
+    {
+        qWarning("AsyncImpex::loadModel: Model type was not found in modelFactory.");
+        delete task;
+        return NULL;
+    }
+    
+    //Nobody else may access the Model until it has been loaded completely
+    m_workspace->models.erase(std::remove(m_workspace->models.begin(), m_workspace->models.end(), model), m_workspace->models.end());
+    task->m_model = model;
+    
+    startTask(task);
+    return task;
+}
+
+AsyncImpexTask* AsyncImpex::loadContent(Model* model)
+{
+    if(model->isContentLoaded())
+    {
+        return NULL;
+    }
+    
+    //Each content is only loaded once
+    for(AsyncImpexTask* task : m_tasks)
+    {
+        if(task->type() == AsyncImpexTask::LoadContent && task->model() == model)
+        {
+            return task;
+        }
+    }
+    
+    AsyncImpexTask* task = new AsyncImpexTask(AsyncImpexTask::LoadContent, model->contentFile(), model, NULL);
+    
+    //The content file holds a complete serialization of the Model,
+    //which is read into a new Model of the same type
+    Model* content_model = NULL;
+    
+    for(const ModelFactoryItem& item : m_workspace->modelFactory())
+    {
+        if(item.model_type == model->typeName())
+        {
+            content_model = item.model_fptr(m_workspace);
+            break;
+        }
+    }
+    
+    if(     content_model == NULL
+        ||  !task->openDevice(QIODevice::ReadOnly)
+        ||  !task->m_reader->readNextStartElement()
+        ||  task->m_reader->name() != model->typeName())
+    {
+        qWarning() << "AsyncImpex::loadContent: Content file could not be opened: " << task->filename();
+        delete content_model;
+        delete task;
+        return NULL;
+    }
+    
+    //Nobody else may access the new Model
+    m_workspace->models.erase(std::remove(m_workspace->models.begin(), m_workspace->models.end(), content_model), m_workspace->models.end());
+    task->m_content_model = content_model;
+    
+    //The Model may neither be changed nor deleted during the load
+    task->m_locks.push_back(std::make_pair(model, model->lock()));
+    
+    startTask(task);
+    return task;
+}
+
+bool AsyncImpex::isRunning() const
+{
+    return !m_tasks.empty();
+}
+
+void AsyncImpex::cancelAll()
+{
+    for(AsyncImpexTask* task : m_tasks)
+    {
+        task->cancel();
+    }
+}
+
+void AsyncImpex::waitForDone()
+{
+    while(isRunning())
+    {
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents | QEventLoop::WaitForMoreEvents);
+    }
+}
+
+void AsyncImpex::startTask(AsyncImpexTask* task)
+{
+    QThread* thr = new QThread;
+    task->moveToThread(thr);
+    
+    connect(thr, SIGNAL(started()), task, SLOT(run()));
+    connect(task, SIGNAL(finished()), this, SLOT(finishTask()));
+    
+    m_tasks.push_back(task);
+    thr->start();
+}
+
+void AsyncImpex::finishTask()
+{
+    AsyncImpexTask* task = static_cast<AsyncImpexTask*>(sender());
+    QThread* thr = task->thread();
+    
+    thr->quit();
+    thr->wait();
+    
+    for(const std::pair<Model*, unsigned int>& lock : task->m_locks)
+    {
+        lock.first->unlock(lock.second);
+    }
+    
+    m_tasks.erase(std::remove(m_tasks.begin(), m_tasks.end(), task), m_tasks.end());
+    
+    //The loaded Model becomes a part of the Workspace now
+    if(task->type() == AsyncImpexTask::LoadModel && task->successful())
+    {
+        m_workspace->models.push_back(task->model());
+    }
+    
+    //The Model takes over the loaded content in this thread
+    if(task->type() == AsyncImpexTask::LoadContent && task->successful())
+    {
+        task->m_successful = task->model()->loadContent(*task->m_content_model);
+    }
+    
+    emit taskFinished(task);
+    
+    if(task->type() == AsyncImpexTask::LoadModel && !task->successful())
+    {
+        delete task->model();
+    }
+    delete task->m_content_model;
+    
+    delete task;
+    delete thr;
+}
+
+} //end of namespace graipe
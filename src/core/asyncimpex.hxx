@@ -0,0 +1,360 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_CORE_ASYNCIMPEX_HXX
+#define GRAIPE_CORE_ASYNCIMPEX_HXX
+
+#include "core/config.hxx"
+#include "core/model.hxx"
+#include "core/workspace.hxx"
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QXmlStreamReader>
+
+#include <vector>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *
+ * @file
+ * @brief Header file for the asynchronous import/export of Models and Workspaces
+ */
+
+class AsyncImpexDevice;
+
+/**
+ * A single asynchronous import/export task. Tasks are created and started by the
+ * AsyncImpex service, and run in their own thread. During the run, the task reports
+ * the count of (uncompressed) bytes, which have been processed so far by means of the
+ * progress() signal. Each task may be cancelled at any time using cancel().
+ *
+ * A task is owned by the AsyncImpex service, which deletes it after having emitted its
+ * AsyncImpex::taskFinished() signal.
+ */
+class GRAIPE_CORE_EXPORT AsyncImpexTask
+:   public QObject
+{
+    Q_OBJECT
+    
+    public:
+        /** The type of the task **/
+        enum TaskType
+        {
+            SaveModel,
+            SaveWorkspace,
+            LoadModel,
+            LoadContent
+        };
+    
+        /**
+         * Constructor of a task. Does not start the task, see AsyncImpex.
+         *
+         * \param type      The type of the task.
+         * \param filename  The file to be written or read.
+         * \param model     The Model to be saved or deserialized, or whose content is loaded
+         *                  (for SaveModel, LoadModel and LoadContent).
+         * \param workspace The Workspace to be saved (for SaveWorkspace).
+         */
+        AsyncImpexTask(TaskType type, const QString& filename, Model* model, Workspace* workspace);
+    
+        /**
+         * Destructor of a task. Closes the file, if it is still open.
+         */
+        ~AsyncImpexTask();
+    
+        /**
+         * The type of the task.
+         *
+         * \return The type of the task.
+         */
+        TaskType type() const;
+    
+        /**
+         * The file, which is written or read by the task.
+         *
+         * \return The filename of the task.
+         */
+        QString filename() const;
+    
+        /**
+         * The Model, which is saved or loaded by the task. A loaded Model is added to the
+         * Workspace's Models right before the AsyncImpex::taskFinished() signal, if the task
+         * was successful. Else, the Model will be deleted after that signal.
+         * For LoadContent tasks, this is the Model, whose content is loaded. It takes
+         * over the content right before the AsyncImpex::taskFinished() signal.
+         *
+         * \return The Model of the task or NULL for SaveWorkspace tasks.
+         */
+        Model* model() const;
+    
+        /**
+         * The count of (uncompressed) bytes, which have been written or read.
+         * Use the progress() signal to monitor a running task.
+         *
+         * \return The processed bytes (after the task has been finished).
+         */
+        qint64 bytesProcessed() const;
+    
+        /**
+         * Query, if the task has been finished successfully.
+         *
+         * \return True, if the task was successful.
+         */
+        bool successful() const;
+    
+        /**
+         * Query, if the task has been cancelled.
+         *
+         * \return True, if cancel() has been called.
+         */
+        bool cancelled() const;
+    
+        /**
+         * Cancels the task. May be called from any thread. Partially written files are
+         * removed by the task.
+         */
+        void cancel();
+    
+        /**
+         * Called by the I/O device of the task for each block of processed bytes.
+         *
+         * \param bytes The count of bytes, which have been processed.
+         */
+        void addProcessedBytes(qint64 bytes);
+    
+    public slots:
+        /**
+         * Performs the task. This is called inside the task's thread.
+         */
+        void run();
+    
+    signals:
+        /**
+         * Reports the progress of the task. Emitted at most once per MB.
+         *
+         * \param bytes The count of bytes, which have been processed so far.
+         */
+        void progress(qint64 bytes);
+    
+        /**
+         * Emitted, when the task has been finished, cancelled or failed.
+         */
+        void finished();
+    
+    private:
+        /**
+         * Opens the file of the task and the counting device on top of it.
+         * For reading, an XML reader is created, too.
+         *
+         * \param mode The open mode (WriteOnly or ReadOnly).
+         * \return True, if the file could be opened.
+         */
+        bool openDevice(QIODevice::OpenModeFlag mode);
+    
+        /**
+         * Closes and deletes the reader and the devices of the task.
+         */
+        void closeDevice();
+    
+        /** The type of the task **/
+        TaskType m_type;
+        /** The filename **/
+        QString m_filename;
+        /** The Model to be saved or loaded **/
+        Model* m_model;
+        /** The Model of the same type, which reads the content (LoadContent only) **/
+        Model* m_content_model;
+        /** The Workspace to be saved **/
+        Workspace* m_workspace;
+        /** The processed bytes **/
+        QAtomicInteger<qint64> m_bytes;
+        /** The processed bytes at the last progress() signal **/
+        qint64 m_reported_bytes;
+        /** Successful? **/
+        bool m_successful;
+        /** Cancelled? **/
+        QAtomicInt m_cancelled;
+    
+        //The service needs to manage the model locks
+        friend class AsyncImpex;
+        /** The locks of the Models, which are held during the task **/
+        std::vector<std::pair<Model*, unsigned int> > m_locks;
+        /** The snapshot of the Workspace to be saved **/
+        WorkspaceSnapshot m_snapshot;
+        /** The opened file **/
+        QIODevice* m_device;
+        /** The counting device on top of the file **/
+        AsyncImpexDevice* m_io;
+        /** The XML reader (LoadModel and LoadContent only) **/
+        QXmlStreamReader* m_reader;
+};
+
+/**
+ * The asynchronous import/export service. It saves Models and Workspaces and loads Models
+ * in background threads, such that the caller (e.g. the GUI) stays responsive. Several
+ * tasks may run at the same time. All Models, which are saved by a task, are locked during
+ * the task.
+ * All methods need to be called from the thread of the Workspace's Models (usually the GUI
+ * thread).
+ *
+ * A typical call would look like:
+ * \code
+   AsyncImpexTask* task = impex->saveModel(model, "model.xgz");
+   connect(task, SIGNAL(progress(qint64)), this, SLOT(showProgress(qint64)));
+   connect(impex, SIGNAL(taskFinished(AsyncImpexTask*)), this, SLOT(saved(AsyncImpexTask*)));
+   \endcode
+ */
+class GRAIPE_CORE_EXPORT AsyncImpex
+:   public QObject
+{
+    Q_OBJECT
+    
+    public:
+        /**
+         * Constructor of the service.
+         *
+         * \param workspace The Workspace, which is used for saving and loading.
+         * \param parent    The parent of the service (as a QObject).
+         */
+        AsyncImpex(Workspace* workspace, QObject* parent=NULL);
+    
+        /**
+         * Destructor of the service. Waits for all running tasks.
+         */
+        ~AsyncImpex();
+    
+        /**
+         * Starts saving a Model to a file. The Model is locked until the task is finished.
+         *
+         * \param model    The Model to be saved.
+         * \param filename The file, where the Model will be saved.
+         * \return The started task.
+         */
+        AsyncImpexTask* saveModel(Model* model, const QString& filename);
+    
+        /**
+         * Starts saving the complete Workspace to a file. The Models' contents are stored
+         * separately (see Workspace::contentDirectoryForFile()). The task saves a snapshot
+         * of the Workspace (see Workspace::snapshot()), which is taken immediately. All Models
+         * of the snapshot are locked until the task is finished. Models, which are added later
+         * (e.g. results of algorithms or loaded Models), are not saved by this task.
+         * Only one Workspace may be saved at a time.
+         *
+         * \param filename The file, where the Workspace will be saved.
+         * \return The started task or NULL, if another Workspace save is running.
+         */
+        AsyncImpexTask* saveWorkspace(const QString& filename);
+    
+        /**
+         * Starts loading a Model from a file. The Model is created immediately, but it is
+         * only added to the Workspace's Models, when the task has been finished successfully.
+         *
+         * \param filename The file of the Model.
+         * \return The started task or NULL, if the Model type could not be determined.
+         */
+        AsyncImpexTask* loadModel(const QString& filename);
+    
+        /**
+         * Starts loading the content of a lazily restored Model from its content file
+         * (see Model::loadContent()). The content is read into a new Model of the same
+         * type, which is taken over by the Model right before the taskFinished() signal.
+         * The Model is locked until the task is finished.
+         *
+         * \param model The Model, whose content shall be loaded.
+         * \return The started (or already running) task or NULL, if the content is
+         *         already loaded or the content file could not be opened.
+         */
+        AsyncImpexTask* loadContent(Model* model);
+    
+        /**
+         * Query, if any task is currently running.
+         *
+         * \return True, if at least one task is running.
+         */
+        bool isRunning() const;
+    
+        /**
+         * Cancels all running tasks.
+         */
+        void cancelAll();
+    
+        /**
+         * Blocks until all running tasks are finished. Events (except user input) are
+         * processed meanwhile.
+         */
+        void waitForDone();
+    
+    signals:
+        /**
+         * Emitted, when a task has been finished and the Models have been unlocked.
+         * The task will be deleted right afterwards.
+         *
+         * \param task The finished task.
+         */
+        void taskFinished(AsyncImpexTask* task);
+    
+    protected slots:
+        /**
+         * Cleans up after a task has been finished.
+         */
+        void finishTask();
+    
+    protected:
+        /**
+         * Starts a task in its own thread.
+         *
+         * \param task The task.
+         */
+        void startTask(AsyncImpexTask* task);
+    
+        /** The Workspace **/
+        Workspace* m_workspace;
+        /** The running tasks **/
+        std::vector<AsyncImpexTask*> m_tasks;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_CORE_ASYNCIMPEX_HXX
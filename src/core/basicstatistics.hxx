@@ -36,7 +36,9 @@
 #ifndef GRAIPE_CORE_BASICSTATISTICS_HXX
 #define GRAIPE_CORE_BASICSTATISTICS_HXX
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include <QtDebug>
 
@@ -53,7 +55,7 @@ namespace graipe  {
 /**
  * This file just contains a very basic data structure for the storage
  * of a simple statistic, w.r.t. minimum, maximum, mean and standard
- * deviation of the data.
+ * deviation of the data and a basic histogram structure.
  *
  * There exists a print method, which uses qDebug to output the 
  * statistics on the terminal.
@@ -84,6 +86,93 @@ struct BasicStatistics
         T stddev;
 };
 
+/**
+ * Combines the statistics of the x- and y-components of 2D data
+ * to (component-wise) statistics of 2D points.
+ *
+ * \param x The statistics of the x-components.
+ * \param y The statistics of the y-components.
+ * \return The statistics of the points.
+ */
+template <typename P>
+BasicStatistics<P> combineStatistics(const BasicStatistics<double>& x, const BasicStatistics<double>& y)
+{
+    BasicStatistics<P> stats;
+    stats.min    = P(x.min,    y.min);
+    stats.max    = P(x.max,    y.max);
+    stats.mean   = P(x.mean,   y.mean);
+    stats.stddev = P(x.stddev, y.stddev);
+    return stats;
+}
+
+/**
+ * A histogram of scalar data with equally sized bins between the minimum
+ * and the maximum of the data. Besides the bin counts, the histogram can be
+ * used to estimate percentiles of the data without another pass over the data,
+ * e.g. for an automatic contrast stretch.
+ */
+struct BasicHistogram
+{
+    public:
+        /**
+         * Default constructor: an empty histogram.
+         */
+        BasicHistogram()
+        :   min(0),
+            max(0),
+            count(0)
+        {
+        }
+    
+        /**
+         * Comparison of histograms.
+         * \param other other histogram to compare with
+         * \return true if both have equal ranges and bins.
+         */
+        bool operator==(const BasicHistogram&  other) const
+        {
+            return min == other.min && max == other.max && count == other.count && bins == other.bins;
+        };
+    
+        /**
+         * Estimation of a percentile of the data. Inside the bin, which contains
+         * the percentile, the data is assumed to be uniformly distributed.
+         *
+         * \param p The percentile in [0, 100].
+         * \return The estimated value of the percentile.
+         */
+        double percentile(double p) const
+        {
+            if(count == 0 || bins.size() == 0)
+            {
+                return min;
+            }
+            
+            double target = std::max(0.0, std::min(p, 100.0))/100.0 * count,
+                   bin_width = (max-min)/bins.size(),
+                   cumulated = 0;
+            
+            for(unsigned int b=0; b<bins.size(); ++b)
+            {
+                if(bins[b] != 0 && cumulated + bins[b] >= target)
+                {
+                    return min + bin_width*(b + (target-cumulated)/bins[b]);
+                }
+                cumulated += bins[b];
+            }
+            return max;
+        }
+    
+        /** lower bound of the first bin **/
+        double min;
+        /** upper bound of the last bin **/
+        double max;
+        /** count of all binned values **/
+        unsigned long count;
+        /** the count of values per bin **/
+        std::vector<unsigned long> bins;
+};
+
 /**
  * Helper function to log BasicStatistics to the Debug log
  * \param stats Statistics to be logged.
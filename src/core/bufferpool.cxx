@@ -0,0 +1,229 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#include "core/bufferpool.hxx"
+
+#include <algorithm>
+#include <new>
+
+#include <QtGlobal>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *     @file
+ *     @brief Implementation file for the pooled allocation of large temporary buffers
+ * @}
+ */
+
+/** The current pool of each thread **/
+static thread_local BufferPool* current_buffer_pool = NULL;
+
+BufferPoolStatistics::BufferPoolStatistics()
+: requests(0),
+  hits(0),
+  bytes_in_use(0),
+  peak_bytes_in_use(0),
+  bytes_cached(0)
+{
+}
+
+double BufferPoolStatistics::hitRate() const
+{
+    return requests ? double(hits)/requests : 0.0;
+}
+
+BufferPool::BufferPool(qint64 max_cached_bytes)
+: m_max_cached_bytes(max_cached_bytes)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    clear();
+}
+
+void* BufferPool::acquire(std::size_t bytes, std::size_t& block_size)
+{
+    block_size = sizeClass(bytes);
+    
+    void* buffer = NULL;
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        m_statistics.requests++;
+        m_statistics.bytes_in_use += block_size;
+        m_statistics.peak_bytes_in_use = std::max(m_statistics.peak_bytes_in_use, m_statistics.bytes_in_use);
+        
+        std::map<std::size_t, std::vector<void*> >::iterator iter = m_free_buffers.find(block_size);
+        
+        if(iter != m_free_buffers.end() && !iter->second.empty())
+        {
+            buffer = iter->second.back();
+            iter->second.pop_back();
+            
+            m_statistics.hits++;
+            m_statistics.bytes_cached -= block_size;
+        }
+    }
+    
+    //Allocate outside of the lock
+    if(buffer == NULL)
+    {
+        buffer = qMallocAligned(block_size, alignment);
+        
+        if(buffer == NULL)
+        {
+            QMutexLocker locker(&m_mutex);
+            m_statistics.bytes_in_use -= block_size;
+            
+            throw std::bad_alloc();
+        }
+    }
+    return buffer;
+}
+
+void BufferPool::release(void* buffer, std::size_t block_size)
+{
+    if(buffer == NULL)
+        return;
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        m_statistics.bytes_in_use -= block_size;
+        
+        if(m_statistics.bytes_cached + (qint64)block_size <= m_max_cached_bytes)
+        {
+            m_free_buffers[block_size].push_back(buffer);
+            m_statistics.bytes_cached += block_size;
+            return;
+        }
+    }
+    
+    qFreeAligned(buffer);
+}
+
+void BufferPool::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    trim(0);
+}
+
+qint64 BufferPool::maxCachedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_max_cached_bytes;
+}
+
+void BufferPool::setMaxCachedBytes(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    m_max_cached_bytes = bytes;
+    trim(bytes);
+}
+
+BufferPoolStatistics BufferPool::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+void BufferPool::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    
+    m_statistics.requests = 0;
+    m_statistics.hits = 0;
+    m_statistics.peak_bytes_in_use = m_statistics.bytes_in_use;
+}
+
+std::size_t BufferPool::sizeClass(std::size_t bytes)
+{
+    if(bytes <= alignment)
+        return alignment;
+    
+    //Highest power of two, which is <= bytes
+    std::size_t power = alignment;
+    while((power << 1) <= bytes)
+    {
+        power <<= 1;
+    }
+    
+    std::size_t step = std::max(power/4, alignment);
+    
+    return ((bytes + step - 1)/step)*step;
+}
+
+BufferPool& BufferPool::global()
+{
+    static BufferPool global_pool;
+    return global_pool;
+}
+
+BufferPool& BufferPool::current()
+{
+    return current_buffer_pool ? *current_buffer_pool : global();
+}
+
+void BufferPool::setCurrent(BufferPool* pool)
+{
+    current_buffer_pool = pool;
+}
+
+void BufferPool::trim(qint64 bytes)
+{
+    //Free the largest buffers first
+    std::map<std::size_t, std::vector<void*> >::reverse_iterator iter = m_free_buffers.rbegin();
+    
+    while(m_statistics.bytes_cached > bytes && iter != m_free_buffers.rend())
+    {
+        std::vector<void*>& buffers = iter->second;
+        
+        while(m_statistics.bytes_cached > bytes && !buffers.empty())
+        {
+            qFreeAligned(buffers.back());
+            buffers.pop_back();
+            m_statistics.bytes_cached -= iter->first;
+        }
+        ++iter;
+    }
+}
+
+} //end of namespace graipe
@@ -0,0 +1,225 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_CORE_BUFFERPOOL_HXX
+#define GRAIPE_CORE_BUFFERPOOL_HXX
+
+#include "core/config.hxx"
+
+#include <map>
+#include <vector>
+
+#include <QMutex>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *
+ * @file
+ * @brief Header file for the pooled allocation of large temporary buffers
+ */
+
+/**
+ * Statistics of a BufferPool.
+ */
+struct GRAIPE_CORE_EXPORT BufferPoolStatistics
+{
+    /**
+     * Default constructor. Initializes all counters to zero.
+     */
+    BufferPoolStatistics();
+    
+    /**
+     * The fraction of the requests, which have been served by cached buffers.
+     *
+     * \return The hit rate (0..1) or 0, if there have not been any requests.
+     */
+    double hitRate() const;
+    
+    /** The number of acquired buffers **/
+    quint64 requests;
+    /** The number of acquired buffers, which have been served by cached buffers **/
+    quint64 hits;
+    /** The bytes of the buffers, which are currently checked out **/
+    qint64 bytes_in_use;
+    /** The maximum of bytes_in_use since the last reset **/
+    qint64 peak_bytes_in_use;
+    /** The bytes of the buffers, which are currently cached for reuse **/
+    qint64 bytes_cached;
+};
+
+/**
+ * A thread-safe pool of large, aligned memory buffers. Buffers, which are
+ * released, are cached by their size class instead of being freed, so that
+ * subsequent requests of the same size class reuse warm memory instead of
+ * allocating (and page-faulting) fresh memory. 
+ *
+ * Each Workspace holds a pool, which is made the current pool of the thread
+ * running an Algorithm (see Algorithm::lockModels()). Typed access is given
+ * by the PooledArray class of the images module.
+ */
+class GRAIPE_CORE_EXPORT BufferPool
+{
+    public:
+        /** The alignment of all buffers in bytes **/
+        static const std::size_t alignment = 64;
+    
+        /**
+         * Constructor. Creates an empty pool.
+         *
+         * \param max_cached_bytes The maximal bytes, which are cached for reuse.
+         */
+        BufferPool(qint64 max_cached_bytes = 512*1024*1024);
+    
+        /**
+         * Destructor. Frees all cached buffers. All buffers need to be
+         * released before.
+         */
+        ~BufferPool();
+    
+        /**
+         * Checks out a buffer of at least the given size.
+         *
+         * \param bytes The requested size in bytes.
+         * \param block_size Will be set to the size of the buffer's size class.
+         *                   It has to be given back to release().
+         * \return The aligned buffer.
+         */
+        void* acquire(std::size_t bytes, std::size_t& block_size);
+    
+        /**
+         * Returns a buffer to the pool. It is cached for reuse, if the
+         * cache does not exceed maxCachedBytes() afterwards.
+         *
+         * \param buffer The buffer.
+         * \param block_size The size of the buffer's size class as given by acquire().
+         */
+        void release(void* buffer, std::size_t block_size);
+    
+        /**
+         * Frees all cached buffers.
+         */
+        void clear();
+    
+        /**
+         * The maximal bytes, which are cached for reuse.
+         *
+         * \return The maximal bytes of the cache.
+         */
+        qint64 maxCachedBytes() const;
+    
+        /**
+         * Sets the maximal bytes, which are cached for reuse.
+         * Cached buffers, which exceed the new limit, are freed.
+         *
+         * \param bytes The maximal bytes of the cache.
+         */
+        void setMaxCachedBytes(qint64 bytes);
+    
+        /**
+         * The current statistics of this pool.
+         *
+         * \return The statistics of this pool.
+         */
+        BufferPoolStatistics statistics() const;
+    
+        /**
+         * Resets the request counters and the peak usage of this pool.
+         */
+        void resetStatistics();
+    
+        /**
+         * Rounds a size up to its size class. There are four size classes for
+         * each power of two, thus at most 25% of a buffer remain unused.
+         *
+         * \param bytes The size in bytes.
+         * \return The size of the corresponding size class in bytes.
+         */
+        static std::size_t sizeClass(std::size_t bytes);
+    
+        /**
+         * The process-wide pool, which is used if no other pool is current.
+         *
+         * \return The global pool.
+         */
+        static BufferPool& global();
+    
+        /**
+         * The current pool of the calling thread.
+         *
+         * \return The pool set by setCurrent() or the global pool.
+         */
+        static BufferPool& current();
+    
+        /**
+         * Sets the current pool of the calling thread.
+         *
+         * \param pool The pool or NULL to use the global pool.
+         */
+        static void setCurrent(BufferPool* pool);
+    
+    private:
+        /** Pools cannot be copied **/
+        BufferPool(const BufferPool&);
+        BufferPool& operator=(const BufferPool&);
+    
+        /**
+         * Frees cached buffers until the cache does not exceed the given size.
+         * The mutex needs to be locked by the caller.
+         *
+         * \param bytes The maximal bytes of the cache.
+         */
+        void trim(qint64 bytes);
+    
+        /** The mutex for the concurrent access **/
+        mutable QMutex m_mutex;
+        /** The cached buffers by their size class **/
+        std::map<std::size_t, std::vector<void*> > m_free_buffers;
+        /** The maximal bytes of the cache **/
+        qint64 m_max_cached_bytes;
+        /** The statistics **/
+        BufferPoolStatistics m_statistics;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_CORE_BUFFERPOOL_HXX
@@ -47,17 +47,21 @@
  */
 
 #include "core/algorithm.hxx"
+#include "core/asyncimpex.hxx"
 #include "core/basicstatistics.hxx"
+#include "core/bufferpool.hxx"
 #include "core/colortables.hxx"
 #include "core/factories.hxx"
 #include "core/impex.hxx"
 #include "core/logging.hxx"
 #include "core/model.hxx"
+#include "core/modelstatistics.hxx"
 #include "core/module.hxx"
 #include "core/parameters.hxx"
 #include "core/parameterselection.hxx"
 #include "core/qt_ext.hxx"
 #include "core/serializable.hxx"
+#include "core/spatialindex.hxx"
 #include "core/updatechecker.hxx"
 #include "core/viewcontroller.hxx"
 #include "core/workspace.hxx"
@@ -64,7 +64,9 @@ QIODevice* Impex::openFile(const QString & filename, QIODevice::OpenModeFlag ope
         if(compress)
         {
             QIOCompressor* compressor = new QIOCompressor(file);
-            compressor->setStreamFormat(QIOCompressor::GzipFormat);
+            
+            //Block streams are plain gzip streams, which are compressed in parallel
+            compressor->setStreamFormat(QIOCompressor::BlockGzipFormat);
 
             if (compressor->open(openMode))
             {
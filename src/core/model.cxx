@@ -42,6 +42,7 @@
 #include <algorithm>
 
 #include <QtDebug>
+#include <QMutexLocker>
 #include <QXmlStreamWriter>
 
 namespace graipe {
@@ -64,7 +65,10 @@ Model::Model(Workspace* wsp)
     m_global_ul(new PointFParameter("Global upper-left (deg.):", QPointF(-180,-90), QPointF(180,90), QPointF(0,0), NULL)),
     m_global_lr(new PointFParameter("Global lower-right (deg.):", QPointF(-180,-90),QPointF(180,90), QPointF(0,0), NULL)),
     m_parameters(new ParameterGroup("Model Properties", ParameterGroup::storage_type(), QFormLayout::WrapAllRows)),
-    m_workspace(wsp)
+    m_workspace(wsp),
+    m_transaction_depth(0),
+    m_update_pending(false),
+    m_transforms_valid(false)
 {
     m_name->setValue(QString("New ") + typeName());
     m_description->setValue(QString("This new ") + typeName() + " has been created on " + QDateTime::currentDateTime().toString());
@@ -93,8 +97,15 @@ Model::Model(const Model& model)
     m_lr(new PointParameter("Local lower-right:", QPoint(0,0),QPoint(100000,100000), QPoint(model.right(), model.bottom()), NULL)),
     m_global_ul(new PointFParameter("Global upper-left (deg.):", QPointF(-180,-90), QPointF(180,90), QPointF(model.globalLeft(), model.globalTop()), NULL)),
     m_global_lr(new PointFParameter("Global lower-right (deg.):", QPointF(-180,-90),QPointF(180,90), QPointF(model.globalRight(), model.globalBottom()), NULL)),
-    m_parameters(new ParameterGroup("Model Properties",ParameterGroup::storage_type(), QFormLayout::WrapAllRows))
-{
+    m_parameters(new ParameterGroup("Model Properties",ParameterGroup::storage_type(), QFormLayout::WrapAllRows)),
+    m_workspace(model.m_workspace),
+    m_transaction_depth(0),
+    m_update_pending(false),
+    m_transforms_valid(false)
+{
+    //The content of the other model is needed by the subclasses' copy constructors
+    model.loadContent();
+    
     m_parameters->addParameter("name", m_name);
     m_parameters->addParameter("descr", m_description);
     
@@ -117,6 +128,13 @@ Model::~Model()
     
     //Remove from global models list
     workspace()->models.erase(std::remove(workspace()->models.begin(), workspace()->models.end(), this), workspace()->models.end());
+    
+    //Remove the ViewControllers, which are still waiting for the content
+    std::vector<std::pair<Model*, QByteArray> >& pending = workspace()->pendingViewControllers;
+    
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [this](const std::pair<Model*, QByteArray>& p){ return p.first == this; }),
+                  pending.end());
 }
 
 QString Model::name() const
@@ -296,14 +314,110 @@ bool Model::isGeoViewable() const
 
 QTransform Model::localTransformation() const
 {
-	return QTransform::fromTranslate(left(), top());
+    QMutexLocker locker(&m_transform_mutex);
+    updateTransformations();
+    return m_local_transform;
 }
 
 QTransform Model::globalTransformation() const
+{
+    QMutexLocker locker(&m_transform_mutex);
+    updateTransformations();
+    return m_global_transform;
+}
+
+QTransform Model::inverseLocalTransformation() const
+{
+    QMutexLocker locker(&m_transform_mutex);
+    updateTransformations();
+    return m_inverse_local_transform;
+}
+
+QTransform Model::inverseGlobalTransformation() const
+{
+    QMutexLocker locker(&m_transform_mutex);
+    updateTransformations();
+    return m_inverse_global_transform;
+}
+
+void Model::mapToLocal(const std::vector<QPointF>& points, std::vector<QPointF>& local_points) const
+{
+    local_points.resize(points.size());
+    mapPoints(localTransformation(), points.data(), local_points.data(), points.size());
+}
+
+void Model::mapToGlobal(const std::vector<QPointF>& points, std::vector<QPointF>& global_points) const
+{
+    global_points.resize(points.size());
+    mapPoints(globalTransformation(), points.data(), global_points.data(), points.size());
+}
+
+void Model::mapFromLocal(const std::vector<QPointF>& local_points, std::vector<QPointF>& points) const
+{
+    points.resize(local_points.size());
+    mapPoints(inverseLocalTransformation(), local_points.data(), points.data(), local_points.size());
+}
+
+void Model::mapFromGlobal(const std::vector<QPointF>& global_points, std::vector<QPointF>& points) const
+{
+    points.resize(global_points.size());
+    mapPoints(inverseGlobalTransformation(), global_points.data(), points.data(), global_points.size());
+}
+
+void Model::mapPoints(const QTransform& trans, const QPointF* points, QPointF* mapped_points, unsigned int count)
+{
+    if(!trans.isAffine())
+    {
+        for(unsigned int i=0; i<count; ++i)
+        {
+            mapped_points[i] = trans.map(points[i]);
+        }
+        return;
+    }
+    
+    //Affine case: x' = m11*x + m21*y + dx, y' = m12*x + m22*y + dy
+    const qreal m11 = trans.m11(), m21 = trans.m21(), dx = trans.dx(),
+                m12 = trans.m12(), m22 = trans.m22(), dy = trans.dy();
+    
+    for(unsigned int i=0; i<count; ++i)
+    {
+        const qreal x = points[i].x(), y = points[i].y();
+        mapped_points[i].rx() = m11*x + m21*y + dx;
+        mapped_points[i].ry() = m12*x + m22*y + dy;
+    }
+}
+
+QTransform Model::computeLocalTransformation() const
+{
+	return QTransform::fromTranslate(left(), top());
+}
+
+QTransform Model::computeGlobalTransformation() const
 {
 	return  QTransform::fromTranslate(globalLeft(), -globalTop());
 }
 
+void Model::invalidateTransformations()
+{
+    QMutexLocker locker(&m_transform_mutex);
+    m_transforms_valid = false;
+}
+
+void Model::updateTransformations() const
+{
+    if(m_transforms_valid)
+        return;
+    
+    m_local_transform  = computeLocalTransformation();
+    m_global_transform = computeGlobalTransformation();
+    
+    //QTransform::inverted() returns the identity for non-invertible matrices
+    m_inverse_local_transform  = m_local_transform.inverted();
+    m_inverse_global_transform = m_global_transform.inverted();
+    
+    m_transforms_valid = true;
+}
+
 void Model::copyGeometry(Model& other) const
 {
 	//ensure constness
@@ -338,6 +452,7 @@ void Model::copyData(Model& other) const
 	//ensure constness
 	if(this != &other)
 	{
+		loadContent();
 		copyMetadata(other);
 	}
 }
@@ -347,6 +462,8 @@ void Model::serialize(QXmlStreamWriter& xmlWriter) const
     xmlWriter.setAutoFormatting(true);
     xmlWriter.setAutoFormattingIndent(4);
     
+    loadContent();
+    
     bool fullFile = (xmlWriter.device()->pos() == 0);
     
     if (fullFile)
@@ -361,6 +478,10 @@ void Model::serialize(QXmlStreamWriter& xmlWriter) const
             xmlWriter.writeStartElement("Content");
                 serialize_content(xmlWriter);
             xmlWriter.writeEndElement();
+            if(!m_statistics.isEmpty())
+            {
+                m_statistics.serialize(xmlWriter);
+            }
         xmlWriter.writeEndElement();    
     if (fullFile)
     {
@@ -382,6 +503,9 @@ bool Model::deserialize(QXmlStreamReader& xmlReader)
             {
                 setID(xmlReader.attributes().value("ID").toString());
                 
+                //Statistics are only valid, if they are stored with the content
+                m_statistics.clear();
+                
                 while(xmlReader.readNextStartElement())
                 {
                     if(xmlReader.name() == "Header")
@@ -411,6 +535,16 @@ bool Model::deserialize(QXmlStreamReader& xmlReader)
                             return false;
                         }
                     }
+                    if(xmlReader.name() == "Statistics")
+                    {
+                        //Cached statistics are optional: Recompute them on failure
+                        m_statistics.deserialize(xmlReader);
+                    }
+                    if(xmlReader.name() == "ContentFile")
+                    {
+                        //Content will be loaded on demand by loadContent()
+                        m_content_file = xmlReader.readElementText();
+                    }
                 }
                 return true;
             }
@@ -449,6 +583,9 @@ bool Model::deserialize_header(QXmlStreamReader& xmlReader)
     bool res = m_parameters->deserialize(xmlReader);
     
     connect(m_parameters, SIGNAL(valueChanged()), this, SLOT(updateModel()));
+    
+    //The geometry parameters have been read without any update
+    invalidateTransformations();
         
     return res;
 }
@@ -462,6 +599,137 @@ bool Model::deserialize_content(QXmlStreamReader& xmlReader)
     return true;
 }
 
+void Model::serialize_reference(QXmlStreamWriter& xmlWriter, const QString& content_file) const
+{
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.setAutoFormattingIndent(4);
+    
+    xmlWriter.writeStartElement(typeName());
+    xmlWriter.writeAttribute("ID", id());
+        xmlWriter.writeStartElement("Header");
+            serialize_header(xmlWriter);
+        xmlWriter.writeEndElement();
+        xmlWriter.writeTextElement("ContentFile", content_file);
+    xmlWriter.writeEndElement();
+}
+
+bool Model::isContentLoaded() const
+{
+    return m_content_file.isEmpty();
+}
+
+QString Model::contentFile() const
+{
+    return m_content_file;
+}
+
+void Model::setContentFile(const QString& filename)
+{
+    m_content_file = filename;
+}
+
+bool Model::loadContent() const
+{
+    if(isContentLoaded())
+    {
+        return true;
+    }
+    
+    //Loading the content does not change the (logical) state of the model:
+    Model* model = const_cast<Model*>(this);
+    
+    //Thus, it is also allowed while the model is locked (e.g. by a workspace save),
+    //since the locks would make the deserialization fail.
+    QVector<unsigned int> locks;
+    locks.swap(model->m_locks);
+    
+    QIODevice* device = Impex::openFile(m_content_file, QIODevice::ReadOnly);
+    bool res = false;
+    
+    if(device != NULL)
+    {
+        QXmlStreamReader xmlReader(device);
+        
+        if(     xmlReader.readNextStartElement()
+            &&  xmlReader.name() == typeName())
+        {
+            m_statistics.clear();
+            res = true;
+            
+            //The header has already been restored and may have been changed since
+            while(res && xmlReader.readNextStartElement())
+            {
+                if(xmlReader.name() == "Content")
+                {
+                    res = model->deserialize_content(xmlReader);
+                }
+                else if(xmlReader.name() == "Statistics")
+                {
+                    m_statistics.deserialize(xmlReader);
+                }
+                else
+                {
+                    xmlReader.skipCurrentElement();
+                }
+            }
+        }
+        device->close();
+        delete device;
+    }
+    
+    model->m_locks.swap(locks);
+    
+    if(!res)
+    {
+        //Keep the reference: The content file is still the only valid copy of the content
+        qCritical() << "Model::loadContent: Content could not be restored from file: " << m_content_file;
+        return false;
+    }
+    
+    m_content_file.clear();
+    
+    emit model->modelChanged();
+    
+    return true;
+}
+
+bool Model::loadContent(const Model& loaded) const
+{
+    //The content may have been loaded in the meantime
+    if(isContentLoaded())
+    {
+        return true;
+    }
+    
+    if(     loaded.typeName() != typeName()
+        ||  !loaded.isContentLoaded())
+    {
+        return false;
+    }
+    
+    //See loadContent() above
+    Model* model = const_cast<Model*>(this);
+    
+    QVector<unsigned int> locks;
+    locks.swap(model->m_locks);
+    
+    ModelTransaction transaction(model);
+    
+    //Keep the current header, only the content is taken over
+    copyMetadata(const_cast<Model&>(loaded));
+    loaded.copyData(*model);
+    
+    m_content_file.clear();
+    
+    //Clears the statistics and emits modelChanged() once on commit
+    model->updateModel();
+    transaction.commit();
+    
+    model->m_locks.swap(locks);
+    
+    return true;
+}
+
 bool Model::locked() const
 {
     return (m_locks.size() > 0);
@@ -492,23 +760,84 @@ void Model::unlock(unsigned int unlock_code)
     }
 }
 
+ModelStatistics& Model::statistics() const
+{
+    return m_statistics;
+}
+
 ParameterGroup* Model::parameters()
 {
     return m_parameters;
 }
 
-void Model::updateModel()
+void Model::beginTransaction()
 {
-    emit modelChanged();
+    ++m_transaction_depth;
 }
 
+void Model::commitTransaction()
+{
+    if(m_transaction_depth == 0)
+        return;
+    
+    if(--m_transaction_depth == 0 && m_update_pending)
+    {
+        m_update_pending = false;
+        updateModel();
+    }
+}
 
+bool Model::inTransaction() const
+{
+    return m_transaction_depth != 0;
+}
 
+bool Model::deferUpdate()
+{
+    //The geometry may have changed: invalidate the cached transformations
+    invalidateTransformations();
+    
+    if(m_transaction_depth != 0)
+    {
+        m_update_pending = true;
+        return true;
+    }
+    return false;
+}
 
+void Model::updateModel()
+{
+    if(deferUpdate())
+        return;
+    
+    //The data may have changed: invalidate all cached statistics
+    m_statistics.clear();
+    
+    emit modelChanged();
+}
 
 
 
 
+ModelTransaction::ModelTransaction(Model* model)
+:   m_model(model)
+{
+    m_model->beginTransaction();
+}
+
+ModelTransaction::~ModelTransaction()
+{
+    commit();
+}
+
+void ModelTransaction::commit()
+{
+    if(m_model != NULL)
+    {
+        m_model->commitTransaction();
+        m_model = NULL;
+    }
+}
 
 
 
@@ -574,20 +903,20 @@ bool RasteredModel::isGeoViewable() const
     return !isEmpty() && Model::isGeoViewable();
 }
 
-QTransform RasteredModel::localTransformation() const
+QTransform RasteredModel::computeLocalTransformation() const
 {
 	double scale_x = std::abs(right()  - left())/width();
     double scale_y = std::abs(bottom() - top())/height();
 	
-	return QTransform::fromScale(scale_x,scale_y) * Model::localTransformation();
+	return QTransform::fromScale(scale_x,scale_y) * Model::computeLocalTransformation();
 }
 
-QTransform RasteredModel::globalTransformation() const
+QTransform RasteredModel::computeGlobalTransformation() const
 {
 	double scale_x = std::abs(globalRight() - globalLeft())/width();
 	double scale_y = std::abs(globalBottom() - globalTop())/height();
 	
-	return QTransform::fromScale(scale_x,scale_y) * Model::globalTransformation();
+	return QTransform::fromScale(scale_x,scale_y) * Model::computeGlobalTransformation();
 }
 
 void RasteredModel::copyGeometry(Model& other) const
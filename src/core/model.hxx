@@ -38,14 +38,18 @@
 
 #include "core/config.hxx"
 #include "core/serializable.hxx"
+#include "core/modelstatistics.hxx"
 
 #include <QString>
 #include <QVector>
 #include <QTransform>
+#include <QMutex>
 #include <QObject>
 #include <QtDebug>
 #include <QXmlStreamWriter>
 
+#include <vector>
+
 namespace graipe {
 
 
@@ -310,17 +314,80 @@ class GRAIPE_CORE_EXPORT Model
     
         /**
          * Convenience function to get the local transformation in Qt style.
+         * The transformation is cached and only recomputed after the geometry
+         * of the model has been changed.
          *
          * \return The local translation matrix of the model.
          */
-        virtual QTransform localTransformation() const;
+        QTransform localTransformation() const;
     
         /**
          * Convenience function to get the global transformation in Qt style.
+         * The transformation is cached and only recomputed after the geometry
+         * of the model has been changed.
          *
          * \return The global translation matrix of the model.
          */
-        virtual QTransform globalTransformation() const;
+        QTransform globalTransformation() const;
+    
+        /**
+         * The (cached) inverse of the local transformation.
+         *
+         * \return The inverse local transformation or the identity, if it is not invertible.
+         */
+        QTransform inverseLocalTransformation() const;
+    
+        /**
+         * The (cached) inverse of the global transformation.
+         *
+         * \return The inverse global transformation or the identity, if it is not invertible.
+         */
+        QTransform inverseGlobalTransformation() const;
+    
+        /**
+         * Maps a whole array of model coordinates to local coordinates.
+         *
+         * \param points The model coordinates.
+         * \param local_points Will be resized and filled with the local coordinates.
+         */
+        void mapToLocal(const std::vector<QPointF>& points, std::vector<QPointF>& local_points) const;
+    
+        /**
+         * Maps a whole array of model coordinates to global coordinates.
+         *
+         * \param points The model coordinates.
+         * \param global_points Will be resized and filled with the global coordinates.
+         */
+        void mapToGlobal(const std::vector<QPointF>& points, std::vector<QPointF>& global_points) const;
+    
+        /**
+         * Maps a whole array of local coordinates back to model coordinates.
+         *
+         * \param local_points The local coordinates.
+         * \param points Will be resized and filled with the model coordinates.
+         */
+        void mapFromLocal(const std::vector<QPointF>& local_points, std::vector<QPointF>& points) const;
+    
+        /**
+         * Maps a whole array of global coordinates back to model coordinates.
+         *
+         * \param global_points The global coordinates.
+         * \param points Will be resized and filled with the model coordinates.
+         */
+        void mapFromGlobal(const std::vector<QPointF>& global_points, std::vector<QPointF>& points) const;
+    
+        /**
+         * Maps a range of points by means of a transformation. For affine
+         * transformations, the mapping is computed by means of a plain loop
+         * over the coefficients, which may be vectorized by the compiler.
+         * The source and destination ranges may be the same.
+         *
+         * \param trans The transformation.
+         * \param points Pointer to the first point.
+         * \param mapped_points Pointer to the first mapped point.
+         * \param count The count of points.
+         */
+        static void mapPoints(const QTransform& trans, const QPointF* points, QPointF* mapped_points, unsigned int count);
 
         /**
          * Const copy model's geometry information to another model.
@@ -361,6 +428,9 @@ class GRAIPE_CORE_EXPORT Model
          *        HEADER = serialize_header(), and
          *       CONTENT = serialize_content().
          *
+         * If statistics have been cached for the model, they are appended
+         * after the content (see ModelStatistics::serialize).
+         *
          * If the device, on which the writer writes, is not on the beginning (pos!=0),
          * the writeStartDocument() and writeEndDocument() calls will be suppressed in
          * order to allow multi-object files.
@@ -409,6 +479,79 @@ class GRAIPE_CORE_EXPORT Model
          */
         virtual bool deserialize_content(QXmlStreamReader& xmlReader);
     
+        /**
+         * This function serializes a Model without its content. Instead of the
+         * content, a reference to a separate file is written, which needs to hold
+         * a complete serialization of the model (see serialize()):
+         * \verbatim
+           <TYPENAME>
+               <Header>
+                   HEADER
+               </Header>
+               <ContentFile>CONTENT_FILE</ContentFile>
+           </TYPENAME>
+           \endverbatim
+         *
+         * When such a Model is deserialized, only the header is restored and the
+         * content is loaded later on demand by loadContent().
+         *
+         * \param xmlWriter The QXmlStreamWriter used for the serialization.
+         * \param content_file The filename of the model's content file.
+         */
+        void serialize_reference(QXmlStreamWriter& xmlWriter, const QString& content_file) const;
+    
+        /**
+         * Query, if the content of the Model has already been loaded. This is always
+         * the case, unless the Model has been deserialized from a reference (see
+         * serialize_reference()).
+         *
+         * \return True, if the content is available.
+         */
+        bool isContentLoaded() const;
+    
+        /**
+         * The filename of the content file, which has not been loaded so far.
+         *
+         * \return The filename, or an empty string if the content is already loaded.
+         */
+        QString contentFile() const;
+    
+        /**
+         * Sets the filename of the content file, from which the content will be
+         * loaded on demand. This marks the content of the Model as not loaded.
+         *
+         * \param filename The filename of the content file.
+         */
+        void setContentFile(const QString& filename);
+    
+        /**
+         * Loads the content of the Model from its content file, if it has not been
+         * loaded so far. This is automatically called before the content is needed
+         * by a ViewController, by copying or by a serialization of the Model.
+         * Algorithms have to ensure, that the content of their Models is loaded
+         * before they are started (in the main thread).
+         * Since loading does not change the logical state of the Model, it is also
+         * performed for locked Models. After loading, the modelChanged() signal is
+         * emitted. If loading fails, the content file is kept, so that the content
+         * is not lost on the next save.
+         *
+         * \return True, if the content is available afterwards.
+         */
+        bool loadContent() const;
+    
+        /**
+         * Takes over the content of another Model of the same type, which has been
+         * loaded from this Model's content file, e.g. in a background thread (see
+         * AsyncImpex::loadContent()). The header of this Model is kept, since it
+         * may have been changed since the content file was written. Like
+         * loadContent(), this is also performed for locked Models and emits the
+         * modelChanged() signal. Does nothing, if the content has already been loaded.
+         *
+         * \param loaded The Model, which holds the loaded content.
+         * \return True, if the content is available afterwards.
+         */
+        bool loadContent(const Model& loaded) const;
+    
         /**
          * Models may be locked (to read only access), while algorithms are using them e.g.
          * This function can be used to query, if the Model is locked or not.
@@ -440,6 +583,38 @@ class GRAIPE_CORE_EXPORT Model
          */
         void unlock(unsigned int unlock_code);
     
+        /**
+         * Access to the statistics cache of the model. The cache is filled by the
+         * statistics classes of the modules and cleared on every (performed)
+         * updateModel() call.
+         * Models, which change their data without calling updateModel() need to
+         * clear the cache themselves.
+         *
+         * \return The statistics cache of this model.
+         */
+        ModelStatistics& statistics() const;
+    
+        /**
+         * Opens a (possibly nested) update transaction. While a transaction is open,
+         * calls of updateModel() are deferred and coalesced into a single update,
+         * which is performed, when the outermost transaction is committed.
+         * Prefer the RAII class ModelTransaction over calling this directly.
+         */
+        void beginTransaction();
+    
+        /**
+         * Commits an update transaction. If this closes the outermost transaction
+         * and updates have been requested meanwhile, updateModel() is called once.
+         */
+        void commitTransaction();
+    
+        /**
+         * Query, if an update transaction is currently open.
+         *
+         * \return True, if updates are currently deferred.
+         */
+        bool inTransaction() const;
+    
         /**
          * Potentially non-const access to the parameters of the model.
          * These can be used to edit the model in a GUI!
@@ -460,6 +635,37 @@ class GRAIPE_CORE_EXPORT Model
 		void modelChanged();
     
     protected:
+        /**
+         * Needs to be called at the beginning of each updateModel() specialization:
+         * If a transaction is open, the update is marked as pending and true is
+         * returned. The specialization shall then return without any further work.
+         *
+         * \return True, if the update has been deferred.
+         */
+        bool deferUpdate();
+    
+        /**
+         * Computation of the local transformation from the geometry parameters.
+         * Subclasses, which have a different geometry, may specialize this.
+         *
+         * \return The local translation matrix of the model.
+         */
+        virtual QTransform computeLocalTransformation() const;
+    
+        /**
+         * Computation of the global transformation from the geometry parameters.
+         * Subclasses, which have a different geometry, may specialize this.
+         *
+         * \return The global translation matrix of the model.
+         */
+        virtual QTransform computeGlobalTransformation() const;
+    
+        /**
+         * Marks the cached transformations as outdated. This is called by
+         * deferUpdate() and thus on every geometry change.
+         */
+        void invalidateTransformations();
+    
         /**
          * @{
          * The single parameters of this model
@@ -481,6 +687,78 @@ class GRAIPE_CORE_EXPORT Model
     private:
         /** keeping track of the locks **/
         QVector<unsigned int> m_locks;
+    
+        /** The cached statistics of the model's data **/
+        mutable ModelStatistics m_statistics;
+    
+        /** The nesting depth of open update transactions **/
+        unsigned int m_transaction_depth;
+    
+        /** Has an update been requested during the open transactions? **/
+        bool m_update_pending;
+    
+        /** The file of the content, which is loaded on demand (empty if loaded) **/
+        mutable QString m_content_file;
+    
+        /**
+         * Recomputes the cached transformations if they are outdated.
+         * Needs to be called with locked m_transform_mutex.
+         */
+        void updateTransformations() const;
+    
+        /** Guards the cached transformations, which may be read from many threads **/
+        mutable QMutex m_transform_mutex;
+    
+        /** Are the cached transformations up to date? **/
+        mutable bool m_transforms_valid;
+    
+        /** The cached transformations and their inverses **/
+        mutable QTransform m_local_transform, m_global_transform,
+                           m_inverse_local_transform, m_inverse_global_transform;
+};
+
+
+/**
+ * RAII helper for batched model updates. Opens an update transaction on
+ * construction and commits it on destruction (or on an explicit commit()).
+ * All updateModel() calls in between are coalesced into a single update,
+ * e.g.:
+ * \code
+   {
+       ModelTransaction transaction(vectorfield);
+       for(...)
+           vectorfield->addVector(orig, dir);
+   } //<- emits modelChanged() once
+   \endcode
+ */
+class GRAIPE_CORE_EXPORT ModelTransaction
+{
+    public:
+        /**
+         * Opens a transaction on a model.
+         *
+         * \param model The model, which will be changed.
+         */
+        ModelTransaction(Model* model);
+    
+        /**
+         * Commits the transaction, if not already done.
+         */
+        ~ModelTransaction();
+    
+        /**
+         * Commits the transaction before the end of the scope.
+         */
+        void commit();
+    
+    private:
+        /** Transactions cannot be copied **/
+        ModelTransaction(const ModelTransaction&);
+        /** Transactions cannot be assigned **/
+        ModelTransaction& operator=(const ModelTransaction&);
+    
+        /** The model of the transaction, NULL after commit **/
+        Model* m_model;
 };
 
 
@@ -567,20 +845,6 @@ class GRAIPE_CORE_EXPORT RasteredModel
          */
         bool isGeoViewable() const;
     
-        /**
-         * Convenience function to get the local transformation in Qt style.
-         *
-         * \return The local translation matrix of the model scaled by the resolution.
-         */
-        QTransform localTransformation() const;
-    
-        /**
-         * Convenience function to get the global transformation in Qt style.
-         *
-         * \return The global translation matrix of the model scaled by the resolution.
-         */
-        QTransform globalTransformation() const;
-        
         /**
          * Const copy model's geometry information to another model.
          *
@@ -595,6 +859,20 @@ class GRAIPE_CORE_EXPORT RasteredModel
         void copyData(Model& other) const;
     
     protected:
+        /**
+         * Computation of the local transformation from the geometry parameters.
+         *
+         * \return The local translation matrix of the model scaled by the resolution.
+         */
+        QTransform computeLocalTransformation() const;
+    
+        /**
+         * Computation of the global transformation from the geometry parameters.
+         *
+         * \return The global translation matrix of the model scaled by the resolution.
+         */
+        QTransform computeGlobalTransformation() const;
+    
         /** The additional parameters of this model: **/
         PointParameter * m_size;
 };
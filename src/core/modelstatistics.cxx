@@ -0,0 +1,197 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#include "core/modelstatistics.hxx"
+
+#include <QStringList>
+#include <QMutexLocker>
+
+#include <stdexcept>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *     @file
+ *     @brief Implementation file for the statistics cache of models
+ * @}
+ */
+
+ModelStatistics::ModelStatistics()
+:   m_generation(0)
+{
+}
+
+bool ModelStatistics::isEmpty() const
+{
+    QMutexLocker locker(&m_mutex);
+    
+    return m_channels.isEmpty();
+}
+
+bool ModelStatistics::contains(const QString& key) const
+{
+    QMutexLocker locker(&m_mutex);
+    
+    return m_channels.contains(key);
+}
+
+ChannelStatistics ModelStatistics::channel(const QString& key) const
+{
+    QMutexLocker locker(&m_mutex);
+    
+    return m_channels.value(key);
+}
+
+void ModelStatistics::insert(const QString& key, const ChannelStatistics& channel)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    m_channels.insert(key, channel);
+}
+
+bool ModelStatistics::insert(const QString& key, const ChannelStatistics& channel, unsigned long generation)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    if(generation != m_generation)
+    {
+        return false;
+    }
+    
+    m_channels.insert(key, channel);
+    return true;
+}
+
+unsigned long ModelStatistics::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    
+    return m_generation;
+}
+
+void ModelStatistics::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    
+    m_channels.clear();
+    ++m_generation;
+}
+
+void ModelStatistics::serialize(QXmlStreamWriter& xmlWriter) const
+{
+    QMutexLocker locker(&m_mutex);
+    
+    xmlWriter.writeStartElement("Statistics");
+    
+    for(QMap<QString, ChannelStatistics>::const_iterator iter = m_channels.constBegin(); iter != m_channels.constEnd(); ++iter)
+    {
+        const ChannelStatistics& channel = iter.value();
+        
+        QStringList bins;
+        for(unsigned long bin : channel.histogram.bins)
+        {
+            bins.append(QString::number(bin));
+        }
+        
+        xmlWriter.writeStartElement("Channel");
+        xmlWriter.writeAttribute("Key",    iter.key());
+        xmlWriter.writeAttribute("Count",  QString::number(channel.histogram.count));
+        xmlWriter.writeAttribute("Min",    QString::number(channel.stats.min, 'g', 17));
+        xmlWriter.writeAttribute("Max",    QString::number(channel.stats.max, 'g', 17));
+        xmlWriter.writeAttribute("Mean",   QString::number(channel.stats.mean, 'g', 17));
+        xmlWriter.writeAttribute("StdDev", QString::number(channel.stats.stddev, 'g', 17));
+            xmlWriter.writeCharacters(bins.join(" "));
+        xmlWriter.writeEndElement();
+    }
+    
+    xmlWriter.writeEndElement();
+}
+
+bool ModelStatistics::deserialize(QXmlStreamReader& xmlReader)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    m_channels.clear();
+    ++m_generation;
+    
+    try
+    {
+        if(xmlReader.name() != "Statistics")
+        {
+            throw std::runtime_error("Did not find Statistics in XML tree");
+        }
+        
+        while(xmlReader.readNextStartElement())
+        {
+            if(xmlReader.name() == "Channel" && xmlReader.attributes().hasAttribute("Key"))
+            {
+                QXmlStreamAttributes attributes = xmlReader.attributes();
+                
+                ChannelStatistics channel;
+                channel.stats.min    = attributes.value("Min").toDouble();
+                channel.stats.max    = attributes.value("Max").toDouble();
+                channel.stats.mean   = attributes.value("Mean").toDouble();
+                channel.stats.stddev = attributes.value("StdDev").toDouble();
+                
+                channel.histogram.min   = channel.stats.min;
+                channel.histogram.max   = channel.stats.max;
+                channel.histogram.count = attributes.value("Count").toULong();
+                
+                for(const QString& bin : xmlReader.readElementText().split(" ", QString::SkipEmptyParts))
+                {
+                    channel.histogram.bins.push_back(bin.toULong());
+                }
+                
+                m_channels.insert(attributes.value("Key").toString(), channel);
+            }
+            else
+            {
+                xmlReader.skipCurrentElement();
+            }
+        }
+    }
+    catch(std::runtime_error & e)
+    {
+        qCritical() << "ModelStatistics::deserialize failed! Error: " << e.what();
+        m_channels.clear();
+        return false;
+    }
+    return true;
+}
+
+} //end of namespace graipe
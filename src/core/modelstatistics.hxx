@@ -0,0 +1,462 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_CORE_MODELSTATISTICS_HXX
+#define GRAIPE_CORE_MODELSTATISTICS_HXX
+
+#include "core/config.hxx"
+#include "core/basicstatistics.hxx"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <QString>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QXmlStreamWriter>
+#include <QXmlStreamReader>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *
+ * @file
+ * @brief Header file for the statistics cache of models
+ */
+
+/**
+ * The statistics of one scalar channel of a model's data, e.g. one image band or
+ * the lengths of all vectors of a vectorfield.
+ */
+struct ChannelStatistics
+{
+    /** Minimum, maximum, mean and standard deviation of the channel **/
+    BasicStatistics<double> stats;
+    /** Histogram of the channel (range: stats.min to stats.max) **/
+    BasicHistogram histogram;
+};
+
+/**
+ * A cache of channel statistics, which is attached to each Model. The statistics
+ * classes of the modules (e.g. ImageStatistics) store their results here under a
+ * unique key per channel. Thus, the statistics are only computed once and not every
+ * time, a view is updated.
+ *
+ * The cache is cleared by the Model on every updateModel() call, i.e. on every
+ * emission of the modelChanged() signal, and it is serialized together with the model.
+ * Since the statistics may be requested by algorithms (in other threads) and views at
+ * the same time, all accesses are guarded by a mutex. Each clearing starts a new
+ * generation of the cache, such that statistics, which have been computed before
+ * the model changed, will not be cached afterwards.
+ */
+class GRAIPE_CORE_EXPORT ModelStatistics
+{
+    public:
+        /**
+         * Default constructor. Creates an empty cache.
+         */
+        ModelStatistics();
+    
+        /**
+         * Returns true, if no statistics are cached.
+         *
+         * \return True, if no statistics are cached.
+         */
+        bool isEmpty() const;
+    
+        /**
+         * Checks if the statistics of a channel are cached.
+         *
+         * \param key The key of the channel.
+         * \return True, if the statistics of the channel are cached.
+         */
+        bool contains(const QString& key) const;
+    
+        /**
+         * Returns the cached statistics of a channel.
+         *
+         * \param key The key of the channel.
+         * \return The cached statistics or empty statistics, if the channel is not cached.
+         */
+        ChannelStatistics channel(const QString& key) const;
+    
+        /**
+         * Returns the statistics of a channel. If these are not cached yet, they
+         * will be computed by means of computeChannelStatistics() and then cached,
+         * unless the cache has been cleared during the computation.
+         *
+         * \param key The key of the channel.
+         * \param accessor An accessor for the channel's values (see computeChannelStatistics()).
+         * \param size The count of values of the channel.
+         * \return The statistics of the channel.
+         */
+        template <class Accessor>
+        ChannelStatistics channel(const QString& key, const Accessor& accessor, std::size_t size);
+    
+        /**
+         * Adds (or replaces) the statistics of a channel to the cache.
+         *
+         * \param key The key of the channel.
+         * \param channel The statistics of the channel.
+         */
+        void insert(const QString& key, const ChannelStatistics& channel);
+    
+        /**
+         * Adds (or replaces) the statistics of a channel to the cache, if the cache
+         * has not been cleared since the given generation.
+         *
+         * \param key The key of the channel.
+         * \param channel The statistics of the channel.
+         * \param generation The generation of the cache, at which the computation started.
+         * \return True, if the statistics have been added to the cache.
+         */
+        bool insert(const QString& key, const ChannelStatistics& channel, unsigned long generation);
+    
+        /**
+         * Returns the current generation of the cache. It is increased on every
+         * clear() and deserialize() call.
+         *
+         * \return The current generation of the cache.
+         */
+        unsigned long generation() const;
+    
+        /**
+         * Removes all cached statistics.
+         */
+        void clear();
+    
+        /**
+         * Serializes the cached statistics to an xml stream:
+         * \verbatim
+           <Statistics>
+               <Channel Key="KEY" Count="N" Min="MIN" Max="MAX" Mean="MEAN" StdDev="STDDEV">BIN_0 ... BIN_K</Channel>
+               ...
+           </Statistics>
+           \endverbatim
+         *
+         * \param xmlWriter The QXmlStreamWriter, on which we write.
+         */
+        void serialize(QXmlStreamWriter& xmlWriter) const;
+    
+        /**
+         * Deserializes the cached statistics from an xml stream. The reader
+         * has to be positioned at the Statistics start element.
+         *
+         * \param  xmlReader The xmlReader, from which we read.
+         * \return True, if the statistics could be restored.
+         */
+        bool deserialize(QXmlStreamReader& xmlReader);
+    
+    private:
+        /** The cache is bound to its model and thus cannot be copied **/
+        ModelStatistics(const ModelStatistics&);
+        /** The cache is bound to its model and thus cannot be assigned **/
+        ModelStatistics& operator=(const ModelStatistics&);
+    
+        /** The statistics of the channels **/
+        QMap<QString, ChannelStatistics> m_channels;
+        /** The generation of the cache **/
+        unsigned long m_generation;
+        /** Guard for all accesses **/
+        mutable QMutex m_mutex;
+};
+
+/**
+ * A task of the parallel computation of channel statistics. Each task processes
+ * one block of the channel. In the first pass, the count, extrema, mean and the
+ * sum of squared differences (Welford's method) are accumulated, in the second
+ * pass, the block's histogram is filled. NaN values are skipped.
+ */
+template <class Accessor>
+class ChannelStatisticsTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor of a task for the first (moments) pass.
+         *
+         * \param accessor The accessor for the channel's values.
+         * \param begin The first index of the block.
+         * \param end The index after the last index of the block.
+         */
+        ChannelStatisticsTask(const Accessor& accessor, std::size_t begin, std::size_t end)
+        :   count(0),
+            min(0),
+            max(0),
+            mean(0),
+            m2(0),
+            m_accessor(accessor),
+            m_begin(begin),
+            m_end(end),
+            m_histogram_pass(false),
+            m_scale(0)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Prepares the task for the second (histogram) pass.
+         *
+         * \param hist_min The lower bound of the histogram.
+         * \param hist_max The upper bound of the histogram.
+         * \param bin_count The count of bins.
+         */
+        void setHistogramPass(double hist_min, double hist_max, unsigned int bin_count)
+        {
+            m_histogram_pass = true;
+            min = hist_min;
+            bins.assign(bin_count, 0);
+            m_scale = (hist_max > hist_min) ? bin_count/(hist_max-hist_min) : 0;
+        }
+    
+        /**
+         * Processes the block, called by the thread pool.
+         */
+        void run()
+        {
+            if(m_histogram_pass)
+            {
+                const unsigned int last_bin = bins.size()-1;
+                
+                for(std::size_t i=m_begin; i<m_end; ++i)
+                {
+                    const double x = m_accessor(i);
+                    
+                    if(x == x)
+                    {
+                        ++bins[std::min(last_bin, (unsigned int)((x-min)*m_scale))];
+                    }
+                }
+            }
+            else
+            {
+                for(std::size_t i=m_begin; i<m_end; ++i)
+                {
+                    const double x = m_accessor(i);
+                    
+                    if(x == x)
+                    {
+                        if(count == 0)
+                        {
+                            min = max = x;
+                        }
+                        else
+                        {
+                            min = std::min(min, x);
+                            max = std::max(max, x);
+                        }
+                        ++count;
+                        
+                        const double d = x - mean;
+                        mean += d/count;
+                        m2   += d*(x - mean);
+                    }
+                }
+            }
+        }
+    
+        /** The count of (non-NaN) values of the block **/
+        unsigned long count;
+        /** The minimum of the block (or the histogram's lower bound) **/
+        double min;
+        /** The maximum of the block **/
+        double max;
+        /** The mean of the block **/
+        double mean;
+        /** The sum of squared differences to the mean of the block **/
+        double m2;
+        /** The histogram bins of the block **/
+        std::vector<unsigned long> bins;
+    
+    private:
+        /** The accessor of the channel **/
+        Accessor m_accessor;
+        /** The block range **/
+        std::size_t m_begin, m_end;
+        /** Which pass is computed **/
+        bool m_histogram_pass;
+        /** The scaling of a value to its bin index **/
+        double m_scale;
+};
+
+/**
+ * Computes the statistics and the histogram of a scalar channel by means of two
+ * parallel passes over the data. The channel is split into blocks, which are processed
+ * by a thread pool. Small channels are processed by the calling thread only.
+ *
+ * \param accessor An accessor for the channel's values. Needs to provide
+ *                 double operator()(std::size_t index) const, which may be called
+ *                 concurrently.
+ * \param size The count of values of the channel.
+ * \param bin_count The count of bins of the histogram.
+ * \return The statistics of the channel.
+ */
+template <class Accessor>
+ChannelStatistics computeChannelStatistics(const Accessor& accessor, std::size_t size, unsigned int bin_count=256)
+{
+    //Blocks of less than 64k values are not worth a thread
+    const std::size_t min_block_size = 1<<16;
+    
+    const std::size_t thread_count = std::max<std::size_t>(1, std::min<std::size_t>(QThread::idealThreadCount(), size/min_block_size)),
+                      block_size = (size + thread_count - 1)/thread_count;
+    
+    std::vector<ChannelStatisticsTask<Accessor>*> tasks;
+    for(std::size_t t=0; t<thread_count; ++t)
+    {
+        tasks.push_back(new ChannelStatisticsTask<Accessor>(accessor, std::min(size, t*block_size), std::min(size, (t+1)*block_size)));
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(thread_count);
+    
+    //First pass: Count, extrema, mean and squared differences
+    for(std::size_t t=1; t<thread_count; ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    //Merge the block results (Chan et al.)
+    unsigned long count = 0;
+    double min = 0, max = 0, mean = 0, m2 = 0;
+    
+    for(ChannelStatisticsTask<Accessor>* task : tasks)
+    {
+        if(task->count == 0)
+        {
+            continue;
+        }
+        if(count == 0)
+        {
+            min = task->min;
+            max = task->max;
+        }
+        else
+        {
+            min = std::min(min, task->min);
+            max = std::max(max, task->max);
+        }
+        
+        const unsigned long new_count = count + task->count;
+        const double d = task->mean - mean;
+        
+        mean += d*task->count/new_count;
+        m2   += task->m2 + d*d*count*task->count/new_count;
+        count = new_count;
+    }
+    
+    ChannelStatistics result;
+    result.stats.min    = min;
+    result.stats.max    = max;
+    result.stats.mean   = mean;
+    result.stats.stddev = count ? std::sqrt(m2/count) : 0.0;
+    
+    result.histogram.min   = min;
+    result.histogram.max   = max;
+    result.histogram.count = count;
+    result.histogram.bins.assign(bin_count, 0);
+    
+    //Second pass: Histogram
+    if(count != 0 && bin_count != 0)
+    {
+        for(ChannelStatisticsTask<Accessor>* task : tasks)
+        {
+            task->setHistogramPass(min, max, bin_count);
+        }
+        for(std::size_t t=1; t<thread_count; ++t)
+        {
+            pool.start(tasks[t]);
+        }
+        tasks[0]->run();
+        pool.waitForDone();
+        
+        for(ChannelStatisticsTask<Accessor>* task : tasks)
+        {
+            for(unsigned int b=0; b<bin_count; ++b)
+            {
+                result.histogram.bins[b] += task->bins[b];
+            }
+        }
+    }
+    
+    for(ChannelStatisticsTask<Accessor>* task : tasks)
+    {
+        delete task;
+    }
+    
+    return result;
+}
+
+template <class Accessor>
+ChannelStatistics ModelStatistics::channel(const QString& key, const Accessor& accessor, std::size_t size)
+{
+    unsigned long generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        QMap<QString, ChannelStatistics>::const_iterator iter = m_channels.constFind(key);
+        
+        if(iter != m_channels.constEnd())
+        {
+            return iter.value();
+        }
+        generation = m_generation;
+    }
+    
+    //Computed without holding the lock, other channels may be accessed meanwhile
+    ChannelStatistics result = computeChannelStatistics(accessor, size);
+    
+    //If the model changed meanwhile, the result may be stale and is not cached
+    insert(key, result, generation);
+    
+    return result;
+}
+
+/**
+ * @}
+ */
+    
+}//end of namespace graipe
+
+#endif //GRAIPE_CORE_MODELSTATISTICS_HXX
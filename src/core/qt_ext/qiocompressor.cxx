@@ -82,6 +82,12 @@
 #include "qiocompressor.hxx"
 #include "zlib.h"
 #include <QtCore/QDebug>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
+#include <vector>
 
 namespace graipe {
 
@@ -99,6 +105,156 @@ typedef Bytef ZlibByte;
 typedef uInt ZlibSize;
 
 
+/** Uncompressed size of the blocks of the BlockGzipFormat **/
+static const int blockGzipSize = 1<<20;
+/** Size of the deflate window, the end of the previous block is used as dictionary **/
+static const int blockGzipDictSize = 1<<15;
+/** Size of the gzip header (no optional fields) **/
+static const int blockGzipHeaderSize = 10;
+/** Size of the gzip trailer (CRC32 and uncompressed size) **/
+static const int blockGzipTrailerSize = 8;
+
+/**
+ * Writes a 16 or 32 bit value in little endian byte order.
+ *
+ * \param data  Pointer to the first byte.
+ * \param value The value.
+ * \param bytes The count of bytes to write.
+ */
+static void writeLittleEndian(char* data, quint32 value, int bytes)
+{
+    for(int i=0; i<bytes; ++i)
+    {
+        data[i] = char((value >> (8*i)) & 0xFF);
+    }
+}
+
+/**
+ * A task, which compresses one block of the BlockGzipFormat to raw deflate data.
+ * All but the last block of a stream end with a sync flush at a byte boundary.
+ * Thus, the results of the tasks can simply be concatenated to one deflate stream.
+ * It is used by the thread pool of the QIOCompressor.
+ */
+class QIOCompressorBlockTask
+:   public QRunnable
+{
+public:
+    /**
+     * Constructor of a compression task.
+     *
+     * \param data Pointer to the uncompressed data of the block.
+     * \param size The size of the uncompressed data.
+     * \param dict Pointer to the uncompressed data preceding the block.
+     * \param dictSize The size of the dictionary (at most 32kB).
+     * \param compressionLevel The compression level.
+     * \param last If true, the block finishes the deflate stream.
+     */
+    QIOCompressorBlockTask(const char* data, int size, const char* dict, int dictSize, int compressionLevel, bool last)
+    :   ok(false),
+        crc(0),
+        size(size),
+        m_data(data),
+        m_dict(dict),
+        m_dictSize(dictSize),
+        m_compressionLevel(compressionLevel),
+        m_last(last)
+    {
+        setAutoDelete(false);
+    }
+    
+    /**
+     * Compresses the block, called by the thread pool.
+     */
+    void run()
+    {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        
+        //Raw deflate, since the gzip header and trailer are written by the QIOCompressor
+        if(deflateInit2(&stream, m_compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return;
+        
+        //Continue the window of the previous block, like a single stream would do
+        if(     m_dictSize != 0
+            &&  deflateSetDictionary(&stream, reinterpret_cast<const ZlibByte *>(m_dict), m_dictSize) != Z_OK)
+        {
+            deflateEnd(&stream);
+            return;
+        }
+        
+        //deflateBound() covers Z_FINISH, each flush may add up to six bytes
+        const uLong bound = deflateBound(&stream, size) + 16;
+        output.resize(bound);
+        
+        stream.next_in   = reinterpret_cast<ZlibByte *>(const_cast<char *>(m_data));
+        stream.avail_in  = size;
+        stream.next_out  = reinterpret_cast<ZlibByte *>(output.data());
+        stream.avail_out = bound;
+        
+        const int status = deflate(&stream, m_last ? Z_FINISH : Z_SYNC_FLUSH);
+        
+        ok = m_last ?  status == Z_STREAM_END
+                    : (status == Z_OK && stream.avail_in == 0 && stream.avail_out != 0);
+        
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        
+        crc = crc32(0L, reinterpret_cast<const ZlibByte *>(m_data), size);
+    }
+    
+    /** Successfully processed? **/
+    bool ok;
+    /** The CRC32 of the uncompressed data **/
+    quint32 crc;
+    /** The size of the uncompressed data **/
+    const int size;
+    /** The compressed data **/
+    QByteArray output;
+    
+private:
+    /** The uncompressed data **/
+    const char* m_data;
+    /** The dictionary **/
+    const char* m_dict;
+    /** The size of the dictionary **/
+    int m_dictSize;
+    /** The compression level **/
+    int m_compressionLevel;
+    /** Is this the last block of the stream? **/
+    bool m_last;
+};
+
+/**
+ * Runs block tasks in parallel. The first task is processed by the calling thread.
+ *
+ * \param tasks The tasks.
+ * \return True, if all tasks were successful.
+ */
+static bool runBlockTasks(const std::vector<QIOCompressorBlockTask*>& tasks)
+{
+    if(tasks.empty())
+        return true;
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::max<int>(1, tasks.size()-1));
+    
+    for(unsigned int t=1; t<tasks.size(); ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    for(QIOCompressorBlockTask* task : tasks)
+    {
+        if(!task->ok)
+            return false;
+    }
+    return true;
+}
+
 /**
  * Pirvate/Hidden implementation of the QIOCompressor's internal magic
  */
@@ -159,6 +315,24 @@ public:
      * \param zlibErrorCode The zlib Error Code
      */
     void setZlibError(const QString &errorMessage, int zlibErrorCode);
+    
+    /**
+     * Compresses the pending data in parallel and appends the resulting deflate
+     * data to the gzip member on the underlying device (BlockGzipFormat only).
+     * The gzip header is written before the first block.
+     *
+     * \param all If true, the last (incomplete) block is written, too.
+     * \param finish If true, the deflate stream is finished and the gzip trailer is written.
+     * \return True, if successful, else false.
+     */
+    bool writeBlocks(bool all, bool finish=false);
+    
+    /**
+     * Prepares the next member of a multi-member gzip stream, if there is any.
+     *
+     * \return True, if there is more input after the end of the current member.
+     */
+    bool nextGzipMember();
 
     /**
      * @{ 
@@ -172,6 +346,11 @@ public:
     ZlibByte *buffer;
     State state;
     QIOCompressor::StreamFormat streamFormat;
+    QByteArray blockData;
+    QByteArray blockDictionary;
+    quint32 blockCrc;
+    quint32 blockTotalSize;
+    bool blockHeaderWritten;
     /**
      * @}
      */
@@ -185,6 +364,9 @@ QIOCompressorPrivate::QIOCompressorPrivate(QIOCompressor *q_ptr, QIODevice *devi
 ,buffer(new ZlibByte[bufferSize])
 ,state(Closed)
 ,streamFormat(QIOCompressor::ZlibFormat)
+,blockCrc(0)
+,blockTotalSize(0)
+,blockHeaderWritten(false)
 {
     // Use default zlib memory management.
     zlibStream.zalloc = Z_NULL;
@@ -262,6 +444,93 @@ void QIOCompressorPrivate::setZlibError(const QString &errorMessage, int zlibErr
     q->setErrorString(errorString);
 }
 
+bool QIOCompressorPrivate::writeBlocks(bool all, bool finish)
+{
+    Q_Q(QIOCompressor);
+    
+    // All blocks form a single gzip member, which starts with the header.
+    if (!blockHeaderWritten) {
+        char header[blockGzipHeaderSize];
+        header[0] = char(0x1f); header[1] = char(0x8b); header[2] = Z_DEFLATED; header[3] = 0; //no flags
+        writeLittleEndian(header+4, 0, 4);  //MTIME
+        header[8] = 0; header[9] = char(255); //XFL, OS (unknown)
+        
+        if (!writeBytes(reinterpret_cast<ZlibByte *>(header), blockGzipHeaderSize))
+            return false;
+        blockHeaderWritten = true;
+    }
+    
+    int block_count = all ? (blockData.size() + blockGzipSize - 1)/blockGzipSize
+                          :  blockData.size()/blockGzipSize;
+    
+    // The last (maybe empty) block finishes the deflate stream.
+    if (finish)
+        block_count = std::max(block_count, 1);
+    
+    std::vector<QIOCompressorBlockTask*> tasks;
+    for(int b=0; b<block_count; ++b)
+    {
+        const int begin = b*blockGzipSize;
+        const char* dict = (b == 0) ? blockDictionary.constData() : blockData.constData() + begin - blockGzipDictSize;
+        const int dict_size = (b == 0) ? blockDictionary.size() : blockGzipDictSize;
+        
+        tasks.push_back(new QIOCompressorBlockTask(blockData.constData() + begin,
+                                                   std::min(blockGzipSize, blockData.size() - begin),
+                                                   dict, dict_size,
+                                                   compressionLevel,
+                                                   finish && b == block_count-1));
+    }
+    
+    bool res = runBlockTasks(tasks);
+    
+    if (!res) {
+        state = QIOCompressorPrivate::Error;
+        q->setErrorString(QT_TRANSLATE_NOOP("QIOCompressor", "Internal zlib error when compressing blocks"));
+    }
+    
+    for(QIOCompressorBlockTask* task : tasks)
+    {
+        if (res) {
+            res = writeBytes(reinterpret_cast<ZlibByte *>(task->output.data()), task->output.size());
+            blockCrc = crc32_combine(blockCrc, task->crc, task->size);
+            blockTotalSize += task->size;
+        }
+        delete task;
+    }
+    
+    // Keep the end of the written data as dictionary for the next block.
+    const int written = std::min(blockData.size(), block_count*blockGzipSize);
+    if (written != 0) {
+        blockDictionary = (blockDictionary + blockData.left(written)).right(blockGzipDictSize);
+        blockData.remove(0, written);
+    }
+    
+    if (res && finish) {
+        char trailer[blockGzipTrailerSize];
+        writeLittleEndian(trailer,   blockCrc, 4);
+        writeLittleEndian(trailer+4, blockTotalSize, 4); //modulo 2^32
+        
+        res = writeBytes(reinterpret_cast<ZlibByte *>(trailer), blockGzipTrailerSize);
+    }
+    return res;
+}
+
+bool QIOCompressorPrivate::nextGzipMember()
+{
+    if (streamFormat != QIOCompressor::GzipFormat && streamFormat != QIOCompressor::BlockGzipFormat)
+        return false;
+    
+    if (zlibStream.avail_in == 0) {
+        const qint64 bytesAvalible = device->read(reinterpret_cast<char *>(buffer), bufferSize);
+        if (bytesAvalible <= 0)
+            return false;
+        
+        zlibStream.next_in = buffer;
+        zlibStream.avail_in = bytesAvalible;
+    }
+    return inflateReset(&zlibStream) == Z_OK;
+}
+
 
 
 
@@ -307,6 +576,11 @@ bool QIOCompressor::isGzipSupported()
     return checkGzipSupport(zlibVersion());
 }
 
+int QIOCompressor::blockSize()
+{
+    return blockGzipSize;
+}
+
 
 bool QIOCompressor::isSequential() const
 {
@@ -363,6 +637,7 @@ bool QIOCompressor::open(OpenMode mode)
     int windowBits;
     switch (d->streamFormat) {
     case QIOCompressor::GzipFormat:
+    case QIOCompressor::BlockGzipFormat:
         windowBits = 31;
         break;
     case QIOCompressor::RawZipFormat:
@@ -373,6 +648,12 @@ bool QIOCompressor::open(OpenMode mode)
     }
 
     int status;
+    d->blockData.clear();
+    d->blockDictionary.clear();
+    d->blockCrc = crc32(0L, Z_NULL, 0);
+    d->blockTotalSize = 0;
+    d->blockHeaderWritten = false;
+    
     if (read) {
         d->state = QIOCompressorPrivate::NotReadFirstByte;
         d->zlibStream.avail_in = 0;
@@ -389,7 +670,10 @@ bool QIOCompressor::open(OpenMode mode)
         }
     } else {
         d->state = QIOCompressorPrivate::NoBytesWritten;
-        if (d->streamFormat == QIOCompressor::ZlibFormat)
+        // Blocks are compressed by independent streams.
+        if (d->streamFormat == QIOCompressor::BlockGzipFormat)
+            status = Z_OK;
+        else if (d->streamFormat == QIOCompressor::ZlibFormat)
             status = deflateInit(&d->zlibStream, d->compressionLevel);
         else
             status = deflateInit2(&d->zlibStream, d->compressionLevel, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
@@ -413,6 +697,13 @@ void QIOCompressor::close()
     if (openMode() & ReadOnly) {
         d->state = QIOCompressorPrivate::NotReadFirstByte;
         inflateEnd(&d->zlibStream);
+    } else if (d->streamFormat == QIOCompressor::BlockGzipFormat) {
+        if (d->state == QIOCompressorPrivate::BytesWritten) {
+            d->state = QIOCompressorPrivate::NoBytesWritten;
+            d->writeBlocks(true, true);
+        }
+        d->blockData.clear();
+        d->blockDictionary.clear();
     } else {
         if (d->state == QIOCompressorPrivate::BytesWritten) { // Only flush if we have written anything.
             d->state = QIOCompressorPrivate::NoBytesWritten;
@@ -435,7 +726,10 @@ void QIOCompressor::flush()
     if (isOpen() == false || openMode() & ReadOnly)
         return;
 
-    d->flushZlib(Z_SYNC_FLUSH);
+    if (d->streamFormat == QIOCompressor::BlockGzipFormat)
+        d->writeBlocks(true);
+    else
+        d->flushZlib(Z_SYNC_FLUSH);
 }
 
 qint64 QIOCompressor::bytesAvailable() const
@@ -518,6 +812,10 @@ qint64 QIOCompressor::readData(char *data, qint64 maxSize)
             case Z_BUF_ERROR: // No more input and zlib can not privide more output - Not an error, we can try to read again when we have more input.
                 return 0;
             break;
+            case Z_STREAM_END: // Concatenated gzip streams are continued with their next member.
+                if (d->nextGzipMember())
+                    status = Z_OK;
+            break;
         }
     // Loop util data buffer is full or we reach the end of the input stream.
     } while (d->zlibStream.avail_out != 0 && status != Z_STREAM_END);
@@ -539,6 +837,21 @@ qint64 QIOCompressor::writeData(const char *data, qint64 maxSize)
     if (maxSize < 1)
         return 0;
     Q_D(QIOCompressor);
+    
+    if (d->state == QIOCompressorPrivate::Error)
+        return -1;
+
+    // Collect the data, until there is one block for each core.
+    if (d->streamFormat == QIOCompressor::BlockGzipFormat) {
+        d->blockData.append(data, maxSize);
+        d->state = QIOCompressorPrivate::BytesWritten;
+        
+        if (d->blockData.size() >= blockGzipSize*QThread::idealThreadCount() && !d->writeBlocks(false))
+            return -1;
+        
+        return maxSize;
+    }
+    
     d->zlibStream.next_in = reinterpret_cast<ZlibByte *>(const_cast<char *>(data));
     d->zlibStream.avail_in = maxSize;
 
@@ -157,13 +157,23 @@ public:
         setting this format, by itself, does not let QIOCompressor read
         or write ZIP files. Ref. the ziplist example program.
 
+        BlockGzipFormat: This format writes standard gzip streams, which
+        consist of a single member. The data is split into blocks of
+        blockSize() bytes, which are deflated in parallel by all cores.
+        Each block uses the end of the previous block as dictionary and all
+        but the last block end with a sync flush, thus the compressed blocks
+        are simply concatenated. The CRC32 of the member is combined from
+        the checksums of the blocks. Reading is the same as for the
+        GzipFormat.
+
         \sa setStreamFormat()
     */
     enum StreamFormat
     {
         ZlibFormat,
         GzipFormat,
-        RawZipFormat
+        RawZipFormat,
+        BlockGzipFormat
     };
     
     /*!
@@ -200,6 +210,11 @@ public:
     */
     static bool isGzipSupported();
     
+    /*!
+        Returns the count of uncompressed bytes per block of the BlockGzipFormat.
+    */
+    static int blockSize();
+    
     /*!
         Is always true, since we compress linearly.
     */
@@ -0,0 +1,271 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#include "core/spatialindex.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *     @file
+ *     @brief Implementation file for the spatial index and screen-space aggregation of views
+ * @}
+ */
+
+/** The maximal number of cells of the grid along one axis **/
+static const unsigned int max_index_cells_per_axis = 4096;
+
+/** The maximal number of cells of a screen-space aggregation **/
+static const unsigned int max_aggregation_cells = 1 << 22;
+
+SpatialIndex2D::SpatialIndex2D()
+: m_cell_size(1),
+  m_cols(0),
+  m_rows(0)
+{
+}
+
+void SpatialIndex2D::clear()
+{
+    m_bounds.clear();
+    m_extent = QRectF();
+    m_cell_size = 1;
+    m_cols = m_rows = 0;
+    m_cell_start.clear();
+    m_cell_items.clear();
+}
+
+bool SpatialIndex2D::isEmpty() const
+{
+    return m_bounds.empty();
+}
+
+unsigned int SpatialIndex2D::size() const
+{
+    return (unsigned int)m_bounds.size();
+}
+
+unsigned int SpatialIndex2D::cell(qreal value, qreal origin, unsigned int count) const
+{
+    qreal c = (value - origin)/m_cell_size;
+    
+    if(c <= 0)
+        return 0;
+    if(c >= count)
+        return count-1;
+    return (unsigned int)c;
+}
+
+void SpatialIndex2D::build(const std::vector<QRectF>& bounds, unsigned int items_per_cell)
+{
+    clear();
+    
+    if(bounds.empty())
+        return;
+    
+    //Normalize the bounds and find the extent of all items
+    m_bounds.resize(bounds.size());
+    
+    qreal   left   =  std::numeric_limits<qreal>::max(),
+            top    =  std::numeric_limits<qreal>::max(),
+            right  = -std::numeric_limits<qreal>::max(),
+            bottom = -std::numeric_limits<qreal>::max();
+    
+    for(unsigned int i=0; i<bounds.size(); ++i)
+    {
+        const QRectF r = bounds[i].normalized();
+        m_bounds[i] = r;
+        
+        left   = std::min(left,   r.left());
+        top    = std::min(top,    r.top());
+        right  = std::max(right,  r.right());
+        bottom = std::max(bottom, r.bottom());
+    }
+    m_extent = QRectF(QPointF(left, top), QPointF(right, bottom));
+    
+    //Choose the cell size w.r.t. the desired count of items per cell
+    unsigned int target_cells = std::max(1u, (unsigned int)(m_bounds.size()/std::max(1u, items_per_cell)));
+    
+    qreal   w = m_extent.width(),
+            h = m_extent.height(),
+            e = std::max(w, h);
+    
+    if(e > 0)
+    {
+        //Avoid degenerated cells for line-shaped extents
+        qreal   cw = std::max(w, e/target_cells),
+                ch = std::max(h, e/target_cells);
+        m_cell_size = std::sqrt(cw*ch/target_cells);
+    }
+    
+    m_cols = std::min(max_index_cells_per_axis, (unsigned int)(w/m_cell_size) + 1);
+    m_rows = std::min(max_index_cells_per_axis, (unsigned int)(h/m_cell_size) + 1);
+    
+    //Count the items per cell
+    m_cell_start.assign(m_cols*m_rows + 1, 0);
+    
+    for(const QRectF& r : m_bounds)
+    {
+        unsigned int    x0 = cell(r.left(),   left, m_cols), x1 = cell(r.right(),  left, m_cols),
+                        y0 = cell(r.top(),    top,  m_rows), y1 = cell(r.bottom(), top,  m_rows);
+        
+        for(unsigned int y=y0; y<=y1; ++y)
+        {
+            for(unsigned int x=x0; x<=x1; ++x)
+            {
+                ++m_cell_start[y*m_cols + x + 1];
+            }
+        }
+    }
+    
+    for(unsigned int c=1; c<m_cell_start.size(); ++c)
+    {
+        m_cell_start[c] += m_cell_start[c-1];
+    }
+    
+    //Distribute the items into the cells
+    m_cell_items.resize(m_cell_start.back());
+    std::vector<unsigned int> cell_pos(m_cell_start.begin(), m_cell_start.end()-1);
+    
+    for(unsigned int i=0; i<m_bounds.size(); ++i)
+    {
+        const QRectF& r = m_bounds[i];
+        
+        unsigned int    x0 = cell(r.left(),   left, m_cols), x1 = cell(r.right(),  left, m_cols),
+                        y0 = cell(r.top(),    top,  m_rows), y1 = cell(r.bottom(), top,  m_rows);
+        
+        for(unsigned int y=y0; y<=y1; ++y)
+        {
+            for(unsigned int x=x0; x<=x1; ++x)
+            {
+                m_cell_items[cell_pos[y*m_cols + x]++] = i;
+            }
+        }
+    }
+}
+
+void SpatialIndex2D::query(const QRectF& rect, std::vector<unsigned int>& result) const
+{
+    result.clear();
+    
+    if(isEmpty())
+        return;
+    
+    const QRectF r = rect.normalized();
+    
+    if(     r.right()  < m_extent.left()  || r.left() > m_extent.right()
+        ||  r.bottom() < m_extent.top()   || r.top()  > m_extent.bottom())
+    {
+        return;
+    }
+    
+    unsigned int    x0 = cell(r.left(),   m_extent.left(), m_cols), x1 = cell(r.right(),  m_extent.left(), m_cols),
+                    y0 = cell(r.top(),    m_extent.top(),  m_rows), y1 = cell(r.bottom(), m_extent.top(),  m_rows);
+    
+    for(unsigned int y=y0; y<=y1; ++y)
+    {
+        for(unsigned int x=x0; x<=x1; ++x)
+        {
+            unsigned int c = y*m_cols + x;
+            
+            for(unsigned int k=m_cell_start[c]; k<m_cell_start[c+1]; ++k)
+            {
+                const QRectF& b = m_bounds[m_cell_items[k]];
+                
+                //Inclusive test, since points have empty bounds
+                if(     b.left() <= r.right()  && b.right()  >= r.left()
+                    &&  b.top()  <= r.bottom() && b.bottom() >= r.top())
+                {
+                    result.push_back(m_cell_items[k]);
+                }
+            }
+        }
+    }
+    
+    //Items covering more than one cell may have been found more than once
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+
+
+
+ScreenSpaceAggregator::ScreenSpaceAggregator(const QRectF& rect, qreal cell_size)
+: m_rect(rect.normalized()),
+  m_cell_size(cell_size),
+  m_cols(0),
+  m_rows(0)
+{
+    if(m_cell_size <= 0 || m_rect.isEmpty())
+        return;
+    
+    qreal cells = std::ceil(m_rect.width()/m_cell_size) * std::ceil(m_rect.height()/m_cell_size);
+    
+    //Coarsen the cells, if the rectangle would need too many of them
+    if(cells > max_aggregation_cells)
+    {
+        m_cell_size *= std::sqrt(cells/max_aggregation_cells);
+    }
+    
+    m_cols = (unsigned int)std::ceil(m_rect.width()/m_cell_size) + 1;
+    m_rows = (unsigned int)std::ceil(m_rect.height()/m_cell_size) + 1;
+    m_occupied.assign(m_cols*m_rows, false);
+}
+
+bool ScreenSpaceAggregator::accept(const QPointF& p)
+{
+    //Items outside of the rectangle are not aggregated
+    if(m_occupied.empty() || !m_rect.contains(p))
+        return true;
+    
+    unsigned int    x = std::min(m_cols-1, (unsigned int)((p.x() - m_rect.left())/m_cell_size)),
+                    y = std::min(m_rows-1, (unsigned int)((p.y() - m_rect.top())/m_cell_size));
+    
+    std::vector<bool>::reference occupied = m_occupied[y*m_cols + x];
+    
+    if(occupied)
+        return false;
+    
+    occupied = true;
+    return true;
+}
+
+} //end of namespace graipe
@@ -0,0 +1,178 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_CORE_SPATIALINDEX_HXX
+#define GRAIPE_CORE_SPATIALINDEX_HXX
+
+#include "core/config.hxx"
+
+#include <vector>
+
+#include <QRectF>
+#include <QPointF>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_core
+ * @{
+ *
+ * @file
+ * @brief Header file for the spatial index and screen-space aggregation of views
+ */
+
+/**
+ * A uniform grid index over the bounding rectangles of many items, e.g. the
+ * vectors of a vectorfield or the features of a feature list. It is used by
+ * the ViewControllers to restrict the painting to the items, which intersect
+ * the currently exposed rectangle. Items, which cover more than one cell, are
+ * referenced by every cell they cover.
+ */
+class GRAIPE_CORE_EXPORT SpatialIndex2D
+{
+    public:
+        /**
+         * Default constructor. Creates an empty index.
+         */
+        SpatialIndex2D();
+    
+        /**
+         * Removes all items from the index.
+         */
+        void clear();
+    
+        /**
+         * Returns true, if the index does not contain any items.
+         *
+         * \return True, if the index is empty.
+         */
+        bool isEmpty() const;
+    
+        /**
+         * The number of indexed items.
+         *
+         * \return The number of indexed items.
+         */
+        unsigned int size() const;
+    
+        /**
+         * (Re-)Builds the index for the given item bounds. The cell size is
+         * chosen such that each cell contains a few items on average.
+         *
+         * \param bounds The bounding rectangle of each item. Items may be points,
+         *               i.e. have an empty size.
+         * \param items_per_cell The average number of items per cell.
+         */
+        void build(const std::vector<QRectF>& bounds, unsigned int items_per_cell=4);
+    
+        /**
+         * Finds all items, whose bounds intersect (or touch) a given rectangle.
+         *
+         * \param rect The query rectangle.
+         * \param result Will be filled with the ascending indices of all found items.
+         */
+        void query(const QRectF& rect, std::vector<unsigned int>& result) const;
+    
+    private:
+        /**
+         * Computes the cell coordinate of a position along one axis.
+         *
+         * \param value The position.
+         * \param origin The origin of the grid along this axis.
+         * \param count The number of cells along this axis.
+         * \return The clamped cell coordinate.
+         */
+        unsigned int cell(qreal value, qreal origin, unsigned int count) const;
+    
+        /** The bounds of all items **/
+        std::vector<QRectF> m_bounds;
+        /** The united bounds of all items **/
+        QRectF m_extent;
+        /** The edge length of a cell **/
+        qreal m_cell_size;
+        /** The number of columns and rows of the grid **/
+        unsigned int m_cols, m_rows;
+        /** Start offset of each cell in m_cell_items (one more than cells) **/
+        std::vector<unsigned int> m_cell_start;
+        /** The item indices of all cells **/
+        std::vector<unsigned int> m_cell_items;
+};
+
+/**
+ * A screen-space aggregation of items for level of detail painting. The exposed
+ * rectangle is divided into cells of the size of one device pixel, and only the
+ * first item, which falls into each cell, is accepted for painting. Thus, the
+ * count of painted items never exceeds the count of visible pixels, even if
+ * millions of items are shown at a low zoom level.
+ */
+class GRAIPE_CORE_EXPORT ScreenSpaceAggregator
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param rect The exposed rectangle in item coordinates.
+         * \param cell_size The size of one cell (e.g. a device pixel) in item coordinates.
+         */
+        ScreenSpaceAggregator(const QRectF& rect, qreal cell_size);
+    
+        /**
+         * Tests if an item at a given position shall be painted. This is the case,
+         * if no other item has been accepted for the same cell before.
+         *
+         * \param p The position of the item.
+         * \return True, if the item shall be painted.
+         */
+        bool accept(const QPointF& p);
+    
+    private:
+        /** The exposed rectangle **/
+        QRectF m_rect;
+        /** The edge length of a cell **/
+        qreal m_cell_size;
+        /** The number of columns and rows **/
+        unsigned int m_cols, m_rows;
+        /** The occupancy of each cell **/
+        std::vector<bool> m_occupied;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_CORE_SPATIALINDEX_HXX
@@ -42,6 +42,7 @@
 #include <QGraphicsObject>
 #include <QGraphicsScene>
 #include <QGraphicsSceneHoverEvent>
+#include <QStyleOptionGraphicsItem>
 
 namespace graipe {
 
@@ -95,6 +96,9 @@ ViewController::ViewController(Model * model)
 	connect(m_parameters, SIGNAL(valueChanged()), this,	SLOT(updateView()));
 	connect(m_model,      SIGNAL(modelChanged()), this, SLOT(updateView()));
     
+    //Provide the exposed rectangle at each paint call
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    
     //Add to global viewControllers list
     model->workspace()->viewControllers.push_back(this);
 }
@@ -262,6 +266,20 @@ void ViewController::paintAfter(QPainter *painter, const QStyleOptionGraphicsIte
 	}
 }
 
+QRectF ViewController::exposedRect(const QStyleOptionGraphicsItem * option) const
+{
+    if(option == NULL || option->exposedRect.isEmpty())
+    {
+        return boundingRect();
+    }
+    return option->exposedRect;
+}
+
+qreal ViewController::levelOfDetail(const QPainter * painter)
+{
+    return QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+}
+
 void ViewController::hoverMoveEvent(QGraphicsSceneHoverEvent * event)
 {	
 	QGraphicsItem::hoverMoveEvent(event);
@@ -299,6 +317,9 @@ void ViewController::updateView()
 	}
 	
 	m_axis_grid_pen = QPen(m_axisLineColor->value(), m_axisLineWidth->value(),(Qt::PenStyle)m_axisGridStyle->value());
+    
+    //Invalidates the pixmap cache of the ViewController (if enabled)
+    update();
 }
 
 void ViewController::updateParameters(bool /*force_update*/)
@@ -83,6 +83,7 @@ class GRAIPE_CORE_EXPORT ViewController
 	public:
         /**
          * Default constructor of the ViewController class.
+         * The content of the model needs to be loaded (see Model::loadContent()).
          *
          * \param model  The model, which shall be displayed by means of this view
          */
@@ -249,6 +250,26 @@ class GRAIPE_CORE_EXPORT ViewController
 		void updateStatusDescription(QString);
 		
 	protected:
+        /**
+         * The rectangle, which needs to be repainted, in item coordinates. This is the
+         * exposed rectangle of the style option, since each ViewController uses the
+         * extended style option. Use it to skip the painting of invisible items.
+         *
+         * \param option The style options of the current paint call.
+         * \return The exposed rectangle or the bounding rectangle, if nothing was exposed.
+         */
+        QRectF exposedRect(const QStyleOptionGraphicsItem * option) const;
+    
+        /**
+         * The level of detail of the current paint call, i.e. the number of
+         * device pixels per item unit. Use it to aggregate items, which
+         * would fall into the same device pixel.
+         *
+         * \param painter The painter of the current paint call.
+         * \return The level of detail of the painter's world transform.
+         */
+        static qreal levelOfDetail(const QPainter * painter);
+    
         /** The model (not owned by the ViewController) **/
         Model * m_model;
         
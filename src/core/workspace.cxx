@@ -37,8 +37,11 @@
 #include "core/impex.hxx"
 #include "core/module.hxx"
 
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QLibrary>
+#include <QFileInfo>
+#include <QSet>
 
 namespace graipe {
 
@@ -51,6 +54,55 @@ namespace graipe {
  * @}
  */
 
+/**
+ * Copies the serialization of a ViewController from an XML reader to an XML writer.
+ * The reader may be located at the ViewController's start element or before.
+ *
+ * \param xmlReader The XML reader.
+ * \param xmlWriter The XML writer.
+ * \param model_id  If not empty, the reference to the ViewController's Model is replaced by this ID.
+ */
+static void copyViewController(QXmlStreamReader& xmlReader, QXmlStreamWriter& xmlWriter, const QString& model_id = QString())
+{
+    int depth = 0;
+    
+    while(!xmlReader.atEnd() && !xmlReader.hasError())
+    {
+        if(xmlReader.isStartElement())
+        {
+            if(depth == 0 && !model_id.isEmpty())
+            {
+                xmlWriter.writeStartElement(xmlReader.name().toString());
+                
+                for(const QXmlStreamAttribute& attribute : xmlReader.attributes())
+                {
+                    xmlWriter.writeAttribute(attribute.name().toString(),
+                                             attribute.name() == "ModelID" ? model_id : attribute.value().toString());
+                }
+            }
+            else
+            {
+                xmlWriter.writeCurrentToken(xmlReader);
+            }
+            ++depth;
+        }
+        else if(xmlReader.isEndElement())
+        {
+            xmlWriter.writeCurrentToken(xmlReader);
+            
+            if(--depth == 0)
+            {
+                break;
+            }
+        }
+        else if(depth > 0)
+        {
+            xmlWriter.writeCurrentToken(xmlReader);
+        }
+        xmlReader.readNext();
+    }
+}
+
 Workspace::Workspace()
 : m_currentModel(NULL),
   m_currentViewController(NULL)
@@ -170,6 +222,12 @@ bool Workspace::deserialize(QXmlStreamReader& xmlReader)
                                                             throw "did not load model!";
                                                         }
                                                         
+                                                        //Content file references are relative to the content dir
+                                                        if(!m->isContentLoaded())
+                                                        {
+                                                            m->setContentFile(QDir(m_content_dir).absoluteFilePath(m->contentFile()));
+                                                        }
+                                                        
                                                         if(m->id() == p_currentModel->value())
                                                         {
                                                             m_currentModel = m;
@@ -196,7 +254,37 @@ bool Workspace::deserialize(QXmlStreamReader& xmlReader)
                                                         {
                                                             for(int i=0; i!=p_viewControllers->value(); i++)
                                                             {
-                                                                ViewController* vc = loadViewController(xmlReader);
+                                                                if(!xmlReader.readNextStartElement())
+                                                                {
+                                                                    throw "did not load viewController!";
+                                                                }
+                                                                
+                                                                QString vc_modelID = xmlReader.attributes().value("ModelID").toString();
+                                                                
+                                                                QByteArray vc_data;
+                                                                QXmlStreamWriter vc_writer(&vc_data);
+                                                                copyViewController(xmlReader, vc_writer);
+                                                                
+                                                                //ViewControllers need the content of their Model, thus they are
+                                                                //created after it has been loaded (see restorePendingViewControllers)
+                                                                Model* vc_model = NULL;
+                                                                for(Model* m : models)
+                                                                {
+                                                                    if(m->id() == vc_modelID)
+                                                                    {
+                                                                        vc_model = m;
+                                                                        break;
+                                                                    }
+                                                                }
+                                                                
+                                                                if(vc_model != NULL && !vc_model->isContentLoaded())
+                                                                {
+                                                                    pendingViewControllers.push_back(std::make_pair(vc_model, vc_data));
+                                                                    continue;
+                                                                }
+                                                                
+                                                                QXmlStreamReader vc_reader(vc_data);
+                                                                ViewController* vc = loadViewController(vc_reader);
                                                                 if(vc == NULL)
                                                                 {
                                                                     throw "did not load viewController!";
@@ -235,18 +323,62 @@ bool Workspace::deserialize(QXmlStreamReader& xmlReader)
 
 void Workspace::serialize(QXmlStreamWriter& xmlWriter) const
 {
+    serialize(xmlWriter, snapshot());
+}
+
+WorkspaceSnapshot Workspace::snapshot() const
+{
+    WorkspaceSnapshot snapshot;
+    
+    //Transform memory address to ID for models and viewControllers:
+    for(Model* model : models)
+    {
+        model->setID(QString::number(reinterpret_cast<long long>(model)));
+    }
+    for(ViewController* vc : viewControllers)
+    {
+        vc->setID(QString::number(reinterpret_cast<long long>(vc)));
+    }
+    
+    snapshot.models = models;
+    
+    //The content files may be dropped by loading the models during the save
+    for(Model* model : models)
+    {
+        snapshot.contentFiles.push_back(model->contentFile());
+    }
+    snapshot.viewControllerCount = (unsigned int)(viewControllers.size() + pendingViewControllers.size());
+    snapshot.currentModel = (m_currentModel == NULL) ? "0" : m_currentModel->id();
+    snapshot.currentViewController = (m_currentViewController == NULL) ? "0" : m_currentViewController->id();
+    
+    //The ViewControllers are small, but belong to the GUI: serialize them right now
+    QBuffer buffer(&snapshot.viewControllers);
+    buffer.open(QIODevice::WriteOnly);
+    
+    QXmlStreamWriter xmlWriter(&buffer);
+    xmlWriter.writeStartElement("ViewControllers");
+    for(ViewController* vc : viewControllers)
+    {
+        vc->serialize(xmlWriter);
+    }
+    //The pending ViewControllers refer to their Models by the new IDs
+    for(const std::pair<Model*, QByteArray>& pending : pendingViewControllers)
+    {
+        QXmlStreamReader vc_reader(pending.second);
+        copyViewController(vc_reader, xmlWriter, pending.first->id());
+    }
+    xmlWriter.writeEndElement();
+    
+    return snapshot;
+}
+
+void Workspace::serialize(QXmlStreamWriter& xmlWriter, const WorkspaceSnapshot& snapshot) const
+{
+    //Only the Models of the snapshot are serialized, not the current ones
+    const std::vector<Model*>& models = snapshot.models;
+    
     try
     {
-        //Transform memory address to ID for models and viewControllers:
-        for(Model* model : models)
-        {
-            model->setID(QString::number(reinterpret_cast<long long>(model)));
-        }
-        for(ViewController* vc : viewControllers)
-        {
-            vc->setID(QString::number(reinterpret_cast<long long>(vc)));
-        }
-        
         xmlWriter.setAutoFormatting(true);
         xmlWriter.writeStartDocument();
             
@@ -257,11 +389,11 @@ void Workspace::serialize(QXmlStreamWriter& xmlWriter) const
                 ParameterGroup w_settings;
                 w_settings.addParameter("modules", new IntParameter("Module count:", 0, 1e10, (int)modules_names().size()));
                 w_settings.addParameter("models", new IntParameter("Model count:",   0 ,1e10, (int)models.size()));
-                w_settings.addParameter("viewControllers", new IntParameter("ViewController count:", 0, 1e10, (int)viewControllers.size()));
+                w_settings.addParameter("viewControllers", new IntParameter("ViewController count:", 0, 1e10, (int)snapshot.viewControllerCount));
                 w_settings.addParameter("currentModel",
-                                        new StringParameter("Current Model:", (m_currentModel == NULL) ? "0" : m_currentModel->id()));
+                                        new StringParameter("Current Model:", snapshot.currentModel));
                 w_settings.addParameter("currentViewController",
-                                        new StringParameter("Current ViewController:", (m_currentViewController == NULL) ? "0" : m_currentViewController->id()));
+                                        new StringParameter("Current ViewController:", snapshot.currentViewController));
                 w_settings.serialize(xmlWriter);
             xmlWriter.writeEndElement();
             
@@ -275,18 +407,101 @@ void Workspace::serialize(QXmlStreamWriter& xmlWriter) const
                 xmlWriter.writeEndElement();
         
                 xmlWriter.writeStartElement("Models");
-                for(Model* m : models)
+                if(m_content_dir.isEmpty())
                 {
-                    m->serialize(xmlWriter);
+                    for(Model* m : models)
+                    {
+                        m->serialize(xmlWriter);
+                    }
+                }
+                else
+                {
+                    QDir content_dir(m_content_dir);
+                    
+                    if(!content_dir.mkpath("."))
+                    {
+                        throw std::runtime_error("Could not create content directory");
+                    }
+                    
+                    //1. Reuse content files of unloaded models, which are already there
+                    std::vector<QString> content_files(models.size());
+                    QSet<QString> used_files;
+                    
+                    const std::vector<QString>& unloaded_files = snapshot.contentFiles;
+                    
+                    for(unsigned int i=0; i<models.size(); ++i)
+                    {
+                        QFileInfo info(unloaded_files[i]);
+                        
+                        if(     !unloaded_files[i].isEmpty()
+                            &&  info.absoluteDir() == content_dir)
+                        {
+                            content_files[i] = info.fileName();
+                            used_files.insert(content_files[i]);
+                        }
+                    }
+                    
+                    //2. Write (or copy) all other content files
+                    for(unsigned int i=0; i<models.size(); ++i)
+                    {
+                        Model* m = models[i];
+                        
+                        if(!content_files[i].isEmpty())
+                        {
+                            m->serialize_reference(xmlWriter, content_files[i]);
+                            continue;
+                        }
+                        
+                        QString filename = m->id() + ".xgz";
+                        for(int n=1; used_files.contains(filename); ++n)
+                        {
+                            filename = m->id() + "_" + QString::number(n) + ".xgz";
+                        }
+                        used_files.insert(filename);
+                        
+                        QString path = content_dir.absoluteFilePath(filename);
+                        QFile::remove(path);
+                        
+                        if(!unloaded_files[i].isEmpty())
+                        {
+                            //No need to decode the content just for storing it again
+                            if(!QFile::copy(unloaded_files[i], path))
+                            {
+                                throw std::runtime_error("Could not copy content file");
+                            }
+                        }
+                        else if(!Impex::save(m, path))
+                        {
+                            throw std::runtime_error("Could not write content file");
+                        }
+                        
+                        m->serialize_reference(xmlWriter, filename);
+                    }
+                    
+                    //3. Remove content files, which are not referenced anymore
+                    for(const QString& file : content_dir.entryList(QStringList("*.xgz"), QDir::Files))
+                    {
+                        if(!used_files.contains(file))
+                        {
+                            content_dir.remove(file);
+                        }
+                    }
                 }
                 xmlWriter.writeEndElement();
         
-                xmlWriter.writeStartElement("ViewControllers");
-                for(ViewController* vc : viewControllers)
+                //Copy the serialized ViewControllers (the writer re-indents them)
+                QXmlStreamReader vc_reader(snapshot.viewControllers);
+                while(!vc_reader.atEnd())
                 {
-                    vc->serialize(xmlWriter);
+                    vc_reader.readNext();
+                    
+                    if(     !vc_reader.hasError()
+                        &&  !vc_reader.isStartDocument() && !vc_reader.isEndDocument()
+                        &&  !vc_reader.isWhitespace())
+                    {
+                        xmlWriter.writeCurrentToken(vc_reader);
+                    }
                 }
-                xmlWriter.writeEndElement();
                 
             xmlWriter.writeEndElement();
                 
@@ -303,6 +518,28 @@ void Workspace::serialize(QXmlStreamWriter& xmlWriter) const
     }
 }
 
+void Workspace::setContentDirectory(const QString& dir)
+{
+    m_content_dir = dir;
+}
+
+QString Workspace::contentDirectory() const
+{
+    return m_content_dir;
+}
+
+QString Workspace::contentDirectoryForFile(const QString& filename)
+{
+    QFileInfo info(filename);
+    
+    return info.absoluteDir().absoluteFilePath(info.completeBaseName() + "_models");
+}
+
+BufferPool& Workspace::bufferPool()
+{
+    return m_buffer_pool;
+}
+
 void Workspace::clear()
 {
     for(ViewController* vc : viewControllers)
@@ -310,12 +547,16 @@ void Workspace::clear()
         vc->deleteLater();
     }
     viewControllers.clear();
+    pendingViewControllers.clear();
     
     for(Model* m : models)
     {
         m->deleteLater();
     }
     models.clear();
+    
+    //Free the cached temporary buffers
+    m_buffer_pool.clear();
 }
 
 Model* Workspace::loadModel(const QString & filename)
@@ -426,6 +667,9 @@ ViewController* Workspace::loadViewController(QXmlStreamReader & xmlReader)
             return NULL;
         }
         
+        //  The ViewController needs the content of the model
+        vc_model->loadContent();
+        
          //3. Create a controller using the vc_type and the model found above:
         for(unsigned int i=0; i<viewControllerFactory().size(); ++i)
         {
@@ -463,6 +707,43 @@ ViewController* Workspace::loadViewController(QXmlStreamReader & xmlReader)
     return NULL;
 }
 
+std::vector<ViewController*> Workspace::restorePendingViewControllers(Model* model)
+{
+    std::vector<ViewController*> vcs;
+    
+    if(!model->isContentLoaded())
+    {
+        return vcs;
+    }
+    
+    std::vector<std::pair<Model*, QByteArray> > pending;
+    pending.swap(pendingViewControllers);
+    
+    for(const std::pair<Model*, QByteArray>& p : pending)
+    {
+        if(p.first != model)
+        {
+            pendingViewControllers.push_back(p);
+            continue;
+        }
+        
+        //The Model's ID may have been changed by a snapshot since the restore
+        QByteArray vc_data;
+        QXmlStreamWriter vc_writer(&vc_data);
+        QXmlStreamReader pending_reader(p.second);
+        copyViewController(pending_reader, vc_writer, model->id());
+        
+        QXmlStreamReader vc_reader(vc_data);
+        ViewController* vc = loadViewController(vc_reader);
+        
+        if(vc != NULL)
+        {
+            vcs.push_back(vc);
+        }
+    }
+    return vcs;
+}
+
 Algorithm* Workspace::loadAlgorithm(const QString & filename)
 {
     QIODevice* device = Impex::openFile(filename, QIODevice::ReadOnly);
@@ -36,6 +36,7 @@
 #ifndef GRAIPE_CORE_WORKSPACE_HXX
 #define GRAIPE_CORE_WORKSPACE_HXX
 
+#include "core/bufferpool.hxx"
 #include "core/factories.hxx"
 #include "core/model.hxx"
 #include "core/module.hxx"
@@ -58,6 +59,27 @@ namespace graipe {
  * @brief This file holds all Workspace information
  */
  
+/**
+ * A snapshot of a Workspace for its serialization. It is taken in the thread of the
+ * Workspace's Models and may then be serialized in another thread (see AsyncImpex),
+ * while the Workspace itself is changed, e.g. by new Models of finished algorithms.
+ */
+struct WorkspaceSnapshot
+{
+    /** The Models (with assigned IDs) at the time of the snapshot **/
+    std::vector<Model*> models;
+    /** The content file of each Model, which was not loaded at the time of the snapshot (else empty) **/
+    std::vector<QString> contentFiles;
+    /** The serialized ViewControllers (a complete "ViewControllers" element) **/
+    QByteArray viewControllers;
+    /** The count of ViewControllers **/
+    unsigned int viewControllerCount;
+    /** The ID of the current Model or "0" **/
+    QString currentModel;
+    /** The ID of the current ViewController or "0" **/
+    QString currentViewController;
+};
+
 /**
  * This is the Workspace class.
  * Before you start working with Graipe, you should always create a workspace.
@@ -129,6 +151,64 @@ class GRAIPE_CORE_EXPORT Workspace
          * \param xmlWriter The QXmlStreamWriter on which we want to serialize.
          */
         void serialize(QXmlStreamWriter& xmlWriter) const;
+    
+        /**
+         * Takes a snapshot of the Workspace for a later serialization. The IDs of all
+         * Models and ViewControllers are assigned and the ViewControllers are serialized
+         * immediately. Needs to be called in the thread of the Workspace's Models.
+         *
+         * \return The snapshot of the Workspace.
+         */
+        WorkspaceSnapshot snapshot() const;
+    
+        /**
+         * Serialization of a snapshot of the Workspace on to an output device.
+         * Only the Models of the snapshot are accessed, which therefore need to
+         * stay alive (and should be locked) during the serialization.
+         *
+         * \param xmlWriter The QXmlStreamWriter on which we want to serialize.
+         * \param snapshot The snapshot of the Workspace.
+         */
+        void serialize(QXmlStreamWriter& xmlWriter, const WorkspaceSnapshot& snapshot) const;
+    
+        /**
+         * Sets the directory for the separate storage of the Models' contents.
+         * If set, serialize() only writes the Models' headers into the workspace and
+         * each Model's content into a separate file in this directory (see 
+         * Model::serialize_reference()). Unchanged content files of Models, which have
+         * not been loaded since the last restore, are reused instead of being rewritten.
+         * On deserialize(), the Models' contents are not loaded but remain on disk
+         * until they are needed (see Model::loadContent()).
+         * If empty (default), the Models are serialized completely into the workspace.
+         *
+         * \param dir The directory for the Models' contents.
+         */
+        void setContentDirectory(const QString& dir);
+    
+        /**
+         * The directory for the separate storage of the Models' contents.
+         *
+         * \return The content directory or an empty string, if not set.
+         */
+        QString contentDirectory() const;
+    
+        /**
+         * The suggested content directory for a workspace file. It is located
+         * next to the file and named by its basename, e.g. "ws.xgz" -> "ws_models".
+         *
+         * \param filename The filename of the workspace.
+         * \return The content directory for this workspace file.
+         */
+        static QString contentDirectoryForFile(const QString& filename);
+    
+        /**
+         * The pool of large temporary buffers of this workspace. It is the
+         * current pool of each thread, which runs an Algorithm of this workspace.
+         * Its statistics may be used to monitor the reuse of buffers.
+         *
+         * \return The buffer pool of this workspace.
+         */
+        BufferPool& bufferPool();
 
         /**
          * Clear all data structures, namely: Models and ViewControllers,
@@ -264,6 +344,24 @@ class GRAIPE_CORE_EXPORT Workspace
          */
         std::vector<ViewController*> viewControllers;
     
+        /**
+         * A public container holding the ViewControllers of restored Models, whose
+         * content has not been loaded so far. Each entry holds the Model and the
+         * serialization of one ViewController. These ViewControllers are created by
+         * restorePendingViewControllers() and saved with the Workspace meanwhile.
+         */
+        std::vector<std::pair<Model*, QByteArray> > pendingViewControllers;
+    
+        /**
+         * Creates the pending ViewControllers of a Model after its content has been
+         * loaded, e.g. by AsyncImpex::loadContent(). They are removed from the
+         * pendingViewControllers.
+         *
+         * \param model The Model, whose content has been loaded.
+         * \return The created ViewControllers.
+         */
+        std::vector<ViewController*> restorePendingViewControllers(Model* model);
+    
     
         /**
          * Returns the currently active Model. Change it using 
@@ -342,6 +440,12 @@ class GRAIPE_CORE_EXPORT Workspace
         //The current Model and ViewController
         Model* m_currentModel;
         ViewController* m_currentViewController;
+    
+        //The directory of the Models' content files
+        QString m_content_dir;
+    
+        //The pool of temporary buffers
+        BufferPool m_buffer_pool;
 };
 
 /**
@@ -118,6 +118,9 @@ class MeanVectorfield
                         unsigned int ref_w = vf->width(), ref_h = vf->height();
                         vigra::MultiArray<2,float>temp_u(ref_w,ref_h), temp_v(ref_w,ref_h);
                         
+                        //Decoding buffers for vectorfields with 16 bit storage
+                        DenseVectorfield2D::ArrayType buffer_u, buffer_v;
+                        
                         //iterate ->add vfs
                         for(unsigned int i = 0; i < selected_vectorfields.size(); ++i)
                         {
@@ -126,8 +129,8 @@ class MeanVectorfield
                             
                             vigra_precondition(vf->width() == ref_w && vf->height() == ref_h, "vectorfields are of different size");
                             
-                            temp_u += vf->u();
-                            temp_v += vf->v();
+                            temp_u += vf->u(buffer_u);
+                            temp_v += vf->v(buffer_v);
                         }
                         
                         //divide by count
@@ -638,8 +641,10 @@ class Vectorfield2DCurl
                     
                     vigra::MultiArray<2,float>m_uy(w,h), m_vx(w,h), res(w,h);
                     
-                    vigra::separableConvolveY(vf->u(), m_uy, kernel);
-                    vigra::separableConvolveX(vf->v(), m_vx, kernel);
+                    DenseVectorfield2D::ArrayType buffer_u, buffer_v;
+                    
+                    vigra::separableConvolveY(vf->u(buffer_u), m_uy, kernel);
+                    vigra::separableConvolveX(vf->v(buffer_v), m_vx, kernel);
                     
                     for (unsigned int y=0 ; y < h; ++y)
                     {
@@ -649,7 +654,7 @@ class Vectorfield2DCurl
                         }
                     }
                     
-                    img->setBand(0,res);
+                    img->takeBand(0,res);
                     img->setName("Scalar Curl of: " + vf->name());
                     img->setDescription("A gaussian sigma of: " + param_sigma->toString() + " has been used to derive the gradents of the vectorfield.");
                     
@@ -750,8 +755,10 @@ class Vectorfield2DDiv
                     
                     vigra::MultiArray<2,float> m_ux(w,h), m_vy(w,h), res(w,h);
                     
-                    vigra::separableConvolveX(vf->u(), m_ux, kernel);
-                    vigra::separableConvolveY(vf->v(), m_vy, kernel);
+                    DenseVectorfield2D::ArrayType buffer_u, buffer_v;
+                    
+                    vigra::separableConvolveX(vf->u(buffer_u), m_ux, kernel);
+                    vigra::separableConvolveY(vf->v(buffer_v), m_vy, kernel);
                     
                     for (unsigned int y=0 ; y < h; ++y)
                     {
@@ -761,7 +768,7 @@ class Vectorfield2DDiv
                         }
                     }
                     
-                    img->setBand(0,res);
+                    img->takeBand(0,res);
                     img->setName("Divergence of: " + vf->name());
                     img->setDescription("A gaussian sigma of: " + param_sigma->toString() + " has been used to derive the gradents of the vectorfield.");
                     
@@ -237,6 +237,31 @@ class AverageVelocityErrorFunctor
         }
 };
 
+/**
+ * Maps the origins and targets of all vectors of a vectorfield to global
+ * coordinates by means of two batch mappings.
+ *
+ * \param vf The vectorfield.
+ * \param global_origins Will be filled with the global origins.
+ * \param global_targets Will be filled with the global targets.
+ */
+inline void globalOriginsAndTargets(const Vectorfield2D* vf,
+                                    std::vector<QPointF>& global_origins, std::vector<QPointF>& global_targets)
+{
+    std::vector<Vectorfield2D::PointType> origins, directions;
+    vf->copyOrigins(origins);
+    vf->copyDirections(directions);
+    
+    std::vector<QPointF> points(origins.begin(), origins.end());
+    vf->mapToGlobal(points, global_origins);
+    
+    for (unsigned int i=0; i<points.size(); ++i)
+    {
+        points[i] += directions[i];
+    }
+    vf->mapToGlobal(points, global_targets);
+}
+
 /**
  * Comparison of any given vectorfield w.r.t. a dense vectorfield
  * Since the dense vectorfield may not directly cover the positions of the given vectorfield,
@@ -263,42 +288,55 @@ WeightedPointFeatureList2D* compareVectorfieldToDenseModel(Vectorfield2D* vf,
 	
 	unsigned int  count=0;
 	
-	bool invertible;
+	const QTransform	t_reference_vf	= reference_vf->globalTransformation();
 	
-	const QTransform	t_vf			= vf->globalTransformation(),
-						t_reference_vf	= reference_vf->globalTransformation(),
-						inv_t_ref_vf	= t_reference_vf.inverted(&invertible);
+	vigra_precondition(t_reference_vf.isInvertible(), "Transformation matrix of second vectorfield is not invertible!");
 	
-	vigra_precondition(invertible, "Transformation matrix of second vectorfield is not invertible!");
-	
-    vigra::SplineImageView<SPLINE_ORDER, float> spi_u(srcImageRange(reference_vf->u()));
-    vigra::SplineImageView<SPLINE_ORDER, float> spi_v(srcImageRange(reference_vf->v()));
-
-	for (unsigned int l1=0; l1 < vf->size(); ++l1)
+    //Read all vectors and properties once instead of per vector
+    std::vector<Vectorfield2D::PointType> origins;
+    vf->copyOrigins(origins);
+    
+    std::vector<QPointF> global_origins, global_targets;
+    globalOriginsAndTargets(vf, global_origins, global_targets);
+    
+    //Sample the reference directions at all positions at once (in parallel).
+    //The spline coefficients are cached by the reference vectorfield.
+    std::vector<QPointF> ref_img_positions;
+    reference_vf->mapFromGlobal(global_origins, ref_img_positions);
+    
+    std::vector<Vectorfield2D::PointType> ref_img_directions;
+    bool all_valid = reference_vf->sampleDirections(ref_img_positions, ref_img_directions, SPLINE_ORDER);
+    
+    vigra_precondition(all_valid, "Some vectors are located outside of the dense reference vectorfield!");
+    
+    //Project the reference directions to world coordinates
+    std::vector<QPointF> ref_img_targets(ref_img_positions.size()), ref_origins, ref_targets;
+    for (unsigned int l1=0; l1 < ref_img_positions.size(); ++l1)
 	{
-		QPointF p_tar = t_vf.map(vf->target(l1)),
-				p_ori = t_vf.map(vf->origin(l1));
-		
-		double	dir_x = p_tar.x()-p_ori.x(),
-				dir_y = p_tar.y()-p_ori.y();
-				
-		QPointF ref_img_p = inv_t_ref_vf.map(p_ori);
-		
-		//get direction information in image coordinates
-		double	reference_dir_x = spi_u(ref_img_p.x(), ref_img_p.y()),
-				reference_dir_y = spi_v(ref_img_p.x(), ref_img_p.y());
-		
-		//prject direction information to world coordinates
-		QPointF	r_tar = t_reference_vf.map(ref_img_p + QPointF(reference_dir_x, reference_dir_y)),
-				r_ori = t_reference_vf.map(ref_img_p);
+        ref_img_targets[l1] = ref_img_positions[l1] + ref_img_directions[l1];
+    }
+    reference_vf->mapToGlobal(ref_img_positions, ref_origins);
+    reference_vf->mapToGlobal(ref_img_targets, ref_targets);
+    
+    const double    vf_scale = vf->scale(),
+                    reference_vf_scale = reference_vf->scale();
+    
+    //Build the result list and the error statistics in one pass
+    QVector<Vectorfield2D::PointType> result_points(origins.size());
+    QVector<float> result_weights(origins.size());
+    
+	for (unsigned int l1=0; l1 < origins.size(); ++l1)
+	{
+		double	dir_x = global_targets[l1].x()-global_origins[l1].x(),
+				dir_y = global_targets[l1].y()-global_origins[l1].y();
 		
-		reference_dir_x = r_tar.x()-r_ori.x();
-		reference_dir_y = r_tar.y()-r_ori.y();
+		double	reference_dir_x = ref_targets[l1].x()-ref_origins[l1].x(),
+				reference_dir_y = ref_targets[l1].y()-ref_origins[l1].y();
 		
-		if(vf->scale() != 0 && reference_vf->scale() != 0)
+		if(vf_scale != 0 && reference_vf_scale != 0)
 		{
-			single_error = error_measure(dir_x*vf->scale(),						dir_y*vf->scale(), 
-										 reference_dir_x*reference_vf->scale(),	reference_dir_y*reference_vf->scale());
+			single_error = error_measure(dir_x*vf_scale,						dir_y*vf_scale, 
+										 reference_dir_x*reference_vf_scale,	reference_dir_y*reference_vf_scale);
 		}
 		else
 		{
@@ -306,15 +344,16 @@ WeightedPointFeatureList2D* compareVectorfieldToDenseModel(Vectorfield2D* vf,
 										 reference_dir_x,	reference_dir_y);
 		}
 		
-		//qDebug() << "status: " << (l1*100.0 / vf->size()) << "% err:" << single_error << " " << error_measure.units() << "\n";
-		
-		comparison->addFeature(vf->origin(l1), single_error);
+		result_points[l1]  = origins[l1];
+		result_weights[l1] = single_error;
 		
 		error  += single_error;	
 		error2 += single_error*single_error;
 		count++;
 	}
 	
+	comparison->addFeatures(result_points, result_weights);
+	
 	report += QString("%1 error    is: %2 %3\n").arg(error_measure.shortName()).arg(error/count).arg(error_measure.units())
             + QString("%1 variance is: %2 %3^2\n").arg(error_measure.shortName()).arg((error2 - ((error*error)/count))/count).arg(error_measure.units())
             + QString("%1 std.dev. is: %2 %3\n").arg(error_measure.shortName()).arg(sqrt((error2 - ((error*error)/count))/count)).arg(error_measure.units());
@@ -344,23 +383,32 @@ WeightedPointFeatureList2D* compareVectorfieldsGeneric( Vectorfield2D* vf,
 {
 	WeightedPointFeatureList2D* comparison = new WeightedPointFeatureList2D(vf->workspace());
 	
+	//Coalesce all additions into one model update
+	ModelTransaction transaction(comparison);
+	comparison->reserve(vf->size());
+	
 	double error=0, error2=0;
 	double single_error;
 	
 	unsigned int  count=0;
 	
-	const QTransform	t_vf			= vf->globalTransformation(),
-						t_reference_vf	= reference_vf->globalTransformation();
+	//Map all origins and targets to global coordinates once
+	std::vector<QPointF> vf_origins, vf_targets, ref_origins, ref_targets;
+	globalOriginsAndTargets(vf, vf_origins, vf_targets);
+	globalOriginsAndTargets(reference_vf, ref_origins, ref_targets);
+	
+	const double    vf_scale = vf->scale(),
+                    reference_vf_scale = reference_vf->scale();
 	
-	for (unsigned int l1=0; l1 < vf->size(); ++l1)
+	for (unsigned int l1=0; l1 < vf_origins.size(); ++l1)
 	{
         std::list<WeightedIndex> candidates;
 		
 		//find out distance for each vector of reference vf
-		for (unsigned int l2=0; l2 < reference_vf->size(); ++l2)
+		for (unsigned int l2=0; l2 < ref_origins.size(); ++l2)
 		{
-			QPointF p1 = t_vf.map(vf->origin(l1)),
-					p2 = t_reference_vf.map(reference_vf->origin(l2));
+			const QPointF & p1 = vf_origins[l1],
+						  & p2 = ref_origins[l2];
 			
 			double cur_dist = sqrt( pow(p1.x()-p2.x(),2) +  pow(p1.y()-p2.y(),2));
 			WeightedIndex wi; wi.idx = l2; wi.weight = cur_dist;
@@ -379,8 +427,8 @@ WeightedPointFeatureList2D* compareVectorfieldsGeneric( Vectorfield2D* vf,
 		{
 			double weight =   1.0/(1.0 + c_iter->weight);
 			
-			QPointF p1 = t_reference_vf.map(reference_vf->target(c_iter->idx)),
-					p2 = t_reference_vf.map(reference_vf->origin(c_iter->idx));
+			const QPointF & p1 = ref_targets[c_iter->idx],
+						  & p2 = ref_origins[c_iter->idx];
 			
 			mean_reference_dir_x+=weight*(p1.x()-p2.x());	//weighted x-diff
 			mean_reference_dir_y+=weight*(p1.y()-p2.y());	//weighted y-diff
@@ -391,17 +439,14 @@ WeightedPointFeatureList2D* compareVectorfieldsGeneric( Vectorfield2D* vf,
 		mean_reference_dir_y /=sum_w;
 		
 		
-		QPointF p1 = t_vf.map(vf->target(l1)),
-				p2 = t_vf.map(vf->origin(l1));
-		
-		double	dir_x = p1.x()-p2.x(),
-				dir_y = p1.y()-p2.y();
+		double	dir_x = vf_targets[l1].x()-vf_origins[l1].x(),
+				dir_y = vf_targets[l1].y()-vf_origins[l1].y();
 		
 		
-		if(vf->scale() != 0 && reference_vf->scale() != 0)
+		if(vf_scale != 0 && reference_vf_scale != 0)
 		{
-			single_error = error_measure(dir_x*vf->scale(),								dir_y*vf->scale(), 
-										 mean_reference_dir_x*reference_vf->scale(),	mean_reference_dir_y*reference_vf->scale());
+			single_error = error_measure(dir_x*vf_scale,							dir_y*vf_scale, 
+										 mean_reference_dir_x*reference_vf_scale,	mean_reference_dir_y*reference_vf_scale);
 		}
 		else
 		{
@@ -33,6 +33,7 @@
 /*                                                                      */
 /************************************************************************/
 
+
 #ifndef GRAIPE_FEATUREDETECTION_DETECTPOINTFEATURES_HXX
 #define GRAIPE_FEATUREDETECTION_DETECTPOINTFEATURES_HXX
 
@@ -46,9 +47,14 @@
 //GRAIPE Feature Types
 #include "features2d/features2d.h"
 
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
 #include <cmath>
 #include <math.h>
 #include <algorithm>
+#include <vector>
 
 namespace graipe {
 /**
@@ -59,6 +65,179 @@ namespace graipe {
  * @brief Header file for general detection of 2d features (excl. SIFT)
  */
 
+/**
+ * Per-thread buffer of detected features. Each detection band collects its
+ * features here, before they are merged and added to a feature list at once.
+ */
+struct FeatureBuffer2D
+{
+    /** The positions of the features **/
+    QVector<PointFeatureList2D::PointType> points;
+    /** The weights of the features **/
+    QVector<float> weights;
+    /** The orientations of the features (edgels only) **/
+    QVector<float> orientations;
+};
+
+/**
+ * A task of the band-parallel feature detection. It calls the band detector
+ * for one horizontal band of the image, given by its core rows and the rows
+ * of the surrounding halo, and collects the features of the core rows.
+ */
+template <class BandDetector>
+class FeatureBandTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor of a task.
+         *
+         * \param detector The band detector, called as detector(halo_begin, halo_end, core_begin, core_end, features).
+         * \param halo_begin The first row of the band including the halo.
+         * \param halo_end The row after the last row of the band including the halo.
+         * \param core_begin The first row, for which features are collected.
+         * \param core_end The row after the last row, for which features are collected.
+         */
+        FeatureBandTask(const BandDetector& detector, int halo_begin, int halo_end, int core_begin, int core_end)
+        :   m_detector(detector),
+            m_halo_begin(halo_begin),
+            m_halo_end(halo_end),
+            m_core_begin(core_begin),
+            m_core_end(core_end)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Detects the features of the band, called by the thread pool.
+         */
+        void run()
+        {
+            if(m_core_begin < m_core_end)
+            {
+                m_detector(m_halo_begin, m_halo_end, m_core_begin, m_core_end, features);
+            }
+        }
+    
+        /** The features of the core rows **/
+        FeatureBuffer2D features;
+    
+    private:
+        /** The band detector **/
+        const BandDetector& m_detector;
+        /** The rows of the band including the halo and the core rows **/
+        int m_halo_begin, m_halo_end, m_core_begin, m_core_end;
+};
+
+/**
+ * Band-parallel feature detection. The image rows are split into one band per
+ * thread. Each band is extended by a halo of rows, which are needed by the filters
+ * of the detector, such that the features of the core rows are the same as for the
+ * whole image. The features of all bands are merged in order of the bands, which
+ * results in the same (row-major) order as for a detection on the whole image.
+ *
+ * \param height The height of the image.
+ * \param halo The count of halo rows above and below each band.
+ * \param detector The band detector, called as detector(halo_begin, halo_end, core_begin, core_end, features).
+ * \param features The merged features of all bands.
+ */
+template <class BandDetector>
+void detectFeaturesInBands(int height, int halo, const BandDetector& detector, FeatureBuffer2D& features)
+{
+    //Bands, which are not much larger than their halo, are not worth a thread
+    const int min_band_height = std::max(64, 4*halo);
+    
+    const int band_count  = std::max(1, std::min(QThread::idealThreadCount(), height/min_band_height)),
+              band_height = (height + band_count - 1)/band_count;
+    
+    std::vector<FeatureBandTask<BandDetector>*> tasks;
+    for(int b=0; b<band_count; ++b)
+    {
+        int core_begin = std::min(height, b*band_height),
+            core_end   = std::min(height, (b+1)*band_height);
+        
+        tasks.push_back(new FeatureBandTask<BandDetector>(detector,
+                                                          std::max(0, core_begin-halo), std::min(height, core_end+halo),
+                                                          core_begin, core_end));
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(band_count);
+    
+    for(unsigned int t=1; t<tasks.size(); ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    int feature_count = 0;
+    for(FeatureBandTask<BandDetector>* task : tasks)
+    {
+        feature_count += task->features.points.size();
+    }
+    
+    features.points.reserve(feature_count);
+    features.weights.reserve(feature_count);
+    
+    for(FeatureBandTask<BandDetector>* task : tasks)
+    {
+        features.points       += task->features.points;
+        features.weights      += task->features.weights;
+        features.orientations += task->features.orientations;
+        delete task;
+    }
+}
+
+/**
+ * Collects all pixels of some rows of an image, which pass a threshold test
+ * and are not masked out.
+ *
+ * \param src        The source image.
+ * \param mask       The mask image or NULL, if no mask shall be used.
+ * \param lower      The lower treshold. The pixel value has to be at least of this value.
+ * \param upper      The upper treshold. The pixel value has to be at max. of this value.
+ * \param row_offset The row of the first row of src w.r.t. to the whole image.
+ * \param row_begin  The first row of src, which will be tested.
+ * \param row_end    The row after the last row of src, which will be tested.
+ * \param features   The buffer, where the passing pixels are appended, weighted with their value.
+ */
+template <class T, class M>
+void collectThresholdFeatures(const vigra::MultiArrayView<2,T>& src, const vigra::MultiArrayView<2,M>* mask,
+                              T lower, T upper,
+                              int row_offset, int row_begin, int row_end,
+                              FeatureBuffer2D& features)
+{
+	for(int y=row_begin; y<row_end; ++y)
+	{
+		for(int x=0; x<src.width(); ++x)
+		{
+			T val = src(x,y);
+            
+			if(val>=lower && val<=upper && (mask == NULL || (*mask)(x,y+row_offset) != 0))
+			{
+                features.points.push_back(PointFeatureList2D::PointType(x,y+row_offset));
+                features.weights.push_back(val);
+			}
+		}
+	}
+}
+
+/**
+ * Creates a weighted feature list from a buffer of features by
+ * means of one bulk addition.
+ *
+ * \param features The features.
+ * \param wsp      The workspace of the new list.
+ * \return The new weighted feature list.
+ */
+inline WeightedPointFeatureList2D* createWeightedFeatureList(const FeatureBuffer2D& features, Workspace * wsp)
+{
+	WeightedPointFeatureList2D* featureList = new WeightedPointFeatureList2D(wsp);
+    featureList->addFeatures(features.points, features.weights);
+    return featureList;
+}
+
 /** 
  * Feature detection using Thresholding
  * These functions will extract a list of pointfeatures from an image.
@@ -76,22 +255,19 @@ WeightedPointFeatureList2D* detectFeaturesUsingThreshold(const vigra::MultiArray
                                                             T lower, T upper,
                                                             Workspace * wsp)
 {
-	
-	WeightedPointFeatureList2D* featureList = new WeightedPointFeatureList2D(wsp);
-	
-	for(int y=0; y<src.height(); ++y)
-	{
-		for(int x=0; x<src.width(); ++x)
-		{
-			T val = src(x,y);
-            
-			if(val>=lower && val<=upper)
-			{
-				featureList->addFeature(WeightedPointFeatureList2D::PointType(x,y),val);
-			}
-		}
-	}
-	return featureList;
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), 0,
+                          [&](int, int, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectThresholdFeatures(src, (const vigra::MultiArrayView<2,T>*)NULL,
+                                                       lower, upper,
+                                                       0, core_begin, core_end,
+                                                       band_features);
+                          },
+                          features);
+    
+	return createWeightedFeatureList(features, wsp);
 }
     
 /** 
@@ -116,20 +292,19 @@ WeightedPointFeatureList2D* detectFeaturesUsingThresholdWithMask(const vigra::Mu
 {
     vigra_precondition( src.shape() == mask.shape(), "mask and source shapes differ!");
     
-	WeightedPointFeatureList2D* featureList = new WeightedPointFeatureList2D(wsp);
-	
-	for(int y=0; y<src.height(); ++y)
-	{
-		for(int x=0; x<src.width(); ++x)
-		{
-			T val = src(x,y);
-			if(val>=lower && val<=upper && mask(x,y) != 0)
-			{
-				featureList->addFeature(WeightedPointFeatureList2D::PointType(x,y),val);
-			}
-		}
-	}
-	return featureList;
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), 0,
+                          [&](int, int, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectThresholdFeatures(src, &mask,
+                                                       lower, upper,
+                                                       0, core_begin, core_end,
+                                                       band_features);
+                          },
+                          features);
+    
+	return createWeightedFeatureList(features, wsp);
 }
 
 
@@ -164,6 +339,39 @@ void monotony_operator(const vigra::MultiArrayView<2,T> & src, vigra::MultiArray
     }
 }
 
+/**
+ * Collects the Monotony features of one band of an image. The monotony is
+ * only computed for the rows of the band (incl. its halo of monotony_offset rows).
+ *
+ * \param src             The source image.
+ * \param mask            The mask image or NULL, if no mask shall be used.
+ * \param lowest_level    The lowest allowed level of monotony.
+ * \param highest_level   The highest allowed level of monotony.
+ * \param monotony_offset The offset in x- and y-direction of the neighbors.
+ * \param halo_begin      The first row of the band including the halo.
+ * \param halo_end        The row after the last row of the band including the halo.
+ * \param core_begin      The first row, for which features are collected.
+ * \param core_end        The row after the last row, for which features are collected.
+ * \param features        The buffer, where the features are appended.
+ */
+template <class T, class M>
+void collectMonotonyFeatures(const vigra::MultiArrayView<2,T>& src, const vigra::MultiArrayView<2,M>* mask,
+                             unsigned char lowest_level, unsigned char highest_level,
+                             unsigned int monotony_offset,
+                             int halo_begin, int halo_end, int core_begin, int core_end,
+                             FeatureBuffer2D& features)
+{
+    vigra::MultiArrayView<2,T> band = src.subarray(vigra::Shape2(0, halo_begin), vigra::Shape2(src.width(), halo_end));
+    
+	vigra::MultiArray<2,unsigned char> monotony_img(band.shape());
+	monotony_operator(band, monotony_img, monotony_offset);
+    
+    collectThresholdFeatures(vigra::MultiArrayView<2,unsigned char>(monotony_img), mask,
+                             lowest_level, highest_level,
+                             halo_begin, core_begin-halo_begin, core_end-halo_begin,
+                             features);
+}
+
 /** 
  * Feature detection using the Monotony Operator
  * These function will extract a list of pointfeatures from an image.
@@ -185,10 +393,19 @@ WeightedPointFeatureList2D* detectFeaturesUsingMonotonyOperator(const vigra::Mul
                                                                 unsigned int monotony_offset,
                                                                 Workspace * wsp)
 {
-	vigra::MultiArray<2,unsigned char> monotony_img(src.shape());
-	monotony_operator(src, monotony_img, monotony_offset);
-
-	return detectFeaturesUsingThreshold(monotony_img, lowest_level, highest_level, wsp);
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), monotony_offset,
+                          [&](int halo_begin, int halo_end, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectMonotonyFeatures(src, (const vigra::MultiArrayView<2,T>*)NULL,
+                                                      lowest_level, highest_level, monotony_offset,
+                                                      halo_begin, halo_end, core_begin, core_end,
+                                                      band_features);
+                          },
+                          features);
+    
+	return createWeightedFeatureList(features, wsp);
 }
 
 /** 
@@ -215,64 +432,120 @@ WeightedPointFeatureList2D* detectFeaturesUsingMonotonyOperatorWithMask(const vi
 {
     vigra_precondition( src.shape() == mask.shape(), "mask and source shapes differ!");
     
-	vigra::MultiArray<2,unsigned char> monotony_img(src.shape());
-	monotony_operator(src, monotony_img, monotony_offset);
-	
-	return detectFeaturesUsingThresholdWithMask(monotony_img, mask,
-                                                lowest_level, highest_level,
-                                                wsp);
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), monotony_offset,
+                          [&](int halo_begin, int halo_end, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectMonotonyFeatures(src, &mask,
+                                                      lowest_level, highest_level, monotony_offset,
+                                                      halo_begin, halo_end, core_begin, core_end,
+                                                      band_features);
+                          },
+                          features);
+    
+	return createWeightedFeatureList(features, wsp);
 }
 
 
 
 
-/**  
- * Feature detection using the Harris corner detector
- * This function will extract a list of 2d-weighted-features from an image.
- * The weight is given by the response of the corresponding pixels.
+/**
+ * The count of halo rows needed by the Harris corner detector at a given scale:
+ * vigra computes the structure tensor with inner and outer scale set to scale.
+ * The gaussian derivative kernels reach (int)(3.5*scale+0.5) rows, the smoothing
+ * kernels (int)(3.0*scale+0.5) rows, and the local maxima need one row more.
  *
- * \param src       The source image.
- * \param scale     The (gaussian sigma) scale used for the Harris operator.
- * \param threshold The minimal response, for which a feaure will be created. Defaults to 0.
- * \param wsp       The workspace of the detection.
- * \return Weighted point featurelist. The list of local maxima of the Harris operator
- *         with reponses above the given threshold.
+ * \param scale The (gaussian sigma) scale used for the Harris operator.
+ * \return The count of halo rows.
  */
-template <class T>
-WeightedPointFeatureList2D* detectFeaturesUsingHarris(const vigra::MultiArrayView<2,T>& src,
-                                                        double scale,
-                                                        double threshold,
-                                                        Workspace * wsp)
+inline int harrisHaloSize(double scale)
+{
+    return (int)(3.5*scale + 0.5) + (int)(3.0*scale + 0.5) + 2;
+}
+
+/**
+ * Collects the Harris corners of one band of an image. The corner response
+ * is only computed for the rows of the band (incl. its halo).
+ *
+ * \param src        The source image.
+ * \param mask       The mask image or NULL, if no mask shall be used.
+ * \param scale      The (gaussian sigma) scale used for the Harris operator.
+ * \param threshold  The minimal response, for which a feaure will be created.
+ * \param halo_begin The first row of the band including the halo.
+ * \param halo_end   The row after the last row of the band including the halo.
+ * \param core_begin The first row, for which features are collected.
+ * \param core_end   The row after the last row, for which features are collected.
+ * \param features   The buffer, where the features are appended.
+ */
+template <class T, class M>
+void collectHarrisFeatures(const vigra::MultiArrayView<2,T>& src, const vigra::MultiArrayView<2,M>* mask,
+                           double scale, double threshold,
+                           int halo_begin, int halo_end, int core_begin, int core_end,
+                           FeatureBuffer2D& features)
 {
-    vigra::MultiArray<2,float>cornerResponse(src.shape());
-	vigra::MultiArray<2,unsigned char> filteredResponse(src.shape());
+    vigra::MultiArrayView<2,T> band = src.subarray(vigra::Shape2(0, halo_begin), vigra::Shape2(src.width(), halo_end));
+    
+    vigra::MultiArray<2,float>cornerResponse(band.shape());
+	vigra::MultiArray<2,unsigned char> filteredResponse(band.shape());
 	
 	// find corner response at given scale
-    vigra::cornerResponseFunction(src, cornerResponse, scale);
+    vigra::cornerResponseFunction(band, cornerResponse, scale);
 	
     // find local maxima of corner response
     vigra::localMaxima(cornerResponse, filteredResponse);
 	
-	WeightedPointFeatureList2D* new_featurelist = new WeightedPointFeatureList2D(wsp);
-	
-    // sample grid on img1 and try to add ctrl points
-    for (int y=0; y < src.height(); y++ )
+    // sample the core rows and try to add ctrl points
+    for (int y=core_begin; y < core_end; y++ )
 	{
         for (int x=0; x < src.width(); x++ )
 		{
-			if (filteredResponse(x,y) != 0)
+			if (filteredResponse(x,y-halo_begin) != 0 && (mask == NULL || (*mask)(x,y) != 0))
 			{
-                double resp = cornerResponse(x,y);
+                double resp = cornerResponse(x,y-halo_begin);
             
                 if (resp > threshold)
                 {
-                    // add to feature list
-                    new_featurelist->addFeature(WeightedPointFeatureList2D::PointType(x,y), resp);
+                    // add to feature buffer
+                    features.points.push_back(PointFeatureList2D::PointType(x,y));
+                    features.weights.push_back(resp);
                 }
             }
 		}
     }
-	return new_featurelist;
+}
+
+/**  
+ * Feature detection using the Harris corner detector
+ * This function will extract a list of 2d-weighted-features from an image.
+ * The weight is given by the response of the corresponding pixels.
+ *
+ * \param src       The source image.
+ * \param scale     The (gaussian sigma) scale used for the Harris operator.
+ * \param threshold The minimal response, for which a feaure will be created. Defaults to 0.
+ * \param wsp       The workspace of the detection.
+ * \return Weighted point featurelist. The list of local maxima of the Harris operator
+ *         with reponses above the given threshold.
+ */
+template <class T>
+WeightedPointFeatureList2D* detectFeaturesUsingHarris(const vigra::MultiArrayView<2,T>& src,
+                                                        double scale,
+                                                        double threshold,
+                                                        Workspace * wsp)
+{
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), harrisHaloSize(scale),
+                          [&](int halo_begin, int halo_end, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectHarrisFeatures(src, (const vigra::MultiArrayView<2,T>*)NULL,
+                                                    scale, threshold,
+                                                    halo_begin, halo_end, core_begin, core_end,
+                                                    band_features);
+                          },
+                          features);
+    
+	return createWeightedFeatureList(features, wsp);
 }
 
 /**  
@@ -296,41 +569,98 @@ WeightedPointFeatureList2D* detectFeaturesUsingHarrisWithMask(const vigra::Multi
 {
     vigra_precondition( src.shape() == mask.shape(), "mask and source shapes differ!");
     
-    vigra::MultiArray<2,float>cornerResponse(src.shape());
-	vigra::MultiArray<2,unsigned char> filteredResponse(src.shape());
-	
-	// find corner response at given scale
-    vigra::cornerResponseFunction(src, cornerResponse, scale);
-	
-    // find local maxima of corner response
-    vigra::localMaxima(cornerResponse, filteredResponse);
-	
-	WeightedPointFeatureList2D* new_featurelist = new WeightedPointFeatureList2D(wsp);
-	
-    // sample grid on img1 and try to add ctrl points
-    for (int y=0; y < src.height(); y++ )
-	{
-        for (int x=0; x < src.width(); x++ )
-		{
-			if (filteredResponse(x,y) != 0 && mask(x,y) != 0)
-			{
-                double resp = cornerResponse(x,y);
-            
-                if (resp > threshold)
-                {
-                    // add to feature list
-                    new_featurelist->addFeature(WeightedPointFeatureList2D::PointType(x,y), resp);
-                }
-            }
-		}
-    }
-	return new_featurelist;
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), harrisHaloSize(scale),
+                          [&](int halo_begin, int halo_end, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectHarrisFeatures(src, &mask,
+                                                    scale, threshold,
+                                                    halo_begin, halo_end, core_begin, core_end,
+                                                    band_features);
+                          },
+                          features);
+    
+	return createWeightedFeatureList(features, wsp);
 }
 
 
 
 
 
+/**
+ * The count of halo rows needed by the Canny edge detector at a given scale:
+ * The gaussian derivative kernels of the gradient reach (int)(3.5*scale+0.5)
+ * rows, and the non-maximum suppression and subpixel edgel localization need
+ * the neighbored gradient rows, too.
+ *
+ * \param scale The (gaussian sigma) scale used for the Canny operator.
+ * \return The count of halo rows.
+ */
+inline int cannyHaloSize(double scale)
+{
+    return (int)(3.5*scale + 0.5) + 2;
+}
+
+/**
+ * Collects the Canny edgels of one band of an image. The gradient is only
+ * computed for the rows of the band (incl. its halo). Each edgel is assigned to
+ * the band, which contains its rounded position. Thus, edgels near the band
+ * borders, which are found by both neighbored bands, are collected only once.
+ *
+ * \param src        The source image.
+ * \param mask       The mask image or NULL, if no mask shall be used.
+ * \param scale      The (gaussian sigma) scale used for the Canny operator.
+ * \param threshold  The minimal response, for which a feaure will be created.
+ * \param halo_begin The first row of the band including the halo.
+ * \param halo_end   The row after the last row of the band including the halo.
+ * \param core_begin The first row, for which features are collected.
+ * \param core_end   The row after the last row, for which features are collected.
+ * \param features   The buffer, where the features are appended.
+ */
+template <class T, class M>
+void collectCannyFeatures(const vigra::MultiArrayView<2,T>& src, const vigra::MultiArrayView<2,M>* mask,
+                          double scale, double threshold,
+                          int halo_begin, int halo_end, int core_begin, int core_end,
+                          FeatureBuffer2D& features)
+{
+    vigra::MultiArrayView<2,T> band = src.subarray(vigra::Shape2(0, halo_begin), vigra::Shape2(src.width(), halo_end));
+    
+	// empty edgel list
+    std::vector<vigra::Edgel> v_edgels;
+    
+	// find edgels at scale
+    vigra::cannyEdgelListThreshold(band, v_edgels, scale, threshold);
+	
+	for(const vigra::Edgel& e : v_edgels)
+	{
+        int x = e.x+.5,
+            y = e.y+.5 + halo_begin;
+        
+        if(y >= core_begin && y < core_end && (mask == NULL || (*mask)(x, y) != 0))
+        {
+            features.points.push_back(PointFeatureList2D::PointType(e.x, e.y + halo_begin));
+            features.weights.push_back(e.strength);
+            features.orientations.push_back(fmod(2*M_PI + e.orientation, 2*M_PI));
+        }
+	}
+}
+
+/**
+ * Creates an edgel feature list from a buffer of features by
+ * means of one bulk addition.
+ *
+ * \param features The features.
+ * \param wsp      The workspace of the new list.
+ * \return The new edgel feature list.
+ */
+inline EdgelFeatureList2D* createEdgelFeatureList(const FeatureBuffer2D& features, Workspace * wsp)
+{
+    EdgelFeatureList2D* edgels = new EdgelFeatureList2D(wsp);
+    edgels->addFeatures(features.points, features.weights, features.orientations);
+    return edgels;
+}
+
 /** 
  * Feature detection using the Canny Edge operator.
  * This functions will extract a list of 2d-edgel-features from an image.
@@ -346,20 +676,19 @@ EdgelFeatureList2D* detectFeaturesUsingCanny(const vigra::MultiArrayView<2,T>& s
                                              double scale, double threshold,
                                              Workspace * wsp)
 {
-	// empty edgel list
-    std::vector<vigra::Edgel> v_edgels;
+    FeatureBuffer2D features;
     
-	// find edgels at scale
-    vigra::cannyEdgelListThreshold(src, v_edgels, scale, threshold);
-	
-    EdgelFeatureList2D* edgels = new EdgelFeatureList2D(wsp);
-	
-	for(auto e : v_edgels)
-	{
-		edgels->addFeature(EdgelFeatureList2D::PointType(e.x,e.y), e.strength, fmod(2*M_PI + e.orientation, 2*M_PI));
-	}
+    detectFeaturesInBands(src.height(), cannyHaloSize(scale),
+                          [&](int halo_begin, int halo_end, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectCannyFeatures(src, (const vigra::MultiArrayView<2,T>*)NULL,
+                                                   scale, threshold,
+                                                   halo_begin, halo_end, core_begin, core_end,
+                                                   band_features);
+                          },
+                          features);
     
-	return  edgels;
+	return createEdgelFeatureList(features, wsp);
 }
 
 
@@ -382,23 +711,21 @@ EdgelFeatureList2D* detectFeaturesUsingCannyWithMask(const vigra::MultiArrayView
                                                      double scale, double threshold,
                                                      Workspace * wsp)
 {
-	// empty edgel list
-    std::vector<vigra::Edgel> v_edgels;
+    vigra_precondition( src.shape() == mask.shape(), "mask and source shapes differ!");
     
-	// find edgels at scale
-    vigra::cannyEdgelListThreshold(src, v_edgels, scale, threshold);
-	
-    EdgelFeatureList2D* edgels = new EdgelFeatureList2D(wsp);
-	
-	for(auto e : v_edgels)
-	{
-        if(mask(e.x+.5,  e.y+.5) != 0)
-        {
-            edgels->addFeature(EdgelFeatureList2D::PointType(e.x,e.y), e.strength, fmod(2*M_PI + e.orientation, 2*M_PI));
-        }
-    }
+    FeatureBuffer2D features;
+    
+    detectFeaturesInBands(src.height(), cannyHaloSize(scale),
+                          [&](int halo_begin, int halo_end, int core_begin, int core_end, FeatureBuffer2D& band_features)
+                          {
+                              collectCannyFeatures(src, &mask,
+                                                   scale, threshold,
+                                                   halo_begin, halo_end, core_begin, core_end,
+                                                   band_features);
+                          },
+                          features);
     
-	return  edgels;
+	return createEdgelFeatureList(features, wsp);
 }
 
 /**
@@ -76,6 +76,8 @@ namespace graipe {
  * \param double_image_size   If true, the lowest octave will start are 2*width, 2*height of the image.
  * \param normalize_image     If true, the image will be normalized to 0..1 for the further computations.
  * \param wsp                 The worskpace of the SIFT detection.
+ * \param scale_space         Reusable buffers of the scale space. If NULL, temporary
+ *                            buffers will be used. Defaults to NULL.
  * \return A list of all detected SIFT features.
  */
 
@@ -83,12 +85,21 @@ template <class T>
 SIFTFeatureList2D* detectFeaturesUsingSIFT(const vigra::MultiArrayView<2,T>& src,
                                           float sigma, unsigned int octaves, unsigned int levels,
 									      float contrast_threshold, float curvature_threshold, bool double_image_size, bool normalize_image,
-                                          Workspace * wsp)
+                                          Workspace * wsp,
+                                          SIFTScaleSpace * scale_space = NULL)
 {
 	SIFTFeatureList2D * result = new SIFTFeatureList2D(wsp);
+	
+	//Coalesce all additions into one model update
+	ModelTransaction transaction(result);
+    
+    SIFTScaleSpace temp_scale_space;
+    
+    std::vector<SIFTFeature> std_result = computeSIFTDescriptors(src, scale_space ? *scale_space : temp_scale_space,
+                                                                 sigma, octaves, levels, contrast_threshold, curvature_threshold, double_image_size, normalize_image);
+    
+    result->reserve(std_result.size());
     
-    std::vector<SIFTFeature> std_result = computeSIFTDescriptors(src, sigma, octaves, levels, contrast_threshold, curvature_threshold, double_image_size, normalize_image);
-        
     for(const SIFTFeature& sift : std_result)
     {
         result->addFeature(SIFTFeatureList2D::PointType(sift.position[0], sift.position[1]),
@@ -645,7 +645,8 @@ class SIFTFeatureDetector
                                                                                    param_sigma->value(), param_octaves->value(), param_levels->value(),
                                                                                    param_contrast_threshold->value(), param_curvature_threshold->value(),
                                                                                    param_double_size->value(), param_normalize->value(),
-                                                                                   m_workspace);
+                                                                                   m_workspace,
+                                                                                   &m_scale_space);
                     
                     new_feature_list->setName(QString("SIFT Features of ") + param_imageBand->toString());
                     QString descr("The following parameters were used to determine the SIFT Features:\n");
@@ -671,6 +672,10 @@ class SIFTFeatureDetector
                 unlockModels();
             }
         }
+    
+    protected:
+        /** The buffers of the scale space, which are reused between the runs **/
+        SIFTScaleSpace m_scale_space;
 };
 
 /** 
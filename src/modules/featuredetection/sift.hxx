@@ -13,6 +13,12 @@
 #include <vigra/linear_algebra.hxx>
 #include <vigra/splineimageview.hxx>
 
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include <memory>
+
 namespace graipe {
 
 /**
@@ -51,11 +57,11 @@ struct SIFTFeature
  * \return True, if a local minimum or maximum is found.
  */
 template <class T>
-inline bool localExtremum(const std::vector<vigra::MultiArray<2, T> > & dog, int i, int x, int y)
+inline bool localExtremum(const std::vector<vigra::MultiArrayView<2, T> > & dog, int i, int x, int y)
 {
-    const vigra::MultiArray<2, float> & prev = dog[i-3];
-    const vigra::MultiArray<2, float> & curr = dog[i-2];
-    const vigra::MultiArray<2, float> & next = dog[i-1];
+    const vigra::MultiArrayView<2, T> & prev = dog[i-3];
+    const vigra::MultiArrayView<2, T> & curr = dog[i-2];
+    const vigra::MultiArrayView<2, T> & next = dog[i-1];
     
     float v = curr(x,y);
     return (    (    v < curr(x-1,y-1) && v < curr(x,y-1) && v < curr(x+1,y-1)
@@ -63,11 +69,11 @@ inline bool localExtremum(const std::vector<vigra::MultiArray<2, T> > & dog, int
                  &&  v < curr(x-1,y+1) && v < curr(x,y+1) && v < curr(x+1,y+1)
                  
                  &&  v < prev(x-1,y-1) && v < prev(x,y-1) && v < prev(x+1,y-1)
-                 &&  v < prev(x-1,y)   && v < prev(x-1,y) && v < prev(x+1,y)
+                 &&  v < prev(x-1,y)   && v < prev(x,y)   && v < prev(x+1,y)
                  &&  v < prev(x-1,y+1) && v < prev(x,y+1) && v < prev(x+1,y+1)
                  
                  &&  v < next(x-1,y-1) && v < next(x,y-1) && v < next(x+1,y-1)
-                 &&  v < next(x-1,y)   && v < next(x-1,y) && v < next(x+1,y)
+                 &&  v < next(x-1,y)   && v < next(x,y)   && v < next(x+1,y)
                  &&  v < next(x-1,y+1) && v < next(x,y+1) && v < next(x+1,y+1))
             
             ||  (    v > curr(x-1,y-1) && v > curr(x,y-1) && v > curr(x+1,y-1)
@@ -75,11 +81,11 @@ inline bool localExtremum(const std::vector<vigra::MultiArray<2, T> > & dog, int
                  &&  v > curr(x-1,y+1) && v > curr(x,y+1) && v > curr(x+1,y+1)
                  
                  &&  v > prev(x-1,y-1) && v > prev(x,y-1) && v > prev(x+1,y-1)
-                 &&  v > prev(x-1,y)   && v > prev(x-1,y) && v > prev(x+1,y)
+                 &&  v > prev(x-1,y)   && v > prev(x,y)   && v > prev(x+1,y)
                  &&  v > prev(x-1,y+1) && v > prev(x,y+1) && v > prev(x+1,y+1)
                  
                  &&  v > next(x-1,y-1) && v > next(x,y-1) && v > next(x+1,y-1)
-                 &&  v > next(x-1,y)   && v > next(x-1,y) && v > next(x+1,y)
+                 &&  v > next(x-1,y)   && v > next(x,y)   && v > next(x+1,y)
                  &&  v > next(x-1,y+1) && v > next(x,y+1) && v > next(x+1,y+1)));
 }
 
@@ -96,7 +102,7 @@ inline bool localExtremum(const std::vector<vigra::MultiArray<2, T> > & dog, int
  * \return True, if a the extremum can be refined and passes the threshold checks.
  */
 template <class T>
-inline bool adjustLocalExtremum(const std::vector<vigra::MultiArray<2, T> > & dog,
+inline bool adjustLocalExtremum(const std::vector<vigra::MultiArrayView<2, T> > & dog,
                                 SIFTFeature & feature,
                                 float contrast_threshold, float curvature_threshold)
 {
@@ -107,9 +113,9 @@ inline bool adjustLocalExtremum(const std::vector<vigra::MultiArray<2, T> > & do
     unsigned int x = feature.position[0];
     unsigned int y = feature.position[1];
     
-    const vigra::MultiArray<2, float> & prev = dog[i-3];
-    const vigra::MultiArray<2, float> & curr = dog[i-2];
-    const vigra::MultiArray<2, float> & next = dog[i-1];
+    const vigra::MultiArrayView<2, T> & prev = dog[i-3];
+    const vigra::MultiArrayView<2, T> & curr = dog[i-2];
+    const vigra::MultiArrayView<2, T> & next = dog[i-1];
     
     float v = curr(x,y);
     
@@ -131,7 +137,7 @@ inline bool adjustLocalExtremum(const std::vector<vigra::MultiArray<2, T> > & do
     
     hess(0,1) = hess(1,0) = curr(x+1, y+1) - curr(x-1, y+1) - curr(x+1, y-1) + curr(x-1, y-1); //Dxy
     hess(0,2) = hess(2,0) = next(x+1, y)   - next(x-1, y)   - prev(x+1, y)   + prev(x-1, y);   //Dxs
-    hess(1,2) = hess(2,1) = next(y, y+1)   - next(x, y-1)   - prev(x, y+1)   + prev(x, y-1);   //Dys
+    hess(1,2) = hess(2,1) = next(x, y+1)   - next(x, y-1)   - prev(x, y+1)   + prev(x, y-1);   //Dys
     hess/=4.0;
     
     if(!linearSolve(hess, grad, offset))
@@ -190,7 +196,7 @@ inline bool adjustLocalExtremum(const std::vector<vigra::MultiArray<2, T> > & do
  * \return A filled vector with all gaussian distance weighted gradient directions.
  */
 template <class T>
-std::vector<float> computeOrientationHistogram(const vigra::MultiArray<2,T> & img,
+std::vector<float> computeOrientationHistogram(const vigra::MultiArrayView<2,T> & img,
                                                const SIFTFeature & feature,
                                                int radius=8, unsigned int histogram_bins=36)
 {
@@ -288,10 +294,217 @@ inline std::vector<float>  computeSIFTHistograms(const vigra::SplineImageView<OR
     return histograms;
 }
 
+/**
+ * A task of the parallel SIFT computation, which calls a function for
+ * each index of a block of indices.
+ */
+template <class Function>
+class SIFTTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor of a task.
+         *
+         * \param function The function, called as function(index).
+         * \param begin The first index of this task.
+         * \param end The index after the last index of this task.
+         */
+        SIFTTask(const Function& function, unsigned int begin, unsigned int end)
+        :   m_function(function),
+            m_begin(begin),
+            m_end(end)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Calls the function for each index of the block, called by the thread pool.
+         */
+        void run()
+        {
+            for(unsigned int i=m_begin; i<m_end; ++i)
+            {
+                m_function(i);
+            }
+        }
+    
+    private:
+        /** The function **/
+        const Function& m_function;
+        /** The block of indices **/
+        unsigned int m_begin, m_end;
+};
+
+/**
+ * Calls a function for each index 0..count-1 in parallel. The indices are
+ * split into one block per thread. The function needs to write its results
+ * to distinct places for each index.
+ *
+ * \param count The count of indices.
+ * \param function The function, called as function(index).
+ */
+template <class Function>
+void parallelSIFTLoop(unsigned int count, const Function& function)
+{
+    if(count == 0)
+        return;
+    
+    const unsigned int thread_count = std::max<unsigned int>(1, std::min<unsigned int>(QThread::idealThreadCount(), count)),
+                       block_size = (count + thread_count - 1)/thread_count;
+    
+    std::vector<SIFTTask<Function>*> tasks;
+    for(unsigned int t=0; t<thread_count; ++t)
+    {
+        tasks.push_back(new SIFTTask<Function>(function, std::min(count, t*block_size), std::min(count, (t+1)*block_size)));
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(thread_count);
+    
+    for(unsigned int t=1; t<tasks.size(); ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    for(SIFTTask<Function>* task : tasks)
+    {
+        delete task;
+    }
+}
+
+/**
+ * Gaussian smoothing of an image, which is split into one band of rows per thread.
+ * Each band is extended by the radius of the gaussian kernel, such that the result
+ * is the same as for the smoothing of the whole image.
+ *
+ * \param src The source image.
+ * \param dest The destination image of the same shape. Must not be the source image.
+ * \param sigma The sigma of the gaussian.
+ */
+inline void parallelGaussianSmoothing(const vigra::MultiArrayView<2,float> & src, vigra::MultiArrayView<2,float> dest, double sigma)
+{
+    const int width = src.width(),
+              height = src.height(),
+              halo = (int)std::ceil(3.0*sigma) + 1;
+    
+    //Bands, which are not much larger than their halo, are not worth a thread
+    const int band_count  = std::max(1, std::min(QThread::idealThreadCount(), height/std::max(64, 4*halo))),
+              band_height = (height + band_count - 1)/band_count;
+    
+    if(band_count == 1)
+    {
+        vigra::gaussianSmoothing(src, dest, sigma);
+        return;
+    }
+    
+    parallelSIFTLoop(band_count, [&](unsigned int b)
+                                 {
+                                     int core_begin = std::min<int>(height, b*band_height),
+                                         core_end   = std::min<int>(height, (b+1)*band_height),
+                                         halo_begin = std::max(0, core_begin-halo),
+                                         halo_end   = std::min(height, core_end+halo);
+                                     
+                                     if(core_begin >= core_end)
+                                         return;
+                                     
+                                     vigra::MultiArray<2,float> band(vigra::Shape2(width, halo_end-halo_begin));
+                                     vigra::gaussianSmoothing(src.subarray(vigra::Shape2(0, halo_begin), vigra::Shape2(width, halo_end)), band, sigma);
+                                     
+                                     dest.subarray(vigra::Shape2(0, core_begin), vigra::Shape2(width, core_end))
+                                        = band.subarray(vigra::Shape2(0, core_begin-halo_begin), vigra::Shape2(width, core_end-halo_begin));
+                                 });
+}
+
+/**
+ * The buffers of the SIFT scale space (gaussian smoothed images and their DoGs).
+ * They are allocated once for the largest (first) octave, while the smaller octaves
+ * use the upper left part of them. If the same scale space is used for many images,
+ * the buffers will only be reallocated if the image size or the count of levels changes.
+ */
+class SIFTScaleSpace
+{
+    public:
+        /**
+         * Prepares the buffers for a given shape of the first octave and a
+         * given count of intervals per octave.
+         *
+         * \param shape The shape of the first octave.
+         * \param intervals The count of gaussian smoothed images per octave.
+         */
+        void prepare(const vigra::Shape2& shape, unsigned int intervals)
+        {
+            m_gaussians.resize(intervals);
+            m_dogs.resize(intervals-1);
+            
+            for(vigra::MultiArray<2,float>& gaussian : m_gaussians)
+            {
+                if(gaussian.shape() != shape)
+                    gaussian.reshape(shape);
+            }
+            for(vigra::MultiArray<2,float>& dog : m_dogs)
+            {
+                if(dog.shape() != shape)
+                    dog.reshape(shape);
+            }
+        }
+    
+        /**
+         * The gaussian smoothed images of an octave. Each row of the views
+         * is stored contiguously in memory.
+         *
+         * \param shape The shape of the octave.
+         * \return Views to the gaussian smoothed images.
+         */
+        std::vector<vigra::MultiArrayView<2,float> > gaussians(const vigra::Shape2& shape)
+        {
+            return views(m_gaussians, shape);
+        }
+    
+        /**
+         * The DoGs of an octave. Each row of the views is stored contiguously in memory.
+         *
+         * \param shape The shape of the octave.
+         * \return Views to the DoGs.
+         */
+        std::vector<vigra::MultiArrayView<2,float> > dogs(const vigra::Shape2& shape)
+        {
+            return views(m_dogs, shape);
+        }
+    
+    private:
+        /**
+         * The upper left views of a given shape of some buffers.
+         *
+         * \param buffers The buffers.
+         * \param shape The shape of the views.
+         * \return The views.
+         */
+        static std::vector<vigra::MultiArrayView<2,float> > views(std::vector<vigra::MultiArray<2,float> >& buffers, const vigra::Shape2& shape)
+        {
+            std::vector<vigra::MultiArrayView<2,float> > result;
+            for(vigra::MultiArray<2,float>& buffer : buffers)
+            {
+                result.push_back(buffer.subarray(vigra::Shape2(0,0), shape));
+            }
+            return result;
+        }
+    
+        /** The gaussian smoothed images **/
+        std::vector<vigra::MultiArray<2,float> > m_gaussians;
+        /** The DoGs **/
+        std::vector<vigra::MultiArray<2,float> > m_dogs;
+};
+
 /**
  * The main SIFT method. Computes the feature descriptors.
+ * The computation of the scale space, the DoGs, the search for extrema and the
+ * descriptor computation are parallelized within each octave.
  *
  * \param image The input image.
+ * \param scale_space The (reusable) buffers of the scale space.
  * \param sigma The (gaussian scale) sigma by means of a scale step. Defaults to 1.0
  * \param octaves The number of octaves. If zero (=default), it will auto-estimate using a min size of 8x8
  * \param levels The number of levels per octave, for which keypoint may be found
@@ -309,54 +522,63 @@ inline std::vector<float>  computeSIFTHistograms(const vigra::SplineImageView<OR
  */
 template <class T>
 std::vector<SIFTFeature> computeSIFTDescriptors(const vigra::MultiArrayView<2,T> & image,
+                                                SIFTScaleSpace & scale_space,
                                                 float sigma = 1.0, unsigned int octaves=0, unsigned int levels=3,
                                                 float contrast_threshold=0.03, float curvature_threshold=10.0, bool double_image_size=true, bool normalize_image=true)
 {
     using namespace std;
     using namespace vigra;
-    using namespace vigra::multi_math;
     
     //If we rescale the image (double in each direction), we need to adjust the
     //octave offset - thus resulting DoG positions will be divided by two at the
     //lowermost scale if needed
     int o_offset=0;
     
-    vigra::MultiArray<2, float> work_image=image;
+    Shape2 shape = image.shape();
     
     if(double_image_size)
     {
-        work_image.reshape(2*image.shape());
-        
-        resizeImageLinearInterpolation(image, work_image);
-        gaussianSmoothing(work_image, work_image, sigma);
+        shape *= 2;
         o_offset=-1;
     }
     
-    //Determine the number of Octaves
-    if(octaves<1)
-    {
-        octaves = log(std::min(work_image.width(),work_image.height()))/log(2.0)-3;
-    }
-
     //Further parameters
     unsigned int         s = levels;
     float                k = pow(2.0,1.0/s);
     unsigned int intervals = s+3;
     
-    //Data containers:
-    std::vector<MultiArray<2, float> > octave(intervals);
-    std::vector<MultiArray<2, float> > dog(intervals-1);
+    //Data containers, which are reused between the octaves:
+    scale_space.prepare(shape, intervals);
+    
+    MultiArrayView<2, float> base = scale_space.gaussians(shape)[0];
+    
+    //initialise first octave with current (maybe doubled) image
+    if(double_image_size)
+    {
+        resizeImageLinearInterpolation(image, base);
+        gaussianSmoothing(base, base, sigma);
+    }
+    else
+    {
+        base = image;
+    }
+    
+    //Determine the number of Octaves
+    if(octaves<1)
+    {
+        octaves = log(std::min(shape[0], shape[1]))/log(2.0)-3;
+    }
     
     std::vector<SIFTFeature> result;
     
     //Find min and max of image
-    vigra::FindMinMax<T> minmax;   // init functor
-    vigra::inspectImage(work_image, minmax);
+    vigra::FindMinMax<float> minmax;   // init functor
+    vigra::inspectImage(base, minmax);
     
     if(normalize_image)
     {
         //Normalize image to 0..1
-        vigra::transformImage(work_image, work_image,
+        vigra::transformImage(base, base,
                               vigra::linearRangeMapping(
                                                         minmax.min, minmax.max,  // src range
                                                         0.0, 1.0)				// dest range
@@ -367,9 +589,6 @@ std::vector<SIFTFeature> computeSIFTDescriptors(const vigra::MultiArrayView<2,T>
         contrast_threshold *= (minmax.max - minmax.min);
     }
     
-    //initialise first octave with current (maybe doubled) image
-    octave[0] = work_image;
-    
     unsigned int counter_phase1=0;
     unsigned int counter_phase2=0;
     unsigned int counter_phase3=0;
@@ -377,14 +596,18 @@ std::vector<SIFTFeature> computeSIFTDescriptors(const vigra::MultiArrayView<2,T>
     //Run the loop
     for(unsigned int o=0; o<octaves; ++o)
     {
+        const int width  = shape[0],
+                  height = shape[1];
+        
+        //Views to the buffers (since assigning views would copy the data, new ones are created)
+        std::vector<MultiArrayView<2, float> > octave = scale_space.gaussians(shape),
+                                               dog    = scale_space.dogs(shape);
+        
         /**
          * 1. Step create the Octaves and DoGs:
          */
         for (unsigned int i=1; i<intervals; ++i)
         {
-            //initialize curent interval image array
-            octave[i].reshape(octave[i-1].shape());
-
             // (total_sigma)^2 = sigma^2 + (last_sigma)^2
             // --> sigma = sqrt((total_sigma)^2 - (last_sigma)^2)!
             //determine the last sigma
@@ -392,119 +615,223 @@ std::vector<SIFTFeature> computeSIFTDescriptors(const vigra::MultiArrayView<2,T>
                    total_sigma = last_sigma*k,
                    current_sigma = sqrt(total_sigma*total_sigma - last_sigma*last_sigma);
             
-            
-            gaussianSmoothing(octave[i-1], octave[i], current_sigma);
-
-            //Compute the dog
-            dog[i-1].reshape(octave[i].shape());
-            dog[i-1] = octave[i]-octave[i-1];
+            parallelGaussianSmoothing(octave[i-1], octave[i], current_sigma);
         }
         
+        //Compute the DoGs row by row (the rows are contiguous, the inner loop may be vectorized)
+        parallelSIFTLoop(height, [&](unsigned int y)
+                                 {
+                                     for (unsigned int i=1; i<intervals; ++i)
+                                     {
+                                         const float * lower = &octave[i-1](0,y),
+                                                     * upper = &octave[i](0,y);
+                                         float * diff = &dog[i-1](0,y);
+                                         
+                                         for(int x=0; x<width; ++x)
+                                         {
+                                             diff[x] = upper[x] - lower[x];
+                                         }
+                                     }
+                                 });
+        
         /**
-          * 2. Step: Find features on each DoG level,
-          *          adjust them with subpixel accuray
-          *          filter out most of them,
-          *          create orientation histogram,
-          *          align according to max orientation,
-          *          create descriptors
+          * 2. Step: Find features on each DoG level in parallel bands of rows,
+          *          adjust them with subpixel accuray and
+          *          filter out most of them.
+          *          The candidates are collected per level and band to keep
+          *          the order of a sequential search.
           */
-        for (unsigned int i=3; i<intervals; ++i)
+        const unsigned int band_count  = std::max<int>(1, std::min(QThread::idealThreadCount(), (height-2)/16)),
+                           band_height = (height - 2 + band_count - 1)/band_count;
+        
+        std::vector<std::vector<SIFTFeature> > candidates((intervals-3)*band_count);
+        std::vector<unsigned int> counters_phase1(candidates.size(), 0),
+                                  counters_phase2(candidates.size(), 0);
+        
+        parallelSIFTLoop(candidates.size(), [&](unsigned int c)
+                                            {
+                                                unsigned int i = 3 + c/band_count,
+                                                             b = c%band_count,
+                                                             y_begin = 1 + std::min<int>(height-2, b*band_height),
+                                                             y_end   = 1 + std::min<int>(height-2, (b+1)*band_height);
+                                                
+                                                //if we have at least three DoGs, we can search for local extrema
+                                                for (unsigned int y=y_begin; y<y_end; ++y)
+                                                {
+                                                    const float * row = &dog[i-2](0,y);
+                                                    
+                                                    for (int x=1; x<width-1; ++x)
+                                                    {
+                                                        float v = row[x];
+                                                        
+                                                        if ( abs(v) > contrast_threshold)
+                                                        {
+                                                            counters_phase1[c]++;
+                                                            
+                                                            if(localExtremum(dog, i, x, y))
+                                                            {
+                                                                //Create a new feature and initialize it.
+                                                                SIFTFeature new_feature;
+                                                                new_feature.position[0] = x;
+                                                                new_feature.position[1] = y;
+                                                                new_feature.scale = i;
+                                                                new_feature.contrast = abs(v);
+                                                                
+                                                                counters_phase2[c]++;
+                                                                
+                                                                if ( adjustLocalExtremum(dog, new_feature, contrast_threshold, curvature_threshold) )
+                                                                {
+                                                                    candidates[c].push_back(new_feature);
+                                                                }
+                                                            }
+                                                        }
+                                                    }
+                                                }
+                                            });
+        
+        std::vector<SIFTFeature> features;
+        std::vector<bool> level_used(intervals, false);
+        
+        for(unsigned int c=0; c<candidates.size(); ++c)
         {
-            //if we have at least three DoGs, we can search for local extrema
-            for (unsigned int y=1; y<dog[i-2].height()-1; ++y)
+            counter_phase1 += counters_phase1[c];
+            counter_phase2 += counters_phase2[c];
+            
+            for(const SIFTFeature& feature : candidates[c])
             {
-                for (unsigned int x=1; x<dog[i-2].width()-1; ++x)
-                {
-                    float v = dog[i-2](x,y);
-                    
-                    if ( abs(v) > contrast_threshold)
-                    {
-                        counter_phase1++;
-                        
-                        if(localExtremum(dog, i, x, y))
-                        {
-                        
-                            //Create a new feature and initialize it.
-                            SIFTFeature new_feature;
-                            new_feature.position[0] = x;
-                            new_feature.position[1] = y;
-                            new_feature.scale = i;
-                            new_feature.contrast = abs(v);
-                        
-                            counter_phase2++;
-                            
-                            if ( adjustLocalExtremum(dog, new_feature, contrast_threshold, curvature_threshold) )
-                            {
-                                counter_phase3++;
-                                
-                                //switch from DoG to scale space
-								unsigned int best_i = std::floor(new_feature.scale+.5);
-                                std::vector<float> hist = computeOrientationHistogram(octave[best_i], new_feature);
-
-                                int x2 = 0;
-                                double y2 = hist[0];
-                                
-                                for(unsigned int bin=1; bin<hist.size(); ++bin)
-                                {
-                                    if(hist[bin] > y2)
-                                    {
-                                        x2 = bin;
-                                        y2 = hist[bin];
-                                    }
-                                }
-                                
-                                if(y2!=0)
-                                {
-                                    //Interpolate angle using parabola:
-                                    //Collecting values
-                                    int x1 = x2-1;
-                                    int x3 = x2+1;
-                                    double y1 = hist[(36+x1)%36];
-                                    double y3 = hist[(36+x3)%36];
-                                    
-                                    //Estimate parabola
-                                    double denom = (x1 - x2) * (x1 - x3) * (x2 - x3);
-                                    double A     = (x3 * (y2 - y1) + x2 * (y1 - y3) + x1 * (y3 - y2)) / denom;
-                                    double B     = (x3*x3 * (y1 - y2) + x2*x2 * (y3 - y1) + x1*x1 * (y2 - y3)) / denom;
-                                    //double C     = (x2 * x3 * (x2 - x3) * y1 + x3 * x1 * (x3 - x1) * y2 + x1 * x2 * (x1 - x2) * y3) / denom;
-
-                                    double xv = -B / (2*A);
-                                    //double yv = C - B*B / (4*A);
-                        
-                                    //Assign value:
-                                    new_feature.orientation = xv*10.0/180.0*M_PI;
-                                }
-                                else
-                                {
-                                    new_feature.orientation = x2*10.0/180.0*M_PI;
-                                }
-                                
-                                vigra::SplineImageView<2,float> siv(octave[best_i]);
-                                
-                                new_feature.descriptor = computeSIFTHistograms(siv, new_feature);
-
-                                //Rescale from local DoG size to global image size
-                                new_feature.position *= pow(2,o+o_offset);                          //global position
-                                new_feature.scale = pow(2,o+o_offset)*pow(k, new_feature.scale)*sigma;  //global scale
-                                
-                                //Add to results:
-                                result.push_back(new_feature);
-                            }
-                        }
-                    }
-                }
+                level_used[(unsigned int)std::floor(feature.scale+.5)] = true;
+                features.push_back(feature);
             }
         }
+        counter_phase3 += features.size();
+        
+        //One spline view for each level of the scale space, which is used by a feature
+        std::vector<std::unique_ptr<SplineImageView<2,float> > > splines(intervals);
+        
+        parallelSIFTLoop(intervals, [&](unsigned int i)
+                                    {
+                                        if(level_used[i])
+                                        {
+                                            splines[i].reset(new SplineImageView<2,float>(octave[i]));
+                                        }
+                                    });
+        
+        /**
+         * 3. Step: For each feature in parallel:
+         *          create orientation histogram,
+         *          align according to max orientation,
+         *          create descriptors
+         *
+         * The evaluation of a spline view modifies its internal state, thus
+         * each thread uses its own copies of the spline views.
+         */
+        auto describe_feature = [&](unsigned int f, std::vector<std::unique_ptr<SplineImageView<2,float> > >& local_splines)
+                                          {
+                                              SIFTFeature& new_feature = features[f];
+                                              
+                                              //switch from DoG to scale space
+                                              unsigned int best_i = std::floor(new_feature.scale+.5);
+                                              std::vector<float> hist = computeOrientationHistogram(octave[best_i], new_feature);
+                                              
+                                              int x2 = 0;
+                                              double y2 = hist[0];
+                                              
+                                              for(unsigned int bin=1; bin<hist.size(); ++bin)
+                                              {
+                                                  if(hist[bin] > y2)
+                                                  {
+                                                      x2 = bin;
+                                                      y2 = hist[bin];
+                                                  }
+                                              }
+                                              
+                                              if(y2!=0)
+                                              {
+                                                  //Interpolate angle using parabola:
+                                                  //Collecting values
+                                                  int x1 = x2-1;
+                                                  int x3 = x2+1;
+                                                  double y1 = hist[(36+x1)%36];
+                                                  double y3 = hist[(36+x3)%36];
+                                                  
+                                                  //Estimate parabola
+                                                  double denom = (x1 - x2) * (x1 - x3) * (x2 - x3);
+                                                  double A     = (x3 * (y2 - y1) + x2 * (y1 - y3) + x1 * (y3 - y2)) / denom;
+                                                  double B     = (x3*x3 * (y1 - y2) + x2*x2 * (y3 - y1) + x1*x1 * (y2 - y3)) / denom;
+                                                  
+                                                  double xv = -B / (2*A);
+                                                  
+                                                  //Assign value:
+                                                  new_feature.orientation = xv*10.0/180.0*M_PI;
+                                              }
+                                              else
+                                              {
+                                                  new_feature.orientation = x2*10.0/180.0*M_PI;
+                                              }
+                                              
+                                              if(!local_splines[best_i])
+                                              {
+                                                  local_splines[best_i].reset(new SplineImageView<2,float>(*splines[best_i]));
+                                              }
+                                              new_feature.descriptor = computeSIFTHistograms(*local_splines[best_i], new_feature);
+                                              
+                                              //Rescale from local DoG size to global image size
+                                              new_feature.position *= pow(2,o+o_offset);                              //global position
+                                              new_feature.scale = pow(2,o+o_offset)*pow(k, new_feature.scale)*sigma;  //global scale
+                                          };
+        
+        const unsigned int feature_count = features.size(),
+                           thread_count  = std::max<unsigned int>(1, std::min<unsigned int>(QThread::idealThreadCount(), feature_count)),
+                           block_size    = (feature_count + thread_count - 1)/thread_count;
+        
+        parallelSIFTLoop(thread_count, [&](unsigned int t)
+                                       {
+                                           std::vector<std::unique_ptr<SplineImageView<2,float> > > local_splines(intervals);
+                                           
+                                           for(unsigned int f=t*block_size; f<std::min(feature_count, (t+1)*block_size); ++f)
+                                           {
+                                               describe_feature(f, local_splines);
+                                           }
+                                       });
+        
+        //Add to results:
+        result.insert(result.end(), features.begin(), features.end());
         
         //rescale for next pyramid step and resize old image (3rd from top)
-        octave[0].reshape(octave[0].shape()/2);
-        resizeImageNoInterpolation(octave[s], octave[0]);
+        if(o+1 < octaves)
+        {
+            shape /= 2;
+            
+            resizeImageNoInterpolation(octave[s], scale_space.gaussians(shape)[0]);
+        }
     }
     qDebug("SIFT feature detector: %d features are found (%d after phase1, %d after phase 2)", counter_phase3, counter_phase1, counter_phase2);
     
     return result;
 }
 
+/**
+ * The main SIFT method without reusable buffers. Computes the feature descriptors.
+ *
+ * \param image The input image.
+ * \param sigma The (gaussian scale) sigma by means of a scale step. Defaults to 1.0
+ * \param octaves The number of octaves. If zero (=default), it will auto-estimate using a min size of 8x8
+ * \param levels The number of levels per octave, for which keypoint may be found
+ * \param contrast_threshold The keypoint's contrast threshold, Defaults to 0.03 = 3%
+ * \param curvature_threshold The keypoint's edge threshold. Defaults to 10.0 (radius of corner)
+ * \param double_image_size It true, it doubles the image size for 0th scale
+ * \param normalize_image It true, the image will be normalized to 0..1 first.
+ * \return The SIFT features.
+ */
+template <class T>
+std::vector<SIFTFeature> computeSIFTDescriptors(const vigra::MultiArrayView<2,T> & image,
+                                                float sigma = 1.0, unsigned int octaves=0, unsigned int levels=3,
+                                                float contrast_threshold=0.03, float curvature_threshold=10.0, bool double_image_size=true, bool normalize_image=true)
+{
+    SIFTScaleSpace scale_space;
+    return computeSIFTDescriptors(image, scale_space, sigma, octaves, levels, contrast_threshold, curvature_threshold, double_image_size, normalize_image);
+}
+
 /**
  * @}
  */
@@ -45,6 +45,7 @@
 
 //GRAIPE components needed
 #include "features2d/features2d.h"
+#include "images/pooledarray.hxx"
 #include "vectorfields/vectorfields.h"
 #include "registration/registration.h"
 
@@ -157,9 +158,6 @@ SparseWeightedMultiVectorfield2D* matchFeaturesToImage(const vigra::MultiArrayVi
 	unsigned int work_w   = (unsigned int) src1.width(),
                  work_h   = (unsigned int) src1.height();
 	
-	vigra::MultiArray<2,T2> s2_temp(src2.shape());
-	s2_temp.init(0);
-	
     mat = vigra::identityMatrix<double>(3);
     
     if(use_global)
@@ -178,11 +176,15 @@ SparseWeightedMultiVectorfield2D* matchFeaturesToImage(const vigra::MultiArrayVi
 			     result_h = used_max_distance*2+mask_height+1;
     
 	///Create result image (will be used / updated for each features correlation)
-	MultiArray<2,float>	result(result_w, result_h);
+	PooledArray<2,float>	result(Shape2(result_w, result_h));
 	
 	//Create resulting vectorfield
 	SparseWeightedMultiVectorfield2D* result_vf = new SparseWeightedMultiVectorfield2D(features.workspace());
 	
+	//Coalesce all additions into one model update
+	ModelTransaction transaction(result_vf);
+	result_vf->reserve(features.size());
+	
 	
 	for(unsigned int i=0 ; i < features.size(); ++i)
     {
@@ -473,9 +475,6 @@ SparseWeightedMultiVectorfield2D* matchFeaturesToFeatures(const vigra::MultiArra
 	unsigned int work_w   = (unsigned int) src1.width(),
                  work_h   = (unsigned int) src1.height();
     
-	vigra::MultiArray<2,T2> s2_temp(src2.shape());
-	s2_temp.init(0);
-	
     mat = vigra::identityMatrix<double>(3);
     
     if(use_global)
@@ -492,6 +491,10 @@ SparseWeightedMultiVectorfield2D* matchFeaturesToFeatures(const vigra::MultiArra
 	
 	//Create resulting vectorfield
 	SparseWeightedMultiVectorfield2D*  result_vf = new SparseWeightedMultiVectorfield2D(s1_features.workspace());
+	
+	//Coalesce all additions into one model update
+	ModelTransaction transaction(result_vf);
+	result_vf->reserve(s1_features.size());
 		
 	for(unsigned int i=0 ; i < s1_features.size(); ++i)
 	{ 
@@ -714,6 +717,10 @@ SparseWeightedMultiVectorfield2D* matchFeaturesToFeaturesUsingShapeContext(const
 	//Create resulting vectorfield
 	SparseWeightedMultiVectorfield2D* result_vf = new SparseWeightedMultiVectorfield2D(s1_features.workspace());
 	
+	//Coalesce all additions into one model update
+	ModelTransaction transaction(result_vf);
+	result_vf->reserve(s1_features.size());
+	
 	unsigned int max_radius = max(mask_width,mask_height)/2.0,
 			     angle_bins = 8;
 	
@@ -111,6 +111,10 @@ SparseWeightedMultiVectorfield2D* matchSIFTFeaturesUsingDistance(const vigra::Mu
     //Create resulting vectorfield
     SparseWeightedMultiVectorfield2D* result_vf = new SparseWeightedMultiVectorfield2D(points1.workspace());
     
+    //Coalesce all additions into one model update
+    ModelTransaction transaction(result_vf);
+    result_vf->reserve(points1.size());
+    
     for(unsigned int i=0; i<points1.size(); i++)
     {
         QVector<float> di = points1.descriptor(i);
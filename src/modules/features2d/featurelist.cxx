@@ -90,6 +90,26 @@ void PointFeatureList2D::addFeature(const PointType& p)
 	updateModel();
 }
 
+void PointFeatureList2D::addFeatures(const QVector<PointType>& points)
+{
+    if(locked())
+        return;
+    
+    ModelTransaction transaction(this);
+    
+    reserve(size() + points.size());
+    
+    for(const PointType& p : points)
+    {
+        addFeature(p);
+    }
+}
+
+void PointFeatureList2D::reserve(unsigned int count)
+{
+    m_points.reserve(count);
+}
+
 void PointFeatureList2D::removeFeature(unsigned int index)
 {
     if(locked())
@@ -278,6 +298,29 @@ void WeightedPointFeatureList2D::addFeature(const PointType& p,float weight)
     PointFeatureList2D::addFeature(p);
 }
 
+void WeightedPointFeatureList2D::addFeatures(const QVector<PointType>& points, const QVector<float>& weights)
+{
+    if(locked())
+        return;
+    
+    Q_ASSERT(points.size() == weights.size());
+    
+    ModelTransaction transaction(this);
+    
+    reserve(size() + points.size());
+    
+    for(int i=0; i<points.size(); ++i)
+    {
+        addFeature(points[i], weights[i]);
+    }
+}
+
+void WeightedPointFeatureList2D::reserve(unsigned int count)
+{
+    m_weights.reserve(count);
+    PointFeatureList2D::reserve(count);
+}
+
 void WeightedPointFeatureList2D::removeFeature(unsigned int index)
 {
     if(locked())
@@ -416,6 +459,29 @@ void EdgelFeatureList2D::addFeature(const PointType& p,float weight, float orien
     WeightedPointFeatureList2D::addFeature(p, weight);
 }
 
+void EdgelFeatureList2D::addFeatures(const QVector<PointType>& points, const QVector<float>& weights, const QVector<float>& orientations)
+{
+    if(locked())
+        return;
+    
+    Q_ASSERT(points.size() == weights.size() && points.size() == orientations.size());
+    
+    ModelTransaction transaction(this);
+    
+    reserve(size() + points.size());
+    
+    for(int i=0; i<points.size(); ++i)
+    {
+        addFeature(points[i], weights[i], orientations[i]);
+    }
+}
+
+void EdgelFeatureList2D::reserve(unsigned int count)
+{
+    m_orientations.reserve(count);
+    WeightedPointFeatureList2D::reserve(count);
+}
+
 void EdgelFeatureList2D::removeFeature(unsigned int index)
 {
     if(locked())
@@ -576,6 +642,13 @@ void SIFTFeatureList2D::addFeature(const PointType& p, float weight, float orien
     EdgelFeatureList2D::addFeature(p, weight, orientation);
 }
 
+void SIFTFeatureList2D::reserve(unsigned int count)
+{
+    m_scales.reserve(count);
+    m_descriptors.reserve(count);
+    EdgelFeatureList2D::reserve(count);
+}
+
 void SIFTFeatureList2D::removeFeature(unsigned int index)
 {
     if(locked())
@@ -119,6 +119,23 @@ class GRAIPE_FEATURES2D_EXPORT PointFeatureList2D
          * \param p The new feature.
          */
 		virtual void addFeature(const PointType& p);
+    
+        /**
+         * Addition of many point features to the list at once. Only one model
+         * update will be performed for all features.
+         * Does nothing if the model is locked.
+         *
+         * \param points The new features.
+         */
+		void addFeatures(const QVector<PointType>& points);
+    
+        /**
+         * Reserves the storage for a given count of features to avoid
+         * reallocations when adding many features.
+         *
+         * \param count The count of features to reserve storage for.
+         */
+		virtual void reserve(unsigned int count);
 		
         /**
          * Removal of a feature at a certain index.
@@ -263,6 +280,29 @@ class GRAIPE_FEATURES2D_EXPORT WeightedPointFeatureList2D
          */
         virtual void addFeature(const PointType& p, float weight);
     
+        /**
+         * Addition of many weighted features to the list at once. Only one model
+         * update will be performed for all features.
+         * Does nothing if the model is locked.
+         *
+         * \param points The new features.
+         * \param weights The weights of the new features (same size as points).
+         */
+		void addFeatures(const QVector<PointType>& points, const QVector<float>& weights);
+    
+        /**
+         * Make the unweighted bulk addition available, too.
+         */
+        using PointFeatureList2D::addFeatures;
+    
+        /**
+         * Reserves the storage for a given count of features to avoid
+         * reallocations when adding many features.
+         *
+         * \param count The count of features to reserve storage for.
+         */
+		void reserve(unsigned int count);
+    
         /**
          * Specialized removal of a feature at a certain index.
          * Does nothing if the model is locked or the index is out of range.
@@ -417,6 +457,30 @@ class GRAIPE_FEATURES2D_EXPORT EdgelFeatureList2D
          */
         virtual void addFeature(const PointType& p, float weight, float orientation);
     
+        /**
+         * Addition of many edgel features to the list at once. Only one model
+         * update will be performed for all features.
+         * Does nothing if the model is locked.
+         *
+         * \param points The new features.
+         * \param weights The weights of the new features (same size as points).
+         * \param orientations The orientations of the new features (same size as points).
+         */
+		void addFeatures(const QVector<PointType>& points, const QVector<float>& weights, const QVector<float>& orientations);
+    
+        /**
+         * Make the unweighted and weighted bulk additions available, too.
+         */
+        using WeightedPointFeatureList2D::addFeatures;
+    
+        /**
+         * Reserves the storage for a given count of features to avoid
+         * reallocations when adding many features.
+         *
+         * \param count The count of features to reserve storage for.
+         */
+		void reserve(unsigned int count);
+    
         /**
          * Specialized removal of a feature at a certain index.
          * Does nothing if the model is locked or the index is out of range.
@@ -598,6 +662,14 @@ class GRAIPE_FEATURES2D_EXPORT SIFTFeatureList2D
          * \param descr The SIFT descriptor of the feature
          */
         virtual void addFeature(const PointType& p, float weight, float orientation, float scale, const QVector<float> & descr);
+    
+        /**
+         * Reserves the storage for a given count of features to avoid
+         * reallocations when adding many features.
+         *
+         * \param count The count of features to reserve storage for.
+         */
+		void reserve(unsigned int count);
         
         /**
          * Specialized removal of a feature at a certain index.
@@ -51,6 +51,37 @@ namespace graipe {
  * @}
  */
 
+/**
+ * Computes the bounds of all point features for the spatial index of the views.
+ * Since each feature is a point, the bounds have an empty size.
+ *
+ * \param features The point feature list.
+ * \param bounds Will be filled with the bounds of each feature.
+ */
+static void pointFeatureBounds(const PointFeatureList2D* features, std::vector<QRectF>& bounds)
+{
+    bounds.resize(features->size());
+    
+    for(unsigned int i=0; i<bounds.size(); ++i)
+    {
+        bounds[i] = QRectF(features->position(i), QSizeF(0,0));
+    }
+}
+
+/**
+ * The margin of the painted features around their bounds.
+ *
+ * \param radius The radius of each painted feature.
+ * \param show_labels Are the labels painted, too?
+ * \param font_size The font size of the labels.
+ * \return The margin around the features' bounds.
+ */
+static qreal featurePaintMargin(qreal radius, bool show_labels, qreal font_size)
+{
+    //Labels are painted right of the features' positions
+    return radius + (show_labels ? 5*font_size : 0);
+}
+
 PointFeatureList2DViewController::PointFeatureList2DViewController(PointFeatureList2D* features)
 :	ViewController(features),
     m_stats(new PointFeatureList2DStatistics(features)),
@@ -58,7 +89,8 @@ PointFeatureList2DViewController::PointFeatureList2DViewController(PointFeatureL
     m_fontSize(new FloatParameter("Label font size:", 1.0e-6f, 1.0e+6f, 10, m_showLabels)),
     m_mode(NULL),
     m_radius(new FloatParameter("Radius:", 1.0e-6f, 1.0e+6f, 2)),
-    m_color(new ColorParameter("Color:", Qt::yellow))
+    m_color(new ColorParameter("Color:", Qt::yellow)),
+    m_spatial_index_dirty(true)
 {
     QStringList modes;
 	modes.append("Select"); modes.append("Create"); modes.append("Delete");
@@ -70,6 +102,9 @@ PointFeatureList2DViewController::PointFeatureList2DViewController(PointFeatureL
     m_parameters->addParameter("mode", m_mode);
     m_parameters->addParameter("radius", m_radius);
     m_parameters->addParameter("color", m_color);
+    
+    //Keep the painted features as a pixmap until the view or model changes
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 PointFeatureList2DViewController::~PointFeatureList2DViewController()
@@ -102,11 +137,21 @@ void PointFeatureList2DViewController::paint(QPainter *painter,
 	f.setPointSizeF(m_radius->value()/fm.height());
 	painter->setFont(f);
 	
-	for(unsigned int i=0; i<features->size(); ++i)
+	//Only paint the features inside the exposed rectangle, at most one per device pixel
+	std::vector<unsigned int> visible;
+	visibleFeatures(option, visible);
+	
+	qreal lod = levelOfDetail(painter);
+	ScreenSpaceAggregator aggregator(exposedRect(option), lod > 0 ? 1.0/lod : 0.0);
+	
+	for(unsigned int i : visible)
 	{
         //Assuming  PointType==QPointF
         const PointFeatureList2D::PointType& p = features->position(i);
         
+        if(!aggregator.accept(p))
+            continue;
+        
         painter->drawEllipse(p, m_radius->value(), m_radius->value());
 		
 		if(m_showLabels->value())
@@ -140,6 +185,28 @@ QRectF PointFeatureList2DViewController::boundingRect() const
     
 }
 
+void PointFeatureList2DViewController::updateView()
+{
+	ViewController::updateView();
+    
+    m_spatial_index_dirty = true;
+}
+
+void PointFeatureList2DViewController::visibleFeatures(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible)
+{
+    if(m_spatial_index_dirty)
+    {
+        std::vector<QRectF> bounds;
+        pointFeatureBounds(static_cast<PointFeatureList2D*>(model()), bounds);
+        
+        m_spatial_index.build(bounds);
+        m_spatial_index_dirty = false;
+    }
+    
+    qreal margin = featurePaintMargin(m_radius->value(), m_showLabels->value(), m_fontSize->value());
+    m_spatial_index.query(exposedRect(option).adjusted(-margin, -margin, margin, margin), visible);
+}
+
 void PointFeatureList2DViewController::hoverMoveEvent(QGraphicsSceneHoverEvent * event)
 {	
 	QGraphicsItem::hoverMoveEvent(event);
@@ -266,7 +333,8 @@ WeightedPointFeatureList2DViewController::WeightedPointFeatureList2DViewControll
     m_showWeightLegend(new BoolParameter("Show weight legend:", false)),
     m_legendCaption(new StringParameter("Legend Caption", "weights", 20, m_showWeightLegend)),
     m_legendTicks(new IntParameter("Legend ticks", 0, 1000, 10, m_showWeightLegend)),
-    m_legendDigits(new IntParameter("Legend digits", 0, 10, 2, m_showWeightLegend))
+    m_legendDigits(new IntParameter("Legend digits", 0, 10, 2, m_showWeightLegend)),
+    m_spatial_index_dirty(true)
 {
     QStringList modes;
 	modes.append("Select"); modes.append("Create"); modes.append("Delete");
@@ -306,6 +374,9 @@ WeightedPointFeatureList2DViewController::WeightedPointFeatureList2DViewControll
 	m_weight_legend->setDigits(m_legendDigits->value());
 	m_weight_legend->setZValue(zValue());
 	
+    //Keep the painted features as a pixmap until the view or model changes
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    
     //force controller ui update
     updateParameters(true);
 	
@@ -339,17 +410,27 @@ void WeightedPointFeatureList2DViewController::paint(QPainter *painter, const QS
 	f.setPointSizeF(m_radius->value()/fm.height());
 	painter->setFont(f);
 	
-	for(unsigned int i=0; i<features->size(); ++i)
+	//Only paint the features inside the exposed rectangle, at most one per device pixel
+	std::vector<unsigned int> visible;
+	visibleFeatures(option, visible);
+	
+	qreal lod = levelOfDetail(painter);
+	ScreenSpaceAggregator aggregator(exposedRect(option), lod > 0 ? 1.0/lod : 0.0);
+	
+	for(unsigned int i : visible)
 	{
         if(	(features->weight(i) >= m_minWeight->value()) &&  (features->weight(i) <= m_maxWeight->value()) )
 		{
+            //Assuming PointType==QPointF
+            const PointFeatureList2D::PointType& pos = features->position(i);
+            
+            if(!aggregator.accept(pos))
+                continue;
+            
 			float current_weight =		std::max(0.0f, std::min(1.0f,(features->weight(i)-m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
 			
 			painter->setBrush(QColor(m_colorTable->value().at(current_weight*255)));
             
-            //Assuming PointType==QPointF
-            const PointFeatureList2D::PointType& pos = features->position(i);
-            
 			painter->drawEllipse(pos, m_radius->value(), m_radius->value());
 			
 			if(m_showLabels->value())
@@ -413,6 +494,8 @@ void WeightedPointFeatureList2DViewController::updateView()
 {
 	ViewController::updateView();
     
+    m_spatial_index_dirty = true;
+    
 	//Underly colorful gradient of velocity to legend
     m_weight_legend->setColorTable(m_colorTable->value());
     m_weight_legend->setValueRange(m_minWeight->value(), m_maxWeight->value());
@@ -421,6 +504,26 @@ void WeightedPointFeatureList2DViewController::updateView()
     m_weight_legend->setDigits(m_legendDigits->value());
 }
 
+void WeightedPointFeatureList2DViewController::computeFeatureBounds(std::vector<QRectF>& bounds) const
+{
+    pointFeatureBounds(static_cast<const WeightedPointFeatureList2D*>(m_model), bounds);
+}
+
+void WeightedPointFeatureList2DViewController::visibleFeatures(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible)
+{
+    if(m_spatial_index_dirty)
+    {
+        std::vector<QRectF> bounds;
+        computeFeatureBounds(bounds);
+        
+        m_spatial_index.build(bounds);
+        m_spatial_index_dirty = false;
+    }
+    
+    qreal margin = featurePaintMargin(m_radius->value(), m_showLabels->value(), m_fontSize->value());
+    m_spatial_index.query(exposedRect(option).adjusted(-margin, -margin, margin, margin), visible);
+}
+
 void WeightedPointFeatureList2DViewController::hoverMoveEvent(QGraphicsSceneHoverEvent * event)
 {	
 	QGraphicsItem::hoverMoveEvent(event);
@@ -577,16 +680,26 @@ void EdgelFeatureList2DViewController::paint(QPainter *painter, const QStyleOpti
              << QPointF(-m_radius->value(),  m_radius->value()*0.6)
              << QPointF( m_radius->value(),  0);
     
-	for(unsigned int i=0; i<features->size(); ++i)
+	//Only paint the features inside the exposed rectangle, at most one per device pixel
+	std::vector<unsigned int> visible;
+	visibleFeatures(option, visible);
+	
+	qreal lod = levelOfDetail(painter);
+	ScreenSpaceAggregator aggregator(exposedRect(option), lod > 0 ? 1.0/lod : 0.0);
+	
+	for(unsigned int i : visible)
 	{
 		if(	(features->weight(i) >= m_minWeight->value()) &&  (features->weight(i) <= m_maxWeight->value()) )
 		{
+            const PointFeatureList2D::PointType& pos = features->position(i);
+            
+            if(!aggregator.accept(pos))
+                continue;
+            
 			float current_weight = std::max(0.0f, std::min(1.0f,(features->weight(i)-m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
 			
 			painter->setBrush(QColor(m_colorTable->value().at(current_weight*255)));
             
-            const PointFeatureList2D::PointType& pos = features->position(i);
-            
             QTransform t;
             t.translate(pos.x(), pos.y());
             t.rotate(features->angle(i));
@@ -769,7 +882,12 @@ void SIFTFeatureList2DViewController::paint(QPainter *painter, const QStyleOptio
 	strokes[2] = Qt::blue;
 	strokes[3] = Qt::yellow;
 	
-	for(unsigned int i = 0; i<features->size(); ++i)
+	//Only paint the features inside the exposed rectangle. Features at the same position
+	//are not aggregated, since they are marked as alternatives below
+	std::vector<unsigned int> visible;
+	visibleFeatures(option, visible);
+	
+	for(unsigned int i : visible)
 	{
 		if(	(features->weight(i) >= m_minWeight->value()) &&  (features->weight(i) <= m_maxWeight->value()) )
 		{
@@ -819,6 +937,22 @@ void SIFTFeatureList2DViewController::paint(QPainter *painter, const QStyleOptio
 	ViewController::paintAfter(painter, option, widget);
 }
 
+void SIFTFeatureList2DViewController::computeFeatureBounds(std::vector<QRectF>& bounds) const
+{
+    const SIFTFeatureList2D * features = static_cast<const SIFTFeatureList2D*>(m_model);
+    
+    bounds.resize(features->size());
+    
+    for(unsigned int i=0; i<bounds.size(); ++i)
+    {
+        //The rotated unit square, scaled by the feature's scale, fits into this circle
+        qreal r = features->scale(i)*M_SQRT1_2;
+        const PointFeatureList2D::PointType& pos = features->position(i);
+        
+        bounds[i] = QRectF(pos.x()-r, pos.y()-r, 2*r, 2*r);
+    }
+}
+
 void SIFTFeatureList2DViewController::hoverMoveEvent(QGraphicsSceneHoverEvent * event)
 {	
 	QGraphicsItem::hoverMoveEvent(event);
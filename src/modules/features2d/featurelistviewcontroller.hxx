@@ -37,6 +37,7 @@
 #define GRAIPE_FEATURES2D_FEATURELISTVIEWCONTROLLER_HXX
 
 #include "core/viewcontroller.hxx"
+#include "core/spatialindex.hxx"
 #include "core/qt_ext/qlegend.hxx"
 
 #include "features2d/featurelist.hxx"
@@ -101,6 +102,11 @@ class GRAIPE_FEATURES2D_EXPORT PointFeatureList2DViewController
          * \return The bounding rectangle of this view.
          */
         QRectF boundingRect() const;
+    
+        /**
+         * Specialization of the update of the view according to the current parameter settings.
+         */
+        void updateView();
         
     protected:
         /**
@@ -117,6 +123,16 @@ class GRAIPE_FEATURES2D_EXPORT PointFeatureList2DViewController
          */
         void mousePressEvent (QGraphicsSceneMouseEvent * event);
     
+        /**
+         * Finds all features, which need to be painted for the current paint call.
+         * The spatial index of the features is rebuilt, if the model has changed.
+         *
+         * \param option The style options of the current paint call.
+         * \param visible Will be filled with the indices of all features, which intersect
+         *                the exposed rectangle.
+         */
+        void visibleFeatures(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible);
+    
         /** Statistics **/
         PointFeatureList2DStatistics * m_stats;
     
@@ -132,6 +148,11 @@ class GRAIPE_FEATURES2D_EXPORT PointFeatureList2DViewController
         /**
         * @}
         */
+    
+        /** Spatial index of all features **/
+        SpatialIndex2D m_spatial_index;
+        /** Needs the spatial index to be rebuilt? **/
+        bool m_spatial_index_dirty;
 };
 
 /**
@@ -212,6 +233,24 @@ class GRAIPE_FEATURES2D_EXPORT WeightedPointFeatureList2DViewController
          */
         void mousePressEvent (QGraphicsSceneMouseEvent * event);
     
+        /**
+         * Computes the bounds of all features for the spatial index.
+         * Specialized for features, which extend w.r.t. their scale.
+         *
+         * \param bounds Will be filled with the bounding rectangle of each feature.
+         */
+        virtual void computeFeatureBounds(std::vector<QRectF>& bounds) const;
+    
+        /**
+         * Finds all features, which need to be painted for the current paint call.
+         * The spatial index of the features is rebuilt, if the model has changed.
+         *
+         * \param option The style options of the current paint call.
+         * \param visible Will be filled with the indices of all features, which intersect
+         *                the exposed rectangle.
+         */
+        void visibleFeatures(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible);
+    
         /** Statistics **/
         WeightedPointFeatureList2DStatistics * m_stats;
     
@@ -236,6 +275,11 @@ class GRAIPE_FEATURES2D_EXPORT WeightedPointFeatureList2DViewController
     
         /** Weight legend **/
         QLegend * m_weight_legend;
+    
+        /** Spatial index of all features **/
+        SpatialIndex2D m_spatial_index;
+        /** Needs the spatial index to be rebuilt? **/
+        bool m_spatial_index_dirty;
 };
 
 /**
@@ -348,6 +392,14 @@ class GRAIPE_FEATURES2D_EXPORT SIFTFeatureList2DViewController
          * \param event The mouse event which triggered this function.
          */
         void hoverMoveEvent(QGraphicsSceneHoverEvent * event);
+    
+        /**
+         * Computes the bounds of all features for the spatial index.
+         * Specialized to cover the scaled square of each SIFT feature.
+         *
+         * \param bounds Will be filled with the bounding rectangle of each feature.
+         */
+        void computeFeatureBounds(std::vector<QRectF>& bounds) const;
         
         /** Statistics **/
         SIFTFeatureList2DStatistics * m_stats;
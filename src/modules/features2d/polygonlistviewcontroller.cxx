@@ -20,6 +20,54 @@ namespace graipe {
  * @}
  */
 
+/**
+ * Finds the visible polygons of a polygon list by means of its spatial index,
+ * which is rebuilt before, if necessary.
+ *
+ * \param polygons The polygon list.
+ * \param index The spatial index of the polygon list.
+ * \param dirty Needs the index to be rebuilt? Will be reset afterwards.
+ * \param rect The exposed rectangle.
+ * \param margin The margin of the painted polygons (e.g. the line width).
+ * \param visible Will be filled with the indices of the visible polygons.
+ */
+static void findVisiblePolygons(const PolygonList2D* polygons, SpatialIndex2D& index, bool& dirty,
+                                const QRectF& rect, qreal margin, std::vector<unsigned int>& visible)
+{
+    if(dirty)
+    {
+        std::vector<QRectF> bounds(polygons->size());
+        
+        for(unsigned int i=0; i<bounds.size(); ++i)
+        {
+            bounds[i] = polygons->polygon(i).boundingRect();
+        }
+        index.build(bounds);
+        dirty = false;
+    }
+    index.query(rect.adjusted(-margin, -margin, margin, margin), visible);
+}
+
+/**
+ * Level of detail test for polygons: Polygons, which are smaller than one cell
+ * of the screen-space aggregator, are only painted, if no other one has been
+ * painted at the same cell before.
+ *
+ * \param polygon The polygon.
+ * \param aggregator The screen-space aggregator of the current paint call.
+ * \param cell_size The cell size of the aggregator.
+ * \return True, if the polygon shall be painted.
+ */
+static bool acceptPolygon(const QPolygonF& polygon, ScreenSpaceAggregator& aggregator, qreal cell_size)
+{
+    QRectF bounds = polygon.boundingRect();
+    
+    if(bounds.width() > cell_size || bounds.height() > cell_size)
+        return true;
+    
+    return aggregator.accept(bounds.center());
+}
+
 PolygonList2DViewController::PolygonList2DViewController(PolygonList2D* polygons)
 :	ViewController(polygons),
     m_polygons(polygons),
@@ -28,7 +76,8 @@ PolygonList2DViewController::PolygonList2DViewController(PolygonList2D* polygons
     m_fontSize(new FloatParameter("Label font size:", 1.0e-6f, 1.0e+6f, 10, m_showLabels)),
     m_mode(NULL),
     m_lineWidth(new FloatParameter("Line width:", 1.0e-6f, 1.0e+6f, 2)),
-    m_color(new ColorParameter("Color:", Qt::yellow))
+    m_color(new ColorParameter("Color:", Qt::yellow)),
+    m_spatial_index_dirty(true)
 {
     QStringList modes;
 	modes.append("Select"); modes.append("Create"); modes.append("Delete");
@@ -40,6 +89,9 @@ PolygonList2DViewController::PolygonList2DViewController(PolygonList2D* polygons
     m_parameters->addParameter("mode", m_mode);
     m_parameters->addParameter("lineWidth", m_lineWidth);
     m_parameters->addParameter("color", m_color);
+    
+    //Keep the painted polygons as a pixmap until the view or model changes
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 PolygonList2DViewController::~PolygonList2DViewController()
@@ -74,14 +126,25 @@ void PolygonList2DViewController::paint(QPainter *painter, const QStyleOptionGra
         painter->setPen(new_pen);
         painter->setFont(QFont("Arial",m_fontSize->value()));
         
-        for(unsigned int i=0; i<m_polygons->size(); i++)
+        //Only paint the polygons inside the exposed rectangle, aggregate the tiny ones
+        std::vector<unsigned int> visible;
+        visiblePolygons(option, visible);
+        
+        qreal lod = levelOfDetail(painter),
+              cell_size = lod > 0 ? 1.0/lod : 0.0;
+        ScreenSpaceAggregator aggregator(exposedRect(option), cell_size);
+        
+        for(unsigned int i : visible)
         {
-            painter->drawPolygon(m_polygons->polygon(i));
+            if(acceptPolygon(m_polygons->polygon(i), aggregator, cell_size))
+            {
+                painter->drawPolygon(m_polygons->polygon(i));
+            }
         }	
         
         if(m_showLabels->value())
         {
-            for(unsigned int i=0; i<m_polygons->size(); i++)
+            for(unsigned int i : visible)
             {
                 painter->drawText(m_polygons->polygon(i)[0], QString("%1").arg(i));
             }
@@ -101,6 +164,18 @@ QRectF PolygonList2DViewController::boundingRect() const
     return ViewController::boundingRect().united(rect);
 }
 
+void PolygonList2DViewController::updateView()
+{
+    ViewController::updateView();
+    
+    m_spatial_index_dirty = true;
+}
+
+void PolygonList2DViewController::visiblePolygons(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible)
+{
+    findVisiblePolygons(m_polygons, m_spatial_index, m_spatial_index_dirty, exposedRect(option), m_lineWidth->value(), visible);
+}
+
 void PolygonList2DViewController::mousePressEvent(QGraphicsSceneMouseEvent * event)
 {
     QGraphicsItem::mousePressEvent(event);
@@ -154,6 +229,7 @@ void PolygonList2DViewController::mousePressEvent(QGraphicsSceneMouseEvent * eve
 
 WeightedPolygonList2DViewController::WeightedPolygonList2DViewController(WeightedPolygonList2D * polygons)
 :	ViewController(polygons),
+    m_polygons(polygons),
     m_stats(new WeightedPolygonList2DStatistics(polygons)),
     m_showLabels(new BoolParameter("Show labels:", false)),
     m_fontSize(new FloatParameter("Label font size:", 1.0e-6f, 1.0e+6f, 10, m_showLabels)),
@@ -165,7 +241,8 @@ WeightedPolygonList2DViewController::WeightedPolygonList2DViewController(Weighte
     m_showWeightLegend(new BoolParameter("Show weight legend:", false)),
     m_legendCaption(new StringParameter("Legend Caption", "weights", 20, m_showWeightLegend)),
     m_legendTicks(new IntParameter("Legend ticks", 0, 1000, 10, m_showWeightLegend)),
-    m_legendDigits(new IntParameter("Legend digits", 0, 10, 2, m_showWeightLegend))
+    m_legendDigits(new IntParameter("Legend digits", 0, 10, 2, m_showWeightLegend)),
+    m_spatial_index_dirty(true)
 {
     QStringList modes;
 	modes.append("Select"); modes.append("Create"); modes.append("Delete");
@@ -205,6 +282,9 @@ WeightedPolygonList2DViewController::WeightedPolygonList2DViewController(Weighte
     m_weight_legend->setDigits(m_legendDigits->value());
     m_weight_legend->setZValue(zValue());
     
+    //Keep the painted polygons as a pixmap until the view or model changes
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    
     //force controller ui update
     updateParameters(true);
     
@@ -243,9 +323,18 @@ void WeightedPolygonList2DViewController::paint(QPainter *painter, const QStyleO
         painter->setFont(QFont("Arial",m_fontSize->value()));
         
         
-        for(unsigned int i=0; i<m_polygons->size(); ++i)
+        //Only paint the polygons inside the exposed rectangle, aggregate the tiny ones
+        std::vector<unsigned int> visible;
+        visiblePolygons(option, visible);
+        
+        qreal lod = levelOfDetail(painter),
+              cell_size = lod > 0 ? 1.0/lod : 0.0;
+        ScreenSpaceAggregator aggregator(exposedRect(option), cell_size);
+        
+        for(unsigned int i : visible)
         {
-            if(	(m_polygons->weight(i) >= m_minWeight->value()) &&  (m_polygons->weight(i) <= m_maxWeight->value()) )
+            if(	(m_polygons->weight(i) >= m_minWeight->value()) &&  (m_polygons->weight(i) <= m_maxWeight->value())
+                && acceptPolygon(m_polygons->polygon(i), aggregator, cell_size))
             {
                 float current_weight = std::max(0.0f, std::min(1.0f,(m_polygons->weight(i)-m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
                 
@@ -257,7 +346,7 @@ void WeightedPolygonList2DViewController::paint(QPainter *painter, const QStyleO
         
         if(m_showLabels->value())
         {
-            for(unsigned int i=0; i<m_polygons->size(); ++i)
+            for(unsigned int i : visible)
             {
                 painter->drawText(m_polygons->polygon(i)[0], QString("%1").arg(i));
             }
@@ -308,6 +397,8 @@ void WeightedPolygonList2DViewController::updateView()
 {
     ViewController::updateView();
     
+    m_spatial_index_dirty = true;
+    
     //Underly colorful gradient of velocity to legend
     m_weight_legend->setColorTable(m_colorTable->value());
     
@@ -317,4 +408,9 @@ void WeightedPolygonList2DViewController::updateView()
     m_weight_legend->setDigits(m_legendDigits->value());
 }
 
+void WeightedPolygonList2DViewController::visiblePolygons(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible)
+{
+    findVisiblePolygons(m_polygons, m_spatial_index, m_spatial_index_dirty, exposedRect(option), m_lineWidth->value(), visible);
+}
+
 } //End of namespace graipe
@@ -37,6 +37,7 @@
 #define GRAIPE_FEATURES2D_POLYGONLISTVIEWCONTROLLER_HXX
 
 #include "core/viewcontroller.hxx"
+#include "core/spatialindex.hxx"
 #include "core/qt_ext/qlegend.hxx"
 
 #include "features2d/polygonlist.hxx"
@@ -101,6 +102,11 @@ class GRAIPE_FEATURES2D_EXPORT PolygonList2DViewController
         {
             return "PolygonList2DViewController";
         }
+    
+        /**
+         * Specialization of the update of the view according to the current parameter settings.
+         */
+        void updateView();
         
     protected:
         /**
@@ -110,6 +116,15 @@ class GRAIPE_FEATURES2D_EXPORT PolygonList2DViewController
          */
         void mousePressEvent(QGraphicsSceneMouseEvent * event);
     
+        /**
+         * Finds all polygons, which need to be painted for the current paint call.
+         * The spatial index of the polygons is rebuilt, if the model has changed.
+         *
+         * \param option The style options of the current paint call.
+         * \param visible Will be filled with the indices of all polygons, which intersect
+         *                the exposed rectangle.
+         */
+        void visiblePolygons(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible);
     
         /** Pointer to the polygons (to avaid casts) **/
         PolygonList2D* m_polygons;
@@ -129,6 +144,11 @@ class GRAIPE_FEATURES2D_EXPORT PolygonList2DViewController
         /**
          * @}
          */
+    
+        /** Spatial index of all polygons **/
+        SpatialIndex2D m_spatial_index;
+        /** Needs the spatial index to be rebuilt? **/
+        bool m_spatial_index_dirty;
 };
    
 /**
@@ -196,6 +216,16 @@ class GRAIPE_FEATURES2D_EXPORT WeightedPolygonList2DViewController
         void updateView();
         
     protected:
+        /**
+         * Finds all polygons, which need to be painted for the current paint call.
+         * The spatial index of the polygons is rebuilt, if the model has changed.
+         *
+         * \param option The style options of the current paint call.
+         * \param visible Will be filled with the indices of all polygons, which intersect
+         *                the exposed rectangle.
+         */
+        void visiblePolygons(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible);
+    
         /** Pointer to the weighted polygons (to avaid casts) **/
         WeightedPolygonList2D* m_polygons;
     
@@ -223,6 +253,11 @@ class GRAIPE_FEATURES2D_EXPORT WeightedPolygonList2DViewController
     
         /** Weight legend **/
         QLegend * m_weight_legend;
+    
+        /** Spatial index of all polygons **/
+        SpatialIndex2D m_spatial_index;
+        /** Needs the spatial index to be rebuilt? **/
+        bool m_spatial_index_dirty;
 };
     
 /**
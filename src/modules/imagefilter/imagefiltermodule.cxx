@@ -178,7 +178,7 @@ class FrostFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         frostFilter(current_image->band(m_phase),
-                                    new_image->band(m_phase),
+                                    new_image->writableBand(m_phase),
                                     vigra::Diff2D(param_windowSize->value(),param_windowSize->value()),
                                     param_damping_k->value(),
                                     vigra::BorderTreatmentMode(param_btmode->value()));
@@ -295,7 +295,7 @@ class EnhancedFrostFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         enhancedFrostFilter(current_image->band(m_phase),
-                                            new_image->band(m_phase),
+                                            new_image->writableBand(m_phase),
                                             vigra::Diff2D(param_windowSize->value(), param_windowSize->value()),
                                             param_damping_k->value(), param_enl->value(),
                                             vigra::BorderTreatmentMode(param_btmode->value()));
@@ -412,7 +412,7 @@ class GammaMAPFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         gammaMAPFilter(current_image->band(m_phase),
-                                       new_image->band(m_phase),
+                                       new_image->writableBand(m_phase),
                                        vigra::Diff2D(param_windowSize->value(), param_windowSize->value()),
                                        param_enl->value(),
                                        vigra::BorderTreatmentMode(param_btmode->value()));
@@ -527,7 +527,7 @@ class KuanFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         kuanFilter(current_image->band(m_phase),
-                                   new_image->band(m_phase),
+                                   new_image->writableBand(m_phase),
                                    vigra::Diff2D(param_windowSize->value(), param_windowSize->value()),
                                    param_enl->value(),
                                    vigra::BorderTreatmentMode(param_btmode->value()));
@@ -642,7 +642,7 @@ class LeeFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         leeFilter(current_image->band(m_phase),
-                                  new_image->band(m_phase),
+                                  new_image->writableBand(m_phase),
                                   vigra::Diff2D(param_windowSize->value(), param_windowSize->value()),
                                   param_enl->value(),
                                   vigra::BorderTreatmentMode(param_btmode->value()));
@@ -762,7 +762,7 @@ class EnhancedLeeFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         enhancedLeeFilter(current_image->band(m_phase),
-                                          new_image->band(m_phase),
+                                          new_image->writableBand(m_phase),
                                           vigra::Diff2D(param_windowSize->value(), param_windowSize->value()),
                                           param_damping_k->value(), param_enl->value(),
                                           vigra::BorderTreatmentMode(param_btmode->value()));
@@ -875,7 +875,7 @@ class MedianFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         medianFilter(current_image->band(m_phase),
-                                     new_image->band(m_phase),
+                                     new_image->writableBand(m_phase),
                                      vigra::Diff2D(param_windowSize->value(), param_windowSize->value()),
                                      vigra::BorderTreatmentMode(param_btmode->value()));
                                              
@@ -991,7 +991,7 @@ class ShockFilter
                     for( m_phase=0; m_phase < m_phase_count; m_phase++)
                     {	
                         shockFilter(current_image->band(m_phase),
-                                    new_image->band(m_phase),
+                                    new_image->writableBand(m_phase),
                                     param_iSigma->value(), param_oSigma->value(),
                                     param_upwind->value(), param_iterations->value());
                         
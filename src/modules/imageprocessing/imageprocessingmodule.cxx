@@ -128,23 +128,28 @@ class AddImages
                         image->copyMetadata(*new_image);
                         new_image->setName(QString("addition of ") + param_images->toString());
                         
-                        //iterate
-                        for(unsigned int i = 0; i < selected_images.size(); ++i)
+                        //Sum of all images in one pass: b0 + b1 + ... + bN
+                        QString sum("b0");
+                        
+                        for(unsigned int i = 1; i < selected_images.size(); ++i)
                         {
+                            sum += QString(" + b%1").arg(i);
+                        }
+                        BandExpression expression(sum);
+                        
+                        for( unsigned int c=0; c < new_image->numBands(); c++)
+                        {
+                            std::vector<vigra::MultiArrayView<2,float> > bands;
                             
-                            image = static_cast<Image<float>*>( selected_images[i] );
-                            
-                            vigra_precondition(image->size() == new_image->size() && image->numBands() == new_image->numBands(), "images are of different size");
-                            
-                            for( unsigned int c=0; c < image->numBands(); c++)
+                            for(unsigned int i = 0; i < selected_images.size(); ++i)
                             {
-                                using namespace vigra::functor;
-                        
-                                vigra::combineTwoImages(image->band(c),
-                                                        new_image->band(c),
-                                                        new_image->band(c),
-                                                        Arg1()+Arg2());
+                                image = static_cast<Image<float>*>( selected_images[i] );
+                                
+                                vigra_precondition(image->size() == new_image->size() && image->numBands() == new_image->numBands(), "images are of different size");
+                                
+                                bands.push_back(image->band(c));
                             }
+                            expression.evaluate(bands, new_image->writableBand(c));
                         }
                         
                         m_results.push_back(new_image);
@@ -180,6 +185,138 @@ Algorithm* createAddImages(Workspace* wsp)
 
 
 
+/**
+ * This algorithm computes a new image band by means of a per-pixel expression
+ * over the bands of any count of images (see BandExpression). The bands of all
+ * selected images are numbered consecutively in their order of selection: 
+ * b0 is the first band of the first image and so on.
+ */
+class BandCalculator
+:   public Algorithm
+{
+    public:
+        /**
+         * Default constructor. Adds all neccessary parameters for this algorithm to run.
+         *
+         * \param wsp The workspace to be used.
+         */
+        BandCalculator(Workspace* wsp)
+        : Algorithm(wsp)
+        {
+            m_parameters->addParameter("images", new MultiModelParameter("Images",	"Image", NULL, false, wsp));
+            m_parameters->addParameter("expression", new StringParameter("Expression (bands: b0, b1, ...)", "b0", 40));
+        }
+    
+        /**
+         * Returns the name of this algorithm.
+         * 
+         * \return Always: "BandCalculator"
+         */
+        QString typeName() const
+        {
+            return "BandCalculator";
+        }
+    
+        /**
+         * Specialization of the running phase of this algorithm.
+         */
+        void run()
+        {
+            if(!parametersValid())
+            {
+                //Parameters set incorrectly
+                emit errorMessage(QString("Some parameters are not available"));
+            }
+            else
+            {
+                lockModels();
+                try 
+                {
+                    emit statusMessage(0.0, QString("started"));
+                    
+                    MultiModelParameter	* param_images      = static_cast<MultiModelParameter*> ((*m_parameters)["images"]);
+                    StringParameter	* param_expression  = static_cast<StringParameter*> ((*m_parameters)["expression"]);
+                    
+                    std::vector<Model*> selected_images = param_images->value();
+                    
+                    if (selected_images.size() == 0)
+                    {
+                        emit errorMessage(QString("Explainable error occured: No images have been selected"));
+                    }
+                    else
+                    {
+                        //Compile first to report syntax errors before any allocation
+                        BandExpression expression(param_expression->value());
+                        
+                        std::vector<vigra::MultiArrayView<2,float> > bands;
+                        
+                        for(Model* model : selected_images)
+                        {
+                            Image<float>* image = static_cast<Image<float>*>(model);
+                            
+                            for( unsigned int c=0; c < image->numBands(); c++)
+                            {
+                                bands.push_back(image->band(c));
+                            }
+                        }
+                        
+                        if(bands.size() < expression.bandCount())
+                        {
+                            throw std::runtime_error(QString("The expression needs %1 bands, but only %2 are given").arg(expression.bandCount()).arg(bands.size()).toStdString());
+                        }
+                        
+                        emit statusMessage(1.0, QString("starting computation"));
+                        
+                        //take the first image as a master for size and metadata
+                        Image<float>* image = static_cast<Image<float>*>( selected_images[0] );
+                        
+                        Image<float>* new_image = new Image<float>(image->size(), 1, m_workspace);
+                        
+                        //Copy all metadata from current image (will be overwritten later),
+                        //but keep the single result band
+                        image->copyMetadata(*new_image);
+                        new_image->setNumBands(1);
+                        new_image->setName(QString("band calculation of ") + param_images->toString());
+                        
+                        expression.evaluate(bands, new_image->writableBand(0), this);
+                        
+                        QString descr("The following parameters were used for the band calculation:\n");
+                        descr += m_parameters->valueText("ModelParameter");
+                        new_image->setDescription(descr);
+                        
+                        m_results.push_back(new_image);
+                        
+                        emit statusMessage(100.0, QString("finished computation"));
+                        emit finished();
+                    }
+                }
+                catch(std::exception& e)
+                {
+                    emit errorMessage(QString("Explainable error occured: ") + QString::fromStdString(e.what()));
+                }
+                catch(...)
+                {
+                    emit errorMessage(QString("Non-explainable error occured"));		
+                }
+                unlockModels();
+            }
+        }
+};
+
+/**
+ * Creates a new band calculator algorithm
+ *
+ * \param wsp The workspace to be used.
+ * \return A new instance of the BandCalculator algorithm.
+ */
+Algorithm* createBandCalculator(Workspace* wsp)
+{
+	return new BandCalculator(wsp);
+}
+
+
+
+
 /**
  * This algorithm computes the Gaussian gradient at a certain scale of an image.
  * The result is returned by means of a dense vectorfield.
@@ -353,8 +490,8 @@ class RecursiveSmoothingFilter : public Algorithm
                     
                     for( unsigned int c=0; c < current_image->numBands(); c++)
                     {
-                        vigra::recursiveSmoothX(current_image->band(c), new_image->band(c), scale);// vigra::BorderTreatmentMode(param_btmode->value()));
-                        vigra::recursiveSmoothY(new_image->band(c), new_image->band(c), scale);//, vigra::BorderTreatmentMode(param_btmode->value())));
+                        vigra::recursiveSmoothX(current_image->band(c), new_image->writableBand(c), scale);// vigra::BorderTreatmentMode(param_btmode->value()));
+                        vigra::recursiveSmoothY(new_image->band(c), new_image->writableBand(c), scale);//, vigra::BorderTreatmentMode(param_btmode->value())));
                     }
                     QString descr("The following parameters were used for recursive smoothing:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -461,8 +598,8 @@ class GaussianSmoothingFilter : public Algorithm
                     
                     for( unsigned int c=0; c < current_image->numBands(); c++)
                     {
-                        vigra::separableConvolveX(current_image->band(c), new_image->band(c), gauss);//, vigra::BorderTreatmentMode(param_btmode->value())) );
-                        vigra::separableConvolveY(new_image->band(c), new_image->band(c), gauss);//, vigra::BorderTreatmentMode(param_btmode->value())));
+                        vigra::separableConvolveX(current_image->band(c), new_image->writableBand(c), gauss);//, vigra::BorderTreatmentMode(param_btmode->value())) );
+                        vigra::separableConvolveY(new_image->band(c), new_image->writableBand(c), gauss);//, vigra::BorderTreatmentMode(param_btmode->value())));
                     }
                     QString descr("The following parameters were used for gaussian smoothing:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -583,7 +720,7 @@ class NormalizedGaussianSmoothingFilter : public Algorithm
                     {
                         vigra::normalizedConvolveImage(current_image->band(c),
                                                        mask,
-                                                       new_image->band(c), gauss2d);
+                                                       new_image->writableBand(c), gauss2d);
                     }
                     QString descr("The following parameters were used for normalized gaussian smoothing:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -696,7 +833,7 @@ class ApplyMaskToImage
                         
                         vigra::combineTwoImages(image->band(c),
                                                 mask,
-                                                new_image->band(c),
+                                                new_image->writableBand(c),
                                                 Arg1()*Arg2());
                     }
                     QString descr("The following parameters were used for masking:\n");
@@ -803,7 +940,7 @@ class MaskErosion
                     new_image->setName(QString("Mask erosion: ") + param_mask->toString());
                     
                     vigra::multiBinaryErosion(mask,
-                                       new_image->band(0),
+                                       new_image->writableBand(0),
                                        param_radius->value());
                     
                     QString descr("The following parameters were used for mask erosion:\n");
@@ -910,7 +1047,7 @@ class MaskDilation
                     new_image->setName(QString("Mask dilation: ") + param_mask->toString());
                     
                     vigra::multiBinaryDilation(mask,
-                                        new_image->band(0),
+                                        new_image->writableBand(0),
                                         param_radius->value());
                     
                     QString descr("The following parameters were used for mask dilation:\n");
@@ -1016,12 +1153,11 @@ class MaskUnion
                     
                     new_image->setName(QString("Mask union: ") + param_mask1->image()->name() + " and " + param_mask2->image()->name());
                     
-                    using namespace vigra::functor;
+                    std::vector<vigra::MultiArrayView<2,float> > bands;
+                    bands.push_back(mask1);
+                    bands.push_back(mask2);
                     
-                    vigra::combineTwoImages(mask1,
-                                            mask2,
-                                            new_image->band(0),
-                                            Arg1() || Arg2());
+                    BandExpression("b0 || b1").evaluate(bands, new_image->writableBand(0));
                     
                     QString descr("The following parameters were used for mask union:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -1122,12 +1258,11 @@ class MaskIntersection: public Algorithm
                     
                     new_image->setName(QString("Mask intersec.: ") + param_mask1->toString() + " and " + param_mask2->toString());
                     
-                    using namespace vigra::functor;
+                    std::vector<vigra::MultiArrayView<2,float> > bands;
+                    bands.push_back(mask1);
+                    bands.push_back(mask2);
                     
-                    vigra::combineTwoImages(mask1,
-                                            mask2,
-                                            new_image->band(0),
-                                            Arg1() && Arg2());
+                    BandExpression("b0 && b1").evaluate(bands, new_image->writableBand(0));
                     
                     QString descr("The following parameters were used for mask intersection:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -1230,12 +1365,11 @@ class MaskDifference: public Algorithm
                     
                     new_image->setName(QString("Mask difference: ") + param_mask1->toString() + " and " + param_mask2->toString());
                     
-                    using namespace vigra::functor;
+                    std::vector<vigra::MultiArrayView<2,float> > bands;
+                    bands.push_back(mask1);
+                    bands.push_back(mask2);
                     
-                    vigra::combineTwoImages(mask1,
-                                            mask2,
-                                            new_image->band(0),
-                                            Arg1() && !Arg2());
+                    BandExpression("b0 && !b1").evaluate(bands, new_image->writableBand(0));
                     
                     QString descr("The following parameters were used for mask difference:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -1347,19 +1481,17 @@ class ImageCropper
                     vigra_assert( lr_x<= current_image->width() && lr_y<=current_image->height(), "LowerRight coords have to be <= (width,height)");
                     
                     
-                    //create new image and do the transform
-                    Image<float>* new_image = new Image<float>(vigra::Shape2(lr_x - ul_x, lr_y - ul_y), current_image->numBands(), m_workspace);
+                    //create new image, which is a view into the current image's bands
+                    Image<float>* new_image = new Image<float>(m_workspace);
+                    
+                    //No bands will be allocated for the new image until the transaction is commited
+                    ModelTransaction transaction(new_image);
                     
                     //Copy all metadata from current image (will be overwritten later)
                     current_image->copyMetadata(*new_image);
                     
                     new_image->setName(QString("cropped ") + current_image->name());
                     
-                    for( unsigned int c=0; c < current_image->numBands(); c++)
-                    {
-                        new_image->setBand(c, current_image->band(c));
-                    }
-                    
                     QString descr("The following parameters were used for cropping:\n");
                     descr += m_parameters->valueText("ModelParameter");
                     new_image->setDescription(descr);
@@ -1378,6 +1510,10 @@ class ImageCropper
                     new_image->setGlobalRight( current_image->globalLeft() + lr_x/current_image->width() * (current_image->globalRight() - current_image->globalLeft()) );
                     new_image->setGlobalBottom( current_image->globalTop() + lr_y/current_image->height() * (current_image->globalBottom() - current_image->globalTop()) );
                     
+                    //Crop without copying: strided views into the current image's bands
+                    new_image->shareSubImage(*current_image, vigra::Shape2(ul_x, ul_y));
+                    transaction.commit();
+                    
                     m_results.push_back(new_image);
                     emit statusMessage(100.0, QString("finished computation"));
                     emit finished();
@@ -1409,6 +1545,105 @@ Algorithm* createImageCropper(Workspace* wsp)
 
 
 
+/**
+ * This algorithm selects one band of an image as a new single-band image.
+ * The new image references the band of the original image without copying it.
+ */
+class ImageBandSelector
+:   public Algorithm
+{
+    public:
+        /**
+         * Default constructor. Adds all neccessary parameters for this algorithm to run.
+         *
+         * \param wsp The workspace to be used.
+         */
+        ImageBandSelector(Workspace* wsp)
+        : Algorithm(wsp)
+        {
+            m_parameters->addParameter("image", new ImageBandParameter<float>("Image band", NULL, false, wsp));
+        }
+    
+        /**
+         * Returns the name of this algorithm.
+         * 
+         * \return Always: "ImageBandSelector"
+         */
+        QString typeName() const
+        {
+            return "ImageBandSelector";
+        }
+    
+        /**
+         * Specialization of the running phase of this algorithm.
+         */
+        void run()
+        {
+            if(!parametersValid())
+            {
+                //Parameters set incorrectly
+                emit errorMessage(QString("Some parameters are not available"));
+            }
+            else
+            {
+                lockModels();
+                try 
+                {
+                    emit statusMessage(0.0, QString("started"));
+                    
+                    ImageBandParameter<float>* param_imageBand = static_cast<ImageBandParameter<float>*> ((*m_parameters)["image"]);
+                    
+                    Image<float>* current_image = param_imageBand->image();
+                    
+                    //create new image, which references the selected band
+                    Image<float>* new_image = new Image<float>(m_workspace);
+                    
+                    //No bands will be allocated for the new image until the transaction is commited
+                    ModelTransaction transaction(new_image);
+                    
+                    //Copy all metadata from current image (will be overwritten later)
+                    current_image->copyMetadata(*new_image);
+                    new_image->setNumBands(1);
+                    
+                    new_image->setName(QString("band %1 of ").arg(param_imageBand->bandId()) + current_image->name());
+                    
+                    QString descr("The following parameters were used for band selection:\n");
+                    descr += m_parameters->valueText("ImageBandParameter<float>");
+                    new_image->setDescription(descr);
+                    
+                    new_image->shareBand(0, *current_image, param_imageBand->bandId());
+                    transaction.commit();
+                    
+                    m_results.push_back(new_image);
+                    emit statusMessage(100.0, QString("finished computation"));
+                    emit finished();
+                }
+                catch(std::exception& e)
+                {
+                    emit errorMessage(QString("Explainable error occured: ") + QString::fromStdString(e.what()));
+                }
+                catch(...)
+                {
+                    emit errorMessage(QString("Non-explainable error occured"));		
+                }
+                unlockModels();
+            }
+        }
+};
+
+/**
+ * Creates a new algorithm for the selection of an image band.
+ *
+ * \param wsp The workspace to be used.
+ * \return A new instance of the ImageBandSelector.
+ */
+Algorithm* createImageBandSelector(Workspace* wsp)
+{
+	return new ImageBandSelector(wsp);
+}
+
+
+
 /**
  * This algorithm computes a resized image using a new width and height for the image.
  * The local and global coordinates of the image are not updated, so that is still covers 
@@ -1485,32 +1720,32 @@ class ImageResizer : public Algorithm
                         {
                             case 5:
                                 vigra::resizeImageSplineInterpolation(current_image->band(c),
-                                                                      new_image->band(c),
+                                                                      new_image->writableBand(c),
                                                                       vigra::BSpline<5, float>());
                                 break;
                             case 4:
                                 vigra::resizeImageSplineInterpolation(current_image->band(c),
-                                                                      new_image->band(c),
+                                                                      new_image->writableBand(c),
                                                                       vigra::BSpline<4, float>());
                                 break;
                             case 3:
                                 vigra::resizeImageSplineInterpolation(current_image->band(c),
-                                                                      new_image->band(c),
+                                                                      new_image->writableBand(c),
                                                                       vigra::BSpline<3, float>());
                                 break;
                             case 2:
                                 vigra::resizeImageSplineInterpolation(current_image->band(c),
-                                                                      new_image->band(c),
+                                                                      new_image->writableBand(c),
                                                                       vigra::BSpline<2, float>());
                                 break;
                             case 1:
                                 vigra::resizeImageLinearInterpolation(current_image->band(c),
-                                                                      new_image->band(c));
+                                                                      new_image->writableBand(c));
                                 break;
                             default:
                             case 0:
                                 vigra::resizeImageNoInterpolation(current_image->band(c),
-                                                                  new_image->band(c));
+                                                                  new_image->writableBand(c));
                                 break;
                         }
                     }
@@ -1616,6 +1851,9 @@ class ImageInverter
                     
                     new_image->setName(QString("inverted ") + current_image->name());
                     
+                    BandExpression expression;
+                    QMap<QString, float> constants;
+                    
                     for( unsigned int c=0; c < current_image->numBands(); c++)
                     {
                         float offset = param_offset->value();
@@ -1629,11 +1867,11 @@ class ImageInverter
                             offset =  minmax.max;
                         }
                         
-                        using namespace vigra::functor;
+                        constants["offset"] = offset;
+                        expression.compile("offset - b0", constants);
                         
-                        vigra::transformImage(current_image->band(c),
-                                              new_image->band(c),
-                                              Param(offset)-Arg1());
+                        expression.evaluate(std::vector<vigra::MultiArrayView<2,float> >(1, current_image->band(c)),
+                                            new_image->writableBand(c));
                         
                     }
                     QString descr("The following parameters were used for inverting:\n");
@@ -1745,13 +1983,14 @@ class ImageThresholder
                     
                     new_image->setName(QString("thresholded ") + param_imageBand->toString());
                     
-                    using namespace vigra::functor;
+                    QMap<QString, float> constants;
+                    constants["low"] = param_lowerT->value();
+                    constants["hi"]  = param_upperT->value();
+                    constants["no"]  = param_mark0->value();
+                    constants["yes"] = param_mark1->value();
                     
-                    vigra::transformImage(imageband,
-                                          new_image->band(0),
-                                          ifThenElse(Arg1()<Param(param_lowerT->value()) || Arg1()>Param(param_upperT->value()),
-                                                     Param(param_mark0->value()),
-                                                     Param(param_mark1->value())));
+                    BandExpression("b0 < low || b0 > hi ? no : yes", constants).evaluate(std::vector<vigra::MultiArrayView<2,float> >(1, imageband),
+                                                                                         new_image->writableBand(0));
                     
                     QString descr("The following parameters were used for thresholding:\n");
                     descr += m_parameters->valueText("ModelParameter");
@@ -1861,40 +2100,24 @@ class FloatingImageThresholder
                     
                     vigra::MultiArrayView<2,float> imageband = param_imageBand->value();
                     
-                    float temp_val, temp_lowerT, temp_upperT;
+                    //The position along the floating direction in [0, 1)
+                    QString pos = param_horizontally->value() ? "x/width" : "y/height";
                     
-                    vigra::MultiArray<2,float> res(imageband.shape());
+                    QMap<QString, float> constants;
+                    constants["lowS"] = param_lowerT_start->value();
+                    constants["hiS"]  = param_upperT_start->value();
+                    constants["lowE"] = param_lowerT_end->value();
+                    constants["hiE"]  = param_upperT_end->value();
+                    constants["no"]   = param_mark0->value();
+                    constants["yes"]  = param_mark1->value();
                     
-                    for(unsigned int y=0; y< imageband.height(); y++)
-                    {
-                        for(unsigned int x=0; x< imageband.width(); x++)
-                        {
-                            temp_val = imageband(x,y);
-                            if( param_horizontally->value() )
-                            {
-                                temp_lowerT = param_lowerT_start->value() + float(x)/imageband.width()*(param_lowerT_end->value() - param_lowerT_start->value());
-                                temp_upperT = param_upperT_start->value() + float(x)/imageband.width()*(param_upperT_end->value() - param_upperT_start->value());
-                            }
-                            else 
-                            {							
-                                temp_lowerT = param_lowerT_start->value() + float(y)/imageband.height()*(param_lowerT_end->value() - param_lowerT_start->value());
-                                temp_upperT = param_upperT_start->value() + float(y)/imageband.height()*(param_upperT_end->value() - param_upperT_start->value());
-                            }
-
-                            if(temp_val<temp_lowerT || temp_val>temp_upperT )
-                            {
-                                res(x,y) = param_mark0->value();
-                            }
-                            else 
-                            {
-                                res(x,y) = param_mark1->value();
-                            }
-                        }
-                    }
+                    BandExpression expression(QString("b0 < lowS + %1*(lowE - lowS) || b0 > hiS + %1*(hiE - hiS) ? no : yes").arg(pos), constants);
                     
                     //create new image and do the transform
                     Image<float>* new_image = new Image<float>(imageband.shape(), 1, m_workspace);
-                    new_image->setBand(0, res);
+                    
+                    expression.evaluate(std::vector<vigra::MultiArrayView<2,float> >(1, imageband),
+                                        new_image->writableBand(0));
                     
                     //Copy all metadata from current image (will be overwritten later)
                     param_imageBand->image()->copyMetadata(*new_image);
@@ -2072,11 +2295,11 @@ class ThinLineExtractor
                     
                     //create new image and do the transform
                     Image<float>* new_image = new Image<float>(imageband.shape(), 1, m_workspace);
-                    new_image->setBand(0, res);
+                    new_image->takeBand(0, res);
                     
                     Image<float>* new_stat_image = new Image<float>(imageband.shape(), 2, m_workspace);
-                    new_stat_image->setBand(0, res_stats_val);
-                    new_stat_image->setBand(1, res_stats_val);
+                    new_stat_image->takeBand(0, res_stats_val);
+                    new_stat_image->shareBand(1, *new_stat_image, 0);
                     
                     //Copy all metadata from current image (will be overwritten later)
                     param_imageBand->image()->copyMetadata(*new_image);
@@ -2196,7 +2419,7 @@ class DistanceTransformator
                     new_image->setName(QString("distance transform of ") + param_imageBand->toString());
                     
                     using namespace vigra::functor;
-                    vigra::distanceTransform(imageband, new_image->band(0), 1 ,2);
+                    vigra::distanceTransform(imageband, new_image->writableBand(0), 1 ,2);
                     
                     QString descr("No parameters needed for distance transform!");
                     new_image->setDescription(descr);
@@ -2318,6 +2541,12 @@ class ImageProcessingModule
 			alg_item.algorithm_fptr = &createImageCropper;
 			alg_factory.push_back(alg_item);
 			
+			//Image band selection
+			alg_item.algorithm_name = "Select image band";
+            alg_item.algorithm_type = "ImageBandSelector";
+			alg_item.algorithm_fptr = &createImageBandSelector;
+			alg_factory.push_back(alg_item);
+			
 			//5. Image Resizer
 			alg_item.algorithm_name = "Resize image";
             alg_item.algorithm_type = "ImageResizer";
@@ -2336,6 +2565,12 @@ class ImageProcessingModule
 			alg_item.algorithm_fptr = &createAddImages;
 			alg_factory.push_back(alg_item);
 			
+			//8. Band calculator
+			alg_item.algorithm_name = "Band calculator";
+            alg_item.algorithm_type = "BandCalculator";
+			alg_item.algorithm_fptr = &createBandCalculator;
+			alg_factory.push_back(alg_item);
+			
 			
 			alg_item.topic_name = "Mask processing";
 			
@@ -0,0 +1,1030 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#include "images/bandmath.hxx"
+
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_images
+ * @{
+ *     @file
+ *     @brief Implementation file for the band math expression engine
+ * @}
+ */
+
+/**
+ * @{
+ * The per-pixel operations. Each of them is used as a template argument
+ * for the tile kernels below, so that each kernel is a plain loop over
+ * a tile, which can be vectorized by the compiler.
+ */
+struct BandMathAdd          { static float apply(float a, float b) { return a + b; } };
+struct BandMathSubtract     { static float apply(float a, float b) { return a - b; } };
+struct BandMathMultiply     { static float apply(float a, float b) { return a * b; } };
+struct BandMathDivide       { static float apply(float a, float b) { return a / b; } };
+struct BandMathPower        { static float apply(float a, float b) { return std::pow(a, b); } };
+struct BandMathMinimum      { static float apply(float a, float b) { return a < b ? a : b; } };
+struct BandMathMaximum      { static float apply(float a, float b) { return a > b ? a : b; } };
+struct BandMathLess         { static float apply(float a, float b) { return a <  b ? 1.0f : 0.0f; } };
+struct BandMathLessEqual    { static float apply(float a, float b) { return a <= b ? 1.0f : 0.0f; } };
+struct BandMathGreater      { static float apply(float a, float b) { return a >  b ? 1.0f : 0.0f; } };
+struct BandMathGreaterEqual { static float apply(float a, float b) { return a >= b ? 1.0f : 0.0f; } };
+struct BandMathEqual        { static float apply(float a, float b) { return a == b ? 1.0f : 0.0f; } };
+struct BandMathNotEqual     { static float apply(float a, float b) { return a != b ? 1.0f : 0.0f; } };
+struct BandMathAnd          { static float apply(float a, float b) { return (a != 0 && b != 0) ? 1.0f : 0.0f; } };
+struct BandMathOr           { static float apply(float a, float b) { return (a != 0 || b != 0) ? 1.0f : 0.0f; } };
+
+struct BandMathNegate       { static float apply(float a) { return -a; } };
+struct BandMathNot          { static float apply(float a) { return a == 0 ? 1.0f : 0.0f; } };
+struct BandMathAbs          { static float apply(float a) { return std::abs(a); } };
+struct BandMathSqrt         { static float apply(float a) { return std::sqrt(a); } };
+struct BandMathExp          { static float apply(float a) { return std::exp(a); } };
+struct BandMathLog          { static float apply(float a) { return std::log(a); } };
+struct BandMathFloor        { static float apply(float a) { return std::floor(a); } };
+struct BandMathCeil         { static float apply(float a) { return std::ceil(a); } };
+struct BandMathSin          { static float apply(float a) { return std::sin(a); } };
+struct BandMathCos          { static float apply(float a) { return std::cos(a); } };
+/**
+ * @}
+ */
+
+/**
+ * Tile kernel for binary operations of two tiles: a = a op b.
+ *
+ * \param a The first operand and the result.
+ * \param b The second operand.
+ * \param n The count of pixels of the tile.
+ */
+template <class Op>
+void bandMathKernel(float* a, const float* b, unsigned int n)
+{
+    for(unsigned int i=0; i<n; ++i)
+    {
+        a[i] = Op::apply(a[i], b[i]);
+    }
+}
+
+/**
+ * Tile kernel for binary operations of a tile and a scalar: a = a op b.
+ *
+ * \param a The first operand and the result.
+ * \param b The scalar second operand.
+ * \param n The count of pixels of the tile.
+ */
+template <class Op>
+void bandMathKernel(float* a, float b, unsigned int n)
+{
+    for(unsigned int i=0; i<n; ++i)
+    {
+        a[i] = Op::apply(a[i], b);
+    }
+}
+
+/**
+ * Tile kernel for unary operations: a = op a.
+ *
+ * \param a The operand and the result.
+ * \param n The count of pixels of the tile.
+ */
+template <class Op>
+void bandMathKernel(float* a, unsigned int n)
+{
+    for(unsigned int i=0; i<n; ++i)
+    {
+        a[i] = Op::apply(a[i]);
+    }
+}
+
+/**
+ * Dispatches a binary operation to the corresponding kernel.
+ *
+ * \param op The operation.
+ * \param a The first operand and the result.
+ * \param b The second operand (tile or scalar).
+ * \param n The count of pixels of the tile.
+ */
+template <class Operand>
+void bandMathBinary(BandExpression::OpCode op, float* a, Operand b, unsigned int n)
+{
+    switch(op)
+    {
+        case BandExpression::Add:          bandMathKernel<BandMathAdd>(a, b, n);          break;
+        case BandExpression::Subtract:     bandMathKernel<BandMathSubtract>(a, b, n);     break;
+        case BandExpression::Multiply:     bandMathKernel<BandMathMultiply>(a, b, n);     break;
+        case BandExpression::Divide:       bandMathKernel<BandMathDivide>(a, b, n);       break;
+        case BandExpression::Power:        bandMathKernel<BandMathPower>(a, b, n);        break;
+        case BandExpression::Minimum:      bandMathKernel<BandMathMinimum>(a, b, n);      break;
+        case BandExpression::Maximum:      bandMathKernel<BandMathMaximum>(a, b, n);      break;
+        case BandExpression::Less:         bandMathKernel<BandMathLess>(a, b, n);         break;
+        case BandExpression::LessEqual:    bandMathKernel<BandMathLessEqual>(a, b, n);    break;
+        case BandExpression::Greater:      bandMathKernel<BandMathGreater>(a, b, n);      break;
+        case BandExpression::GreaterEqual: bandMathKernel<BandMathGreaterEqual>(a, b, n); break;
+        case BandExpression::Equal:        bandMathKernel<BandMathEqual>(a, b, n);        break;
+        case BandExpression::NotEqual:     bandMathKernel<BandMathNotEqual>(a, b, n);     break;
+        case BandExpression::And:          bandMathKernel<BandMathAnd>(a, b, n);          break;
+        case BandExpression::Or:           bandMathKernel<BandMathOr>(a, b, n);           break;
+        default: break;
+    }
+}
+
+/**
+ * Dispatches a unary operation to the corresponding kernel.
+ *
+ * \param op The operation.
+ * \param a The operand and the result.
+ * \param n The count of pixels of the tile.
+ */
+void bandMathUnary(BandExpression::OpCode op, float* a, unsigned int n)
+{
+    switch(op)
+    {
+        case BandExpression::Negate: bandMathKernel<BandMathNegate>(a, n); break;
+        case BandExpression::Not:    bandMathKernel<BandMathNot>(a, n);    break;
+        case BandExpression::Abs:    bandMathKernel<BandMathAbs>(a, n);    break;
+        case BandExpression::Sqrt:   bandMathKernel<BandMathSqrt>(a, n);   break;
+        case BandExpression::Exp:    bandMathKernel<BandMathExp>(a, n);    break;
+        case BandExpression::Log:    bandMathKernel<BandMathLog>(a, n);    break;
+        case BandExpression::Floor:  bandMathKernel<BandMathFloor>(a, n);  break;
+        case BandExpression::Ceil:   bandMathKernel<BandMathCeil>(a, n);   break;
+        case BandExpression::Sin:    bandMathKernel<BandMathSin>(a, n);    break;
+        case BandExpression::Cos:    bandMathKernel<BandMathCos>(a, n);    break;
+        default: break;
+    }
+}
+
+/**
+ * Is an operation unary?
+ *
+ * \param op The operation.
+ * \return True, if the operation has exactly one operand.
+ */
+bool bandMathIsUnary(BandExpression::OpCode op)
+{
+    return op >= BandExpression::Negate && op <= BandExpression::Cos;
+}
+
+/**
+ * Is an operation binary?
+ *
+ * \param op The operation.
+ * \return True, if the operation has exactly two operands.
+ */
+bool bandMathIsBinary(BandExpression::OpCode op)
+{
+    return op >= BandExpression::Add && op <= BandExpression::Or;
+}
+
+
+
+
+/**
+ * A recursive descent parser, which translates an expression into the
+ * stack program of a BandExpression. Constant sub-expressions are folded and
+ * binary operations with a constant right operand use the scalar kernels.
+ */
+class BandExpressionParser
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param expression The expression.
+         * \param constants The named constants.
+         * \param program The program, which will be emitted.
+         */
+        BandExpressionParser(const QString& expression, const QMap<QString, float>& constants,
+                             std::vector<BandExpression::Instruction>& program)
+        :   m_expression(expression),
+            m_constants(constants),
+            m_program(program),
+            m_pos(0),
+            m_band_count(0)
+        {
+        }
+    
+        /**
+         * Parses the complete expression.
+         *
+         * \return The count of bands used inside the expression.
+         */
+        unsigned int parse()
+        {
+            parseTernary();
+            skipSpaces();
+            
+            if(m_pos != m_expression.size())
+            {
+                error("Unexpected '" + m_expression.mid(m_pos,1) + "'");
+            }
+            return m_band_count;
+        }
+    
+    private:
+        /**
+         * Throws an error at the current position.
+         *
+         * \param message The description of the error.
+         */
+        void error(const QString& message) const
+        {
+            throw std::runtime_error(QString("Band expression error at position %1: %2").arg(m_pos).arg(message).toStdString());
+        }
+    
+        /**
+         * Skips all whitespaces at the current position.
+         */
+        void skipSpaces()
+        {
+            while(m_pos < m_expression.size() && m_expression[m_pos].isSpace())
+                m_pos++;
+        }
+    
+        /**
+         * Consumes a token, if it is next.
+         *
+         * \param token The token.
+         * \return True, if the token has been consumed.
+         */
+        bool accept(const QString& token)
+        {
+            skipSpaces();
+            
+            if(m_expression.midRef(m_pos, token.size()) == token)
+            {
+                m_pos += token.size();
+                return true;
+            }
+            return false;
+        }
+    
+        /**
+         * Consumes a token, which needs to be next.
+         *
+         * \param token The token.
+         */
+        void expect(const QString& token)
+        {
+            if(!accept(token))
+            {
+                error("Expected '" + token + "'");
+            }
+        }
+    
+        /**
+         * Adds an instruction to the program.
+         *
+         * \param op The operation.
+         * \param value The constant value.
+         * \param band The band index.
+         */
+        void emitInstruction(BandExpression::OpCode op, float value=0, unsigned int band=0)
+        {
+            BandExpression::Instruction instr = {op, band, value, false};
+            m_program.push_back(instr);
+        }
+    
+        /**
+         * Is an instruction from the end of the program a constant?
+         *
+         * \param offset The offset from the end (1 = last instruction).
+         * \return True, if the instruction loads a constant.
+         */
+        bool isConstant(unsigned int offset) const
+        {
+            return     m_program.size() >= offset
+                    && m_program[m_program.size()-offset].op == BandExpression::LoadConstant;
+        }
+    
+        /**
+         * Adds a binary operation to the program.
+         * Since every operand is either a single load or ends with an operation, 
+         * two trailing constants are always the complete operands of this operation.
+         *
+         * \param op The operation.
+         */
+        void emitBinary(BandExpression::OpCode op)
+        {
+            if(isConstant(1))
+            {
+                float b = m_program.back().value;
+                m_program.pop_back();
+                
+                if(isConstant(1))
+                {
+                    bandMathBinary(op, &m_program.back().value, b, 1);
+                }
+                else
+                {
+                    emitInstruction(op, b);
+                    m_program.back().scalar = true;
+                }
+            }
+            else
+            {
+                emitInstruction(op);
+            }
+        }
+    
+        /**
+         * Adds a unary operation to the program.
+         *
+         * \param op The operation.
+         */
+        void emitUnary(BandExpression::OpCode op)
+        {
+            if(isConstant(1))
+            {
+                bandMathUnary(op, &m_program.back().value, 1);
+            }
+            else
+            {
+                emitInstruction(op);
+            }
+        }
+    
+        /**
+         * ternary := or ['?' ternary ':' ternary]
+         */
+        void parseTernary()
+        {
+            parseOr();
+            
+            if(accept("?"))
+            {
+                parseTernary();
+                expect(":");
+                parseTernary();
+                emitInstruction(BandExpression::Select);
+            }
+        }
+    
+        /**
+         * or := and {'||' and}
+         */
+        void parseOr()
+        {
+            parseAnd();
+            
+            while(accept("||"))
+            {
+                parseAnd();
+                emitBinary(BandExpression::Or);
+            }
+        }
+    
+        /**
+         * and := comparison {'&&' comparison}
+         */
+        void parseAnd()
+        {
+            parseComparison();
+            
+            while(accept("&&"))
+            {
+                parseComparison();
+                emitBinary(BandExpression::And);
+            }
+        }
+    
+        /**
+         * comparison := sum {('<='|'>='|'=='|'!='|'<'|'>') sum}
+         */
+        void parseComparison()
+        {
+            parseSum();
+            
+            while(true)
+            {
+                BandExpression::OpCode op;
+                
+                if(accept("<="))        op = BandExpression::LessEqual;
+                else if(accept(">="))   op = BandExpression::GreaterEqual;
+                else if(accept("=="))   op = BandExpression::Equal;
+                else if(accept("!="))   op = BandExpression::NotEqual;
+                else if(accept("<"))    op = BandExpression::Less;
+                else if(accept(">"))    op = BandExpression::Greater;
+                else                    return;
+                
+                parseSum();
+                emitBinary(op);
+            }
+        }
+    
+        /**
+         * sum := product {('+'|'-') product}
+         */
+        void parseSum()
+        {
+            parseProduct();
+            
+            while(true)
+            {
+                BandExpression::OpCode op;
+                
+                if(accept("+"))         op = BandExpression::Add;
+                else if(accept("-"))    op = BandExpression::Subtract;
+                else                    return;
+                
+                parseProduct();
+                emitBinary(op);
+            }
+        }
+    
+        /**
+         * product := unary {('*'|'/') unary}
+         */
+        void parseProduct()
+        {
+            parseUnary();
+            
+            while(true)
+            {
+                BandExpression::OpCode op;
+                
+                if(accept("*"))         op = BandExpression::Multiply;
+                else if(accept("/"))    op = BandExpression::Divide;
+                else                    return;
+                
+                parseUnary();
+                emitBinary(op);
+            }
+        }
+    
+        /**
+         * unary := ('-'|'+'|'!') unary | power
+         */
+        void parseUnary()
+        {
+            if(accept("-"))
+            {
+                parseUnary();
+                emitUnary(BandExpression::Negate);
+            }
+            else if(accept("+"))
+            {
+                parseUnary();
+            }
+            else if(accept("!"))
+            {
+                parseUnary();
+                emitUnary(BandExpression::Not);
+            }
+            else
+            {
+                parsePower();
+            }
+        }
+    
+        /**
+         * power := primary ['^' unary]
+         */
+        void parsePower()
+        {
+            parsePrimary();
+            
+            if(accept("^"))
+            {
+                parseUnary();
+                emitBinary(BandExpression::Power);
+            }
+        }
+    
+        /**
+         * primary := number | '(' ternary ')' | function '(' arguments ')' | identifier
+         */
+        void parsePrimary()
+        {
+            skipSpaces();
+            
+            if(m_pos == m_expression.size())
+            {
+                error("Unexpected end of expression");
+            }
+            
+            QChar c = m_expression[m_pos];
+            
+            if(c.isDigit() || c == '.')
+            {
+                parseNumber();
+            }
+            else if(accept("("))
+            {
+                parseTernary();
+                expect(")");
+            }
+            else if(c.isLetter() || c == '_')
+            {
+                parseIdentifier();
+            }
+            else
+            {
+                error("Unexpected '" + QString(c) + "'");
+            }
+        }
+    
+        /**
+         * Parses a number.
+         */
+        void parseNumber()
+        {
+            int start = m_pos;
+            
+            while(m_pos < m_expression.size() && (m_expression[m_pos].isDigit() || m_expression[m_pos] == '.'))
+                m_pos++;
+            
+            //Exponent
+            if(m_pos < m_expression.size() && (m_expression[m_pos] == 'e' || m_expression[m_pos] == 'E'))
+            {
+                int exp_pos = m_pos+1;
+                
+                if(exp_pos < m_expression.size() && (m_expression[exp_pos] == '+' || m_expression[exp_pos] == '-'))
+                    exp_pos++;
+                
+                if(exp_pos < m_expression.size() && m_expression[exp_pos].isDigit())
+                {
+                    m_pos = exp_pos;
+                    while(m_pos < m_expression.size() && m_expression[m_pos].isDigit())
+                        m_pos++;
+                }
+            }
+            
+            bool ok;
+            float value = m_expression.mid(start, m_pos-start).toFloat(&ok);
+            
+            if(!ok)
+            {
+                error("Invalid number '" + m_expression.mid(start, m_pos-start) + "'");
+            }
+            emitInstruction(BandExpression::LoadConstant, value);
+        }
+    
+        /**
+         * Parses an identifier: A function call, a band, a coordinate or a named constant.
+         */
+        void parseIdentifier()
+        {
+            int start = m_pos;
+            
+            while(m_pos < m_expression.size() && (m_expression[m_pos].isLetterOrNumber() || m_expression[m_pos] == '_'))
+                m_pos++;
+            
+            QString name = m_expression.mid(start, m_pos-start);
+            
+            //Functions
+            if(accept("("))
+            {
+                parseFunction(name);
+                return;
+            }
+            
+            //Bands
+            if(name.size() > 1 && name[0] == 'b')
+            {
+                bool ok;
+                unsigned int band = name.mid(1).toUInt(&ok);
+                
+                if(ok)
+                {
+                    emitInstruction(BandExpression::LoadBand, 0, band);
+                    m_band_count = std::max(m_band_count, band+1);
+                    return;
+                }
+            }
+            
+            if(name == "x")
+            {
+                emitInstruction(BandExpression::LoadX);
+            }
+            else if(name == "y")
+            {
+                emitInstruction(BandExpression::LoadY);
+            }
+            else if(name == "width")
+            {
+                emitInstruction(BandExpression::LoadWidth);
+            }
+            else if(name == "height")
+            {
+                emitInstruction(BandExpression::LoadHeight);
+            }
+            else if(m_constants.contains(name))
+            {
+                emitInstruction(BandExpression::LoadConstant, m_constants[name]);
+            }
+            else
+            {
+                m_pos = start;
+                error("Unknown identifier '" + name + "'");
+            }
+        }
+    
+        /**
+         * Parses the arguments of a function call (after the opening bracket).
+         *
+         * \param name The name of the function.
+         */
+        void parseFunction(const QString& name)
+        {
+            BandExpression::OpCode op = BandExpression::Abs;
+            
+            //Unary functions
+            if(name == "abs")         op = BandExpression::Abs;
+            else if(name == "sqrt")   op = BandExpression::Sqrt;
+            else if(name == "exp")    op = BandExpression::Exp;
+            else if(name == "log")    op = BandExpression::Log;
+            else if(name == "floor")  op = BandExpression::Floor;
+            else if(name == "ceil")   op = BandExpression::Ceil;
+            else if(name == "sin")    op = BandExpression::Sin;
+            else if(name == "cos")    op = BandExpression::Cos;
+            //Binary functions
+            else if(name == "min")    op = BandExpression::Minimum;
+            else if(name == "max")    op = BandExpression::Maximum;
+            else if(name == "pow")    op = BandExpression::Power;
+            else                      error("Unknown function '" + name + "'");
+            
+            parseTernary();
+            
+            if(bandMathIsUnary(op))
+            {
+                expect(")");
+                emitUnary(op);
+            }
+            else
+            {
+                expect(",");
+                parseTernary();
+                expect(")");
+                emitBinary(op);
+            }
+        }
+    
+        /** The expression **/
+        const QString& m_expression;
+        /** The named constants **/
+        const QMap<QString, float>& m_constants;
+        /** The emitted program **/
+        std::vector<BandExpression::Instruction>& m_program;
+        /** The current position inside the expression **/
+        int m_pos;
+        /** The count of used bands **/
+        unsigned int m_band_count;
+};
+
+
+
+
+/**
+ * The shared state of one evaluation of a BandExpression.
+ */
+struct BandExpressionEvaluation
+{
+    /** The program **/
+    const std::vector<BandExpression::Instruction>* program;
+    /** The stack depth of the program **/
+    unsigned int stack_size;
+    /** The source bands **/
+    const std::vector<vigra::MultiArrayView<2,float> >* bands;
+    /** The destination band **/
+    vigra::MultiArrayView<2,float>* dest;
+    /** The count of rows per chunk of work **/
+    unsigned int chunk_rows;
+    /** The count of chunks **/
+    int chunk_count;
+    /** The next chunk to be processed **/
+    QAtomicInt next_chunk;
+    /** The count of processed chunks **/
+    QAtomicInt done_chunks;
+};
+
+/**
+ * A task of the evaluation of a BandExpression. All tasks fetch chunks of rows
+ * until all chunks are processed. Each row is processed in tiles, which fit 
+ * into the first level cache, together with all intermediate results.
+ */
+class BandExpressionTask
+:   public QRunnable
+{
+    public:
+        /** The count of pixels per tile **/
+        enum { tile_size = 1024 };
+    
+        /**
+         * Constructor of a task.
+         *
+         * \param eval The shared state of the evaluation.
+         * \param alg If not NULL, the progress is reported to this algorithm.
+         *            Only the task in the calling thread is allowed to do so.
+         */
+        BandExpressionTask(BandExpressionEvaluation& eval, Algorithm* alg)
+        :   m_eval(eval),
+            m_alg(alg),
+            m_stack(eval.stack_size*tile_size)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Processes chunks until no chunks are left, called by the thread pool.
+         */
+        void run()
+        {
+            const unsigned int height = m_eval.dest->height();
+            
+            for(int chunk = m_eval.next_chunk.fetchAndAddRelaxed(1);
+                chunk < m_eval.chunk_count;
+                chunk = m_eval.next_chunk.fetchAndAddRelaxed(1))
+            {
+                const unsigned int y_end = std::min(height, (chunk+1)*m_eval.chunk_rows);
+                
+                for(unsigned int y=chunk*m_eval.chunk_rows; y<y_end; ++y)
+                {
+                    for(unsigned int x=0; x<m_eval.dest->width(); x+=tile_size)
+                    {
+                        processTile(x, y, std::min<unsigned int>(tile_size, m_eval.dest->width()-x));
+                    }
+                }
+                
+                int done = m_eval.done_chunks.fetchAndAddRelaxed(1) + 1;
+                
+                if(m_alg)
+                {
+                    m_alg->status_update(100.0*done/m_eval.chunk_count);
+                }
+            }
+        }
+    
+    private:
+        /**
+         * Runs the program for one tile of a row.
+         *
+         * \param x0 The first x-coordinate of the tile.
+         * \param y The y-coordinate of the tile.
+         * \param n The count of pixels of the tile.
+         */
+        void processTile(unsigned int x0, unsigned int y, unsigned int n)
+        {
+            float* stack = m_stack.data();
+            unsigned int sp = 0;
+            
+            for(const BandExpression::Instruction& instr : *m_eval.program)
+            {
+                float* top = stack + sp*tile_size;
+                
+                switch(instr.op)
+                {
+                    case BandExpression::LoadBand:
+                        {
+                            const vigra::MultiArrayView<2,float>& band = (*m_eval.bands)[instr.band];
+                            const float* src = &band(x0, y);
+                            const std::ptrdiff_t stride = band.stride(0);
+                            
+                            if(stride == 1)
+                            {
+                                std::copy(src, src+n, top);
+                            }
+                            else
+                            {
+                                for(unsigned int i=0; i<n; ++i)
+                                    top[i] = src[i*stride];
+                            }
+                        }
+                        sp++;
+                        break;
+                    case BandExpression::LoadConstant:
+                        std::fill(top, top+n, instr.value);
+                        sp++;
+                        break;
+                    case BandExpression::LoadX:
+                        for(unsigned int i=0; i<n; ++i)
+                            top[i] = float(x0+i);
+                        sp++;
+                        break;
+                    case BandExpression::LoadY:
+                        std::fill(top, top+n, float(y));
+                        sp++;
+                        break;
+                    case BandExpression::LoadWidth:
+                        std::fill(top, top+n, float(m_eval.dest->width()));
+                        sp++;
+                        break;
+                    case BandExpression::LoadHeight:
+                        std::fill(top, top+n, float(m_eval.dest->height()));
+                        sp++;
+                        break;
+                    case BandExpression::Select:
+                        {
+                            float* cond = top - 3*tile_size;
+                            const float* a = top - 2*tile_size;
+                            const float* b = top - tile_size;
+                            
+                            for(unsigned int i=0; i<n; ++i)
+                                cond[i] = (cond[i] != 0) ? a[i] : b[i];
+                        }
+                        sp -= 2;
+                        break;
+                    default:
+                        if(bandMathIsUnary(instr.op))
+                        {
+                            bandMathUnary(instr.op, top - tile_size, n);
+                        }
+                        else if(instr.scalar)
+                        {
+                            bandMathBinary(instr.op, top - tile_size, instr.value, n);
+                        }
+                        else
+                        {
+                            bandMathBinary(instr.op, top - 2*tile_size, (const float*)(top - tile_size), n);
+                            sp--;
+                        }
+                        break;
+                }
+            }
+            
+            //Write the result
+            float* dest = &(*m_eval.dest)(x0, y);
+            const std::ptrdiff_t stride = m_eval.dest->stride(0);
+            
+            if(stride == 1)
+            {
+                std::copy(stack, stack+n, dest);
+            }
+            else
+            {
+                for(unsigned int i=0; i<n; ++i)
+                    dest[i*stride] = stack[i];
+            }
+        }
+    
+        /** The shared state of the evaluation **/
+        BandExpressionEvaluation& m_eval;
+        /** The algorithm for the progress report **/
+        Algorithm* m_alg;
+        /** The tile buffers of the stack **/
+        std::vector<float> m_stack;
+};
+
+
+
+
+BandExpression::BandExpression()
+:   m_stack_size(0),
+    m_band_count(0)
+{
+}
+
+BandExpression::BandExpression(const QString& expression, const QMap<QString, float>& constants)
+:   m_stack_size(0),
+    m_band_count(0)
+{
+    compile(expression, constants);
+}
+
+void BandExpression::compile(const QString& expression, const QMap<QString, float>& constants)
+{
+    m_expression.clear();
+    m_program.clear();
+    m_stack_size = 0;
+    m_band_count = 0;
+    
+    std::vector<Instruction> program;
+    BandExpressionParser parser(expression, constants, program);
+    
+    unsigned int band_count = parser.parse();
+    
+    //Simulate the stack to find its maximal depth
+    unsigned int sp = 0, stack_size = 0;
+    
+    for(const Instruction& instr : program)
+    {
+        if(instr.op <= LoadHeight)
+        {
+            sp++;
+        }
+        else if(instr.op == Select)
+        {
+            sp -= 2;
+        }
+        else if(bandMathIsBinary(instr.op) && !instr.scalar)
+        {
+            sp--;
+        }
+        stack_size = std::max(stack_size, sp);
+    }
+    
+    m_expression = expression;
+    m_program = program;
+    m_stack_size = stack_size;
+    m_band_count = band_count;
+}
+
+QString BandExpression::expression() const
+{
+    return m_expression;
+}
+
+bool BandExpression::isValid() const
+{
+    return !m_program.empty();
+}
+
+unsigned int BandExpression::bandCount() const
+{
+    return m_band_count;
+}
+
+void BandExpression::evaluate(const std::vector<vigra::MultiArrayView<2,float> >& bands,
+                              vigra::MultiArrayView<2,float> dest,
+                              Algorithm* alg) const
+{
+    vigra_precondition(isValid(), "BandExpression::evaluate: No valid expression has been compiled.");
+    vigra_precondition(bands.size() >= m_band_count, "BandExpression::evaluate: Too few bands given for the expression.");
+    
+    for(const vigra::MultiArrayView<2,float>& band : bands)
+    {
+        vigra_precondition(band.shape() == dest.shape(), "BandExpression::evaluate: Band and dest sizes differ!");
+    }
+    
+    if(dest.size() == 0)
+    {
+        return;
+    }
+    
+    //Chunks of at least 64k pixels per fetch
+    const unsigned int min_chunk_pixels = 1<<16;
+    
+    BandExpressionEvaluation eval;
+    eval.program = &m_program;
+    eval.stack_size = m_stack_size;
+    eval.bands = &bands;
+    eval.dest = &dest;
+    eval.chunk_rows = std::max<unsigned int>(1, min_chunk_pixels/dest.width());
+    eval.chunk_count = (dest.height() + eval.chunk_rows - 1)/eval.chunk_rows;
+    
+    const unsigned int thread_count = std::max(1, std::min(QThread::idealThreadCount(), eval.chunk_count));
+    
+    std::vector<BandExpressionTask*> tasks;
+    for(unsigned int t=0; t<thread_count; ++t)
+    {
+        tasks.push_back(new BandExpressionTask(eval, t==0 ? alg : NULL));
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(thread_count);
+    
+    for(unsigned int t=1; t<tasks.size(); ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    for(BandExpressionTask* task : tasks)
+    {
+        delete task;
+    }
+}
+
+} //end of namespace graipe
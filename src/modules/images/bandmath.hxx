@@ -0,0 +1,182 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_IMAGES_BANDMATH_HXX
+#define GRAIPE_IMAGES_BANDMATH_HXX
+
+#include "core/algorithm.hxx"
+#include "images/config.hxx"
+
+#include <vigra/multi_array.hxx>
+
+#include <QMap>
+#include <QString>
+
+#include <vector>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_images
+ * @{
+ *
+ * @file
+ * @brief Header file for the band math expression engine
+ */
+
+/**
+ * A per-pixel arithmetic expression over image bands. The expression is compiled
+ * once into a small stack program. At evaluation, the program is run over tiles 
+ * of pixels: each instruction processes a whole tile by means of a simple loop, 
+ * which the compiler is able to vectorize. All intermediate results stay inside 
+ * the (cache-sized) tile buffers and the result is written directly into the 
+ * destination band, so that no temporary bands are needed. The tiles are 
+ * distributed to a thread pool.
+ *
+ * The expressions may contain:
+ * - Operands: b0, b1, ... (the bands given at evaluation), x, y (the pixel 
+ *   coordinates), width, height (the band size), numbers and named constants.
+ * - Arithmetic operators: + - * / ^ (power) and unary -.
+ * - Comparisons: < <= > >= == != (resulting in 1 or 0).
+ * - Logical operators: && || ! (any non-zero value is true) and cond ? a : b.
+ * - Functions: abs, sqrt, exp, log, floor, ceil, sin, cos, min, max, pow.
+ *
+ * For instance, the NDVI may be computed by:
+ *     "b0+b1 != 0 ? (b0-b1)/(b0+b1) : 0"
+ */
+class GRAIPE_IMAGES_EXPORT BandExpression
+{
+    public:
+        /**
+         * Default constructor. Creates an empty (invalid) expression.
+         */
+        BandExpression();
+    
+        /**
+         * Constructor, which compiles an expression. Throws a std::runtime_error,
+         * if the expression cannot be compiled.
+         *
+         * \param expression The expression.
+         * \param constants The named constants, which may be used inside the expression.
+         */
+        BandExpression(const QString& expression, const QMap<QString, float>& constants = QMap<QString, float>());
+    
+        /**
+         * Compiles an expression. Throws a std::runtime_error with a description of
+         * the problem, if the expression cannot be compiled.
+         *
+         * \param expression The expression.
+         * \param constants The named constants, which may be used inside the expression.
+         */
+        void compile(const QString& expression, const QMap<QString, float>& constants = QMap<QString, float>());
+    
+        /**
+         * Returns the compiled expression.
+         *
+         * \return The expression or an empty string, if nothing has been compiled.
+         */
+        QString expression() const;
+    
+        /**
+         * Has an expression been compiled successfully?
+         *
+         * \return True, if the expression may be evaluated.
+         */
+        bool isValid() const;
+    
+        /**
+         * The count of bands, which need to be given at evaluation. This is the
+         * largest band index (bN) used inside the expression plus one.
+         *
+         * \return The count of needed bands.
+         */
+        unsigned int bandCount() const;
+    
+        /**
+         * Evaluates the expression for every pixel. All bands need to be of the 
+         * same shape as the destination. The destination may also be one of the
+         * given bands.
+         * If an algorithm pointer is provided, the status is updated to show progress.
+         *
+         * \param bands The bands, which are refered by b0, b1, ... inside the expression.
+         * \param dest The destination band.
+         * \param alg Pointer to the algorithm, used for update status.
+         */
+        void evaluate(const std::vector<vigra::MultiArrayView<2,float> >& bands,
+                      vigra::MultiArrayView<2,float> dest,
+                      Algorithm* alg = NULL) const;
+    
+        /** The operations of the compiled program **/
+        enum OpCode
+        {
+            LoadBand, LoadConstant, LoadX, LoadY, LoadWidth, LoadHeight,
+            Add, Subtract, Multiply, Divide, Power, Minimum, Maximum,
+            Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual, And, Or,
+            Negate, Not, Abs, Sqrt, Exp, Log, Floor, Ceil, Sin, Cos,
+            Select
+        };
+    
+        /** One instruction of the compiled program **/
+        struct Instruction
+        {
+            /** The operation **/
+            OpCode op;
+            /** The band index for LoadBand **/
+            unsigned int band;
+            /** The value for LoadConstant, or the right operand of a binary operation, if scalar **/
+            float value;
+            /** Is the right operand of a binary operation the scalar value? **/
+            bool scalar;
+        };
+    
+    private:
+        /** The expression **/
+        QString m_expression;
+        /** The compiled program **/
+        std::vector<Instruction> m_program;
+        /** The maximal stack depth of the program **/
+        unsigned int m_stack_size;
+        /** The count of needed bands **/
+        unsigned int m_band_count;
+};
+
+/**
+ * @}
+ */
+    
+} //end of namespace graipe
+
+#endif //GRAIPE_IMAGES_BANDMATH_HXX
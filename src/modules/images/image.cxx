@@ -72,14 +72,17 @@ Image<T>::Image(const Image<T> & img)
 {
     appendParameters();
 
+    //Defer the allocation of the bands, since they will be shared
+    ModelTransaction transaction(this);
+    
     //Get tags from other image
 	img.copyMetadata(*this);
 	
-	//Get Bands from other image
-	for (unsigned int i=0; i< img.numBands(); ++i) 
+	//Share bands with other image
+	for (unsigned int i=0; i< img.m_imagebands.size(); ++i)
     {
-        //Copy bands from other image
-        m_imagebands[i] = img.band(i);
+        m_bandstorage.push_back(img.m_bandstorage[i]);
+        m_imagebands.emplace_back(new vigra::MultiArrayView<2,T>(*img.m_imagebands[i]));
     }
 }
 
@@ -142,7 +145,26 @@ typename Image<T>::Size_Type Image<T>::size() const
 template<class T>
 const vigra::MultiArrayView<2,T> & Image<T>::band(unsigned int band_id) const
 {
-    return m_imagebands[band_id];
+    return *m_imagebands[band_id];
+}
+
+template<class T>
+vigra::MultiArrayView<2,T> Image<T>::writableBand(unsigned int band_id)
+{
+    if(locked())
+        return vigra::MultiArrayView<2,T>();
+    
+    //Copy on write
+    if(isBandShared(band_id))
+    {
+        std::shared_ptr<vigra::MultiArray<2,T> > storage(new vigra::MultiArray<2,T>(band(band_id)));
+        bindBand(band_id, storage, *storage);
+    }
+    
+    //The caller will change the band, thus invalidate the statistics manually
+    statistics().clear();
+    
+    return band(band_id);
 }
 
 template<class T>
@@ -151,7 +173,86 @@ void Image<T>::setBand(unsigned int band_id, const vigra::MultiArrayView<2,T>& b
     if(locked())
         return;
     
-    m_imagebands[band_id] = band;
+    const std::unique_ptr<vigra::MultiArrayView<2,T> >& current_band = m_imagebands[band_id];
+    
+    if(!current_band || isBandShared(band_id) || band.shape() != current_band->shape())
+    {
+        std::shared_ptr<vigra::MultiArray<2,T> > storage(new vigra::MultiArray<2,T>(band));
+        bindBand(band_id, storage, *storage);
+    }
+    //Reuse the own storage, if the band has not been changed in place
+    //(overlaps are handled by vigra)
+    else if(band.data() != current_band->data() || band.stride() != current_band->stride())
+    {
+        *current_band = band;
+    }
+    
+    //No updateModel() call here, thus invalidate the statistics manually
+    statistics().clear();
+}
+
+template<class T>
+void Image<T>::takeBand(unsigned int band_id, vigra::MultiArray<2,T>& band)
+{
+    if(locked())
+        return;
+    
+    std::shared_ptr<vigra::MultiArray<2,T> > storage(new vigra::MultiArray<2,T>);
+    storage->swap(band);
+    bindBand(band_id, storage, *storage);
+    
+    //No updateModel() call here, thus invalidate the statistics manually
+    statistics().clear();
+}
+
+template<class T>
+void Image<T>::shareBand(unsigned int band_id, const Image<T>& other, unsigned int other_band_id)
+{
+    if(locked())
+        return;
+    
+    vigra_precondition(other.band(other_band_id).shape() == size(), "Image<T>::shareBand: Band sizes do not match!");
+    
+    if(m_imagebands.size() < numBands())
+    {
+        m_bandstorage.resize(numBands());
+        m_imagebands.resize(numBands());
+    }
+    
+    bindBand(band_id, other.m_bandstorage[other_band_id], *other.m_imagebands[other_band_id]);
+    
+    //No updateModel() call here, thus invalidate the statistics manually
+    statistics().clear();
+}
+
+template<class T>
+void Image<T>::shareSubImage(const Image<T>& other, const Size_Type& ul)
+{
+    if(locked())
+        return;
+    
+    Size_Type lr = ul + size();
+    
+    vigra_precondition(other.numBands() == numBands(), "Image<T>::shareSubImage: Band counts do not match!");
+    vigra_precondition(lr[0] <= other.size()[0] && lr[1] <= other.size()[1], "Image<T>::shareSubImage: Region exceeds the other image!");
+    
+    m_bandstorage.resize(numBands());
+    m_imagebands.resize(numBands());
+    
+    //Strided views into the other image's storage
+    for(unsigned int c=0; c<numBands(); ++c)
+    {
+        bindBand(c, other.m_bandstorage[c], other.m_imagebands[c]->subarray(ul, lr));
+    }
+    
+    //No updateModel() call here, thus invalidate the statistics manually
+    statistics().clear();
+}
+
+template<class T>
+bool Image<T>::isBandShared(unsigned int band_id) const
+{
+    return m_bandstorage[band_id].use_count() > 1;
 }
 
 template <class T>
@@ -258,14 +359,19 @@ void Image<T>::copyData(Model& other) const
     
     copyMetadata(other);
     
-	if(this != &other && other.typeName() == typeName())
+	if(this != &other && other.typeName() == typeName() && !other.locked())
 	{
         Image<T>& image_model = static_cast<Image<T>&>(other);
         
-        for (unsigned int i=0; i< numBands(); ++i)
+        //Share the bands instead of copying them
+        image_model.m_bandstorage.resize(m_imagebands.size());
+        image_model.m_imagebands.resize(m_imagebands.size());
+        
+        for (unsigned int i=0; i< m_imagebands.size(); ++i)
         {
-            image_model.setBand(i, band(i));
+            image_model.bindBand(i, m_bandstorage[i], *m_imagebands[i]);
         }
+        image_model.statistics().clear();
     }    
 }
 
@@ -285,7 +391,17 @@ void Image<T>::serialize_content(QXmlStreamWriter& xmlWriter) const
 
         for(unsigned int c=0; c<m_imagebands.size(); ++c)
         {
-            QByteArray block((const char*)m_imagebands[c].data(),channel_size);
+            //Sub-images are strided views and need to be made contiguous first
+            vigra::MultiArray<2,T> contiguous_band;
+            const T* data = band(c).data();
+            
+            if(!band(c).isUnstrided())
+            {
+                contiguous_band = band(c);
+                data = contiguous_band.data();
+            }
+            
+            QByteArray block = QByteArray::fromRawData((const char*)data, channel_size);
             
             xmlWriter.writeStartElement("Channel");
             xmlWriter.writeAttribute("ID", QString::number(c));
@@ -311,13 +427,15 @@ bool Image<T>::deserialize_content(QXmlStreamReader& xmlReader)
     
     qint64 channel_size = this->width()*this->height()*sizeof(T);
     
+    m_bandstorage.clear();
+    m_bandstorage.resize(numBands());
     m_imagebands.clear();
     m_imagebands.resize(numBands());
         
     //Prepare all bands:
     for(unsigned int c=0; c<m_imagebands.size(); ++c)
     {
-        m_imagebands[c] = vigra::MultiArray<2,T>(width(),height());
+        allocateBand(c);
     }
     
     try
@@ -379,7 +497,7 @@ bool Image<T>::deserialize_content(QXmlStreamReader& xmlReader)
                 
                 if(block.size() == channel_size)
                 {
-                    memcpy((char*)m_imagebands[id].data(), block.data(), channel_size);
+                    memcpy((char*)m_bandstorage[id]->data(), block.data(), channel_size);
                 }
                 else
                 {
@@ -399,6 +517,9 @@ bool Image<T>::deserialize_content(QXmlStreamReader& xmlReader)
 template <class T>
 void Image<T>::updateModel()
 {
+    if(deferUpdate())
+        return;
+    
     //qDebug() << QString("Inside Image<T>::updateModel() - numBands=%1, size=(%2x%3) -locked=%4").arg(numBands()).arg(width()).arg(height()).arg(locked());
     
     //remove existing image bands
@@ -408,33 +529,26 @@ void Image<T>::updateModel()
         
         while (m_imagebands.size() != numBands())
         {
+            m_bandstorage.pop_back();
             m_imagebands.pop_back();
         }
     }
     else if(width()!=0 && height()!=0)
     {
-        //Add a new image band
-        if (numBands() > m_imagebands.size())
-        {
+        //Add new image bands
+        m_bandstorage.resize(numBands());
+        m_imagebands.resize(numBands());
         
-            vigra::MultiArray<2,T> band(width(), height());
-            band.init(vigra::NumericTraits<T>::zero());
-            
-            while (m_imagebands.size() != numBands())
-            {
-                //qDebug() << QString("Add a new image band of size: (%1x%2)").arg(width()).arg(height());
-                m_imagebands.push_back(band);
-            }
-        }
-        //Dimensions have changed
-        else if(   m_imagebands.size()!=0
-                && ((unsigned int)m_imagebands[0].width()!= width() || (unsigned int)m_imagebands[0].height()!= height()))
+        //Allocate new and (re-)allocate bands, whose dimensions have changed.
+        //Shared storage of other images is never changed here.
+        for(unsigned int c=0; c<m_imagebands.size(); ++c)
         {
-            //qDebug() << QString("Dimensions have changed from (%1x%2) to (%3x%4)").arg(m_imagebands[0].width()).arg(m_imagebands[0].height()).arg(width()).arg(height());
-            for(vigra::MultiArray<2,T> & band: m_imagebands)
+            if(    !m_imagebands[c]
+                || (unsigned int)m_imagebands[c]->width()!= width()
+                || (unsigned int)m_imagebands[c]->height()!= height())
             {
-                band.reshape(vigra::Shape2(width(),height()));
-                band.init(vigra::NumericTraits<T>::zero());
+                //qDebug() << QString("Add a new image band of size: (%1x%2)").arg(width()).arg(height());
+                allocateBand(c);
             }
         }
         
@@ -442,6 +556,24 @@ void Image<T>::updateModel()
     }
 }
 
+template <class T>
+void Image<T>::allocateBand(unsigned int band_id)
+{
+    std::shared_ptr<vigra::MultiArray<2,T> > storage(new vigra::MultiArray<2,T>(vigra::Shape2(width(), height())));
+    storage->init(vigra::NumericTraits<T>::zero());
+    
+    bindBand(band_id, storage, *storage);
+}
+
+template <class T>
+void Image<T>::bindBand(unsigned int band_id,
+                        const std::shared_ptr<vigra::MultiArray<2,T> >& storage,
+                        const vigra::MultiArrayView<2,T>& view)
+{
+    m_bandstorage[band_id] = storage;
+    m_imagebands[band_id].reset(new vigra::MultiArrayView<2,T>(view));
+}
+
 template <class T>
 void Image<T>::appendParameters()
 {
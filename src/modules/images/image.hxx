@@ -43,6 +43,8 @@
 
 #include <QDateTime>
 
+#include <memory>
+
 namespace graipe {
 
 /**
@@ -60,6 +62,13 @@ namespace graipe {
  *
  * This class extends the RasteredModel class, the template argument is
  * defining the pixel type.
+ *
+ * The storage of the image bands is shared in a copy-on-write manner:
+ * Copies of an image, band selections and sub-images (crops) only reference
+ * the pixel buffers of their source image. Bands of an image, which has
+ * been created with a given size, are always owned by the image itself.
+ * If you need to write into a band, which may be shared, use writableBand()
+ * instead of band().
  */
 template<class T>
 class GRAIPE_IMAGES_EXPORT Image
@@ -88,6 +97,7 @@ class GRAIPE_IMAGES_EXPORT Image
 		
 		/**
          * Copy constructor. Constructs a new Image from another Image.
+         * The bands are not copied, but shared with the other image.
          *
          * \param img The other image.
          */
@@ -139,20 +149,74 @@ class GRAIPE_IMAGES_EXPORT Image
          * Constant/reading access to a band of the image at a given band_id.
          * If no band_id is given, the first band (band_id=0) will be returned.
          * This function may throw an error, if the band_id is out of bounds.
+         * Note that the band may be a strided view, if the image is a 
+         * sub-image of another image.
          *
          * \param band_id The id of the band.
          * \return The band, as a const vigra::MultiArrayView.
          */
 		const vigra::MultiArrayView<2,T>& band( unsigned int band_id = 0) const;
     
+        /**
+         * Writing access to a band of the image at a given band_id.
+         * If the band's storage is shared with other images, it will be
+         * copied before (copy-on-write). Does nothing and returns an empty
+         * view if the model is locked.
+         *
+         * \param band_id The id of the band.
+         * \return The band, as a vigra::MultiArrayView, which is owned by this image.
+         */
+		vigra::MultiArrayView<2,T> writableBand(unsigned int band_id = 0);
+    
         /**
          * Setting access to a band of the image at a given band_id.
+         * The band will be copied into a new storage of this image.
          * This function may throw an error, if the band_id is out of bounds.
          *
          * \param band_id The id of the band.
          * \param band The band, as a const vigra::MultiArrayView.
          */
 		void setBand(unsigned int band_id, const vigra::MultiArrayView<2,T>& band);
+    
+        /**
+         * Setting access to a band of the image at a given band_id.
+         * The band's storage will be taken over by this image without copying it.
+         * Afterwards, the given band is empty.
+         * This function may throw an error, if the band_id is out of bounds.
+         *
+         * \param band_id The id of the band.
+         * \param band The band, as a vigra::MultiArray.
+         */
+		void takeBand(unsigned int band_id, vigra::MultiArray<2,T>& band);
+    
+        /**
+         * Lets a band of this image reference the storage of a band of another
+         * image without copying it. Both bands need to have the same size.
+         *
+         * \param band_id The id of the band of this image.
+         * \param other The other image.
+         * \param other_band_id The id of the band of the other image.
+         */
+		void shareBand(unsigned int band_id, const Image<T>& other, unsigned int other_band_id);
+    
+        /**
+         * Lets all bands of this image reference a rectangular region of the
+         * bands of another image without copying them. The region starts at the
+         * given upper left position and has the size of this image. Both images
+         * need to have the same number of bands.
+         *
+         * \param other The other image.
+         * \param ul The upper left position of the region inside the other image.
+         */
+		void shareSubImage(const Image<T>& other, const Size_Type& ul);
+    
+        /**
+         * Returns true, if the storage of a band is shared with other images.
+         *
+         * \param band_id The id of the band.
+         * \return True, if the band's storage is referenced by other images, too.
+         */
+		bool isBandShared(unsigned int band_id) const;
             
         /**
          * Getter for the number of bands of an Image.
@@ -233,6 +297,7 @@ class GRAIPE_IMAGES_EXPORT Image
     
         /**
          * Const copy model's complete data (and metadata) to another model.
+         * The bands are not copied, but shared with the other model.
          *
          * \param other The other model.
          */
@@ -268,8 +333,33 @@ class GRAIPE_IMAGES_EXPORT Image
          */
         void appendParameters();
     
-        /** Storage of the image bands **/
-		std::vector<vigra::MultiArray<2,T> > m_imagebands;
+        /**
+         * Replaces the storage of a band by a new, zero-initialized one
+         * of the current size.
+         *
+         * \param band_id The id of the band.
+         */
+        void allocateBand(unsigned int band_id);
+    
+        /**
+         * Lets a band of this image reference a view into a (shared) storage.
+         *
+         * \param band_id The id of the band.
+         * \param storage The storage, which will be referenced.
+         * \param view The view into the storage.
+         */
+        void bindBand(unsigned int band_id,
+                      const std::shared_ptr<vigra::MultiArray<2,T> >& storage,
+                      const vigra::MultiArrayView<2,T>& view);
+    
+        /** Storage of the image bands, which may be shared with other images **/
+		std::vector<std::shared_ptr<vigra::MultiArray<2,T> > > m_bandstorage;
+    
+        /**
+         * Views of the image bands into their storage. These are held by pointers,
+         * since the assignment of a vigra::MultiArrayView copies the pixels.
+         */
+		std::vector<std::unique_ptr<vigra::MultiArrayView<2,T> > > m_imagebands;
     
         /**
          * @{
@@ -445,7 +445,7 @@ bool ImageImpex::importImage(const QString & filename, Image<T>& image)
 				for(unsigned int c=0; c< image.numBands(); c++)
 				{
 					GDALRasterBand* poBand = poDataset->GetRasterBand( c+1 );
-					rescale = fillImageBandFromBandData(poBand, image.band(c));
+					rescale = fillImageBandFromBandData(poBand, image.writableBand(c));
 				}
 				
 				
@@ -546,8 +546,12 @@ bool ImageImpex::exportImage(const Image<T>& image, const QString& filename, con
 				poBand = poDstDS->GetRasterBand(c);
 				if (poBand)
                 {	
+                    //Bands of sub-images may be strided views: let GDAL use the strides
+                    const vigra::MultiArrayView<2,T>& band = image.band(c-1);
+                    
 					CPLErr error = poBand->RasterIO(GF_Write, 0, 0,image.width(), image.height(),
-									 (void*)image.band(c-1).data(), image.width(), image.height(), GDALTraits<T>::gdalTypeID(), 0, 0 );
+									 (void*)band.data(), image.width(), image.height(), GDALTraits<T>::gdalTypeID(),
+                                     band.stride(0)*sizeof(T), band.stride(1)*sizeof(T) );
                     
                     vigra_precondition(error == CE_None, "ImageImpex::fillImageBandFromBandData: Image could not be imported into memory!");
 				}
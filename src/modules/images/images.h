@@ -46,11 +46,13 @@
  * @brief Header file for the outer API of GRAIPE's images module
  */
 
+#include "images/bandmath.hxx"
 #include "images/image.hxx"
 #include "images/imagebandparameter.hxx"
 #include "images/imageimpex.hxx"
 #include "images/imagestatistics.hxx"
 #include "images/imageviewcontroller.hxx"
+#include "images/pooledarray.hxx"
 
 /**
  * @}
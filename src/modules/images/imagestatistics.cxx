@@ -34,7 +34,6 @@
 /************************************************************************/
 
 #include "images/imagestatistics.hxx"
-#include <vigra/accumulator.hxx>
 
 namespace graipe {
 
@@ -45,7 +44,56 @@ namespace graipe {
  *     @brief Implementation file for the statstics of images
  * @}
  */
- 
+
+/**
+ * Accessor of the pixel values of an image band
+ * for the parallel computation of the channel statistics.
+ * Bands of sub-images may be strided views, which are
+ * accessed by means of their strides.
+ */
+template<class T>
+class ImageBandAccessor
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param band The image band.
+         */
+        ImageBandAccessor(const vigra::MultiArrayView<2,T>& band)
+        : m_data(band.data()),
+          m_width(band.width()),
+          m_stride(band.stride()),
+          m_unstrided(band.isUnstrided())
+        {
+        }
+    
+        /**
+         * Access to a pixel value.
+         *
+         * \param index The (scan-order) index of the pixel.
+         * \return The pixel value.
+         */
+        double operator()(std::size_t index) const
+        {
+            if(m_unstrided)
+            {
+                return m_data[index];
+            }
+            return m_data[(index % m_width)*m_stride[0] + (index / m_width)*m_stride[1]];
+        }
+    
+    private:
+        /** The first pixel of the band **/
+        const T* m_data;
+        /** The width of the band **/
+        std::size_t m_width;
+        /** The strides of the band **/
+        vigra::Shape2 m_stride;
+        /** Is the band contiguous? **/
+        bool m_unstrided;
+};
+
 template< class T>
 ImageStatistics<T>::ImageStatistics()
 {
@@ -55,20 +103,16 @@ template< class T>
 ImageStatistics<T>::ImageStatistics(const Image<T>* img)
  : m_image(img)
 {
-    using namespace vigra::acc;
-    
-    AccumulatorChain<T,Select<Variance, Mean, StdDev, Minimum, Maximum> > a;
-    
-    BasicStatistics<double> stats;
     for( unsigned int c=0; c<img->numBands(); ++c)
     {
-        extractFeatures(img->band(c).begin(), img->band(c).end(), a);
-        stats.min = get<Minimum>(a);
-        stats.max = get<Maximum>(a);
-        stats.mean = get<Mean>(a);
-        stats.stddev = get<StdDev>(a);
+        const vigra::MultiArrayView<2,T>& band = img->band(c);
+        
+        ChannelStatistics channel = img->statistics().channel(QString("band_%1").arg(c),
+                                                              ImageBandAccessor<T>(band),
+                                                              band.size());
 
-        m_intensityStats.push_back(stats);
+        m_intensityStats.push_back(channel.stats);
+        m_intensityHistograms.push_back(channel.histogram);
     }
 }
 
@@ -78,6 +122,12 @@ std::vector<BasicStatistics<double> > ImageStatistics<T>::intensityStats() const
 	return m_intensityStats;
 }
 
+template< class T>
+std::vector<BasicHistogram> ImageStatistics<T>::intensityHistograms() const
+{
+	return m_intensityHistograms;
+}
+
 //Promoted class instantiations for all promoted image classes
 template class ImageStatistics<float>;
 template class ImageStatistics<int>;
@@ -54,6 +54,8 @@ namespace graipe {
 /**
  * This class defines a basic statistics class for Images.
  * It represents the intensity statistics of all bands inside the image.
+ * The statistics are computed only once and then cached at the image
+ * (see Model::statistics()) until the image changes.
  */
 template <class T>
 class GRAIPE_IMAGES_EXPORT ImageStatistics
@@ -78,12 +80,23 @@ class GRAIPE_IMAGES_EXPORT ImageStatistics
          */
         std::vector<BasicStatistics<double> > intensityStats() const;
     
+        /**
+         * Returns the intensity histograms of all bands inside the image.
+         * These may be used to derive percentiles, e.g. for auto-contrast.
+         *
+         * \return Intensity histograms of all bands inside the image.
+         */
+        std::vector<BasicHistogram> intensityHistograms() const;
+    
     protected:
         /** The image **/
         const Image<T>* m_image;
     
         /** The intensity statistics (band-wise) **/
         std::vector<BasicStatistics<double> > m_intensityStats;
+    
+        /** The intensity histograms (band-wise) **/
+        std::vector<BasicHistogram> m_intensityHistograms;
 };
 
 /**
@@ -50,7 +50,6 @@ namespace graipe {
 template <class T>
 ImageSingleBandViewController<T>::ImageSingleBandViewController(Image<T>* img)
 : ViewController(img),
-    m_stats(new ImageStatistics<T>(img)),
     m_minValue(new FloatParameter("Min. value:",-1e20f, 1e20f, 0)),
     m_transparentBelowMin(new BoolParameter("Transp. (< min):", false)),
     m_maxValue(new FloatParameter("Max. value:",-1e20f, 1e20f, 255)),
@@ -75,10 +74,13 @@ ImageSingleBandViewController<T>::ImageSingleBandViewController(Image<T>* img)
     m_parameters->addParameter("legendTicks", m_legendTicks);
     m_parameters->addParameter("legendDigits", m_legendDigits);
     
+    //Statistics are cached at the image, thus only computed once
+    ImageStatistics<T> stats(img);
+    
     //Create and show legend
     m_intensity_legend = new QLegend(0, m_img->height()+5,
                                      150, 50,
-                                     m_stats->intensityStats()[0].min, m_stats->intensityStats()[0].max,
+                                     stats.intensityStats()[0].min, stats.intensityStats()[0].max,
                                      m_legendTicks->value(),
                                      false,
                                      this);
@@ -135,13 +137,16 @@ void ImageSingleBandViewController<T>::updateView()
         m_ct[255] = Qt::transparent;
     }
     
-    const vigra::MultiArray<2,T>& band = m_img->band(m_bandId->value());
+    const vigra::MultiArrayView<2,T>& band = m_img->band(m_bandId->value());
 
     int w = m_img->width();
     int h = m_img->height();
     
-    float new_min = m_stats->intensityStats()[m_bandId->value()].min;
-    float new_max = m_stats->intensityStats()[m_bandId->value()].max;
+    //Cheap, if the image has not changed since the last update (cached statistics)
+    ImageStatistics<T> stats(m_img);
+    
+    float new_min = stats.intensityStats()[m_bandId->value()].min;
+    float new_max = stats.intensityStats()[m_bandId->value()].max;
     
     m_minValue->setRange(floor(new_min), ceil(new_max));
     m_maxValue->setRange(floor(new_min), ceil(new_max));
@@ -271,9 +276,9 @@ void ImageRGBViewController<T>::updateView()
     if(!m_img->isViewable())
         return;
 
-    const vigra::MultiArray<2,T>& r = m_img->band(m_redBandId->value());
-    const vigra::MultiArray<2,T>& g = m_img->band(m_greenBandId->value());
-    const vigra::MultiArray<2,T>& b = m_img->band(m_blueBandId->value());
+    const vigra::MultiArrayView<2,T>& r = m_img->band(m_redBandId->value());
+    const vigra::MultiArrayView<2,T>& g = m_img->band(m_greenBandId->value());
+    const vigra::MultiArrayView<2,T>& b = m_img->band(m_blueBandId->value());
     
     int w = m_img->width();
     int h = m_img->height();
@@ -111,9 +111,6 @@ class GRAIPE_IMAGES_EXPORT ImageSingleBandViewController
         void hoverMoveEvent (QGraphicsSceneHoverEvent * event);
         
     private:
-        /** Statistics **/
-        ImageStatistics<T>* m_stats;
-    
         /**
          * @{
          *
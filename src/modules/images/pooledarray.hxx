@@ -0,0 +1,179 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_IMAGES_POOLEDARRAY_HXX
+#define GRAIPE_IMAGES_POOLEDARRAY_HXX
+
+#include "core/bufferpool.hxx"
+
+#include "vigra/multi_array.hxx"
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_images
+ * @{
+ *
+ * @file
+ * @brief Header file for temporary arrays, which are allocated from a BufferPool
+ */
+
+/**
+ * A buffer, which has been checked out from a BufferPool and is given back
+ * on destruction. This is the storage base class of the PooledArray.
+ */
+class PooledBuffer
+{
+    protected:
+        /**
+         * Constructor. Checks out a buffer from a pool.
+         *
+         * \param pool The pool.
+         * \param bytes The size of the buffer in bytes.
+         */
+        PooledBuffer(BufferPool& pool, std::size_t bytes)
+        : m_pool(pool),
+          m_block_size(0),
+          m_buffer(pool.acquire(bytes, m_block_size))
+        {
+        }
+    
+        /**
+         * Destructor. Gives the buffer back to the pool.
+         */
+        ~PooledBuffer()
+        {
+            m_pool.release(m_buffer, m_block_size);
+        }
+    
+        /** The pool of the buffer **/
+        BufferPool& m_pool;
+        /** The size class of the buffer **/
+        std::size_t m_block_size;
+        /** The buffer **/
+        void* m_buffer;
+    
+    private:
+        /** Buffers cannot be copied **/
+        PooledBuffer(const PooledBuffer&);
+        PooledBuffer& operator=(const PooledBuffer&);
+};
+
+/**
+ * A temporary, unstrided array, which is allocated from a BufferPool instead of the heap.
+ * It may be used wherever a vigra::MultiArrayView is expected and replaces short-living
+ * vigra::MultiArray temporaries of algorithms, which are (re-)created with the same
+ * shapes for each call, level or patch. Since the pixel type is not constructed, it
+ * needs to be a plain type like float or vigra::TinyVector<float,N>.
+ *
+ * Example:
+ * \code
+   PooledArray<2,float> gradX(src.shape()), gradY(src.shape());
+   vigra::gaussianGradient(src, gradX, gradY, sigma);
+   \endcode
+ */
+template <unsigned int N, class T>
+class PooledArray
+:   private PooledBuffer,
+    public vigra::MultiArrayView<N,T>
+{
+    public:
+        /** The type of the view on the array **/
+        typedef vigra::MultiArrayView<N,T> view_type;
+    
+        /**
+         * Constructor. Checks out an array of a given shape and initializes
+         * all elements to zero, like a vigra::MultiArray does.
+         *
+         * \param shape The shape of the array.
+         * \param pool The pool to allocate from. Defaults to the current pool of the thread.
+         */
+        explicit PooledArray(const typename view_type::difference_type& shape, BufferPool& pool = BufferPool::current())
+        :   PooledBuffer(pool, vigra::prod(shape)*sizeof(T)),
+            view_type(shape, static_cast<T*>(m_buffer))
+        {
+            this->init(T());
+        }
+    
+        /**
+         * Constructor. Checks out an array of a given shape and initializes
+         * all elements to a given value.
+         *
+         * \param shape The shape of the array.
+         * \param init The initial value of each element.
+         * \param pool The pool to allocate from. Defaults to the current pool of the thread.
+         */
+        PooledArray(const typename view_type::difference_type& shape, const T& init, BufferPool& pool = BufferPool::current())
+        :   PooledBuffer(pool, vigra::prod(shape)*sizeof(T)),
+            view_type(shape, static_cast<T*>(m_buffer))
+        {
+            this->init(init);
+        }
+    
+        /**
+         * Assignments of views, scalars and multi_math expressions like for
+         * vigra::MultiArrayView. Since the array cannot be reshaped, the shapes need to match.
+         */
+        using view_type::operator=;
+    
+        /**
+         * The view on the array.
+         *
+         * \return The array as a vigra::MultiArrayView.
+         */
+        view_type& view()
+        {
+            return *this;
+        }
+    
+        /**
+         * The constant view on the array.
+         *
+         * \return The array as a const vigra::MultiArrayView.
+         */
+        const view_type& view() const
+        {
+            return *this;
+        }
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_IMAGES_POOLEDARRAY_HXX
@@ -37,6 +37,8 @@
 #define GRAIPE_MULTISPECTRAL_MULTISPECTRALCLASSIFICATION_HXX
 
 #include "core/algorithm.hxx"
+#include "images/bandmath.hxx"
+
 #include <vigra/multi_array.hxx>
 
 namespace graipe {
@@ -59,37 +61,19 @@ namespace graipe {
  * \param[out] dest The resulting values of the NDVI for each pixel.
  * \param alg Pointer to the algorithm, used for update status.
  */
-template <class T1, class T2>
-void computeNDVI(const vigra::MultiArrayView<2,T1> & s_nir, const vigra::MultiArrayView<2,T1> & s_red, vigra::MultiArrayView<2,T2> dest,
-                 Algorithm* alg = NULL)
+inline void computeNDVI(const vigra::MultiArrayView<2,float> & s_nir, const vigra::MultiArrayView<2,float> & s_red, vigra::MultiArrayView<2,float> dest,
+                        Algorithm* alg = NULL)
 {
-
     vigra_precondition(s_nir.shape() == s_red.shape() ,"channel sizes differ!");
     vigra_precondition(s_red.shape() == dest.shape() ,"channel and dest sizes differ!");
     
-	unsigned int i=0;
-	
-    auto nir_iter = s_nir.begin();
-    auto red_iter = s_red.begin();
-    auto dest_iter = dest.begin();
+    BandExpression ndvi("b0+b1 != 0 ? (b0-b1)/(b0+b1) : 0");
     
-    for( ; nir_iter != s_nir.end(); ++nir_iter, ++red_iter, ++dest_iter, ++i)
-    {
-        T2 temp = *nir_iter + *red_iter;
-			
-        if(temp != 0)
-        {
-			*dest_iter = (*nir_iter - *red_iter)/ temp;
-        }
-		else
-        {
-			*dest_iter = 0;
-		}
-		if (i%dest.width()==0 && alg)
-		{
-			alg->status_update(100.0*i/dest.size());
-		}
-	}
+    std::vector<vigra::MultiArrayView<2,float> > bands;
+    bands.push_back(s_nir);
+    bands.push_back(s_red);
+    
+    ndvi.evaluate(bands, dest, alg);
 }
 
 /**
@@ -99,44 +83,31 @@ void computeNDVI(const vigra::MultiArrayView<2,T1> & s_nir, const vigra::MultiAr
  *
  * \param[in] s_nir The source band at the near infrared.
  * \param[in] s_red The source band at the red part of the spectrum.
+ * \param[out] dest The resulting values of the NDVI for each pixel.
  * \param[in] c The c parameter of the EVI algorithm.
  * \param[in] l The l parameter of the EVI algorithm.
  * \param[in] g The g parameter of the EVI algorithm.
- * \param[out] dest The resulting values of the NDVI for each pixel.
  * \param alg Pointer to the algorithm, used for update status.
  */
-template <class T1, class T2>
-void computeEVI2(const vigra::MultiArrayView<2,T1> & s_nir, const vigra::MultiArrayView<2,T1> & s_red, vigra::MultiArrayView<2,T2> dest,
-				 double c, double l, double g,
-				 Algorithm* alg = NULL)
+inline void computeEVI2(const vigra::MultiArrayView<2,float> & s_nir, const vigra::MultiArrayView<2,float> & s_red, vigra::MultiArrayView<2,float> dest,
+                        double c, double l, double g,
+                        Algorithm* alg = NULL)
 {
-
     vigra_precondition(s_nir.shape() == s_red.shape() ,"channel sizes differ!");
     vigra_precondition(s_red.shape() == dest.shape() ,"channel and dest sizes differ!");
     
-	unsigned int i=0;
-	
-    auto nir_iter = s_nir.begin();
-    auto red_iter = s_red.begin();
-    auto dest_iter = dest.begin();
+    QMap<QString, float> constants;
+    constants["c"] = c;
+    constants["l"] = l;
+    constants["g"] = g;
+    
+    BandExpression evi2("b0 + c*b1 + l != 0 ? g*(b0-b1)/(b0 + c*b1 + l) : 0", constants);
     
-    for( ; nir_iter != s_nir.end(); ++nir_iter, ++red_iter, ++dest_iter, ++i)
-    {
-        T2 temp = *nir_iter + c *(*red_iter) + l;
-			
-        if(temp != 0)
-        {
-            *dest_iter = g*(*nir_iter - *red_iter)/ temp;
-        }
-        else
-        {
-            *dest_iter = 0;
-		}
-		if (i%dest.width()==0 && alg)
-		{
-			alg->status_update(100.0*i/dest.size());
-		}
-	}
+    std::vector<vigra::MultiArrayView<2,float> > bands;
+    bands.push_back(s_nir);
+    bands.push_back(s_red);
+    
+    evi2.evaluate(bands, dest, alg);
 }
 
 /**
@@ -147,47 +118,35 @@ void computeEVI2(const vigra::MultiArrayView<2,T1> & s_nir, const vigra::MultiAr
  * \param[in] s_nir The source band at the near infrared.
  * \param[in] s_red The source band at the red part of the spectrum.
  * \param[in] s_blue The source band at the blue part of the spectrum.
+ * \param[out] dest The resulting values of the NDVI for each pixel.
  * \param[in] c1 The c1 parameter of the EVI algorithm.
  * \param[in] c2 The c2 parameter of the EVI algorithm.
  * \param[in] l The l parameter of the EVI algorithm.
  * \param[in] g The g parameter of the EVI algorithm.
- * \param[out] dest The resulting values of the NDVI for each pixel.
  * \param alg Pointer to the algorithm, used for update status.
  */
-template <class T1, class T2>
-void computeEVI(const vigra::MultiArrayView<2,T1> & s_nir, const vigra::MultiArrayView<2,T1> & s_red, const vigra::MultiArrayView<2,T1> & s_blue, vigra::MultiArrayView<2,T2> dest,
-				 double c1, double c2, double l, double g,
-				 Algorithm* alg = NULL)
+inline void computeEVI(const vigra::MultiArrayView<2,float> & s_nir, const vigra::MultiArrayView<2,float> & s_red, const vigra::MultiArrayView<2,float> & s_blue, vigra::MultiArrayView<2,float> dest,
+                       double c1, double c2, double l, double g,
+                       Algorithm* alg = NULL)
 {
-
     vigra_precondition(s_nir.shape() == s_red.shape() ,"channel sizes differ!");
     vigra_precondition(s_nir.shape() == s_blue.shape() ,"channel sizes differ!");
     vigra_precondition(s_red.shape() == dest.shape() ,"channel and dest sizes differ!");
     
-	unsigned int i=0;
-	
-    auto nir_iter = s_nir.begin();
-    auto red_iter = s_red.begin();
-    auto blue_iter = s_blue.begin();
-    auto dest_iter = dest.begin();
+    QMap<QString, float> constants;
+    constants["c1"] = c1;
+    constants["c2"] = c2;
+    constants["l"]  = l;
+    constants["g"]  = g;
+    
+    BandExpression evi("b0 + c1*b1 + c2*b2 + l != 0 ? g*(b0-b1)/(b0 + c1*b1 + c2*b2 + l) : 0", constants);
+    
+    std::vector<vigra::MultiArrayView<2,float> > bands;
+    bands.push_back(s_nir);
+    bands.push_back(s_red);
+    bands.push_back(s_blue);
     
-    for( ; nir_iter != s_nir.end(); ++nir_iter, ++red_iter, ++blue_iter, ++dest_iter, ++i)
-    {
-        T2 temp = *nir_iter + c1 *(*red_iter) + c2 *(*blue_iter) + l;
-			
-        if(temp != 0)
-        {
-            *dest_iter = g*(*nir_iter - *red_iter)/ temp;
-        }
-        else
-        {
-            *dest_iter = 0;
-		}
-		if (i%dest.width()==0 && alg)
-		{
-			alg->status_update(100.0*i/dest.size());
-		}
-	}
+    evi.evaluate(bands, dest, alg);
 }
 
 /**
@@ -40,6 +40,9 @@
 #include "features2d/features2d.h"
 #include "images/images.h"
 
+//Fused gradient computation
+#include "opticalflow/gaussianderivatives.hxx"
+
 //vigra components needed
 #include "vigra/edgedetection.hxx"
 
@@ -66,11 +69,17 @@ template <class T1, class T2>
 void imageToJacobian(const Image<T1>* img, std::vector<vigra::MultiArray<2,vigra::TinyVector<T2, 2> > > & jacobian, float scale)
 {
 	jacobian.clear();
-	jacobian.resize(img->numBands(), vigra::MultiArray<2,vigra::TinyVector<float, 2> >(img->size()));
+	jacobian.resize(img->numBands(), vigra::MultiArray<2,vigra::TinyVector<T2, 2> >(img->size()));
+    
+    //One engine for all bands: kernels and scratch memory are reused
+    GaussianDerivativeEngine<T2> derivatives(scale);
     
 	for (unsigned int c = 0; c < img->numBands(); ++c) 
 	{
-		vigra::gaussianGradient(img->band(c), jacobian[c], scale);
+		derivatives.derivatives(img->band(c),
+                                typename GaussianDerivativeEngine<T2>::ViewType(),
+                                jacobian[c].bindElementChannel(0),
+                                jacobian[c].bindElementChannel(1));
 	}
 }
 
@@ -327,6 +336,10 @@ EdgelFeatureList2D* msCannyFeatures(Image<float>* img, float scale, float thresh
     vigra::cannyEdgelListThreshold(gradient, v_edgels, threshold);
 	
     EdgelFeatureList2D* edgels = new EdgelFeatureList2D(img->workspace());
+    
+    //Coalesce all additions into one model update
+    ModelTransaction transaction(edgels);
+    edgels->reserve(v_edgels.size());
 	
 	for(unsigned int i=0; i< v_edgels.size(); ++i)
 	{
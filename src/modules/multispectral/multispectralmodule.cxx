@@ -426,7 +426,7 @@ class NDVIEstimator
                     
                     computeNDVI(image->band(nir_band_param->value()),
                                 image->band(red_band_param->value()),
-                                new_image->band(0),
+                                new_image->writableBand(0),
                                 this);
                     
                     image->copyMetadata(*new_image);
@@ -550,7 +550,7 @@ class EVIEstimator
                     computeEVI(image->band(nir_band_param->value()),
                                image->band(red_band_param->value()),
                                image->band(blue_band_param->value()),
-                               new_image->band(0),
+                               new_image->writableBand(0),
                                param_C1->value(), param_C2->value(), param_L->value(), param_G->value(),
                                this);
                     
@@ -672,7 +672,7 @@ class EVI2BandsEstimator
                     
                     computeEVI2(image->band(nir_band_param->value()),
                                 image->band(red_band_param->value()),
-                                new_image->band(0),
+                                new_image->writableBand(0),
                                 param_C->value(), param_L->value(), param_G->value(),
                                 this);
                     
@@ -39,6 +39,7 @@
 #include "vigra/linear_algebra.hxx"
 
 #include "opticalflow/opticalflowgradients.hxx"
+#include "images/pooledarray.hxx"
 
 namespace graipe {
 
@@ -75,7 +76,8 @@ class OpticalFlow2BandsFunctor
         :	m_iterations(iterations),
             m_sigma(sigma),
             m_threshold(threshold),
-            m_level(0.0)
+            m_level(0.0),
+            m_derivatives(sigma)
         {
         }
 
@@ -135,20 +137,15 @@ class OpticalFlow2BandsFunctor
             
             vigra::Shape2 shape = src11.shape();
             
-            vigra::MultiArray<2,ValueType>	gradX1c1(shape), gradX1c2(shape), gradY1c1(shape), gradY1c2(shape), gradT1c1(shape), gradT1c2(shape),
+            PooledArray<2,ValueType>	gradX1c1(shape), gradX1c2(shape), gradY1c1(shape), gradY1c2(shape), gradT1c1(shape), gradT1c2(shape),
                                             gradX2c1(shape), gradX2c2(shape), gradY2c1(shape), gradY2c2(shape), gradT2c1(shape), gradT2c2(shape);
             
-            vigra::gaussianGradient(src11,	gradX1c1, gradY1c1, m_sigma);
-            vigra::gaussianGradient(src12,	gradX1c2, gradY1c2, m_sigma);
-            
-            vigra::gaussianGradient(src21,	gradX2c1, gradY2c1, m_sigma);
-            vigra::gaussianGradient(src22,	gradX2c2, gradY2c2, m_sigma);
+            //Smoothing and gradient of each band by one fused pass
+            m_derivatives.derivatives(src11, gradT1c1, gradX1c1, gradY1c1);
+            m_derivatives.derivatives(src12, gradT1c2, gradX1c2, gradY1c2);
             
-            vigra::gaussianSmoothing(src11,	gradT1c1, m_sigma);
-            vigra::gaussianSmoothing(src12,	gradT1c2, m_sigma);
-            
-            vigra::gaussianSmoothing(src21,	gradT2c1, m_sigma);
-            vigra::gaussianSmoothing(src21,	gradT2c2, m_sigma);
+            m_derivatives.derivatives(src21, gradT2c1, gradX2c1, gradY2c1);
+            m_derivatives.derivatives(src22, gradT2c2, gradX2c2, gradY2c2);
             
             //Matrix A, vecor b and eigenvectors resp. eigenvalues
             vigra::Matrix<double> A(2,2), b(2,1), res(2,1), ev(2,2);
@@ -238,21 +235,21 @@ class OpticalFlow2BandsFunctor
             
             vigra::Shape2 shape = src11.shape();
             
-            vigra::MultiArray<2,ValueType>	gradX1c1(shape), gradX1c2(shape), gradY1c1(shape), gradY1c2(shape), gradT1c1(shape), gradT1c2(shape),
+            PooledArray<2,ValueType>	gradX1c1(shape), gradX1c2(shape), gradY1c1(shape), gradY1c2(shape), gradT1c1(shape), gradT1c2(shape),
                                             gradX2c1(shape), gradX2c2(shape), gradY2c1(shape), gradY2c2(shape), gradT2c1(shape), gradT2c2(shape);
             
             
-            gaussianGradientWithMask(src11,	mask,   gradX1c1, gradY1c1, m_sigma);
-            gaussianGradientWithMask(src12, mask,	gradX1c2, gradY1c2, m_sigma);
+            m_derivatives.gradientWithMask(src11, mask, gradX1c1, gradY1c1);
+            m_derivatives.gradientWithMask(src12, mask, gradX1c2, gradY1c2);
             
-            gaussianGradientWithMask(src21, mask,	gradX2c1, gradY2c1, m_sigma);
-            gaussianGradientWithMask(src22, mask,	gradX2c2, gradY2c2, m_sigma);
+            m_derivatives.gradientWithMask(src21, mask, gradX2c1, gradY2c1);
+            m_derivatives.gradientWithMask(src22, mask, gradX2c2, gradY2c2);
             
-            gaussianSmoothingWithMask(src11, mask,	gradT1c1, m_sigma);
-            gaussianSmoothingWithMask(src12, mask,	gradT1c2, m_sigma);
+            m_derivatives.smoothingWithMask(src11, mask, gradT1c1);
+            m_derivatives.smoothingWithMask(src12, mask, gradT1c2);
             
-            gaussianSmoothingWithMask(src21, mask,	gradT2c1, m_sigma);
-            gaussianSmoothingWithMask(src21, mask,	gradT2c2, m_sigma);
+            m_derivatives.smoothingWithMask(src21, mask, gradT2c1);
+            m_derivatives.smoothingWithMask(src22, mask, gradT2c2);
             
             //Matrix A, vecor b and eigenvectors resp. eigenvalues
             vigra::Matrix<double> A(2,2), b(2,1), res(2,1), ev(2,2);
@@ -321,6 +318,9 @@ class OpticalFlow2BandsFunctor
         double	m_sigma;
         double	m_threshold;
         int		m_level;
+        
+        //Reused derivative estimator (kernels and scratch memory)
+        GaussianDerivativeEngine<ValueType> m_derivatives;
 };
 
 /**
@@ -408,10 +408,10 @@ class OpticalFlowHS2BandsFunctor
             
             vigra::Shape2 shape = src11.shape();
             
-            vigra::MultiArray<2,ValueType>	gradXc1(shape), gradXc2(shape), gradYc1(shape), gradYc2(shape), gradTc1(shape), gradTc2(shape);
+            PooledArray<2,ValueType>	gradXc1(shape), gradXc2(shape), gradYc1(shape), gradYc2(shape), gradTc1(shape), gradTc2(shape);
         
             //to hold the new mean result vectors of the last result
-            vigra::MultiArray<2,FlowValueType> mean_flow(shape);
+            PooledArray<2,FlowValueType> mean_flow(shape);
             
             //spatiotemporal Gradients of first order: I_1x, I_1y and I_1t
             spatioTemporalGradient(src11,
@@ -505,10 +505,10 @@ class OpticalFlowHS2BandsFunctor
             
             vigra::Shape2 shape = src11.shape();
             
-            vigra::MultiArray<2,ValueType>	gradXc1(shape), gradXc2(shape), gradYc1(shape), gradYc2(shape), gradTc1(shape), gradTc2(shape);
+            PooledArray<2,ValueType>	gradXc1(shape), gradXc2(shape), gradYc1(shape), gradYc2(shape), gradTc1(shape), gradTc2(shape);
             
             //to hold the new mean result vectors of the last result
-            vigra::MultiArray<2,FlowValueType> mean_flow(shape);
+            PooledArray<2,FlowValueType> mean_flow(shape);
             
             //spatiotemporal Gradients of first order: I_1x, I_1y and I_1t
             spatioTemporalGradientWithMask(src11,
@@ -334,8 +334,8 @@ class OpticalFlowAlgorithm2Bands
                 if(m_param_pmode->value() !=0 && i!=0 && m_param_saveIntermediateImages->value()) 
                 {
                     Image<float>* new_image = new Image<float>(img11_list[i].shape(), 2, m_workspace);
-                    new_image->setBand(0, img11_list[i]);
-                    new_image->setBand(1, img12_list[i]);
+                    new_image->takeBand(0, img11_list[i]);
+                    new_image->takeBand(1, img12_list[i]);
                     
                     image1->copyMetadata(*new_image);
                     
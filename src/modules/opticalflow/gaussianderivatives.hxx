@@ -0,0 +1,768 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_OPTICALFLOW_GAUSSIANDERIVATIVES_HXX
+#define GRAIPE_OPTICALFLOW_GAUSSIANDERIVATIVES_HXX
+
+#include <vector>
+#include <algorithm>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_math.hxx>
+#include <vigra/separableconvolution.hxx>
+#include <vigra/stdconvolution.hxx>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_opticalflow
+ * @{
+ *
+ * @file
+ * @brief Header file for the fused Gaussian derivative engine.
+ */
+
+/**
+ * A fused estimator for Gaussian smoothed images and their partial derivatives.
+ *
+ * For unmasked images, all requested terms (smoothing, gradient and Hessian) are
+ * computed by a single separable pass over the image. The image is traversed in
+ * blocks of rows: Each row of a block (and its halo) is filtered horizontally once
+ * per distinct kernel, the vertical filtering then derives all requested terms from
+ * these cached rows. Both inner loops run over contiguous float lines and are thus
+ * easily auto-vectorized by the compiler.
+ *
+ * For masked images, normalized convolutions are used. The engine keeps the kernels
+ * for the current sigma and reuses intermediate results, e.g. the gradient for the
+ * Hessian matrix.
+ *
+ * All temporary memory is kept inside the engine and reused by subsequent calls.
+ * It is thus advisable to keep one engine alive (e.g. as a functor member) instead
+ * of creating a new one for each call. An engine must not be used by more than one
+ * thread at a time.
+ */
+template <class T = float>
+class GaussianDerivativeEngine
+{
+    public:
+        /** The value type of all results and temporaries **/
+        typedef T ValueType;
+        /** The view type of all results **/
+        typedef vigra::MultiArrayView<2, T> ViewType;
+    
+        /**
+         * Constructor of the engine.
+         *
+         * \param sigma The scale of the Gaussian function used to derive the partial derivatives.
+         * \param block_height The count of rows processed as one block by the fused pass.
+         */
+        GaussianDerivativeEngine(double sigma=1.0, int block_height=64)
+        :   m_sigma(-1.0),
+            m_outer_sigma(-1.0),
+            m_radius(0),
+            m_block_height(std::max(block_height, 1))
+        {
+            setSigma(sigma);
+        }
+    
+        /**
+         * The current scale of the Gaussian function.
+         *
+         * \return The scale of the Gaussian function.
+         */
+        double sigma() const
+        {
+            return m_sigma;
+        }
+    
+        /**
+         * Sets the scale of the Gaussian function and rebuilds the kernels, if
+         * the scale differs from the current one.
+         *
+         * \param sigma The new scale of the Gaussian function.
+         */
+        void setSigma(double sigma)
+        {
+            if(sigma == m_sigma)
+                return;
+            
+            m_sigma = sigma;
+            
+            //1D kernels for the fused separable pass
+            vigra::Kernel1D<double> kernel;
+            
+            kernel.initGaussian(sigma);
+            storeKernel(kernel, m_kernels[Smooth]);
+            
+            kernel.initGaussianDerivative(sigma, 1);
+            storeKernel(kernel, m_kernels[Derivative1]);
+            
+            kernel.initGaussianDerivative(sigma, 2);
+            storeKernel(kernel, m_kernels[Derivative2]);
+            
+            m_radius = 0;
+            for(int k=0; k<KernelCount; ++k)
+            {
+                m_radius = std::max(m_radius, std::max(-m_kernels[k].left, m_kernels[k].right));
+            }
+            
+            //2D kernels for the normalized convolutions
+            vigra::Kernel1D<float> grad_dummy;
+            grad_dummy.initExplicitly(0, 0) = 1;
+            
+            vigra::Kernel1D<float> grad;
+            grad.initGaussianDerivative(sigma,1);
+            
+            m_kernel_gx.initSeparable(grad, grad_dummy);
+            m_kernel_gy.initSeparable(grad_dummy, grad);
+            m_kernel_smooth.initGaussian(sigma);
+        }
+    
+        /**
+         * Computes the Gaussian smoothing, gradient and Hessian matrix of an image
+         * by one fused pass. Each result is optional: Passing an empty view
+         * (without data) skips the computation of the corresponding term.
+         *
+         * \param[in] src The image.
+         * \param[out] smoothed The Gaussian smoothed image.
+         * \param[out] gX The gradient in x-direction.
+         * \param[out] gY The gradient in y-direction.
+         * \param[out] gXX The xx-part of the Hessian matrix.
+         * \param[out] gXY The xy-part of the Hessian matrix.
+         * \param[out] gYY The yy-part of the Hessian matrix.
+         */
+        template <class T1>
+        void derivatives(const vigra::MultiArrayView<2, T1> & src,
+                         ViewType smoothed,
+                         ViewType gX,
+                         ViewType gY,
+                         ViewType gXX = ViewType(),
+                         ViewType gXY = ViewType(),
+                         ViewType gYY = ViewType())
+        {
+            std::vector<Output> outputs;
+            outputs.push_back(Output(0, Smooth,      Smooth,      smoothed));
+            outputs.push_back(Output(0, Derivative1, Smooth,      gX));
+            outputs.push_back(Output(0, Smooth,      Derivative1, gY));
+            outputs.push_back(Output(0, Derivative2, Smooth,      gXX));
+            outputs.push_back(Output(0, Derivative1, Derivative1, gXY));
+            outputs.push_back(Output(0, Smooth,      Derivative2, gYY));
+            
+            fusedPass(ImageLineLoader<T1>(src), src.shape(), outputs);
+        }
+    
+        /**
+         * Computes the gradient and the Hessian matrix of an image by one fused pass.
+         *
+         * \param[in] src The image.
+         * \param[out] gX The gradient in x-direction.
+         * \param[out] gY The gradient in y-direction.
+         * \param[out] gXX The xx-part of the Hessian matrix.
+         * \param[out] gXY The xy-part of the Hessian matrix.
+         * \param[out] gYY The yy-part of the Hessian matrix.
+         */
+        template <class T1>
+        void gradientAndHessian(const vigra::MultiArrayView<2, T1> & src,
+                                ViewType gX,  ViewType gY,
+                                ViewType gXX, ViewType gXY, ViewType gYY)
+        {
+            derivatives(src, ViewType(), gX, gY, gXX, gXY, gYY);
+        }
+    
+        /**
+         * Computes the spatio-temporal gradient of two images by one fused pass over both images.
+         * The spatial part is the gradient of the mean of both images, the temporal part is the
+         * smoothed difference I2-I1. Since the convolution is linear, this equals the differencing
+         * of both smoothed images.
+         *
+         * \param[in] src1 The first image of the series.
+         * \param[in] src2 The second image of the series.
+         * \param[out] gX The spatio-temporal gradient in x-direction.
+         * \param[out] gY The spatio-temporal gradient in y-direction.
+         * \param[out] gT The spatio-temporal gradient in temporal direction.
+         * \param[out] gXX Optional: The xx-part of the Hessian matrix of the mean image.
+         * \param[out] gXY Optional: The xy-part of the Hessian matrix of the mean image.
+         * \param[out] gYY Optional: The yy-part of the Hessian matrix of the mean image.
+         */
+        template <class T1, class T2>
+        void spatioTemporalGradient(const vigra::MultiArrayView<2, T1> & src1,
+                                    const vigra::MultiArrayView<2, T2> & src2,
+                                    ViewType gX, ViewType gY, ViewType gT,
+                                    ViewType gXX = ViewType(),
+                                    ViewType gXY = ViewType(),
+                                    ViewType gYY = ViewType())
+        {
+            vigra_precondition(src1.shape() == src2.shape(), "image sizes differ!");
+            
+            std::vector<Output> outputs;
+            outputs.push_back(Output(0, Derivative1, Smooth,      gX));
+            outputs.push_back(Output(0, Smooth,      Derivative1, gY));
+            outputs.push_back(Output(1, Smooth,      Smooth,      gT));
+            outputs.push_back(Output(0, Derivative2, Smooth,      gXX));
+            outputs.push_back(Output(0, Derivative1, Derivative1, gXY));
+            outputs.push_back(Output(0, Smooth,      Derivative2, gYY));
+            
+            fusedPass(SpatioTemporalLineLoader<T1,T2>(src1, src2), src1.shape(), outputs);
+        }
+    
+        /**
+         * Masked Gaussian smoothing of an image using normalized convolution.
+         *
+         * \param[in] src The image.
+         * \param[in] mask The mask of the image (only mask != 0) will be considered.
+         * \param[out] dest The smoothed result.
+         * \param[in] btmode The border treatment mode used for the normalized convolution.
+         */
+        template <class T1, class T2>
+        void smoothingWithMask(const vigra::MultiArrayView<2, T1> & src,
+                               const vigra::MultiArrayView<2, T2> & mask,
+                               ViewType dest,
+                               vigra::BorderTreatmentMode btmode = vigra::BORDER_TREATMENT_CLIP)
+        {
+            vigra_precondition(src.shape() == mask.shape(), "image and mask sizes differ!");
+            vigra_precondition(src.shape() == dest.shape(), "source and dest. image sizes differ!");
+            
+            m_kernel_smooth.setBorderTreatment(btmode);
+            vigra::normalizedConvolveImage(src, mask, dest, m_kernel_smooth);
+        }
+    
+        /**
+         * Masked Gaussian gradient of an image using normalized convolution.
+         *
+         * \param[in] src The image.
+         * \param[in] mask The mask of the image (only mask != 0) will be considered.
+         * \param[out] gX The gradient in x-direction.
+         * \param[out] gY The gradient in y-direction.
+         * \param[in] btmode The border treatment mode used for the normalized convolution.
+         */
+        template <class T1, class T2>
+        void gradientWithMask(const vigra::MultiArrayView<2, T1> & src,
+                              const vigra::MultiArrayView<2, T2> & mask,
+                              ViewType gX, ViewType gY,
+                              vigra::BorderTreatmentMode btmode = vigra::BORDER_TREATMENT_CLIP)
+        {
+            vigra_precondition(src.shape() == mask.shape(), "image and mask sizes differ!");
+            vigra_precondition(gX.shape() == gY.shape(), "gradient array sizes differ!");
+            vigra_precondition(src.shape() == gX.shape(), "gradient array sizes differ from image sizes!");
+            
+            m_kernel_gx.setBorderTreatment(btmode);
+            m_kernel_gy.setBorderTreatment(btmode);
+            
+            vigra::normalizedConvolveImage(src, mask, gX, m_kernel_gx);
+            vigra::normalizedConvolveImage(src, mask, gY, m_kernel_gy);
+        }
+    
+        /**
+         * Masked Gaussian gradient and Hessian matrix of an image using normalized convolution.
+         * The second order derivatives are derived from the first order ones, which are
+         * therefore only computed once. Parts of the Hessian matrix may be skipped by
+         * passing empty views (without data).
+         *
+         * \param[in] src The image.
+         * \param[in] mask The mask of the image (only mask != 0) will be considered.
+         * \param[out] gX The gradient in x-direction.
+         * \param[out] gY The gradient in y-direction.
+         * \param[out] gXX The xx-part of the Hessian matrix.
+         * \param[out] gXY The xy-part of the Hessian matrix.
+         * \param[out] gYY The yy-part of the Hessian matrix.
+         * \param[in] btmode The border treatment mode used for the normalized convolution.
+         */
+        template <class T1, class T2>
+        void gradientAndHessianWithMask(const vigra::MultiArrayView<2, T1> & src,
+                                        const vigra::MultiArrayView<2, T2> & mask,
+                                        ViewType gX,  ViewType gY,
+                                        ViewType gXX, ViewType gXY, ViewType gYY,
+                                        vigra::BorderTreatmentMode btmode = vigra::BORDER_TREATMENT_CLIP)
+        {
+            vigra_precondition(!gXX.hasData() || src.shape() == gXX.shape(), "gradient array sizes differ from image sizes!");
+            vigra_precondition(!gXY.hasData() || src.shape() == gXY.shape(), "gradient array sizes differ from image sizes!");
+            vigra_precondition(!gYY.hasData() || src.shape() == gYY.shape(), "gradient array sizes differ from image sizes!");
+            
+            gradientWithMask(src, mask, gX, gY, btmode);
+            
+            //gXX & gXY from gX, gYY from gY
+            if(gXX.hasData())
+                vigra::normalizedConvolveImage(gX, mask, gXX, m_kernel_gx);
+            if(gXY.hasData())
+                vigra::normalizedConvolveImage(gX, mask, gXY, m_kernel_gy);
+            if(gYY.hasData())
+                vigra::normalizedConvolveImage(gY, mask, gYY, m_kernel_gy);
+        }
+    
+        /**
+         * Masked Hessian matrix of an image using normalized convolution.
+         * The gradient is only kept in the engine's scratch memory.
+         *
+         * \param[in] src The image.
+         * \param[in] mask The mask of the image (only mask != 0) will be considered.
+         * \param[out] gXX The xx-part of the Hessian matrix.
+         * \param[out] gXY The xy-part of the Hessian matrix.
+         * \param[out] gYY The yy-part of the Hessian matrix.
+         * \param[in] btmode The border treatment mode used for the normalized convolution.
+         */
+        template <class T1, class T2>
+        void hessianWithMask(const vigra::MultiArrayView<2, T1> & src,
+                             const vigra::MultiArrayView<2, T2> & mask,
+                             ViewType gXX, ViewType gXY, ViewType gYY,
+                             vigra::BorderTreatmentMode btmode = vigra::BORDER_TREATMENT_CLIP)
+        {
+            std::vector<ViewType> temp = scratchImages(2, src.shape());
+            gradientAndHessianWithMask(src, mask, temp[0], temp[1], gXX, gXY, gYY, btmode);
+        }
+    
+        /**
+         * Masked structure tensor of an image using normalized convolution.
+         *
+         * \param[in] src The image.
+         * \param[in] mask The mask of the image (only mask != 0) will be considered.
+         * \param[out] stXX The xx-part of the Structure Tensor.
+         * \param[out] stXY The xy-part of the Structure Tensor.
+         * \param[out] stYY The yy-part of the Structure Tensor.
+         * \param[in] sigma_outer The scale of the outer Gaussian function used to smooth the partial derivatives.
+         * \param[in] btmode The border treatment mode used for the normalized convolution.
+         */
+        template <class T1, class T2>
+        void structureTensorWithMask(const vigra::MultiArrayView<2, T1> & src,
+                                     const vigra::MultiArrayView<2, T2> & mask,
+                                     ViewType stXX, ViewType stXY, ViewType stYY,
+                                     double sigma_outer,
+                                     vigra::BorderTreatmentMode btmode = vigra::BORDER_TREATMENT_CLIP)
+        {
+            vigra_precondition(stXX.shape() == stXY.shape(), "structure tensor array sizes differ!");
+            vigra_precondition(stXY.shape() == stYY.shape(), "structure tensor array sizes differ!");
+            vigra_precondition(src.shape() == stXX.shape(), "structure tensor array sizes differ from image sizes!");
+            
+            if(sigma_outer != m_outer_sigma)
+            {
+                m_outer_sigma = sigma_outer;
+                m_kernel_outer.initGaussian(sigma_outer);
+            }
+            m_kernel_outer.setBorderTreatment(btmode);
+            
+            std::vector<ViewType> temp = scratchImages(3, src.shape());
+            ViewType gX = temp[0], gY = temp[1], gXY = temp[2];
+            
+            gradientWithMask(src, mask, gX, gY, btmode);
+            
+            for(int y=0; y<src.height(); ++y)
+            {
+                for(int x=0; x<src.width(); ++x)
+                {
+                    const ValueType vx = gX(x,y), vy = gY(x,y);
+                    
+                    gXY(x,y) = vx*vy;
+                    gX(x,y)  = vx*vx;
+                    gY(x,y)  = vy*vy;
+                }
+            }
+            
+            vigra::normalizedConvolveImage(gX,  mask, stXX, m_kernel_outer);
+            vigra::normalizedConvolveImage(gXY, mask, stXY, m_kernel_outer);
+            vigra::normalizedConvolveImage(gY,  mask, stYY, m_kernel_outer);
+        }
+    
+        /**
+         * Masked spatio-temporal gradient of two images using normalized convolution.
+         * Since the normalized convolution is linear w.r.t. the image for a fixed mask, the
+         * temporal part is computed by one smoothing of the difference image I2-I1.
+         *
+         * \param[in] src1 The first image of the series.
+         * \param[in] src2 The second image of the series.
+         * \param[in] mask The masking of the scene (of the series).
+         * \param[out] gX The spatio-temporal gradient in x-direction.
+         * \param[out] gY The spatio-temporal gradient in y-direction.
+         * \param[out] gT The spatio-temporal gradient in temporal direction.
+         * \param[out] gXX Optional: The xx-part of the Hessian matrix of the mean image.
+         * \param[out] gXY Optional: The xy-part of the Hessian matrix of the mean image.
+         * \param[out] gYY Optional: The yy-part of the Hessian matrix of the mean image.
+         * \param[in] btmode The border treatment mode used for the normalized convolution.
+         */
+        template <class T1, class T2, class T3>
+        void spatioTemporalGradientWithMask(const vigra::MultiArrayView<2, T1> & src1,
+                                            const vigra::MultiArrayView<2, T2> & src2,
+                                            const vigra::MultiArrayView<2, T3> & mask,
+                                            ViewType gX, ViewType gY, ViewType gT,
+                                            ViewType gXX = ViewType(),
+                                            ViewType gXY = ViewType(),
+                                            ViewType gYY = ViewType(),
+                                            vigra::BorderTreatmentMode btmode = vigra::BORDER_TREATMENT_CLIP)
+        {
+            vigra_precondition(src1.shape() == src2.shape(), "image sizes differ!");
+            vigra_precondition(gY.shape() == gT.shape(), "gradient array sizes differ!");
+            
+            using namespace ::vigra::multi_math;
+            
+            ViewType temp = scratchImages(1, src1.shape())[0];
+            
+            //Spatial part of the spatio-temporal gradient
+            temp = 0.5*(src1 + src2);
+            gradientAndHessianWithMask(temp, mask, gX, gY, gXX, gXY, gYY, btmode);
+            
+            //Temporal part of the spatio-temporal gradient
+            temp = src2 - src1;
+            smoothingWithMask(temp, mask, gT, btmode);
+        }
+    
+    private:
+        /** Indices of the 1D kernels **/
+        enum KernelIndex { Smooth=0, Derivative1=1, Derivative2=2, KernelCount=3 };
+    
+        /** Maximal count of input channels of the fused pass **/
+        enum { ChannelCount=2 };
+    
+        /** A 1D kernel with coefficients for the indices left...right **/
+        struct Kernel
+        {
+            std::vector<ValueType> coefficients;
+            int left;
+            int right;
+        };
+    
+        /** One result of the fused pass: channel filtered by kernel_x and kernel_y **/
+        struct Output
+        {
+            Output(int c, int kx, int ky, ViewType v)
+            : channel(c), kernel_x(kx), kernel_y(ky), view(v)
+            {
+            }
+            
+            int channel;
+            int kernel_x;
+            int kernel_y;
+            ViewType view;
+        };
+    
+        /** Loads a row of an image into a padded line **/
+        template <class T1>
+        struct ImageLineLoader
+        {
+            ImageLineLoader(const vigra::MultiArrayView<2, T1> & s)
+            : src(s)
+            {
+            }
+            
+            void operator()(int /*channel*/, int y, ValueType * line, int pad) const
+            {
+                const int w = src.width();
+                
+                for(int x=0; x<w; ++x)
+                {
+                    line[pad+x] = src(x,y);
+                }
+                reflectBorders(line, w, pad);
+            }
+            
+            const vigra::MultiArrayView<2, T1> & src;
+        };
+    
+        /** Loads the mean (channel 0) or the difference (channel 1) of a row of two images **/
+        template <class T1, class T2>
+        struct SpatioTemporalLineLoader
+        {
+            SpatioTemporalLineLoader(const vigra::MultiArrayView<2, T1> & s1, const vigra::MultiArrayView<2, T2> & s2)
+            : src1(s1), src2(s2)
+            {
+            }
+            
+            void operator()(int channel, int y, ValueType * line, int pad) const
+            {
+                const int w = src1.width();
+                
+                if(channel == 0)
+                {
+                    for(int x=0; x<w; ++x)
+                    {
+                        line[pad+x] = 0.5*(src1(x,y) + src2(x,y));
+                    }
+                }
+                else
+                {
+                    for(int x=0; x<w; ++x)
+                    {
+                        line[pad+x] = src2(x,y) - src1(x,y);
+                    }
+                }
+                reflectBorders(line, w, pad);
+            }
+            
+            const vigra::MultiArrayView<2, T1> & src1;
+            const vigra::MultiArrayView<2, T2> & src2;
+        };
+    
+        /**
+         * Copies the coefficients of a vigra kernel.
+         */
+        static void storeKernel(const vigra::Kernel1D<double> & kernel, Kernel & dest)
+        {
+            dest.left  = kernel.left();
+            dest.right = kernel.right();
+            dest.coefficients.resize(dest.right - dest.left + 1);
+            
+            for(int i=dest.left; i<=dest.right; ++i)
+            {
+                dest.coefficients[i-dest.left] = kernel[i];
+            }
+        }
+    
+        /**
+         * Reflects an index at the borders [0, n-1] like vigra::BORDER_TREATMENT_REFLECT.
+         */
+        static int reflectIndex(int i, int n)
+        {
+            if(n == 1)
+                return 0;
+            
+            while(i < 0 || i >= n)
+            {
+                if(i < 0)
+                    i = -i;
+                if(i >= n)
+                    i = 2*(n-1) - i;
+            }
+            return i;
+        }
+    
+        /**
+         * Fills the padding of a line (pad values at each side) by reflection.
+         */
+        static void reflectBorders(ValueType * line, int w, int pad)
+        {
+            for(int x=1; x<=pad; ++x)
+            {
+                line[pad-x]     = line[pad + reflectIndex(-x, w)];
+                line[pad+w-1+x] = line[pad + reflectIndex(w-1+x, w)];
+            }
+        }
+    
+        /**
+         * Horizontal convolution: dest[x] = sum_k kernel[k]*src[x-k].
+         * The src line needs to be padded by the kernel's radius.
+         */
+        static void convolveLine(const ValueType * src, const Kernel & kernel, ValueType * dest, int w)
+        {
+            std::fill(dest, dest+w, ValueType());
+            
+            for(int k=kernel.left; k<=kernel.right; ++k)
+            {
+                const ValueType c = kernel.coefficients[k-kernel.left];
+                const ValueType * s = src - k;
+                
+                for(int x=0; x<w; ++x)
+                {
+                    dest[x] += c*s[x];
+                }
+            }
+        }
+    
+        /**
+         * Vertical convolution of a block of lines with a line stride of w.
+         * center points to the line at the current row.
+         */
+        static void convolveColumn(const ValueType * center, const Kernel & kernel, ValueType * dest, int w)
+        {
+            std::fill(dest, dest+w, ValueType());
+            
+            for(int k=kernel.left; k<=kernel.right; ++k)
+            {
+                const ValueType c = kernel.coefficients[k-kernel.left];
+                const ValueType * s = center - k*w;
+                
+                for(int x=0; x<w; ++x)
+                {
+                    dest[x] += c*s[x];
+                }
+            }
+        }
+    
+        /**
+         * Returns n views of the given shape into the engine's image scratch memory.
+         * Views returned by a former call are invalidated by this call.
+         */
+        std::vector<ViewType> scratchImages(unsigned int n, const vigra::Shape2 & shape)
+        {
+            const std::size_t size = shape[0]*shape[1];
+            
+            if(m_image_arena.size() < n*size)
+            {
+                m_image_arena.resize(n*size);
+            }
+            
+            std::vector<ViewType> views;
+            for(unsigned int i=0; i<n; ++i)
+            {
+                views.push_back(ViewType(shape, m_image_arena.data() + i*size));
+            }
+            return views;
+        }
+    
+        /**
+         * The fused, block-wise separable pass over one or two input channels.
+         *
+         * \param loader Fills a padded line with the row of a channel.
+         * \param shape The shape of the input and all outputs.
+         * \param outputs The requested outputs. Outputs without data are skipped.
+         */
+        template <class LineLoader>
+        void fusedPass(const LineLoader & loader, const vigra::Shape2 & shape, const std::vector<Output> & outputs)
+        {
+            const int w = shape[0],
+                      h = shape[1],
+                      r = m_radius;
+            
+            //Which horizontally filtered blocks of rows are needed?
+            int block_index[ChannelCount][KernelCount];
+            int block_count = 0;
+            
+            std::fill(&block_index[0][0], &block_index[0][0] + ChannelCount*KernelCount, -1);
+            
+            for(unsigned int o=0; o<outputs.size(); ++o)
+            {
+                const Output & out = outputs[o];
+                
+                if(out.view.hasData())
+                {
+                    vigra_precondition(out.view.shape() == shape, "result array sizes differ from image sizes!");
+                    
+                    if(block_index[out.channel][out.kernel_x] == -1)
+                    {
+                        block_index[out.channel][out.kernel_x] = block_count++;
+                    }
+                }
+            }
+            
+            if(block_count == 0)
+                return;
+            
+            const int block_height  = std::min(m_block_height, h),
+                      halo_height   = block_height + 2*r;
+            const std::size_t line_size  = w + 2*r,
+                              block_size = halo_height*w;
+            
+            if(m_line_arena.size() < line_size + w + block_count*block_size)
+            {
+                m_line_arena.resize(line_size + w + block_count*block_size);
+            }
+            
+            ValueType * line = m_line_arena.data(),
+                      * acc  = line + line_size,
+                      * rows = acc + w;
+            
+            for(int y0=0; y0<h; y0+=block_height)
+            {
+                const int y1 = std::min(y0+block_height, h);
+                
+                //1. Horizontal filtering of the block and its halo
+                for(int yy=y0-r; yy<y1+r; ++yy)
+                {
+                    const std::size_t offset = (yy-y0+r)*w;
+                    
+                    for(int c=0; c<ChannelCount; ++c)
+                    {
+                        bool channel_needed = false;
+                        for(int k=0; k<KernelCount; ++k)
+                        {
+                            channel_needed |= (block_index[c][k] != -1);
+                        }
+                        
+                        if(!channel_needed)
+                            continue;
+                        
+                        loader(c, reflectIndex(yy, h), line, r);
+                        
+                        for(int k=0; k<KernelCount; ++k)
+                        {
+                            if(block_index[c][k] != -1)
+                            {
+                                convolveLine(line + r, m_kernels[k], rows + block_index[c][k]*block_size + offset, w);
+                            }
+                        }
+                    }
+                }
+                
+                //2. Vertical filtering of all requested terms
+                for(int y=y0; y<y1; ++y)
+                {
+                    for(unsigned int o=0; o<outputs.size(); ++o)
+                    {
+                        const Output & out = outputs[o];
+                        
+                        if(!out.view.hasData())
+                            continue;
+                        
+                        ViewType view = out.view;
+                        
+                        const ValueType * center = rows + block_index[out.channel][out.kernel_x]*block_size + (y-y0+r)*w;
+                        
+                        //write directly into unstrided rows
+                        ValueType * dest = (view.stride(0) == 1) ? &view(0,y) : acc;
+                        
+                        convolveColumn(center, m_kernels[out.kernel_y], dest, w);
+                        
+                        if(dest == acc)
+                        {
+                            for(int x=0; x<w; ++x)
+                            {
+                                view(x,y) = acc[x];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    
+        double m_sigma;
+        double m_outer_sigma;
+        int m_radius;
+        int m_block_height;
+    
+        Kernel m_kernels[KernelCount];
+    
+        vigra::Kernel2D<float> m_kernel_gx;
+        vigra::Kernel2D<float> m_kernel_gy;
+        vigra::Kernel2D<float> m_kernel_smooth;
+        vigra::Kernel2D<float> m_kernel_outer;
+    
+        std::vector<ValueType> m_line_arena;
+        std::vector<ValueType> m_image_arena;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_OPTICALFLOW_GAUSSIANDERIVATIVES_HXX
@@ -50,12 +50,14 @@
 //TODO: If possible, fix them. If not, discard them.
 //#include "opticalflow_experimental.hxx
 
+#include "gaussianderivatives.hxx"
 #include "opticalflow_global.hxx"
 #include "opticalflow_hybrid.hxx"
 #include "opticalflow_local.hxx"
 #include "opticalflowalgorithms.hxx"
 #include "opticalflowframework.hxx"
 #include "opticalflowgradients.hxx"
+#include "variationalkernels.hxx"
 
 /**
  * @}
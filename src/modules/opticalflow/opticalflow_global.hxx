@@ -48,6 +48,10 @@
 
 //OFCE Spatiotemporal Gradients
 #include "opticalflowgradients.hxx"
+#include "images/pooledarray.hxx"
+
+//Planar update kernels
+#include "variationalkernels.hxx"
 
 
 
@@ -372,45 +376,44 @@ class OpticalFlowHSFunctor
             
             using namespace ::vigra;
             
-			vigra::MultiArray<2,ValueType> gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape());
+			PooledArray<2,ValueType> gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()),
+                                           factor(src1.shape()), mean_u(src1.shape()), mean_v(src1.shape());
+            
+            GaussianDerivativeEngine<ValueType> derivatives(m_sigma);
             
-            vigra::MultiArray<2, FlowValueType>  mean_flow(src1.shape());
-						
 			//spatiotemporal Gradients of first order: I_x, I_y and I_t
-			spatioTemporalGradient(src1, src2, gradX, gradY, gradT, m_sigma);
-			
-			double iter_change=0, mean_change=0, max_change=0;
+			derivatives.spatioTemporalGradient(src1, src2, gradX, gradY, gradT);
+            
+            //constant part of the update: 1/(alpha^2 + I_x^2 + I_y^2)
+            dataTermFactors(gradX, gradY, m_alpha, factor);
+            
+            //iterate on planar u and v
+            PlanarFlow planar(src1.shape());
+            planar.importFlow(flow);
 			
+            FlowChangeTracker<TrackChanges> changes;
+            
 			for (int iteration=1;iteration<=m_iterations; ++iteration)
 			{
-				mean_change=0;
-				max_change=0;
+                changes = FlowChangeTracker<TrackChanges>();
+                changes.setCount(src1.size());
+                
+				derivatives.derivatives(planar.u, mean_u, EmptyView(), EmptyView());
+				derivatives.derivatives(planar.v, mean_v, EmptyView(), EmptyView());
 				
-				vigra::gaussianSmoothing(flow, mean_flow,	m_sigma);
-				
-				for (int j=0; j<src1.height(); ++j)
-				{
-					for (int i=0; i<src1.width(); ++i)
-					{
-						double	fix_part	= (gradX(i,j)*mean_flow(i,j)[0]+ gradY(i,j)*mean_flow(i,j)[1]+ gradT(i,j))	/	(m_alpha*m_alpha + gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j)),
-								new_u		= mean_flow(i,j)[0] - fix_part*gradX(i,j),
-								new_v		= mean_flow(i,j)[1] - fix_part*gradY(i,j);
-						
-						iter_change = sqrt(		pow(flow(i,j)[0] - new_u,2)
-										   +	pow(flow(i,j)[1] - new_v,2));
-						
-						mean_change	+= iter_change;
-						max_change = max(max_change, iter_change);
-                        
-						flow(i,j)[0] = new_u;
-                        flow(i,j)[1] = new_v;
-					}
-				}
-				mean_change = mean_change / src1.size();
-				//qDebug() << iteration << ":\t mean change this iteration: " << mean_change << "\n";
-				//qDebug() << iteration << ":\t max change this iteration: " << max_change << "\n\n";
-				//if(mean_change < 0.001/(m_alpha*m_alpha*m_alpha) || max_change < 0.001/(m_alpha*m_alpha)) break;
+                hornSchunckUpdate<false, TrackChanges>(gradX.data(), gradY.data(), gradT.data(),
+                                                       factor.data(),
+                                                       mean_u.data(), mean_v.data(),
+                                                       NULL,
+                                                       planar.u.data(), planar.v.data(),
+                                                       src1.size(),
+                                                       changes);
+                
+				//qDebug() << iteration << ":\t mean change this iteration: " << changes.meanChange() << "\n";
+				//qDebug() << iteration << ":\t max change this iteration: " << changes.maxChange() << "\n\n";
 			}
+            
+            planar.exportFlow(flow);
 		}
 		
 		/**
@@ -434,51 +437,54 @@ class OpticalFlowHSFunctor
             
             using namespace ::vigra;
             
-			vigra::MultiArray<2,ValueType> gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape());
+			PooledArray<2,ValueType> gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()),
+                                           factor(src1.shape()), mean_u(src1.shape()), mean_v(src1.shape()),
+                                           weights(src1.shape());
+            
+            GaussianDerivativeEngine<ValueType> derivatives(m_sigma);
             
-            vigra::MultiArray<2, FlowValueType>  mean_flow(src1.shape());
-						
 			//spatiotemporal Gradients of first order: I_x, I_y and I_t
-			spatioTemporalGradientWithMask(src1, src2, mask, gradX, gradY, gradT, m_sigma);
-			
-			double iter_change=0, mean_change=0, max_change=0;
+			derivatives.spatioTemporalGradientWithMask(src1, src2, mask, gradX, gradY, gradT);
+            
+            //constant part of the update: 1/(alpha^2 + I_x^2 + I_y^2)
+            dataTermFactors(gradX, gradY, m_alpha, factor);
+            maskToWeights(mask, weights);
+            
+            //iterate on planar u and v
+            PlanarFlow planar(src1.shape());
+            planar.importFlow(flow);
 			
+            FlowChangeTracker<TrackChanges> changes;
+            
 			for (int iteration=1;iteration<=m_iterations; ++iteration)
 			{
-				mean_change=0;
-				max_change=0;
+                changes = FlowChangeTracker<TrackChanges>();
+                changes.setCount(src1.size());
+                
+				derivatives.smoothingWithMask(planar.u, mask, mean_u);
+				derivatives.smoothingWithMask(planar.v, mask, mean_v);
 				
-				gaussianSmoothingWithMask(flow, mask, mean_flow,	m_sigma);
-				
-				for (int j=0; j<src1.height(); ++j)
-				{
-					for (int i=0; i<src1.width(); ++i)
-					{
-						if(mask(i,j) !=0)
-                        {
-                            double	fix_part	= (gradX(i,j)*mean_flow(i,j)[0]+ gradY(i,j)*mean_flow(i,j)[1]+ gradT(i,j))	/	(m_alpha*m_alpha + gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j)),
-                                    new_u		= mean_flow(i,j)[0] -fix_part*gradX(i,j),
-                                    new_v		= mean_flow(i,j)[1] -fix_part*gradY(i,j);
-						
-                            iter_change = sqrt(		pow(flow(i,j)[0] - new_u,2)
-										   +	pow(flow(i,j)[1] - new_v,2));
-						
-                            mean_change	+= iter_change;
-                            max_change = max(max_change, iter_change);
-						
-                            flow(i,j)[0] = new_u;
-                            flow(i,j)[1] = new_v;
-						}
-					}
-				}
-				mean_change = mean_change / src1.size();
-				//qDebug() << iteration << ":\t mean change this iteration: " << mean_change << "\n";
-				//qDebug() << iteration << ":\t max change this iteration: " << max_change << "\n\n";
-				//if(mean_change < 0.001/(m_alpha*m_alpha*m_alpha) || max_change < 0.001/(m_alpha*m_alpha)) break;
+                hornSchunckUpdate<true, TrackChanges>(gradX.data(), gradY.data(), gradT.data(),
+                                                      factor.data(),
+                                                      mean_u.data(), mean_v.data(),
+                                                      weights.data(),
+                                                      planar.u.data(), planar.v.data(),
+                                                      src1.size(),
+                                                      changes);
+                
+				//qDebug() << iteration << ":\t mean change this iteration: " << changes.meanChange() << "\n";
+				//qDebug() << iteration << ":\t max change this iteration: " << changes.maxChange() << "\n\n";
 			}
+            
+            planar.exportFlow(flow);
 		}
     
 	private:
+        /** Track the mean/max change per iteration (for debugging only) **/
+        static const bool TrackChanges = false;
+        /** Empty view type to skip results of the derivative engine **/
+        typedef GaussianDerivativeEngine<ValueType>::ViewType EmptyView;
+    
 		double	m_alpha;
 		int		m_iterations;
 		double  m_sigma;
@@ -570,136 +576,58 @@ class OpticalFlowNEFunctor
             using namespace ::vigra;
             using namespace ::vigra::linalg;
             
-			vigra::MultiArray<2,ValueType>  gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()),
+			PooledArray<2,ValueType>  gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()),
                                      gradXX(src1.shape()), gradXY(src1.shape()), gradYY(src1.shape()),
-                                     q_x(src1.shape()), q_y(src1.shape()),
+                                     factor(src1.shape()),
+                                     q_x(src1.shape()), q_y(src1.shape()), c_xy(src1.shape()),
+                                     mean_u(src1.shape()), mean_v(src1.shape()),
                                      u_x(src1.shape()),	v_x(src1.shape()),
                                      u_y(src1.shape()),	v_y(src1.shape()),
-                                     u_xy(src1.shape()), v_xy(src1.shape()),
-                                     temp(src1.shape());
+                                     u_xy(src1.shape()), v_xy(src1.shape());
             
-            vigra::MultiArray<2,FlowValueType> mean_flow(src1.shape());
-            
-			double	delta  = 1; 						
+			double	delta  = 1;
             
-            temp = src1;
-            temp += src2;
-            temp /= 2;
+            GaussianDerivativeEngine<ValueType> derivatives(m_sigma);
             
-			// Second order derivatives from hessian (matrix) of gaussian
-			vigra::hessianMatrixOfGaussian(temp, gradXX, gradXY, gradYY, m_sigma);
-			
-			//spatiotemporal Gradients of first order: I_x, I_y and I_t
-			spatioTemporalGradient(src1, src2, gradX, gradY, gradT, m_sigma);
-					
-			//preparing q_x and q_y (is constant for all iterations)
-			for (int j=0; j<src1.height(); ++j)
-			{
-				for (int i=0; i<src1.width(); ++i)
-				{
-					vigra::Matrix<double>	W(2,2),	hessOfGauss(2,2), invHessOfGauss(2,2), nablaI_t(1,2), q_mat(1,2);
+			//spatiotemporal Gradients of first order: I_x, I_y and I_t and
+			//second order derivatives from hessian (matrix) of gaussian of the mean image
+			derivatives.spatioTemporalGradient(src1, src2, gradX, gradY, gradT, gradXX, gradXY, gradYY);
 					
-					//Calculate weight matrix W
-					W(0,0) = gradY(i,j)*gradY(i,j) + delta;
-					W(1,0) = -gradX(i,j)*gradY(i,j);
-					W(0,1) = -gradX(i,j)*gradY(i,j);
-					W(1,1) = gradX(i,j)*gradX(i,j) + delta;
-					
-					W = 1.0/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2.0*delta) * W;
-					
-					//Calculate q
-					invHessOfGauss(0,0) = gradYY(i,j);			
-					invHessOfGauss(1,0) = -gradXY(i,j);
-					invHessOfGauss(0,1) = -gradXY(i,j);
-					invHessOfGauss(1,1) = gradXX(i,j);
-					
-					hessOfGauss(0,0) = gradXX(i,j);	
-					hessOfGauss(1,0) = gradXY(i,j);	
-					hessOfGauss(0,1) = gradXY(i,j);
-					hessOfGauss(1,1) = gradYY(i,j);
-					
-					nablaI_t(0,0) = gradX(i,j);
-					nablaI_t(0,1) = gradY(i,j);
-					
-					q_mat	=	1.0/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2.0*delta)
-								*	(nablaI_t * (invHessOfGauss + 2.0*hessOfGauss*W));
-					
-					q_x(i,j) = q_mat(0,0);
-					q_y(i,j) = q_mat(0,1);
-				}
-			}
-			
-			double iter_change=0, mean_change=0,max_change=0;
+			//preparing q_x, q_y and the mixed term factors (constant for all iterations)
+            nagelEnkelmannTerms(gradX, gradY, gradXX, gradXY, gradYY, delta, q_x, q_y, c_xy);
+            dataTermFactors(gradX, gradY, m_alpha, factor);
 			
-			double	Xi_u, Xi_v, fix_part, new_u, new_v;
+            //iterate on planar u and v
+            PlanarFlow planar(src1.shape());
+            planar.importFlow(flow);
 			
-			//prepare gaussian kernel for smoothing of vectorfields
-			vigra::Kernel1D<float> k; 
-			k.initGaussianDerivative(m_sigma, 1);
+            FlowChangeTracker<TrackChanges> changes;
 			
 			//do iterations
 			for (int iteration=1; iteration<=m_iterations; ++iteration)
 			{
-				mean_change=0;
-				max_change=0;
+                changes = FlowChangeTracker<TrackChanges>();
+                changes.setCount(src1.size());
 				
-				//u,v-mean
-				vigra::gaussianSmoothing(flow, mean_flow, m_sigma);
-				
-				// u_x and u_y
-				vigra::gaussianGradient(flow.bindElementChannel(0), u_x, u_y, m_sigma);
-				
-				// u_xy
-				vigra::separableConvolveX(flow.bindElementChannel(0), temp, k);
-				vigra::separableConvolveY(temp, u_xy, k);
-								
-				// v_x and v_y
-				vigra::gaussianGradient(flow.bindElementChannel(1), v_x, v_y, m_sigma);
+				//u,v-mean, u_x, u_y, u_xy and v_x, v_y, v_xy by one fused pass each
+				derivatives.derivatives(planar.u, mean_u, u_x, u_y, EmptyView(), u_xy);
+				derivatives.derivatives(planar.v, mean_v, v_x, v_y, EmptyView(), v_xy);
 				
-				// v_xy
-				vigra::separableConvolveX(flow.bindElementChannel(1), temp, k);
-				vigra::separableConvolveY(temp, v_xy, k);
+                nagelEnkelmannUpdate<false, TrackChanges>(gradX.data(), gradY.data(), gradT.data(),
+                                                          factor.data(),
+                                                          q_x.data(), q_y.data(), c_xy.data(),
+                                                          mean_u.data(), u_x.data(), u_y.data(), u_xy.data(),
+                                                          mean_v.data(), v_x.data(), v_y.data(), v_xy.data(),
+                                                          NULL,
+                                                          planar.u.data(), planar.v.data(),
+                                                          src1.size(),
+                                                          changes);
 				
-                for (int j=0; j<src1.height(); ++j)
-                {
-                    for (int i=0; i<src1.width(); ++i)
-                    {
-						//Calculate Xi's
-						Xi_u =		mean_flow(i,j)[0] 
-								-	2.0*gradX(i,j)*gradY(i,j)*u_xy(i,j)/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2*delta)
-								-	(q_x(i,j)*u_x(i,j)+q_y(i,j)*u_y(i,j));
-						
-						Xi_v =		mean_flow(i,j)[1]
-								-	2.0*gradX(i,j)*gradY(i,j)*v_xy(i,j)/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2*delta)
-								-	(q_x(i,j)*v_x(i,j)+q_y(i,j)*v_y(i,j));
-						
-						//Assign new values
-						fix_part =  (gradX(i,j)*Xi_u +gradY(i,j)*Xi_v + gradT(i,j)) / (gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + m_alpha*m_alpha);
-						
-						new_u = Xi_u - gradX(i,j)*fix_part;
-						new_v = Xi_v - gradY(i,j)*fix_part;
-						
-						//qDebug() << "q: (" << q_x(i,j) << ", "<< q_y(i,j) << ")\n";
-						//qDebug() << "Xi: (" << Xi_u << ", "<< Xi_v << ")\n";
-						//qDebug() << "fix_part: (" << fix_part << ")\n";
-						//qDebug() << "new: (" << new_u << ", "<< new_v << ")\n";
-						
-						iter_change = sqrt(		pow(flow(i,j)[0] - new_u,2)
-											+	pow(flow(i,j)[1] - new_v,2));
-						
-						mean_change += iter_change;
-						max_change = max(max_change, iter_change);
-						
-						flow(i,j)[0] = new_u;
-						flow(i,j)[1] = new_v;
-					}
-				}
-				
-				mean_change = mean_change / src1.size();
-				//qDebug() << iteration << ":\t mean change this iteration: " << mean_change << "\n";
-				//qDebug() << iteration << ":\t max change this iteration: " << max_change << "\n\n";
-				//if(mean_change < 0.001/(m_alpha*m_alpha*m_alpha) || max_change < 0.001/(m_alpha*m_alpha)) break;
+				//qDebug() << iteration << ":\t mean change this iteration: " << changes.meanChange() << "\n";
+				//qDebug() << iteration << ":\t max change this iteration: " << changes.maxChange() << "\n\n";
 			}
+            
+            planar.exportFlow(flow);
 		}
 	
 		/**
@@ -723,143 +651,73 @@ class OpticalFlowNEFunctor
             using namespace ::vigra;
             using namespace ::vigra::linalg;
             
-			vigra::MultiArray<2,ValueType>  gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()),
+			PooledArray<2,ValueType>  gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()),
                                      gradXX(src1.shape()), gradXY(src1.shape()), gradYY(src1.shape()),
+                                     factor(src1.shape()), weights(src1.shape()),
+                                     q_x(src1.shape()), q_y(src1.shape()), c_xy(src1.shape()),
                                      mean_u(src1.shape()), mean_v(src1.shape()),
-                                     q_x(src1.shape()), q_y(src1.shape()),
                                      u_x(src1.shape()),	v_x(src1.shape()),
                                      u_y(src1.shape()),	v_y(src1.shape()),
-                                     u_xy(src1.shape()), v_xy(src1.shape()),
-                                     temp(src1.shape());
-            
-            vigra::MultiArray<2,FlowValueType> mean_flow(src1.shape());
+                                     u_xy(src1.shape()), v_xy(src1.shape());
             
 			double	delta  = 1;
             
-            temp = src1;
-            temp += src2;
-            temp /= 2;
+            GaussianDerivativeEngine<ValueType> derivatives(m_sigma);
 			
-			// Second order derivatives from hessian (matrix) of gaussian
-			hessianMatrixOfGaussianWithMask(temp,  mask, gradXX, gradXY, gradYY, m_sigma);
-			
-			//spatiotemporal Gradients of first order: I_x, I_y and I_t
-			spatioTemporalGradientWithMask(src1, src2, mask, gradX, gradY, gradT, m_sigma);
-			
-			//preparing q_x and q_y (is constant for all iterations)
-            for (int j=0; j<src1.height(); ++j)
-            {
-                for (int i=0; i<src1.width(); ++i)
-                {
-                    
-					vigra::Matrix<double>	W(2,2),	hessOfGauss(2,2), invHessOfGauss(2,2), nablaI_t(1,2), q_mat(1,2);
-					
-					//Calculate weight matrix W
-					W(0,0) = gradY(i,j)*gradY(i,j) + delta;
-					W(1,0) = -gradX(i,j)*gradY(i,j);
-					W(0,1) = -gradX(i,j)*gradY(i,j);
-					W(1,1) = gradX(i,j)*gradX(i,j) + delta;
-					
-					W = 1.0/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2.0*delta) * W;
-					
-					//Calculate q
-					invHessOfGauss(0,0) = gradYY(i,j);			
-					invHessOfGauss(1,0) = -gradXY(i,j);
-					invHessOfGauss(0,1) = -gradXY(i,j);
-					invHessOfGauss(1,1) = gradXX(i,j);
-					
-					hessOfGauss(0,0) = gradXX(i,j);	
-					hessOfGauss(1,0) = gradXY(i,j);	
-					hessOfGauss(0,1) = gradXY(i,j);
-					hessOfGauss(1,1) = gradYY(i,j);
-					
-					nablaI_t(0,0) = gradX(i,j);
-					nablaI_t(0,1) = gradY(i,j);
-					
-					q_mat	=	1.0/	(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2.0*delta)
-									*	(nablaI_t * (invHessOfGauss + 2.0*hessOfGauss*W));
-					
-					q_x(i,j) = q_mat(0,0);
-					q_y(i,j) = q_mat(0,1);
-				}
-			}
+			//spatiotemporal Gradients of first order: I_x, I_y and I_t and
+			//second order derivatives from hessian (matrix) of gaussian of the mean image
+			derivatives.spatioTemporalGradientWithMask(src1, src2, mask, gradX, gradY, gradT, gradXX, gradXY, gradYY);
 			
-			double iter_change=0, mean_change=0,max_change=0;
+			//preparing q_x, q_y and the mixed term factors (constant for all iterations)
+            nagelEnkelmannTerms(gradX, gradY, gradXX, gradXY, gradYY, delta, q_x, q_y, c_xy);
+            dataTermFactors(gradX, gradY, m_alpha, factor);
+            maskToWeights(mask, weights);
 			
-			double	Xi_u, Xi_v, fix_part, new_u, new_v;
+            //iterate on planar u and v
+            PlanarFlow planar(src1.shape());
+            planar.importFlow(flow);
 			
-			//prepare gaussian kernel for smoothing of vectorfields
-			vigra::Kernel1D<float> k; 
-			k.initGaussianDerivative(m_sigma, 1);
+            FlowChangeTracker<TrackChanges> changes;
 			
 			//do iterations
 			for (int iteration=1; iteration<=m_iterations; ++iteration)
 			{
-				mean_change=0;
-				max_change=0;
+                changes = FlowChangeTracker<TrackChanges>();
+                changes.setCount(src1.size());
 				
 				//u,v-mean
-				gaussianSmoothingWithMask(flow, mask, mean_flow, m_sigma);
+				derivatives.smoothingWithMask(planar.u, mask, mean_u);
+				derivatives.smoothingWithMask(planar.v, mask, mean_v);
 				
-				// u_x and u_y
-				gaussianGradientWithMask(flow.bindElementChannel(0), mask, u_x, u_y,	m_sigma);
+				// u_x, u_y and u_xy
+				derivatives.gradientAndHessianWithMask(planar.u, mask, u_x, u_y, EmptyView(), u_xy, EmptyView());
 				
-				// u_xy
-				gaussianGradient2ndMixedTermWithMask(flow.bindElementChannel(0), mask, u_xy, m_sigma);
-								
-				// v_x and v_y
-				gaussianGradientWithMask(flow.bindElementChannel(1), mask, v_x, v_y, m_sigma);
+				// v_x, v_y and v_xy
+				derivatives.gradientAndHessianWithMask(planar.v, mask, v_x, v_y, EmptyView(), v_xy, EmptyView());
 				
-				// v_xy
-				gaussianGradient2ndMixedTermWithMask(flow.bindElementChannel(1), mask, v_xy, m_sigma);
+                nagelEnkelmannUpdate<true, TrackChanges>(gradX.data(), gradY.data(), gradT.data(),
+                                                         factor.data(),
+                                                         q_x.data(), q_y.data(), c_xy.data(),
+                                                         mean_u.data(), u_x.data(), u_y.data(), u_xy.data(),
+                                                         mean_v.data(), v_x.data(), v_y.data(), v_xy.data(),
+                                                         weights.data(),
+                                                         planar.u.data(), planar.v.data(),
+                                                         src1.size(),
+                                                         changes);
 				
-                for (int j=0; j<src1.height(); ++j)
-                {
-                    for (int i=0; i<src1.width(); ++i)
-                    {
-						if(mask(i,j) !=0)
-						{
-                            //Calculate Xi's
-                            Xi_u =		mean_flow(i,j)[0] 
-                                    -	2.0*gradX(i,j)*gradY(i,j)*u_xy(i,j)/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2*delta)
-                                    -	(q_x(i,j)*u_x(i,j)+q_y(i,j)*u_y(i,j));
-                            
-                            Xi_v =		mean_flow(i,j)[1]
-                                    -	2.0*gradX(i,j)*gradY(i,j)*v_xy(i,j)/(gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + 2*delta)
-                                    -	(q_x(i,j)*v_x(i,j)+q_y(i,j)*v_y(i,j));
-                            
-                            //Assign new values
-                            fix_part =  (gradX(i,j)*Xi_u +gradY(i,j)*Xi_v + gradT(i,j)) / (gradX(i,j)*gradX(i,j) + gradY(i,j)*gradY(i,j) + m_alpha*m_alpha);
-                            
-                            new_u = Xi_u - gradX(i,j)*fix_part;
-                            new_v = Xi_v - gradY(i,j)*fix_part;
-                            
-                            //qDebug() << "q: (" << q_x(i,j) << ", "<< q_y(i,j) << ")\n";
-                            //qDebug() << "Xi: (" << Xi_u << ", "<< Xi_v << ")\n";
-                            //qDebug() << "fix_part: (" << fix_part << ")\n";
-                            //qDebug() << "new: (" << new_u << ", "<< new_v << ")\n";
-                            
-                            iter_change = sqrt(		pow(flow(i,j)[0] - new_u,2)
-                                               +	pow(flow(i,j)[1] - new_v,2));
-                            
-                            mean_change += iter_change;
-                            max_change = std::max(max_change, iter_change);
-                            
-                            flow(i,j)[0] = new_u;
-                            flow(i,j)[1] = new_v;
-                        }
-					}
-				}
-				
-				mean_change = mean_change /src1.size();
-				//qDebug() << iteration << ":\t mean change this iteration: " << mean_change << "\n";
-				//qDebug() << iteration << ":\t max change this iteration: " << max_change << "\n\n";
-				//if(mean_change < 0.001/(m_alpha*m_alpha*m_alpha) || max_change < 0.001/(m_alpha*m_alpha)) break;
+				//qDebug() << iteration << ":\t mean change this iteration: " << changes.meanChange() << "\n";
+				//qDebug() << iteration << ":\t max change this iteration: " << changes.maxChange() << "\n\n";
 			}
-			
+            
+            planar.exportFlow(flow);
 		}
 
    private:
+        /** Track the mean/max change per iteration (for debugging only) **/
+        static const bool TrackChanges = false;
+        /** Empty view type to skip results of the derivative engine **/
+        typedef GaussianDerivativeEngine<ValueType>::ViewType EmptyView;
+    
 		double	m_alpha;
 		int		m_iterations;
 		double  m_sigma;
@@ -42,6 +42,9 @@
 //OFCE Spatiotemporal Gradients
 #include "opticalflowgradients.hxx"
 
+//Planar update kernels
+#include "variationalkernels.hxx"
+
 
 namespace graipe {
 
@@ -134,10 +137,13 @@ class OpticalFlowCLGFunctor
             using namespace ::vigra::multi_math;
 			
 			vigra::MultiArray<2, ValueType> stxx(src1.shape()), stxy(src1.shape()), styy(src1.shape()),
-                                            gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()), temp(src1.shape());
-            
-            vigra::MultiArray<2, FlowValueType> last_flow(src1.shape());
+                                            gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()), temp(src1.shape()),
+                                            b_x(src1.shape()), b_y(src1.shape()),
+                                            k_u(src1.shape()), k_v(src1.shape()),
+                                            last_u(src1.shape()), last_v(src1.shape());
 			
+            GaussianDerivativeEngine<ValueType> derivatives(m_sigma);
+            
             temp = (src1+src2)/2;
             
 			// calculate Structure Tensor at inner scale = sigma and outer scale = sigma2
@@ -147,58 +153,60 @@ class OpticalFlowCLGFunctor
 			//Calculate spatio temporal gradients for the vector "b"
 			
 			//1. step: calculate spatiotemporal Gradients of first order: I_x, I_y and I_t
-			spatioTemporalGradient(src1, src2, gradX, gradY, gradT, m_sigma);
+			derivatives.spatioTemporalGradient(src1, src2, gradX, gradY, gradT);
 			
 			//2. step:	set I_x =>  b_x = smooth<I_x * I_t>
 			//			    I_y =>  b_y = smooth<I_y * I_t>
 			gradX = gradT*gradX;
 			gradY = gradT*gradY;
-			vigra::gaussianSmoothing(gradY, gradX,	m_outer_sigma);
-			vigra::gaussianSmoothing(gradY, gradY,	m_outer_sigma);
+			vigra::gaussianSmoothing(gradX, b_x,	m_outer_sigma);
+			vigra::gaussianSmoothing(gradY, b_y,	m_outer_sigma);
 			
 			
-			int max_iter = m_iterations;
-			double	omega = m_omega,
-					iter_change=0,
-					mean_change=0,
-					max_change=0;
+			int max_iter = m_iterations,
+                w = src1.width();
+			float omega = m_omega,
+                  inv_alpha = 1.0/m_alpha;
+            
+            //3. step: SOR factors, which are constant for all iterations
+            k_u = omega/(4.0f + inv_alpha*stxx);
+            k_v = omega/(4.0f + inv_alpha*styy);
+            
+            //iterate on planar u and v
+            PlanarFlow planar(src1.shape());
+            planar.importFlow(flow);
+            
+            std::vector<float> row_buffer(2*w);
+            FlowChangeTracker<TrackChanges> changes;
 			
 			for(int iteration=1; iteration<=max_iter; iteration++)
 			{
 				//save last results
-				last_flow = flow;
+				last_u = planar.u;
+				last_v = planar.v;
 				
-				mean_change=0;
-				max_change=0;
+                changes = FlowChangeTracker<TrackChanges>();
+                changes.setCount(src1.size());
 				
 				for (int j=1;j<src1.height()-1; ++j)
 				{
-					for (int i=1;i<src1.width()-1; ++i)
-					{
-						 //With SOR (successive over-relaxation)
-						 flow(i,j)[0] = (1.0-omega)*last_flow(i,j)[0]
-										+	omega*(		(flow(i-1,j)[0] + flow(i,j-1)[0])
-													+	(last_flow(i+1,j)[0]+last_flow(i,j+1)[0])
-													-	(1.0/m_alpha)*(stxy(i,j)*last_flow(i,j)[1] + gradX(i,j)))
-										/	(4.0 + (1.0/m_alpha)*stxx(i,j));
-						
-						 flow(i,j)[1] = (1.0-omega)*last_flow(i,j)[1]
-									   +	omega*(		(flow(i-1,j)[1] + flow(i,j-1)[1])
-													+	(last_flow(i+1,j)[1]+last_flow(i,j+1)[1])
-													-	(1.0/m_alpha)*(stxy(i,j)*last_flow(i,j)[0] + gradY(i,j)))
-									   /	(4.0 + (1.0/m_alpha)*styy(i,j));
-						
-						iter_change =  vigra::norm(last_flow(i,j) - flow(i,j));
-						mean_change += iter_change;
-										
-                        max_change = std::max(max_change, iter_change);
-					}
+                    const int offset = j*w;
+                    
+                    clgSORRowUpdate<false, TrackChanges>(w, omega, inv_alpha,
+                                                         stxy.data()+offset, b_x.data()+offset, b_y.data()+offset,
+                                                         k_u.data()+offset, k_v.data()+offset,
+                                                         last_u.data()+offset, last_v.data()+offset,
+                                                         NULL,
+                                                         planar.u.data()+offset, planar.v.data()+offset,
+                                                         &row_buffer[0],
+                                                         changes);
 				}
-				mean_change = mean_change / src1.size();
-				//qDebug() << iteration << ":\t mean change this iteration: " << mean_change << "\n";
-				//qDebug() << iteration << ":\t max change this iteration: " << max_change << "\n\n";
-				//if(mean_change < 0.001/(m_alpha*m_alpha*m_alpha) || max_change < 0.001/(m_alpha*m_alpha)) break;
+				//qDebug() << iteration << ":\t mean change this iteration: " << changes.meanChange() << "\n";
+				//qDebug() << iteration << ":\t max change this iteration: " << changes.maxChange() << "\n\n";
+				//if(changes.meanChange() < 0.001/(m_alpha*m_alpha*m_alpha) || changes.maxChange() < 0.001/(m_alpha*m_alpha)) break;
 			}
+            
+            planar.exportFlow(flow);
 		}
 	
 		/**
@@ -224,77 +232,84 @@ class OpticalFlowCLGFunctor
             using namespace ::vigra::multi_math;
             
 			vigra::MultiArray<2, ValueType> stxx(src1.shape()), stxy(src1.shape()), styy(src1.shape()),
-                                            gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()), temp(src1.shape());
-           
-            vigra::MultiArray<2,FlowValueType> last_flow(src1.shape());
+                                            gradX(src1.shape()), gradY(src1.shape()), gradT(src1.shape()), temp(src1.shape()),
+                                            b_x(src1.shape()), b_y(src1.shape()),
+                                            k_u(src1.shape()), k_v(src1.shape()),
+                                            last_u(src1.shape()), last_v(src1.shape()),
+                                            weights(src1.shape());
+            
+            GaussianDerivativeEngine<ValueType> derivatives(m_sigma);
             
             temp = (src1+src2)/2;
             
 			// calculate Structure Tensor at inner scale = sigma and outer scale = sigma2
-			structureTensorWithMask(temp, mask, stxx, stxy, styy, m_sigma, m_outer_sigma);
+			derivatives.structureTensorWithMask(temp, mask, stxx, stxy, styy, m_outer_sigma);
 			
 			
 			//Calculate spatio temporal gradients for the vector "b"
 			
 			//1. step: calculate spatiotemporal Gradients of first order: I_x, I_y and I_t
-			spatioTemporalGradientWithMask(src1, src2, mask, gradX , gradY, gradT, m_sigma);
+			derivatives.spatioTemporalGradientWithMask(src1, src2, mask, gradX , gradY, gradT);
 			
 			//2. step:	set I_x =>  b_x = smooth<I_x * I_t>
 			//			    I_y =>  b_y = smooth<I_y * I_t>
 			gradX = gradT*gradX;
 			gradY = gradT*gradY;
-			gaussianSmoothingWithMask(gradY, mask, gradX,	m_outer_sigma);
-			gaussianSmoothingWithMask(gradY, mask, gradY,	m_outer_sigma);
+			gaussianSmoothingWithMask(gradX, mask, b_x,	m_outer_sigma);
+			gaussianSmoothingWithMask(gradY, mask, b_y,	m_outer_sigma);
 			
 			
-			int max_iter = m_iterations;
-			double	omega = m_omega,
-			iter_change=0,
-			mean_change=0,
-			max_change=0;
+			int max_iter = m_iterations,
+                w = src1.width();
+			float omega = m_omega,
+                  inv_alpha = 1.0/m_alpha;
+            
+            //3. step: SOR factors, which are constant for all iterations
+            k_u = omega/(4.0f + inv_alpha*stxx);
+            k_v = omega/(4.0f + inv_alpha*styy);
+            maskToWeights(mask, weights);
+            
+            //iterate on planar u and v
+            PlanarFlow planar(src1.shape());
+            planar.importFlow(flow);
+            
+            std::vector<float> row_buffer(2*w);
+            FlowChangeTracker<TrackChanges> changes;
 			
 			for(int iteration=1; iteration<=max_iter; iteration++)
 			{
 				//save last results
-				last_flow = flow;
+				last_u = planar.u;
+				last_v = planar.v;
 				
-				mean_change=0;
-				max_change=0;
+                changes = FlowChangeTracker<TrackChanges>();
+                changes.setCount(src1.size());
 				
 				for (int j=1;j<src1.height()-1; ++j)
 				{
-					for (int i=1;i<src1.width()-1; ++i)
-					{
-						if(	mask(i,j) !=0 )
-						{
-						 //With SOR (successive over-relaxation)
-						 flow(i,j)[0] = (1.0-omega)*last_flow(i,j)[0]
-										+	omega*(		(flow(i-1,j)[0] + flow(i,j-1)[0])
-													+	(last_flow(i+1,j)[0]+last_flow(i,j+1)[0])
-													-	(1.0/m_alpha)*(stxy(i,j)*last_flow(i,j)[1] + gradX(i,j)))
-										/	(4.0 + (1.0/m_alpha)*stxx(i,j));
-						
-						 flow(i,j)[1] = (1.0-omega)*last_flow(i,j)[1]
-									   +	omega*(		(flow(i-1,j)[1] + flow(i,j-1)[1])
-													+	(last_flow(i+1,j)[1]+last_flow(i,j+1)[1])
-													-	(1.0/m_alpha)*(stxy(i,j)*last_flow(i,j)[0] + gradY(i,j)))
-									   /	(4.0 + (1.0/m_alpha)*styy(i,j));
-						
-						iter_change =  vigra::norm(last_flow(i,j) - flow(i,j));
-						mean_change += iter_change;
-										
-                        max_change = std::max(max_change, iter_change);
-                        }
-                    }
+                    const int offset = j*w;
+                    
+                    clgSORRowUpdate<true, TrackChanges>(w, omega, inv_alpha,
+                                                        stxy.data()+offset, b_x.data()+offset, b_y.data()+offset,
+                                                        k_u.data()+offset, k_v.data()+offset,
+                                                        last_u.data()+offset, last_v.data()+offset,
+                                                        weights.data()+offset,
+                                                        planar.u.data()+offset, planar.v.data()+offset,
+                                                        &row_buffer[0],
+                                                        changes);
 				}
-				mean_change = mean_change / src1.size();
-				//qDebug() << iteration << ":\t mean change this iteration: " << mean_change << "\n";
-				//qDebug() << iteration << ":\t max change this iteration: " << max_change << "\n\n";
-				//if(mean_change < 0.001/(m_alpha*m_alpha*m_alpha) || max_change < 0.001/(m_alpha*m_alpha)) break;
+				//qDebug() << iteration << ":\t mean change this iteration: " << changes.meanChange() << "\n";
+				//qDebug() << iteration << ":\t max change this iteration: " << changes.maxChange() << "\n\n";
+				//if(changes.meanChange() < 0.001/(m_alpha*m_alpha*m_alpha) || changes.maxChange() < 0.001/(m_alpha*m_alpha)) break;
 			}
+            
+            planar.exportFlow(flow);
 		}
     
     private:
+        /** Track the mean/max change per iteration (for debugging only) **/
+        static const bool TrackChanges = false;
+    
 		double	m_outer_sigma;
 		double	m_sigma;
 		double	m_alpha;
@@ -405,7 +420,7 @@ class OpticalFlowCLGNonlinearFunctor
 			//			    I_y =>  b_y = smooth<I_y * I_t>
 			gradX = gradT*gradX;
 			gradY = gradT*gradY;
-			vigra::gaussianSmoothing(gradY, gradX,	m_outer_sigma);
+			vigra::gaussianSmoothing(gradX, gradX,	m_outer_sigma);
 			vigra::gaussianSmoothing(gradY, gradY,	m_outer_sigma);
 			
 			int max_iter = m_iterations;
@@ -529,8 +544,10 @@ class OpticalFlowCLGNonlinearFunctor
 			//			    I_y =>  b_y = smooth<I_y * I_t>
 			gradX = gradT*gradX;
 			gradY = gradT*gradY;
-			gaussianSmoothingWithMask(gradY, mask, gradX,	m_outer_sigma);
-			gaussianSmoothingWithMask(gradY, mask, gradY,	m_outer_sigma);
+			temp = gradX;
+			gaussianSmoothingWithMask(temp, mask, gradX,	m_outer_sigma);
+			temp = gradY;
+			gaussianSmoothingWithMask(temp, mask, gradY,	m_outer_sigma);
 			
 			int max_iter = m_iterations;
 			double	omega = m_omega,
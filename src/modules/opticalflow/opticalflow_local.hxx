@@ -41,6 +41,7 @@
 
 //OFCE Spatiotemporal Gradients
 #include "opticalflowgradients.hxx"
+#include "images/pooledarray.hxx"
 
 //Image interpolation using splines
 #include <vigra/splineimageview.hxx>
@@ -101,7 +102,8 @@ class OpticalFlowLKFunctor
 			m_mask_size(mask_size),
 			m_threshold(threshold),
 			m_iterations(iterations),
-			m_level(0.0)
+			m_level(0.0),
+			m_derivatives(sigma)
 		{
         }
 
@@ -155,16 +157,14 @@ class OpticalFlowLKFunctor
             
             using namespace ::vigra;
             
-			vigra::MultiArray<2, ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
+			PooledArray<2,ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
                                             gradX2(src1.shape()), gradY2(src1.shape()),
                                             gradT1(src1.shape()), gradT2(src1.shape());
 			
 			
-			vigra::gaussianGradient(src1, gradX1, gradY1, m_sigma);
-			vigra::gaussianGradient(src2, gradX2, gradY2, m_sigma);
-			
-			vigra::gaussianSmoothing(src1, gradT1, m_sigma);
-			vigra::gaussianSmoothing(src2, gradT2, m_sigma);
+			//Smoothing and gradient of each image by one fused pass
+			m_derivatives.derivatives(src1, gradT1, gradX1, gradY1);
+			m_derivatives.derivatives(src2, gradT2, gradX2, gradY2);
 			
 			vigra::SplineImageView<1,ValueType> gradX2_s(gradX2), gradY2_s(gradY2), gradT2_s(gradT2);
 			
@@ -264,16 +264,16 @@ class OpticalFlowLKFunctor
             
             using namespace ::vigra;
             
-			vigra::MultiArray<2, ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
+			PooledArray<2,ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
                                             gradX2(src1.shape()), gradY2(src1.shape()),
                                             gradT1(src1.shape()), gradT2(src1.shape());
 			
 			
-			gaussianGradientWithMask(src1, mask, gradX1, gradY1, m_sigma);
-			gaussianGradientWithMask(src2, mask, gradX2, gradY2, m_sigma);
+			m_derivatives.gradientWithMask(src1, mask, gradX1, gradY1);
+			m_derivatives.gradientWithMask(src2, mask, gradX2, gradY2);
 			
-			gaussianSmoothingWithMask(src1, mask, gradT1, m_sigma);
-			gaussianSmoothingWithMask(src2, mask, gradT2, m_sigma);
+			m_derivatives.smoothingWithMask(src1, mask, gradT1);
+			m_derivatives.smoothingWithMask(src2, mask, gradT2);
 			
 			vigra::SplineImageView<1,ValueType> gradX2_s(gradX2), gradY2_s(gradY2), gradT2_s(gradT2);
 			
@@ -363,6 +363,9 @@ class OpticalFlowLKFunctor
 		unsigned int	m_iterations;
 		
 		unsigned int	m_level;
+		
+		//Reused derivative estimator (kernels and scratch memory)
+		GaussianDerivativeEngine<ValueType> m_derivatives;
 };
 
 
@@ -396,7 +399,8 @@ class OpticalFlowSTFunctor
 			m_mask_size(mask_size),
 			m_threshold(threshold),
 			m_iterations(iterations),
-			m_level(0.0)
+			m_level(0.0),
+			m_derivatives(sigma)
 		{
         }
     
@@ -449,16 +453,14 @@ class OpticalFlowSTFunctor
             
             using namespace ::vigra;
             
-			vigra::MultiArray<2, ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
+			PooledArray<2,ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
                                             gradX2(src1.shape()), gradY2(src1.shape()),
                                             gradT1(src1.shape()), gradT2(src1.shape());
 			
 			
-			vigra::gaussianGradient(src1, gradX1, gradY1, m_sigma);
-			vigra::gaussianGradient(src2, gradX2, gradY2, m_sigma);
-			
-			vigra::gaussianSmoothing(src1, gradT1, m_sigma);
-			vigra::gaussianSmoothing(src2, gradT2, m_sigma);
+			//Smoothing and gradient of each image by one fused pass
+			m_derivatives.derivatives(src1, gradT1, gradX1, gradY1);
+			m_derivatives.derivatives(src2, gradT2, gradX2, gradY2);
 			
 			vigra::SplineImageView<1,ValueType> gradX2_s(gradX2), gradY2_s(gradY2), gradT2_s(gradT2);
 			
@@ -563,16 +565,16 @@ class OpticalFlowSTFunctor
             
             using namespace ::vigra;
             
-			vigra::MultiArray<2, ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
+			PooledArray<2,ValueType>	gradX1(src1.shape()), gradY1(src1.shape()),
                                             gradX2(src1.shape()), gradY2(src1.shape()),
                                             gradT1(src1.shape()), gradT2(src1.shape());
 			
 			
-			gaussianGradientWithMask(src1, mask, gradX1, gradY1, m_sigma);
-			gaussianGradientWithMask(src2, mask, gradX2, gradY2, m_sigma);
+			m_derivatives.gradientWithMask(src1, mask, gradX1, gradY1);
+			m_derivatives.gradientWithMask(src2, mask, gradX2, gradY2);
 			
-			gaussianSmoothingWithMask(src1, mask, gradT1, m_sigma);
-			gaussianSmoothingWithMask(src2, mask, gradT2, m_sigma);
+			m_derivatives.smoothingWithMask(src1, mask, gradT1);
+			m_derivatives.smoothingWithMask(src2, mask, gradT2);
 			
 			vigra::SplineImageView<1,ValueType> gradX2_s(gradX2), gradY2_s(gradY2), gradT2_s(gradT2);
 			
@@ -669,6 +671,9 @@ class OpticalFlowSTFunctor
 		unsigned int	m_iterations;
 		
 		unsigned int	m_level;
+		
+		//Reused derivative estimator (kernels and scratch memory)
+		GaussianDerivativeEngine<ValueType> m_derivatives;
 };
 
 
@@ -698,7 +703,8 @@ class OpticalFlowCCFunctor
 		:	m_sigma(sigma),
 			m_threshold(threshold),
 			m_iterations(iterations),
-			m_level(0.0)
+			m_level(0.0),
+			m_derivatives(sigma)
 		{
         }
     
@@ -750,23 +756,18 @@ class OpticalFlowCCFunctor
             vigra_precondition(src1.shape() == flow.shape(), "flow array sizes differ from image sizes!");
             
             
-			vigra::MultiArray<2, ValueType>	gradXX1(src1.shape()), gradXX2(src1.shape()),
+			PooledArray<2,ValueType>	gradXX1(src1.shape()), gradXX2(src1.shape()),
                                             gradXY1(src1.shape()), gradXY2(src1.shape()),
                                             gradYY1(src1.shape()), gradYY2(src1.shape()),
                                             gradX1(src1.shape()),  gradX2(src1.shape()),
                                             gradY1(src1.shape()),  gradY2(src1.shape());
 			
 			
-			// First image: First order derivatives
-			vigra::gaussianGradient(src1, gradX1, gradY1, m_sigma);
-			// First image: Second order derivatives from hessian (matrix) of gaussian
-			vigra::hessianMatrixOfGaussian(src1, gradXX1, gradXY1, gradYY1, m_sigma);
+			// First image: First and second order derivatives by one fused pass
+			m_derivatives.gradientAndHessian(src1, gradX1, gradY1, gradXX1, gradXY1, gradYY1);
 			
-			// Second image: First order derivatives
-			vigra::gaussianGradient(src2, gradX2, gradY2, m_sigma);
-            
-			// Second image: Second order derivatives from hessian (matrix) of gaussian
-			vigra::hessianMatrixOfGaussian(src2, gradXX2, gradXY2, gradYY2, m_sigma);
+			// Second image: First and second order derivatives by one fused pass
+			m_derivatives.gradientAndHessian(src2, gradX2, gradY2, gradXX2, gradXY2, gradYY2);
 			
 			vigra::SplineImageView<1,ValueType> gradX2_s(gradX2), gradY2_s(gradY2),
                                                 gradXX2_s(gradXX2), gradXY2_s(gradXY2), gradYY2_s(gradYY2);
@@ -831,25 +832,20 @@ class OpticalFlowCCFunctor
             vigra_precondition(src1.shape() == flow.shape(), "flow array sizes differ from image sizes!");
             
             
-			vigra::MultiArray<2, T3>	gradXX1(src1.shape()), gradXX2(src1.shape()),
+			PooledArray<2,ValueType>	gradXX1(src1.shape()), gradXX2(src1.shape()),
 										gradXY1(src1.shape()), gradXY2(src1.shape()),
 										gradYY1(src1.shape()), gradYY2(src1.shape()),
 										gradX1(src1.shape()),  gradX2(src1.shape()),
 										gradY1(src1.shape()),  gradY2(src1.shape());
 			
 			
-			// First image: First order derivatives
-			gaussianGradientWithMask(src1, mask, gradX1, gradY1, m_sigma);
-			// First image: Second order derivatives from hessian (matrix) of gaussian
-			hessianMatrixOfGaussianWithMask(src1, mask, gradXX1, gradXY1, gradYY1, m_sigma);
+			// First image: First and second order derivatives (the latter derived from the former)
+			m_derivatives.gradientAndHessianWithMask(src1, mask, gradX1, gradY1, gradXX1, gradXY1, gradYY1);
 			
-			// Second image: First order derivatives
-			gaussianGradientWithMask(src2, mask, gradX2, gradY2, m_sigma);
-            
-			// Second image: Second order derivatives from hessian (matrix) of gaussian
-			hessianMatrixOfGaussianWithMask(src2, mask, gradXX2, gradXY2, gradYY2, m_sigma);
+			// Second image: First and second order derivatives (the latter derived from the former)
+			m_derivatives.gradientAndHessianWithMask(src2, mask, gradX2, gradY2, gradXX2, gradXY2, gradYY2);
 			
-			vigra::SplineImageView<1,T3> gradX2_s(gradX2), gradY2_s(gradY2),
+			vigra::SplineImageView<1,ValueType> gradX2_s(gradX2), gradY2_s(gradY2),
                                          gradXX2_s(gradXX2), gradXY2_s(gradXY2), gradYY2_s(gradYY2);
 			
 			//Matrix A, vecor b and eigenvectors resp. eigenvalues
@@ -902,6 +898,9 @@ class OpticalFlowCCFunctor
 		unsigned int	m_iterations;
 	
 		unsigned int	m_level;
+		
+		//Reused derivative estimator (kernels and scratch memory)
+		GaussianDerivativeEngine<ValueType> m_derivatives;
 };
 
 
@@ -165,6 +165,10 @@ class OpticalFlowAlgorithm
             m_param_saveIntermediateImages	= new BoolParameter("save intermediate (warped) images", false, m_param_useHierarchy);
             m_param_saveIntermediateFlow	= new BoolParameter("save intermediate flow fields", false, m_param_useHierarchy);
             
+            m_param_useSequence     = new BoolParameter("process an image sequence (hierarchical warping)");
+            m_param_sequence        = new MultiModelParameter("further images of the sequence (band of the second image is used)", "Image", m_param_useSequence, false, m_workspace);
+            m_param_warmStart       = new BoolParameter("use the previous flow as initial flow", true, m_param_useSequence);
+            
             m_parameters->addParameter("use_gme?", m_param_useGME);
             m_parameters->addParameter("use_hierarchy?", m_param_useHierarchy );
             m_parameters->addParameter("lowL", m_param_lowestLevel );
@@ -174,6 +178,9 @@ class OpticalFlowAlgorithm
             m_parameters->addParameter("warp_sigma", m_param_warp_sigma );
             m_parameters->addParameter("save-intermI", m_param_saveIntermediateImages );
             m_parameters->addParameter("save-intermVF", m_param_saveIntermediateFlow );
+            m_parameters->addParameter("use_sequence?", m_param_useSequence );
+            m_parameters->addParameter("sequence", m_param_sequence );
+            m_parameters->addParameter("warm_start?", m_param_warmStart );
         }	
         
         /**
@@ -190,6 +197,11 @@ class OpticalFlowAlgorithm
             
             vigra_assert(FlowValueType().size() > 1, "flow functor needs to return a vectorfield of at least (u,v) components");
             
+            if(m_param_useSequence->value())
+            {
+                computeSequenceFlow(func);
+                return;
+            }
             
             vigra::MultiArrayView<2,float> imageband1 = m_param_imageBand1->value();
             vigra::MultiArrayView<2,float> imageband2 = m_param_imageBand2->value();
@@ -305,6 +317,99 @@ class OpticalFlowAlgorithm
                 
             }	
             
+            addFlowResults<OpticalFlowFunctor>(img_list, flow_list, mat_list,
+                                               m_param_imageBand1->image(), m_param_imageBand1->toString(),
+                                               m_param_imageBand2->image(), m_param_imageBand2->toString());
+        }
+    
+        /**
+         * The sequence mode of the flow computation. The sequence consists of the
+         * reference image, the second image and all further images. For the further 
+         * images, the band of the second image is used. The flow between each pair
+         * of consecutive images is computed by means of the hierarchical warping, 
+         * where the pyramid of each image is built only once.
+         *
+         * \param func The Optical Flow Functor, which will carry out each step's 
+         *             flow estimation.
+         */
+        template<class OpticalFlowFunctor>
+        void computeSequenceFlow(OpticalFlowFunctor func)
+        {
+            typedef typename OpticalFlowFunctor::FlowValueType FlowValueType;
+            
+            std::vector<Image<float>*> images;
+            std::vector<QString> names;
+            std::vector<vigra::MultiArrayView<2,float> > frames;
+            
+            images.push_back(m_param_imageBand1->image());
+            names.push_back(m_param_imageBand1->toString());
+            frames.push_back(m_param_imageBand1->value());
+            
+            images.push_back(m_param_imageBand2->image());
+            names.push_back(m_param_imageBand2->toString());
+            frames.push_back(m_param_imageBand2->value());
+            
+            unsigned int band_id = m_param_imageBand2->bandId();
+            
+            for(Model* model : m_param_sequence->value())
+            {
+                Image<float>* image = static_cast<Image<float>*>(model);
+                
+                vigra_precondition(band_id < image->numBands(), "an image of the sequence has too few bands!");
+                
+                images.push_back(image);
+                names.push_back(QString("%1 (band %2)").arg(image->name()).arg(band_id));
+                frames.push_back(image->band(band_id));
+            }
+            
+            //Mask
+            vigra::MultiArrayView<2,float> mask = m_param_mask->value();
+            
+            //The sequence mode always warps, the initialiser mode uses the smallest subsampling
+            WarpTPSFunctor warp_func;
+            unsigned int warp_subsampling = 5*std::max(1, m_param_pmode->value());
+            
+            calculateOFCESequenceHierarchicallyWarping(frames,
+                                                       m_param_useMask->value() ? &mask : NULL,
+                                                       func,
+                                                       m_param_useGME->value(),
+                                                       m_param_highestLevel->value(), m_param_lowestLevel->value(), m_param_hmode->value(),
+                                                       warp_func, warp_subsampling, m_param_warp_sigma->value(),
+                                                       m_param_warmStart->value(),
+                                                       [&](unsigned int pair,
+                                                           const std::vector<vigra::MultiArray<2,float> >& img_list,
+                                                           const std::vector<vigra::MultiArray<2,FlowValueType> >& flow_list,
+                                                           const std::vector<vigra::Matrix<double> >& mat_list)
+                                                       {
+                                                           addFlowResults<OpticalFlowFunctor>(img_list, flow_list, mat_list,
+                                                                                              images[pair], names[pair],
+                                                                                              images[pair+1], names[pair+1]);
+                                                           
+                                                           emit statusMessage(1.0 + (pair+1)*98.0/(frames.size()-1), QString("computed flow of image pair %1").arg(pair+1));
+                                                       });
+        }
+    
+        /**
+         * Creates the resulting vectorfields (and warped images) of one flow computation
+         * and adds them to the results of this algorithm.
+         *
+         * \param img_list The (warped) image pyramid of the first image.
+         * \param flow_list The resulting Optical Flow fields of each level.
+         * \param mat_list The global motion estimation matrices of each level.
+         * \param image1 The first image.
+         * \param name1 The name of the first image (band).
+         * \param image2 The second image.
+         * \param name2 The name of the second image (band).
+         */
+        template<class OpticalFlowFunctor>
+        void addFlowResults(const std::vector<vigra::MultiArray<2,float> >& img_list,
+                            const std::vector<vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> >& flow_list,
+                            const std::vector<vigra::Matrix<double> >& mat_list,
+                            Image<float>* image1, const QString& name1,
+                            Image<float>* image2, const QString& name2)
+        {
+            typedef typename OpticalFlowFunctor::FlowValueType FlowValueType;
+            
             for (unsigned int i=0; i< flow_list.size(); ++i)
             {
                 //Save pyramid of vectorfields on demand
@@ -327,11 +432,11 @@ class OpticalFlowAlgorithm
                     
                     if( i != 0)
                     {
-                        new_vectorfield->setName(QString("%1 (L%2) of %3 and %4").arg(functor_sname).arg(i).arg(m_param_imageBand1->toString()).arg(m_param_imageBand2->toString()));
+                        new_vectorfield->setName(QString("%1 (L%2) of %3 and %4").arg(functor_sname).arg(i).arg(name1).arg(name2));
                     }
                     else
                     {
-                        new_vectorfield->setName(QString("%1 of %2 and %3").arg(functor_sname).arg(m_param_imageBand1->toString()).arg(m_param_imageBand2->toString()));
+                        new_vectorfield->setName(QString("%1 of %2 and %3").arg(functor_sname).arg(name1).arg(name2));
                     }
                     new_vectorfield->setGlobalMotion(QTransform(mat_list[i](0,0), mat_list[i](1,0), mat_list[i](2,0),
                                                                 mat_list[i](0,1), mat_list[i](1,1), mat_list[i](2,1),
@@ -341,11 +446,11 @@ class OpticalFlowAlgorithm
                     qDebug() << "Inverted GME for VF:" << new_vectorfield->globalMotion().inverted();
                     
                     //Get time diff
-                    unsigned int seconds = (unsigned int)m_param_imageBand1->image()->timestamp().secsTo(m_param_imageBand2->image()->timestamp());
+                    unsigned int seconds = (unsigned int)image1->timestamp().secsTo(image2->timestamp());
                     
                     if(seconds != 0)
                     {
-                        new_vectorfield->setScale(m_param_imageBand1->image()->scale()*100.0/seconds * (m_param_imageBand1->image()->width()/flow_list[0].width()));
+                        new_vectorfield->setScale(image1->scale()*100.0/seconds * (image1->width()/flow_list[0].width()));
                     }
                     
                     QString descr = QString("The following parameters were used to calculate the %1\n").arg(functor_name);
@@ -359,17 +464,17 @@ class OpticalFlowAlgorithm
                     m_results.push_back(new_vectorfield);
                 }
                 //Also save warped images on demand
-                if(m_param_pmode->value() !=0 && i!=0 && m_param_saveIntermediateImages->value()) 
+                if(i!=0 && i<img_list.size() && m_param_saveIntermediateImages->value()) 
                 {
                     Image<float>* new_image = new Image<float>(img_list[i].shape(), 1, m_workspace);
                     new_image->setBand(0,img_list[i]);
                     
-                    m_param_imageBand1->image()->copyMetadata(*new_image);
+                    image1->copyMetadata(*new_image);
                     
-                    new_image->setName(QString("Warped Image (L%1) of %2").arg(i).arg(m_param_imageBand1->toString()));
+                    new_image->setName(QString("Warped Image (L%1) of %2").arg(i).arg(name1));
                     new_image->setDescription(QString(  "The following parameters were used to calculate the warping:\n"
                                                         "TPS Functor\n"
-                                                        "Subsampled each %1 pixel").arg(5*m_param_pmode->value()));
+                                                        "Subsampled each %1 pixel").arg(5*std::max(1, m_param_pmode->value())));
                     m_results.push_back(new_image);
                 }
             }
@@ -400,6 +505,10 @@ class OpticalFlowAlgorithm
         
         BoolParameter	* m_param_saveIntermediateImages;
         BoolParameter	* m_param_saveIntermediateFlow;
+        
+        BoolParameter       * m_param_useSequence;
+        MultiModelParameter * m_param_sequence;
+        BoolParameter       * m_param_warmStart;
         /**
          * @}
          */
@@ -50,6 +50,10 @@
 #include <vigra/stdconvolution.hxx>
 #include <vigra/affine_registration_fft.hxx>
 
+//background construction of pyramids for sequences
+#include <QRunnable>
+#include <QThreadPool>
+
 namespace graipe {
 
 /**
@@ -518,99 +522,180 @@ void calculateOFCEHierarchicallyInitialiser(const vigra::MultiArrayView<2,T1> &
 
 
 /**
- * The third hierarchical Optical Flow estimation approach:
- *  
- *  a) Detect flow at level n
- *  b) use that (probably scaled) flow to warp the img_list image of next level.
- *  c) save the flow at this level
- *  d) proceed with zero assumption flow at next level (n+1)
- *  e) ...
- *  f) at the end: Add all motion increments to obtain complete flow
+ * Builds the gaussian pyramid of an image by means of repeated calls
+ * of reduceToNextLevel().
  *
- * For each (a) the functor is called without a mask, but if selected with global motion estimation.
+ * \param[in] src The image.
+ * \param[in] steps The count of reduced levels.
+ * \param[out] pyramid The pyramid. Will contain steps+1 levels, where level 0 is a copy of src.
+ */
+template <class T1, class T2>
+void buildGaussianPyramid(const vigra::MultiArrayView<2,T1> & src,
+                          unsigned int steps,
+                          std::vector<vigra::MultiArray<2,T2> >& pyramid)
+{
+    pyramid.resize(steps+1);
+    pyramid[0] = src;
+    
+    for (unsigned int level=1; level<=steps; ++level)
+	{
+		reduceToNextLevel(pyramid[level-1], pyramid[level]);
+	}
+}
+
+/**
+ * A task, which builds the gaussian pyramid of an image. This is used
+ * to prepare the pyramid of the next frame of a sequence while the flow
+ * of the current frames is computed.
+ */
+template <class T>
+class GaussianPyramidTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param[in] src The image.
+         * \param[in] steps The count of reduced levels.
+         * \param[out] pyramid The pyramid, which will be filled by run().
+         */
+        GaussianPyramidTask(const vigra::MultiArrayView<2,T> & src,
+                            unsigned int steps,
+                            std::vector<vigra::MultiArray<2,T> >& pyramid)
+        :   m_src(src),
+            m_steps(steps),
+            m_pyramid(pyramid)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Builds the pyramid.
+         */
+        void run()
+        {
+            buildGaussianPyramid(m_src, m_steps, m_pyramid);
+        }
+    
+    protected:
+        /** The image **/
+        vigra::MultiArrayView<2,T> m_src;
+        /** The count of reduced levels **/
+        unsigned int m_steps;
+        /** The pyramid **/
+        std::vector<vigra::MultiArray<2,T> >& m_pyramid;
+};
+
+/**
+ * Prepares the result lists of the hierarchical Optical Flow estimation for
+ * a given image pyramid: One zero flow field, one identity matrix and two
+ * correlations per level.
  *
- * \param[in] src1 First image of the series.
- * \param[in] src2 Second image of the series.
- * \param[out] img_list The resulting warped images during the steps.
- * \param[out] flow_list The resulting Optical Flow fields during the steps.
+ * \param[in] img_list The image pyramid.
+ * \param[out] flow_list The Optical Flow fields of each level.
+ * \param[out] mat_list The global motion estimation matrices of each level.
+ * \param[out] rotation_correlation_list The rotation correlations of each level.
+ * \param[out] translation_correlation_list The translation correlations of each level.
+ */
+template <class T, class FlowValueType, class MatrixType>
+void prepareOFCEPyramidLists(const std::vector<vigra::MultiArray<2,T> >& img_list,
+                             std::vector<vigra::MultiArray<2,FlowValueType> >& flow_list,
+                             std::vector<MatrixType>& mat_list,
+                             std::vector<double>& rotation_correlation_list,
+                             std::vector<double>& translation_correlation_list)
+{
+    flow_list.resize(img_list.size());
+    mat_list.resize(img_list.size(), MatrixType(3,3));
+    rotation_correlation_list.resize(img_list.size(), 0);
+    translation_correlation_list.resize(img_list.size(), 0);
+    
+    for (unsigned int level=0; level<img_list.size(); ++level)
+	{
+        //reshape also resets the flow to zero
+        flow_list[level].reshape(img_list[level].shape());
+    }
+}
+
+/**
+ * The common part of both hierarchical warping approaches below. It works on
+ * already built image pyramids and prepared result lists, so that the pyramids
+ * may be reused, e.g. for the frames of a sequence. The flow, which is stored
+ * at the first level of the step list, is used as initial flow.
+ *
+ * \param[in,out] img_list The pyramid of the first image. Will be warped during the steps.
+ * \param[in] img2_list The pyramid of the second image.
+ * \param[in] mask_list The pyramid of the mask or NULL, if no mask shall be used.
+ * \param[in,out] flow_list The Optical Flow fields during the steps.
  * \param[in] flow_func The used functor to compute the Optical Flow.
  * \param[in] use_gme If true, the global motion estimation be used prior to each computation.
  * \param[out] mat_list If use_global is true, this contains the global motion estimation matrices (rot+trans).
  * \param[out] rotation_correlation_list If use_global is true, this contains the rotation correlations.
  * \param[out] translation_correlation_list If use_global is true, this contains the transflation correlations.
- * \param[in] steps Step count.
+ * \param[in] step_list The layers in the traversal order, see buildStepList().
  * \param[in] break_level On wich level shall we finish/break the traversal.
- * \param[in] hmode The hierarchical traversal mode: (0: V, 1: Single W, 2: Full W)
  * \param[in] warp The functor, which is used for warping
  * \param[in] warp_subsampling The subsampling, wich is used for warping
  * \param[in] warp_sigma The sigma, which is used for smoothing the result before subsampling.
  */
-template <class T1, class T2, class MatrixType, class OpticalFlowFunctor, class WarpingFunctor>
-void calculateOFCEHierarchicallyWarping(const vigra::MultiArrayView<2,T1> & src1, 
-										const vigra::MultiArrayView<2,T2> & src2, 
-										std::vector<vigra::MultiArray<2, T1> >& img_list,
-                                        std::vector<vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> >& flow_list,
-										OpticalFlowFunctor flow_func,
-										bool use_gme, 
-                                        std::vector<MatrixType>& mat_list,
-                                        std::vector<double>& rotation_correlation_list,
-                                        std::vector<double>& translation_correlation_list,
-										unsigned int steps,  
-										unsigned int break_level, 
-										unsigned int hmode,
-										WarpingFunctor warp,
-										unsigned int warp_subsampling,
-										float warp_sigma)
+template <class T1, class T2, class T3, class MatrixType, class OpticalFlowFunctor, class WarpingFunctor>
+void calculateOFCEWarpingOnPyramids(std::vector<vigra::MultiArray<2,T1> >& img_list,
+                                    const std::vector<vigra::MultiArray<2,T2> >& img2_list,
+                                    const std::vector<vigra::MultiArray<2,T3> >* mask_list,
+                                    std::vector<vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> >& flow_list,
+                                    OpticalFlowFunctor flow_func,
+                                    bool use_gme,
+                                    std::vector<MatrixType>& mat_list,
+                                    std::vector<double>& rotation_correlation_list,
+                                    std::vector<double>& translation_correlation_list,
+                                    const std::list<unsigned int>& step_list,
+                                    unsigned int break_level,
+                                    WarpingFunctor warp,
+                                    unsigned int warp_subsampling,
+                                    float warp_sigma)
 {
-    vigra_precondition(src1.shape() == src2.shape() ,"image sizes differ!");
-    
     using namespace ::vigra::multi_math;
     
-	steps = std::min((double)steps, log((double)std::min(src1.width(), src1.height()))/log(2.0)-3);
-	std::list<unsigned int> step_list = buildStepList(steps, break_level, hmode);
-	
-    //create gaussian pyramid hierarchy bottom->up
-	img_list.resize(steps+1);
-    std::vector<vigra::MultiArray<2,T2> >	img2_list(steps+1);
-    
-	vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> flow_res(src1.shape()), temp_res(src1.shape());
-	
-	qDebug() << "Building gaussian pyramid for both images with " << steps << " levels";
-	
-	img_list[0]  = src1;
-	img2_list[0] = src2;
-	
-	for (unsigned int level=1; level<=steps; ++level)
-	{
-		reduceToNextLevel(img_list[level-1], img_list[level]);
-		reduceToNextLevel(img2_list[level-1], img2_list[level]);
-		
-		flow_list.push_back(vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType>(img_list[level].shape()));
-		mat_list.push_back(MatrixType(3,3));
-		
-	}
+	vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> flow_res(img_list[0].shape()), temp_res(img_list[0].shape());
 	
 	//work on that hierarchy	
-	for (std::list<unsigned int>::iterator iter = step_list.begin(); iter != step_list.end(); ++iter)
+	for (std::list<unsigned int>::const_iterator iter = step_list.begin(); iter != step_list.end(); ++iter)
 	{
-		std::list<unsigned int>::iterator next_iter = iter; next_iter++;
+		std::list<unsigned int>::const_iterator next_iter = iter; next_iter++;
 		unsigned int s = *iter;
-		unsigned int next_s = *next_iter;
 		
 		qDebug() << "Running OFCE on level " << s;
 		
 		flow_func.setLevel(s);
 		
-		calculateOFCE(img_list[s], img2_list[s],
-                      flow_list[s],
-					  flow_func, 
-					  use_gme,
-                      mat_list[s],
-                      rotation_correlation_list[s],
-                      translation_correlation_list[s]);
+        if(mask_list != NULL)
+        {
+            calculateOFCE(img_list[s],
+                          img2_list[s],
+                          (*mask_list)[s],
+                          flow_list[s],
+                          flow_func,
+                          use_gme,
+                          mat_list[s],
+                          rotation_correlation_list[s],
+                          translation_correlation_list[s]);
+        }
+        else
+        {
+            calculateOFCE(img_list[s],
+                          img2_list[s],
+                          flow_list[s],
+                          flow_func,
+                          use_gme,
+                          mat_list[s],
+                          rotation_correlation_list[s],
+                          translation_correlation_list[s]);
+        }
         
 		if(next_iter != step_list.end() )
 		{
+            unsigned int next_s = *next_iter;
+            
 			//rescale vector length
             double rescale_factor = pow(2.0, double(s));
             
@@ -625,7 +710,7 @@ void calculateOFCEHierarchicallyWarping(const vigra::MultiArrayView<2,T1> & src1
 			vigra::resizeImageLinearInterpolation(flow_list[s], flow_list[next_s]);
 			
 			//rescale vector length
-            rescale_factor = pow(2.0, double(s-next_s));
+            rescale_factor = pow(2.0, double(s)-double(next_s));
             flow_list[next_s].bindElementChannel(0) *= rescale_factor;
             flow_list[next_s].bindElementChannel(1) *= rescale_factor;
 			
@@ -666,6 +751,73 @@ void calculateOFCEHierarchicallyWarping(const vigra::MultiArrayView<2,T1> & src1
 	flow_list[0] = flow_res;
 }
 
+/**
+ * The third hierarchical Optical Flow estimation approach:
+ *  
+ *  a) Detect flow at level n
+ *  b) use that (probably scaled) flow to warp the img_list image of next level.
+ *  c) save the flow at this level
+ *  d) proceed with zero assumption flow at next level (n+1)
+ *  e) ...
+ *  f) at the end: Add all motion increments to obtain complete flow
+ *
+ * For each (a) the functor is called without a mask, but if selected with global motion estimation.
+ *
+ * \param[in] src1 First image of the series.
+ * \param[in] src2 Second image of the series.
+ * \param[out] img_list The resulting warped images during the steps.
+ * \param[out] flow_list The resulting Optical Flow fields during the steps.
+ * \param[in] flow_func The used functor to compute the Optical Flow.
+ * \param[in] use_gme If true, the global motion estimation be used prior to each computation.
+ * \param[out] mat_list If use_global is true, this contains the global motion estimation matrices (rot+trans).
+ * \param[out] rotation_correlation_list If use_global is true, this contains the rotation correlations.
+ * \param[out] translation_correlation_list If use_global is true, this contains the transflation correlations.
+ * \param[in] steps Step count.
+ * \param[in] break_level On wich level shall we finish/break the traversal.
+ * \param[in] hmode The hierarchical traversal mode: (0: V, 1: Single W, 2: Full W)
+ * \param[in] warp The functor, which is used for warping
+ * \param[in] warp_subsampling The subsampling, wich is used for warping
+ * \param[in] warp_sigma The sigma, which is used for smoothing the result before subsampling.
+ */
+template <class T1, class T2, class MatrixType, class OpticalFlowFunctor, class WarpingFunctor>
+void calculateOFCEHierarchicallyWarping(const vigra::MultiArrayView<2,T1> & src1, 
+										const vigra::MultiArrayView<2,T2> & src2, 
+										std::vector<vigra::MultiArray<2, T1> >& img_list,
+                                        std::vector<vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> >& flow_list,
+										OpticalFlowFunctor flow_func,
+										bool use_gme, 
+                                        std::vector<MatrixType>& mat_list,
+                                        std::vector<double>& rotation_correlation_list,
+                                        std::vector<double>& translation_correlation_list,
+										unsigned int steps,  
+										unsigned int break_level, 
+										unsigned int hmode,
+										WarpingFunctor warp,
+										unsigned int warp_subsampling,
+										float warp_sigma)
+{
+    vigra_precondition(src1.shape() == src2.shape() ,"image sizes differ!");
+    
+	steps = std::min((double)steps, log((double)std::min(src1.width(), src1.height()))/log(2.0)-3);
+	std::list<unsigned int> step_list = buildStepList(steps, break_level, hmode);
+	
+    //create gaussian pyramid hierarchy bottom->up
+    std::vector<vigra::MultiArray<2,T2> >	img2_list;
+	
+	qDebug() << "Building gaussian pyramid for both images with " << steps << " levels";
+	
+    buildGaussianPyramid(src1, steps, img_list);
+    buildGaussianPyramid(src2, steps, img2_list);
+	
+    prepareOFCEPyramidLists(img_list, flow_list, mat_list, rotation_correlation_list, translation_correlation_list);
+    
+    calculateOFCEWarpingOnPyramids(img_list, img2_list, (const std::vector<vigra::MultiArray<2,float> >*)NULL,
+                                   flow_list, flow_func,
+                                   use_gme, mat_list, rotation_correlation_list, translation_correlation_list,
+                                   step_list, break_level,
+                                   warp, warp_subsampling, warp_sigma);
+}
+
 /**
  * The fourth hierarchical Optical Flow estimation approach:
  *  a) Detect flow at level n
@@ -715,113 +867,171 @@ void calculateOFCEHierarchicallyWarping(const vigra::MultiArrayView<2,T1> & src1
     vigra_precondition(src1.shape() == src2.shape() ,"image sizes differ!");
     vigra_precondition(src1.shape() == mask.shape() ,"image and mask sizes differ!");
     
-    using namespace ::vigra::multi_math;
-    
 	steps = std::min((double)steps, log((double)std::min(src1.width(), src1.height()))/log(2.0)-3);
 	std::list<unsigned int> step_list = buildStepList(steps, break_level, hmode);
 	
     //create gaussian pyramid hierarchy bottom->up
-	img_list.resize(steps+1);
-	std::vector<vigra::MultiArray<2,T2> >	img2_list(steps+1);
-	std::vector<vigra::MultiArray<2,T3> >	mask_list(steps+1);
-	
-	vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType> flow_res(src1.shape()), temp_res(src1.shape());
+	std::vector<vigra::MultiArray<2,T2> >	img2_list;
+	std::vector<vigra::MultiArray<2,T3> >	mask_list;
 	
 	qDebug() << "Building gaussian pyramid for both images with " << steps << " levels";
 	
-	img_list[0] = src1;
-	img2_list[0] = src2;
-	mask_list[0] = mask;
+    buildGaussianPyramid(src1, steps, img_list);
+    buildGaussianPyramid(src2, steps, img2_list);
+    buildGaussianPyramid(mask, steps, mask_list);
 	
-	for (unsigned int level=1; level<=steps; ++level)
-	{
-		reduceToNextLevel(img_list[level-1], img_list[level]);
-		reduceToNextLevel(img2_list[level-1], img2_list[level]);
-		reduceToNextLevel(mask_list[level-1], mask_list[level]);
-		
-		flow_list.push_back(vigra::MultiArray<2,typename OpticalFlowFunctor::FlowValueType>(img_list[level].shape()));
-		mat_list.push_back(MatrixType(3,3));
-		
-	}
+    prepareOFCEPyramidLists(img_list, flow_list, mat_list, rotation_correlation_list, translation_correlation_list);
+    
+    calculateOFCEWarpingOnPyramids(img_list, img2_list, &mask_list,
+                                   flow_list, flow_func,
+                                   use_gme, mat_list, rotation_correlation_list, translation_correlation_list,
+                                   step_list, break_level,
+                                   warp, warp_subsampling, warp_sigma);
+}
+
+/**
+ * The sequence mode of the hierarchical warping approach: Computes the Optical
+ * Flow between each pair of consecutive frames of an image sequence.
+ *
+ * The gaussian pyramid of each frame is built only once and kept in a sliding
+ * window of the current and the next frame. The pyramid of the frame after next
+ * is built in the background, while the flow of the current pair is computed.
+ * If selected, the flow of the previous pair is used as the initial flow
+ * (warm start) at the first level of the step list. This is not done if global
+ * motion estimation is used, since the flow is then computed relative to the
+ * global motion.
+ *
+ * After each pair, the visitor is called by means of:
+ *      visitor(pair_index, img_list, flow_list, mat_list)
+ * where pair_index is the index of the first frame of the pair and the lists
+ * are the same as for calculateOFCEHierarchicallyWarping().
+ *
+ * \param[in] frames The frames of the sequence.
+ * \param[in] mask The mask, where pixel values are assumed to be valid or NULL, if no mask shall be used.
+ * \param[in] flow_func The used functor to compute the Optical Flow.
+ * \param[in] use_gme If true, the global motion estimation be used prior to each computation.
+ * \param[in] steps Step count.
+ * \param[in] break_level On wich level shall we finish/break the traversal.
+ * \param[in] hmode The hierarchical traversal mode: (0: V, 1: Single W, 2: Full W)
+ * \param[in] warp The functor, which is used for warping
+ * \param[in] warp_subsampling The subsampling, wich is used for warping
+ * \param[in] warp_sigma The sigma, which is used for smoothing the result before subsampling.
+ * \param[in] warm_start If true, the previous flow is used as initial flow.
+ * \param[in] visitor The functor, which is called with the results of each pair.
+ */
+template <class T1, class T3, class OpticalFlowFunctor, class WarpingFunctor, class FlowVisitor>
+void calculateOFCESequenceHierarchicallyWarping(const std::vector<vigra::MultiArrayView<2,T1> >& frames,
+                                                const vigra::MultiArrayView<2,T3> * mask,
+                                                OpticalFlowFunctor flow_func,
+                                                bool use_gme,
+                                                unsigned int steps,
+                                                unsigned int break_level,
+                                                unsigned int hmode,
+                                                WarpingFunctor warp,
+                                                unsigned int warp_subsampling,
+                                                float warp_sigma,
+                                                bool warm_start,
+                                                FlowVisitor visitor)
+{
+    typedef typename OpticalFlowFunctor::FlowValueType FlowValueType;
+    
+    vigra_precondition(frames.size() > 1 ,"at least two frames are needed!");
+    
+    for (unsigned int f=1; f<frames.size(); ++f)
+    {
+        vigra_precondition(frames[0].shape() == frames[f].shape() ,"image sizes differ!");
+    }
+    vigra_precondition(mask == NULL || frames[0].shape() == mask->shape() ,"image and mask sizes differ!");
+    
+    using namespace ::vigra::multi_math;
+    
+	steps = std::min((double)steps, log((double)std::min(frames[0].width(), frames[0].height()))/log(2.0)-3);
+	std::list<unsigned int> step_list = buildStepList(steps, break_level, hmode);
 	
-	//work on that hierarchy	
-	for (std::list<unsigned int>::iterator iter = step_list.begin(); iter != step_list.end(); ++iter)
-	{
-		std::list<unsigned int>::iterator next_iter = iter; next_iter++;
-		unsigned int s = *iter;
-		unsigned int next_s = *next_iter;
-		
-		qDebug() << "Running OFCE on level " << s;
-		
-		flow_func.setLevel(s);
-		
-		calculateOFCE(img_list[s],
-					  img2_list[s],
-					  mask_list[s],
-					  flow_list[s],
-					  flow_func,
-					  use_gme,
-                      mat_list[s],
-                      rotation_correlation_list[s],
-                      translation_correlation_list[s]);
+    //The sliding window of pyramids
+    std::vector<vigra::MultiArray<2,T1> > current, next, prefetch, img_list;
+    std::vector<vigra::MultiArray<2,T3> > mask_list;
+    
+	qDebug() << "Building gaussian pyramids for the first two frames with " << steps << " levels";
+	
+    buildGaussianPyramid(frames[0], steps, current);
+    buildGaussianPyramid(frames[1], steps, next);
+    
+    if(mask != NULL)
+    {
+        buildGaussianPyramid(*mask, steps, mask_list);
+    }
+    
+    std::vector<vigra::MultiArray<2,FlowValueType> > flow_list;
+    std::vector<vigra::Matrix<double> > mat_list;
+    std::vector<double> rotation_correlation_list;
+    std::vector<double> translation_correlation_list;
+    
+    vigra::MultiArray<2,FlowValueType> last_flow;
+    
+    //One thread for the background construction of the next pyramid
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    
+    for (unsigned int pair=0; pair+1<frames.size(); ++pair)
+    {
+        GaussianPyramidTask<T1>* prefetch_task = NULL;
         
-		if(next_iter != step_list.end() )
-		{
-			//rescale vector length
-            double rescale_factor = pow(2.0, double(s));
+        if(pair+2 < frames.size())
+        {
+            prefetch_task = new GaussianPyramidTask<T1>(frames[pair+2], steps, prefetch);
+            pool.start(prefetch_task);
+        }
+        
+        try
+        {
+            //The first image is warped during the steps, thus work on a copy of its pyramid
+            img_list = current;
             
-			//store computed u and v to the result
-			vigra::resizeImageLinearInterpolation(flow_list[s], temp_res);
+            prepareOFCEPyramidLists(img_list, flow_list, mat_list, rotation_correlation_list, translation_correlation_list);
             
-            //rescale values:
-            flow_res += temp_res*rescale_factor;
+            if(warm_start && !use_gme && pair != 0)
+            {
+                unsigned int first_s = step_list.front();
+                
+                //scale the previous flow down to the first level
+                vigra::resizeImageLinearInterpolation(last_flow, flow_list[first_s]);
+                
+                double rescale_factor = pow(2.0, -double(first_s));
+                flow_list[first_s].bindElementChannel(0) *= rescale_factor;
+                flow_list[first_s].bindElementChannel(1) *= rescale_factor;
+            }
             
-            //use u and v (in a subsampled way) to call the warping
-			//progate u's and v's for the next lower step
-			vigra::resizeImageLinearInterpolation(flow_list[s], flow_list[next_s]);
-			
-			//rescale vector length
-            rescale_factor = pow(2.0, double(s-next_s));
+            qDebug() << "Running hierarchical OFCE on frames " << pair << " and " << pair+1;
             
-            using namespace vigra::multi_math;
-			flow_list[next_s].bindElementChannel(0) *= rescale_factor;
-			flow_list[next_s].bindElementChannel(1) *= rescale_factor;
-			
-			//smooth further if necessary
-			if (warp_sigma != 0.0)
-			{
-				vigra::gaussianSmoothing(flow_list[next_s], flow_list[next_s], warp_sigma);
-			}
-			
-			//Prepare point list for warping
-			std::vector<Vectorfield2D::PointType> src_points, dest_points;
-			for(unsigned int y=0; y<(unsigned int)(flow_list[next_s].height()); y+=warp_subsampling)
-			{
-				for(unsigned int x=0; x<(unsigned int)(flow_list[next_s].width()); x+=warp_subsampling)
-				{
-					src_points.push_back(Vectorfield2D::PointType(x,y));
-					dest_points.push_back(Vectorfield2D::PointType(x+flow_list[next_s](x,y)[0], y+flow_list[next_s](x,y)[1]));
-				} 
-			}
-			//Call the warping functor
-			warp(img_list[next_s], img_list[next_s], src_points.begin(), src_points.end(), dest_points.begin());
-			
-			//Delete (already corrected) motion estimate
-			flow_list[next_s] = typename OpticalFlowFunctor::FlowValueType();
-		}
-	}	
-	if(break_level!=0)
-	{
-        vigra::resizeImageLinearInterpolation(flow_list[break_level], flow_list[0]);
-		
-		//rescale vector length
-		double rescale_factor = pow(2.0, double(break_level));
-		
-		//store computed u and v to the result
-		vigra::resizeImageLinearInterpolation(flow_list[break_level], temp_res);
-        flow_res += temp_res*rescale_factor;
-	}
-	flow_list[0] = flow_res;
+            calculateOFCEWarpingOnPyramids(img_list, next, (mask != NULL) ? &mask_list : NULL,
+                                           flow_list, flow_func,
+                                           use_gme, mat_list, rotation_correlation_list, translation_correlation_list,
+                                           step_list, break_level,
+                                           warp, warp_subsampling, warp_sigma);
+            
+            if(warm_start)
+            {
+                last_flow = flow_list[0];
+            }
+            
+            visitor(pair, img_list, flow_list, mat_list);
+        }
+        catch(...)
+        {
+            //The background task still works on the prefetch pyramid
+            pool.waitForDone();
+            delete prefetch_task;
+            throw;
+        }
+        
+        pool.waitForDone();
+        delete prefetch_task;
+        
+        //Move the sliding window by one frame
+        current.swap(next);
+        next.swap(prefetch);
+    }
 }
 
 /**
@@ -43,6 +43,8 @@
 #include <vigra/convolution.hxx>
 #include <vigra/stdconvolution.hxx>
 
+#include "gaussianderivatives.hxx"
+
 namespace graipe {
 
 /**
@@ -52,11 +54,29 @@ namespace graipe {
  * @file
  * @brief Header file for the generic image series' gradients for Optical Flow approaches.
  */
+
+/**
+ * Access to the GaussianDerivativeEngine of the calling thread, which is used by the
+ * free gradient functions below. Thus, the kernels are only rebuilt if the scale
+ * changes and the temporary memory is reused by subsequent calls of the same thread.
+ *
+ * \param sigma The scale of the Gaussian function used to derive the partial derivatives.
+ * \return The engine of the calling thread, set to the given scale.
+ */
+template <class T>
+GaussianDerivativeEngine<T>& threadDerivativeEngine(double sigma)
+{
+    static thread_local GaussianDerivativeEngine<T> engine(sigma);
+    
+    engine.setSigma(sigma);
+    return engine;
+}
  
 /**
  * The generic version of a spatio-temporal Gradient estimator based on two images.
  * To avoid noise-addictiveness, one can give a gaussian sigma value to smooth
  * both images before differencing (which is indeed a subtraction of smoothed (I2-I1).
+ * All parts are computed by one fused pass of a GaussianDerivativeEngine.
  *
  * \param[in] src1 The first image of the series.
  * \param[in] src2 The second image of the series.
@@ -78,17 +98,7 @@ void spatioTemporalGradient(const vigra::MultiArrayView<2, T1> & src1,
     vigra_precondition(gY.shape() == gT.shape(), "gradient array sizes differ!");
     vigra_precondition(src1.shape() == gT.shape(), "gradient array sizes differ from image sizes!");
     
-    using namespace ::vigra;
-    using namespace ::vigra::multi_math;
-    
-	//Spatial part of the spatio-temporal gradient
-	vigra::MultiArray<2, T3> temp = 0.5*(src1 + src2);
-	vigra::gaussianGradient(temp, gX, gY, sigma);
-	
-	//Temporal part of the spatio-temporal gradient
-	vigra::gaussianSmoothing(src1,   gT, sigma);
-	vigra::gaussianSmoothing(src2, temp, sigma);
-    gT = temp - gT;
+    threadDerivativeEngine<T3>(sigma).spatioTemporalGradient(src1, src2, gX, gY, gT);
 }
 
 /**
@@ -115,28 +125,7 @@ void gaussianGradientWithMask(const vigra::MultiArrayView<2, T1> & src,
     vigra_precondition(gX.shape() == gY.shape(), "gradient array sizes differ!");
     vigra_precondition(src.shape() == gX.shape(), "gradient array sizes differ from image sizes!");
     
-    //Build the kernels for:
-	vigra::Kernel1D<float> grad_dummy;
-	grad_dummy.initExplicitly(0, 0) = 1;
-	
-	vigra::Kernel1D<float> grad;
-	grad.initGaussianDerivative(sigma,1);
-	
-	//g_X
-	vigra::Kernel2D<float> kernel_gx;
-	kernel_gx.initSeparable(grad, grad_dummy);
-    kernel_gx.setBorderTreatment(btmode);
-    
-	
-	//g_Y
-	vigra::Kernel2D<float> kernel_gy;
-	kernel_gy.initSeparable(grad_dummy, grad);
-	kernel_gy.setBorderTreatment(btmode);
-    
-	//gX
-	vigra::normalizedConvolveImage(src, mask, gX, kernel_gx);
-	//gY
-	vigra::normalizedConvolveImage(src, mask, gY, kernel_gy);
+    threadDerivativeEngine<T3>(sigma).gradientWithMask(src, mask, gX, gY, btmode);
 }
 
 /**
@@ -209,26 +198,7 @@ void hessianMatrixOfGaussianWithMask(const vigra::MultiArrayView<2, T1> & src,
     vigra_precondition(gXY.shape() == gYY.shape(), "gradient array sizes differ!");
     vigra_precondition(src.shape() == gXX.shape(), "gradient array sizes differ from image sizes!");
     
-    //gX & gY
-	gaussianGradientWithMask(src, mask, gXX, gYY, sigma, btmode);
-    
-	//gXX & gXY
-	gaussianGradientWithMask(gXX, mask, gXX, gXY, sigma, btmode);
-	
-	//Build the kernels for:
-	vigra::Kernel1D<float> grad_dummy;
-	grad_dummy.initExplicitly(0, 0) = 1;
-	
-	vigra::Kernel1D<float> grad;
-	grad.initGaussianDerivative(sigma,1);
-
-	vigra::Kernel2D<float> kernel_gy;
-	kernel_gy.initSeparable(grad_dummy, grad);
-	kernel_gy.setBorderTreatment(btmode);
-	
-	//gYY
-	vigra::normalizedConvolveImage(gYY, mask, gYY, kernel_gy);
-	
+    threadDerivativeEngine<T3>(sigma).hessianWithMask(src, mask, gXX, gXY, gYY, btmode);
 }
 
 /**
@@ -289,18 +259,7 @@ void structureTensorWithMask(const vigra::MultiArrayView<2, T1> & src,
     vigra_precondition(gXY.shape() == gYY.shape(), "gradient array sizes differ!");
     vigra_precondition(src.shape() == gXX.shape(), "gradient array sizes differ from image sizes!");
     
-	gaussianGradientWithMask(src, mask, gXX, gYY, sigma_inner, btmode);
-	
-    using namespace vigra::multi_math;
-    
-    gXY = gXX * gXY;
-	gXX = gXX * gXX;
-	gYY = gYY * gYY;
-		
-	gaussianSmoothingWithMask(gXX, mask, gXX, sigma_outer);
-	gaussianSmoothingWithMask(gXY, mask, gXY, sigma_outer);
-	gaussianSmoothingWithMask(gYY, mask, gYY, sigma_outer);
-	
+    threadDerivativeEngine<T3>(sigma_inner).structureTensorWithMask(src, mask, gXX, gXY, gYY, sigma_outer, btmode);
 }
 
 /**
@@ -338,17 +297,8 @@ void spatioTemporalGradientWithMask(const vigra::MultiArrayView<2, T1> & src1,
     vigra_precondition(gY.shape() == gT.shape(), "gradient array sizes differ!");
     vigra_precondition(src1.shape() == gX.shape(), "gradient array sizes differ from image sizes!");
         
-    using namespace ::vigra;
-    using namespace ::vigra::multi_math;
-    
-	//Spatial part of the spatio-temporal gradient
-	vigra::MultiArray<2, T3> temp = 0.5*(src1 + src2);
-	gaussianGradientWithMask(temp, mask, gX, gY, sigma, btmode);
-	
-	//Temporal part of the spatio-temporal gradient
-	gaussianSmoothingWithMask(src1, mask,   gT, sigma, btmode);
-	gaussianSmoothingWithMask(src2, mask, temp, sigma, btmode);
-    gT = temp - gT;
+    typedef typename GaussianDerivativeEngine<T4>::ViewType EmptyView;
+    threadDerivativeEngine<T4>(sigma).spatioTemporalGradientWithMask(src1, src2, mask, gX, gY, gT, EmptyView(), EmptyView(), EmptyView(), btmode);
 }
 
 /**
@@ -0,0 +1,452 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_OPTICALFLOW_VARIATIONALKERNELS_HXX
+#define GRAIPE_OPTICALFLOW_VARIATIONALKERNELS_HXX
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/tinyvector.hxx>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_opticalflow
+ * @{
+ *
+ * @file
+ * @brief Header file for the inner update kernels of the variational Optical Flow approaches.
+ *
+ * The kernels work on a planar (structure of arrays) representation of the flow field
+ * and on contiguous float arrays only. They are specialized at compile-time on masked
+ * vs. unmasked processing and on the tracking of the per-iteration change. Without
+ * masks and change tracking, the loops are free of branches and reductions and are
+ * vectorized by the compiler (SSE/AVX, depending on the target architecture, see
+ * GRAIPE_NATIVE_ARCH in the common cmake config).
+ */
+
+/**
+ * Planar copy of the first two components (u and v) of a flow field.
+ * The solvers iterate on this representation instead of the interleaved
+ * TinyVector layout of the flow fields.
+ */
+class PlanarFlow
+{
+    public:
+        /**
+         * Creates a zero initialized planar flow of a given shape.
+         *
+         * \param shape The shape of the flow.
+         */
+        PlanarFlow(const vigra::Shape2 & shape)
+        :   u(shape),
+            v(shape)
+        {
+        }
+    
+        /**
+         * Copies the u and v components of a flow field into this planar flow.
+         *
+         * \param flow The flow field. Needs to have the same shape.
+         */
+        template <class T, int N>
+        void importFlow(const vigra::MultiArrayView<2, vigra::TinyVector<T,N> > & flow)
+        {
+            vigra_precondition(flow.shape() == u.shape(), "flow array sizes differ from planar flow sizes!");
+            
+            u = flow.bindElementChannel(0);
+            v = flow.bindElementChannel(1);
+        }
+    
+        /**
+         * Copies this planar flow back into the u and v components of a flow field.
+         *
+         * \param flow The flow field. Needs to have the same shape.
+         */
+        template <class T, int N>
+        void exportFlow(vigra::MultiArrayView<2, vigra::TinyVector<T,N> > flow) const
+        {
+            vigra_precondition(flow.shape() == u.shape(), "flow array sizes differ from planar flow sizes!");
+            
+            flow.bindElementChannel(0) = u;
+            flow.bindElementChannel(1) = v;
+        }
+    
+        /** The planar u component **/
+        vigra::MultiArray<2, float> u;
+        /** The planar v component **/
+        vigra::MultiArray<2, float> v;
+};
+
+/**
+ * Converts a mask of any value type into a planar float mask with values 0 and 1,
+ * which may be used for branch-free blending in the update kernels.
+ *
+ * \param mask The mask (only mask != 0 will be considered).
+ * \param weights The resulting 0/1 weights.
+ */
+template <class T>
+void maskToWeights(const vigra::MultiArrayView<2,T> & mask, vigra::MultiArrayView<2,float> weights)
+{
+    vigra_precondition(mask.shape() == weights.shape(), "mask and weights sizes differ!");
+    
+    for(int y=0; y<mask.height(); ++y)
+    {
+        for(int x=0; x<mask.width(); ++x)
+        {
+            weights(x,y) = (mask(x,y) != 0) ? 1.0f : 0.0f;
+        }
+    }
+}
+
+/**
+ * Accumulator for the mean and maximum change of the flow during one iteration.
+ * The TrackChanges=false specialization does nothing and is optimized away.
+ */
+template <bool TrackChanges>
+class FlowChangeTracker
+{
+    public:
+        FlowChangeTracker()
+        :   m_sum(0),
+            m_max(0),
+            m_count(0)
+        {
+        }
+    
+        /**
+         * Adds the change of one flow vector.
+         *
+         * \param du The change of the u component.
+         * \param dv The change of the v component.
+         */
+        void add(float du, float dv)
+        {
+            float change = std::sqrt(du*du + dv*dv);
+            m_sum += change;
+            m_max = std::max(m_max, change);
+        }
+    
+        /**
+         * Sets the count of pixels used for the mean change.
+         *
+         * \param count The count of pixels.
+         */
+        void setCount(std::size_t count)
+        {
+            m_count = count;
+        }
+    
+        /**
+         * The mean change of the current iteration.
+         *
+         * \return The mean change.
+         */
+        double meanChange() const
+        {
+            return m_count ? m_sum/m_count : 0.0;
+        }
+    
+        /**
+         * The max. change of the current iteration.
+         *
+         * \return The max. change.
+         */
+        double maxChange() const
+        {
+            return m_max;
+        }
+    
+    private:
+        double m_sum;
+        float m_max;
+        std::size_t m_count;
+};
+
+template <>
+class FlowChangeTracker<false>
+{
+    public:
+        void add(float, float) {}
+        void setCount(std::size_t) {}
+        double meanChange() const { return 0.0; }
+        double maxChange() const  { return 0.0; }
+};
+
+/**
+ * Precomputes the per pixel factor 1/(alpha^2 + I_x^2 + I_y^2), which is constant
+ * for all iterations of the Horn & Schunck and Nagel & Enkelmann update steps.
+ *
+ * \param[in] gX The gradient in x-direction.
+ * \param[in] gY The gradient in y-direction.
+ * \param[in] alpha The alpha weight between gradient and smoothness.
+ * \param[out] factor The resulting factors.
+ */
+inline void dataTermFactors(const vigra::MultiArrayView<2,float> & gX,
+                            const vigra::MultiArrayView<2,float> & gY,
+                            float alpha,
+                            vigra::MultiArrayView<2,float> factor)
+{
+    vigra_precondition(gX.shape() == gY.shape() && gX.shape() == factor.shape(), "gradient and factor sizes differ!");
+    vigra_precondition(gX.isUnstrided() && gY.isUnstrided() && factor.isUnstrided(), "arrays need to be unstrided!");
+    
+    const float * gx = gX.data(),
+                * gy = gY.data();
+    float * k = factor.data();
+    const float alpha2 = alpha*alpha;
+    
+    for(std::ptrdiff_t i=0, n=gX.size(); i<n; ++i)
+    {
+        k[i] = 1.0f/(alpha2 + gx[i]*gx[i] + gy[i]*gy[i]);
+    }
+}
+
+/**
+ * One (Jacobi) update step of the Horn & Schunck approach:
+ *
+ *   u = mean_u - I_x * (I_x*mean_u + I_y*mean_v + I_t) * factor
+ *   v = mean_v - I_y * (I_x*mean_u + I_y*mean_v + I_t) * factor
+ *
+ * \param gx, gy, gt The spatio-temporal gradient.
+ * \param factor The precomputed factors 1/(alpha^2 + I_x^2 + I_y^2).
+ * \param mean_u, mean_v The smoothed flow of the last iteration.
+ * \param weights The 0/1 mask weights (only used if Masked).
+ * \param[in,out] u, v The planar flow.
+ * \param n The count of pixels.
+ * \param changes The change tracker.
+ */
+template <bool Masked, bool TrackChanges>
+void hornSchunckUpdate(const float * gx, const float * gy, const float * gt,
+                       const float * factor,
+                       const float * mean_u, const float * mean_v,
+                       const float * weights,
+                       float * u, float * v,
+                       std::ptrdiff_t n,
+                       FlowChangeTracker<TrackChanges> & changes)
+{
+    for(std::ptrdiff_t i=0; i<n; ++i)
+    {
+        const float fix_part = (gx[i]*mean_u[i] + gy[i]*mean_v[i] + gt[i]) * factor[i];
+        
+        float new_u = mean_u[i] - fix_part*gx[i],
+              new_v = mean_v[i] - fix_part*gy[i];
+        
+        if(Masked)
+        {
+            new_u = u[i] + weights[i]*(new_u - u[i]);
+            new_v = v[i] + weights[i]*(new_v - v[i]);
+        }
+        if(TrackChanges)
+        {
+            changes.add(new_u - u[i], new_v - v[i]);
+        }
+        
+        u[i] = new_u;
+        v[i] = new_v;
+    }
+}
+
+/**
+ * Precomputes the constant parts of the Nagel & Enkelmann update step:
+ * The vector q and the factor of the mixed second order flow derivatives:
+ *
+ *   q    = 1/(|nabla I|^2 + 2 delta) * nabla I^T * (adj(H) + 2 H W)
+ *   c_xy = 2 I_x I_y /(|nabla I|^2 + 2 delta)
+ *
+ * with H the Hessian of I and W the (normalized) weight matrix.
+ *
+ * \param[in] gX, gY The gradient of the image.
+ * \param[in] gXX, gXY, gYY The Hessian of the image.
+ * \param[in] delta The regularisation of the weight matrix.
+ * \param[out] q_x, q_y The vector q.
+ * \param[out] c_xy The factor of the mixed term.
+ */
+inline void nagelEnkelmannTerms(const vigra::MultiArrayView<2,float> & gX,  const vigra::MultiArrayView<2,float> & gY,
+                                const vigra::MultiArrayView<2,float> & gXX, const vigra::MultiArrayView<2,float> & gXY, const vigra::MultiArrayView<2,float> & gYY,
+                                double delta,
+                                vigra::MultiArrayView<2,float> q_x, vigra::MultiArrayView<2,float> q_y, vigra::MultiArrayView<2,float> c_xy)
+{
+    vigra_precondition(gX.shape() == q_x.shape() && gX.shape() == q_y.shape() && gX.shape() == c_xy.shape(), "gradient and term sizes differ!");
+    
+    for(std::ptrdiff_t i=0, n=gX.size(); i<n; ++i)
+    {
+        const double gx = gX[i], gy = gY[i],
+                     xx = gXX[i], xy = gXY[i], yy = gYY[i],
+                     norm = 1.0/(gx*gx + gy*gy + 2.0*delta);
+        
+        //H*W, where W = norm * [gy^2+delta, -gx*gy; -gx*gy, gx^2+delta]
+        const double hw00 = norm*(xx*(gy*gy+delta) - xy*gx*gy),
+                     hw01 = norm*(xy*(gx*gx+delta) - xx*gx*gy),
+                     hw10 = norm*(xy*(gy*gy+delta) - yy*gx*gy),
+                     hw11 = norm*(yy*(gx*gx+delta) - xy*gx*gy);
+        
+        //M = adj(H) + 2*H*W
+        const double m00 =  yy + 2.0*hw00,
+                     m01 = -xy + 2.0*hw01,
+                     m10 = -xy + 2.0*hw10,
+                     m11 =  xx + 2.0*hw11;
+        
+        q_x[i]  = norm*(gx*m00 + gy*m10);
+        q_y[i]  = norm*(gx*m01 + gy*m11);
+        c_xy[i] = norm*2.0*gx*gy;
+    }
+}
+
+/**
+ * One (Jacobi) update step of the Nagel & Enkelmann approach:
+ *
+ *   xi_u = mean_u - c_xy*u_xy - (q_x*u_x + q_y*u_y)
+ *   xi_v = mean_v - c_xy*v_xy - (q_x*v_x + q_y*v_y)
+ *   u    = xi_u - I_x * (I_x*xi_u + I_y*xi_v + I_t) * factor
+ *   v    = xi_v - I_y * (I_x*xi_u + I_y*xi_v + I_t) * factor
+ *
+ * \param gx, gy, gt The spatio-temporal gradient.
+ * \param factor The precomputed factors 1/(alpha^2 + I_x^2 + I_y^2).
+ * \param q_x, q_y, c_xy The precomputed Nagel & Enkelmann terms.
+ * \param mean_u, u_x, u_y, u_xy The smoothing and derivatives of u.
+ * \param mean_v, v_x, v_y, v_xy The smoothing and derivatives of v.
+ * \param weights The 0/1 mask weights (only used if Masked).
+ * \param[in,out] u, v The planar flow.
+ * \param n The count of pixels.
+ * \param changes The change tracker.
+ */
+template <bool Masked, bool TrackChanges>
+void nagelEnkelmannUpdate(const float * gx, const float * gy, const float * gt,
+                          const float * factor,
+                          const float * q_x, const float * q_y, const float * c_xy,
+                          const float * mean_u, const float * u_x, const float * u_y, const float * u_xy,
+                          const float * mean_v, const float * v_x, const float * v_y, const float * v_xy,
+                          const float * weights,
+                          float * u, float * v,
+                          std::ptrdiff_t n,
+                          FlowChangeTracker<TrackChanges> & changes)
+{
+    for(std::ptrdiff_t i=0; i<n; ++i)
+    {
+        const float xi_u = mean_u[i] - c_xy[i]*u_xy[i] - (q_x[i]*u_x[i] + q_y[i]*u_y[i]),
+                    xi_v = mean_v[i] - c_xy[i]*v_xy[i] - (q_x[i]*v_x[i] + q_y[i]*v_y[i]),
+                    fix_part = (gx[i]*xi_u + gy[i]*xi_v + gt[i]) * factor[i];
+        
+        float new_u = xi_u - gx[i]*fix_part,
+              new_v = xi_v - gy[i]*fix_part;
+        
+        if(Masked)
+        {
+            new_u = u[i] + weights[i]*(new_u - u[i]);
+            new_v = v[i] + weights[i]*(new_v - v[i]);
+        }
+        if(TrackChanges)
+        {
+            changes.add(new_u - u[i], new_v - v[i]);
+        }
+        
+        u[i] = new_u;
+        v[i] = new_v;
+    }
+}
+
+/**
+ * One SOR (successive over-relaxation) step of the linear combined local global approach
+ * for one inner row j of the planar flow. The row is processed in two phases:
+ *
+ *  1. All terms, which do not depend on the current row's new values (last iteration,
+ *     row j-1 and j+1 and the structure tensor terms) are collected in a vectorizable loop.
+ *  2. The remaining Gauss-Seidel recurrence u(i) += k(i)*u(i-1) is resolved in a short scalar loop.
+ *
+ * \param w The width of the flow.
+ * \param omega The SOR weight.
+ * \param inv_alpha The reciprocal of the alpha weight.
+ * \param stxy The xy-part of the structure tensor (row j).
+ * \param b_x, b_y The smoothed products I_x*I_t and I_y*I_t (row j).
+ * \param k_u, k_v The precomputed factors omega/(4 + stxx/alpha) resp. omega/(4 + styy/alpha) (row j).
+ * \param last_u, last_v The flow of the last iteration (row j, row j+1 at +w).
+ * \param weights The 0/1 mask weights (only used if Masked) (row j).
+ * \param[in,out] u, v The planar flow (row j, row j-1 at -w).
+ * \param temp A temporary row buffer of size 2*w.
+ * \param changes The change tracker.
+ */
+template <bool Masked, bool TrackChanges>
+void clgSORRowUpdate(int w, float omega, float inv_alpha,
+                     const float * stxy, const float * b_x, const float * b_y,
+                     const float * k_u, const float * k_v,
+                     const float * last_u, const float * last_v,
+                     const float * weights,
+                     float * u, float * v,
+                     float * temp,
+                     FlowChangeTracker<TrackChanges> & changes)
+{
+    float * c_u = temp,
+          * c_v = temp + w;
+    
+    const float relax = 1.0f - omega;
+    
+    //1. Vectorizable part
+    for(int i=1; i<w-1; ++i)
+    {
+        c_u[i] =  relax*last_u[i]
+                + k_u[i]*(   u[i-w] + last_u[i+1] + last_u[i+w]
+                          -  inv_alpha*(stxy[i]*last_v[i] + b_x[i]));
+        
+        c_v[i] =  relax*last_v[i]
+                + k_v[i]*(   v[i-w] + last_v[i+1] + last_v[i+w]
+                          -  inv_alpha*(stxy[i]*last_u[i] + b_y[i]));
+    }
+    
+    //2. Gauss-Seidel recurrence along the row
+    for(int i=1; i<w-1; ++i)
+    {
+        if(!Masked || weights[i] != 0)
+        {
+            u[i] = c_u[i] + k_u[i]*u[i-1];
+            v[i] = c_v[i] + k_v[i]*v[i-1];
+        }
+        if(TrackChanges)
+        {
+            changes.add(u[i] - last_u[i], v[i] - last_v[i]);
+        }
+    }
+}
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_OPTICALFLOW_VARIATIONALKERNELS_HXX
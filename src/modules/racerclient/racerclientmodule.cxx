@@ -71,9 +71,99 @@ inline float distanceOnEarth(const QPointF & p1deg, const QPointF & p2deg)
 	double lon1rad = double(p1deg.x())*degToRad, lon2rad = double(p2deg.x())*degToRad;
 	double lat1rad = double(p1deg.y())*degToRad, lat2rad = double(p2deg.y())*degToRad;
 	
-	return acos(sin(lat1rad)*sin(lat2rad) + cos(lat1rad)*cos(lat2rad) * cos(lon2rad-lon1rad)) * r;
+	//Clamp against rounding errors, which would yield NaN for equal positions
+	double cos_angle = sin(lat1rad)*sin(lat2rad) + cos(lat1rad)*cos(lat2rad) * cos(lon2rad-lon1rad);
+	
+	return acos(std::max(-1.0, std::min(1.0, cos_angle))) * r;
+}
+
+/**
+ * Small helper function to compute the global positions (lon, lat in degrees) of
+ * all vectors of a vectorfield. The global transformation is computed only once.
+ *
+ * \param vf The vectorfield.
+ * \param positions Will be filled with the global positions of all vectors.
+ */
+inline void globalVectorPositions(const Vectorfield2D* vf, std::vector<QPointF>& positions)
+{
+	std::vector<Vectorfield2D::PointType> origins;
+	vf->copyOrigins(origins);
+	
+	std::vector<QPointF> points(origins.begin(), origins.end());
+	vf->mapToGlobal(points, positions);
 }
 
+/**
+ * A spatial index over global positions (lon, lat in degrees) for the search of all
+ * positions within a given great circle distance. The candidates are found by means
+ * of a grid index and refined using the exact distance on earth. Positions on the 
+ * other side of the date line are not found.
+ */
+class EarthNeighborIndex
+{
+    public:
+        /**
+         * Constructor. Builds the index for the given positions.
+         *
+         * \param positions The global positions (lon, lat in degrees).
+         */
+        EarthNeighborIndex(const std::vector<QPointF>& positions)
+        :   m_positions(positions)
+        {
+            std::vector<QRectF> bounds(positions.size());
+            
+            for (unsigned int i=0; i<positions.size(); ++i)
+            {
+                bounds[i] = QRectF(positions[i], QSizeF(0,0));
+            }
+            m_index.build(bounds);
+        }
+    
+        /**
+         * Finds all positions within a given distance.
+         *
+         * \param p The global position (lon, lat in degrees).
+         * \param max_distance The maximal distance in km.
+         * \param result Will be filled with the ascending indices of all found positions.
+         * \param distances Will be filled with the distances of all found positions.
+         */
+        void neighbors(const QPointF& p, float max_distance,
+                       std::vector<unsigned int>& result, std::vector<float>& distances) const
+        {
+            result.clear();
+            distances.clear();
+            
+            //One degree of latitude on the earth sphere of radius 6371 km
+            const double km_per_degree = 6371*M_PI/180.0;
+            
+            double dlat = max_distance/km_per_degree;
+            
+            //The longitude span is the largest at the most poleward latitude
+            double cos_lat = cos(std::min(90.0, std::abs(p.y()) + dlat)*M_PI/180.0);
+            double dlon = (cos_lat > 1.0e-6) ? std::min(180.0, dlat/cos_lat) : 180.0;
+            
+            std::vector<unsigned int> candidates;
+            m_index.query(QRectF(p.x()-dlon, p.y()-dlat, 2*dlon, 2*dlat), candidates);
+            
+            for (unsigned int c : candidates)
+            {
+                float distance = distanceOnEarth(p, m_positions[c]);
+                
+                if (distance <= max_distance)
+                {
+                    result.push_back(c);
+                    distances.push_back(distance);
+                }
+            }
+        }
+    
+    protected:
+        /** The global positions **/
+        const std::vector<QPointF>& m_positions;
+        /** The grid index of the positions **/
+        SpatialIndex2D m_index;
+};
+
 /**
  * This class implements a classical reasoning case for the analysis of derived sea surface currents
  * (by means of a vectorfield), other sources of knowledge and a common reasoning base
@@ -110,6 +200,9 @@ class RacerInterpreter
             m_param_save_abox = new BoolParameter("Save resulting A-Box?", false);
             m_param_abox_filename = new FilenameParameter("A-Box in Racer-format", "", m_param_save_abox);	
             
+            m_param_host = new StringParameter("Racer server address", "127.0.0.1");
+            m_param_port = new IntParameter("Racer server port", 1, 65535, 8088);
+            
             m_parameters->addParameter("vf", m_param_measured_vectorfield );
             m_parameters->addParameter("tbox-filename", m_param_tbox_filename );
             
@@ -130,6 +223,9 @@ class RacerInterpreter
 
             m_parameters->addParameter("save_abox?",    m_param_save_abox);
             m_parameters->addParameter("abox-filename", m_param_abox_filename);
+            
+            m_parameters->addParameter("host", m_param_host);
+            m_parameters->addParameter("port", m_param_port);
         }
     
         QString typeName() const
@@ -167,23 +263,22 @@ class RacerInterpreter
                     
                     emit statusMessage(1.0, QString("starting computation"));
                     
-                    RacerConnection conn;
+                    RacerConnection conn(m_param_host->value(), m_param_port->value());
                     
                     unsigned int connection_timeout =		 5*	1000; //5 secs
                     unsigned int tbox_timeout =				60*	1000; //1 min
                     unsigned int abox_timeout =				60*	1000; //1 min
                     unsigned int query_timeout =		30*	60*	1000; //30 min
                     
+                    //Assertions per request and requests in flight for the A-Box
+                    unsigned int abox_batch_size = 256;
+                    conn.setMaxPendingRequests(16);
+                    
                     qDebug("Trying to connect to the RACER server");
                     conn.connectToServer(connection_timeout);
                     
                     if(conn.connected())
                     {
-                        //qInfo() << "Connected with RACER SERVER? " << conn.connected() <<"\n"
-                        //			<< "ipAddress: " << conn.ipAddress() << "\n"
-                        //			<< "port:      " << conn.port() << "\n"
-                        //			<< "racer version:      " << conn.racerVersion() << "\n";
-                        
                         QString request,result;
                         
                         if(!tbox_filename.isEmpty())
@@ -194,394 +289,146 @@ class RacerInterpreter
                         
                         //If T-Box has been loaded, we proceed
                         if(result != "")
-                        {					
-                            //qDebug() << "Received result from RACER after loading TBox: " << result << "\n";
-                            
-                            std::vector<QString> directions(8);
-                            directions[0] = "north";
-                            directions[1] = "northeast";
-                            directions[2] = "east";
-                            directions[3] = "southeast";
-                            directions[4] = "south";
-                            directions[5] = "southwest";
-                            directions[6] = "west";
-                            directions[7] = "northwest";
-                            
+                        {
+                            QFile file(abox_filename);
                             QTextStream* filestream  = NULL;
                             
                             if(m_param_save_abox->value())
                             {
-                                QFile file(abox_filename);
                                 if (file.open(QIODevice::WriteOnly | QIODevice::Text))
                                 {
                                     filestream = new QTextStream(&file);
                                 }
                             }
                             
+                            //Global positions and neighbor indices of all vectorfields
+                            std::vector<QPointF> measured_pos, wind_pos, modelled_pos;
+                            globalVectorPositions(measured_vf, measured_pos);
+                            
+                            EarthNeighborIndex measured_index(measured_pos);
+                            
+                            Vectorfield2D* wind_vf = NULL;
+                            Vectorfield2D* modelled_vf = NULL;
+                            
                             if (m_param_use_wind->value())
                             {
-                                Vectorfield2D* wind_vf = static_cast<Vectorfield2D*>(  m_param_wind_vectorfield->value() );	
+                                wind_vf = static_cast<Vectorfield2D*>(  m_param_wind_vectorfield->value() );
                                 
                                 if(wind_vf != NULL)
                                 {
+                                    globalVectorPositions(wind_vf, wind_pos);
+                                    
                                     if (wind_vf->scale() == 0)
                                     {
                                         emit errorMessage("Error: No scale given to compute the 'cm/s' for each vector of the wind vf.");
-                                        
-                                        conn.disconnect();
-                                    }
-                                    else
-                                    {
-                                        //only add wind vectors to abox, which have a role relation with a measured vector:
-                                        for(unsigned int i=0; i<wind_vf->size(); ++i)
-                                        {
-                                            
-                                            QTransform wind_vf_transform = wind_vf->globalTransformation();
-                                            
-                                            QPointF t_i = wind_vf_transform.map(QPointF(wind_vf->origin(i).x(), wind_vf->origin(i).y()));
-                                            QPointF t_j;
-                                            
-                                            for(unsigned int j=0; j<measured_vf->size(); ++j)
-                                            {
-                                                QTransform measured_vf_transform = measured_vf->globalTransformation();
-                                                
-                                                t_j = measured_vf_transform.map(QPointF(measured_vf->origin(j).x(), measured_vf->origin(j).y()));
-                                                
-                                                float distance = distanceOnEarth(t_i, t_j);
-                                                
-                                                if (distance <= m_param_distance3->value())
-                                                {
-                                                    QString name = QString("wind%1").arg(i);
-                                                    
-                                                    QTextStream datastream;
-                                                    
-                                                    //add the concept
-                                                    datastream <<  "(instance " << name << " (and windcurrent\n";
-                                                    
-                                                    //find out direction (in qualitative description)
-                                                    QString angle_str = directions[std::min(7.0,std::max(0.0, double(wind_vf->angle(i)) / 360 * directions.size()))];
-                                                    datastream << "\t\t(some has-direction " << angle_str << ")\n";
-                                                    
-                                                    //find out velocity (in qualitative description)
-                                                    float velocity = wind_vf->length(i)*wind_vf->scale();
-                                                    
-                                                    if (velocity != 0)
-                                                    {
-                                                        QString  velocity_str;
-                                                        if (velocity<= m_param_velocity1->value())
-                                                        {
-                                                            velocity_str = "low";
-                                                        }
-                                                        else if (velocity > m_param_velocity1->value() && velocity <= m_param_velocity2->value())
-                                                        {
-                                                            velocity_str = "moderate";
-                                                        }
-                                                        else if (velocity > m_param_velocity2->value() && velocity <= m_param_velocity3->value())
-                                                        {
-                                                            velocity_str = "high";
-                                                        }
-                                                        if (!velocity_str.isEmpty())
-                                                            datastream << "\t\t(some has-velocity " << velocity_str << ")\n";
-                                                        
-                                                        //Close idividual descriptor:
-                                                        datastream << "))\n\n";
-                                                        
-                                                        QString request = datastream.readAll();
-                                                        if(filestream)
-                                                        {
-                                                            *filestream << request;
-                                                        }
-                                                        
-                                                        //Send ABox for current wind vector to RACER
-                                                        result =  conn.send(request, abox_timeout);
-                                                        if (result.isEmpty())
-                                                        {
-                                                            break;
-                                                        }
-                                                    }
-                                                    
-                                                    break; //break out of inner for loop
-                                                }
-                                            }
-                                        }
                                     }
                                 }
                             }
                             
                             if (m_param_use_modelled_currents->value())
                             {
-                                Vectorfield2D* modelled_vf = static_cast<Vectorfield2D*>(  m_param_modelled_vectorfield->value() );	
+                                modelled_vf = static_cast<Vectorfield2D*>(  m_param_modelled_vectorfield->value() );
                                 
                                 if(modelled_vf != NULL)
                                 {
+                                    globalVectorPositions(modelled_vf, modelled_pos);
+                                    
                                     if (modelled_vf->scale() == 0)
                                     {
                                         emit errorMessage("Error: No scale given to compute the 'cm/s' for each vector of the modelled vf.");
-                                        
-                                        conn.disconnect();
-                                    }
-                                    else
-                                    {
-                                        //only add modelled vectors to abox, which have a role relation with a measured vector:
-                                        for(unsigned int i=0; i<modelled_vf->size(); ++i)
-                                        {
-                                            
-                                            QTransform modelled_vf_transform = modelled_vf->globalTransformation();
-                                            
-                                            QPointF t_i = modelled_vf_transform.map(QPointF(modelled_vf->origin(i).x(), modelled_vf->origin(i).y()));
-                                            QPointF t_j;
-                                            
-                                            for(unsigned int j=0; j<measured_vf->size(); ++j)
-                                            {
-                                                QTransform measured_vf_transform = measured_vf->globalTransformation();
-                                                
-                                                t_j = measured_vf_transform.map(QPointF(measured_vf->origin(j).x(), measured_vf->origin(j).y()));
-                                                
-                                                float distance = distanceOnEarth(t_i, t_j);
-                                                
-                                                if (distance <= m_param_distance3->value())
-                                                {
-                                                    QString name = QString("modelled%1").arg(i);
-                                                    
-                                                    QTextStream datastream;
-                                                    
-                                                    //add the concept
-                                                    datastream <<  "(instance " << name << " (and modelledcurrent\n";
-                                                    
-                                                    //find out direction (in qualitative description)
-                                                    QString angle_str = directions[std::min(7.0,std::max(0.0, double(modelled_vf->angle(i)) / 360 * directions.size()))];
-                                                    datastream << "\t\t(some has-direction " << angle_str << ")\n";
-                                                    
-                                                    //find out velocity (in qualitative description)
-                                                    float velocity = modelled_vf->length(i)*modelled_vf->scale();
-                                                    
-                                                    if (velocity != 0)
-                                                    {
-                                                        QString  velocity_str;
-                                                        if (velocity<= m_param_velocity1->value())
-                                                        {
-                                                            velocity_str = "low";
-                                                        }
-                                                        else if (velocity > m_param_velocity1->value() && velocity <= m_param_velocity2->value())
-                                                        {
-                                                            velocity_str = "moderate";
-                                                        }
-                                                        else if (velocity > m_param_velocity2->value() && velocity <= m_param_velocity3->value())
-                                                        {
-                                                            velocity_str = "high";
-                                                        }
-                                                        if (!velocity_str.isEmpty())
-                                                            datastream << "\t\t(some has-velocity " << velocity_str << ")\n";
-                                                        
-                                                        //Close idividual descriptor:
-                                                        datastream << "))\n\n";
-                                                        
-                                                        QString request = datastream.readAll();
-                                                        
-                                                        if(filestream)
-                                                        {
-                                                            *filestream << request;
-                                                        }
-                                                        
-                                                        //Send ABox for current modelled vector to RACER
-                                                        result =  conn.send(request, abox_timeout);
-                                                        if (result.isEmpty())
-                                                        {
-                                                            break;
-                                                        }
-                                                    }
-                                                    
-                                                    break; //break out of inner for loop
-                                                }
-                                            }
-                                        }
                                     }
                                 }
                             }
                             
-                            //for each measured vector:
-                            for(unsigned int i=0; i<measured_vf->size(); ++i)
+                            EarthNeighborIndex wind_index(wind_pos), modelled_index(modelled_pos);
+                            
+                            std::vector<unsigned int> neighbors;
+                            std::vector<float> distances;
+                            
+                            RacerAssertionBatch abox(&conn, abox_batch_size, filestream, abox_timeout);
+                            
+                            //only add wind vectors to abox, which have a role relation with a measured vector:
+                            if(wind_vf != NULL && wind_vf->scale() != 0)
                             {
-                                QString name = QString("measured%1").arg(i);
-                                
-                                QTextStream datastream;
-                                
-                                //add the concept
-                                datastream <<  "(instance " << name << " (and measuredcurrent\n";
-                                
-                                //find out direction (in qualitative description)
-                                QString angle_str= directions[std::min(7.0,std::max(0.0, double(measured_vf->angle(i)) / 360 * directions.size()))];
-                                datastream << "\t\t(some has-direction " << angle_str << ")\n";
-                                
-                                //find out velocity (in qualitative description)
-                                float velocity = measured_vf->length(i)*measured_vf->scale();
-                                
-                                
-                                QString  velocity_str;
-                                if (velocity<= m_param_velocity1->value())
-                                {
-                                    velocity_str = "low";
-                                }
-                                else if (velocity > m_param_velocity1->value() && velocity <= m_param_velocity2->value())
-                                {
-                                    velocity_str = "moderate";
-                                }
-                                else if (velocity > m_param_velocity2->value() && velocity <= m_param_velocity3->value())
-                                {
-                                    velocity_str = "high";
-                                }
-                                if (!velocity_str.isEmpty())
-                                    datastream << "\t\t(some has-velocity " << velocity_str << ")\n";
-                                
-                                //Close idividual descriptor:
-                                datastream << "))\n";
-                                QString request = datastream.readAll();
-                                
-                                if(filestream)
+                                for(unsigned int i=0; i<wind_vf->size(); ++i)
                                 {
-                                    *filestream << request;
+                                    measured_index.neighbors(wind_pos[i], m_param_distance3->value(), neighbors, distances);
+                                    
+                                    if(!neighbors.empty() && wind_vf->length(i) != 0)
+                                    {
+                                        abox.add(instanceAssertion(QString("wind%1").arg(i), "windcurrent", wind_vf, i));
+                                    }
                                 }
-                                
-                                //Send ABox for current vector to RACER
-                                result =  conn.send(request, abox_timeout);
-                                if (result.isEmpty())
+                            }
+                            
+                            //only add modelled vectors to abox, which have a role relation with a measured vector:
+                            if(modelled_vf != NULL && modelled_vf->scale() != 0)
+                            {
+                                for(unsigned int i=0; i<modelled_vf->size(); ++i)
                                 {
-                                    qDebug() << "Error at datastream: " << request;
-                                    break;
+                                    measured_index.neighbors(modelled_pos[i], m_param_distance3->value(), neighbors, distances);
+                                    
+                                    if(!neighbors.empty() && modelled_vf->length(i) != 0)
+                                    {
+                                        abox.add(instanceAssertion(QString("modelled%1").arg(i), "modelledcurrent", modelled_vf, i));
+                                    }
                                 }
                             }
                             
+                            //for each measured vector:
+                            for(unsigned int i=0; i<measured_vf->size(); ++i)
+                            {
+                                abox.add(instanceAssertion(QString("measured%1").arg(i), "measuredcurrent", measured_vf, i));
+                            }
+                            
                             //for each measured vector determine role relations:
                             for(unsigned int i=0; i<measured_vf->size(); ++i)
                             {
                                 QString name = QString("measured%1").arg(i);
                                 
-                                QTextStream datastream;
-                                QTransform measured_vf_transform = measured_vf->globalTransformation();
-                                
-                                QPointF t_i = measured_vf_transform.map(QPointF(measured_vf->origin(i).x(), measured_vf->origin(i).y()));
-                                QPointF t_j;
-                                
-                                if (m_param_use_wind->value())
+                                //find out distant wind individuals (in qualitative description)
+                                if(wind_vf != NULL)
                                 {
-                                    Vectorfield2D* wind_vf = static_cast<Vectorfield2D*>(  m_param_wind_vectorfield->value() );
-                                    if(wind_vf != NULL)
+                                    wind_index.neighbors(measured_pos[i], m_param_distance3->value(), neighbors, distances);
+                                    
+                                    for(unsigned int n=0; n<neighbors.size(); ++n)
                                     {
-                                        QTransform wind_vf_transform = wind_vf->globalTransformation();
-                                        
-                                        //find out distant wind individuals (in qualitative description)
-                                        //for each neighbor wind vector:
-                                        for(unsigned int j=0; j<wind_vf->size(); ++j)
-                                        {
-                                            QString neighbor_name = QString("wind%1").arg(j);
-                                            
-                                            t_j = wind_vf_transform.map(QPointF(wind_vf->origin(j).x(), wind_vf->origin(j).y()));
-                                            
-                                            float distance = distanceOnEarth(t_i, t_j);
-                                            
-                                            QString distance_str;
-                                            if (distance <= m_param_distance1->value())
-                                            {
-                                                distance_str = "touches";
-                                            }
-                                            else if (distance > m_param_distance1->value() && distance <= m_param_distance2->value())
-                                            {
-                                                distance_str = "is-next-to";
-                                            }
-                                            else if (distance > m_param_distance2->value() && distance <= m_param_distance3->value())
-                                            {
-                                                distance_str = "is-far-away-from";
-                                            }
-                                            if(!distance_str.isEmpty())
-                                                datastream << "(related " << name << " " << neighbor_name << " " << distance_str << ")\n";
-                                        }
+                                        abox.add(relationAssertion(name, QString("wind%1").arg(neighbors[n]), distances[n]));
                                     }
                                 }
                                 
-                                if (m_param_use_modelled_currents->value())
+                                //find out distant modelled current individuals (in qualitative description)
+                                if(modelled_vf != NULL)
                                 {
-                                    Vectorfield2D* modelled_vf = static_cast<Vectorfield2D*>(  m_param_modelled_vectorfield->value() );
-                                    if(modelled_vf != NULL)
+                                    modelled_index.neighbors(measured_pos[i], m_param_distance3->value(), neighbors, distances);
+                                    
+                                    for(unsigned int n=0; n<neighbors.size(); ++n)
                                     {
-                                        QTransform modelled_vf_transform = modelled_vf->globalTransformation();
-                                        
-                                        //find out distant modelled current individuals (in qualitative description)
-                                        //for each neighbor modelled current vector:
-                                        for(unsigned int j=0; j<modelled_vf->size(); ++j)
-                                        {
-                                            QString neighbor_name = QString("modelled%1").arg(j);
-                                            
-                                            t_j = modelled_vf_transform.map(QPointF(modelled_vf->origin(j).x(), modelled_vf->origin(j).y()));
-                                            
-                                            float distance = distanceOnEarth(t_i, t_j);
-                                            
-                                            QString distance_str;
-                                            if (distance <= m_param_distance1->value())
-                                            {
-                                                distance_str = "touches";
-                                            }
-                                            else if (distance > m_param_distance1->value() && distance <= m_param_distance2->value())
-                                            {
-                                                distance_str = "is-next-to";
-                                            }
-                                            else if (distance > m_param_distance2->value() && distance <= m_param_distance3->value())
-                                            {
-                                                distance_str = "is-far-away-from";
-                                            }
-                                            if(!distance_str.isEmpty())
-                                                datastream << "(related " << name << " " << neighbor_name << " " << distance_str << ")\n";
-                                        }
+                                        abox.add(relationAssertion(name, QString("modelled%1").arg(neighbors[n]), distances[n]));
                                     }
                                 }
                                 
                                 //find out distant measured individuals (in qualitative description)
                                 //for each neighbor vector with a smaller id.
                                 //This is possible due to the reflexive spatial rules!
-                                for(unsigned int j=0; j<i; ++j)
+                                measured_index.neighbors(measured_pos[i], m_param_distance3->value(), neighbors, distances);
+                                
+                                for(unsigned int n=0; n<neighbors.size() && neighbors[n]<i; ++n)
                                 {
-                                    QString neighbor_name = QString("measured%1").arg(j);
-                                    
-                                    t_j = measured_vf_transform.map(QPointF(measured_vf->origin(j).x(), measured_vf->origin(j).y()));
-                                    
-                                    float distance = distanceOnEarth(t_i, t_j);
-                                    
-                                    QString distance_str;
-                                    if (distance <= m_param_distance1->value())
-                                    {
-                                        distance_str = "touches";
-                                    }
-                                    else if (distance > m_param_distance1->value() && distance <= m_param_distance2->value())
-                                    {
-                                        distance_str = "is-next-to";
-                                    }
-                                    else if (distance > m_param_distance2->value() && distance <= m_param_distance3->value())
-                                    {
-                                        distance_str = "is-far-away-from";
-                                    }
-                                    if(!distance_str.isEmpty())
-                                        datastream << "(related " << name << " " << neighbor_name << " " << distance_str << ")\n";
+                                    abox.add(relationAssertion(name, QString("measured%1").arg(neighbors[n]), distances[n]));
                                 }
                                 
-                                QString request = datastream.readAll();
-                                
-                                if(!request.isEmpty())
+                                if(i % 1000 == 0)
                                 {
-                                    if(filestream)
-                                    {
-                                        *filestream << request;
-                                    }
-                                    
-                                    //Send ABox for current vector to RACER
-                                    result =  conn.send(request, abox_timeout);
-                                    if (result.isEmpty())
-                                    {
-                                        qDebug() << "Error at request: " << request;
-                                        break;
-                                    }
+                                    emit statusMessage(i*100.0/measured_vf->size(), QString("creating A-Box from data"));
                                 }
-                                emit statusMessage(i*100.0/measured_vf->size(), QString("creating A-Box from data"));
-                            }	
+                            }
                             
+                            //Wait for the last replies
+                            if(!abox.finish())
+                            {
+                                qWarning() << "RACER did not accept all of the" << abox.assertionCount() << "A-Box assertions";
+                            }
                             
                             //ABox is written completely - close it
                             if(filestream)
@@ -636,12 +483,11 @@ class RacerInterpreter
                         else
                         {
                             qCritical("RACER did not read TBox....");
-                            conn.disconnect();
                             emit errorMessage(	QString("Explainable error occured: RACER Server did not read TBox"));
                         }
                         
                         
-                        conn.disconnect();
+                        conn.disconnectFromServer();
                         
                         emit statusMessage(100.0, QString("finished computation"));
                         emit finished();
@@ -666,6 +512,92 @@ class RacerInterpreter
         }
 
     protected:
+        /**
+         * Qualitative description of a direction.
+         *
+         * \param angle The angle of the direction in degrees.
+         * \return One of the eight compass directions.
+         */
+        static QString directionDescription(float angle)
+        {
+            static const char* directions[8] = {"north", "northeast", "east", "southeast", "south", "southwest", "west", "northwest"};
+            
+            return directions[(int)std::min(7.0,std::max(0.0, double(angle) / 360 * 8))];
+        }
+    
+        /**
+         * Qualitative description of a velocity.
+         *
+         * \param velocity The velocity in cm/s.
+         * \return "low", "moderate", "high" or an empty string for larger velocities.
+         */
+        QString velocityDescription(float velocity) const
+        {
+            if (velocity<= m_param_velocity1->value())
+            {
+                return "low";
+            }
+            else if (velocity <= m_param_velocity2->value())
+            {
+                return "moderate";
+            }
+            else if (velocity <= m_param_velocity3->value())
+            {
+                return "high";
+            }
+            return "";
+        }
+    
+        /**
+         * The A-Box assertion of one vector as an individual of a concept.
+         *
+         * \param name The name of the individual.
+         * \param concept The concept of the individual.
+         * \param vf The vectorfield.
+         * \param i The index of the vector.
+         * \return The assertion "(instance name (and concept (some has-direction ...) ...))".
+         */
+        QString instanceAssertion(const QString& name, const QString& concept, const Vectorfield2D* vf, unsigned int i) const
+        {
+            QString assertion = "(instance " + name + " (and " + concept 
+                              + " (some has-direction " + directionDescription(vf->angle(i)) + ")";
+            
+            QString velocity_str = velocityDescription(vf->length(i)*vf->scale());
+            
+            if (!velocity_str.isEmpty())
+                assertion += " (some has-velocity " + velocity_str + ")";
+            
+            return assertion + "))";
+        }
+    
+        /**
+         * The A-Box assertion of the spatial relation of two individuals.
+         *
+         * \param name The name of the first individual.
+         * \param neighbor_name The name of the second individual.
+         * \param distance The distance between both individuals in km.
+         * \return The assertion "(related name neighbor_name relation)" or an empty
+         *         string, if both are farther away than the far distance.
+         */
+        QString relationAssertion(const QString& name, const QString& neighbor_name, float distance) const
+        {
+            QString distance_str;
+            
+            if (distance <= m_param_distance1->value())
+            {
+                distance_str = "touches";
+            }
+            else if (distance <= m_param_distance2->value())
+            {
+                distance_str = "is-next-to";
+            }
+            else
+            {
+                distance_str = "is-far-away-from";
+            }
+            return "(related " + name + " " + neighbor_name + " " + distance_str + ")";
+        }
+    
         /** 
          * @{
          *
@@ -691,6 +623,9 @@ class RacerInterpreter
 
         BoolParameter	* m_param_save_abox;
         FilenameParameter * m_param_abox_filename;
+        
+        StringParameter * m_param_host;
+        IntParameter    * m_param_port;
         /**
          * @}
          */
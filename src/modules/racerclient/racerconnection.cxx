@@ -35,13 +35,19 @@
 
 #include "racerclient/racerconnection.hxx"
 
+#include <algorithm>
+
 namespace graipe {
 
 RacerConnection::RacerConnection()
 :	QObject(),
 	m_tcpSocket(new QTcpSocket),
 	m_ipAddress("127.0.0.1"),
-	m_port(8088)
+	m_port(8088),
+	m_last_reply_type(InvalidReply),
+	m_pending_requests(0),
+	m_max_pending_requests(16),
+	m_error_count(0)
 {
 	/*
 	// find out which IP to connect to
@@ -76,7 +82,11 @@ RacerConnection::RacerConnection(QString ipAddress, int port)
 :	QObject(),
 m_tcpSocket(new QTcpSocket),
 m_ipAddress(ipAddress),
-m_port(port)
+m_port(port),
+m_last_reply_type(InvalidReply),
+m_pending_requests(0),
+m_max_pending_requests(16),
+m_error_count(0)
 {
 	connectActions();
 }
@@ -147,93 +157,216 @@ void RacerConnection::disconnectFromServer(int msecs)
 
 QString RacerConnection::send(const QString& request,int msecs)
 {
-	
-	//qDebug() << QString("Sent Data") << qRequest;
-	
-	
 	//Remove whitespaces
 	QString request_simplified = request.simplified();
 	if( request_simplified.isEmpty() )
 	{
 		//m_log.addToLog("Unable to send empty string to RACER","Error");
+		return "";
 	}
-	else
+	
+	//Wait for the replies of all posted requests first, the last one will be ours
+	if(!post(request_simplified, msecs) || !waitForReplies(msecs))
 	{
-		QByteArray array = request_simplified.toUtf8().data();
-		
-		long len =  m_tcpSocket->write(array);
-		
-		if (len != array.size())
-			qDebug("Wrote less than I should...");
+		qDebug("Timeout: Communication with Racer not successful!");
+		return "";
+	}
+	
+	switch(m_last_reply_type)
+	{
+		case ErrorReply:
+			qDebug("Got an error");
+			return m_last_reply;
+		case OkReply:
+		case AnswerReply:
+			return m_last_reply;
+		default:
+			qDebug() << "Got a strange result:" << m_last_reply;
+			return "";
+	}
+}
 
-		//m_log.addToLog(QString("%1\n was send (%2/%3 bytes)").arg(request_simplified).arg(len).arg(array.size()),"Request");
-		
-		m_tcpSocket->write("\n");
-		if (m_tcpSocket->waitForBytesWritten(msecs))
+bool RacerConnection::post(const QString& request, int msecs)
+{
+	QString request_simplified = request.simplified();
+	
+	if(request_simplified.isEmpty() || m_tcpSocket->state() != QAbstractSocket::ConnectedState)
+	{
+		return false;
+	}
+	
+	//Wait for a free slot
+	while(m_pending_requests >= std::max(1u, m_max_pending_requests))
+	{
+		if(!waitForReply(msecs))
+		{
+			qDebug("Timeout: Reading bytes from Racer not successful!");
+			return false;
+		}
+	}
+	
+	QByteArray array = request_simplified.toUtf8();
+	array.append('\n');
+	
+	if (m_tcpSocket->write(array) != array.size())
+	{
+		qDebug("Wrote less than I should...");
+		return false;
+	}
+	m_tcpSocket->flush();
+	m_pending_requests++;
+	
+	//Parse replies, which have already arrived
+	readReplies();
+	
+	return true;
+}
+
+bool RacerConnection::waitForReplies(int msecs)
+{
+	while(m_pending_requests != 0)
+	{
+		if(!waitForReply(msecs))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned int RacerConnection::pendingRequests() const
+{
+	return m_pending_requests;
+}
+
+unsigned int RacerConnection::maxPendingRequests() const
+{
+	return m_max_pending_requests;
+}
+
+void RacerConnection::setMaxPendingRequests(unsigned int count)
+{
+	m_max_pending_requests = count;
+}
+
+unsigned int RacerConnection::errorCount() const
+{
+	return m_error_count;
+}
+
+void RacerConnection::resetErrorCount()
+{
+	m_error_count = 0;
+}
+
+RacerConnection::ReplyType RacerConnection::parseReply(const QString& line, QString& result)
+{
+	result.clear();
+	
+	//Split the reply into type, id and the remainder
+	int type_end = line.indexOf(' ');
+	if (type_end == -1)
+	{
+		return InvalidReply;
+	}
+	
+	int id_end = line.indexOf(' ', type_end+1);
+	
+	QString type = line.left(type_end);
+	QString remainder = (id_end == -1) ? QString() : line.mid(id_end+1);
+	
+	if (type == ":ok")
+	{
+		result = remainder;
+		return OkReply;
+	}
+	if (type == ":error")
+	{
+		result = remainder;
+		return ErrorReply;
+	}
+	if (type == ":answer")
+	{
+		//The answer is the first (quoted) string of the remainder
+		if (remainder.startsWith('"'))
 		{
-			if(m_tcpSocket->waitForReadyRead(msecs))
+			for (int i=1; i<remainder.size(); ++i)
 			{
-				QByteArray array = m_tcpSocket->readAll();
-				
-				//qDebug() << QString("Received Data");
-				
-				//try to split answers
-				QStringList lst = QString(array).split(" ");
-				if(lst.size()>= 2 && lst[0] == ":ok")
+				if (remainder[i] == '\\' && i+1 < remainder.size())
 				{
-					//qDebug("Got an ok");
-					
-					QString result = lst[2];
-					for (int i=3; i<lst.size(); ++i)
-					{
-						result += " " + lst[i];
-					}
-					return result;
+					result += remainder[++i];
 				}
-				if(lst.size()>= 2 && lst[0] == ":error")
+				else if (remainder[i] == '"')
 				{
-					qDebug("Got an error");
-					
-					QString result = lst[2];
-					for (int i=3; i<lst.size(); ++i)
-					{
-						result += " " + lst[i];
-					}
-					return result;
+					break;
 				}
-				if(lst.size()>=2 && lst[0] == ":answer")
+				else
 				{
-					qDebug("Got an answer");
-					
-					//unescape strings (seems to be neccessary sometimes...
-					QString s = lst[2];
-					s.replace("\\\"","");
-					if( s != lst[2])
-						
-						//Remove outer "-marks
-						s = s.replace("\"","");
-					
-					return s;
+					result += remainder[i];
 				}
-				else {
-					qDebug() << "Got a strange result:" << QString(array);
-					
-				}
-
 			}
-			else 
-			{
-				qDebug("Timeout: Reading bytes from Racer not successful!");
-			}
-			
 		}
-		else 
+		else
 		{
-			qDebug("Timeout: Sending bytes to Racer not successful!");
+			result = remainder.section(' ', 0, 0);
 		}
+		return AnswerReply;
+	}
+	
+	result = line;
+	return InvalidReply;
+}
 
+unsigned int RacerConnection::readReplies()
+{
+	m_read_buffer.append(m_tcpSocket->readAll());
+	
+	unsigned int count = 0;
+	int line_end;
+	
+	//Each reply of Racer is terminated by a newline
+	while ((line_end = m_read_buffer.indexOf('\n')) != -1)
+	{
+		QString line = QString::fromUtf8(m_read_buffer.constData(), line_end).trimmed();
+		m_read_buffer.remove(0, line_end+1);
+		
+		if (line.isEmpty())
+		{
+			continue;
+		}
+		
+		m_last_reply_type = parseReply(line, m_last_reply);
+		
+		if (m_last_reply_type == ErrorReply || m_last_reply_type == InvalidReply)
+		{
+			qDebug() << "Racer reply:" << line;
+			m_error_count++;
+		}
+		if (m_pending_requests != 0)
+		{
+			m_pending_requests--;
+		}
+		count++;
+	}
+	return count;
+}
+
+bool RacerConnection::waitForReply(int msecs)
+{
+	if (readReplies() != 0)
+	{
+		return true;
+	}
+	
+	//Incomplete replies need more data
+	while (m_tcpSocket->waitForReadyRead(msecs))
+	{
+		if (readReplies() != 0)
+		{
+			return true;
+		}
 	}
-	return "";
+	return false;
 }
 
 const QString & RacerConnection::racerVersion() const
@@ -272,4 +405,71 @@ void RacerConnection::connectActions()
 }
 
 
+
+
+
+RacerAssertionBatch::RacerAssertionBatch(RacerConnection* conn, unsigned int batch_size, QTextStream* stream, int msecs)
+:	m_conn(conn),
+	m_batch_size(std::max(1u, batch_size)),
+	m_stream(stream),
+	m_msecs(msecs),
+	m_batch_count(0),
+	m_assertion_count(0),
+	m_failed(false)
+{
+	m_conn->resetErrorCount();
+}
+
+RacerAssertionBatch::~RacerAssertionBatch()
+{
+	flush();
+}
+
+void RacerAssertionBatch::add(const QString& assertion)
+{
+	if (m_stream)
+	{
+		*m_stream << assertion << "\n";
+	}
+	
+	m_batch += " " + assertion;
+	m_batch_count++;
+	m_assertion_count++;
+	
+	if (m_batch_count >= m_batch_size)
+	{
+		flush();
+	}
+}
+
+bool RacerAssertionBatch::finish()
+{
+	flush();
+	
+	return m_conn->waitForReplies(m_msecs) && !m_failed && m_conn->errorCount() == 0;
+}
+
+unsigned int RacerAssertionBatch::assertionCount() const
+{
+	return m_assertion_count;
+}
+
+void RacerAssertionBatch::flush()
+{
+	if (m_batch_count == 0)
+	{
+		return;
+	}
+	
+	QString request = (m_batch_count == 1) ? m_batch : "(state" + m_batch + ")";
+	
+	if (!m_conn->post(request, m_msecs))
+	{
+		m_failed = true;
+	}
+	
+	m_batch.clear();
+	m_batch_count = 0;
+}
+
 } //end of namespace graipe
@@ -153,6 +153,81 @@ class GRAIPE_RACERCLIENT_EXPORT RacerConnection
          * \return the resulting string as got from the server.
          */
         QString send(const QString& request, int msecs=30000);
+    
+        /**
+         * The type of a reply of the Racer server.
+         */
+        enum ReplyType
+        {
+            OkReply,
+            AnswerReply,
+            ErrorReply,
+            InvalidReply
+        };
+    
+        /**
+         * Sends a request to the Racer server without waiting for its reply (pipelining).
+         * The replies are read and parsed incrementally, whenever new data arrives.
+         * If the maximum count of pending requests is reached, this call blocks until
+         * the oldest request has been answered.
+         *
+         * \param request The request string.
+         * \param msecs Timeout for waiting on a free slot. Defaults to 30.000 msecs (= 30s).
+         * \return False, if the request could not be sent.
+         */
+        bool post(const QString& request, int msecs=30000);
+    
+        /**
+         * Waits until all posted requests have been answered.
+         *
+         * \param msecs Timeout for each arrival of new data. Defaults to 30.000 msecs (= 30s).
+         * \return False, if a timeout or a connection error occured.
+         */
+        bool waitForReplies(int msecs=30000);
+    
+        /**
+         * The count of posted requests, which have not been answered yet.
+         *
+         * \return The count of pending requests.
+         */
+        unsigned int pendingRequests() const;
+    
+        /**
+         * Getter for the maximum count of pending requests.
+         *
+         * \return The maximum count of requests, which may be in flight at once.
+         */
+        unsigned int maxPendingRequests() const;
+    
+        /**
+         * Setter for the maximum count of pending requests.
+         *
+         * \param count The maximum count of requests, which may be in flight at once.
+         */
+        void setMaxPendingRequests(unsigned int count);
+    
+        /**
+         * The count of error or invalid replies to posted requests since the last
+         * call of resetErrorCount().
+         *
+         * \return The count of failed requests.
+         */
+        unsigned int errorCount() const;
+    
+        /**
+         * Resets the count of failed requests.
+         */
+        void resetErrorCount();
+    
+        /**
+         * Parses one reply line of the Racer server, which looks like:
+         * ":answer 1 "result" "warning"", ":ok 1 "warning"" or ":error 1 message".
+         *
+         * \param line The reply line.
+         * \param result Will contain the result of the reply.
+         * \return The type of the reply.
+         */
+        static ReplyType parseReply(const QString& line, QString& result);
 
     protected slots:
         /**
@@ -169,6 +244,21 @@ class GRAIPE_RACERCLIENT_EXPORT RacerConnection
          */
         void connectActions();
     
+        /**
+         * Reads all available data from the socket and parses all complete replies.
+         *
+         * \return The count of parsed replies.
+         */
+        unsigned int readReplies();
+    
+        /**
+         * Waits for new data from the socket and parses all complete replies.
+         *
+         * \param msecs Timeout for the arrival of new data.
+         * \return False, if a timeout or a connection error occured.
+         */
+        bool waitForReply(int msecs);
+    
         /** The used block size **/
         qint16             m_blockSize;
     
@@ -183,6 +273,95 @@ class GRAIPE_RACERCLIENT_EXPORT RacerConnection
     
         /** The port number **/
         int m_port;
+    
+        /** The received data, which does not form a complete reply yet **/
+        QByteArray m_read_buffer;
+    
+        /** The last parsed reply **/
+        QString m_last_reply;
+    
+        /** The type of the last parsed reply **/
+        ReplyType m_last_reply_type;
+    
+        /** The count of posted, unanswered requests **/
+        unsigned int m_pending_requests;
+    
+        /** The maximum count of posted, unanswered requests **/
+        unsigned int m_max_pending_requests;
+    
+        /** The count of error replies to posted requests **/
+        unsigned int m_error_count;
+};
+
+/**
+ * A helper to send many A-Box assertions to the Racer server with few requests.
+ * The assertions are collected and sent in batches by means of Racer's
+ * (state ...) form, which tells all contained assertions at once. The batches 
+ * are posted to the connection, so that several batches are in flight while 
+ * the next one is collected. Optionally, all assertions are written to a stream
+ * (e.g. to save the A-Box to a file).
+ */
+class GRAIPE_RACERCLIENT_EXPORT RacerAssertionBatch
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param conn The (connected) Racer connection.
+         * \param batch_size The count of assertions per request.
+         * \param stream If not NULL, each assertion will also be written to this stream.
+         * \param msecs Timeout for the requests. Defaults to 60.000 msecs (= 1min).
+         */
+        RacerAssertionBatch(RacerConnection* conn, unsigned int batch_size=256, QTextStream* stream=NULL, int msecs=60000);
+    
+        /**
+         * Destructor. Sends the remaining assertions, but does not wait for their replies.
+         */
+        ~RacerAssertionBatch();
+    
+        /**
+         * Adds an assertion. Sends the current batch, if it is full.
+         *
+         * \param assertion The assertion, e.g. "(related a b touches)".
+         */
+        void add(const QString& assertion);
+    
+        /**
+         * Sends the remaining assertions and waits for all replies.
+         *
+         * \return True, if all assertions have been accepted by the server.
+         */
+        bool finish();
+    
+        /**
+         * The count of added assertions.
+         *
+         * \return The count of all added assertions.
+         */
+        unsigned int assertionCount() const;
+    
+    protected:
+        /**
+         * Sends the current batch.
+         */
+        void flush();
+    
+        /** The connection **/
+        RacerConnection* m_conn;
+        /** The count of assertions per request **/
+        unsigned int m_batch_size;
+        /** The stream for the assertions **/
+        QTextStream* m_stream;
+        /** The timeout **/
+        int m_msecs;
+        /** The current batch **/
+        QString m_batch;
+        /** The count of assertions in the current batch **/
+        unsigned int m_batch_count;
+        /** The count of all assertions **/
+        unsigned int m_assertion_count;
+        /** Did any request fail? **/
+        bool m_failed;
 };
 
 /**
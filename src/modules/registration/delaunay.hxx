@@ -68,6 +68,8 @@
 
 #include "vigra/tinyvector.hxx"
 
+#include "registration/delaunaytriangulation.hxx"
+
 namespace graipe {
 
 /**
@@ -614,104 +616,25 @@ class VertexIsInCircumCircle
 };
 
 /**
- * All class definitions above may now be compined to formulate
- * the well known Delaunay triangluation procedure.
+ * Delaunay triangulation of a vector of vertices. Uses the sweep-hull
+ * triangulation engine (see delaunaytriangulation.hxx) and converts its
+ * result into a set of triangles.
  *
  * \param vertices Unconnected vector of vertices/point, which shall be
- *                 Delauny triangulated.
+ *                 Delauny triangulated. They do not need to be sorted.
  * \param output The (final) set of triangles which hold pointers to the input
  *                vertices.
  */
-void delaunay_triangulation(const VertexVector& vertices, TriangleSet& output)
+inline void delaunay_triangulation(const VertexVector& vertices, TriangleSet& output)
 {
-	if (vertices.size() < 3)
+    DelaunayTriangulation triangulation(vertices.begin(), vertices.end());
+    
+    for (unsigned int t=0; t<triangulation.triangleCount(); ++t)
     {
-        return;	// nothing to handle
+        output.insert(Triangle<double>(&vertices[triangulation.vertexIndex(t,0)],
+                                       &vertices[triangulation.vertexIndex(t,1)],
+                                       &vertices[triangulation.vertexIndex(t,2)]));
     }
-	
-    // Determine the bounding box.
-	CVIterator itVertex = vertices.begin();
-
-	float xMin = (*itVertex)[0];
-	float yMin = (*itVertex)[1];
-	float xMax = xMin;
-	float yMax = yMin;
-
-	++itVertex;		// If we're here, we know that vertices is not empty.
-	for (; itVertex != vertices.end(); itVertex++)
-	{
-		xMax = (*itVertex)[0];	// Vertices are sorted along the x-axis, so the last one stored will be the biggest.
-		float y = (*itVertex)[1];
-		if (y < yMin)
-        {
-            yMin = y;
-        }
-		if (y > yMax)
-        {
-            yMax = y;
-        }
-	}
-
-	float dx = xMax - xMin;
-	float dy = yMax - yMin;
-
-	// Make the bounding box slightly bigger, just to feel safe.
-	float ddx = dx * 0.01F;
-	float ddy = dy * 0.01F;
-
-	xMin -= ddx;
-	xMax += ddx;
-	dx += 2 * ddx;
-
-	yMin -= ddy;
-	yMax += ddy;
-	dy += 2 * ddy;
-
-	// Create a 'super triangle', encompassing all the vertices. We choose an equilateral triangle with horizontal base.
-	// We could have made the 'super triangle' simply very big. However, the algorithm is quite sensitive to
-	// rounding errors, so it's better to make the 'super triangle' just big enough, like we do here.
-	Vertex vSuper[3];
-    
-    float dMax = (dx > dy) ? dx : dy; 
-    float xMid = (xMax + xMin) / 2.0;
-    float yMid = (yMax + yMin) / 2.0; 
-    
-    vSuper[0] = Vertex(xMid - 20 * dMax, yMid - dMax); 
-    vSuper[1] = Vertex(xMid, yMid + 20 * dMax); 
-    vSuper[2] = Vertex(xMid + 20 * dMax,yMid - dMax);
-	
-    TriangleSet workset;
-	workset.insert(Triangle<>(vSuper));
-
-	for (itVertex = vertices.begin(); itVertex != vertices.end(); itVertex++)
-	{
-		// First, remove all 'completed' triangles from the workset.
-		// A triangle is 'completed' if its circumcircle is entirely to the left of the current vertex.
-		// Vertices are sorted in x-direction (the set container does this automagically).
-		// Unless they are part of the 'super triangle', copy the 'completed' triangles to the output.
-		// The algorithm also works without this step, but it is an important optimalization for bigger numbers of vertices.
-		// It makes the algorithm about five times faster for 2000 vertices, and for 10000 vertices,
-		// it's thirty times faster. For smaller numbers, the difference is negligible.
-		TIterator itEnd = remove_if(workset.begin(), workset.end(), TriangleIsCompleted(itVertex, output, vSuper));
-
-		EdgeSet edges;
-
-		// A triangle is 'hot' if the current vertex v is inside the circumcircle.
-		// Remove all hot triangles, but keep their edges.
-		itEnd = remove_if(workset.begin(), itEnd, VertexIsInCircumCircle(itVertex, edges));
-		workset.erase(itEnd, workset.end());	// remove_if doesn't actually remove; we have to do this explicitly.
-
-		// Create new triangles from the edges and the current vertex.
-		for (EdgeIterator it = edges.begin(); it != edges.end(); it++)
-        {
-			workset.insert(Triangle<>(it->v0(), it->v1(), & (* itVertex)));
-        }
-	}
-
-	// Finally, remove all the triangles belonging to the 'super triangle' and move the remaining
-	// triangles tot the output; remove_copy_if lets us do that in one go.
-	TIterator where = output.begin();
-	remove_copy_if(workset.begin(), workset.end(), std::inserter(output, where), TriangleHasVertex(vSuper));
 }
 
 /**
@@ -0,0 +1,1002 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_REGISTRATION_DELAUNAYTRIANGULATION_HXX
+#define GRAIPE_REGISTRATION_DELAUNAYTRIANGULATION_HXX
+
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "vigra/tinyvector.hxx"
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_registration
+ * @{
+ *
+ * @file
+ * @brief Header file for the sweep-hull Delaunay triangulation engine
+ */
+
+namespace detail
+{
+    /**
+     * Error-free transformation of a sum: a+b = x+y, where x = fl(a+b).
+     */
+    inline void twoSum(double a, double b, double& x, double& y)
+    {
+        x = a + b;
+        double b_virt = x - a;
+        double a_virt = x - b_virt;
+        y = (a - a_virt) + (b - b_virt);
+    }
+
+    /**
+     * Error-free transformation of a product: a*b = x+y, where x = fl(a*b).
+     */
+    inline void twoProduct(double a, double b, double& x, double& y)
+    {
+        x = a*b;
+        y = std::fma(a, b, -x);
+    }
+
+    /**
+     * Computes the exact sign of a sum of (at most 16) doubles by growing
+     * a non-overlapping floating point expansion (Shewchuk).
+     *
+     * \param terms The summands.
+     * \param n The number of summands.
+     * \return -1, 0 or 1, according to the sign of the exact sum.
+     */
+    inline int exactSumSign(const double* terms, unsigned int n)
+    {
+        double e[16];
+        unsigned int m = 0;
+        
+        for (unsigned int i=0; i<n; ++i)
+        {
+            double q = terms[i], h;
+            unsigned int k = 0;
+            
+            for (unsigned int j=0; j<m; ++j)
+            {
+                twoSum(q, e[j], q, h);
+                if (h != 0.0)
+                {
+                    e[k++] = h;
+                }
+            }
+            if (q != 0.0)
+            {
+                e[k++] = q;
+            }
+            m = k;
+        }
+        return (m == 0) ? 0 : ((e[m-1] > 0) ? 1 : -1);
+    }
+}
+
+/**
+ * Robust orientation predicate. The floating point determinant is used, whenever
+ * its sign is certain. Otherwise, the sign is computed exactly.
+ *
+ * \param a The first point.
+ * \param b The second point.
+ * \param c The third point.
+ * \return A positive value if a, b, c are in counterclockwise order, a negative
+ *         value if they are in clockwise order and zero if they are collinear.
+ */
+inline double orient2D(const vigra::TinyVector<double,2>& a,
+                       const vigra::TinyVector<double,2>& b,
+                       const vigra::TinyVector<double,2>& c)
+{
+    double det_left  = (a[0]-c[0])*(b[1]-c[1]);
+    double det_right = (a[1]-c[1])*(b[0]-c[0]);
+    double det = det_left - det_right;
+    double det_sum;
+    
+    if (det_left > 0)
+    {
+        if (det_right <= 0)
+            return det;
+        det_sum = det_left + det_right;
+    }
+    else if (det_left < 0)
+    {
+        if (det_right >= 0)
+            return det;
+        det_sum = -det_left - det_right;
+    }
+    else
+    {
+        return det;
+    }
+    
+    const double eps = std::numeric_limits<double>::epsilon()/2;
+    const double err_bound = (3.0 + 16.0*eps)*eps*det_sum;
+    
+    if (det >= err_bound || -det >= err_bound)
+    {
+        return det;
+    }
+    
+    //Exact evaluation of: ax*by - ax*cy - cx*by - ay*bx + ay*cx + cy*bx
+    double terms[12];
+    detail::twoProduct( a[0], b[1], terms[0],  terms[1]);
+    detail::twoProduct(-a[0], c[1], terms[2],  terms[3]);
+    detail::twoProduct(-c[0], b[1], terms[4],  terms[5]);
+    detail::twoProduct(-a[1], b[0], terms[6],  terms[7]);
+    detail::twoProduct( a[1], c[0], terms[8],  terms[9]);
+    detail::twoProduct( c[1], b[0], terms[10], terms[11]);
+    
+    return detail::exactSumSign(terms, 12);
+}
+
+/**
+ * Filtered incircle predicate. If the sign of the floating point determinant
+ * cannot be guaranteed, zero (cocircular) is returned, which keeps the current
+ * edge during Delaunay legalization. The topology of the triangulation does
+ * only depend on the (exact) orientation predicate.
+ *
+ * \param a The first point of a counterclockwise triangle.
+ * \param b The second point of a counterclockwise triangle.
+ * \param c The third point of a counterclockwise triangle.
+ * \param d The point to test.
+ * \return A positive value if d lies inside the circumcircle of a, b, c,
+ *         a negative value if it lies outside and zero if this is uncertain.
+ */
+inline double inCircle(const vigra::TinyVector<double,2>& a,
+                       const vigra::TinyVector<double,2>& b,
+                       const vigra::TinyVector<double,2>& c,
+                       const vigra::TinyVector<double,2>& d)
+{
+    double adx = a[0]-d[0], ady = a[1]-d[1],
+           bdx = b[0]-d[0], bdy = b[1]-d[1],
+           cdx = c[0]-d[0], cdy = c[1]-d[1];
+    
+    double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy, a_lift = adx*adx + ady*ady;
+    double cdxady = cdx*ady, adxcdy = adx*cdy, b_lift = bdx*bdx + bdy*bdy;
+    double adxbdy = adx*bdy, bdxady = bdx*ady, c_lift = cdx*cdx + cdy*cdy;
+    
+    double det =  a_lift*(bdxcdy - cdxbdy)
+                + b_lift*(cdxady - adxcdy)
+                + c_lift*(adxbdy - bdxady);
+    
+    double permanent =  (std::abs(bdxcdy) + std::abs(cdxbdy))*a_lift
+                      + (std::abs(cdxady) + std::abs(adxcdy))*b_lift
+                      + (std::abs(adxbdy) + std::abs(bdxady))*c_lift;
+    
+    const double eps = std::numeric_limits<double>::epsilon()/2;
+    const double err_bound = (10.0 + 96.0*eps)*eps*permanent;
+    
+    if (det > err_bound || -det > err_bound)
+    {
+        return det;
+    }
+    return 0.0;
+}
+
+
+
+
+/**
+ * A Delaunay triangulation engine, which uses the sweep-hull approach:
+ * The points are inserted in order of their distance to the circumcenter of a
+ * seed triangle, always connecting them to the visible part of the convex hull
+ * and legalizing the new edges by flipping afterwards. This results in an
+ * O(n log n) runtime.
+ *
+ * The triangulation is stored in flat arrays: Three vertex indices per triangle
+ * and one opposite half-edge index per triangle edge (-1 on the convex hull).
+ * Half-edge e belongs to triangle e/3 and runs from vertex triangles()[e] to the
+ * next vertex of that triangle. All triangles are oriented counterclockwise
+ * (w.r.t. a right handed coordinate system).
+ *
+ * Vertex indices refer to the order of the points given at construction. Exact
+ * duplicates of points are not part of the triangulation.
+ */
+class DelaunayTriangulation
+{
+    public:
+        /** The used point type **/
+        typedef vigra::TinyVector<double,2> PointType;
+    
+        /**
+         * Default constructor. Creates an empty triangulation.
+         */
+        DelaunayTriangulation()
+        : m_hull_start(-1)
+        {
+        }
+    
+        /**
+         * Constructor from a range of points. Points need to support the
+         * operator[] for their x- and y-coordinate.
+         *
+         * \param begin The begin() iterator of the points.
+         * \param end The end() iterator of the points.
+         */
+        template <class PointIterator>
+        DelaunayTriangulation(PointIterator begin, PointIterator end)
+        : m_hull_start(-1)
+        {
+            triangulate(begin, end);
+        }
+    
+        /**
+         * Replaces the points by the given ones and triangulates them.
+         *
+         * \param begin The begin() iterator of the points.
+         * \param end The end() iterator of the points.
+         */
+        template <class PointIterator>
+        void triangulate(PointIterator begin, PointIterator end)
+        {
+            m_points.clear();
+            
+            for (; begin!=end; ++begin)
+            {
+                m_points.push_back(PointType((*begin)[0], (*begin)[1]));
+            }
+            triangulate();
+        }
+    
+        /**
+         * The points of this triangulation.
+         *
+         * \return A const reference to all points.
+         */
+        const std::vector<PointType>& points() const
+        {
+            return m_points;
+        }
+    
+        /**
+         * The number of triangles of this triangulation.
+         *
+         * \return The triangle count.
+         */
+        unsigned int triangleCount() const
+        {
+            return (unsigned int)(m_triangles.size()/3);
+        }
+    
+        /**
+         * The point index of a vertex of a triangle.
+         *
+         * \param t The index of the triangle.
+         * \param i The vertex of the triangle (0, 1 or 2).
+         * \return The index of the vertex's point.
+         */
+        unsigned int vertexIndex(unsigned int t, unsigned int i) const
+        {
+            return m_triangles[3*t+i];
+        }
+    
+        /**
+         * The point of a vertex of a triangle.
+         *
+         * \param t The index of the triangle.
+         * \param i The vertex of the triangle (0, 1 or 2).
+         * \return The vertex's point.
+         */
+        const PointType& vertex(unsigned int t, unsigned int i) const
+        {
+            return m_points[m_triangles[3*t+i]];
+        }
+    
+        /**
+         * The flat triangle vertex indices array.
+         *
+         * \return Three point indices per triangle.
+         */
+        const std::vector<unsigned int>& triangles() const
+        {
+            return m_triangles;
+        }
+    
+        /**
+         * The flat half-edge adjacency array.
+         *
+         * \return The opposite half-edge for each half-edge, or -1 at the convex hull.
+         */
+        const std::vector<int>& halfedges() const
+        {
+            return m_halfedges;
+        }
+    
+        /**
+         * The convex hull of the triangulation.
+         *
+         * \return The point indices of the convex hull in counterclockwise order.
+         */
+        std::vector<unsigned int> hull() const
+        {
+            std::vector<unsigned int> result;
+            
+            if (m_hull_start != -1)
+            {
+                int e = m_hull_start;
+                do
+                {
+                    result.push_back(e);
+                    e = m_hull_next[e];
+                }
+                while (e != m_hull_start);
+            }
+            return result;
+        }
+    
+        /**
+         * Tests if a point is inside (or on the border of) a triangle.
+         *
+         * \param t The index of the triangle.
+         * \param p The point.
+         * \return True, if p is inside the triangle t.
+         */
+        bool isInside(unsigned int t, const PointType& p) const
+        {
+            for (unsigned int e=3*t; e<3*t+3; ++e)
+            {
+                if (orient2D(m_points[m_triangles[e]], m_points[m_triangles[nextHalfedge(e)]], p) < 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    
+        /**
+         * Finds the triangle, which contains a given point by walking
+         * through the triangulation.
+         *
+         * \param p The point.
+         * \param hint The triangle to start the walk at. Passing the last result
+         *             makes coherent queries (almost) constant in time.
+         * \return The index of the triangle containing p or -1, if p is outside
+         *         of the convex hull.
+         */
+        int findTriangle(const PointType& p, int hint = -1) const
+        {
+            unsigned int triangle_count = triangleCount();
+            
+            if (triangle_count == 0)
+            {
+                return -1;
+            }
+            
+            int t = (hint >= 0 && hint < (int)triangle_count) ? hint : 0;
+            
+            for (unsigned int steps=0; steps<=triangle_count; ++steps)
+            {
+                int crossed = -1;
+                
+                for (int e=3*t; e<3*t+3; ++e)
+                {
+                    if (orient2D(m_points[m_triangles[e]], m_points[m_triangles[nextHalfedge(e)]], p) < 0)
+                    {
+                        crossed = e;
+                        break;
+                    }
+                }
+                
+                if (crossed == -1)
+                {
+                    return t;
+                }
+                if (m_halfedges[crossed] == -1)
+                {
+                    return -1;
+                }
+                t = m_halfedges[crossed]/3;
+            }
+            
+            //Should not happen for Delaunay triangulations - fall back to linear search
+            for (unsigned int i=0; i<triangle_count; ++i)
+            {
+                if (isInside(i, p))
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+    
+    private:
+        /**
+         * The next half-edge of the same triangle.
+         */
+        static int nextHalfedge(int e)
+        {
+            return (e % 3 == 2) ? e - 2 : e + 1;
+        }
+    
+        /**
+         * The previous half-edge of the same triangle.
+         */
+        static int prevHalfedge(int e)
+        {
+            return (e % 3 == 0) ? e + 2 : e - 1;
+        }
+    
+        /**
+         * Squared euclidean distance of two points.
+         */
+        static double squaredDistance(const PointType& p1, const PointType& p2)
+        {
+            double dx = p1[0]-p2[0], dy = p1[1]-p2[1];
+            return dx*dx + dy*dy;
+        }
+    
+        /**
+         * The circumcenter of three points relative to the first one.
+         */
+        static PointType relativeCircumcenter(const PointType& a, const PointType& b, const PointType& c)
+        {
+            double dx = b[0]-a[0], dy = b[1]-a[1],
+                   ex = c[0]-a[0], ey = c[1]-a[1];
+            double bl = dx*dx + dy*dy,
+                   cl = ex*ex + ey*ey;
+            double d = 0.5/(dx*ey - dy*ex);
+            
+            return PointType((ey*bl - dy*cl)*d, (dx*cl - ex*bl)*d);
+        }
+    
+        /**
+         * Monotonic pseudo angle of a vector in [0,1).
+         */
+        static double pseudoAngle(double dx, double dy)
+        {
+            double p = dx/(std::abs(dx) + std::abs(dy));
+            return ((dy > 0) ? 3.0 - p : 1.0 + p)/4.0;
+        }
+    
+        /**
+         * The hull hash bucket of a point.
+         */
+        unsigned int hashKey(const PointType& p) const
+        {
+            double angle = pseudoAngle(p[0]-m_center[0], p[1]-m_center[1]);
+            if (!(angle == angle))
+            {
+                angle = 0;
+            }
+            return ((unsigned int)std::floor(angle*m_hull_hash.size())) % m_hull_hash.size();
+        }
+    
+        /**
+         * Links two half-edges as opposite ones.
+         */
+        void link(int a, int b)
+        {
+            m_halfedges[a] = b;
+            if (b != -1)
+            {
+                m_halfedges[b] = a;
+            }
+        }
+    
+        /**
+         * Adds a triangle and links its half-edges to the given opposite ones.
+         */
+        int addTriangle(unsigned int i0, unsigned int i1, unsigned int i2, int a, int b, int c)
+        {
+            int t = (int)m_triangles.size();
+            
+            m_triangles.push_back(i0);
+            m_triangles.push_back(i1);
+            m_triangles.push_back(i2);
+            m_halfedges.resize(t+3, -1);
+            
+            link(t,   a);
+            link(t+1, b);
+            link(t+2, c);
+            
+            return t;
+        }
+    
+        /**
+         * Restores the Delaunay property by recursively flipping edges, which are
+         * opposite to the last inserted point. Hull half-edges, which are moved
+         * by a flip, are updated in the hull index.
+         *
+         * \param a The half-edge to start with.
+         */
+        void legalize(int a)
+        {
+            m_edge_stack.clear();
+            m_edge_stack.push_back(a);
+            
+            while (!m_edge_stack.empty())
+            {
+                a = m_edge_stack.back();
+                m_edge_stack.pop_back();
+                
+                int b = m_halfedges[a];
+                
+                if (b == -1)
+                {
+                    continue;
+                }
+                
+                int an = nextHalfedge(a), ap = prevHalfedge(a),
+                    bn = nextHalfedge(b), bp = prevHalfedge(b);
+                
+                unsigned int p0 = m_triangles[a],  p1 = m_triangles[an],
+                             pa = m_triangles[ap], pb = m_triangles[bp];
+                
+                if (inCircle(m_points[p0], m_points[p1], m_points[pa], m_points[pb]) <= 0)
+                {
+                    continue;
+                }
+                
+                //Flip: (p0,p1,pa),(p1,p0,pb) -> (p0,pb,pa),(p1,pa,pb)
+                int han = m_halfedges[an], hbn = m_halfedges[bn];
+                
+                m_triangles[an] = pb;
+                m_triangles[bn] = pa;
+                
+                link(a, hbn);
+                if (hbn == -1)
+                {
+                    m_hull_tri[p0] = a;
+                }
+                link(b, han);
+                if (han == -1)
+                {
+                    m_hull_tri[p1] = b;
+                }
+                link(an, bn);
+                
+                m_edge_stack.push_back(a);
+                m_edge_stack.push_back(bp);
+            }
+        }
+    
+        /**
+         * Inserts a point, which lies exactly on a convex hull edge, by splitting
+         * the triangle at that edge.
+         *
+         * \param i The index of the point.
+         * \return True, if the point was inserted, false if it coincides with a hull vertex.
+         */
+        bool insertOnHullEdge(unsigned int i)
+        {
+            const PointType& p = m_points[i];
+            int e = m_hull_start;
+            
+            do
+            {
+                int q = m_hull_next[e];
+                const PointType& pe = m_points[e];
+                const PointType& pq = m_points[q];
+                
+                if (orient2D(pe, pq, p) == 0
+                    && dot(p-pe, pq-pe) > 0
+                    && dot(p-pq, pe-pq) > 0)
+                {
+                    int h  = m_hull_tri[e],
+                        hn = nextHalfedge(h),
+                        hp = prevHalfedge(h);
+                    
+                    unsigned int r = m_triangles[hp];
+                    int outer = m_halfedges[hn];
+                    
+                    //(e,q,r) -> (e,i,r),(i,q,r)
+                    m_triangles[hn] = i;
+                    int t = addTriangle(i, q, r, -1, outer, hn);
+                    
+                    if (outer == -1)
+                    {
+                        m_hull_tri[q] = t+1;
+                    }
+                    m_hull_tri[e] = h;
+                    m_hull_tri[i] = t;
+                    
+                    m_hull_next[e] = i; m_hull_prev[i] = e;
+                    m_hull_next[i] = q; m_hull_prev[q] = i;
+                    m_hull_hash[hashKey(p)] = i;
+                    
+                    legalize(hp);
+                    legalize(t+1);
+                    return true;
+                }
+                e = q;
+            }
+            while (e != m_hull_start);
+            
+            return false;
+        }
+    
+        /**
+         * Triangulates the current points.
+         */
+        void triangulate()
+        {
+            m_triangles.clear();
+            m_halfedges.clear();
+            m_hull_start = -1;
+            
+            const unsigned int n = (unsigned int)m_points.size();
+            const double inf = std::numeric_limits<double>::infinity();
+            
+            if (n < 3)
+            {
+                return;
+            }
+            
+            //Find the seed triangle near the center of the bounding box
+            PointType min_p = m_points[0], max_p = m_points[0];
+            
+            for (unsigned int i=1; i<n; ++i)
+            {
+                min_p = vigra::min(min_p, m_points[i]);
+                max_p = vigra::max(max_p, m_points[i]);
+            }
+            m_center = (min_p + max_p)/2.0;
+            
+            unsigned int i0 = 0, i1 = 0, i2 = 0;
+            double min_dist = inf;
+            
+            for (unsigned int i=0; i<n; ++i)
+            {
+                double d = squaredDistance(m_center, m_points[i]);
+                if (d < min_dist)
+                {
+                    i0 = i;
+                    min_dist = d;
+                }
+            }
+            
+            min_dist = inf;
+            for (unsigned int i=0; i<n; ++i)
+            {
+                double d = squaredDistance(m_points[i0], m_points[i]);
+                if (d < min_dist && d > 0)
+                {
+                    i1 = i;
+                    min_dist = d;
+                }
+            }
+            if (min_dist == inf)
+            {
+                return;
+            }
+            
+            double min_radius = inf;
+            for (unsigned int i=0; i<n; ++i)
+            {
+                if (orient2D(m_points[i0], m_points[i1], m_points[i]) == 0)
+                {
+                    continue;
+                }
+                
+                double r = squaredNorm(relativeCircumcenter(m_points[i0], m_points[i1], m_points[i]));
+                if (r < min_radius)
+                {
+                    i2 = i;
+                    min_radius = r;
+                }
+            }
+            if (min_radius == inf)
+            {
+                //All points are collinear
+                return;
+            }
+            
+            if (orient2D(m_points[i0], m_points[i1], m_points[i2]) < 0)
+            {
+                std::swap(i1, i2);
+            }
+            m_center = m_points[i0] + relativeCircumcenter(m_points[i0], m_points[i1], m_points[i2]);
+            
+            //Sort the points by their distance to the seed circumcenter
+            std::vector<double> dists(n);
+            std::vector<unsigned int> ids(n);
+            
+            for (unsigned int i=0; i<n; ++i)
+            {
+                ids[i] = i;
+                dists[i] = squaredDistance(m_center, m_points[i]);
+            }
+            
+            const std::vector<PointType>& points = m_points;
+            std::sort(ids.begin(), ids.end(),
+                      [&dists, &points](unsigned int a, unsigned int b)
+                      {
+                          if (dists[a] != dists[b])
+                              return dists[a] < dists[b];
+                          if (points[a][0] != points[b][0])
+                              return points[a][0] < points[b][0];
+                          if (points[a][1] != points[b][1])
+                              return points[a][1] < points[b][1];
+                          return a < b;
+                      });
+            
+            //Initialize the hull by means of the seed triangle
+            m_hull_prev.assign(n, -1);
+            m_hull_next.assign(n, -1);
+            m_hull_tri.assign(n, -1);
+            m_hull_hash.assign((unsigned int)std::ceil(std::sqrt((double)n)), -1);
+            
+            m_hull_start = i0;
+            m_hull_next[i0] = i1; m_hull_prev[i2] = i1;
+            m_hull_next[i1] = i2; m_hull_prev[i0] = i2;
+            m_hull_next[i2] = i0; m_hull_prev[i1] = i0;
+            
+            m_hull_tri[i0] = 0;
+            m_hull_tri[i1] = 1;
+            m_hull_tri[i2] = 2;
+            
+            m_hull_hash[hashKey(m_points[i0])] = i0;
+            m_hull_hash[hashKey(m_points[i1])] = i1;
+            m_hull_hash[hashKey(m_points[i2])] = i2;
+            
+            m_triangles.reserve(3*(2*n-5));
+            m_halfedges.reserve(3*(2*n-5));
+            addTriangle(i0, i1, i2, -1, -1, -1);
+            
+            for (unsigned int k=0; k<n; ++k)
+            {
+                const unsigned int i = ids[k];
+                const PointType& p = m_points[i];
+                
+                //Skip seed points and exact duplicates (which are adjacent after sorting)
+                if (i == i0 || i == i1 || i == i2
+                    || (k > 0 && p == m_points[ids[k-1]]))
+                {
+                    continue;
+                }
+                
+                //Find a visible edge on the hull using the angular hash
+                int start = -1;
+                unsigned int key = hashKey(p);
+                
+                for (unsigned int j=0; j<m_hull_hash.size(); ++j)
+                {
+                    start = m_hull_hash[(key + j) % m_hull_hash.size()];
+                    if (start != -1 && start != m_hull_next[start])
+                    {
+                        break;
+                    }
+                }
+                if (start == -1 || start == m_hull_next[start])
+                {
+                    start = m_hull_start;
+                }
+                start = m_hull_prev[start];
+                
+                int e = start, q;
+                
+                while (q = m_hull_next[e], orient2D(m_points[e], m_points[q], p) >= 0)
+                {
+                    e = q;
+                    if (e == start)
+                    {
+                        e = -1;
+                        break;
+                    }
+                }
+                
+                if (e == -1)
+                {
+                    //No edge is strictly visible: p lies on the hull
+                    insertOnHullEdge(i);
+                    continue;
+                }
+                
+                //Add the first triangle from the point
+                int t = addTriangle(e, i, m_hull_next[e], -1, -1, m_hull_tri[e]);
+                m_hull_tri[e] = t;
+                m_hull_tri[i] = t+1;
+                legalize(t+2);
+                
+                //Walk forward through the hull, adding more triangles
+                int n_e = m_hull_next[e];
+                
+                while (q = m_hull_next[n_e], orient2D(m_points[n_e], m_points[q], p) < 0)
+                {
+                    t = addTriangle(n_e, i, q, m_hull_tri[i], -1, m_hull_tri[n_e]);
+                    m_hull_tri[i] = t+1;
+                    legalize(t+2);
+                    
+                    m_hull_next[n_e] = n_e; //mark as removed
+                    n_e = q;
+                }
+                
+                //Walk backward from the other side, adding more triangles
+                if (e == start)
+                {
+                    while (q = m_hull_prev[e], orient2D(m_points[q], m_points[e], p) < 0)
+                    {
+                        t = addTriangle(q, i, e, -1, m_hull_tri[e], m_hull_tri[q]);
+                        m_hull_tri[q] = t;
+                        legalize(t+2);
+                        
+                        m_hull_next[e] = e; //mark as removed
+                        e = q;
+                    }
+                }
+                
+                //Update the hull
+                m_hull_start = m_hull_prev[i] = e;
+                m_hull_next[e] = m_hull_prev[n_e] = i;
+                m_hull_next[i] = n_e;
+                
+                m_hull_hash[hashKey(p)] = i;
+                m_hull_hash[hashKey(m_points[e])] = e;
+            }
+            
+            m_edge_stack.clear();
+            m_hull_hash.clear();
+            m_hull_tri.clear();
+        }
+    
+        /** The points **/
+        std::vector<PointType> m_points;
+        /** Three point indices per triangle **/
+        std::vector<unsigned int> m_triangles;
+        /** Opposite half-edge of each half-edge, -1 at the hull **/
+        std::vector<int> m_halfedges;
+    
+        /** The hull as a doubly linked list over the point indices **/
+        std::vector<int> m_hull_prev, m_hull_next;
+        /** The first hull point **/
+        int m_hull_start;
+    
+        /** Temporary data during triangulation: The hull half-edge starting at each hull point **/
+        std::vector<int> m_hull_tri;
+        /** Temporary data during triangulation: The angular hash of the hull points **/
+        std::vector<int> m_hull_hash;
+        /** Temporary data during triangulation: The sweep center **/
+        PointType m_center;
+        /** Temporary data during triangulation: The legalization stack **/
+        std::vector<int> m_edge_stack;
+};
+
+
+
+
+/**
+ * A small, thread-safe cache for Delaunay triangulations. Since a triangulation
+ * only depends on its points, the points themselves are used as the cache key:
+ * Triangulating the same (e.g. vectorfield) points again returns the cached
+ * result, while any change of the points leads to a new triangulation.
+ * The least recently used triangulations are dropped first.
+ */
+class DelaunayTriangulationCache
+{
+    public:
+        /** The used point type **/
+        typedef DelaunayTriangulation::PointType PointType;
+    
+        /**
+         * Constructor of the cache.
+         *
+         * \param capacity The maximum number of cached triangulations.
+         */
+        DelaunayTriangulationCache(unsigned int capacity = 4)
+        : m_capacity(capacity)
+        {
+        }
+    
+        /**
+         * Returns the Delaunay triangulation of the given points, either
+         * from the cache or newly computed.
+         *
+         * \param begin The begin() iterator of the points.
+         * \param end The end() iterator of the points.
+         * \return The Delaunay triangulation of these points.
+         */
+        template <class PointIterator>
+        DelaunayTriangulation triangulation(PointIterator begin, PointIterator end)
+        {
+            std::vector<PointType> points;
+            
+            for (; begin!=end; ++begin)
+            {
+                points.push_back(PointType((*begin)[0], (*begin)[1]));
+            }
+            
+            {
+                QMutexLocker lock(&m_mutex);
+                
+                for (std::list<DelaunayTriangulation>::iterator iter=m_entries.begin(); iter!=m_entries.end(); ++iter)
+                {
+                    if (iter->points() == points)
+                    {
+                        m_entries.splice(m_entries.begin(), m_entries, iter);
+                        return m_entries.front();
+                    }
+                }
+            }
+            
+            //Triangulate without blocking other users of the cache
+            DelaunayTriangulation result(points.begin(), points.end());
+            
+            QMutexLocker lock(&m_mutex);
+            
+            m_entries.push_front(result);
+            while (m_entries.size() > m_capacity)
+            {
+                m_entries.pop_back();
+            }
+            return result;
+        }
+    
+        /**
+         * Removes all cached triangulations.
+         */
+        void clear()
+        {
+            QMutexLocker lock(&m_mutex);
+            m_entries.clear();
+        }
+    
+    private:
+        /** The cached triangulations, most recently used first **/
+        std::list<DelaunayTriangulation> m_entries;
+        /** The maximum number of cached triangulations **/
+        unsigned int m_capacity;
+        /** The mutex to guard the cache **/
+        QMutex m_mutex;
+};
+
+/**
+ * Access to the global triangulation cache of the registration module.
+ *
+ * \return A reference to the cache.
+ */
+inline DelaunayTriangulationCache& delaunayTriangulationCache()
+{
+    static DelaunayTriangulationCache cache;
+    return cache;
+}
+
+/**
+ * @}
+ */
+
+} //namespace graipe
+
+#endif //GRAIPE_REGISTRATION_DELAUNAYTRIANGULATION_HXX
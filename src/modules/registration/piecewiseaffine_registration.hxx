@@ -48,7 +48,11 @@
 #include <vigra/tinyvector.hxx>
 #include <vigra/splineimageview.hxx>
 
+#include <algorithm>
+#include <cmath>
+
 #include "registration/delaunay.hxx"
+#include "registration/delaunaytriangulation.hxx"
 
 namespace graipe {
 
@@ -63,8 +67,8 @@ namespace graipe {
 /** The used type for points **/
 typedef Vertex PointType;
 
-/** The used type for triangles **/
-typedef Triangle<double> TriangleType;
+/** The used type for triangles: The three (target) vertices **/
+typedef vigra::TinyVector<PointType,3> TriangleType;
 
 /** The used triangle transformation type **/
 typedef std::pair<TriangleType, vigra::Matrix<double> > TriangleTransformationType;
@@ -72,54 +76,66 @@ typedef std::pair<TriangleType, vigra::Matrix<double> > TriangleTransformationTy
 
 /**
  * This function computes the piecewise affine transmations for a set of points
- * It first Delaunay triangluates the source points and uses the same triangle structure on
- * source and target points. 
- * For each of the triangles, it computes the affine matrix.
+ * given an existing Delaunay triangulation of the source points. The same
+ * triangle structure is used on source and target points.
+ * For each of the triangles, it computes the affine matrix, which maps
+ * the target triangle onto the source triangle.
  *
- * \param s     The begin() iterator of the source points.
- * \param s_end The end() iterator of the source points.
+ * \param triangulation The Delaunay triangulation of the source points.
+ * \param s    The begin() iterator of the source points.
  * \param d    The begin() iterator of the corresponding dest points.
- * \return A Vector containing pairs of triangles and affine transformation matrices.
+ * \return A Vector containing pairs of (target) triangles and affine transformation matrices.
  */
 template <class SrcPointIterator, class DestPointIterator>
-std::vector<TriangleTransformationType> computePiecewiseAffineTransformations(SrcPointIterator s, SrcPointIterator s_end, DestPointIterator d)
+std::vector<TriangleTransformationType> computePiecewiseAffineTransformations(const DelaunayTriangulation & triangulation,
+                                                                              SrcPointIterator s, DestPointIterator d)
 {
-    unsigned int point_count = (unsigned int)(s_end - s);
-    
-    VertexVector vertices(point_count);
-    TriangleSet triangles;
-    
-    unsigned int i=0;
-    
-    for (i=0; i<point_count;++i)
-    {
-        vertices[i] = Vertex((float)s[i][0], (float)s[i][1]);
-    }
-    
-    delaunay_triangulation(vertices, triangles);
-    
     std::vector<PointType> s_points(3), d_points(3);
     
     std::vector<TriangleTransformationType> result;
+    result.reserve(triangulation.triangleCount());
     
-	for (TriangleSet::iterator iter = triangles.begin(); iter!=triangles.end(); iter++) 
+    for (unsigned int t=0; t<triangulation.triangleCount(); ++t)
     {
+        TriangleType triangle;
+        
         for(unsigned int i=0; i<3; ++i)
         {
-            unsigned long idx = iter->vertex(i) - vertices.data();
-            s_points[i] = s[idx];
-            s_points[i] = d[idx];
+            unsigned int idx = triangulation.vertexIndex(t,i);
+            s_points[i] = PointType(s[idx][0], s[idx][1]);
+            d_points[i] = PointType(d[idx][0], d[idx][1]);
+            triangle[i] = d_points[i];
         }
-        result.push_back(TriangleTransformationType(*iter,
+        result.push_back(TriangleTransformationType(triangle,
                                                     vigra::affineMatrix2DFromCorrespondingPoints(d_points.begin(), d_points.end(), s_points.begin())));
     }
     
     return result;
 }
 
+/**
+ * This function computes the piecewise affine transmations for a set of points
+ * It first Delaunay triangluates the source points and uses the same triangle structure on
+ * source and target points. The triangulation is taken from the module's triangulation
+ * cache, thus it is only computed once for the same source points.
+ * For each of the triangles, it computes the affine matrix.
+ *
+ * \param s     The begin() iterator of the source points.
+ * \param s_end The end() iterator of the source points.
+ * \param d    The begin() iterator of the corresponding dest points.
+ * \return A Vector containing pairs of (target) triangles and affine transformation matrices.
+ */
+template <class SrcPointIterator, class DestPointIterator>
+std::vector<TriangleTransformationType> computePiecewiseAffineTransformations(SrcPointIterator s, SrcPointIterator s_end, DestPointIterator d)
+{
+    return computePiecewiseAffineTransformations(delaunayTriangulationCache().triangulation(s, s_end), s, d);
+}
+
 /**
  * Given a piecewise affine transformation structure as returned by computePiecewiseAffineTransformations
- * this function returns the transformed image.
+ * this function returns the transformed image. Each triangle is rasterized over
+ * its bounding box, so that every pixel is only tested against the triangles
+ * which may cover it.
  * 
  * \param src The source image.
  * \param dest The destination image.
@@ -129,16 +145,42 @@ template <int ORDER, class T1, class T2>
 void piecewiseAffineWarpImage(vigra::SplineImageView<ORDER, T1> const & src, vigra::MultiArrayView<2,T2> dest,
                               const std::vector<TriangleTransformationType> & tri_trans)
 {
-
-    for(unsigned int y = 0; y<dest.height(); ++y)
+    for(std::vector<TriangleTransformationType>::const_iterator iter=tri_trans.begin(); iter!=tri_trans.end(); ++iter)
     {
-        for(unsigned int x=0; x<dest.width(); ++x)
+        const TriangleType& tri = iter->first;
+        
+        double orientation = orient2D(tri[0], tri[1], tri[2]);
+        
+        if (orientation == 0)
         {
-            for(std::vector<TriangleTransformationType>::const_iterator iter=tri_trans.begin(); iter!=tri_trans.end(); ++iter)
+            continue;
+        }
+        
+        PointType min_p = vigra::min(tri[0], vigra::min(tri[1], tri[2])),
+                  max_p = vigra::max(tri[0], vigra::max(tri[1], tri[2]));
+        
+        int x_start = std::max(0, (int)std::ceil(min_p[0])),
+            y_start = std::max(0, (int)std::ceil(min_p[1])),
+            x_end   = std::min((int)dest.width()-1,  (int)std::floor(max_p[0])),
+            y_end   = std::min((int)dest.height()-1, (int)std::floor(max_p[1]));
+        
+        const vigra::Matrix<double> & transformation = iter->second;
+        
+        for(int y = y_start; y<=y_end; ++y)
+        {
+            for(int x = x_start; x<=x_end; ++x)
             {
-                if(iter->first.isInside(PointType(x,y)))
+                PointType p(x,y);
+                
+                //Accept both orientations, since target triangles may be flipped
+                bool inside = true;
+                for(unsigned int i=0; i<3 && inside; ++i)
+                {
+                    inside = (orient2D(tri[i], tri[(i+1)%3], p)*orientation >= 0);
+                }
+                
+                if(inside)
                 {
-                    vigra::Matrix<double> transformation = iter->second;
                     double sx = transformation(0,0)*x + transformation(0,1)*y + transformation(0,2);
                     double sy = transformation(1,0)*x + transformation(1,1)*y + transformation(1,2); 
                     
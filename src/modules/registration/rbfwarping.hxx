@@ -0,0 +1,480 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_REGISTRATION_RBFWARPING_HXX
+#define GRAIPE_REGISTRATION_RBFWARPING_HXX
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include <vigra/tinyvector.hxx>
+#include <vigra/multi_array.hxx>
+#include <vigra/splineimageview.hxx>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_registration
+ * @{
+ *
+ * @file
+ * @brief Header file for the tiled and approximating (RBF) warping engine
+ */
+
+/**
+ * The transformation of a radial basis function (RBF) registration model, as
+ * computed by vigra::rbfMatrix2DFromCorrespondingPoints. It maps each point of the
+ * destination image to its position in the source image.
+ */
+template <class RadialBasisFunctor>
+class RadialBasisTransformation
+{
+    public:
+        /** The used point type **/
+        typedef vigra::TinyVector<double,2> PointType;
+    
+        /**
+         * Constructor of the transformation.
+         *
+         * \param d     The begin() iterator of the dest points (RBF centers).
+         * \param d_end The end() iterator of the dest points (RBF centers).
+         * \param W     The RBF weight matrix (n+3 x 2), where the last three rows
+         *              contain the affine part.
+         * \param rbf   The radial basis functor.
+         */
+        template <class DestPointIterator, class C>
+        RadialBasisTransformation(DestPointIterator d, DestPointIterator d_end,
+                                  vigra::MultiArrayView<2, double, C> const & W,
+                                  RadialBasisFunctor rbf = RadialBasisFunctor())
+        : m_rbf(rbf)
+        {
+            int point_count = (int)(d_end - d);
+            
+            vigra_precondition(W.shape(0) == point_count+3 && W.shape(1) == 2,
+                               "RadialBasisTransformation(): Weight matrix size does not match the point count.");
+            
+            for(int i=0; i<point_count; ++i, ++d)
+            {
+                m_centers.push_back(PointType((*d)[0], (*d)[1]));
+                m_weights.push_back(PointType(W(i,0), W(i,1)));
+            }
+            
+            m_affine[0] = PointType(W(point_count,0),   W(point_count,1));
+            m_affine[1] = PointType(W(point_count+1,0), W(point_count+1,1));
+            m_affine[2] = PointType(W(point_count+2,0), W(point_count+2,1));
+        }
+    
+        /**
+         * Evaluates the transformation at a position.
+         *
+         * \param x The x-coordinate in the destination image.
+         * \param y The y-coordinate in the destination image.
+         * \return The corresponding position in the source image.
+         */
+        PointType operator()(double x, double y) const
+        {
+            PointType p(x,y);
+            PointType result = m_affine[0] + m_affine[1]*x + m_affine[2]*y;
+            
+            for(unsigned int i=0; i<m_centers.size(); ++i)
+            {
+                result += m_weights[i]*m_rbf(m_centers[i], p);
+            }
+            return result;
+        }
+    
+        /**
+         * The centers of the radial basis functions. The transformation may not
+         * be smooth at these points.
+         *
+         * \return The RBF centers.
+         */
+        const std::vector<PointType>& centers() const
+        {
+            return m_centers;
+        }
+    
+    private:
+        /** The RBF centers **/
+        std::vector<PointType> m_centers;
+        /** The weights of each RBF **/
+        std::vector<PointType> m_weights;
+        /** The affine part: offset, x- and y-factor **/
+        PointType m_affine[3];
+        /** The radial basis functor **/
+        RadialBasisFunctor m_rbf;
+};
+
+
+
+
+/**
+ * A task of the tiled warping. Each task warps a contiguous block of tile rows.
+ *
+ * Inside each grid cell, the transformation is interpolated bilinearly from
+ * the cell's corners. The interpolation is checked against the exact
+ * transformation at the cell's center and edge midpoints. Cells with a larger
+ * error, or cells near a singular point of the transformation, are subdivided
+ * recursively, down to exact evaluation per pixel.
+ */
+template <class Transformation, int ORDER, class T1, class T2>
+class TiledWarpTask
+:   public QRunnable
+{
+    public:
+        /** The used point type **/
+        typedef vigra::TinyVector<double,2> PointType;
+    
+        /**
+         * Constructor of a task.
+         *
+         * \param src The source image. Since spline image views are not
+         *            reentrant, each task works on its own copy.
+         * \param dest The destination image.
+         * \param transformation The transformation from dest to src coordinates.
+         * \param grid_spacing The size of the (coarsest) grid cells.
+         * \param max_error The maximum allowed interpolation error in pixels.
+         * \param tile_points The singular points of the transformation per tile.
+         * \param tile_row_begin The first tile row of this task.
+         * \param tile_row_end The tile row after the last tile row of this task.
+         */
+        TiledWarpTask(vigra::SplineImageView<ORDER, T1> const & src, vigra::MultiArrayView<2, T2> dest,
+                      const Transformation & transformation,
+                      int grid_spacing, double max_error,
+                      const std::vector<std::vector<PointType> > & tile_points,
+                      int tile_row_begin, int tile_row_end)
+        :   m_src(src),
+            m_dest(dest),
+            m_transformation(transformation),
+            m_grid_spacing(grid_spacing),
+            m_max_error(max_error),
+            m_tile_points(tile_points),
+            m_tile_row_begin(tile_row_begin),
+            m_tile_row_end(tile_row_end)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Processes the tile rows, called by the thread pool.
+         */
+        void run()
+        {
+            const int width  = m_dest.width(),
+                      height = m_dest.height(),
+                      tiles_x = (width + m_grid_spacing - 1)/m_grid_spacing;
+            
+            //The transformation at the grid nodes of the current tile row's top and bottom
+            std::vector<PointType> top(tiles_x+1), bottom(tiles_x+1);
+            
+            for(int tx=0; tx<=tiles_x; ++tx)
+            {
+                top[tx] = m_transformation(std::min(tx*m_grid_spacing, width), std::min(m_tile_row_begin*m_grid_spacing, height));
+            }
+            
+            for(int ty=m_tile_row_begin; ty<m_tile_row_end; ++ty)
+            {
+                const int y0 = ty*m_grid_spacing,
+                          y1 = std::min(y0 + m_grid_spacing, height);
+                
+                for(int tx=0; tx<=tiles_x; ++tx)
+                {
+                    bottom[tx] = m_transformation(std::min(tx*m_grid_spacing, width), y1);
+                }
+                
+                for(int tx=0; tx<tiles_x; ++tx)
+                {
+                    const int x0 = tx*m_grid_spacing,
+                              x1 = std::min(x0 + m_grid_spacing, width);
+                    
+                    warpCell(x0, y0, x1, y1,
+                             top[tx], top[tx+1], bottom[tx], bottom[tx+1],
+                             m_tile_points[ty*tiles_x + tx]);
+                }
+                std::swap(top, bottom);
+            }
+        }
+    
+    private:
+        /**
+         * Bilinear interpolation of the corner values of a cell.
+         */
+        static PointType interpolate(const PointType& m00, const PointType& m10,
+                                     const PointType& m01, const PointType& m11,
+                                     double fx, double fy)
+        {
+            return (m00*(1.0-fx) + m10*fx)*(1.0-fy) + (m01*(1.0-fx) + m11*fx)*fy;
+        }
+    
+        /**
+         * Warps the pixels [x0,x1) x [y0,y1) of a cell, given the transformation
+         * at the cell's corners (x0,y0), (x1,y0), (x0,y1) and (x1,y1).
+         */
+        void warpCell(int x0, int y0, int x1, int y1,
+                      const PointType& m00, const PointType& m10,
+                      const PointType& m01, const PointType& m11,
+                      const std::vector<PointType> & singular_points)
+        {
+            const int w = x1-x0, h = y1-y0;
+            
+            if(w<=1 && h<=1)
+            {
+                warpPixel(x0, y0, m00);
+                return;
+            }
+            
+            //Split positions and the exact transformation there
+            const int xm = (w>1) ? x0 + w/2 : x1,
+                      ym = (h>1) ? y0 + h/2 : y1;
+            
+            const double fx = double(xm-x0)/w,
+                         fy = double(ym-y0)/h;
+            
+            PointType m_top    = (w>1) ? m_transformation(xm, y0) : m10,
+                      m_bottom = (w>1) ? m_transformation(xm, y1) : m11,
+                      m_left   = (h>1) ? m_transformation(x0, ym) : m01,
+                      m_right  = (h>1) ? m_transformation(x1, ym) : m11,
+                      m_center = m_transformation(xm, ym);
+            
+            bool refine = false;
+            
+            for(unsigned int i=0; i<singular_points.size() && !refine; ++i)
+            {
+                const PointType& p = singular_points[i];
+                refine = (p[0] >= x0-1 && p[0] <= x1+1 && p[1] >= y0-1 && p[1] <= y1+1);
+            }
+            
+            if(!refine)
+            {
+                double max_err2 = m_max_error*m_max_error;
+                
+                refine =    squaredNorm(m_top    - interpolate(m00, m10, m01, m11, fx,  0.0)) > max_err2
+                         || squaredNorm(m_bottom - interpolate(m00, m10, m01, m11, fx,  1.0)) > max_err2
+                         || squaredNorm(m_left   - interpolate(m00, m10, m01, m11, 0.0, fy )) > max_err2
+                         || squaredNorm(m_right  - interpolate(m00, m10, m01, m11, 1.0, fy )) > max_err2
+                         || squaredNorm(m_center - interpolate(m00, m10, m01, m11, fx,  fy )) > max_err2;
+            }
+            
+            if(refine)
+            {
+                warpCell(x0, y0, xm, ym, m00, m_top, m_left, m_center, singular_points);
+                
+                if(xm < x1)
+                    warpCell(xm, y0, x1, ym, m_top, m10, m_center, m_right, singular_points);
+                if(ym < y1)
+                    warpCell(x0, ym, xm, y1, m_left, m_center, m01, m_bottom, singular_points);
+                if(xm < x1 && ym < y1)
+                    warpCell(xm, ym, x1, y1, m_center, m_right, m_bottom, m11, singular_points);
+            }
+            else
+            {
+                for(int y=y0; y<y1; ++y)
+                {
+                    for(int x=x0; x<x1; ++x)
+                    {
+                        warpPixel(x, y, interpolate(m00, m10, m01, m11, double(x-x0)/w, double(y-y0)/h));
+                    }
+                }
+            }
+        }
+    
+        /**
+         * Samples the source image at the given position for one pixel.
+         */
+        void warpPixel(int x, int y, const PointType& s)
+        {
+            if(m_src.isInside(s[0], s[1]))
+            {
+                m_dest(x,y) = m_src(s[0], s[1]);
+            }
+        }
+    
+        /** The (copied) source image **/
+        vigra::SplineImageView<ORDER, T1> m_src;
+        /** The destination image **/
+        vigra::MultiArrayView<2, T2> m_dest;
+        /** The transformation **/
+        const Transformation & m_transformation;
+        /** The size of the coarsest grid cells **/
+        int m_grid_spacing;
+        /** The maximum allowed interpolation error **/
+        double m_max_error;
+        /** The singular points of the transformation per tile **/
+        const std::vector<std::vector<PointType> > & m_tile_points;
+        /** The range of tile rows of this task **/
+        int m_tile_row_begin, m_tile_row_end;
+};
+
+
+
+
+/**
+ * Warps an image by means of an arbitrary (smooth) transformation, which maps
+ * destination to source coordinates. The transformation is evaluated on a grid
+ * and interpolated bilinearly in between, where the interpolation error is
+ * controlled adaptively (see TiledWarpTask). The tile rows are processed in
+ * parallel.
+ *
+ * \param src The source image.
+ * \param dest The destination image.
+ * \param transformation The transformation. Needs to provide the (reentrant)
+ *                       PointType operator()(double x, double y) const.
+ * \param singular_points Points, where the transformation may not be smooth.
+ *                        Cells around them are always evaluated exactly.
+ * \param grid_spacing The size of the coarsest grid cells. Using a spacing of 1
+ *                     evaluates the transformation exactly for each pixel.
+ * \param max_error The maximum allowed interpolation error in pixels.
+ */
+template <class Transformation, int ORDER, class T1, class T2>
+void tiledWarpImage(vigra::SplineImageView<ORDER, T1> const & src, vigra::MultiArrayView<2, T2> dest,
+                    const Transformation & transformation,
+                    const std::vector<vigra::TinyVector<double,2> > & singular_points,
+                    int grid_spacing = 16, double max_error = 0.05)
+{
+    typedef vigra::TinyVector<double,2> PointType;
+    
+    vigra_precondition(grid_spacing >= 1, "tiledWarpImage(): The grid spacing needs to be positive.");
+    
+    const int width  = dest.width(),
+              height = dest.height();
+    
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+    
+    const int tiles_x = (width  + grid_spacing - 1)/grid_spacing,
+              tiles_y = (height + grid_spacing - 1)/grid_spacing;
+    
+    //Assign the singular points to all tiles, which (nearly) contain them
+    std::vector<std::vector<PointType> > tile_points(grid_spacing > 1 ? tiles_x*tiles_y : 0);
+    
+    if(grid_spacing > 1)
+    {
+        for(unsigned int i=0; i<singular_points.size(); ++i)
+        {
+            const PointType& p = singular_points[i];
+            
+            int tx0 = std::max(0,         (int)std::floor((p[0]-1)/grid_spacing)),
+                tx1 = std::min(tiles_x-1, (int)std::floor((p[0]+1)/grid_spacing)),
+                ty0 = std::max(0,         (int)std::floor((p[1]-1)/grid_spacing)),
+                ty1 = std::min(tiles_y-1, (int)std::floor((p[1]+1)/grid_spacing));
+            
+            for(int ty=ty0; ty<=ty1; ++ty)
+            {
+                for(int tx=tx0; tx<=tx1; ++tx)
+                {
+                    tile_points[ty*tiles_x + tx].push_back(p);
+                }
+            }
+        }
+    }
+    else
+    {
+        tile_points.resize(tiles_x*tiles_y);
+    }
+    
+    const int thread_count = std::max(1, std::min(QThread::idealThreadCount(), tiles_y)),
+              rows_per_task = (tiles_y + thread_count - 1)/thread_count;
+    
+    std::vector<TiledWarpTask<Transformation, ORDER, T1, T2>*> tasks;
+    
+    for(int t=0; t<thread_count; ++t)
+    {
+        int row_begin = std::min(tiles_y, t*rows_per_task),
+            row_end   = std::min(tiles_y, (t+1)*rows_per_task);
+        
+        if(row_begin < row_end)
+        {
+            tasks.push_back(new TiledWarpTask<Transformation, ORDER, T1, T2>(src, dest, transformation, grid_spacing, max_error,
+                                                                             tile_points, row_begin, row_end));
+        }
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(thread_count);
+    
+    for(unsigned int t=1; t<tasks.size(); ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    for(TiledWarpTask<Transformation, ORDER, T1, T2>* task : tasks)
+    {
+        delete task;
+    }
+}
+
+/**
+ * Radial basis function warping of an image, like vigra::rbfWarpImage, but
+ * evaluated by means of the tiled, parallel warping engine.
+ *
+ * \param src The source image.
+ * \param dest The destination image.
+ * \param d The begin() iterator of the dest points (RBF centers).
+ * \param d_end The end() iterator of the dest points (RBF centers).
+ * \param W The RBF weight matrix as computed by vigra::rbfMatrix2DFromCorrespondingPoints.
+ * \param rbf The radial basis functor.
+ * \param grid_spacing The size of the coarsest grid cells. Using a spacing of 1
+ *                     evaluates the RBF model exactly for each pixel.
+ * \param max_error The maximum allowed interpolation error in pixels.
+ */
+template <int ORDER, class T1, class T2, class DestPointIterator, class C, class RadialBasisFunctor>
+void rbfWarpImageTiled(vigra::SplineImageView<ORDER, T1> const & src, vigra::MultiArrayView<2, T2> dest,
+                       DestPointIterator d, DestPointIterator d_end,
+                       vigra::MultiArrayView<2, double, C> const & W,
+                       RadialBasisFunctor rbf,
+                       int grid_spacing = 16, double max_error = 0.05)
+{
+    RadialBasisTransformation<RadialBasisFunctor> transformation(d, d_end, W, rbf);
+    
+    tiledWarpImage(src, dest, transformation, transformation.centers(), grid_spacing, max_error);
+}
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_REGISTRATION_RBFWARPING_HXX
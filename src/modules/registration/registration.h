@@ -20,6 +20,8 @@
 
 #include "registration/piecewiseaffine_registration.hxx"
 #include "registration/delaunay.hxx"
+#include "registration/delaunaytriangulation.hxx"
+#include "registration/rbfwarping.hxx"
 #include "registration/warpingfunctors.hxx"
 
 /**
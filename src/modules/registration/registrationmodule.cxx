@@ -128,7 +128,7 @@ class GlobalMotionCorrector
                     for( unsigned int c=0; c < m_param_imageBand1->image()->numBands(); c++)
                     {
                         vigra::affineWarpImage(vigra::SplineImageView<3, float>(m_param_imageBand1->image()->band(c)),
-                                               displaced_image->band(c),
+                                               displaced_image->writableBand(c),
                                                mat);
                     }
                     
@@ -220,6 +220,11 @@ class GenericRegistration
 			m_parameters->addParameter("image1", new ModelParameter("Image to be warped",  "Image", NULL, false, wsp));
 			m_parameters->addParameter("image2", new ModelParameter("Reference Image",  "Image", NULL, false, wsp));
 			m_parameters->addParameter("vf", new ModelParameter("Correspondence Map",  "SparseVectorfield2D", NULL, false, wsp));
+            
+            if(WarpingFunctorTraits<WARPING_FUNCTOR>::has_accuracy)
+            {
+                m_parameters->addParameter("accuracy", new EnumParameter("Warping accuracy",  warpingAccuracyNames(), ExactWarping));
+            }
 		}
 		
         /**
@@ -260,7 +265,14 @@ class GenericRegistration
                     
                     emit statusMessage(1.0, QString("starting computation"));
                     
-                    WARPING_FUNCTOR func_a;
+                    WarpingAccuracy accuracy = ExactWarping;
+                    
+                    if(WarpingFunctorTraits<WARPING_FUNCTOR>::has_accuracy)
+                    {
+                        accuracy = (WarpingAccuracy) static_cast<EnumParameter*>((*m_parameters)["accuracy"])->value();
+                    }
+                    
+                    WARPING_FUNCTOR func_a = WarpingFunctorTraits<WARPING_FUNCTOR>::create(accuracy);
                     
                     Image<float>* new_image = new Image<float>(image2->size(), image1->numBands(), m_workspace);
                     
@@ -270,7 +282,7 @@ class GenericRegistration
                     for(unsigned int i=0; i<vf->size(); ++i)
                     {
                         src_points[i][0] = vf->origin(i).x();
-                        src_points[i][1] = vf->origin(i).x();
+                        src_points[i][1] = vf->origin(i).y();
                 
                         dest_points[i][0] = vf->target(i).x();
                         dest_points[i][1] = vf->target(i).y();
@@ -278,7 +290,7 @@ class GenericRegistration
                     
                     for(unsigned int c=0; c<image1->numBands(); c++)
                     {
-                        func_a(image1->band(c), new_image->band(c), src_points.begin(), src_points.end(), dest_points.begin());
+                        func_a(image1->band(c), new_image->writableBand(c), src_points.begin(), src_points.end(), dest_points.begin());
             
                     }
                     
@@ -290,6 +302,11 @@ class GenericRegistration
                     descr +=  QString("Reference image: ") + image2->name()  + QString("\n");
                     descr +=  QString("Correspondence vectorfield: ") + vf->name()  + QString("\n");
                     
+                    if(WarpingFunctorTraits<WARPING_FUNCTOR>::has_accuracy)
+                    {
+                        descr +=  QString("Warping accuracy: ") + warpingAccuracyNames()[accuracy]  + QString("\n");
+                    }
+                    
                     new_image->setDescription(descr);
                     
                     image2->copyGeometry(*new_image);
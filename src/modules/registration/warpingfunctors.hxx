@@ -43,11 +43,14 @@
 #include <vigra/affinegeometry.hxx>
 
 #include "registration/piecewiseaffine_registration.hxx"
+#include "registration/rbfwarping.hxx"
 
 #include <vigra/projective_registration.hxx>
 #include <vigra/polynomial_registration.hxx>
 #include <vigra/rbf_registration.hxx>
 
+#include <QStringList>
+
 namespace graipe {
 
 /**
@@ -57,6 +60,27 @@ namespace graipe {
  * @file
  * @brief Header file for the different warping functions for image registration.
  */
+
+/**
+ * The accuracy of warping functors, which support an approximated evaluation
+ * of their transformation model.
+ */
+enum WarpingAccuracy
+{
+    ExactWarping = 0,
+    BalancedWarping = 1,
+    FastWarping = 2
+};
+
+/**
+ * The (user readable) names of the warping accuracies.
+ *
+ * \return The names in order of the WarpingAccuracy enum.
+ */
+inline QStringList warpingAccuracyNames()
+{
+    return QStringList() << "Exact" << "Balanced (max. error 0.05 px)" << "Fast (max. error 0.25 px)";
+}
  
 /**
  * This class represents the affine registration functor.
@@ -258,6 +282,18 @@ template <class RadialBasisFunctor>
 class WarpRadialBasisFunctor
 {
     public:
+        /**
+         * Constructor of the functor.
+         *
+         * \param accuracy The accuracy of the RBF model evaluation during warping.
+         *                 Approximated evaluations use the tiled warping engine with
+         *                 a coarse grid and error controlled interpolation.
+         */
+        WarpRadialBasisFunctor(WarpingAccuracy accuracy = ExactWarping)
+        : m_accuracy(accuracy)
+        {
+        }
+    
         /**
          * The functor call. It transforms the first image with respect to the given point correspondences
          * and the RBF functor to match the second image as best as possible, given the RBF model.
@@ -275,10 +311,30 @@ class WarpRadialBasisFunctor
         {
             RadialBasisFunctor rbf;
             
-            rbfWarpImage(vigra::SplineImageView<4, T1>(src), dest,
-                         d,  d+ (s_end-s),
-                         vigra::rbfMatrix2DFromCorrespondingPoints(s, s_end, d, rbf),
-                         rbf);
+            int grid_spacing = 1;
+            double max_error = 0;
+            
+            switch (m_accuracy)
+            {
+                case BalancedWarping:
+                    grid_spacing = 16;
+                    max_error = 0.05;
+                    break;
+                    
+                case FastWarping:
+                    grid_spacing = 32;
+                    max_error = 0.25;
+                    break;
+                    
+                default:
+                    break;
+            }
+            
+            rbfWarpImageTiled(vigra::SplineImageView<4, T1>(src), dest,
+                              d,  d+ (s_end-s),
+                              vigra::rbfMatrix2DFromCorrespondingPoints(s, s_end, d, rbf),
+                              rbf,
+                              grid_spacing, max_error);
         }
     
         /**
@@ -291,6 +347,10 @@ class WarpRadialBasisFunctor
         {
             return rbfName<RadialBasisFunctor>();
         }
+    
+    private:
+        /** The accuracy of the warping **/
+        WarpingAccuracy m_accuracy;
 };
 
 /**
@@ -310,6 +370,50 @@ typedef WarpRadialBasisFunctor<vigra::DistancePowerFunctor<3> > WarpRBF3Functor;
  */
 
 
+
+
+/**
+ * Creation traits for warping functors. By default, functors do not support
+ * different warping accuracies and are default constructed.
+ */
+template <class WARPING_FUNCTOR>
+struct WarpingFunctorTraits
+{
+    /** Does the functor support different warping accuracies? **/
+    static const bool has_accuracy = false;
+    
+    /**
+     * Creates a warping functor.
+     *
+     * \return A new functor.
+     */
+    static WARPING_FUNCTOR create(WarpingAccuracy)
+    {
+        return WARPING_FUNCTOR();
+    }
+};
+
+/**
+ * Creation traits for RBF warping functors, which support different accuracies.
+ */
+template <class RadialBasisFunctor>
+struct WarpingFunctorTraits<WarpRadialBasisFunctor<RadialBasisFunctor> >
+{
+    /** Does the functor support different warping accuracies? **/
+    static const bool has_accuracy = true;
+    
+    /**
+     * Creates a warping functor.
+     *
+     * \param accuracy The accuracy of the warping.
+     * \return A new functor.
+     */
+    static WarpRadialBasisFunctor<RadialBasisFunctor> create(WarpingAccuracy accuracy)
+    {
+        return WarpRadialBasisFunctor<RadialBasisFunctor>(accuracy);
+    }
+};
+
 /**
  * @}
  */
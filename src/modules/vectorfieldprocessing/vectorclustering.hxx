@@ -36,6 +36,7 @@
 #ifndef GRAIPE_VECTORFIELDPROCESSING_VECTORCLUSTERING_HXX
 #define GRAIPE_VECTORFIELDPROCESSING_VECTORCLUSTERING_HXX
 
+#include <algorithm>
 #include <vector>
 
 #include <vigra/stdimage.hxx>
@@ -45,6 +46,9 @@
 #include "vectorfields/vectorfields.h"
 #include "features2d/features2d.h"
 
+#include "vectorfieldprocessing/vectorkmeans.hxx"
+#include "vectorfieldprocessing/vectorgridclustering.hxx"
+
 namespace graipe {
     
 /**
@@ -89,84 +93,111 @@ inline float dist4D(const Vectorfield2D::PointType & pos1, const PointFeatureLis
 }
 
 /**
- * Helper function for the comparison of two directions using the cross product.
+ * Helper function to compute the cross product of the vectors o-a and o-b.
  *
- * \param a The first direction vector.
- * \param b The second direction vector.
- * \return True if the a cross b is either larger than zero, or is equal to zero and
- *         the length of a is smaller than b's.
+ * \param o The common origin of both vectors.
+ * \param a The target of the first vector.
+ * \param b The target of the second vector.
+ * \return The cross product, which is positive for a counter-clockwise turn o-a-b.
  */
-inline bool comparePointAngles(const PointFeatureList2D::PointType& a, const PointFeatureList2D::PointType& b)
+inline qreal hullCross(const Polygon2D::PointType& o, const Polygon2D::PointType& a, const Polygon2D::PointType& b)
 {
-	//Cross product
-	float c = a.cross(b);
-
-	return c>0  || (c==0 && a.length() < b.length());
+	return (a.x()-o.x())*(b.y()-o.y()) - (a.y()-o.y())*(b.x()-o.x());
 }
 
 /**
- * Helper function to find out, if three consecutive points form a convex configuration.
+ * Helper function for the lexicographical comparison of two points.
  *
  * \param a The first point.
  * \param b The second point.
- * \param c The third point.
- * \return True if the line connecting a-b-c is convex.
+ * \return True if a is left of b or, at the same x-coordinate, above b.
+ */
+inline bool hullPointLess(const Polygon2D::PointType& a, const Polygon2D::PointType& b)
+{
+	return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+}
+
+/**
+ * Computes the convex hull of a set of points using Andrew's monotone chain
+ * algorithm in O(n log n). Collinear points on the hull are dropped.
+ *
+ * \param points The points. They will be sorted in place.
+ * \return The points of the hull in counter-clockwise order (not closed).
  */
-inline bool isConvex(const PointFeatureList2D::PointType& a, const PointFeatureList2D::PointType& b, const PointFeatureList2D::PointType& c)
+inline std::vector<Polygon2D::PointType> convexHull(std::vector<Polygon2D::PointType>& points)
 {
-	float area = QPointFX(b-a).cross(b-c);
+	std::sort(points.begin(), points.end(), hullPointLess);
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+	
+	const unsigned int n = (unsigned int)points.size();
+	
+	if(n < 3)
+	{
+		return points;
+	}
+	
+	std::vector<Polygon2D::PointType> hull(2*n);
+	unsigned int k = 0;
+	
+	//Lower hull
+	for(unsigned int i=0; i<n; ++i)
+	{
+		while(k >= 2 && hullCross(hull[k-2], hull[k-1], points[i]) <= 0)
+			k--;
+		hull[k++] = points[i];
+	}
+	
+	//Upper hull
+	for(unsigned int i=n-1, t=k+1; i>0; --i)
+	{
+		while(k >= t && hullCross(hull[k-2], hull[k-1], points[i-1]) <= 0)
+			k--;
+		hull[k++] = points[i-1];
+	}
 	
-	return area < 0 || (area==0 && QPointFX(a-c).length() < QPointFX(a-b).length() + QPointFX(c-b).length());
+	//The last point is equal to the first one
+	hull.resize(k-1);
+	return hull;
 }
 
 /**
- * Helper function to sort a point list by the corresponding angles. Will be used for the 
- * generation of a polygpn from a given point list.
+ * Function to generate a closed polygon from a set of points. The polygon is given by
+ * the convex hull of the points. Degenerated sets (one point or points on one line) 
+ * will result in a small square or triangle around the points.
  *
- * \param points The point list.
- * \return A copied and sorted point list, according to the angle w.r.t. the upper-left-most
- *         item of the point list.
+ * \param points The points, for which we want to generate the polygon. They will be sorted.
+ * \return The (hull) polygon for the points.
  */
-PointFeatureList2D sortPointListAngular(PointFeatureList2D& points)
+inline Polygon2D polygonFromPoints(std::vector<Polygon2D::PointType>& points)
 {
-	std::list<PointFeatureList2D::PointType> sorted_list;
+	Polygon2D result;
 	
-	PointFeatureList2D sorted_features(points.workspace());
+	std::vector<Polygon2D::PointType> hull = convexHull(points);
 	
-	if( points.size())
+	if (hull.size() == 1)
 	{
-		//Select point of min x and y-coordinate
-		unsigned int min_idx=0;
-		
-		for (unsigned int i=1; i< points.size(); ++i)
-		{
-			if(	points.position(min_idx)< points.position(i) )
-			{
-				min_idx = i;
-			}
-		}
-		
-		//make relative positions to min_idx point
-		for (unsigned int i=0; i< points.size(); ++i)
-		{
-			if(i != min_idx)
-			{
-				sorted_list.push_back(points.position(i) - points.position(min_idx));
-			}
-		}
-		//sort the list by angles
-		sorted_list.sort(comparePointAngles);
-		
-		//create final feature list:
-		sorted_features.addFeature(points.position(min_idx));
-		
-        for(PointFeatureList2D::PointType p: sorted_list)
+		result.addPoint(hull[0]+Polygon2D::PointType(-0.5,0.5));
+		result.addPoint(hull[0]+Polygon2D::PointType(-0.5,-0.5));
+		result.addPoint(hull[0]+Polygon2D::PointType(0.5,-0.5));
+		result.addPoint(hull[0]+Polygon2D::PointType(0.5,0.5));
+		result.addPoint(hull[0]+Polygon2D::PointType(-0.5,0.5));
+	}
+	else if (hull.size() == 2)
+	{
+		result.addPoint(hull[0]);
+		result.addPoint(hull[1]);
+		result.addPoint((hull[0]+hull[1])/2.0+Polygon2D::PointType(1,1));
+		result.addPoint(hull[0]);
+	}
+	else if (hull.size() > 2)
+	{
+		for(const Polygon2D::PointType& p: hull)
 		{
-			sorted_features.addFeature(p+points.position(min_idx));
+			result.addPoint(p);
 		}
-		
+		result.addPoint(hull.front());
 	}
-	return sorted_features;
+	return result;
 }
 
 /**
@@ -174,69 +205,31 @@ PointFeatureList2D sortPointListAngular(PointFeatureList2D& points)
  * cover all points and might be forced to be convex using an additional parameter.
  *
  * \param points The point list, for which we want to generate the polygon.
- * \param convex If true, the resulting polygon will be convex.
+ * \param convex If true, the resulting polygon will be the convex hull. Else, the
+ *               points will be connected in their order.
  * \return The (hull) polygon for the point list.
  */
-Polygon2D polygonFromPointList(const PointFeatureList2D& points, bool convex = true)
+inline Polygon2D polygonFromPointList(const PointFeatureList2D& points, bool convex = true)
 {
-	Polygon2D result;
-	if (points.size() == 1)
+	std::vector<Polygon2D::PointType> positions(points.size());
+	
+	for (unsigned int  i=0; i< points.size(); ++i)
 	{
-		result.addPoint(points.position(0)+Polygon2D::PointType(-0.5,0.5));
-		result.addPoint(points.position(0)+Polygon2D::PointType(-0.5,-0.5));
-		result.addPoint(points.position(0)+Polygon2D::PointType(0.5,-0.5));
-		result.addPoint(points.position(0)+Polygon2D::PointType(0.5,0.5));
-		result.addPoint(points.position(0)+Polygon2D::PointType(-0.5,0.5));
+		positions[i] = points.position(i);
 	}
-	else if (points.size() == 2)
+	
+	if(convex || points.size() < 3)
 	{
-		result.addPoint(points.position(0));
-		result.addPoint(points.position(1));
-		result.addPoint((points.position(0)+points.position(1))/2.0+Polygon2D::PointType(1,1));
-		result.addPoint(points.position(0));
+		return polygonFromPoints(positions);
 	}
-	else if( points.size() > 3)
+	
+	Polygon2D result;
+	for(const Polygon2D::PointType& p: positions)
 	{
-		if(convex)
-		{
-			std::list<Polygon2D::PointType> stack;
-			
-			stack.push_back(points.position(0));
-			stack.push_back(points.position(1));
-			
-			unsigned int i=2, n = points.size();
-			
-			while (i<n)
-			{
-				if(isConvex(*(--(--stack.end())),
-							*(--stack.end()),
-							points.position(i))
-				   || stack.size() == 1)
-				{
-					stack.push_back(points.position(i));
-					i++;
-				}
-				else 
-				{ 
-					if(stack.size()>1)
-						stack.pop_back();
-				}
-			}	
-			for(Polygon2D::PointType p: stack)
-			{
-				result.addPoint(p);
-			}
-			result.addPoint(stack.front());
-		}
-		else
-		{
-			for (unsigned int  i=0; i< points.size(); ++i)
-			{
-				result.addPoint(points.position(i));
-			}
-			result.addPoint(points.position(0));
-		}
+		result.addPoint(p);
 	}
+	result.addPoint(positions.front());
+	
 	return result;
 }
 
@@ -251,60 +244,69 @@ Polygon2D polygonFromPointList(const PointFeatureList2D& points, bool convex = t
  * \param direction_weight weight for the directional component difference.
  * \return A list of weighted polygons, each representing one cluster. 
  */
-WeightedPolygonList2D* polygonsFromClusteredVectorfield(SparseWeightedVectorfield2D* vectorfield, float direction_weight)
+inline WeightedPolygonList2D* polygonsFromClusteredVectorfield(SparseWeightedVectorfield2D* vectorfield, float direction_weight)
 {
+	typedef SparseWeightedVectorfield2D::PointType Point2D;
+	
 	WeightedPolygonList2D* result = new WeightedPolygonList2D(vectorfield->workspace());
 	
 	unsigned int vector_count = vectorfield->size();					//count of vectors
 	unsigned int cluster_count = 0;
 	
+	std::vector<Point2D> origins, directions;
+	vectorfield->copyOrigins(origins);
+	vectorfield->copyDirections(directions);
+	
+	std::vector<unsigned int> cluster_ids(vector_count);
 	
 	//find clusters
 	for (unsigned int i=0; i< vector_count; ++i)
 	{
-        cluster_count = std::max(cluster_count,(unsigned int)vectorfield->weight(i));
+		cluster_ids[i] = (unsigned int)vectorfield->weight(i) - 1;
+        cluster_count = std::max(cluster_count, cluster_ids[i]+1);
 	}
 	
 	//create temp caches
-	std::vector<PointFeatureList2D*> point_lists(cluster_count);
-	std::vector<PointFeatureList2D::PointType> pos(cluster_count), dir(cluster_count);
+	std::vector<std::vector<Polygon2D::PointType> > point_lists(cluster_count);
+	std::vector<Point2D> pos(cluster_count), dir(cluster_count);
     std::vector<float> vec_count(cluster_count), vec_diff(cluster_count);
 	
 	// For each cluster ->estimate mean vector
 	for (unsigned int i=0; i< vector_count; ++i)
 	{
-		unsigned int cluster_idx = vectorfield->weight(i)-1;
-		pos[cluster_idx] += vectorfield->origin(i);
-		dir[cluster_idx] += vectorfield->direction(i);
+		unsigned int cluster_idx = cluster_ids[i];
+		pos[cluster_idx] += origins[i];
+		dir[cluster_idx] += directions[i];
 		vec_count[cluster_idx]++;
 	}
 	for (unsigned int cluster_idx=0; cluster_idx< cluster_count; ++cluster_idx)
 	{
-		//initialise point Lists for polygon creation
-		point_lists[cluster_idx] = new PointFeatureList2D(vectorfield->workspace());
-		
-		pos[cluster_idx] /= vec_count[cluster_idx];
-		dir[cluster_idx] /= vec_count[cluster_idx];
+		if(vec_count[cluster_idx] != 0)
+		{
+			pos[cluster_idx] /= vec_count[cluster_idx];
+			dir[cluster_idx] /= vec_count[cluster_idx];
+		}
+		point_lists[cluster_idx].reserve(vec_count[cluster_idx]);
 	}
 	
 	//for each cluster -> estimate square differences between mean and each vector
 	for (unsigned int i=0; i<vector_count; ++i)
 	{
-		unsigned int cluster_idx = vectorfield->weight(i)-1;
+		unsigned int cluster_idx = cluster_ids[i];
 		vec_diff[cluster_idx] += dist4D(pos[cluster_idx], dir[cluster_idx],
-										vectorfield->origin(i), vectorfield->direction(i),
+										origins[i], directions[i],
 										direction_weight);
 		
 		//Add points to corresponding lists
-		point_lists[cluster_idx]->addFeature(vectorfield->origin(i));
+		point_lists[cluster_idx].push_back(origins[i]);
 	}
 	for (unsigned int cluster_idx=0; cluster_idx< cluster_count; ++cluster_idx)
 	{
-		vec_diff[cluster_idx] /=vec_count[cluster_idx];
-		result->addPolygon(polygonFromPointList(sortPointListAngular(*point_lists[cluster_idx])), vec_diff[cluster_idx]);
-		
-		delete point_lists[cluster_idx];
-		point_lists[cluster_idx] = 0;
+		if(vec_count[cluster_idx] != 0)
+		{
+			vec_diff[cluster_idx] /=vec_count[cluster_idx];
+		}
+		result->addPolygon(polygonFromPoints(point_lists[cluster_idx]), vec_diff[cluster_idx]);
 	}
 	
 	return result;
@@ -316,23 +318,27 @@ WeightedPolygonList2D* polygonsFromClusteredVectorfield(SparseWeightedVectorfiel
  * new vectors until the radius threshold is reached. It then selects the next
  * (far-most) non-assigned vector and repeats the loop until no more assignments are
  * possible. 
+ * The cluster centres are kept in a uniform grid with a cell size of the radius
+ * threshold, so that each vector is only compared to the centres nearby.
  *
  * \param vectorfield The vectorfield to be thresholded.
  * \param max_4d_distance The maximum (4d) distance to be used for clustering. Defaults to 10.
  * \param min_weight The minimal weight of the vectors. Defaults to 0.
- * \param direction_weight weight for the directional component difference.
- * \param use_local Only use the local part of the vectors for clustering.
+ * \param direction_weight weight for the directional component difference. Defaults to 1.
+ * \param use_local Only use the local part of the vectors for clustering. Defaults to false.
  * \return A vector conataining the results: 
  *          First item:  The resulting (clustered) vectorfield (weight = cluster id).
- *          Second item: The vectorfield of the cluster centres. Defaults to 1.
- *          Third item:  The list of weighted polygons for the cluster results. Defaults to false.
+ *          Second item: The vectorfield of the cluster centres.
+ *          Third item:  The list of weighted polygons for the cluster results.
  */
 template <class Vectorfield_Type>
 std::vector<Model*> clusterVectorfieldGreedy(Vectorfield_Type * vectorfield,
                                              float max_4d_distance=10.0, float min_weight=0.0, float direction_weight=1.0,
                                              bool use_local=false)
 {
-    int feature_count = vectorfield->size();					//count of features
+	typedef SparseWeightedVectorfield2D::PointType Point2D;
+	
+    unsigned int feature_count = vectorfield->size();					//count of features
 	
 	SparseWeightedVectorfield2D * result_vectorfield = new SparseWeightedVectorfield2D(vectorfield->workspace());
 	SparseWeightedVectorfield2D * cluster_vectorfield = new SparseWeightedVectorfield2D(vectorfield->workspace());
@@ -344,103 +350,127 @@ std::vector<Model*> clusterVectorfieldGreedy(Vectorfield_Type * vectorfield,
 	result.push_back(result_vectorfield);
 	result.push_back(cluster_vectorfield);
 	
-	std::vector<int> cluster_id(feature_count);
-	int assigned_count=0;
+	//Bulk copies of the vectorfield's data
+	std::vector<Point2D> origins, directions;
+	vectorfield->copyOrigins(origins);
+	vectorfield->copyDirections(directions);
+	
+	const QTransform global_motion = vectorfield->globalMotion();
 	
-	for (int i=0; i< feature_count; ++i)
+	//The 4D point of a vector (or cluster centre) for the distance computations
+	auto point4D = [&](const Point2D& origin, const Point2D& direction) -> VectorPoint4D
 	{
-		cluster_id[i] = -1;
+		Point2D used_direction = direction;
+		
+		if(use_local)
+		{
+			used_direction = direction - (global_motion.map(origin) - origin);
+		}
+		return VectorPoint4D(origin.x(), origin.y(),
+							 direction_weight*used_direction.x(), direction_weight*used_direction.y());
+	};
+	
+	std::vector<VectorPoint4D> points(feature_count);
+	std::vector<float> weights(feature_count);
+	
+	for (unsigned int i=0; i< feature_count; ++i)
+	{
+		points[i]  = point4D(origins[i], directions[i]);
+		weights[i] = vectorfield->weight(i);
 	}
 	
+	std::vector<int> cluster_id(feature_count, -1);
+	
+	//The running means of the clusters
+	std::vector<Point2D> centre_origins, centre_directions;
+	std::vector<float> centre_weights;
+	std::vector<unsigned int> centre_counts;
+	std::vector<VectorPoint4D> centre_points;
+	
+	//The grid is not used for non-positive radii, since nothing can be assigned then
+	VectorCentreGrid grid(max_4d_distance > 0 ? max_4d_distance : 1.0f);
+	
+	auto addCluster = [&](unsigned int i)
+	{
+		cluster_id[i] = centre_points.size();
+		
+		centre_origins.push_back(origins[i]);
+		centre_directions.push_back(directions[i]);
+		centre_weights.push_back(weights[i]);
+		centre_counts.push_back(1);
+		centre_points.push_back(points[i]);
+		
+		grid.insert(cluster_id[i], points[i]);
+	};
+	
 	//initialze with first feature
-	cluster_id[0] = 0;
-	cluster_vectorfield->addVector(vectorfield->origin(0),vectorfield->direction(0), vectorfield->weight(0));
+	if(feature_count != 0)
+	{
+		addCluster(0);
+	}
 	
-	assigned_count=1;
-	bool did_assignment = true;
+	bool did_assignment = feature_count != 0;
 	
     while (did_assignment) 
 	{
 		did_assignment = false;
 		
-		//Find the closest neighbor for the current cluster centre
-		for (int i=0; i< feature_count; ++i)
+		//Find the closest cluster centre for each non-assigned vector
+		for (unsigned int i=0; i< feature_count; ++i)
 		{
-			if (cluster_id[i] != -1 || vectorfield->weight(i) < min_weight)
+			if (cluster_id[i] != -1 || weights[i] < min_weight || max_4d_distance <= 0)
 				continue;
 			
 			//initialize with maximal allowed distance
 			float min_cluster_distance = max_4d_distance;
 			int min_cluster_id = -1;
 			
-			for(unsigned int c=0; c<cluster_vectorfield->size(); c++)
+			//Closest centre, the first one (lowest id) on equal distances
+			auto testCentre = [&](unsigned int c)
 			{
-				float dist =   dist4D(cluster_vectorfield->origin(c), use_local ? cluster_vectorfield->localDirection(c) : cluster_vectorfield->direction(c),
-									  vectorfield->origin(i),         use_local ? vectorfield->localDirection(i): vectorfield->direction(i),
-									  direction_weight);
+				float dist = vectorDistance4D(centre_points[c], points[i]);
 				
-				if (dist<min_cluster_distance)
+				if (dist < min_cluster_distance || (dist == min_cluster_distance && min_cluster_id != -1 && (int)c < min_cluster_id))
 				{
 					min_cluster_distance = dist;
 					min_cluster_id = c;
 				}
-			}
+			};
+			grid.forEachCandidate(points[i], testCentre);
 			
 			if (min_cluster_id != -1)
 			{
-				//qDebug() << "\t\tAdding " << i << " to cluster " << min_cluster_id << "\n"
-				//<< "\t\t origin:    " << cluster_vectorfield->origin(min_cluster_id) << "\n"
-				//<< "\t\t direction: " << cluster_vectorfield->direction(min_cluster_id)  << "\n"
-				//<< "\t\t weight:    " <<  cluster_vectorfield->weight(min_cluster_id) << "\n\n";
-				
 				//Cluster gefunden:
 				cluster_id[i] = min_cluster_id;
-				assigned_count++;
 				did_assignment=true;
 				
 				//cog und richtung für dieses Cluster neu berechnen
-				unsigned int cluster_count = 0;
-				for(unsigned int c=0; c<cluster_id.size(); c++)
-				{
-					if (cluster_id[c] == min_cluster_id)
-					{
-						cluster_count++;
-					}
-				}
+				unsigned int cluster_count = ++centre_counts[min_cluster_id];
 				
-				//qDebug()	<< "cluster count found: " << cluster_count << "\n"
-				//		<< "\t\t new origin:    " << cluster_vectorfield->origin(min_cluster_id)*(cluster_count-1)/cluster_count
-				//								+ vectorfield->origin(i)/cluster_count << "\n"
-				//		<< "\t\t new direction: " << cluster_vectorfield->direction(min_cluster_id)*(cluster_count-1)/cluster_count
-				//								+ vectorfield->direction(i)/cluster_count << "\n"
-				//		<< "\t\t new weight:    " <<  cluster_vectorfield->weight(min_cluster_id)*(cluster_count-1)/cluster_count
-				//								+ vectorfield->weight(i)/cluster_count << "\n\n";
+				centre_origins[min_cluster_id]    = centre_origins[min_cluster_id]*(cluster_count-1)/cluster_count + origins[i]/cluster_count;
+				centre_directions[min_cluster_id] = centre_directions[min_cluster_id]*(cluster_count-1)/cluster_count + directions[i]/cluster_count;
+				centre_weights[min_cluster_id]    = centre_weights[min_cluster_id]*(cluster_count-1)/cluster_count + weights[i]/cluster_count;
 				
-				cluster_vectorfield->setOrigin(min_cluster_id,	  cluster_vectorfield->origin(min_cluster_id)*(cluster_count-1)/cluster_count
-											   + vectorfield->origin(i)/cluster_count);
-				cluster_vectorfield->setDirection(min_cluster_id,	cluster_vectorfield->direction(min_cluster_id)*(cluster_count-1)/cluster_count
-												  + vectorfield->direction(i)/cluster_count);
-				cluster_vectorfield->setWeight(min_cluster_id,	  cluster_vectorfield->weight(min_cluster_id)*(cluster_count-1)/cluster_count
-											   + vectorfield->weight(i)/cluster_count);
+				VectorPoint4D centre_point = point4D(centre_origins[min_cluster_id], centre_directions[min_cluster_id]);
+				grid.move(min_cluster_id, centre_points[min_cluster_id], centre_point);
+				centre_points[min_cluster_id] = centre_point;
 			}
 		}
 		//add new cluster
 		if(!did_assignment)
 		{
-			
 			float max_cluster_distance = 0;
 			int  new_feature_id = -1;
+			
 			//find the far-most non-assigned vector w.r.t. all already known cluster centers
-			for (int i=0; i< feature_count; ++i)
+			for (unsigned int i=0; i< feature_count; ++i)
 			{
-				if (cluster_id[i] != -1 || vectorfield->weight(i) < min_weight)
+				if (cluster_id[i] != -1 || weights[i] < min_weight)
 					continue;
 				
-				for(unsigned int c=0; c<cluster_vectorfield->size(); c++)
+				for(unsigned int c=0; c<centre_points.size(); c++)
 				{
-					float dist =   dist4D(cluster_vectorfield->origin(c), use_local ? cluster_vectorfield->localDirection(c) : cluster_vectorfield->direction(c),
-									      vectorfield->origin(i),         use_local ? vectorfield->localDirection(i): vectorfield->direction(i),
-										  direction_weight);
+					float dist = vectorDistance4D(centre_points[c], points[i]);
 					
 					if ( dist>max_cluster_distance)
 					{
@@ -453,28 +483,32 @@ std::vector<Model*> clusterVectorfieldGreedy(Vectorfield_Type * vectorfield,
 			if (new_feature_id != -1)
 			{
 				did_assignment = true;
-				//qDebug()	<< "\tAdding " << new_feature_id << " to new cluster " << cluster_vectorfield->size() << "\n"
-				//		<< "\t\t origin:    " << vectorfield->origin(new_feature_id) << "\n"
-				//		<< "\t\t direction: " << vectorfield->direction(new_feature_id)  << "\n"
-				//		<< "\t\t weight:    " <<  vectorfield->weight(new_feature_id) << "\n\n";
-				
-				//add new feature
-				cluster_id[new_feature_id] = cluster_vectorfield->size();
-				cluster_vectorfield->addVector(vectorfield->origin(new_feature_id),vectorfield->direction(new_feature_id),vectorfield->weight(new_feature_id));
-				assigned_count++;
+				addCluster(new_feature_id);
 			}
 		}
-		//qDebug() << "assigned " << assigned_count << " of " << feature_count << " elements to " <<  cluster_vectorfield->size() << " clusters\n";
 	}
 	
-	for (int i=0; i< feature_count; ++i)
+	//Coalesce all additions into one model update
+	ModelTransaction cluster_transaction(cluster_vectorfield);
+	cluster_vectorfield->reserve(centre_points.size());
+	
+	for(unsigned int c=0; c<centre_points.size(); c++)
 	{
-		if (vectorfield->weight(i) < min_weight)
+		cluster_vectorfield->addVector(centre_origins[c], centre_directions[c], centre_weights[c]);
+	}
+	cluster_transaction.commit();
+	
+	ModelTransaction transaction(result_vectorfield);
+	result_vectorfield->reserve(feature_count);
+	
+	for (unsigned int i=0; i< feature_count; ++i)
+	{
+		if (weights[i] < min_weight)
 			continue;
 		
-		//qDebug() << "adding vector " << i  << " with weight: " << cluster_id[i]+1 << "\n";
-		result_vectorfield->addVector(vectorfield->origin(i), vectorfield->direction(i), cluster_id[i]+1);
+		result_vectorfield->addVector(origins[i], directions[i], cluster_id[i]+1);
 	}
+	transaction.commit();
     
 	result.push_back(polygonsFromClusteredVectorfield(result_vectorfield, direction_weight));
 	return result;
@@ -483,13 +517,18 @@ std::vector<Model*> clusterVectorfieldGreedy(Vectorfield_Type * vectorfield,
 /**
  * K-means vectorfield clustering algorithm. This implements the well known
  * clustering algorithm for vectorfield. It uses the weighted 4d vector-distance
- * for distance measurement between the vectors.
+ * for distance measurement between the vectors. The vectors are flattened to
+ * 4D points first and then clustered by means of the VectorKMeansClustering,
+ * which uses k-means++ seeding, bound-based pruning and parallel assignments.
  *
  * \param vectorfield The vectorfield to be thresholded.
  * \param k The count of resulting clusters. Defaults to 10.
  * \param min_weight The minimal weight of the vectors. Defaults to 0.
  * \param direction_weight weight for the directional component difference. Defaults to 1.
  * \param use_local Only use the local part of the vectors for clustering. Defaults to false.
+ * \param max_iterations The maximum number of iterations. Defaults to 100.
+ * \param tolerance Stop, if no cluster centre moves further (4D distance). Defaults to 0.001.
+ * \param seed The seed for the random selection of the initial centres. Defaults to 0.
  * \return A vector conataining the results: 
  *          First item:  The resulting (clustered) vectorfield (weight = cluster id).
  *          Second item: The vectorfield of the cluster centres.
@@ -497,7 +536,7 @@ std::vector<Model*> clusterVectorfieldGreedy(Vectorfield_Type * vectorfield,
  */
 template <class Vectorfield_Type>
 std::vector<Model*> clusterVectorfieldKMeans(Vectorfield_Type * vectorfield, unsigned int k=10, float min_weight=0.0, float direction_weight =1.0,
-											 bool use_local = false)
+											 bool use_local = false, unsigned int max_iterations=100, float tolerance=1.0e-3f, unsigned int seed=0)
 {
 	typedef SparseWeightedVectorfield2D::PointType Point2D;
     
@@ -513,114 +552,81 @@ std::vector<Model*> clusterVectorfieldKMeans(Vectorfield_Type * vectorfield, uns
 	result.push_back(result_vectorfield);
 	result.push_back(cluster_vectorfield);
 	
-	//qDebug() << "computing real feature count\n";
+	//Bulk copies of the vectorfield's data
+	std::vector<Point2D> origins, directions, cluster_directions;
+	vectorfield->copyOrigins(origins);
+	vectorfield->copyDirections(directions);
 	
-	unsigned int real_feature_count=0;
-	for (unsigned int i=0; i< feature_count; ++i)
+	if(use_local)
 	{
-		if(vectorfield->weight(i) >= min_weight)
-			real_feature_count++;
+		vectorfield->localDirections(cluster_directions);
 	}
-    k = std::min(real_feature_count,k);
 	
+	const std::vector<Point2D>& used_directions = use_local ? cluster_directions : directions;
+	
+	//Flatten the vectors above the minimal weight to 4D points
+	std::vector<unsigned int> indices;
+	std::vector<VectorPoint4D> points;
+	indices.reserve(feature_count);
+	points.reserve(feature_count);
 	
-	//qDebug() << "preparing cluster assignment array\n";
-	std::vector<int> cluster_id(feature_count);
 	for (unsigned int i=0; i< feature_count; ++i)
 	{
-		cluster_id[i] = -1;
+		if(vectorfield->weight(i) >= min_weight)
+		{
+			indices.push_back(i);
+			points.push_back(VectorPoint4D(origins[i].x(), origins[i].y(),
+										   direction_weight*used_directions[i].x(), direction_weight*used_directions[i].y()));
+		}
 	}
 	
-	//qDebug() << "initial selection of " << k << " seeds\n";
-	//initial selection of n seeds
-	while( cluster_vectorfield->size() != k)
+	VectorKMeansClustering kmeans(k, max_iterations, tolerance, seed);
+	kmeans.cluster(points);
+	
+	const std::vector<int>& labels = kmeans.labels();
+	const unsigned int cluster_count = (unsigned int)kmeans.clusterSizes().size();
+	
+	//Compute the cluster centres w.r.t. the complete directions and the weights
+	std::vector<Point2D> center_origins(cluster_count, Point2D(0,0)),
+						 center_directions(cluster_count, Point2D(0,0));
+	std::vector<float> center_weights(cluster_count, 0.0f);
+	
+	for (unsigned int j=0; j< indices.size(); ++j)
 	{
-		unsigned int rand_id = rand() % feature_count;
+		unsigned int i = indices[j];
+		int c = labels[j];
 		
-		if(cluster_id[rand_id] == -1 && vectorfield->weight(rand_id) >= min_weight)
-		{
-			//qDebug() << "\tadding cluster from vector " << rand_id << "\n";
-			cluster_id[rand_id] =  cluster_vectorfield->size();
-			cluster_vectorfield->addVector(vectorfield->origin(rand_id), vectorfield->direction(rand_id),vectorfield->weight(rand_id));
-		}
+		//Skip unassigned vectors (no clusters)
+		if(c < 0 || c >= int(cluster_count))
+			continue;
+		
+		center_origins[c]    += origins[i];
+		center_directions[c] += directions[i];
+		center_weights[c]    += vectorfield->weight(i);
 	}
 	
-	bool assignment_changed=true;
+	//Coalesce all additions into one model update
+	ModelTransaction cluster_transaction(cluster_vectorfield);
+	cluster_vectorfield->reserve(cluster_count);
 	
-    while (assignment_changed) 
+	for(unsigned int c=0; c<cluster_count; c++)
 	{
-		assignment_changed=false;
+		float size = std::max(1u, kmeans.clusterSizes()[c]);
 		
-		//1. Prepare new clusters for next run...
-		for(unsigned int c=0; c<cluster_vectorfield->size(); c++)
-		{
-			//qDebug() << "moving cluster center from " << cluster_vectorfield->origin(c) << " to ";
-			//cog und richtung für dieses Cluster neu berechnen
-			cluster_vectorfield->setOrigin(c,Point2D(0,0));
-			cluster_vectorfield->setDirection(c,Point2D(0,0));
-			cluster_vectorfield->setWeight(c,0);
-			
-			unsigned int cluster_count = 0;
-			for(unsigned int i=0; i<cluster_id.size(); i++)
-			{
-				if (cluster_id[i] == c)
-				{
-					cluster_count++;
-					cluster_vectorfield->setOrigin(c,	  cluster_vectorfield->origin(c) + vectorfield->origin(i));
-					cluster_vectorfield->setDirection(c,  cluster_vectorfield->direction(c) + vectorfield->direction(i));
-					cluster_vectorfield->setWeight(c,	  cluster_vectorfield->weight(c) + vectorfield->weight(i));
-				}
-			}
-			if(cluster_count !=0)
-			{
-				cluster_vectorfield->setOrigin(c,	  cluster_vectorfield->origin(c)/(float)cluster_count);
-				cluster_vectorfield->setDirection(c,  cluster_vectorfield->direction(c)/(float)cluster_count);
-				cluster_vectorfield->setWeight(c,	  cluster_vectorfield->weight(c)/(float)cluster_count);
-				//qDebug() << cluster_vectorfield->origin(c) << "\n";
-			}
-		}
-
-		
-		//2. Finde das nächste Clusterzentrum für jeden Vektor
-		for (unsigned int i=0; i< feature_count; ++i)
-		{
-			if (vectorfield->weight(i) < min_weight)
-				continue;
-			
-			float min_cluster_distance = vigra::NumericTraits<float>::max();
-			int min_cluster_id = -1;
-			
-			for(unsigned int c=0; c<cluster_vectorfield->size(); c++)
-			{
-				float dist =   dist4D(cluster_vectorfield->origin(c), use_local ? cluster_vectorfield->localDirection(c) : cluster_vectorfield->direction(c),
-									  vectorfield->origin(i),         use_local ? vectorfield->localDirection(i): vectorfield->direction(i),
-									  direction_weight);
-				
-				if ( dist<min_cluster_distance)
-				{
-					min_cluster_distance = dist;
-					min_cluster_id = c;
-				}
-			}
-				
-			//neuer Cluster gefunden:
-			if(cluster_id[i] != min_cluster_id)
-			{
-				//qDebug() << "\tmoving " << i << " from cluster " << cluster_id[i] << " to cluster " << min_cluster_id << "\n";
-				assignment_changed=true;
-				cluster_id[i] = min_cluster_id;
-			}
-		}	
+		cluster_vectorfield->addVector(center_origins[c]/size, center_directions[c]/size, center_weights[c]/size);
 	}
+	cluster_transaction.commit();
 	
-	for (unsigned int i=0; i< feature_count; ++i)
+	ModelTransaction transaction(result_vectorfield);
+	result_vectorfield->reserve(indices.size());
+	
+	for (unsigned int j=0; j< indices.size(); ++j)
 	{
-		if (vectorfield->weight(i) < min_weight)
-			continue;
+		unsigned int i = indices[j];
 		
-		//qDebug() << "adding vector " << i  << " with weight: " << cluster_id[i]+1 << "\n"; 
-		result_vectorfield->addVector(vectorfield->origin(i), vectorfield->direction(i), cluster_id[i]+1);
+		result_vectorfield->addVector(origins[i], directions[i], labels[j]+1);
 	}
+	transaction.commit();
     
 	result.push_back(polygonsFromClusteredVectorfield(result_vectorfield, direction_weight));
 	return result;
@@ -361,9 +361,12 @@ class VectorfieldClustererKMeans
         {
             m_parameters->addParameter("vf", new ModelParameter("Vectorfield", "SparseWeightedVectorfield2D|SparseWeightedMultiVectorfield2D", NULL, false, wsp));
             m_parameters->addParameter("weight-dir", new FloatParameter("weight direction for clustering", 0.0, 9999, 1.0));
-            m_parameters->addParameter("k", new IntParameter("k (count of clusters)", 0.0, 9999, 10));
+            m_parameters->addParameter("k", new IntParameter("k (count of clusters)", 1, 9999, 10));
             m_parameters->addParameter("weightT",  new FloatParameter("weight threshold", 0.0, 9999, 0.0));
             m_parameters->addParameter("use_local_vectors?", new BoolParameter("use local vectors", false));
+            m_parameters->addParameter("max_iterations", new IntParameter("maximum iterations", 1, 99999, 100));
+            m_parameters->addParameter("tolerance", new FloatParameter("stop if centres move less than", 0.0, 9999, 0.001));
+            m_parameters->addParameter("seed", new IntParameter("random seed", 0, 999999, 0));
         }
         QString typeName() const
         {
@@ -392,6 +395,9 @@ class VectorfieldClustererKMeans
                     IntParameter		* param_k = static_cast<IntParameter*>((*m_parameters)["k"]);
                     FloatParameter	* param_threshold = static_cast<FloatParameter*>((*m_parameters)["weightT"]);
                     BoolParameter	    * param_use_local = static_cast<BoolParameter*>((*m_parameters)["use_local_vectors?"]);
+                    IntParameter		* param_max_iterations = static_cast<IntParameter*>((*m_parameters)["max_iterations"]);
+                    FloatParameter	* param_tolerance = static_cast<FloatParameter*>((*m_parameters)["tolerance"]);
+                    IntParameter		* param_seed = static_cast<IntParameter*>((*m_parameters)["seed"]);
                     
                     SparseVectorfield2D* current_vf = static_cast<SparseVectorfield2D* >(  param_vf->value() );	
                     
@@ -401,10 +407,12 @@ class VectorfieldClustererKMeans
                     
                     if(current_vf->typeName() =="SparseWeightedVectorfield2D")
                     {
-                        results = clusterVectorfieldKMeans(static_cast<SparseWeightedVectorfield2D*>(current_vf), param_k->value(), param_threshold->value(), param_direction_weight->value(), param_use_local->value());
+                        results = clusterVectorfieldKMeans(static_cast<SparseWeightedVectorfield2D*>(current_vf), param_k->value(), param_threshold->value(), param_direction_weight->value(), param_use_local->value(),
+                                                           param_max_iterations->value(), param_tolerance->value(), param_seed->value());
                     }
                     else {
-                        results = clusterVectorfieldKMeans(static_cast<SparseWeightedMultiVectorfield2D*>(current_vf), param_k->value(), param_threshold->value(), param_direction_weight->value(), param_use_local->value());
+                        results = clusterVectorfieldKMeans(static_cast<SparseWeightedMultiVectorfield2D*>(current_vf), param_k->value(), param_threshold->value(), param_direction_weight->value(), param_use_local->value(),
+                                                           param_max_iterations->value(), param_tolerance->value(), param_seed->value());
                     }
                     
                     results[0]->setName(QString("K-Means Labeled cluster vectors ") + current_vf->name());
@@ -458,6 +466,122 @@ Algorithm* createVectorfieldClustererKMeans(Workspace* wsp)
 
 
 
+/**
+ * The names of the storage modes of dense vectorfields, in order of
+ * DenseVectorfield2D::StorageMode.
+ *
+ * \return The names of all storage modes.
+ */
+static QStringList storage_mode_names()
+{
+	QStringList storage_mode_names;
+	storage_mode_names.append("Float (32 bit)");
+	storage_mode_names.append("Half precision float (16 bit)");
+	storage_mode_names.append("Quantized integer (16 bit)");
+	return storage_mode_names;
+}
+
+/**
+ * This class converts a dense vectorfield to another storage mode by means of
+ * an graipe::Algorithm. Since the source is locked during the run, the result
+ * is a converted copy of the vectorfield.
+ */
+class DenseVectorfieldStorageConverter
+:   public Algorithm
+{
+    public:
+        /**
+         * Default constructor. Adds all neccessary parameters for this algorithm to run.
+         */
+        DenseVectorfieldStorageConverter(Workspace* wsp)
+        : Algorithm(wsp)
+        {
+            m_parameters->addParameter("vf",   new ModelParameter("Vectorfield", "DenseVectorfield2D|DenseWeightedVectorfield2D", NULL, false, wsp));
+            m_parameters->addParameter("mode", new EnumParameter("Storage mode", storage_mode_names()));
+        }
+        QString typeName() const
+        {
+            return "DenseVectorfieldStorageConverter";
+        }
+        
+        /**
+         * Specialization of the running phase of this algorithm.
+         */
+        void run()
+        {
+            if(!parametersValid())
+            {
+                //Parameters set incorrectly
+                emit errorMessage(QString("Some parameters are not available"));
+            }
+            else
+            {
+                lockModels();
+                try 
+                {
+                    emit statusMessage(0.0, QString("started"));
+                        
+                    ModelParameter	* param_vf   = static_cast<ModelParameter*> ((*m_parameters)["vf"]);
+                    EnumParameter	* param_mode = static_cast<EnumParameter*>((*m_parameters)["mode"]);
+                    
+                    DenseVectorfield2D* current_vf = static_cast<DenseVectorfield2D* >(  param_vf->value() );	
+                    
+                    emit statusMessage(1.0, QString("starting conversion"));
+                    
+                    DenseVectorfield2D* new_vf;
+                    
+                    if(current_vf->typeName() == "DenseWeightedVectorfield2D")
+                    {
+                        new_vf = new DenseWeightedVectorfield2D(*static_cast<DenseWeightedVectorfield2D*>(current_vf));
+                    }
+                    else
+                    {
+                        new_vf = new DenseVectorfield2D(*current_vf);
+                    }
+                    
+                    new_vf->setStorageMode(DenseVectorfield2D::StorageMode(param_mode->value()));
+                    
+                    new_vf->setName(current_vf->name() + QString(" (") + param_mode->toString() + QString(")"));
+                    
+                    QString descr("The following parameters were used for the storage conversion:\n");
+                    descr += m_parameters->valueText("ModelParameter");
+                    new_vf->setDescription(descr);
+                    
+                    current_vf->copyGeometry(*new_vf);
+                    new_vf->setScale(current_vf->scale());
+                    
+                    m_results.push_back(new_vf);
+                    
+                    emit statusMessage(100.0, QString("finished conversion"));
+                    emit finished();
+                }
+                catch(std::exception& e)
+                {
+                    emit errorMessage(QString("Explainable error occured: ") + QString::fromStdString(e.what()));
+                }
+                catch(...)
+                {
+                    emit errorMessage(QString("Non-explainable error occured"));		
+                }
+                unlockModels();
+            }
+        }
+};
+
+/** 
+ * Creates one instance of the dense vectorfield storage
+ * conversion algorithm defined above.
+ *
+ * \return A new instance of the DenseVectorfieldStorageConverter.
+ */
+Algorithm* createDenseVectorfieldStorageConverter(Workspace* wsp)
+{
+	return new DenseVectorfieldStorageConverter(wsp);
+}
+
+
+
+
 /**
  * This class encapsulates all the functionality of this module in a 
  * way that it can be used within graipe. To achieve this, it extends
@@ -535,6 +659,12 @@ class VectorfieldProcessingModule
 			alg_item.algorithm_fptr = &createVectorfieldClustererKMeans;
 			alg_factory.push_back(alg_item);
 			
+			//5. Storage mode of dense vectorfields
+			alg_item.algorithm_name = "Set dense vectorfield storage mode";
+            alg_item.algorithm_type = "DenseVectorfieldStorageConverter";
+			alg_item.algorithm_fptr = &createDenseVectorfieldStorageConverter;
+			alg_factory.push_back(alg_item);
+			
 			
 			return alg_factory;
 		}
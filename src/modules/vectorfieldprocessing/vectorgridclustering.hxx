@@ -0,0 +1,178 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_VECTORFIELDPROCESSING_VECTORGRIDCLUSTERING_HXX
+#define GRAIPE_VECTORFIELDPROCESSING_VECTORGRIDCLUSTERING_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "vectorfieldprocessing/vectorkmeans.hxx"
+
+namespace graipe {
+
+/**
+ * A uniform grid over the positions of the (moving) cluster centres of the
+ * greedy vectorfield clustering. The size of the cells is given by the maximal
+ * distance of a vector to its cluster centre. Since the position part of the
+ * 4D distance is never larger than the complete distance, all centres within
+ * this distance of a point are located in the 3x3 cells around the point's cell.
+ * Only non-empty cells are stored.
+ */
+class VectorCentreGrid
+{
+    public:
+        /**
+         * Constructor of an empty grid.
+         *
+         * \param cell_size The size of each cell, must be larger than zero.
+         */
+        VectorCentreGrid(float cell_size)
+        :   m_cell_size(cell_size)
+        {
+        }
+    
+        /**
+         * Adds a centre to the grid.
+         *
+         * \param id The id of the centre.
+         * \param p  The position of the centre.
+         */
+        void insert(unsigned int id, const VectorPoint4D& p)
+        {
+            m_cells[cellKey(cellX(p[0]), cellY(p[1]))].push_back(id);
+        }
+    
+        /**
+         * Moves a centre inside the grid.
+         *
+         * \param id    The id of the centre.
+         * \param old_p The former position of the centre.
+         * \param new_p The new position of the centre.
+         */
+        void move(unsigned int id, const VectorPoint4D& old_p, const VectorPoint4D& new_p)
+        {
+            const unsigned long long old_key = cellKey(cellX(old_p[0]), cellY(old_p[1])),
+                                     new_key = cellKey(cellX(new_p[0]), cellY(new_p[1]));
+            
+            if(old_key != new_key)
+            {
+                std::vector<unsigned int>& old_cell = m_cells[old_key];
+                old_cell.erase(std::find(old_cell.begin(), old_cell.end(), id));
+                
+                if(old_cell.empty())
+                {
+                    m_cells.erase(old_key);
+                }
+                m_cells[new_key].push_back(id);
+            }
+        }
+    
+        /**
+         * Calls a functor for the id of each centre inside the 3x3 cells
+         * around a given point.
+         *
+         * \param p The point.
+         * \param f The functor, which will be called with each id.
+         */
+        template<class Functor>
+        void forEachCandidate(const VectorPoint4D& p, Functor& f) const
+        {
+            const long long cx = cellX(p[0]), cy = cellY(p[1]);
+            
+            for(long long x=cx-1; x<=cx+1; ++x)
+            {
+                for(long long y=cy-1; y<=cy+1; ++y)
+                {
+                    std::unordered_map<unsigned long long, std::vector<unsigned int> >::const_iterator cell = m_cells.find(cellKey(x, y));
+                    
+                    if(cell != m_cells.end())
+                    {
+                        for(unsigned int id : cell->second)
+                        {
+                            f(id);
+                        }
+                    }
+                }
+            }
+        }
+    
+    private:
+        /**
+         * The x-coordinate of the cell for a given x-position.
+         *
+         * \param x The x-position.
+         * \return The x-coordinate of the corresponding cell.
+         */
+        long long cellX(float x) const
+        {
+            return (long long)std::floor(x/m_cell_size);
+        }
+    
+        /**
+         * The y-coordinate of the cell for a given y-position.
+         *
+         * \param y The y-position.
+         * \return The y-coordinate of the corresponding cell.
+         */
+        long long cellY(float y) const
+        {
+            return (long long)std::floor(y/m_cell_size);
+        }
+    
+        /**
+         * The key of a cell, which combines both cell coordinates.
+         *
+         * \param x The x-coordinate of the cell.
+         * \param y The y-coordinate of the cell.
+         * \return The key of the cell.
+         */
+        static unsigned long long cellKey(long long x, long long y)
+        {
+            return ((unsigned long long)x << 32) | ((unsigned long long)y & 0xFFFFFFFFull);
+        }
+    
+        /** The size of each cell **/
+        float m_cell_size;
+        /** The ids of the centres of each non-empty cell **/
+        std::unordered_map<unsigned long long, std::vector<unsigned int> > m_cells;
+};
+
+} //end of namespace graipe
+
+#endif //GRAIPE_VECTORFIELDPROCESSING_VECTORGRIDCLUSTERING_HXX
@@ -0,0 +1,620 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_VECTORFIELDPROCESSING_VECTORKMEANS_HXX
+#define GRAIPE_VECTORFIELDPROCESSING_VECTORKMEANS_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <vigra/tinyvector.hxx>
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+namespace graipe {
+
+/**
+ * The flat 4D representation of a vector for the clustering algorithms:
+ * (x-position, y-position, weighted x-direction, weighted y-direction).
+ */
+typedef vigra::TinyVector<float,4> VectorPoint4D;
+
+/**
+ * The distance between two 4D points. It is the sum of the euclidean distance
+ * of the positions and the euclidean distance of the (weighted) directions.
+ * Since this is a metric, it may be used for the triangle inequality based
+ * pruning of the k-means clustering. With the direction weight applied to the
+ * directions before, it is equal to dist4D().
+ *
+ * \param a The first point.
+ * \param b The second point.
+ * \return The distance of both points.
+ */
+inline float vectorDistance4D(const VectorPoint4D& a, const VectorPoint4D& b)
+{
+    const float dx = a[0]-b[0], dy = a[1]-b[1],
+                du = a[2]-b[2], dv = a[3]-b[3];
+    
+    return std::sqrt(dx*dx + dy*dy) + std::sqrt(du*du + dv*dv);
+}
+
+/**
+ * A task of the k-means clustering. Each task processes a contiguous block of points.
+ * There are two kinds of passes:
+ * - The seeding pass updates the distances of the points to their nearest seed.
+ * - The assignment pass assigns each point to its nearest centre by means of
+ *   Hamerly's bounds and accumulates the sums of the new centres.
+ */
+class KMeansTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor of a task.
+         *
+         * \param points The points.
+         * \param centers The current centres.
+         * \param begin The first point of this task.
+         * \param end The point after the last point of this task.
+         */
+        KMeansTask(const std::vector<VectorPoint4D>& points,
+                   const std::vector<VectorPoint4D>& centers,
+                   std::size_t begin, std::size_t end)
+        :   m_points(points),
+            m_centers(centers),
+            m_begin(begin),
+            m_end(end),
+            m_seeding_pass(true),
+            m_initial(true),
+            m_min_dist(NULL),
+            m_labels(NULL),
+            m_upper(NULL),
+            m_lower(NULL),
+            m_half_dist(NULL),
+            m_drift(NULL)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Prepares the seeding pass, which updates the distances to the nearest seed
+         * by means of the last added seed.
+         *
+         * \param min_dist The distances of the points to their nearest seed.
+         */
+        void prepareSeeding(std::vector<float>* min_dist)
+        {
+            m_seeding_pass = true;
+            m_min_dist = min_dist;
+            sum_sq_dist = 0;
+        }
+    
+        /**
+         * Prepares the assignment pass.
+         *
+         * \param labels The current labels of the points.
+         * \param upper The upper bounds of the distances to the assigned centres.
+         * \param lower The lower bounds of the distances to the second nearest centres.
+         * \param half_dist The half distances of each centre to its nearest other centre.
+         * \param drift The drift of each centre since the last pass.
+         * \param initial If true, all distances are computed and the drift is ignored.
+         */
+        void prepareAssignment(std::vector<int>* labels, std::vector<float>* upper, std::vector<float>* lower,
+                               const std::vector<float>* half_dist, const std::vector<float>* drift,
+                               bool initial)
+        {
+            m_seeding_pass = false;
+            m_labels = labels;
+            m_upper = upper;
+            m_lower = lower;
+            m_half_dist = half_dist;
+            m_drift = drift;
+            m_initial = initial;
+            
+            sums.assign(m_centers.size(), vigra::TinyVector<double,4>(0.0));
+            counts.assign(m_centers.size(), 0);
+            changes = 0;
+        }
+    
+        /**
+         * Processes the block of points, called by the thread pool.
+         */
+        void run()
+        {
+            if(m_seeding_pass)
+            {
+                runSeeding();
+            }
+            else
+            {
+                runAssignment();
+            }
+        }
+    
+        /** The sum of the squared distances to the nearest seed (seeding pass) **/
+        double sum_sq_dist;
+        /** The sums of the points per centre (assignment pass) **/
+        std::vector<vigra::TinyVector<double,4> > sums;
+        /** The count of points per centre (assignment pass) **/
+        std::vector<unsigned int> counts;
+        /** The count of changed labels (assignment pass) **/
+        std::size_t changes;
+    
+    private:
+        /**
+         * The seeding pass.
+         */
+        void runSeeding()
+        {
+            const VectorPoint4D& seed = m_centers.back();
+            std::vector<float>& min_dist = *m_min_dist;
+            
+            for(std::size_t i=m_begin; i<m_end; ++i)
+            {
+                min_dist[i] = std::min(min_dist[i], vectorDistance4D(m_points[i], seed));
+                sum_sq_dist += double(min_dist[i])*min_dist[i];
+            }
+        }
+    
+        /**
+         * The assignment pass (Hamerly's algorithm).
+         */
+        void runAssignment()
+        {
+            const unsigned int k = (unsigned int)m_centers.size();
+            
+            std::vector<int>& labels = *m_labels;
+            std::vector<float>& upper = *m_upper;
+            std::vector<float>& lower = *m_lower;
+            
+            //The largest and second largest drift for the update of the lower bounds
+            float max_drift = 0, second_max_drift = 0;
+            int max_drift_id = -1;
+            
+            if(!m_initial)
+            {
+                for(unsigned int c=0; c<k; ++c)
+                {
+                    float d = (*m_drift)[c];
+                    
+                    if(d > max_drift)
+                    {
+                        second_max_drift = max_drift;
+                        max_drift = d;
+                        max_drift_id = c;
+                    }
+                    else if(d > second_max_drift)
+                    {
+                        second_max_drift = d;
+                    }
+                }
+            }
+            
+            for(std::size_t i=m_begin; i<m_end; ++i)
+            {
+                const VectorPoint4D& p = m_points[i];
+                int label = labels[i];
+                
+                bool full_scan = m_initial;
+                
+                if(!m_initial)
+                {
+                    upper[i] += (*m_drift)[label];
+                    lower[i] -= (label == max_drift_id) ? second_max_drift : max_drift;
+                    
+                    const float bound = std::max((*m_half_dist)[label], lower[i]);
+                    
+                    if(upper[i] > bound)
+                    {
+                        //Tighten the upper bound and test again
+                        upper[i] = vectorDistance4D(p, m_centers[label]);
+                        full_scan = upper[i] > bound;
+                    }
+                }
+                
+                if(full_scan)
+                {
+                    float best = std::numeric_limits<float>::max(),
+                          second = std::numeric_limits<float>::max();
+                    int best_id = 0;
+                    
+                    for(unsigned int c=0; c<k; ++c)
+                    {
+                        float d = vectorDistance4D(p, m_centers[c]);
+                        
+                        if(d < best)
+                        {
+                            second = best;
+                            best = d;
+                            best_id = c;
+                        }
+                        else if(d < second)
+                        {
+                            second = d;
+                        }
+                    }
+                    
+                    if(best_id != label)
+                    {
+                        changes++;
+                        label = labels[i] = best_id;
+                    }
+                    upper[i] = best;
+                    lower[i] = second;
+                }
+                
+                sums[label] += p;
+                counts[label]++;
+            }
+        }
+    
+        /** The points **/
+        const std::vector<VectorPoint4D>& m_points;
+        /** The current centres **/
+        const std::vector<VectorPoint4D>& m_centers;
+        /** The block range **/
+        std::size_t m_begin, m_end;
+        /** Which pass is computed **/
+        bool m_seeding_pass;
+        /** Is this the initial assignment pass? **/
+        bool m_initial;
+    
+        /** The distances to the nearest seed (seeding pass) **/
+        std::vector<float>* m_min_dist;
+        /** The per point state (assignment pass) **/
+        std::vector<int>*   m_labels;
+        std::vector<float>* m_upper;
+        std::vector<float>* m_lower;
+        /** The per centre state (assignment pass) **/
+        const std::vector<float>* m_half_dist;
+        const std::vector<float>* m_drift;
+};
+
+/**
+ * K-means clustering of flat 4D points, as used for the clustering of vectorfields.
+ * The seeds are selected by means of the k-means++ approach using a seeded random
+ * number generator, so that the results are reproducible. The assignment step
+ * uses Hamerly's bounds to skip most of the distance computations and is processed
+ * in parallel by a thread pool. The clustering stops, if no assignment has changed,
+ * if no centre has moved more than the tolerance, or after the maximum number of 
+ * iterations.
+ */
+class VectorKMeansClustering
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param k The count of clusters.
+         * \param max_iterations The maximum number of iterations.
+         * \param tolerance The minimum movement of the centres to continue the iterations.
+         * \param seed The seed of the random number generator.
+         */
+        VectorKMeansClustering(unsigned int k, unsigned int max_iterations=100, float tolerance=1.0e-3f, unsigned int seed=0)
+        :   m_k(k),
+            m_max_iterations(max_iterations),
+            m_tolerance(tolerance),
+            m_seed(seed),
+            m_iterations(0),
+            m_converged(false)
+        {
+        }
+    
+        /**
+         * Clusters a set of points.
+         *
+         * \param points The points.
+         * \return The number of iterations.
+         */
+        unsigned int cluster(const std::vector<VectorPoint4D>& points)
+        {
+            const std::size_t n = points.size();
+            const unsigned int k = (unsigned int)std::min<std::size_t>(m_k, n);
+            
+            m_centers.clear();
+            m_labels.assign(n, -1);
+            m_sizes.assign(k, 0);
+            m_iterations = 0;
+            m_converged = false;
+            
+            if(k == 0)
+            {
+                return 0;
+            }
+            
+            //Blocks of less than 16k points are not worth a thread
+            const std::size_t min_block_size = 1<<14;
+            
+            const std::size_t thread_count = std::max<std::size_t>(1, std::min<std::size_t>(QThread::idealThreadCount(), n/min_block_size)),
+                              block_size = (n + thread_count - 1)/thread_count;
+            
+            std::vector<KMeansTask*> tasks;
+            for(std::size_t t=0; t<thread_count; ++t)
+            {
+                tasks.push_back(new KMeansTask(points, m_centers, std::min(n, t*block_size), std::min(n, (t+1)*block_size)));
+            }
+            
+            QThreadPool pool;
+            pool.setMaxThreadCount(thread_count);
+            
+            selectSeeds(points, k, tasks, pool, block_size);
+            
+            //Per point bounds and per centre state
+            std::vector<float> upper(n), lower(n), half_dist(k), drift(k, 0.0f);
+            
+            for(m_iterations=1; m_iterations <= m_max_iterations; ++m_iterations)
+            {
+                computeHalfDistances(half_dist);
+                
+                for(KMeansTask* task : tasks)
+                {
+                    task->prepareAssignment(&m_labels, &upper, &lower, &half_dist, &drift, m_iterations==1);
+                }
+                runTasks(tasks, pool);
+                
+                //Merge the block results
+                std::vector<vigra::TinyVector<double,4> > sums(k, vigra::TinyVector<double,4>(0.0));
+                std::size_t changes = 0;
+                
+                m_sizes.assign(k, 0);
+                
+                for(KMeansTask* task : tasks)
+                {
+                    for(unsigned int c=0; c<k; ++c)
+                    {
+                        sums[c] += task->sums[c];
+                        m_sizes[c] += task->counts[c];
+                    }
+                    changes += task->changes;
+                }
+                
+                if(m_iterations > 1 && changes == 0)
+                {
+                    m_converged = true;
+                    break;
+                }
+                
+                //Move the centres to the mean of their points (empty clusters stay)
+                float max_drift = 0;
+                
+                for(unsigned int c=0; c<k; ++c)
+                {
+                    drift[c] = 0;
+                    
+                    if(m_sizes[c] != 0)
+                    {
+                        VectorPoint4D new_center(sums[c]/double(m_sizes[c]));
+                        
+                        drift[c] = vectorDistance4D(m_centers[c], new_center);
+                        m_centers[c] = new_center;
+                        max_drift = std::max(max_drift, drift[c]);
+                    }
+                }
+                
+                if(max_drift <= m_tolerance)
+                {
+                    m_converged = true;
+                    break;
+                }
+            }
+            m_iterations = std::min(m_iterations, m_max_iterations);
+            
+            for(KMeansTask* task : tasks)
+            {
+                delete task;
+            }
+            return m_iterations;
+        }
+    
+        /**
+         * The centres of the clusters after the last call of cluster().
+         *
+         * \return The centres.
+         */
+        const std::vector<VectorPoint4D>& centers() const
+        {
+            return m_centers;
+        }
+    
+        /**
+         * The cluster index of each point after the last call of cluster().
+         *
+         * \return The labels of the points.
+         */
+        const std::vector<int>& labels() const
+        {
+            return m_labels;
+        }
+    
+        /**
+         * The count of points of each cluster after the last call of cluster().
+         *
+         * \return The sizes of the clusters.
+         */
+        const std::vector<unsigned int>& clusterSizes() const
+        {
+            return m_sizes;
+        }
+    
+        /**
+         * The number of iterations of the last call of cluster().
+         *
+         * \return The number of iterations.
+         */
+        unsigned int iterations() const
+        {
+            return m_iterations;
+        }
+    
+        /**
+         * Did the last call of cluster() converge before the maximum
+         * number of iterations?
+         *
+         * \return True, if the clustering has converged.
+         */
+        bool converged() const
+        {
+            return m_converged;
+        }
+    
+    private:
+        /**
+         * Runs all tasks, the first one in the calling thread.
+         *
+         * \param tasks The tasks.
+         * \param pool The thread pool.
+         */
+        static void runTasks(const std::vector<KMeansTask*>& tasks, QThreadPool& pool)
+        {
+            for(std::size_t t=1; t<tasks.size(); ++t)
+            {
+                pool.start(tasks[t]);
+            }
+            tasks[0]->run();
+            pool.waitForDone();
+        }
+    
+        /**
+         * Selection of the seeds by means of k-means++: Each further seed is drawn
+         * with a probability proportional to the squared distance to the nearest seed.
+         *
+         * \param points The points.
+         * \param k The count of seeds.
+         * \param tasks The tasks.
+         * \param pool The thread pool.
+         * \param block_size The count of points per task.
+         */
+        void selectSeeds(const std::vector<VectorPoint4D>& points, unsigned int k,
+                         const std::vector<KMeansTask*>& tasks, QThreadPool& pool, std::size_t block_size)
+        {
+            const std::size_t n = points.size();
+            
+            std::mt19937 rng(m_seed);
+            std::vector<float> min_dist(n, std::numeric_limits<float>::max());
+            
+            m_centers.push_back(points[std::uniform_int_distribution<std::size_t>(0, n-1)(rng)]);
+            
+            while(m_centers.size() < k)
+            {
+                for(KMeansTask* task : tasks)
+                {
+                    task->prepareSeeding(&min_dist);
+                }
+                runTasks(tasks, pool);
+                
+                double total = 0;
+                for(KMeansTask* task : tasks)
+                {
+                    total += task->sum_sq_dist;
+                }
+                
+                std::size_t next = std::uniform_int_distribution<std::size_t>(0, n-1)(rng);
+                
+                //All points coincide with seeds: take a random one
+                if(total > 0)
+                {
+                    double r = std::uniform_real_distribution<double>(0, total)(rng);
+                    
+                    //Find the block first, then the point inside the block
+                    std::size_t t = 0;
+                    while(t+1 < tasks.size() && r >= tasks[t]->sum_sq_dist)
+                    {
+                        r -= tasks[t]->sum_sq_dist;
+                        ++t;
+                    }
+                    
+                    const std::size_t begin = std::min(n, t*block_size),
+                                      end   = std::min(n, (t+1)*block_size);
+                    
+                    next = end-1;
+                    for(std::size_t i=begin; i<end; ++i)
+                    {
+                        r -= double(min_dist[i])*min_dist[i];
+                        if(r < 0)
+                        {
+                            next = i;
+                            break;
+                        }
+                    }
+                }
+                m_centers.push_back(points[next]);
+            }
+        }
+    
+        /**
+         * Computes for each centre the half distance to its nearest other centre.
+         *
+         * \param half_dist The resulting half distances.
+         */
+        void computeHalfDistances(std::vector<float>& half_dist) const
+        {
+            const unsigned int k = (unsigned int)m_centers.size();
+            
+            half_dist.assign(k, std::numeric_limits<float>::max());
+            
+            for(unsigned int c1=0; c1<k; ++c1)
+            {
+                for(unsigned int c2=c1+1; c2<k; ++c2)
+                {
+                    const float d = 0.5f*vectorDistance4D(m_centers[c1], m_centers[c2]);
+                    
+                    half_dist[c1] = std::min(half_dist[c1], d);
+                    half_dist[c2] = std::min(half_dist[c2], d);
+                }
+            }
+        }
+    
+        /** The parameters **/
+        unsigned int m_k, m_max_iterations;
+        float m_tolerance;
+        unsigned int m_seed;
+    
+        /** The results **/
+        std::vector<VectorPoint4D> m_centers;
+        std::vector<int> m_labels;
+        std::vector<unsigned int> m_sizes;
+        unsigned int m_iterations;
+        bool m_converged;
+};
+
+} //end of namespace graipe
+
+#endif //GRAIPE_VECTORFIELDPROCESSING_VECTORKMEANS_HXX
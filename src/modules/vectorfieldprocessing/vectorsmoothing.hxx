@@ -74,6 +74,13 @@ SparseWeightedVectorfield2D* smoothVectorfield(SparseWeightedMultiVectorfield2D
     result_vectorfield->setGlobalMotion(vectorfield->globalMotion());
     work_vectorfield->setGlobalMotion(vectorfield->globalMotion());
 	
+	//Coalesce all modifications into one model update per vectorfield
+	ModelTransaction result_transaction(result_vectorfield),
+	                 work_transaction(work_vectorfield);
+	
+	result_vectorfield->reserve(feature_count);
+	work_vectorfield->reserve(feature_count);
+	
 	
 	vigra::Gaussian<double> gauss( max_geo_distance/3.0 );
     
@@ -192,6 +199,7 @@ SparseWeightedVectorfield2D* smoothVectorfield(SparseWeightedMultiVectorfield2D
 		}
     }
 	//Clean temp vf
+	work_transaction.commit();
 	delete work_vectorfield;
 	
 	//Return result
@@ -227,6 +235,13 @@ SparseWeightedVectorfield2D * relaxVectorfield(SparseWeightedMultiVectorfield2D
 	result_vectorfield->setGlobalMotion(vectorfield->globalMotion());
 	work_vectorfield->setGlobalMotion(vectorfield->globalMotion());
 	
+	//Coalesce all modifications into one model update per vectorfield
+	ModelTransaction result_transaction(result_vectorfield),
+	                 work_transaction(work_vectorfield);
+	
+	result_vectorfield->reserve(feature_count);
+	work_vectorfield->reserve(feature_count);
+	
 	vigra::Gaussian<double> gauss( max_geo_distance/3.0 );
 
 	//Prepare adjacency matrix
@@ -430,6 +445,7 @@ SparseWeightedVectorfield2D * relaxVectorfield(SparseWeightedMultiVectorfield2D
 
     }
 	//Clean temp vf
+	work_transaction.commit();
 	delete work_vectorfield;
 	
 	//Return result
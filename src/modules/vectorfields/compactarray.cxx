@@ -0,0 +1,275 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include "vectorfields/compactarray.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_vectorfields
+ * @{
+ *     @file
+ *     @brief Implementation file for the compact (16 bit) storage of float arrays
+ * @}
+ */
+
+CompactArray2D::CompactArray2D()
+:   m_encoding(Float16Encoding),
+    m_shape(0,0),
+    m_scale(0.0f),
+    m_offset(0.0f)
+{
+}
+
+void CompactArray2D::encode(const vigra::MultiArrayView<2,float>& src, Encoding encoding)
+{
+    m_encoding = encoding;
+    m_shape    = src.shape();
+    m_data.resize(src.size());
+    
+    if(m_encoding == Int16Encoding)
+    {
+        float min_val = std::numeric_limits<float>::max(),
+              max_val = -std::numeric_limits<float>::max();
+        
+        for(int y=0; y<m_shape[1]; ++y)
+        {
+            for(int x=0; x<m_shape[0]; ++x)
+            {
+                float value = src(x,y);
+                
+                if(std::isfinite(value))
+                {
+                    min_val = std::min(min_val, value);
+                    max_val = std::max(max_val, value);
+                }
+            }
+        }
+        fitQuantization(min_val, max_val);
+    }
+    
+    std::size_t i=0;
+    
+    for(int y=0; y<m_shape[1]; ++y)
+    {
+        for(int x=0; x<m_shape[0]; ++x, ++i)
+        {
+            m_data[i] = (m_encoding == Float16Encoding) ? floatToHalf(src(x,y)) : quantize(src(x,y));
+        }
+    }
+}
+
+void CompactArray2D::decode(vigra::MultiArrayView<2,float> dest) const
+{
+    vigra_precondition(dest.shape() == m_shape, "CompactArray2D::decode(): shape mismatch.");
+    
+    std::size_t i=0;
+    
+    for(int y=0; y<m_shape[1]; ++y)
+    {
+        for(int x=0; x<m_shape[0]; ++x, ++i)
+        {
+            dest(x,y) = operator[](i);
+        }
+    }
+}
+
+void CompactArray2D::reshape(const ShapeType& shape, Encoding encoding)
+{
+    m_encoding = encoding;
+    m_shape    = shape;
+    m_data.assign(shape[0]*shape[1], 0);
+    m_scale    = 0.0f;
+    m_offset   = 0.0f;
+}
+
+void CompactArray2D::fill(float value)
+{
+    if(m_encoding == Float16Encoding)
+    {
+        std::fill(m_data.begin(), m_data.end(), floatToHalf(value));
+    }
+    else
+    {
+        if(std::isfinite(value))
+        {
+            fitQuantization(value, value);
+        }
+        else
+        {
+            //No finite values at all
+            fitQuantization(1.0f, 0.0f);
+        }
+        std::fill(m_data.begin(), m_data.end(), quantize(value));
+    }
+}
+
+void CompactArray2D::clear()
+{
+    m_shape = ShapeType(0,0);
+    std::vector<quint16>().swap(m_data);
+}
+
+bool CompactArray2D::setValue(std::size_t index, float value)
+{
+    if(m_encoding == Float16Encoding)
+    {
+        m_data[index] = floatToHalf(value);
+        return true;
+    }
+    
+    //NaN has its own code, everything else needs to be inside the range
+    if(   std::isnan(value)
+       || (value >= m_offset && value <= m_offset + float(Int16NaN-1)*m_scale))
+    {
+        m_data[index] = quantize(value);
+        return true;
+    }
+    return false;
+}
+
+QByteArray CompactArray2D::toByteArray() const
+{
+    return QByteArray((const char*)m_data.data(), int(m_data.size()*sizeof(quint16)));
+}
+
+bool CompactArray2D::fromByteArray(const QByteArray& bytes, const ShapeType& shape, Encoding encoding, float scale, float offset)
+{
+    std::size_t size = shape[0]*shape[1];
+    
+    if(std::size_t(bytes.size()) != size*sizeof(quint16))
+    {
+        return false;
+    }
+    
+    m_encoding = encoding;
+    m_shape    = shape;
+    m_scale    = scale;
+    m_offset   = offset;
+    m_data.resize(size);
+    std::memcpy(m_data.data(), bytes.data(), bytes.size());
+    
+    return true;
+}
+
+quint16 CompactArray2D::floatToHalf(float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    
+    quint32 sign     = (bits >> 16) & 0x8000,
+            mantissa = bits & 0x007fffff;
+    qint32  exponent = qint32((bits >> 23) & 0xff) - 127 + 15;
+    
+    if(((bits >> 23) & 0xff) == 0xff)
+    {
+        //Inf or NaN (keep NaNs quiet)
+        return quint16(sign | 0x7c00 | (mantissa ? 0x0200 : 0));
+    }
+    if(exponent >= 0x1f)
+    {
+        //Overflow: Inf
+        return quint16(sign | 0x7c00);
+    }
+    if(exponent <= 0)
+    {
+        //Underflow: Zero or subnormal half
+        if(exponent < -10)
+        {
+            return quint16(sign);
+        }
+        mantissa |= 0x00800000;
+        
+        int shift = 14 - exponent;
+        quint32 half = mantissa >> shift;
+        
+        if((mantissa >> (shift-1)) & 1)
+        {
+            ++half;
+        }
+        return quint16(sign | half);
+    }
+    
+    quint32 half = sign | (quint32(exponent) << 10) | (mantissa >> 13);
+    
+    //Round to nearest, a carry into the exponent is correct here
+    if(mantissa & 0x1000)
+    {
+        ++half;
+    }
+    return quint16(half);
+}
+
+quint16 CompactArray2D::quantize(float value) const
+{
+    if(std::isnan(value))
+    {
+        return Int16NaN;
+    }
+    if(m_scale == 0.0f)
+    {
+        return 0;
+    }
+    
+    float q = (value - m_offset)/m_scale + 0.5f;
+    
+    //Clamp to the quantization levels
+    if(!(q > 0.0f))
+    {
+        return 0;
+    }
+    if(q >= float(Int16NaN-1))
+    {
+        return Int16NaN-1;
+    }
+    return quint16(q);
+}
+
+void CompactArray2D::fitQuantization(float min_val, float max_val)
+{
+    if(min_val > max_val)
+    {
+        //No finite values at all
+        min_val = max_val = 0.0f;
+    }
+    m_offset = min_val;
+    m_scale  = (max_val - min_val)/float(Int16NaN-1);
+}
+
+} //end of namespace graipe
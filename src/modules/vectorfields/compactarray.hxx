@@ -0,0 +1,320 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef GRAIPE_VECTORFIELDS_COMPACTARRAY_HXX
+#define GRAIPE_VECTORFIELDS_COMPACTARRAY_HXX
+
+#include "vectorfields/config.hxx"
+
+#include <QByteArray>
+#include <QtGlobal>
+
+#include "vigra/multi_array.hxx"
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_vectorfields
+ * @{
+ *
+ * @file
+ * @brief Header file for the compact (16 bit) storage of float arrays
+ */
+
+/**
+ * A 2D float array, which is stored with 16 bits per element. Two encodings
+ * are supported:
+ * - Float16Encoding: IEEE 754 half precision floats (about 3 significant
+ *   digits over the full dynamic range).
+ * - Int16Encoding: Unsigned 16 bit integers with a linear scale and offset,
+ *   which are fitted to the (finite) value range at encoding time. Thus, the
+ *   absolute error is the same for all elements (0.5 * scale()). The highest
+ *   code is reserved for NaN, infinite values are clamped to the range.
+ *
+ * The element access decodes on the fly, so that the array may be read
+ * without converting it back to a full float array.
+ */
+class GRAIPE_VECTORFIELDS_EXPORT CompactArray2D
+{
+    public:
+        /** The supported encodings **/
+        enum Encoding { Float16Encoding, Int16Encoding };
+    
+        /** The shape type of the array **/
+        typedef vigra::MultiArrayShape<2>::type ShapeType;
+    
+        /**
+         * Default constructor. Creates an empty array.
+         */
+        CompactArray2D();
+    
+        /**
+         * Encodes a float array. The previous content will be replaced.
+         *
+         * \param src The float array.
+         * \param encoding The encoding to be used.
+         */
+        void encode(const vigra::MultiArrayView<2,float>& src, Encoding encoding);
+    
+        /**
+         * Decodes this array into a float array.
+         *
+         * \param dest The float array, needs to be of the same shape.
+         */
+        void decode(vigra::MultiArrayView<2,float> dest) const;
+    
+        /**
+         * Resizes this array to a given shape and sets all elements to zero.
+         *
+         * \param shape The new shape.
+         * \param encoding The encoding to be used.
+         */
+        void reshape(const ShapeType& shape, Encoding encoding);
+    
+        /**
+         * Sets all elements to one value.
+         *
+         * \param value The new value of all elements.
+         */
+        void fill(float value);
+    
+        /**
+         * Removes all elements.
+         */
+        void clear();
+    
+        /**
+         * The encoding of this array.
+         *
+         * \return The encoding of this array.
+         */
+        Encoding encoding() const
+        {
+            return m_encoding;
+        }
+    
+        /**
+         * The shape of this array.
+         *
+         * \return The shape (width, height) of this array.
+         */
+        const ShapeType& shape() const
+        {
+            return m_shape;
+        }
+    
+        /**
+         * The count of elements of this array.
+         *
+         * \return width x height.
+         */
+        std::size_t size() const
+        {
+            return m_data.size();
+        }
+    
+        /**
+         * The scale of the Int16Encoding.
+         *
+         * \return The distance of two neighboring quantization levels.
+         */
+        float scale() const
+        {
+            return m_scale;
+        }
+    
+        /**
+         * The offset of the Int16Encoding.
+         *
+         * \return The value of the lowest quantization level.
+         */
+        float offset() const
+        {
+            return m_offset;
+        }
+    
+        /**
+         * Decoded reading access to an element by means of its scan-order index.
+         *
+         * \param index The (scan-order) index of the element.
+         * \return The decoded value of the element.
+         */
+        float operator[](std::size_t index) const
+        {
+            if(m_encoding == Float16Encoding)
+            {
+                return halfToFloat(m_data[index]);
+            }
+            return (m_data[index] == Int16NaN)
+                        ? std::numeric_limits<float>::quiet_NaN()
+                        : m_offset + m_scale*m_data[index];
+        }
+    
+        /**
+         * Decoded reading access to an element by means of its position.
+         *
+         * \param x The x-position of the element.
+         * \param y The y-position of the element.
+         * \return The decoded value of the element.
+         */
+        float operator()(std::size_t x, std::size_t y) const
+        {
+            return operator[](y*m_shape[0] + x);
+        }
+    
+        /**
+         * Encodes and stores the value of an element. An Int16Encoding cannot
+         * store values outside of its quantization range (including infinite
+         * values). These are rejected and the element is left unchanged.
+         *
+         * \param index The (scan-order) index of the element.
+         * \param value The new value of the element.
+         * \return True, if the value has been stored.
+         */
+        bool setValue(std::size_t index, float value);
+    
+        /**
+         * Raw access to the encoded elements, e.g. for serialization.
+         *
+         * \return The encoded elements as a byte array (native byte order).
+         */
+        QByteArray toByteArray() const;
+    
+        /**
+         * Restores the encoded elements from a byte array, which has been
+         * created by means of toByteArray().
+         *
+         * \param bytes The encoded elements.
+         * \param shape The shape of the array.
+         * \param encoding The encoding of the elements.
+         * \param scale The scale of the Int16Encoding.
+         * \param offset The offset of the Int16Encoding.
+         * \return True, if the size of the byte array matched the shape.
+         */
+        bool fromByteArray(const QByteArray& bytes, const ShapeType& shape, Encoding encoding, float scale=1.0f, float offset=0.0f);
+    
+        /**
+         * Conversion of a float to its IEEE 754 half precision representation,
+         * rounded to the nearest representable value.
+         *
+         * \param value The float value.
+         * \return The half precision bits.
+         */
+        static quint16 floatToHalf(float value);
+    
+        /**
+         * Conversion of an IEEE 754 half precision number to a float.
+         *
+         * \param half The half precision bits.
+         * \return The float value.
+         */
+        static float halfToFloat(quint16 half)
+        {
+            quint32 sign     = quint32(half & 0x8000) << 16,
+                    exponent = (half >> 10) & 0x1f,
+                    mantissa = half & 0x03ff,
+                    bits;
+        
+            if(exponent == 0x1f)
+            {
+                //Inf or NaN
+                bits = sign | 0x7f800000 | (mantissa << 13);
+            }
+            else if(exponent != 0)
+            {
+                bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+            }
+            else if(mantissa == 0)
+            {
+                bits = sign;
+            }
+            else
+            {
+                //Subnormal half: normalize for the float representation
+                exponent = 113;
+                while((mantissa & 0x0400) == 0)
+                {
+                    mantissa <<= 1;
+                    --exponent;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x03ff) << 13);
+            }
+        
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+    
+    private:
+        /** The code of the Int16Encoding, which is reserved for NaN **/
+        static const quint16 Int16NaN = 0xFFFF;
+    
+        /**
+         * Quantization of one value w.r.t. the current scale and offset.
+         *
+         * \param value The value.
+         * \return The nearest quantization level, or Int16NaN for NaN.
+         */
+        quint16 quantize(float value) const;
+    
+        /**
+         * Fits scale and offset of the Int16Encoding to a value range.
+         *
+         * \param min_val The minimal value.
+         * \param max_val The maximal value.
+         */
+        void fitQuantization(float min_val, float max_val);
+    
+        /** The encoding of the elements **/
+        Encoding m_encoding;
+        /** The shape of the array **/
+        ShapeType m_shape;
+        /** The encoded elements in scan-order **/
+        std::vector<quint16> m_data;
+        /** Scale and offset of the Int16Encoding **/
+        float m_scale, m_offset;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_VECTORFIELDS_COMPACTARRAY_HXX
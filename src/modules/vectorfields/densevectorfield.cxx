@@ -36,6 +36,13 @@
 #include "vectorfields/densevectorfield.hxx"
 #include "core/basicstatistics.hxx"
 
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
 namespace graipe {
 
 /**
@@ -46,22 +53,166 @@ namespace graipe {
  * @}
  */
 
+/**
+ * The encoding of the compact arrays for a given storage mode.
+ *
+ * \param mode The storage mode, should not be Float32Storage.
+ * \return The encoding of the compact arrays.
+ */
+static CompactArray2D::Encoding storageEncoding(DenseVectorfield2D::StorageMode mode)
+{
+    return (mode == DenseVectorfield2D::Int16Storage) ? CompactArray2D::Int16Encoding : CompactArray2D::Float16Encoding;
+}
+
+/**
+ * Conversion of one array of a dense vectorfield between two storage modes.
+ *
+ * \param array   The float array, empty afterwards for 16 bit modes.
+ * \param compact The compact array, empty afterwards for Float32Storage.
+ * \param from    The current storage mode.
+ * \param to      The new storage mode.
+ */
+static void convertArray(DenseVectorfield2D::ArrayType& array, CompactArray2D& compact,
+                         DenseVectorfield2D::StorageMode from, DenseVectorfield2D::StorageMode to)
+{
+    if(from == to)
+        return;
+    
+    if(from != DenseVectorfield2D::Float32Storage)
+    {
+        array.reshape(compact.shape());
+        compact.decode(array);
+    }
+    
+    if(to == DenseVectorfield2D::Float32Storage)
+    {
+        compact.clear();
+    }
+    else
+    {
+        compact.encode(array, storageEncoding(to));
+        array = DenseVectorfield2D::ArrayType();
+    }
+}
+
+/**
+ * Serialization of one array of a dense vectorfield as a Base64 encoded channel.
+ * The 16 bit storage modes are marked by means of a "Type" attribute.
+ *
+ * \param xmlWriter The xmlWriter for serialization.
+ * \param id        The ID of the channel.
+ * \param array     The float array (used for Float32Storage).
+ * \param compact   The compact array (used for the 16 bit modes).
+ * \param mode      The storage mode.
+ */
+static void writeChannel(QXmlStreamWriter& xmlWriter, const QString& id,
+                         const DenseVectorfield2D::ArrayType& array, const CompactArray2D& compact,
+                         DenseVectorfield2D::StorageMode mode)
+{
+    xmlWriter.writeStartElement("Channel");
+    xmlWriter.writeAttribute("ID", id);
+    xmlWriter.writeAttribute("Encoding", "Base64");
+    
+    if(mode == DenseVectorfield2D::Float32Storage)
+    {
+        qint64 channel_size = array.width()*array.height()*sizeof(DenseVectorfield2D::ArrayType::value_type);
+        
+            xmlWriter.writeCharacters(QByteArray((const char*)array.data(),channel_size).toBase64());
+    }
+    else
+    {
+        if(mode == DenseVectorfield2D::Int16Storage)
+        {
+            xmlWriter.writeAttribute("Type", "Int16");
+            xmlWriter.writeAttribute("Scale",  QString::number(compact.scale(),  'g', 9));
+            xmlWriter.writeAttribute("Offset", QString::number(compact.offset(), 'g', 9));
+        }
+        else
+        {
+            xmlWriter.writeAttribute("Type", "Float16");
+        }
+            xmlWriter.writeCharacters(compact.toByteArray().toBase64());
+    }
+    xmlWriter.writeEndElement();
+}
+
+/**
+ * Deserialization of one array of a dense vectorfield from a Base64 encoded channel.
+ * Channels without a "Type" attribute are float arrays.
+ * Throws a std::runtime_error if the channel does not match.
+ *
+ * \param xmlReader The QXmlStreamReader, positioned at the channel element.
+ * \param id        The ID of the channel.
+ * \param shape     The shape of the array.
+ * \param array     The float array (filled for float channels).
+ * \param compact   The compact array (filled for 16 bit channels).
+ * \return The storage mode of the channel.
+ */
+static DenseVectorfield2D::StorageMode readChannel(QXmlStreamReader& xmlReader, const QString& id, const DenseVectorfield2D::DiffType& shape,
+                                                   DenseVectorfield2D::ArrayType& array, CompactArray2D& compact)
+{
+    QXmlStreamAttributes attributes = xmlReader.attributes();
+    
+    QString type = attributes.hasAttribute("Type") ? attributes.value("Type").toString() : QString("Float32");
+    
+    QByteArray block;
+    block.append(xmlReader.readElementText());
+    block = QByteArray::fromBase64(block);
+    
+    if(type == "Float32")
+    {
+        qint64 channel_size = shape[0]*shape[1]*sizeof(DenseVectorfield2D::ArrayType::value_type);
+        
+        if(block.size() != channel_size)
+        {
+            throw std::runtime_error("Channel serialization was of wrong size in XML after Base64 decoding for " + id.toStdString() + " field.");
+        }
+        array.reshape(shape);
+        memcpy((char*)array.data(), block.data(), channel_size);
+        compact.clear();
+        
+        return DenseVectorfield2D::Float32Storage;
+    }
+    else if(type == "Float16" || type == "Int16")
+    {
+        DenseVectorfield2D::StorageMode mode = (type == "Int16") ? DenseVectorfield2D::Int16Storage : DenseVectorfield2D::Float16Storage;
+        
+        if(!compact.fromByteArray(block, shape, storageEncoding(mode),
+                                  attributes.value("Scale").toFloat(), attributes.value("Offset").toFloat()))
+        {
+            throw std::runtime_error("Channel serialization was of wrong size in XML after Base64 decoding for " + id.toStdString() + " field.");
+        }
+        array = DenseVectorfield2D::ArrayType();
+        
+        return mode;
+    }
+    throw std::runtime_error("Unknown channel type " + type.toStdString() + " for " + id.toStdString() + " field.");
+}
+
 DenseVectorfield2D::DenseVectorfield2D(Workspace* wsp)
-: Vectorfield2D(wsp)
+: Vectorfield2D(wsp),
+  m_storage_mode(Float32Storage)
 {
 }
 
 DenseVectorfield2D::DenseVectorfield2D(const DenseVectorfield2D& vf)
-:	Vectorfield2D(vf)
+:	Vectorfield2D(vf),
+    m_storage_mode(vf.m_storage_mode),
+    m_compact_u(vf.m_compact_u),
+    m_compact_v(vf.m_compact_v)
 {
-	m_u = vf.u();
-	m_v = vf.v();
+    if(m_storage_mode == Float32Storage)
+    {
+        m_u = vf.m_u;
+        m_v = vf.m_v;
+    }
 }
 
 DenseVectorfield2D::DenseVectorfield2D(const DiffType& shape, Workspace* wsp)
 :   Vectorfield2D(wsp),
 	m_u(ArrayType(shape)),
-	m_v(ArrayType(shape))
+	m_v(ArrayType(shape)),
+    m_storage_mode(Float32Storage)
 {
 	setLeft(0); setRight(shape[0]);
 	setTop(0);  setBottom(shape[1]);
@@ -70,7 +221,8 @@ DenseVectorfield2D::DenseVectorfield2D(const DiffType& shape, Workspace* wsp)
 DenseVectorfield2D::DenseVectorfield2D(int width, int height, Workspace* wsp)
 :   Vectorfield2D(wsp),
 	m_u(ArrayType(width,height)),
-    m_v(ArrayType(width,height))
+    m_v(ArrayType(width,height)),
+    m_storage_mode(Float32Storage)
 {
 	setLeft(0); setRight(width);
 	setTop(0);  setBottom(height);
@@ -79,7 +231,8 @@ DenseVectorfield2D::DenseVectorfield2D(int width, int height, Workspace* wsp)
 DenseVectorfield2D::DenseVectorfield2D(const ArrayViewType & u, const ArrayViewType & v, Workspace* wsp)
 :   Vectorfield2D(wsp),
 	m_u(u),
-	m_v(v)
+	m_v(v),
+    m_storage_mode(Float32Storage)
 {
 	setLeft(0); setRight(u.width());
 	setTop(0);  setBottom(u.height());
@@ -87,7 +240,29 @@ DenseVectorfield2D::DenseVectorfield2D(const ArrayViewType & u, const ArrayViewT
 
 unsigned int DenseVectorfield2D::size() const
 {
-	return (unsigned int)m_u.size();
+    DiffType s = shape();
+	return (unsigned int)(s[0]*s[1]);
+}
+
+DenseVectorfield2D::DiffType DenseVectorfield2D::shape() const
+{
+    return (m_storage_mode == Float32Storage) ? m_u.shape() : m_compact_u.shape();
+}
+
+DenseVectorfield2D::StorageMode DenseVectorfield2D::storageMode() const
+{
+    return m_storage_mode;
+}
+
+void DenseVectorfield2D::setStorageMode(StorageMode mode)
+{
+    if(locked() || mode == m_storage_mode)
+        return;
+    
+    convertStorage(mode);
+    
+    //The conversion may have changed the values
+    updateModel();
 }
 
 void DenseVectorfield2D::clear()
@@ -100,6 +275,12 @@ void DenseVectorfield2D::clear()
     //also adjusts the width and height of the member arrays
 	updateModel();
     
+    if(m_storage_mode != Float32Storage)
+    {
+        m_compact_u.fill(0);
+        m_compact_v.fill(0);
+    }
+    
     if(m_u.size())
         m_u=0;
     
@@ -112,7 +293,8 @@ void DenseVectorfield2D::clear()
 
 bool DenseVectorfield2D::isInside(const DiffType & d)
 {
-	return m_u.isInside(d);
+    DiffType s = shape();
+	return d[0] >= 0 && d[1] >= 0 && d[0] < s[0] && d[1] < s[1];
 }
 
 bool DenseVectorfield2D::isInside(unsigned int x, unsigned int y)
@@ -137,7 +319,11 @@ DenseVectorfield2D::PointType DenseVectorfield2D::direction(const PointType& ori
 
 DenseVectorfield2D::PointType DenseVectorfield2D::direction(unsigned int x, unsigned int y) const
 {
-    return PointType(m_u(x,y), m_v(x,y));
+    if(m_storage_mode == Float32Storage)
+    {
+        return PointType(m_u(x,y), m_v(x,y));
+    }
+    return PointType(m_compact_u(x,y), m_compact_v(x,y));
 }
 
 void DenseVectorfield2D::setDirection(unsigned int index, const PointType& new_d)
@@ -155,8 +341,8 @@ void DenseVectorfield2D::setDirection(unsigned int x, unsigned int y, const Poin
     if(locked())
         return;
     
-    m_u(x,y) = new_d.x();
-    m_v(x,y) = new_d.y();
+    storeValue(m_u, m_compact_u, x, y, new_d.x());
+    storeValue(m_v, m_compact_v, x, y, new_d.y());
     
     updateModel();
 }
@@ -246,60 +432,119 @@ void DenseVectorfield2D::setTarget(unsigned int x, unsigned int y, const PointTy
     if(locked())
         return;
     
-    m_u(x,y) = new_t.x() - x;
-    m_v(x,y) = new_t.y() - y;
+    storeValue(m_u, m_compact_u, x, y, new_t.x() - x);
+    storeValue(m_v, m_compact_v, x, y, new_t.y() - y);
     
     updateModel();
 }
 
-const DenseVectorfield2D::ArrayViewType& DenseVectorfield2D::u() const
+DenseVectorfield2D::ArrayViewType DenseVectorfield2D::u(ArrayType& buffer) const
 {
-	return m_u;
+	return decodedArray(m_u, m_compact_u, buffer);
 }
 
 void DenseVectorfield2D::setU(const ArrayViewType& new_u)
 {
-    if(locked() || m_u.shape() != new_u.shape())
+    if(locked() || shape() != new_u.shape())
         return;
     
-	m_u = new_u;
+    if(m_storage_mode == Float32Storage)
+    {
+        m_u = new_u;
+    }
+    else
+    {
+        m_compact_u.encode(new_u, storageEncoding(m_storage_mode));
+    }
+    
+    //No updateModel() call here, thus invalidate the statistics and samplers manually
+    statistics().clear();
+    invalidateSamplers();
 }
 
-const DenseVectorfield2D::ArrayViewType& DenseVectorfield2D::v() const
+DenseVectorfield2D::ArrayViewType DenseVectorfield2D::v(ArrayType& buffer) const
 {
-	return m_v;
+	return decodedArray(m_v, m_compact_v, buffer);
 }
 
 void DenseVectorfield2D::setV(const ArrayViewType& new_v)
 {
-    if(locked() || m_v.shape() != new_v.shape())
+    if(locked() || shape() != new_v.shape())
+        return;
+    
+    if(m_storage_mode == Float32Storage)
+    {
+        m_v = new_v;
+    }
+    else
+    {
+        m_compact_v.encode(new_v, storageEncoding(m_storage_mode));
+    }
+    
+    //No updateModel() call here, thus invalidate the statistics and samplers manually
+    statistics().clear();
+    invalidateSamplers();
+}
+
+const CompactArray2D& DenseVectorfield2D::compactU() const
+{
+    return m_compact_u;
+}
+
+const CompactArray2D& DenseVectorfield2D::compactV() const
+{
+    return m_compact_v;
+}
+
+void DenseVectorfield2D::copyOrigins(std::vector<PointType>& origins) const
+{
+    origins.resize(size());
+    
+    DiffType s = shape();
+    unsigned int i=0;
+    
+    for(unsigned int y=0; y<s[1]; ++y)
+    {
+        for(unsigned int x=0; x<s[0]; ++x, ++i)
+        {
+            origins[i].rx() = x;
+            origins[i].ry() = y;
+        }
+    }
+}
+
+void DenseVectorfield2D::copyDirections(std::vector<PointType>& directions) const
+{
+    directions.resize(size());
+    
+    if(m_storage_mode != Float32Storage)
+    {
+        for(unsigned int i=0; i<directions.size(); ++i)
+        {
+            directions[i].rx() = m_compact_u[i];
+            directions[i].ry() = m_compact_v[i];
+        }
         return;
+    }
+    
+    unsigned int i=0;
     
-	m_v = new_v;
+    for(unsigned int y=0; y<m_u.height(); ++y)
+    {
+        for(unsigned int x=0; x<m_u.width(); ++x, ++i)
+        {
+            directions[i].rx() = m_u(x,y);
+            directions[i].ry() = m_v(x,y);
+        }
+    }
 }
 
 void DenseVectorfield2D::serialize_content(QXmlStreamWriter& xmlWriter) const
 {
     try
     {
-      
-        qint64 channel_size = m_u.width()*m_u.height()*sizeof(ArrayType::value_type);
-
-        QByteArray block((const char*)m_u.data(),channel_size);
-            
-        xmlWriter.writeStartElement("Channel");
-        xmlWriter.writeAttribute("ID", "u");
-        xmlWriter.writeAttribute("Encoding", "Base64");
-            xmlWriter.writeCharacters(block.toBase64());
-        xmlWriter.writeEndElement();
-        
-        block = QByteArray((const char*)m_v.data(),channel_size);
-            
-        xmlWriter.writeStartElement("Channel");
-        xmlWriter.writeAttribute("ID", "v");
-        xmlWriter.writeAttribute("Encoding", "Base64");
-            xmlWriter.writeCharacters(block.toBase64());
-        xmlWriter.writeEndElement();
+        writeChannel(xmlWriter, "u", m_u, m_compact_u, m_storage_mode);
+        writeChannel(xmlWriter, "v", m_v, m_compact_v, m_storage_mode);
     }
     catch(...)
     {
@@ -315,10 +560,12 @@ bool DenseVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader)
         return false;
     }
     
-    m_u.reshape(DiffType(width(), height()));
-    m_v.reshape(DiffType(width(), height()));
+    DiffType shape(width(), height());
+    
+    invalidateSamplers();
     
-    qint64 channel_size = m_u.width()*m_u.height()*sizeof(ArrayType::value_type);
+    StorageMode mode_u = Float32Storage,
+                mode_v = Float32Storage;
     
     try
     {
@@ -335,31 +582,13 @@ bool DenseVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader)
             {
                 QString id = xmlReader.attributes().value("ID").toString();
                 
-                QByteArray block;
-                block.append(xmlReader.readElementText());
-                block = QByteArray::fromBase64(block);
-                
                 if (id  == "u")
                 {
-                    if(block.size() == channel_size)
-                    {
-                        memcpy((char*)m_u.data(), block.data(), channel_size);
-                    }
-                    else
-                    {
-                        throw std::runtime_error("Channel serialization was of wrong size in XML after Base64 decoding for u field.");
-                    }
+                    mode_u = readChannel(xmlReader, id, shape, m_u, m_compact_u);
                 }
                 else if (id  == "v")
                 {
-                    if(block.size() == channel_size)
-                    {
-                        memcpy((char*)m_v.data(), block.data(), channel_size);
-                    }
-                    else
-                    {
-                        throw std::runtime_error("Channel serialization was of wrong size in XML after Base64 decoding for v field.");
-                    }
+                    mode_v = readChannel(xmlReader, id, shape, m_v, m_compact_v);
                 }
             
             }
@@ -368,6 +597,10 @@ bool DenseVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader)
                 throw std::runtime_error("Did not find a correct channel element inXML tree");
             }
         }
+        
+        //Both channels share the storage mode of the u-channel
+        m_storage_mode = mode_u;
+        convertArray(m_v, m_compact_v, mode_v, m_storage_mode);
     }
     catch(std::runtime_error & e)
     {
@@ -377,13 +610,166 @@ bool DenseVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader)
     return true;
 }
 
+/**
+ * A task of the parallel sampling of a dense vectorfield. Each task
+ * samples one contiguous range of positions.
+ */
+class DenseVectorfieldSamplingTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param sampler The sampler of the vectorfield.
+         * \param positions Pointer to the first position of this task.
+         * \param directions Pointer to the first direction of this task.
+         * \param count The count of positions of this task.
+         */
+        DenseVectorfieldSamplingTask(const DenseVectorfieldSampler* sampler,
+                                     const QPointF* positions, Vectorfield2D::PointType* directions, unsigned int count)
+        :   all_valid(true),
+            m_sampler(sampler),
+            m_positions(positions),
+            m_directions(directions),
+            m_count(count)
+        {
+            setAutoDelete(false);
+        }
+    
+        /**
+         * Samples all positions of this task.
+         */
+        void run()
+        {
+            all_valid = m_sampler->sample(m_positions, m_directions, m_count);
+        }
+    
+        /** Have all positions of this task been inside the valid range? **/
+        bool all_valid;
+    
+    protected:
+        /** The sampler **/
+        const DenseVectorfieldSampler* m_sampler;
+        /** The positions **/
+        const QPointF* m_positions;
+        /** The directions **/
+        Vectorfield2D::PointType* m_directions;
+        /** The count of positions **/
+        unsigned int m_count;
+};
+
+std::shared_ptr<const DenseVectorfieldSampler> DenseVectorfield2D::sampler(int spline_order) const
+{
+    spline_order = std::min(5, std::max(0, spline_order));
+    
+    QMutexLocker locker(&m_sampler_mutex);
+    
+    std::shared_ptr<const DenseVectorfieldSampler>& cached = m_samplers[spline_order];
+    
+    if(!cached)
+    {
+        //For the 16 bit storage modes, decode temporary copies only for the spline computation
+        ArrayType decoded_u, decoded_v;
+        
+        ArrayViewType u_data = u(decoded_u),
+                      v_data = v(decoded_v);
+        
+        switch(spline_order)
+        {
+            case 0:
+                cached.reset(new DenseVectorfieldSplineSampler<0>(u_data, v_data));
+                break;
+            case 1:
+                cached.reset(new DenseVectorfieldSplineSampler<1>(u_data, v_data));
+                break;
+            case 2:
+                cached.reset(new DenseVectorfieldSplineSampler<2>(u_data, v_data));
+                break;
+            case 3:
+                cached.reset(new DenseVectorfieldSplineSampler<3>(u_data, v_data));
+                break;
+            case 4:
+                cached.reset(new DenseVectorfieldSplineSampler<4>(u_data, v_data));
+                break;
+            default:
+                cached.reset(new DenseVectorfieldSplineSampler<5>(u_data, v_data));
+                break;
+        }
+    }
+    return cached;
+}
+
+bool DenseVectorfield2D::sampleDirections(const std::vector<QPointF>& positions, std::vector<PointType>& directions, int spline_order) const
+{
+    std::shared_ptr<const DenseVectorfieldSampler> spline_sampler = sampler(spline_order);
+    
+    const unsigned int n = positions.size();
+    directions.resize(n);
+    
+    if(n == 0)
+    {
+        return true;
+    }
+    
+    //Blocks of less than 4k positions are not worth a thread
+    const unsigned int min_block_size = 1<<12;
+    
+    const unsigned int thread_count = std::max(1u, std::min<unsigned int>(QThread::idealThreadCount(), n/min_block_size)),
+                       block_size = (n + thread_count - 1)/thread_count;
+    
+    std::vector<DenseVectorfieldSamplingTask*> tasks;
+    for(unsigned int begin=0; begin<n; begin+=block_size)
+    {
+        tasks.push_back(new DenseVectorfieldSamplingTask(spline_sampler.get(),
+                                                         positions.data()+begin, directions.data()+begin,
+                                                         std::min(block_size, n-begin)));
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(thread_count);
+    
+    for(unsigned int t=1; t<tasks.size(); ++t)
+    {
+        pool.start(tasks[t]);
+    }
+    tasks[0]->run();
+    pool.waitForDone();
+    
+    bool all_valid = true;
+    
+    for(DenseVectorfieldSamplingTask* task : tasks)
+    {
+        all_valid = all_valid && task->all_valid;
+        delete task;
+    }
+    return all_valid;
+}
+
+void DenseVectorfield2D::invalidateSamplers()
+{
+    QMutexLocker locker(&m_sampler_mutex);
+    
+    for(std::shared_ptr<const DenseVectorfieldSampler>& cached : m_samplers)
+    {
+        cached.reset();
+    }
+}
+
 void DenseVectorfield2D::updateModel()
 {
-    if(   (width() !=0 && (unsigned int)m_u.width() != width())
-       || (height()!=0 && (unsigned int)m_u.height()!=height()))
+    //The directions may have changed: remove the cached samplers
+    invalidateSamplers();
+    
+    if(deferUpdate())
+        return;
+    
+    DiffType s = shape();
+    
+    if(   (width() !=0 && (unsigned int)s[0] != width())
+       || (height()!=0 && (unsigned int)s[1] != height()))
     {
-        m_u.reshape(DiffType(width(), height()));
-        m_v.reshape(DiffType(width(), height()));
+        reshapeArrays(DiffType(width(), height()));
     }
     
     Model::updateModel();
@@ -391,17 +777,65 @@ void DenseVectorfield2D::updateModel()
 
 unsigned int DenseVectorfield2D::xyToIdx(unsigned int x, unsigned int y) const
 {
-	return (unsigned int)(y*m_u.width()+x);
+	return (unsigned int)(y*shape()[0]+x);
 }
 
 unsigned int DenseVectorfield2D::indexToX(unsigned int index) const
 {
-	return index % m_u.width();
+	return index % shape()[0];
 }
 
 unsigned int DenseVectorfield2D::indexToY(unsigned int index) const
 {
-	return (unsigned int)(index / m_u.width());
+	return (unsigned int)(index / shape()[0]);
+}
+
+void DenseVectorfield2D::storeValue(ArrayType& array, CompactArray2D& compact, unsigned int x, unsigned int y, float value)
+{
+    if(m_storage_mode != Float32Storage)
+    {
+        if(compact.setValue(xyToIdx(x,y), value))
+            return;
+        
+        //Value out of the Int16Storage's range: Fall back to full precision
+        //once instead of requantizing (and degrading) the array on each write
+        convertStorage(Float32Storage);
+    }
+    array(x,y) = value;
+}
+
+DenseVectorfield2D::ArrayViewType DenseVectorfield2D::decodedArray(const ArrayType& array, const CompactArray2D& compact, ArrayType& buffer) const
+{
+    if(m_storage_mode == Float32Storage)
+        return array;
+    
+    buffer.reshape(compact.shape());
+    compact.decode(buffer);
+    return buffer;
+}
+
+void DenseVectorfield2D::convertStorage(StorageMode mode)
+{
+    convertArray(m_u, m_compact_u, m_storage_mode, mode);
+    convertArray(m_v, m_compact_v, m_storage_mode, mode);
+    
+    m_storage_mode = mode;
+}
+
+void DenseVectorfield2D::reshapeArrays(const DiffType& shape)
+{
+    if(m_storage_mode == Float32Storage)
+    {
+        m_u.reshape(shape);
+        m_v.reshape(shape);
+    }
+    else
+    {
+        m_compact_u.reshape(shape, storageEncoding(m_storage_mode));
+        m_compact_v.reshape(shape, storageEncoding(m_storage_mode));
+        m_u = ArrayType();
+        m_v = ArrayType();
+    }
 }
 
 
@@ -416,16 +850,26 @@ DenseWeightedVectorfield2D::DenseWeightedVectorfield2D(Workspace* wsp)
 }
 
 DenseWeightedVectorfield2D::DenseWeightedVectorfield2D(const DenseWeightedVectorfield2D & vf)
-:	DenseVectorfield2D(vf)
+:	DenseVectorfield2D(vf),
+    m_compact_w(vf.m_compact_w)
 {
-	m_w = vf.w();
+    if(m_storage_mode == Float32Storage)
+    {
+        m_w = vf.m_w;
+    }
 }
 
 DenseWeightedVectorfield2D::DenseWeightedVectorfield2D(const DenseVectorfield2D & vf)
 :	DenseVectorfield2D(vf),
-	m_w(ArrayType(vf.u().shape()))
+	m_w(ArrayType(vf.shape()))
 {
 	m_w = 0;
+    
+    if(m_storage_mode != Float32Storage)
+    {
+        m_compact_w.reshape(shape(), storageEncoding(m_storage_mode));
+        m_w = ArrayType();
+    }
 }
 
 DenseWeightedVectorfield2D::DenseWeightedVectorfield2D(const DiffType& shape, Workspace* wsp)
@@ -460,9 +904,14 @@ void DenseWeightedVectorfield2D::clear()
     //also adjusts the width and height of the member arrays
 	DenseVectorfield2D::clear();
     
-    if(m_w.size() != 0 && m_w.size() != 0)
+    if(m_storage_mode != Float32Storage)
     {
-        m_u=0;
+        m_compact_w.fill(0);
+    }
+    
+    if(m_w.size() != 0)
+    {
+        m_w=0;
     }
     
     //note about update
@@ -471,7 +920,7 @@ void DenseWeightedVectorfield2D::clear()
 
 float DenseWeightedVectorfield2D::weight(unsigned int index) const
 {
-	return m_w(indexToX(index), indexToY(index));
+	return weight(indexToX(index), indexToY(index));
 }
 
 float DenseWeightedVectorfield2D::weight(const PointType& orig) const
@@ -481,7 +930,11 @@ float DenseWeightedVectorfield2D::weight(const PointType& orig) const
 
 float DenseWeightedVectorfield2D::weight(unsigned int x, unsigned int y) const
 {
-	return m_w(x,y);
+    if(m_storage_mode == Float32Storage)
+    {
+        return m_w(x,y);
+    }
+	return m_compact_w(x,y);
 }
 
 void DenseWeightedVectorfield2D::setWeight(unsigned int index, float new_w)
@@ -499,7 +952,7 @@ void DenseWeightedVectorfield2D::setWeight(unsigned int x, unsigned int y, float
     if(locked())
         return;
     
-	m_w(x,y) = new_w;
+    storeValue(m_w, m_compact_w, x, y, new_w);
 	updateModel();
 }
 
@@ -509,15 +962,7 @@ void DenseWeightedVectorfield2D::serialize_content(QXmlStreamWriter& xmlWriter)
     
     try
     {
-        qint64 channel_size = m_w.width()*m_w.height()*sizeof(ArrayType::value_type);
-
-        QByteArray block((const char*)m_w.data(),channel_size);
-            
-        xmlWriter.writeStartElement("Channel");
-        xmlWriter.writeAttribute("ID", "w");
-        xmlWriter.writeAttribute("Encoding", "Base64");
-            xmlWriter.writeCharacters(block.toBase64());
-        xmlWriter.writeEndElement();
+        writeChannel(xmlWriter, "w", m_w, m_compact_w, m_storage_mode);
     }
     catch(...)
     {
@@ -532,10 +977,6 @@ bool DenseWeightedVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader
         return false;
     }
     
-    qint64 channel_size = m_u.width()*m_u.height()*sizeof(ArrayType::value_type);
-    
-    m_w.reshape(DiffType(width(), height()));
-    
     if(width() == 0 || height()==0)
     {
         qCritical("DenseWeightedVectorfield2D::deserialize_content: storage image has zero size!");
@@ -554,18 +995,10 @@ bool DenseWeightedVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader
             && xmlReader.attributes().hasAttribute("Encoding")
             && xmlReader.attributes().value("Encoding") == "Base64")
         {
-            QByteArray block;
-            block.append(xmlReader.readElementText());
-            block = QByteArray::fromBase64(block);
+            StorageMode mode_w = readChannel(xmlReader, "w", DiffType(width(), height()), m_w, m_compact_w);
             
-            if(block.size() == channel_size)
-            {
-                memcpy((char*)m_w.data(), block.data(), channel_size);
-            }
-            else
-            {
-                throw std::runtime_error("Channel serialization was of wrong size in XML after Base64 decoding for w field.");
-            }
+            //The weights share the storage mode of the directions
+            convertArray(m_w, m_compact_w, mode_w, m_storage_mode);
         }
         else
         {
@@ -580,28 +1013,61 @@ bool DenseWeightedVectorfield2D::deserialize_content(QXmlStreamReader& xmlReader
     return true;
 }
 
-const DenseWeightedVectorfield2D::ArrayViewType & DenseWeightedVectorfield2D::w() const
+DenseWeightedVectorfield2D::ArrayViewType DenseWeightedVectorfield2D::w(ArrayType& buffer) const
 {
-	return m_w;
+	return decodedArray(m_w, m_compact_w, buffer);
 }
 
 void DenseWeightedVectorfield2D::setW(const ArrayViewType& new_w)
 {
-    if(locked() || m_w.shape() != new_w.shape())
+    if(locked() || shape() != new_w.shape())
         return;
     
-	m_w = new_w;
+    if(m_storage_mode == Float32Storage)
+    {
+        m_w = new_w;
+    }
+    else
+    {
+        m_compact_w.encode(new_w, storageEncoding(m_storage_mode));
+    }
+    
+    //No updateModel() call here, thus invalidate the statistics manually
+    statistics().clear();
+}
+
+const CompactArray2D& DenseWeightedVectorfield2D::compactW() const
+{
+    return m_compact_w;
 }
 
 void DenseWeightedVectorfield2D::updateModel()
 {
-    if(   (width() !=0 && (unsigned int)m_u.width() != width())
-       || (height()!=0 && (unsigned int)m_u.height()!=height()))
-    {
-        m_w.reshape(DiffType(width(), height()));
-    }
+    if(deferUpdate())
+        return;
     
+    //The weights are reshaped by means of reshapeArrays()
     DenseVectorfield2D::updateModel();
 }
 
+void DenseWeightedVectorfield2D::convertStorage(StorageMode mode)
+{
+    convertArray(m_w, m_compact_w, m_storage_mode, mode);
+    DenseVectorfield2D::convertStorage(mode);
+}
+
+void DenseWeightedVectorfield2D::reshapeArrays(const DiffType& shape)
+{
+    if(m_storage_mode == Float32Storage)
+    {
+        m_w.reshape(shape);
+    }
+    else
+    {
+        m_compact_w.reshape(shape, storageEncoding(m_storage_mode));
+        m_w = ArrayType();
+    }
+    DenseVectorfield2D::reshapeArrays(shape);
+}
+
 } //end of namespace graipe
@@ -38,9 +38,13 @@
 
 #include "core/core.h"
 #include "vectorfields/vectorfield.hxx"
+#include "vectorfields/densevectorfieldsampler.hxx"
+#include "vectorfields/compactarray.hxx"
 
 #include "vigra/multi_array.hxx"
 
+#include <memory>
+
 namespace graipe {
 
 /**
@@ -56,6 +60,11 @@ namespace graipe {
  * each single vector by means of position and direction, we use two 2D
  * arrays here and store the motion component in x direction (m_u) and in
  * y direction (m_v) repectively.
+ *
+ * To save memory (and disk space), the arrays may also be stored with 16 bits
+ * per element, see setStorageMode(). The per-vector accessors decode on the
+ * fly, while the array accessors u() and v() decode into a buffer, which is
+ * provided by the caller. No decoded copies are kept by the vectorfield.
  */
 class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
 :   public Vectorfield2D
@@ -69,6 +78,14 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
         
         /** The internally used array diff type **/
         typedef ArrayType::difference_type DiffType;
+    
+        /**
+         * The storage modes of the arrays:
+         * - Float32Storage: Full precision float arrays (default).
+         * - Float16Storage: Half precision floats.
+         * - Int16Storage:   16 bit integers, linearly quantized to the value range.
+         */
+        enum StorageMode { Float32Storage, Float16Storage, Int16Storage };
         
         /**
          * Default constructor. Creates an empty dense vectorfield.
@@ -127,6 +144,34 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
          * \return The number of vectors in this vectorfield (width x height).
          */
 		unsigned int size() const;
+    
+        /**
+         * The shape of the arrays of this vectorfield.
+         *
+         * \return The 2D shape, which contains (width, height).
+         */
+        DiffType shape() const;
+    
+        /**
+         * The storage mode of the arrays of this vectorfield.
+         *
+         * \return The current storage mode.
+         */
+        StorageMode storageMode() const;
+    
+        /**
+         * Converts the arrays of this vectorfield to another storage mode.
+         * Converting to a 16 bit mode is lossy, converting back to
+         * Float32Storage will not restore the original precision.
+         * The quantization of the Int16Storage is fitted to the value range
+         * at conversion time. Writing a value outside of this range converts
+         * the vectorfield back to Float32Storage.
+         * The storage mode is kept by the serialization.
+         * Does nothing if the model is locked.
+         *
+         * \param mode The new storage mode.
+         */
+        void setStorageMode(StorageMode mode);
         
         /**
          * This does not remove all the vectors, but resets their directions to zero.
@@ -392,10 +437,14 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
         /**
          * Constant reading access to the x-component of the direction
          * vector. Use this access method for the best performance.
+         * For the 16 bit storage modes, the array is decoded into the
+         * given buffer, which thus needs to outlive the returned view.
+         * For the Float32Storage, the buffer remains untouched.
          *
+         * \param buffer The buffer for the decoded array.
          * \return A constant view on the array data for the x-direction.
          */
-		const ArrayViewType & u() const;
+		ArrayViewType u(ArrayType& buffer) const;
     
         /**
          * Setter for the y-component of the direction vector.
@@ -409,10 +458,14 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
         /**
          * Constant reading access to the y-component of the direction
          * vector. Use this access method for the best performance.
+         * For the 16 bit storage modes, the array is decoded into the
+         * given buffer, which thus needs to outlive the returned view.
+         * For the Float32Storage, the buffer remains untouched.
          *
+         * \param buffer The buffer for the decoded array.
          * \return A constant view on the array data for the y-direction.
          */
-		const ArrayViewType & v() const;
+		ArrayViewType v(ArrayType& buffer) const;
     
         /**
          * Setter for the y-component of the direction vector.
@@ -423,9 +476,64 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
          */
         void setV(const ArrayViewType& new_v);
     
+        /**
+         * Constant reading access to the encoded x-component of the direction
+         * vector. Only valid if storageMode() is not Float32Storage.
+         *
+         * \return The compact array of the x-direction.
+         */
+        const CompactArray2D& compactU() const;
+    
+        /**
+         * Constant reading access to the encoded y-component of the direction
+         * vector. Only valid if storageMode() is not Float32Storage.
+         *
+         * \return The compact array of the y-direction.
+         */
+        const CompactArray2D& compactV() const;
+    
+        /**
+         * Bulk copy of the origins of all vectors of this vectorfield.
+         * Specialized for this class to generate the grid positions row by row.
+         *
+         * \param origins Will be resized to size() and filled with the origins.
+         */
+        void copyOrigins(std::vector<PointType>& origins) const;
+    
+        /**
+         * Bulk copy of the directions of all vectors of this vectorfield.
+         * Specialized for this class to read the arrays row by row.
+         *
+         * \param directions Will be resized to size() and filled with the directions.
+         */
+        void copyDirections(std::vector<PointType>& directions) const;
+    
+        /**
+         * The spline sampler of this vectorfield for a given order. The sampler
+         * is created on first request and cached until the vectorfield changes,
+         * so that the spline coefficients are only computed once for many
+         * comparisons against the same vectorfield.
+         *
+         * \param spline_order The order of the spline interpolation (0..5).
+         * \return A shared pointer to the sampler.
+         */
+        std::shared_ptr<const DenseVectorfieldSampler> sampler(int spline_order) const;
+    
+        /**
+         * Parallel interpolation of the directions at many positions by means
+         * of the cached spline sampler.
+         *
+         * \param positions The positions in vectorfield coordinates.
+         * \param directions Will be resized and filled with the interpolated directions.
+         * \param spline_order The order of the spline interpolation (0..5).
+         * \return True, if all positions have been inside the valid range.
+         */
+        bool sampleDirections(const std::vector<QPointF>& positions, std::vector<PointType>& directions, int spline_order=3) const;
+    
         /**
          * Serialize the complete content of the dense vectorfield to an xml file.
          * The serialization is just a binary stream of m_u followed by m_v.
+         * For the 16 bit storage modes, the encoded arrays are written.
          *
          * \param xmlWriter The xmlWriter for serialization.
          */
@@ -474,10 +582,71 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2D
          */
 		unsigned int indexToY(unsigned int index) const;
 		
-        /** storage for the x-part of each vector **/
+        /**
+         * Writes a value into an array w.r.t. the current storage mode.
+         * If the 16 bit array cannot store the value, the vectorfield is
+         * converted to Float32Storage first.
+         *
+         * \param array The float array.
+         * \param compact The compact array.
+         * \param x The x position of the value.
+         * \param y The y position of the value.
+         * \param value The new value.
+         */
+        void storeValue(ArrayType& array, CompactArray2D& compact, unsigned int x, unsigned int y, float value);
+    
+        /**
+         * Reading access to an array w.r.t. the current storage mode.
+         * Decodes a 16 bit array into the given buffer.
+         *
+         * \param array The float array.
+         * \param compact The compact array.
+         * \param buffer The buffer for the decoded array.
+         * \return A constant view on the (decoded) array data.
+         */
+        ArrayViewType decodedArray(const ArrayType& array, const CompactArray2D& compact, ArrayType& buffer) const;
+    
+        /**
+         * Converts the arrays of this vectorfield to another storage mode.
+         * Specialized by subclasses with further arrays.
+         *
+         * \param mode The new storage mode.
+         */
+        virtual void convertStorage(StorageMode mode);
+    
+        /**
+         * Resizes the arrays of this vectorfield. All elements will be zero.
+         * Specialized by subclasses with further arrays.
+         *
+         * \param shape The new shape.
+         */
+        virtual void reshapeArrays(const DiffType& shape);
+    
+        /** storage for the x-part of each vector (empty for 16 bit storage) **/
 		ArrayType m_u;
-        /** storage for the y-part of each vector **/
+        /** storage for the y-part of each vector (empty for 16 bit storage) **/
 		ArrayType m_v;
+    
+        /** The storage mode of the arrays **/
+        StorageMode m_storage_mode;
+    
+        /** compact storage for the x-part of each vector **/
+        CompactArray2D m_compact_u;
+        /** compact storage for the y-part of each vector **/
+        CompactArray2D m_compact_v;
+    
+    private:
+        /**
+         * Removes all cached samplers. Needs to be called on every change
+         * of the directions.
+         */
+        void invalidateSamplers();
+    
+        /** The cached samplers, one for each spline order **/
+        mutable std::shared_ptr<const DenseVectorfieldSampler> m_samplers[6];
+    
+        /** Guards the cached samplers **/
+        mutable QMutex m_sampler_mutex;
 };
 
 /**
@@ -641,10 +810,14 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseWeightedVectorfield2D : public DenseVector
         /**
          * Constant reading access to the weights of each direction
          * vector. Use this access method for the best performance.
+         * For the 16 bit storage modes, the array is decoded into the
+         * given buffer, which thus needs to outlive the returned view.
+         * For the Float32Storage, the buffer remains untouched.
          *
+         * \param buffer The buffer for the decoded array.
          * \return A constant view on the array data for the weights.
          */
-		const ArrayViewType & w() const;
+		ArrayViewType w(ArrayType& buffer) const;
     
         /**
          * Setter for the weights of the direction vectors.
@@ -655,6 +828,14 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseWeightedVectorfield2D : public DenseVector
          */
         void setW(const DenseVectorfield2D::ArrayViewType& new_w);
     
+        /**
+         * Constant reading access to the encoded weights of each direction
+         * vector. Only valid if storageMode() is not Float32Storage.
+         *
+         * \return The compact array of the weights.
+         */
+        const CompactArray2D& compactW() const;
+    
     protected slots:
         /**
          * Specialization of Model's updateModel procedure.
@@ -663,8 +844,24 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseWeightedVectorfield2D : public DenseVector
         void updateModel();
 
     protected:
-        /** Storage for the weights of each vector **/
+        /**
+         * Converts all arrays (including the weights) to another storage mode.
+         *
+         * \param mode The new storage mode.
+         */
+        void convertStorage(StorageMode mode);
+    
+        /**
+         * Resizes all arrays (including the weights). All elements will be zero.
+         *
+         * \param shape The new shape.
+         */
+        void reshapeArrays(const DiffType& shape);
+    
+        /** Storage for the weights of each vector (empty for 16 bit storage) **/
         ArrayType m_w;
+        /** Compact storage for the weights of each vector **/
+        CompactArray2D m_compact_w;
 };
 
 /**
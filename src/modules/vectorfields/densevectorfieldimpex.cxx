@@ -178,12 +178,14 @@ bool DenseVectorfieldImpex::exportVectorfield(const DenseVectorfield2D & vf, con
                 {
                     for(int x=0; x!=width; ++x)
                     {
-                        u_val = vf.u()(x,y);
+                        DenseVectorfield2D::PointType dir = vf.direction(x,y);
+                        
+                        u_val = dir.x();
                         
                         if( file.write((char*)&u_val, 4) != 4)
                             return false;
                             
-                        v_val = vf.v()(x,y);
+                        v_val = dir.y();
                             
                         if( file.write((char*)&v_val, 4) != 4)
                             return false;
@@ -0,0 +1,243 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef GRAIPE_VECTORFIELDS_DENSEVECTORFIELDSAMPLER_HXX
+#define GRAIPE_VECTORFIELDS_DENSEVECTORFIELDSAMPLER_HXX
+
+#include "vectorfields/vectorfield.hxx"
+
+#include <vigra/splineimageview.hxx>
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <memory>
+#include <vector>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_vectorfields
+ * @{
+ *
+ * @file
+ * @brief Header file for the spline samplers of dense vectorfields
+ */
+
+/**
+ * Interface of a sampler, which interpolates the directions of a dense
+ * vectorfield at arbitrary (sub-pixel) positions. Samplers are created and
+ * cached by the dense vectorfields, see DenseVectorfield2D::sampler().
+ * The sample() call is safe to be used from many threads at the same time.
+ */
+class DenseVectorfieldSampler
+{
+    public:
+        /** The internally used point type **/
+        typedef Vectorfield2D::PointType PointType;
+    
+        /**
+         * Virtual destructor.
+         */
+        virtual ~DenseVectorfieldSampler()
+        {
+        }
+    
+        /**
+         * The order of the spline interpolation.
+         *
+         * \return The order of the spline.
+         */
+        virtual int splineOrder() const = 0;
+    
+        /**
+         * Interpolation of the directions at a range of positions.
+         * Positions outside the valid range of the spline get a zero direction.
+         *
+         * \param positions Pointer to the first position in vectorfield coordinates.
+         * \param directions Pointer to the first interpolated direction.
+         * \param count The count of positions.
+         * \return True, if all positions have been inside the valid range.
+         */
+        virtual bool sample(const QPointF* positions, PointType* directions, unsigned int count) const = 0;
+};
+
+/**
+ * The spline sampler of a given order. The spline coefficients of both
+ * direction components are computed once at construction time.
+ *
+ * Since the spline views keep the last evaluation state internally, each
+ * concurrent sample() call needs its own copies of them. These copies are
+ * kept in a pool and reused by later calls, thus at most one copy per
+ * concurrently sampling thread is made over the lifetime of the sampler.
+ */
+template <int ORDER>
+class DenseVectorfieldSplineSampler
+:   public DenseVectorfieldSampler
+{
+    public:
+        /**
+         * Constructor. Computes the spline coefficients.
+         *
+         * \param u The x-component of the directions.
+         * \param v The y-component of the directions.
+         */
+        DenseVectorfieldSplineSampler(const vigra::MultiArrayView<2,float>& u, const vigra::MultiArrayView<2,float>& v)
+        :   m_spi_u(srcImageRange(u)),
+            m_spi_v(srcImageRange(v))
+        {
+        }
+    
+        /**
+         * The order of the spline interpolation.
+         *
+         * \return Always ORDER.
+         */
+        int splineOrder() const
+        {
+            return ORDER;
+        }
+    
+        /**
+         * Interpolation of the directions at a range of positions.
+         * Positions outside the valid range of the spline get a zero direction.
+         *
+         * \param positions Pointer to the first position in vectorfield coordinates.
+         * \param directions Pointer to the first interpolated direction.
+         * \param count The count of positions.
+         * \return True, if all positions have been inside the valid range.
+         */
+        bool sample(const QPointF* positions, PointType* directions, unsigned int count) const
+        {
+            std::unique_ptr<SplineViews> views = acquireViews();
+            
+            const vigra::SplineImageView<ORDER, float> & spi_u = views->u,
+                                                       & spi_v = views->v;
+            
+            bool all_valid = true;
+            
+            for(unsigned int i=0; i<count; ++i)
+            {
+                const double x = positions[i].x(), y = positions[i].y();
+                
+                if(spi_u.isValid(x, y))
+                {
+                    directions[i] = PointType(spi_u(x, y), spi_v(x, y));
+                }
+                else
+                {
+                    directions[i] = PointType(0, 0);
+                    all_valid = false;
+                }
+            }
+            releaseViews(std::move(views));
+            
+            return all_valid;
+        }
+    
+    protected:
+        /**
+         * A copy of the spline views of both direction components,
+         * which is used by one sample() call at a time.
+         */
+        struct SplineViews
+        {
+            /**
+             * Constructor. Copies the spline coefficients.
+             *
+             * \param spi_u The spline view of the x-component.
+             * \param spi_v The spline view of the y-component.
+             */
+            SplineViews(const vigra::SplineImageView<ORDER, float>& spi_u, const vigra::SplineImageView<ORDER, float>& spi_v)
+            :   u(spi_u),
+                v(spi_v)
+            {
+            }
+            
+            /** The spline views of both direction components **/
+            vigra::SplineImageView<ORDER, float> u, v;
+        };
+    
+        /**
+         * Takes an idle copy of the spline views from the pool. If there is
+         * none, a new copy is created.
+         *
+         * \return A copy of the spline views for exclusive use.
+         */
+        std::unique_ptr<SplineViews> acquireViews() const
+        {
+            {
+                QMutexLocker locker(&m_views_mutex);
+                
+                if(!m_idle_views.empty())
+                {
+                    std::unique_ptr<SplineViews> views = std::move(m_idle_views.back());
+                    m_idle_views.pop_back();
+                    return views;
+                }
+            }
+            //Copying the coefficients is much cheaper than computing them
+            return std::unique_ptr<SplineViews>(new SplineViews(m_spi_u, m_spi_v));
+        }
+    
+        /**
+         * Returns a copy of the spline views to the pool for later reuse.
+         *
+         * \param views The copy of the spline views.
+         */
+        void releaseViews(std::unique_ptr<SplineViews> views) const
+        {
+            QMutexLocker locker(&m_views_mutex);
+            
+            m_idle_views.push_back(std::move(views));
+        }
+    
+        /** The spline views of both direction components **/
+        vigra::SplineImageView<ORDER, float> m_spi_u, m_spi_v;
+    
+        /** Idle copies of the spline views for the sample() calls **/
+        mutable std::vector<std::unique_ptr<SplineViews> > m_idle_views;
+        /** Guard for the idle copies **/
+        mutable QMutex m_views_mutex;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_VECTORFIELDS_DENSEVECTORFIELDSAMPLER_HXX
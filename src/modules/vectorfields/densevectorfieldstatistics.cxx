@@ -35,7 +35,7 @@
 
 #include "vectorfields/densevectorfieldstatistics.hxx"
 
-#include <vigra/separableconvolution.hxx>
+#include <cmath>
 
 namespace graipe {
 
@@ -47,7 +47,146 @@ namespace graipe {
  * @}
  */
 
+/**
+ * Accessor of the values of a (contiguous) float array of a dense vectorfield
+ * for the parallel computation of the channel statistics.
+ */
+class DenseArrayAccessor
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param data The first element of the array.
+         */
+        DenseArrayAccessor(const float* data)
+        : m_data(data)
+        {
+        }
+    
+        /**
+         * Access to an array element.
+         *
+         * \param index The (scan-order) index of the element.
+         * \return The element's value.
+         */
+        double operator()(std::size_t index) const
+        {
+            return m_data[index];
+        }
+    
+    private:
+        /** The first element of the array **/
+        const float* m_data;
+};
+
+/**
+ * Accessor of the vector lengths of a dense vectorfield
+ * for the parallel computation of the channel statistics.
+ */
+class DenseLengthAccessor
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param u The first element of the u-component array.
+         * \param v The first element of the v-component array.
+         */
+        DenseLengthAccessor(const float* u, const float* v)
+        : m_u(u),
+          m_v(v)
+        {
+        }
+    
+        /**
+         * Access to a vector's length.
+         *
+         * \param index The (scan-order) index of the vector.
+         * \return The vector's length.
+         */
+        double operator()(std::size_t index) const
+        {
+            return std::sqrt(double(m_u[index])*m_u[index] + double(m_v[index])*m_v[index]);
+        }
+    
+    private:
+        /** The first elements of the u- and v-component arrays **/
+        const float * m_u, * m_v;
+};
+
+/**
+ * Accessor of the values of a compact (16 bit) array of a dense vectorfield
+ * for the parallel computation of the channel statistics. The values are
+ * decoded on the fly.
+ */
+class CompactArrayAccessor
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param data The compact array.
+         */
+        CompactArrayAccessor(const CompactArray2D& data)
+        : m_data(data)
+        {
+        }
+    
+        /**
+         * Access to an array element.
+         *
+         * \param index The (scan-order) index of the element.
+         * \return The element's decoded value.
+         */
+        double operator()(std::size_t index) const
+        {
+            return m_data[index];
+        }
+    
+    private:
+        /** The compact array **/
+        const CompactArray2D& m_data;
+};
+
+/**
+ * Accessor of the vector lengths of a dense vectorfield with compact (16 bit)
+ * storage for the parallel computation of the channel statistics.
+ */
+class CompactLengthAccessor
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param u The compact u-component array.
+         * \param v The compact v-component array.
+         */
+        CompactLengthAccessor(const CompactArray2D& u, const CompactArray2D& v)
+        : m_u(u),
+          m_v(v)
+        {
+        }
+    
+        /**
+         * Access to a vector's length.
+         *
+         * \param index The (scan-order) index of the vector.
+         * \return The vector's length.
+         */
+        double operator()(std::size_t index) const
+        {
+            double u = m_u[index], v = m_v[index];
+            return std::sqrt(u*u + v*v);
+        }
+    
+    private:
+        /** The compact u- and v-component arrays **/
+        const CompactArray2D & m_u, & m_v;
+};
+
 DenseVectorfield2DStatistics::DenseVectorfield2DStatistics()
+: m_vf(NULL)
 {
     float min_val  = vigra::NumericTraits<float>::min();
     float max_val  = vigra::NumericTraits<float>::max();
@@ -63,55 +202,42 @@ DenseVectorfield2DStatistics::DenseVectorfield2DStatistics()
 }
 
 DenseVectorfield2DStatistics::DenseVectorfield2DStatistics(const DenseVectorfield2D* vf)
+: m_vf(vf)
 {
-    float min_val  = vigra::NumericTraits<float>::min();
-    float max_val  = vigra::NumericTraits<float>::max();
-    float zero_val = vigra::NumericTraits<float>::zero();
-    
     //---------------------------------------------------------------------------
-    //Direction and length statistics
+    //Direction and length statistics (cached at the vectorfield)
     
-    m_direction.min    = PointType(max_val, max_val);
-    m_direction.max    = PointType(min_val, min_val);
-    m_direction.mean   = m_direction.stddev    = PointType(zero_val, zero_val);
+    ModelStatistics& cache = vf->statistics();
+    std::size_t size = vf->size();
     
-    m_length.min    = max_val;
-    m_length.max    = min_val;
-    m_length.mean   = m_length.stddev    = zero_val;
+    ChannelStatistics length;
     
-    for (unsigned int i=0; i<vf->size(); ++i)
+    if(vf->storageMode() == DenseVectorfield2D::Float32Storage)
     {
-        const PointType& d = vf->direction(i);
-        m_direction.min = std::min(m_direction.min, d);
-        m_direction.max = std::max(m_direction.max, d);
-        m_direction.mean +=  d;
+        //The buffer remains untouched for the Float32Storage
+        DenseVectorfield2D::ArrayType unused;
         
-        float len=vf->length(i);
-        m_length.min = std::min((double)len, m_length.min);
-        m_length.max = std::max((double)len, m_length.max);
-        m_length.mean +=  len;
-    }
+        const float * u = vf->u(unused).data(),
+                    * v = vf->v(unused).data();
     
-    m_direction.mean /= vf->size();
-    m_length.mean /= vf->size();
-    
-    for (unsigned int i=0; i< vf->size(); ++i)
+        m_direction = combineStatistics<PointType>(cache.channel("direction_x", DenseArrayAccessor(u),    size).stats,
+                                                   cache.channel("direction_y", DenseArrayAccessor(v),    size).stats);
+        length = cache.channel("length", DenseLengthAccessor(u, v), size);
+    }
+    else
     {
-        PointType d=(m_direction.mean - vf->direction(i));
-        m_direction.stddev += PointType(d.x()*d.x(), d.y()*d.y());
+        //Decode on the fly instead of decoding the complete arrays
+        const CompactArray2D & u = vf->compactU(),
+                             & v = vf->compactV();
         
-        float len=vf->length(i);
-        m_length.stddev += vigra::pow(m_length.mean - len, 2.0);
+        m_direction = combineStatistics<PointType>(cache.channel("direction_x", CompactArrayAccessor(u),    size).stats,
+                                                   cache.channel("direction_y", CompactArrayAccessor(v),    size).stats);
+        length = cache.channel("length", CompactLengthAccessor(u, v), size);
     }
-    
-    m_direction.stddev = m_direction.stddev/vf->size();
-    m_direction.stddev.setX(sqrt(m_direction.stddev.x()));
-    m_direction.stddev.setY(sqrt(m_direction.stddev.y()));
-    
-    m_length.stddev = sqrt(m_length.stddev/vf->size());
+    m_length = length.stats;
+    m_length_histogram = length.histogram;
 }
 
-
 const BasicStatistics<Vectorfield2D::PointType>& DenseVectorfield2DStatistics::directionStats() const
 {
 	return m_direction;
@@ -122,8 +248,14 @@ const BasicStatistics<double>& DenseVectorfield2DStatistics::lengthStats() const
 	return m_length;
 }
 
+const BasicHistogram& DenseVectorfield2DStatistics::lengthHistogram() const
+{
+	return m_length_histogram;
+}
+
 DenseWeightedVectorfield2DStatistics::DenseWeightedVectorfield2DStatistics()
-: DenseVectorfield2DStatistics()
+: DenseVectorfield2DStatistics(),
+  m_vf(NULL)
 {
     typedef float value_type;
     
@@ -137,33 +269,17 @@ DenseWeightedVectorfield2DStatistics::DenseWeightedVectorfield2DStatistics()
 }
 
 DenseWeightedVectorfield2DStatistics::DenseWeightedVectorfield2DStatistics(const DenseWeightedVectorfield2D* vf)
-: DenseVectorfield2DStatistics(vf)
+: DenseVectorfield2DStatistics(vf),
+  m_vf(vf)
 {
-    typedef float value_type;
+    //The buffer remains untouched for the Float32Storage
+    DenseVectorfield2D::ArrayType unused;
     
-    value_type min_val  = vigra::NumericTraits<value_type>::min();
-    value_type max_val  = vigra::NumericTraits<value_type>::max();
-    value_type zero_val = vigra::NumericTraits<value_type>::zero();
-    
-    m_weights.min    = max_val;
-    m_weights.max    = min_val;
-    m_weights.mean   = m_weights.stddev    =  zero_val;
-    
-    for (unsigned int i=0; i< vf->size(); ++i)
-    {
-        m_weights.min = std::min( (double)vf->weight(i),m_weights.min);
-        m_weights.max = std::max( (double)vf->weight(i),m_weights.max);
-        
-        m_weights.mean += vf->weight(i);
-    }
-    
-    m_weights.mean /= vf->size();
-    
-    for (unsigned int i=0; i< vf->size(); ++i)
-    {
-        m_weights.stddev += pow(m_weights.mean - vf->weight(i),2.0f);
-    }
-    m_weights.stddev = sqrt(m_weights.stddev/vf->size());
+    ChannelStatistics weight = (vf->storageMode() == DenseVectorfield2D::Float32Storage)
+                                    ? vf->statistics().channel("weight", DenseArrayAccessor(vf->w(unused).data()), vf->size())
+                                    : vf->statistics().channel("weight", CompactArrayAccessor(vf->compactW()), vf->size());
+    m_weights = weight.stats;
+    m_weight_histogram = weight.histogram;
 }
     
 const BasicStatistics<double>& DenseWeightedVectorfield2DStatistics::weightStats() const
@@ -171,4 +287,9 @@ const BasicStatistics<double>& DenseWeightedVectorfield2DStatistics::weightStats
 	return m_weights;
 }
 
+const BasicHistogram& DenseWeightedVectorfield2DStatistics::weightHistogram() const
+{
+	return m_weight_histogram;
+}
+
 }//end of namespace graipe
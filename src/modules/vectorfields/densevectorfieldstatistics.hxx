@@ -91,6 +91,13 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2DStatistics
          */
         const BasicStatistics<double>& lengthStats() const;
     
+        /**
+         * Returns the histogram of the lengths of this vectorfield.
+         *
+         * \return Histogram of the lengths of this vectorfield.
+         */
+        const BasicHistogram& lengthHistogram() const;
+    
     protected:
         /** Pointer to the vectorfield **/
         const DenseVectorfield2D* m_vf;
@@ -99,6 +106,8 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2DStatistics
         BasicStatistics<PointType> m_direction;
         /** Statistics of the vector lengths **/
         BasicStatistics<double> m_length;
+        /** Histogram of the vector lengths **/
+        BasicHistogram m_length_histogram;
 };
     
 /**
@@ -132,12 +141,21 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseWeightedVectorfield2DStatistics
          */
         const BasicStatistics<double>& weightStats() const;
     
+        /**
+         * Returns the histogram of the weights of this vectorfield.
+         *
+         * \return Histogram of the weights of this vectorfield.
+         */
+        const BasicHistogram& weightHistogram() const;
+    
     protected:
         /** Pointer to the vectorfield **/
         const DenseWeightedVectorfield2D* m_vf;
         
         /** Statistics of the vectors' weights **/
         BasicStatistics<double> m_weights;
+        /** Histogram of the vectors' weights **/
+        BasicHistogram m_weight_histogram;
 };
 
 /**
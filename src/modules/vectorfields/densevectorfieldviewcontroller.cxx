@@ -145,56 +145,63 @@ void DenseVectorfield2DViewController::paint(QPainter *painter, const QStyleOpti
     {
         painter->save();
         
-        int step_y = vf->height()/m_resolution->value().y(),
-            step_x = vf->width()/m_resolution->value().x();
+        int step_y = std::max(1, int(vf->height()/m_resolution->value().y())),
+            step_x = std::max(1, int(vf->width()/m_resolution->value().x()));
         
         QPointFX origin, direction, target;
         
-        for(unsigned int y=step_y/2; y < vf->height(); y+=step_x)
+        //Rebuild the cached arrow glyphs only if the view parameters or the model have changed
+        if(!m_vector_drawer.isBatchValid())
         {
-            for(unsigned int x=step_x/2; x < vf->width(); x+=step_y)
+            m_vector_drawer.beginBatch();
+            
+            for(unsigned int y=step_y/2; y < vf->height(); y+=step_y)
             {
-                float current_length = vf->length(x,y);
-                
-                if(current_length!=0 && (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()))
+                for(unsigned int x=step_x/2; x < vf->width(); x+=step_x)
                 {
-                    origin.setX(x);
-                    origin.setY(y);
-                    
-                    switch( m_displayMotionMode->value() )
+                    float current_length = vf->length(x,y);
+                
+                    if(current_length!=0 && (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()))
                     {
-                        case GlobalMotion:
-                            direction = vf->globalDirection(x,y);
-                            break;
+                        origin.setX(x);
+                        origin.setY(y);
+                    
+                        switch( m_displayMotionMode->value() )
+                        {
+                            case GlobalMotion:
+                                direction = vf->globalDirection(x,y);
+                                break;
                             
-                        case LocalMotion:
-                            direction = vf->localDirection(x,y);
-                            break;
+                            case LocalMotion:
+                                direction = vf->localDirection(x,y);
+                                break;
                             
-                        case CompleteMotion:
-                        default:
-                            direction = vf->direction(x,y);
-                            break;
-                    }
+                            case CompleteMotion:
+                            default:
+                                direction = vf->direction(x,y);
+                                break;
+                        }
                     
-                    float len = direction.length();
+                        float len = direction.length();
                     
-                    if(len!=0)
-                    {
-                        if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                        if(len!=0)
                         {
-                            direction=direction/len*m_normalizedLength->value();
-                        }
+                            if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                            {
+                                direction=direction/len*m_normalizedLength->value();
+                            }
                         
-                        target = origin + direction;
+                            target = origin + direction;
                     
-                        float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
+                            float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
                     
-                        m_vector_drawer.paint(painter, origin, target, normalized_weight);
+                            m_vector_drawer.addToBatch(origin, target, normalized_weight);
+                        }
                     }
                 }
             }
         }
+        m_vector_drawer.paintBatch(painter);
         
         painter->restore();
     }
@@ -257,6 +264,7 @@ void DenseVectorfield2DViewController::updateView()
     m_vector_drawer.setLineWidth(m_lineWidth->value());
     m_vector_drawer.setHeadSize(m_headSize->value());
     m_vector_drawer.setColorTable(m_colorTable->value());
+    m_vector_drawer.invalidateBatch();
     
     //Display arrows length scaled
     if(m_normalizeLength->value() && m_normalizeLength->value() != 0)
@@ -374,7 +382,9 @@ DenseVectorfield2DParticleViewController::DenseVectorfield2DParticleViewControll
     m_velocityLegendTicks(new IntParameter("Legend ticks", 0, 1000, 10, m_showVelocityLegend)),
     m_velocityLegendDigits(new IntParameter("Legend digits", 0, 10, 2, m_showVelocityLegend)),
     m_velocity_legend(NULL),
-    m_dense_model(vf)
+    m_dense_model(vf),
+    m_timing(-1),
+    m_timer_id(-1)
 {
     QStringList displayMotionModes;
 		displayMotionModes.append("Complete motion");
@@ -458,23 +468,51 @@ void DenseVectorfield2DParticleViewController::paint(QPainter *painter, const QS
     if(m_dense_model->isViewable())
     {
         painter->save();
-
+        
+        //Sort the visible particles by color, so that the pen changes only once per color
+        const ParticleFrame& frame = m_engine.frame();
+        QRectF view_rect = ViewController::rect();
+        
+        for(QVector<QPointF>& bucket : m_color_buckets)
+        {
+            bucket.resize(0);
+        }
+        
+        for(unsigned int i=0 ; i < frame.size(); i++)
+        {
+            QPointF pos(frame.x[i], frame.y[i]);
+            
+            if(frame.lifetime[i] && view_rect.contains(pos))
+            {
+                m_color_buckets[frame.color[i]].append(pos);
+            }
+        }
+        
         QPen   dotPen;
+        float  radius = m_particleRadius->value();
+        
+        for(int c=0; c!=256; ++c)
+        {
+            const QVector<QPointF>& bucket = m_color_buckets[c];
             
-        for(unsigned int i=0 ; i < (unsigned int)m_positions.size(); i++)
-        {	
-            float current_length = m_dense_model->length(m_positions[i].x(),m_positions[i].y());
+            if(bucket.isEmpty())
+                continue;
             
-            float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
-
-            dotPen.setColor(QColor(m_colorTable->value().at(normalized_weight*255)));
+            dotPen.setColor(QColor(m_colorTable->value().at(c)));
             painter->setPen(dotPen);
             painter->setBrush(dotPen.color());
             
-            
-            if(m_lifetimes[i] && ViewController::rect().contains(m_positions[i]) )
+            //Particles smaller than the pen are drawn as points at once
+            if(radius < 1)
+            {
+                painter->drawPoints(bucket.constData(), bucket.size());
+            }
+            else
             {
-                painter->drawEllipse(m_positions[i],m_particleRadius->value(),m_particleRadius->value());
+                for(const QPointF& pos : bucket)
+                {
+                    painter->drawEllipse(pos, radius, radius);
+                }
             }
         }
         painter->restore();
@@ -547,22 +585,7 @@ void DenseVectorfield2DParticleViewController::updateView()
     
     m_velocity_legend->setVisible(m_showVelocityLegend->value());
     
-	if(m_particles->value() !=  m_positions.size())
-	{
-        unsigned int new_particle_count = m_particles->value();
-        
-        m_positions.resize(new_particle_count);
-        m_lifetimes.resize(new_particle_count);
-	
-        int w = model()->width(),
-            h = model()->height();
-        
-        for(unsigned int i=0; i < new_particle_count; i++)
-        {		
-            m_positions[i] = QPointF(rand() % w, rand() % h);
-            m_lifetimes[i] = m_particleLifetime->value();
-        }
-	}
+    updateEngine();
     
 	if(m_timerInterval->value() != m_timing)
 	{
@@ -584,51 +607,33 @@ void DenseVectorfield2DParticleViewController::timerEvent(QTimerEvent *event)
     if(!m_dense_model->isViewable())
         return;
 	
-	int x,y;
-	float current_length;
+    //Only repaint if the worker thread has finished the next frame
+    if(m_engine.advance())
+    {
+        update();
+    }
+}
+
+ParticleSettings DenseVectorfield2DParticleViewController::particleSettings() const
+{
+    ParticleSettings settings;
     
-    DenseVectorfield2D::PointType dir;
-	
-	for(unsigned int i=0; i < (unsigned int)m_positions.size(); i++)
-	{
-		x=(int)(m_positions[i].x()+0.5);
-		y=(int)(m_positions[i].y()+0.5);
-        dir = m_dense_model->direction(x,y);
-        
-		current_length = m_dense_model->length(x,y);
-        
-		switch( m_displayMotionMode->value() )
-		{
-			case GlobalMotion:
-				dir = m_dense_model->globalDirection(x,y);
-				break;
-				
-			case LocalMotion:
-				dir = m_dense_model->localDirection(x,y);
-				break;
-			case CompleteMotion:
-            default:
-				dir = m_dense_model->direction(x,y);
-                break;
-		}
-		
-		if (	m_lifetimes[i] > 0
-			&&	x >= 0 && x < (int)m_dense_model->width()
-			&&	y >= 0 && y < (int)m_dense_model->height()
-			&&	current_length >= m_minLength->value() && current_length <= m_maxLength->value() )
-		{		
-			m_positions[i].rx() += dir.x()/m_slowDown->value();
-			m_positions[i].ry() += dir.y()/m_slowDown->value();
-			
-			m_lifetimes[i]--;
-		}
-		else
-		{
-			m_positions[i] = QPointF(rand() % (int)m_dense_model->width(),rand() % (int)m_dense_model->height());
-			m_lifetimes[i] = m_particleLifetime->value();
-		}
-	}
-	update();
+    settings.lifetime   = m_particleLifetime->value();
+    settings.slow_down  = m_slowDown->value();
+    settings.min_length = m_minLength->value();
+    settings.max_length = m_maxLength->value();
+    
+    return settings;
+}
+
+void DenseVectorfield2DParticleViewController::updateEngine()
+{
+    if(!m_dense_model->isViewable())
+        return;
+    
+    m_engine.setField(m_dense_model, (Vectorfield2DMotionDisplayMode)m_displayMotionMode->value());
+    m_engine.setSettings(particleSettings());
+    m_engine.setParticleCount(m_particles->value());
 }
 
 void DenseVectorfield2DParticleViewController::hoverMoveEvent(QGraphicsSceneHoverEvent * event)
@@ -752,62 +757,69 @@ void DenseWeightedVectorfield2DViewController::paint(QPainter *painter, const QS
         
         QPointFX origin, direction, target;
         
-        int step_y = vf->height()/m_resolution->value().y(),
-            step_x = vf->width()/m_resolution->value().x();
+        int step_y = std::max(1, int(vf->height()/m_resolution->value().y())),
+            step_x = std::max(1, int(vf->width()/m_resolution->value().x()));
         
-        for(unsigned int y=step_y/2; y < vf->height(); y+=step_x)
+        //Rebuild the cached arrow glyphs only if the view parameters or the model have changed
+        if(!m_vector_drawer.isBatchValid())
         {
-            for(unsigned int x=step_x/2; x < vf->width(); x+=step_y)
+            m_vector_drawer.beginBatch();
+            
+            for(unsigned int y=step_y/2; y < vf->height(); y+=step_y)
             {
-                float current_length = vf->length(x,y);
-                float current_weight = vf->weight(x,y);
-                
-                if(     current_length!=0
-                    && (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value())
-                    && (current_weight>= m_minWeight->value()) && (current_weight <= m_maxWeight->value()))
+                for(unsigned int x=step_x/2; x < vf->width(); x+=step_x)
                 {
-                    origin.setX(x);
-                    origin.setY(y);
-
-                    switch( m_displayMotionMode->value() )
+                    float current_length = vf->length(x,y);
+                    float current_weight = vf->weight(x,y);
+                
+                    if(     current_length!=0
+                        && (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value())
+                        && (current_weight>= m_minWeight->value()) && (current_weight <= m_maxWeight->value()))
                     {
-                        case GlobalMotion:
-                            direction = vf->globalDirection(x,y);
-                            break;
+                        origin.setX(x);
+                        origin.setY(y);
+
+                        switch( m_displayMotionMode->value() )
+                        {
+                            case GlobalMotion:
+                                direction = vf->globalDirection(x,y);
+                                break;
                             
-                        case LocalMotion:
-                            direction = vf->localDirection(x,y);
-                            break;
+                            case LocalMotion:
+                                direction = vf->localDirection(x,y);
+                                break;
                             
-                        case CompleteMotion:
-                        default:
-                            direction = vf->direction(x,y);
-                            break;
-                    }
+                            case CompleteMotion:
+                            default:
+                                direction = vf->direction(x,y);
+                                break;
+                        }
                     
-                    float len = direction.length();
+                        float len = direction.length();
                     
-                    if(len!=0)
-                    {
-                        if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                        if(len!=0)
                         {
-                            direction=direction/len*m_normalizedLength->value();
-                        }
+                            if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                            {
+                                direction=direction/len*m_normalizedLength->value();
+                            }
                         
-                        target = origin + direction;
+                            target = origin + direction;
                     
-                        float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
+                            float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
                     
-                        if (m_useColorForWeight->value() )
-                        {
-                            normalized_weight = (current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value());
-                        }
+                            if (m_useColorForWeight->value() )
+                            {
+                                normalized_weight = (current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value());
+                            }
                         
-                        m_vector_drawer.paint(painter, origin, target, normalized_weight);
+                            m_vector_drawer.addToBatch(origin, target, normalized_weight);
+                        }
                     }
                 }
             }
         }
+        m_vector_drawer.paintBatch(painter);
         
         painter->restore();
     }
@@ -1010,59 +1022,6 @@ DenseWeightedVectorfield2DParticleViewController::~DenseWeightedVectorfield2DPar
     delete m_weight_legend;
 }
 
-void DenseWeightedVectorfield2DParticleViewController::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
-{ 
-	ViewController::paintBefore(painter, option, widget);
-	
-    if(m_dense_weighted_model->isViewable())
-    {
-        painter->save();
-        
-        QPen   dotPen;
-        
-        if(m_useColorForWeight->value())
-        {
-            
-            for(unsigned int i=0 ; i < (unsigned int)m_positions.size(); i++)
-            {	
-                float current_weight = m_dense_weighted_model->length(m_positions[i].x(),m_positions[i].y());
-                float normalized_weight = std::min(1.0f,std::max(0.0f,(current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
-                
-                dotPen.setColor(QColor(m_colorTable->value().at(normalized_weight*255)));
-                painter->setPen(dotPen);
-                painter->setBrush(dotPen.color());
-                
-                
-                if(m_lifetimes[i] && rect().contains(m_positions[i]) )
-                {
-                    painter->drawEllipse(m_positions[i],m_particleRadius->value(),m_particleRadius->value());
-                }
-            }
-        }
-        else
-        {
-            for(unsigned int i=0 ; i < (unsigned int)m_positions.size(); i++)
-            {	
-                float current_length = m_dense_weighted_model->length(m_positions[i].x(),m_positions[i].y());
-                float normalized_length = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
-                
-                dotPen.setColor(QColor(m_colorTable->value().at(normalized_length*255)));
-                painter->setPen(dotPen);
-                painter->setBrush(dotPen.color());
-                
-                
-                if(m_lifetimes[i] && rect().contains(m_positions[i]) )
-                {
-                    painter->drawEllipse(m_positions[i],m_particleRadius->value(),m_particleRadius->value());
-                }
-            }
-        }
-        painter->restore();
-    }
-    
-	ViewController::paintAfter(painter, option, widget);
-}
-
 void DenseWeightedVectorfield2DParticleViewController::updateParameters(bool force_update)
 {
     DenseVectorfield2DParticleViewController::updateParameters(force_update);
@@ -1118,61 +1077,25 @@ void DenseWeightedVectorfield2DParticleViewController::updateView()
 	}	
 }
 
-void DenseWeightedVectorfield2DParticleViewController::timerEvent(QTimerEvent *event)
+ParticleSettings DenseWeightedVectorfield2DParticleViewController::particleSettings() const
+{
+    ParticleSettings settings = DenseVectorfield2DParticleViewController::particleSettings();
+    
+    settings.use_weights     = true;
+    settings.min_weight      = m_minWeight->value();
+    settings.max_weight      = m_maxWeight->value();
+    settings.color_by_weight = m_useColorForWeight->value();
+    
+    return settings;
+}
+
+void DenseWeightedVectorfield2DParticleViewController::updateEngine()
 {
-	
-	if(	!this->isVisible() || event->timerId() != m_timer_id)
-		return;
-	
     if(!m_dense_weighted_model->isViewable())
         return;
-	
-    int x,y;
-	float current_length, current_weight;
-    
-    DenseVectorfield2D::PointType dir;
     
-	for(unsigned int i=0; i < (unsigned int)m_positions.size(); i++)
-	{
-		x=(int)(m_positions[i].x()+0.5);
-        y=(int)(m_positions[i].y()+0.5);
-        
-		current_length = m_dense_weighted_model->length(x,y);
-		current_weight = m_dense_weighted_model->weight(x,y);
-		
-        switch( m_displayMotionMode->value() )
-		{
-			case GlobalMotion:
-				dir = m_dense_model->globalDirection(x,y);
-				break;
-				
-			case LocalMotion:
-				dir = m_dense_model->localDirection(x,y);
-				break;
-			case CompleteMotion:
-            default:
-				dir = m_dense_model->direction(x,y);
-                break;
-		}
-        
-		if (	m_lifetimes[i] > 0
-			&&	x >= 0 && x < (int)m_dense_weighted_model->width()
-			&&	y >= 0 && y < (int)m_dense_weighted_model->height()
-			&&	current_length >= m_minLength->value() && current_length <= m_maxLength->value() 
-			&&	current_weight >= m_minWeight->value() && current_weight <= m_maxWeight->value() )
-		{		
-			m_positions[i].rx() += dir.x()/m_slowDown->value();
-			m_positions[i].ry() += dir.y()/m_slowDown->value();
-			
-			m_lifetimes[i]--;
-		}
-		else
-		{
-			m_positions[i] = QPointF(rand() % (int)m_dense_weighted_model->width(),rand() % (int)m_dense_weighted_model->height());
-			m_lifetimes[i] = m_particleLifetime->value();
-		}
-	}
-	update();
+    DenseVectorfield2DParticleViewController::updateEngine();
+    m_engine.setWeights(m_dense_weighted_model);
 }
 
 void DenseWeightedVectorfield2DParticleViewController::hoverMoveEvent ( QGraphicsSceneHoverEvent * event )
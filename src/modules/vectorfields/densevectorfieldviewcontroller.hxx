@@ -41,6 +41,7 @@
 #include "vectorfields/vectordrawer.hxx"
 #include "vectorfields/densevectorfield.hxx"
 #include "vectorfields/densevectorfieldstatistics.hxx"
+#include "vectorfields/particleengine.hxx"
 #include "vectorfields/config.hxx"
 
 namespace graipe {
@@ -163,6 +164,7 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2DViewController
  * A class for viewing of a dense vectorfield by means of a particle flow
  * simulation on a QGraphicsScene/View and
  * controlling the view using different parameters.
+ * The simulation is computed by a ParticleEngine in the background.
  */
 class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2DParticleViewController
 : public ViewController
@@ -237,6 +239,19 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2DParticleViewController
          * \param event The mouse event which triggered this function.
          */
         void hoverMoveEvent(QGraphicsSceneHoverEvent * event);
+    
+        /**
+         * The simulation settings according to the current parameters.
+         *
+         * \return The settings of the particle engine.
+         */
+        virtual ParticleSettings particleSettings() const;
+    
+        /**
+         * Passes the vectorfield, the settings and the particle count
+         * to the particle engine.
+         */
+        virtual void updateEngine();
 	
         /** Statistics **/
         DenseVectorfield2DStatistics* m_stats;
@@ -274,12 +289,11 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseVectorfield2DParticleViewController
          * @} 
          */
     
-        /** Cached particle positions **/
-		QVector<QPointF>      m_positions;
+        /** The particle simulation **/
+        ParticleEngine m_engine;
     
-        /** Cached particle lifetimes **/
-		QVector<unsigned int> m_lifetimes;
-	
+        /** The visible particles of one frame, sorted by their color index **/
+        QVector<QPointF> m_color_buckets[256];
 };
 
 
@@ -393,16 +407,6 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseWeightedVectorfield2DParticleViewControlle
          * destructor.
          */
 		~DenseWeightedVectorfield2DParticleViewController();
-    
-        /**
-         * Implementation/specialization of the ViewController's paint procedure. This is called
-         * by the QGraphicsView on every re-draw request.
-         *
-         * \param painter Pointer to the painter, which is used for drawing.
-         * \param option Further style options for this GraphicsItem's drawing.
-         * \param widget The widget, where we will draw onto.
-         */
-		void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
             
         /**
          * The typename of this ViewController
@@ -430,18 +434,25 @@ class GRAIPE_VECTORFIELDS_EXPORT DenseWeightedVectorfield2DParticleViewControlle
     
     protected:
         /**
-         * Slot for handling the update of the timer
+         * Implementation/specialization of the handling of a mouse-move event
          *
-         * \param event The timer event which triggered this function.
+         * \param event The mouse event which triggered this function.
          */
-		void timerEvent(QTimerEvent *event);
+        void hoverMoveEvent(QGraphicsSceneHoverEvent * event);
     
         /**
-         * Implementation/specialization of the handling of a mouse-move event
+         * The simulation settings according to the current parameters,
+         * extended by the weight ranges.
          *
-         * \param event The mouse event which triggered this function.
+         * \return The settings of the particle engine.
          */
-        void hoverMoveEvent(QGraphicsSceneHoverEvent * event);
+        ParticleSettings particleSettings() const;
+    
+        /**
+         * Passes the vectorfield (including the weights), the settings and
+         * the particle count to the particle engine.
+         */
+        void updateEngine();
     
         /** 
          * @{
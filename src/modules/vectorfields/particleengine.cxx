@@ -0,0 +1,351 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include "vectorfields/particleengine.hxx"
+
+#include <QRunnable>
+
+#include <algorithm>
+#include <cmath>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_vectorfields
+ * @{
+ *     @file
+ *     @brief Implementation file for the particle advection engine of dense vectorfields
+ * @}
+ */
+
+/**
+ * The task of the worker thread: Computes the next frame of a particle
+ * engine and resets the engine's busy flag afterwards.
+ */
+class ParticleStepTask
+:   public QRunnable
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param engine The particle engine.
+         * \param src The current frame.
+         * \param dest The next frame.
+         * \param busy The busy flag of the engine.
+         */
+        ParticleStepTask(ParticleEngine* engine, const ParticleFrame* src, ParticleFrame* dest, QAtomicInt* busy)
+        :   m_engine(engine),
+            m_src(src),
+            m_dest(dest),
+            m_busy(busy)
+        {
+        }
+    
+        /**
+         * Computes the next frame.
+         */
+        void run()
+        {
+            m_engine->step(*m_src, *m_dest);
+            m_busy->storeRelease(0);
+        }
+    
+    protected:
+        /** The particle engine **/
+        ParticleEngine* m_engine;
+        /** The current frame **/
+        const ParticleFrame* m_src;
+        /** The next frame **/
+        ParticleFrame* m_dest;
+        /** The busy flag of the engine **/
+        QAtomicInt* m_busy;
+};
+
+ParticleEngine::ParticleEngine()
+:   m_current(0),
+    m_next_valid(false),
+    m_width(0),
+    m_height(0),
+    m_random_state(2463534242u),
+    m_busy(0)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+ParticleEngine::~ParticleEngine()
+{
+    m_pool.waitForDone();
+}
+
+void ParticleEngine::setField(const DenseVectorfield2D* vf, Vectorfield2DMotionDisplayMode mode)
+{
+    invalidate();
+    
+    //Read the directions by means of the per-vector accessors, which
+    //decode the 16 bit storage modes on the fly without a decoded copy
+    m_width  = vf->shape()[0];
+    m_height = vf->shape()[1];
+    
+    m_u.resize(vf->size());
+    m_v.resize(vf->size());
+    m_length.resize(vf->size());
+    m_weight.clear();
+    
+    QTransform trans = vf->globalMotion();
+    std::size_t i=0;
+    
+    for(int y=0; y<m_height; ++y)
+    {
+        for(int x=0; x<m_width; ++x, ++i)
+        {
+            DenseVectorfield2D::PointType dir = vf->direction(x,y);
+            
+            float du = dir.x(),
+                  dv = dir.y();
+            
+            //The lengths always refer to the complete motion
+            m_length[i] = std::sqrt(du*du + dv*dv);
+            
+            if(mode != CompleteMotion)
+            {
+                QPointF g_dir = trans.map(QPointF(x,y)) - QPointF(x,y);
+                
+                if(mode == GlobalMotion)
+                {
+                    du = g_dir.x();
+                    dv = g_dir.y();
+                }
+                else
+                {
+                    du -= g_dir.x();
+                    dv -= g_dir.y();
+                }
+            }
+            m_u[i] = du;
+            m_v[i] = dv;
+        }
+    }
+}
+
+void ParticleEngine::setWeights(const DenseWeightedVectorfield2D* vf)
+{
+    invalidate();
+    
+    if(vf->shape()[0] != m_width || vf->shape()[1] != m_height)
+    {
+        m_weight.clear();
+        return;
+    }
+    
+    m_weight.resize(vf->size());
+    std::size_t i=0;
+    
+    for(int y=0; y<m_height; ++y)
+    {
+        for(int x=0; x<m_width; ++x, ++i)
+        {
+            m_weight[i] = vf->weight(x,y);
+        }
+    }
+}
+
+void ParticleEngine::setSettings(const ParticleSettings& settings)
+{
+    invalidate();
+    
+    m_settings = settings;
+}
+
+void ParticleEngine::setParticleCount(unsigned int count)
+{
+    ParticleFrame& current = m_frames[m_current];
+    
+    if(count == current.size())
+        return;
+    
+    invalidate();
+    
+    current.resize(count);
+    
+    for(unsigned int i=0; i<count; ++i)
+    {
+        current.x[i] = random()*std::max(0, m_width-1);
+        current.y[i] = random()*std::max(0, m_height-1);
+        current.lifetime[i] = m_settings.lifetime;
+        current.color[i] = 0;
+    }
+}
+
+bool ParticleEngine::advance()
+{
+    if(m_busy.loadAcquire())
+        return false;
+    
+    bool changed = false;
+    
+    if(m_next_valid)
+    {
+        m_current = 1 - m_current;
+        changed = true;
+    }
+    
+    m_next_valid = true;
+    m_busy.storeRelease(1);
+    m_pool.start(new ParticleStepTask(this, &m_frames[m_current], &m_frames[1-m_current], &m_busy));
+    
+    return changed;
+}
+
+const ParticleFrame& ParticleEngine::frame() const
+{
+    return m_frames[m_current];
+}
+
+void ParticleEngine::step(const ParticleFrame& src, ParticleFrame& dest)
+{
+    const unsigned int n = src.size();
+    
+    dest.resize(n);
+    m_respawn.resize(n);
+    
+    if(m_width == 0 || m_height == 0)
+    {
+        std::fill(dest.lifetime.begin(), dest.lifetime.end(), 0);
+        return;
+    }
+    
+    const float max_x = m_width-1,
+                max_y = m_height-1,
+                inv_slow_down = (m_settings.slow_down > 0) ? 1.0f/m_settings.slow_down : 1.0f;
+    
+    const bool has_weights     = !m_weight.empty(),
+               use_weights     = has_weights && m_settings.use_weights,
+               color_by_weight = has_weights && m_settings.color_by_weight;
+    
+    const float color_min   = color_by_weight ? m_settings.min_weight : m_settings.min_length,
+                color_max   = color_by_weight ? m_settings.max_weight : m_settings.max_length,
+                color_scale = (color_max > color_min) ? 255.0f/(color_max - color_min) : 0.0f;
+    
+    const float * u = m_u.data(),
+                * v = m_v.data(),
+                * len = m_length.data(),
+                * wgt = has_weights ? m_weight.data() : m_length.data();
+    
+    const float * src_x = src.x.data(),
+                * src_y = src.y.data();
+    const unsigned int * src_lifetime = src.lifetime.data();
+    
+    float * dest_x = dest.x.data(),
+          * dest_y = dest.y.data();
+    unsigned int * dest_lifetime = dest.lifetime.data();
+    unsigned char * dest_color = dest.color.data(),
+                  * respawn = m_respawn.data();
+    
+    //First pass: Sample the field bilinearly and move all particles.
+    //Branch-free, so that the compiler may vectorize this loop.
+    for(unsigned int i=0; i<n; ++i)
+    {
+        const float x = src_x[i],
+                    y = src_y[i];
+        
+        const bool inside = (x >= 0.0f) & (x <= max_x) & (y >= 0.0f) & (y <= max_y);
+        
+        const float cx = std::min(std::max(x, 0.0f), max_x),
+                    cy = std::min(std::max(y, 0.0f), max_y);
+        
+        const int x0 = int(cx),
+                  y0 = int(cy),
+                  x1 = std::min(x0+1, m_width-1),
+                  y1 = std::min(y0+1, m_height-1);
+        
+        const float fx = cx - x0,
+                    fy = cy - y0,
+                    w00 = (1.0f-fx)*(1.0f-fy), w10 = fx*(1.0f-fy),
+                    w01 = (1.0f-fx)*fy,        w11 = fx*fy;
+        
+        const int i00 = y0*m_width + x0, i10 = y0*m_width + x1,
+                  i01 = y1*m_width + x0, i11 = y1*m_width + x1;
+        
+        const float du = w00*u[i00]   + w10*u[i10]   + w01*u[i01]   + w11*u[i11],
+                    dv = w00*v[i00]   + w10*v[i10]   + w01*v[i01]   + w11*v[i11],
+                    l  = w00*len[i00] + w10*len[i10] + w01*len[i01] + w11*len[i11],
+                    w  = w00*wgt[i00] + w10*wgt[i10] + w01*wgt[i01] + w11*wgt[i11];
+        
+        const bool alive =    (src_lifetime[i] > 0) & inside
+                            & (l >= m_settings.min_length) & (l <= m_settings.max_length)
+                            & (!use_weights | ((w >= m_settings.min_weight) & (w <= m_settings.max_weight)));
+        
+        dest_x[i] = x + du*inv_slow_down;
+        dest_y[i] = y + dv*inv_slow_down;
+        dest_lifetime[i] = alive ? src_lifetime[i]-1 : 0;
+        respawn[i] = !alive;
+        
+        const float c = ((color_by_weight ? w : l) - color_min)*color_scale;
+        dest_color[i] = (unsigned char)std::min(255.0f, std::max(0.0f, c));
+    }
+    
+    //Second pass: Respawn the particles, which left the field or the ranges
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(respawn[i])
+        {
+            dest_x[i] = random()*max_x;
+            dest_y[i] = random()*max_y;
+            dest_lifetime[i] = m_settings.lifetime;
+            
+            const int idx = int(dest_y[i]+0.5f)*m_width + int(dest_x[i]+0.5f);
+            const float c = ((color_by_weight ? wgt[idx] : len[idx]) - color_min)*color_scale;
+            dest_color[i] = (unsigned char)std::min(255.0f, std::max(0.0f, c));
+        }
+    }
+}
+
+void ParticleEngine::invalidate()
+{
+    m_pool.waitForDone();
+    m_next_valid = false;
+}
+
+float ParticleEngine::random()
+{
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 17;
+    m_random_state ^= m_random_state << 5;
+    
+    return (m_random_state >> 8) * (1.0f/16777216.0f);
+}
+
+} //end of namespace graipe
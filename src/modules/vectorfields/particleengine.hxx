@@ -0,0 +1,255 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2008-2017 by Benjamin Seppke                 */
+/*       Cognitive Systems Group, University of Hamburg, Germany        */
+/*                                                                      */
+/*    This file is part of the GrAphical Image Processing Enviroment.   */
+/*    The GRAIPE Website may be found at:                               */
+/*        https://github.com/bseppke/graipe                             */
+/*    Please direct questions, bug reports, and contributions to        */
+/*    the GitHub page and use the methods provided there.               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef GRAIPE_VECTORFIELDS_PARTICLEENGINE_HXX
+#define GRAIPE_VECTORFIELDS_PARTICLEENGINE_HXX
+
+#include "vectorfields/densevectorfield.hxx"
+#include "vectorfields/config.hxx"
+
+#include <QAtomicInt>
+#include <QThreadPool>
+
+#include <vector>
+
+namespace graipe {
+
+/**
+ * @addtogroup graipe_vectorfields
+ * @{
+ *
+ * @file
+ * @brief Header file for the particle advection engine of dense vectorfields
+ */
+
+/**
+ * One frame of a particle simulation. The particles are stored as a
+ * structure of arrays, so that the stepping loops run over contiguous
+ * memory and may be vectorized by the compiler.
+ */
+struct ParticleFrame
+{
+    /** The x-positions of the particles **/
+    std::vector<float> x;
+    /** The y-positions of the particles **/
+    std::vector<float> y;
+    /** The remaining lifetimes of the particles, zero for hidden particles **/
+    std::vector<unsigned int> lifetime;
+    /** The color index (0..255) of the particles w.r.t. the color range **/
+    std::vector<unsigned char> color;
+    
+    /**
+     * Resizes all arrays of the frame.
+     *
+     * \param count The new particle count.
+     */
+    void resize(unsigned int count)
+    {
+        x.resize(count);
+        y.resize(count);
+        lifetime.resize(count);
+        color.resize(count);
+    }
+    
+    /**
+     * The particle count of the frame.
+     *
+     * \return The count of particles.
+     */
+    unsigned int size() const
+    {
+        return (unsigned int)x.size();
+    }
+};
+
+/**
+ * The settings of a particle simulation.
+ */
+struct ParticleSettings
+{
+    /** Default constructor **/
+    ParticleSettings()
+    :   lifetime(50),
+        slow_down(1),
+        min_length(0), max_length(0),
+        use_weights(false),
+        min_weight(0), max_weight(1),
+        color_by_weight(false)
+    {
+    }
+    
+    /** The lifetime (in steps) of newly spawned particles **/
+    unsigned int lifetime;
+    /** The directions will be divided by this factor at each step **/
+    float slow_down;
+    /** Particles at vectors outside this length range will be respawned **/
+    float min_length, max_length;
+    /** If true, particles at vectors outside the weight range will be respawned, too **/
+    bool use_weights;
+    /** The weight range **/
+    float min_weight, max_weight;
+    /** If true, the particles are colored by the weights, else by the lengths **/
+    bool color_by_weight;
+};
+
+/**
+ * A particle advection engine for dense vectorfields. The vectorfield is
+ * copied into flat arrays once, which are sampled bilinearly for each
+ * particle. The next frame is always computed by a worker thread while the
+ * current frame is displayed (double-buffering), so that the GUI thread only
+ * swaps the frames at each timer event and never waits for the simulation.
+ *
+ * All functions are meant to be called from the GUI thread only.
+ */
+class GRAIPE_VECTORFIELDS_EXPORT ParticleEngine
+{
+    public:
+        /**
+         * Default constructor. Creates an engine without field and particles.
+         */
+        ParticleEngine();
+    
+        /**
+         * Destructor. Waits for the worker thread to finish.
+         */
+        ~ParticleEngine();
+    
+        /**
+         * Copies the directions and lengths of a dense vectorfield into the
+         * engine. The directions are decomposed w.r.t. the global motion
+         * of the vectorfield according to the display mode.
+         *
+         * \param vf The dense vectorfield.
+         * \param mode The motion display mode.
+         */
+        void setField(const DenseVectorfield2D* vf, Vectorfield2DMotionDisplayMode mode);
+    
+        /**
+         * Copies the weights of a dense weighted vectorfield into the engine.
+         * Needs to be called after setField().
+         *
+         * \param vf The dense weighted vectorfield.
+         */
+        void setWeights(const DenseWeightedVectorfield2D* vf);
+    
+        /**
+         * Setter for the simulation settings.
+         *
+         * \param settings The new settings.
+         */
+        void setSettings(const ParticleSettings& settings);
+    
+        /**
+         * Respawns all particles at random positions, if the particle count
+         * has changed.
+         *
+         * \param count The new particle count.
+         */
+        void setParticleCount(unsigned int count);
+    
+        /**
+         * Advances the simulation by one step. If the next frame is ready, it
+         * becomes the current frame and the computation of the following
+         * frame is started in the background. If the worker thread is still
+         * busy, nothing happens (the step is skipped).
+         *
+         * \return True, if the current frame has changed.
+         */
+        bool advance();
+    
+        /**
+         * The current frame, which shall be displayed.
+         *
+         * \return Constant reference to the current frame.
+         */
+        const ParticleFrame& frame() const;
+    
+        /**
+         * Computes one simulation step. Called by the worker thread.
+         *
+         * \param src The current frame.
+         * \param dest The next frame.
+         */
+        void step(const ParticleFrame& src, ParticleFrame& dest);
+    
+    protected:
+        /**
+         * Waits for the worker thread and discards a frame, which has been
+         * computed with outdated field or settings.
+         */
+        void invalidate();
+    
+        /**
+         * Random number generator (xorshift) for the respawn positions.
+         *
+         * \return A random number in [0,1).
+         */
+        float random();
+    
+        /** The frames: current (displayed) and next (computed in background) **/
+        ParticleFrame m_frames[2];
+        /** The index of the current frame **/
+        int m_current;
+        /** Is the next frame ready to be displayed? **/
+        bool m_next_valid;
+    
+        /** The shape of the field **/
+        int m_width, m_height;
+        /** The displayed directions and the lengths of the complete directions **/
+        std::vector<float> m_u, m_v, m_length;
+        /** The weights (empty for unweighted vectorfields) **/
+        std::vector<float> m_weight;
+    
+        /** The simulation settings **/
+        ParticleSettings m_settings;
+    
+        /** The state of the random number generator **/
+        quint32 m_random_state;
+    
+        /** Temporary respawn flags of one step **/
+        std::vector<unsigned char> m_respawn;
+    
+        /** The worker thread and its busy flag **/
+        QThreadPool m_pool;
+        QAtomicInt  m_busy;
+};
+
+/**
+ * @}
+ */
+
+} //end of namespace graipe
+
+#endif //GRAIPE_VECTORFIELDS_PARTICLEENGINE_HXX
@@ -114,6 +114,29 @@ void SparseVectorfield2D::addVector(const PointType& orig, const PointType& dir)
 	updateModel();
 }
 
+void SparseVectorfield2D::addVectors(const std::vector<PointType>& origins, const std::vector<PointType>& directions)
+{
+    if(locked())
+        return;
+    
+    Q_ASSERT(origins.size() == directions.size());
+    
+    ModelTransaction transaction(this);
+    
+    reserve(size() + origins.size());
+    
+    for(unsigned int i=0; i<origins.size(); ++i)
+    {
+        addVector(origins[i], directions[i]);
+    }
+}
+
+void SparseVectorfield2D::reserve(unsigned int count)
+{
+    m_origins.reserve(count);
+    m_directions.reserve(count);
+}
+
 void SparseVectorfield2D::removeVector(unsigned int index)
 {
     if(locked())
@@ -127,6 +150,38 @@ void SparseVectorfield2D::removeVector(unsigned int index)
     }
 }
 
+const std::vector<SparseVectorfield2D::PointType>& SparseVectorfield2D::origins() const
+{
+    return m_origins;
+}
+
+const std::vector<SparseVectorfield2D::PointType>& SparseVectorfield2D::directions() const
+{
+    return m_directions;
+}
+
+void SparseVectorfield2D::copyOrigins(std::vector<PointType>& origins) const
+{
+    origins = m_origins;
+}
+
+void SparseVectorfield2D::copyDirections(std::vector<PointType>& directions) const
+{
+    directions = m_directions;
+}
+
+void SparseVectorfield2D::globalDirections(std::vector<PointType>& global_dirs) const
+{
+    global_dirs.resize(m_origins.size());
+    decomposeMotion(globalMotion(), m_origins.data(), NULL, m_origins.size(), global_dirs.data(), NULL);
+}
+
+void SparseVectorfield2D::localDirections(std::vector<PointType>& local_dirs) const
+{
+    local_dirs.resize(m_origins.size());
+    decomposeMotion(globalMotion(), m_origins.data(), m_directions.data(), m_origins.size(), NULL, local_dirs.data());
+}
+
 QString SparseVectorfield2D::csvHeader() const
 {
 	return "pos_x, pos_y, dir_x, dir_y";
@@ -317,6 +372,30 @@ void SparseWeightedVectorfield2D::addVector(const PointType& orig, const PointTy
     SparseVectorfield2D::addVector(orig, dir);
 }
 
+void SparseWeightedVectorfield2D::addVectors(const std::vector<PointType>& origins, const std::vector<PointType>& directions, const std::vector<float>& weights)
+{
+    if (locked())
+        return;
+    
+    Q_ASSERT(origins.size() == directions.size());
+    Q_ASSERT(origins.size() == weights.size());
+    
+    ModelTransaction transaction(this);
+    
+    reserve(size() + origins.size());
+    
+    for(unsigned int i=0; i<origins.size(); ++i)
+    {
+        addVector(origins[i], directions[i], weights[i]);
+    }
+}
+
+void SparseWeightedVectorfield2D::reserve(unsigned int count)
+{
+    m_weights.reserve(count);
+    SparseVectorfield2D::reserve(count);
+}
+
 void SparseWeightedVectorfield2D::removeVector(unsigned int index)
 {
     if (locked())
@@ -329,6 +408,11 @@ void SparseWeightedVectorfield2D::removeVector(unsigned int index)
     SparseVectorfield2D::removeVector(index);
 }
 
+const std::vector<float>& SparseWeightedVectorfield2D::weights() const
+{
+    return m_weights;
+}
+
 QString SparseWeightedVectorfield2D::csvHeader() const
 {
 	return SparseVectorfield2D::csvHeader() + ", weight";
@@ -545,6 +629,12 @@ void SparseMultiVectorfield2D::addVector(const PointType& orig, const std::vecto
     addVector(orig, all_dirs.front(), alt_dirs);
 }
 
+void SparseMultiVectorfield2D::reserve(unsigned int count)
+{
+    m_alt_directions.reserve(count);
+    SparseVectorfield2D::reserve(count);
+}
+
 void SparseMultiVectorfield2D::removeVector(unsigned int index)
 {		
 	if(locked())
@@ -557,6 +647,30 @@ void SparseMultiVectorfield2D::removeVector(unsigned int index)
     }
 }
 
+const std::vector<SparseMultiVectorfield2D::PointType>& SparseMultiVectorfield2D::altDirections(unsigned int index) const
+{
+    return m_alt_directions[index];
+}
+
+void SparseMultiVectorfield2D::copyAltDirections(unsigned int alt_index, std::vector<PointType>& alt_dirs) const
+{
+    alt_dirs.resize(m_alt_directions.size());
+    
+    for(unsigned int i=0; i<m_alt_directions.size(); ++i)
+    {
+        alt_dirs[i] = m_alt_directions[i][alt_index];
+    }
+}
+
+void SparseMultiVectorfield2D::altLocalDirections(unsigned int alt_index, std::vector<PointType>& local_dirs) const
+{
+    std::vector<PointType> alt_dirs;
+    copyAltDirections(alt_index, alt_dirs);
+    
+    local_dirs.resize(m_origins.size());
+    decomposeMotion(globalMotion(), m_origins.data(), alt_dirs.data(), m_origins.size(), NULL, local_dirs.data());
+}
+
 QString SparseMultiVectorfield2D::csvHeader() const
 {
     QString result =  SparseVectorfield2D::csvHeader();
@@ -694,6 +808,9 @@ bool SparseMultiVectorfield2D::deserialize_item(QXmlStreamReader& xmlReader)
 
 void SparseMultiVectorfield2D::updateModel()
 {
+    if(deferUpdate())
+        return;
+    
     for( std::vector<PointType>& vec : m_alt_directions)
     {
         std::vector<PointType> new_vec(alternatives());
@@ -842,6 +959,13 @@ void SparseWeightedMultiVectorfield2D::addVector(const PointType& orig, const st
     addVector(orig, all_dirs.front(),all_weights.front(), alt_dirs, alt_weights);
 }
 
+void SparseWeightedMultiVectorfield2D::reserve(unsigned int count)
+{
+    m_weights.reserve(count);
+    m_alt_weights.reserve(count);
+    SparseMultiVectorfield2D::reserve(count);
+}
+
 void SparseWeightedMultiVectorfield2D::removeVector(unsigned int index)
 {
     if(locked())
@@ -855,6 +979,26 @@ void SparseWeightedMultiVectorfield2D::removeVector(unsigned int index)
     }
 }
 
+const std::vector<float>& SparseWeightedMultiVectorfield2D::weights() const
+{
+    return m_weights;
+}
+
+const std::vector<float>& SparseWeightedMultiVectorfield2D::altWeights(unsigned int index) const
+{
+    return m_alt_weights[index];
+}
+
+void SparseWeightedMultiVectorfield2D::copyAltWeights(unsigned int alt_index, std::vector<float>& alt_weights) const
+{
+    alt_weights.resize(m_alt_weights.size());
+    
+    for(unsigned int i=0; i<m_alt_weights.size(); ++i)
+    {
+        alt_weights[i] = m_alt_weights[i][alt_index];
+    }
+}
+
 QString SparseWeightedMultiVectorfield2D::csvHeader() const
 {
     QString result =  SparseVectorfield2D::csvHeader() + ", weight";
@@ -1019,6 +1163,9 @@ bool SparseWeightedMultiVectorfield2D::deserialize_item(QXmlStreamReader& xmlRea
 
 void SparseWeightedMultiVectorfield2D::updateModel()
 {
+    if(deferUpdate())
+        return;
+    
     for( std::vector<float>& vec : m_alt_weights)
     {
         std::vector<float> new_vec(alternatives());
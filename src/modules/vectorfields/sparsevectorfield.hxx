@@ -144,7 +144,25 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseVectorfield2D
          * \param orig The origin of the new vector.
          * \param dir  The direction of the new vector.
          */
-		void addVector(const PointType& orig, const PointType& dir);
+		virtual void addVector(const PointType& orig, const PointType& dir);
+    
+        /**
+         * Add many vectors to the sparse vectorfield at once. Only one model
+         * update will be performed for all vectors.
+         * Does nothing if the model is locked.
+         *
+         * \param origins The origins of the new vectors.
+         * \param directions  The directions of the new vectors (same size as origins).
+         */
+		void addVectors(const std::vector<PointType>& origins, const std::vector<PointType>& directions);
+    
+        /**
+         * Reserves the storage for a given count of vectors to avoid
+         * reallocations when adding many vectors.
+         *
+         * \param count The count of vectors to reserve storage for.
+         */
+		virtual void reserve(unsigned int count);
 	
         /**
          * Removing a vector from the vector field at a given index
@@ -154,6 +172,54 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseVectorfield2D
          */
         void removeVector(unsigned int index);
     
+        /**
+         * Constant reading access to the contiguous storage of all origins.
+         * Use this access method for the best performance in loops.
+         *
+         * \return A constant reference to the origins of all vectors.
+         */
+        const std::vector<PointType>& origins() const;
+    
+        /**
+         * Constant reading access to the contiguous storage of all directions.
+         * Use this access method for the best performance in loops.
+         *
+         * \return A constant reference to the directions of all vectors.
+         */
+        const std::vector<PointType>& directions() const;
+    
+        /**
+         * Bulk copy of the origins of all vectors of this vectorfield.
+         * Specialized for this class.
+         *
+         * \param origins Will be filled with the origins.
+         */
+        void copyOrigins(std::vector<PointType>& origins) const;
+    
+        /**
+         * Bulk copy of the directions of all vectors of this vectorfield.
+         * Specialized for this class.
+         *
+         * \param directions Will be filled with the directions.
+         */
+        void copyDirections(std::vector<PointType>& directions) const;
+    
+        /**
+         * Batch computation of the global directions of all vectors.
+         * Specialized for this class to work directly on the storage.
+         *
+         * \param global_dirs Will be resized to size() and filled with the global directions.
+         */
+        void globalDirections(std::vector<PointType>& global_dirs) const;
+    
+        /**
+         * Batch computation of the local directions of all vectors.
+         * Specialized for this class to work directly on the storage.
+         *
+         * \param local_dirs Will be resized to size() and filled with the local directions.
+         */
+        void localDirections(std::vector<PointType>& local_dirs) const;
+    
         /**
          * The content's item header for the vectorfield serialization.
          * 
@@ -292,6 +358,30 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseWeightedVectorfield2D : public SparseVect
          * \param w  The weight of the new vector.
          */
 		virtual void addVector(const PointType& orig, const PointType& dir, float w);
+    
+        /**
+         * Add many weighted vectors to the weighted sparse vectorfield at once.
+         * Only one model update will be performed for all vectors.
+         * Does nothing if the model is locked.
+         *
+         * \param origins The origins of the new vectors.
+         * \param directions  The directions of the new vectors (same size as origins).
+         * \param weights  The weights of the new vectors (same size as origins).
+         */
+		void addVectors(const std::vector<PointType>& origins, const std::vector<PointType>& directions, const std::vector<float>& weights);
+    
+        /**
+         * Make the unweighted bulk addition available, too.
+         */
+        using SparseVectorfield2D::addVectors;
+    
+        /**
+         * Reserves the storage for a given count of vectors to avoid
+         * reallocations when adding many vectors.
+         *
+         * \param count The count of vectors to reserve storage for.
+         */
+		void reserve(unsigned int count);
 	
         /**
          * Removing a vector from the vector field at a given index
@@ -301,6 +391,14 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseWeightedVectorfield2D : public SparseVect
          */
         void removeVector(unsigned int index);
     
+        /**
+         * Constant reading access to the contiguous storage of all weights.
+         * Use this access method for the best performance in loops.
+         *
+         * \return A constant reference to the weights of all vectors.
+         */
+        const std::vector<float>& weights() const;
+    
         /**
          * The content's item header for the weighted vectorfield serialization.
          * 
@@ -556,6 +654,14 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseMultiVectorfield2D
          * \param all_dirs The dir + the alternative directions of the new vector.
          */
 		void addVector(const PointType& orig, const std::vector<PointType>& all_dirs);
+    
+        /**
+         * Reserves the storage for a given count of vectors to avoid
+         * reallocations when adding many vectors.
+         *
+         * \param count The count of vectors to reserve storage for.
+         */
+		void reserve(unsigned int count);
 	
         /**
          * Removing a vector from the vector field at a given index
@@ -565,6 +671,35 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseMultiVectorfield2D
          */
         void removeVector(unsigned int index);
     
+        /**
+         * Constant reading access to the contiguous storage of the alternative
+         * directions of one vector.
+         *
+         * \param index The index of the vector.
+         * \return A constant reference to the alternative directions of the vector.
+         */
+        const std::vector<PointType>& altDirections(unsigned int index) const;
+    
+        /**
+         * Bulk copy of the alternative directions at one alternative index
+         * for all vectors of this vectorfield.
+         *
+         * \param alt_index The index of the alternative direction.
+         * \param alt_dirs Will be resized to size() and filled with the alternative directions.
+         */
+        void copyAltDirections(unsigned int alt_index, std::vector<PointType>& alt_dirs) const;
+    
+        /**
+         * Batch computation of the local alternative directions at one alternative
+         * index for all vectors w.r.t. the transformation matrix given in globalMotion().
+         * Note that the global directions do not depend on the alternative index
+         * and may be computed by means of globalDirections().
+         *
+         * \param alt_index The index of the alternative direction.
+         * \param local_dirs Will be resized to size() and filled with the local directions.
+         */
+        void altLocalDirections(unsigned int alt_index, std::vector<PointType>& local_dirs) const;
+    
         /**
          * The content's item header for the multi vectorfield serialization.
          * 
@@ -787,6 +922,14 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseWeightedMultiVectorfield2D
          * \param all_weights The alternative direction weights of the new vector.
          */
 		virtual void addVector(const PointType& orig, const std::vector<PointType>& all_dirs, const std::vector<float>& all_weights);
+    
+        /**
+         * Reserves the storage for a given count of vectors to avoid
+         * reallocations when adding many vectors.
+         *
+         * \param count The count of vectors to reserve storage for.
+         */
+		void reserve(unsigned int count);
 	
         /**
          * Removing a vector from the vector field at a given index
@@ -796,6 +939,32 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseWeightedMultiVectorfield2D
          */
         void removeVector(unsigned int index);
     
+        /**
+         * Constant reading access to the contiguous storage of all weights.
+         * Use this access method for the best performance in loops.
+         *
+         * \return A constant reference to the weights of all vectors.
+         */
+        const std::vector<float>& weights() const;
+    
+        /**
+         * Constant reading access to the contiguous storage of the alternative
+         * weights of one vector.
+         *
+         * \param index The index of the vector.
+         * \return A constant reference to the alternative weights of the vector.
+         */
+        const std::vector<float>& altWeights(unsigned int index) const;
+    
+        /**
+         * Bulk copy of the alternative weights at one alternative index
+         * for all vectors of this vectorfield.
+         *
+         * \param alt_index The index of the alternative weight.
+         * \param alt_weights Will be resized to size() and filled with the alternative weights.
+         */
+        void copyAltWeights(unsigned int alt_index, std::vector<float>& alt_weights) const;
+    
         /**
          * The content's item header for the weighted multi vectorfield serialization.
          * 
@@ -45,6 +45,89 @@ namespace graipe {
  * @}
  */
 
+/**
+ * Accessor of a scalar property of the vectors of a sparse vectorfield
+ * for the parallel computation of the channel statistics.
+ */
+class SparseVectorfieldAccessor
+{
+    public:
+        /** The accessible properties **/
+        enum Property { OriginX, OriginY, DirectionX, DirectionY, Length };
+    
+        /**
+         * Constructor.
+         *
+         * \param vf The sparse vectorfield.
+         * \param property The property of each vector, which shall be accessed.
+         */
+        SparseVectorfieldAccessor(const SparseVectorfield2D* vf, Property property)
+        : m_origins(vf->origins()),
+          m_directions(vf->directions()),
+          m_property(property)
+        {
+        }
+    
+        /**
+         * Access to a vector's property.
+         *
+         * \param index The index of the vector.
+         * \return The property's value.
+         */
+        double operator()(std::size_t index) const
+        {
+            switch(m_property)
+            {
+                case OriginX:       return m_origins[index].x();
+                case OriginY:       return m_origins[index].y();
+                case DirectionX:    return m_directions[index].x();
+                case DirectionY:    return m_directions[index].y();
+                default:            return m_directions[index].length();
+            }
+        }
+    
+    private:
+        /** The origins of the sparse vectorfield **/
+        const std::vector<Vectorfield2D::PointType>& m_origins;
+        /** The directions of the sparse vectorfield **/
+        const std::vector<Vectorfield2D::PointType>& m_directions;
+        /** The accessed property **/
+        Property m_property;
+};
+
+/**
+ * Accessor of the weights of a sparse weighted vectorfield
+ * for the parallel computation of the channel statistics.
+ */
+class SparseWeightAccessor
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * \param vf The sparse weighted vectorfield.
+         */
+        SparseWeightAccessor(const SparseWeightedVectorfield2D* vf)
+        : m_weights(vf->weights())
+        {
+        }
+    
+        /**
+         * Access to a vector's weight.
+         *
+         * \param index The index of the vector.
+         * \return The weight.
+         */
+        double operator()(std::size_t index) const
+        {
+            return m_weights[index];
+        }
+    
+    private:
+        /** The weights of the sparse weighted vectorfield **/
+        const std::vector<float>& m_weights;
+};
+
 SparseVectorfield2DStatistics::SparseVectorfield2DStatistics()
 : m_vf(NULL)
 {
@@ -68,65 +151,19 @@ SparseVectorfield2DStatistics::SparseVectorfield2DStatistics()
 SparseVectorfield2DStatistics::SparseVectorfield2DStatistics(const SparseVectorfield2D* vf)
 : m_vf(vf)
 {
-    float min_val  = vigra::NumericTraits<float>::min();
-    float max_val  = vigra::NumericTraits<float>::max();
-    float zero_val = vigra::NumericTraits<float>::zero();
-    
-    m_origin.min    = PointType(max_val, max_val);
-    m_origin.max    = PointType(min_val, min_val);
-    m_origin.mean    = m_origin.stddev    = PointType(zero_val, zero_val);
-    
-    m_direction.min    = PointType(max_val, max_val);
-    m_direction.max    = PointType(min_val, min_val);
-    m_direction.mean    = m_direction.stddev    = PointType(zero_val, zero_val);
-    
-    m_length.min    = max_val;
-    m_length.max    = min_val;
-    m_length.mean    = m_length.stddev    = zero_val;
-    
-    for (unsigned int i=0; i<vf->size(); ++i)
-    {
-        const PointType& o = vf->origin(i);
-        m_origin.min = std::min(m_origin.min, o);
-        m_origin.max = std::max(m_origin.max, o);
-        m_origin.mean +=  o;
-        
-        const PointType& d = vf->direction(i);
-        m_direction.min = std::min(m_direction.min, d);
-        m_direction.max = std::max(m_direction.max, d);
-        m_direction.mean +=  d;
-        
-        double len=vf->length(i);
-        m_length.min = std::min(len, m_length.min);
-        m_length.max = std::max(len, m_length.max);
-        m_length.mean +=  len;
-    }
-    
-    m_origin.mean /= vf->size();
-    m_direction.mean /= vf->size();
-    m_length.mean /= vf->size();
-    
-    for (unsigned int i=0; i< vf->size(); ++i)
-    {
-        PointType o=(m_origin.mean - vf->origin(i));
-        m_origin.stddev += PointType(o.x()*o.x(), o.y()*o.y());
-        
-        PointType d=(m_direction.mean - vf->direction(i));
-        m_direction.stddev += PointType(d.x()*d.x(), d.y()*d.y());
-        
-        float len=vf->length(i);
-        m_length.stddev += vigra::pow(m_length.mean - len, 2.0);
-    }
-    
-    m_origin.stddev = m_origin.stddev/vf->size();
-    m_origin.stddev.setX(sqrt(m_origin.stddev.x()));
-    m_origin.stddev.setY(sqrt(m_origin.stddev.y()));
-    
-    m_direction.stddev = m_direction.stddev/vf->size();
-    m_direction.stddev.setX(sqrt(m_direction.stddev.x()));
-    m_direction.stddev.setY(sqrt(m_direction.stddev.y()));
-    
-    m_length.stddev = sqrt(m_length.stddev/vf->size());
+    typedef SparseVectorfieldAccessor Accessor;
+    
+    //Origin, direction and length statistics (cached at the vectorfield)
+    ModelStatistics& cache = vf->statistics();
+    std::size_t size = vf->size();
+    
+    m_origin    = combineStatistics<PointType>(cache.channel("origin_x",    Accessor(vf, Accessor::OriginX),    size).stats,
+                                               cache.channel("origin_y",    Accessor(vf, Accessor::OriginY),    size).stats);
+    m_direction = combineStatistics<PointType>(cache.channel("direction_x", Accessor(vf, Accessor::DirectionX), size).stats,
+                                               cache.channel("direction_y", Accessor(vf, Accessor::DirectionY), size).stats);
+    ChannelStatistics length = cache.channel("length", Accessor(vf, Accessor::Length), size);
+    m_length = length.stats;
+    m_length_histogram = length.histogram;
 }
 
 const BasicStatistics<Vectorfield2D::PointType>& SparseVectorfield2DStatistics::originStats() const
@@ -144,6 +181,11 @@ const BasicStatistics<double>& SparseVectorfield2DStatistics::lengthStats() cons
 	return m_length;
 }
 
+const BasicHistogram& SparseVectorfield2DStatistics::lengthHistogram() const
+{
+	return m_length_histogram;
+}
+
 
 
 
@@ -152,7 +194,8 @@ const BasicStatistics<double>& SparseVectorfield2DStatistics::lengthStats() cons
 
 
 SparseWeightedVectorfield2DStatistics::SparseWeightedVectorfield2DStatistics()
-: SparseVectorfield2DStatistics()
+: SparseVectorfield2DStatistics(),
+  m_vf(NULL)
 {
     float min_val  = vigra::NumericTraits<float>::min();
     float max_val  = vigra::NumericTraits<float>::max();
@@ -165,33 +208,12 @@ SparseWeightedVectorfield2DStatistics::SparseWeightedVectorfield2DStatistics()
     
 
 SparseWeightedVectorfield2DStatistics::SparseWeightedVectorfield2DStatistics(const SparseWeightedVectorfield2D* vf)
-: SparseVectorfield2DStatistics(vf)
+: SparseVectorfield2DStatistics(vf),
+  m_vf(vf)
 {
-    float min_val  = vigra::NumericTraits<float>::min();
-    float max_val  = vigra::NumericTraits<float>::max();
-    float zero_val = vigra::NumericTraits<float>::zero();
-    
-    m_weight.min    = max_val;
-    m_weight.max    = min_val;
-    m_weight.mean   = m_weight.stddev    =  zero_val;
-    
-    for (unsigned int i=0; i<vf->size(); ++i)
-    {
-        double w = vf->weight(i);
-        
-        m_weight.min = std::min(w, m_weight.min);
-        m_weight.max = std::max(w, m_weight.max);
-        
-        m_weight.mean += w;
-    }
-    
-    m_weight.mean /= vf->size();
-    
-    for (unsigned int i=0; i<vf->size(); ++i)
-    {
-        m_weight.stddev += pow(m_weight.mean - vf->weight(i),2.0f);
-    }
-    m_weight.stddev = sqrt(m_weight.stddev/vf->size());
+    ChannelStatistics weight = vf->statistics().channel("weight", SparseWeightAccessor(vf), vf->size());
+    m_weight = weight.stats;
+    m_weight_histogram = weight.histogram;
 }
 
 const BasicStatistics<double>& SparseWeightedVectorfield2DStatistics::weightStats() const
@@ -199,6 +221,11 @@ const BasicStatistics<double>& SparseWeightedVectorfield2DStatistics::weightStat
 	return m_weight;
 }
 
+const BasicHistogram& SparseWeightedVectorfield2DStatistics::weightHistogram() const
+{
+	return m_weight_histogram;
+}
+
 
 
 
@@ -242,21 +269,24 @@ SparseMultiVectorfield2DStatistics::SparseMultiVectorfield2DStatistics(const Spa
         m_alt_lengths[alt_i].mean   = m_alt_lengths[alt_i].stddev    = zero_val;
     }
     
+    const std::vector<PointType>& directions = vf->directions();
+    
     for (unsigned int i=0; i<vf->size(); ++i)
     {
-        const PointType& d = vf->direction(i);
+        const PointType& d = directions[i];
+        const std::vector<PointType>& alt_dirs = vf->altDirections(i);
         m_combined_direction.min = std::min(m_combined_direction.min, d);
         m_combined_direction.max = std::max(m_combined_direction.max, d);
         m_combined_direction.mean +=  d;
         
-        double len=vf->length(i);
+        double len=d.length();
         m_combined_length.min = std::min(len, m_combined_length.min);
         m_combined_length.max = std::max(len, m_combined_length.max);
         m_combined_length.mean +=  len;
         
         for(unsigned int alt_i=0; alt_i<vf->alternatives(); ++alt_i)
         {
-            const PointType& alt_d = vf->altDirection(i,alt_i);
+            const PointType& alt_d = alt_dirs[alt_i];
             m_alt_directions[alt_i].min = std::min(m_alt_directions[alt_i].min, alt_d);
             m_alt_directions[alt_i].max = std::max(m_alt_directions[alt_i].max, alt_d);
             m_alt_directions[alt_i].mean +=  alt_d;
@@ -265,7 +295,7 @@ SparseMultiVectorfield2DStatistics::SparseMultiVectorfield2DStatistics(const Spa
             m_combined_direction.max = std::max(m_combined_direction.max, alt_d);
             m_combined_direction.mean += alt_d;
             
-            double alt_len=vf->altLength(i, alt_i);
+            double alt_len=alt_d.length();
             m_alt_lengths[alt_i].min = std::min(m_alt_lengths[alt_i].min, alt_len);
             m_alt_lengths[alt_i].max = std::max(m_alt_lengths[alt_i].max, alt_len);
             m_alt_lengths[alt_i].mean +=  alt_len;
@@ -287,19 +317,24 @@ SparseMultiVectorfield2DStatistics::SparseMultiVectorfield2DStatistics(const Spa
     
     for (unsigned int i=0; i<vf->size(); ++i)
     {
-        PointType d=(m_combined_direction.mean - vf->direction(i));
+        const std::vector<PointType>& alt_dirs = vf->altDirections(i);
+        
+        PointType d=(m_combined_direction.mean - directions[i]);
         m_combined_direction.stddev += PointType(d.x()*d.x(), d.y()*d.y());
-        m_combined_length.stddev +=  pow(m_combined_length.mean - vf->length(i), 2.0f);
+        m_combined_length.stddev +=  pow(m_combined_length.mean - directions[i].length(), 2.0f);
         
         for(unsigned int alt_i=0; alt_i<vf->alternatives(); ++alt_i)
         {
-            PointType d=(m_alt_directions[alt_i].mean - vf->altDirection(i,alt_i));
+            const PointType& alt_d = alt_dirs[alt_i];
+            double alt_len = alt_d.length();
+            
+            PointType d=(m_alt_directions[alt_i].mean - alt_d);
             m_alt_directions[alt_i].stddev += PointType(d.x()*d.x(), d.y()*d.y());
-            m_alt_lengths[alt_i].stddev += pow(m_alt_lengths[alt_i].mean - vf->altLength(i, alt_i), 2.0f);
+            m_alt_lengths[alt_i].stddev += pow(m_alt_lengths[alt_i].mean - alt_len, 2.0f);
             
-            PointType c_d=(m_combined_direction.mean - vf->altDirection(i, alt_i));
+            PointType c_d=(m_combined_direction.mean - alt_d);
             m_combined_direction.stddev += PointType(c_d.x()*c_d.x(), c_d.y()*c_d.y());
-            m_combined_length.stddev += pow(m_combined_length.mean - vf->altLength(i, alt_i), 2.0f);
+            m_combined_length.stddev += pow(m_combined_length.mean - alt_len, 2.0f);
         }
     }
     
@@ -372,9 +407,12 @@ SparseWeightedMultiVectorfield2DStatistics::SparseWeightedMultiVectorfield2DStat
         m_alt_weights[alt_i].max    = min_val;
         m_alt_weights[alt_i].mean   = m_alt_weights[alt_i].stddev    = zero_val;
     }
+    const std::vector<float>& weights = vf->weights();
+    
     for (unsigned int i=0; i<vf->size(); ++i)
     {
-        double w = vf->weight(i);
+        double w = weights[i];
+        const std::vector<float>& alt_weights = vf->altWeights(i);
     
         m_weight.min  =  std::min(m_weight.min, w);
         m_weight.max  =  std::max(m_weight.max, w);
@@ -387,7 +425,7 @@ SparseWeightedMultiVectorfield2DStatistics::SparseWeightedMultiVectorfield2DStat
     
         for(unsigned int alt_i=0; alt_i<vf->alternatives(); ++alt_i)
         {
-            double alt_w = vf->altWeight(i,alt_i);
+            double alt_w = alt_weights[alt_i];
             m_alt_weights[alt_i].min = std::min(m_alt_weights[alt_i].min, alt_w);
             m_alt_weights[alt_i].max = std::max(m_alt_weights[alt_i].max, alt_w);
             m_alt_weights[alt_i].mean +=  alt_w;
@@ -408,12 +446,14 @@ SparseWeightedMultiVectorfield2DStatistics::SparseWeightedMultiVectorfield2DStat
     
     for (unsigned int i=0; i<vf->size(); ++i)
     {
-        m_weight.stddev += pow(m_weight.mean - vf->weight(i),2.0f);
-        m_combined_weight.stddev += pow(m_combined_weight.mean - vf->weight(i),2.0f);
+        const std::vector<float>& alt_weights = vf->altWeights(i);
+        
+        m_weight.stddev += pow(m_weight.mean - weights[i],2.0f);
+        m_combined_weight.stddev += pow(m_combined_weight.mean - weights[i],2.0f);
 
         for(unsigned int alt_i=0; alt_i<vf->alternatives(); ++alt_i)
         {
-            double alt_w = vf->altWeight(i,alt_i);
+            double alt_w = alt_weights[alt_i];
             m_alt_weights[alt_i].stddev += pow(m_alt_weights[alt_i].mean - alt_w, 2.0f);
             m_combined_weight.stddev += pow(m_combined_weight.mean - alt_w, 2.0f);
         }
@@ -99,6 +99,13 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseVectorfield2DStatistics
          */
         const BasicStatistics<double>& lengthStats() const;
     
+        /**
+         * Returns the histogram of the lengths of this vectorfield.
+         *
+         * \return Histogram of the lengths of this vectorfield.
+         */
+        const BasicHistogram& lengthHistogram() const;
+    
     protected:
         /** Pointer to the vectorfield **/
         const SparseVectorfield2D* m_vf;
@@ -109,6 +116,8 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseVectorfield2DStatistics
          */
         BasicStatistics<PointType> m_origin, m_direction;
         BasicStatistics<double> m_length;
+        /** Histogram of the vector lengths **/
+        BasicHistogram m_length_histogram;
         /** 
          * @}
          */
@@ -145,6 +154,13 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseWeightedVectorfield2DStatistics
          */
         const BasicStatistics<double>& weightStats() const;
     
+        /**
+         * Returns the histogram of the weights of this vectorfield.
+         *
+         * \return Histogram of the weights of this vectorfield.
+         */
+        const BasicHistogram& weightHistogram() const;
+    
     
     protected:
         /** Pointer to the vectorfield **/
@@ -152,6 +168,8 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseWeightedVectorfield2DStatistics
     
         /** Statistics storage **/
         BasicStatistics<double> m_weight;
+        /** Histogram of the vectors' weights **/
+        BasicHistogram m_weight_histogram;
 };
 
     
@@ -64,7 +64,8 @@ SparseVectorfield2DViewController::SparseVectorfield2DViewController(SparseVecto
     m_velocityLegendTicks(new IntParameter("Legend ticks", 0, 1000, 10, m_showVelocityLegend)),
     m_velocityLegendDigits(new IntParameter("Legend digits", 0, 10, 2, m_showVelocityLegend)),
     m_mode(NULL),
-    m_velocity_legend(NULL)
+    m_velocity_legend(NULL),
+    m_spatial_index_dirty(true)
 {
     QStringList displayMotionModes;
 		displayMotionModes.append("Complete motion");
@@ -128,6 +129,9 @@ SparseVectorfield2DViewController::SparseVectorfield2DViewController(SparseVecto
     m_velocity_legend->setTicks(m_velocityLegendTicks->value());
     m_velocity_legend->setDigits(m_velocityLegendDigits->value());
 	m_velocity_legend->setZValue(zValue());
+    
+    //Keep the painted vectors as a pixmap until the view or model changes
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 	
 	updateView();
 }
@@ -151,48 +155,54 @@ void SparseVectorfield2DViewController::paint(QPainter *painter, const QStyleOpt
         painter->save();
         
         QPointFX origin, direction, target;
-        QColor current_color;
         
-        for(unsigned int i=0; i<vf->size(); ++i)
+        const std::vector<QPointFX>& origins = vf->origins();
+        
+        QRectF exposed = exposedRect(option);
+        qreal lod = levelOfDetail(painter);
+        
+        //Rebuild the cached arrow glyphs only if the view has changed or another region is exposed
+        if(!m_vector_drawer.isBatchValid(exposed, lod))
         {
-            float current_length = vf->length(i);
+            m_vector_drawer.beginBatch(exposed, lod);
+            
+            //Only paint the vectors inside the exposed rectangle, at most one per device pixel
+            std::vector<unsigned int> visible;
+            visibleVectors(option, visible);
             
-            if(current_length!=0 && (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()))
+            ScreenSpaceAggregator aggregator(exposed, lod > 0 ? 1.0/lod : 0.0);
+            
+            for(unsigned int i : visible)
             {
-                origin = vf->origin(i);
-                
-                switch( m_displayMotionMode->value() )
+                float current_length = m_lengths[i];
+            
+                if(current_length!=0 && (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()))
                 {
-                    case GlobalMotion:
-                        direction = vf->globalDirection(i);
-                        break;
-                        
-                    case LocalMotion:
-                        direction = vf->localDirection(i);
-                        break;
-                        
-                    case CompleteMotion:
-                    default:
-                        direction = vf->direction(i);
-                        break;
-                }
+                    origin = origins[i];
                 
-                float len = direction.length();
+                    if(!aggregator.accept(origin))
+                        continue;
                 
-                if(len!=0)
-                {
-                    if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                    direction = m_displayed_directions[i];
+                
+                    float len = direction.length();
+                
+                    if(len!=0)
                     {
-                        direction=direction/len*m_normalizedLength->value();
-                    }
+                        if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                        {
+                            direction=direction/len*m_normalizedLength->value();
+                        }
                     
-                    target = origin + direction;
+                        target = origin + direction;
                     
-                    float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
-                    m_vector_drawer.paint(painter, origin, target,normalized_weight);
+                        float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
+                        m_vector_drawer.addToBatch(origin, target, normalized_weight);
+                    }
                 }
             }
         }
+        m_vector_drawer.paintBatch(painter);
         
         painter->restore();
     }
@@ -200,6 +210,72 @@ void SparseVectorfield2DViewController::paint(QPainter *painter, const QStyleOpt
 	ViewController::paintAfter(painter, option, widget);
 }
 
+void SparseVectorfield2DViewController::computeDirections(std::vector<QPointFX>& directions, std::vector<QPointFX>& displayed_directions) const
+{
+    const SparseVectorfield2D * vf = static_cast<const SparseVectorfield2D *>(m_model);
+    
+    directions = vf->directions();
+    
+    switch( m_displayMotionMode->value() )
+    {
+        case GlobalMotion:
+            vf->globalDirections(displayed_directions);
+            break;
+            
+        case LocalMotion:
+            vf->localDirections(displayed_directions);
+            break;
+            
+        case CompleteMotion:
+        default:
+            displayed_directions = directions;
+            break;
+    }
+}
+
+void SparseVectorfield2DViewController::updateSpatialIndex()
+{
+    if(!m_spatial_index_dirty)
+        return;
+    
+    SparseVectorfield2D * vf = static_cast<SparseVectorfield2D *>(model());
+    
+    std::vector<QPointFX> directions;
+    computeDirections(directions, m_displayed_directions);
+    
+    const std::vector<QPointFX>& origins = vf->origins();
+    
+    m_lengths.resize(directions.size());
+    std::vector<QRectF> bounds(origins.size());
+    
+    for(unsigned int i=0; i<origins.size(); ++i)
+    {
+        m_lengths[i] = directions[i].length();
+        
+        QPointFX direction = m_displayed_directions[i];
+        float len = direction.length();
+        
+        if(len!=0 && m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+        {
+            direction=direction/len*m_normalizedLength->value();
+        }
+        bounds[i] = QRectF(origins[i], origins[i] + direction);
+    }
+    
+    m_spatial_index.build(bounds);
+    m_spatial_index_dirty = false;
+}
+
+void SparseVectorfield2DViewController::visibleVectors(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible)
+{
+    updateSpatialIndex();
+    
+    //The arrow heads and lines may exceed the bounds of the vectors
+    qreal margin = m_lineWidth->value() + m_headSize->value();
+    
+    m_spatial_index.query(exposedRect(option).adjusted(-margin, -margin, margin, margin), visible);
+}
+
 QRectF SparseVectorfield2DViewController::boundingRect () const
 {
     qreal maxLength = m_stats->lengthStats().max;
@@ -249,9 +325,12 @@ void SparseVectorfield2DViewController::updateView()
 {
 	ViewController::updateView();
     
+    m_spatial_index_dirty = true;
+    
     m_vector_drawer.setLineWidth(m_lineWidth->value());
     m_vector_drawer.setHeadSize(m_headSize->value());
     m_vector_drawer.setColorTable(m_colorTable->value());
+    m_vector_drawer.invalidateBatch();
     
 	SparseVectorfield2D * vf = static_cast<SparseVectorfield2D*> (model());
     
@@ -490,53 +569,61 @@ void SparseWeightedVectorfield2DViewController::paint(QPainter *painter, const Q
         
         QPointFX origin, direction, target;
         
-        for(unsigned int i=0; i<vf->size(); ++i)
+        const std::vector<QPointFX>& origins = vf->origins();
+        const std::vector<float>& weights = vf->weights();
+        
+        QRectF exposed = exposedRect(option);
+        qreal lod = levelOfDetail(painter);
+        
+        //Rebuild the cached arrow glyphs only if the view has changed or another region is exposed
+        if(!m_vector_drawer.isBatchValid(exposed, lod))
         {
-            float current_weight = vf->weight(i);
-            float current_length = vf->length(i);
+            m_vector_drawer.beginBatch(exposed, lod);
+            
+            //Only paint the vectors inside the exposed rectangle, at most one per device pixel
+            std::vector<unsigned int> visible;
+            visibleVectors(option, visible);
+            
+            ScreenSpaceAggregator aggregator(exposed, lod > 0 ? 1.0/lod : 0.0);
             
-            if(current_length!=0	&& (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()) 
-                                    && (current_weight>= m_minWeight->value()) && (current_weight <= m_maxWeight->value()))
+            for(unsigned int i : visible)
             {
-                origin = vf->origin(i);
-                
-                switch( m_displayMotionMode->value() )
+                float current_weight = weights[i];
+                float current_length = m_lengths[i];
+            
+                if(current_length!=0	&& (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()) 
+                                        && (current_weight>= m_minWeight->value()) && (current_weight <= m_maxWeight->value()))
                 {
-                    case GlobalMotion:
-                        direction = vf->globalDirection(i);
-                        break;
-                        
-                    case LocalMotion:
-                        direction = vf->localDirection(i);
-                        break;
-                        
-                    case CompleteMotion:
-                    default:
-                        direction = vf->direction(i);
-                        break;
-                }
+                    origin = origins[i];
                 
-                float len = direction.length();
+                    if(!aggregator.accept(origin))
+                        continue;
                 
-                if(len!=0)
-                {
-                    if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                    direction = m_displayed_directions[i];
+                
+                    float len = direction.length();
+                
+                    if(len!=0)
                     {
-                        direction=direction/len*m_normalizedLength->value();
-                    }
+                        if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                        {
+                            direction=direction/len*m_normalizedLength->value();
+                        }
                     
-                    target = origin + direction;
+                        target = origin + direction;
                     
-                    float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
+                        float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
                 
-                    if(m_useColorForWeight->value())
-                    {
-                        normalized_weight = std::min(1.0f,std::max(0.0f,(current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
+                        if(m_useColorForWeight->value())
+                        {
+                            normalized_weight = std::min(1.0f,std::max(0.0f,(current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
+                        }
+                        m_vector_drawer.addToBatch(origin, target, normalized_weight);
                     }
-                    m_vector_drawer.paint(painter, origin, target, normalized_weight);
                 }
             }
         }
+        m_vector_drawer.paintBatch(painter);
         
         painter->restore();
     }
@@ -795,49 +882,54 @@ void SparseMultiVectorfield2DViewController::paint(QPainter *painter, const QSty
 
         QPointFX origin, direction, target;
         
-        unsigned int alt = m_showAlternative->value();
+        const std::vector<QPointFX>& origins = vf->origins();
         
-        for(unsigned int i=0; i<vf->size(); ++i)
-        {		
-            float current_length = alt>0 ? vf->altLength(i,alt-1) : vf->length(i);
+        QRectF exposed = exposedRect(option);
+        qreal lod = levelOfDetail(painter);
+        
+        //Rebuild the cached arrow glyphs only if the view has changed or another region is exposed
+        if(!m_vector_drawer.isBatchValid(exposed, lod))
+        {
+            m_vector_drawer.beginBatch(exposed, lod);
             
-            if(current_length!=0)
-            {
-                origin = vf->origin(i);
-                
-                switch( m_displayMotionMode->value() )
+            //Only paint the vectors inside the exposed rectangle, at most one per device pixel
+            std::vector<unsigned int> visible;
+            visibleVectors(option, visible);
+            
+            ScreenSpaceAggregator aggregator(exposed, lod > 0 ? 1.0/lod : 0.0);
+            
+            for(unsigned int i : visible)
+            {		
+                float current_length = m_lengths[i];
+            
+                if(current_length!=0)
                 {
-                    case GlobalMotion:
-                        direction = alt>0 ? vf->altGlobalDirection(i, alt-1) : vf->globalDirection(i);
-                        break;
-                        
-                    case LocalMotion:
-                        direction = alt>0 ? vf->altLocalDirection(i, alt-1) : vf->localDirection(i);
-                        break;
-                        
-                    case CompleteMotion:
-                    default:
-                        direction = alt>0 ? vf->altDirection(i, alt-1) : vf->direction(i);
-                        break;
-                }
+                    origin = origins[i];
                 
-                float len = direction.length();
+                    if(!aggregator.accept(origin))
+                        continue;
                 
-                if(len!=0)
-                {
-                    if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                    direction = m_displayed_directions[i];
+                
+                    float len = direction.length();
+                
+                    if(len!=0)
                     {
-                        direction=direction/len*m_normalizedLength->value();
-                    }
+                        if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                        {
+                            direction=direction/len*m_normalizedLength->value();
+                        }
                     
-                    target = origin + direction;
+                        target = origin + direction;
                     
-                    float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
+                        float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
                 
-                    m_vector_drawer.paint(painter, origin, target, normalized_weight);
+                        m_vector_drawer.addToBatch(origin, target, normalized_weight);
+                    }
                 }
             }
         }
+        m_vector_drawer.paintBatch(painter);
 
         painter->restore();
     }
@@ -845,6 +937,45 @@ void SparseMultiVectorfield2DViewController::paint(QPainter *painter, const QSty
 	ViewController::paintAfter(painter, option, widget);
 }
 
+void SparseMultiVectorfield2DViewController::computeDirections(std::vector<QPointFX>& directions, std::vector<QPointFX>& displayed_directions) const
+{
+    const SparseMultiVectorfield2D * vf = static_cast<const SparseMultiVectorfield2D *>(m_model);
+    
+    unsigned int alt = m_showAlternative->value();
+    
+    if(alt>0)
+    {
+        vf->copyAltDirections(alt-1, directions);
+    }
+    else
+    {
+        directions = vf->directions();
+    }
+    
+    switch( m_displayMotionMode->value() )
+    {
+        case GlobalMotion:
+            vf->globalDirections(displayed_directions);
+            break;
+            
+        case LocalMotion:
+            if(alt>0)
+            {
+                vf->altLocalDirections(alt-1, displayed_directions);
+            }
+            else
+            {
+                vf->localDirections(displayed_directions);
+            }
+            break;
+            
+        case CompleteMotion:
+        default:
+            displayed_directions = directions;
+            break;
+    }
+}
+
 void SparseMultiVectorfield2DViewController::updateParameters(bool force_update)
 {
     ViewController::updateParameters(force_update);
@@ -876,9 +1007,12 @@ void SparseMultiVectorfield2DViewController::updateView()
 {
 	ViewController::updateView();
     
+    m_spatial_index_dirty = true;
+    
     m_vector_drawer.setLineWidth(m_lineWidth->value());
     m_vector_drawer.setHeadSize(m_headSize->value());
     m_vector_drawer.setColorTable(m_colorTable->value());
+    m_vector_drawer.invalidateBatch();
     
 	SparseVectorfield2D * vf = static_cast<SparseVectorfield2D*> (model());
     
@@ -1112,53 +1246,61 @@ void SparseWeightedMultiVectorfield2DViewController::paint(QPainter *painter, co
         
         unsigned int alt = m_showAlternative->value();
         
-        for(unsigned int i=0; i<vf->size(); ++i)
+        const std::vector<QPointFX>& origins = vf->origins();
+        const std::vector<float>& weights = vf->weights();
+        
+        QRectF exposed = exposedRect(option);
+        qreal lod = levelOfDetail(painter);
+        
+        //Rebuild the cached arrow glyphs only if the view has changed or another region is exposed
+        if(!m_vector_drawer.isBatchValid(exposed, lod))
         {
-            float current_weight = alt>0 ? vf->altWeight(i,alt-1) : vf->weight(i);
-            float current_length = alt>0 ? vf->altLength(i,alt-1) : vf->length(i);
+            m_vector_drawer.beginBatch(exposed, lod);
+            
+            //Only paint the vectors inside the exposed rectangle, at most one per device pixel
+            std::vector<unsigned int> visible;
+            visibleVectors(option, visible);
             
-            if(current_length!=0	&& (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()) 
-                                    && (current_weight>= m_minWeight->value()) && (current_weight <= m_maxWeight->value()))
+            ScreenSpaceAggregator aggregator(exposed, lod > 0 ? 1.0/lod : 0.0);
+            
+            for(unsigned int i : visible)
             {
-                origin = vf->origin(i);
-                
-                switch( m_displayMotionMode->value() )
+                float current_weight = alt>0 ? vf->altWeights(i)[alt-1] : weights[i];
+                float current_length = m_lengths[i];
+            
+                if(current_length!=0	&& (current_length>= m_minLength->value()) && (current_length <= m_maxLength->value()) 
+                                        && (current_weight>= m_minWeight->value()) && (current_weight <= m_maxWeight->value()))
                 {
-                    case GlobalMotion:
-                        direction = alt>0 ? vf->altGlobalDirection(i, alt-1) : vf->globalDirection(i);
-                        break;
-                        
-                    case LocalMotion:
-                        direction = alt>0 ? vf->altLocalDirection(i, alt-1) : vf->localDirection(i);
-                        break;
-                        
-                    case CompleteMotion:
-                    default:
-                        direction = alt>0 ? vf->altDirection(i, alt-1) : vf->direction(i);
-                        break;
-                }
-                float len = direction.length();
+                    origin = origins[i];
                 
-                if(len!=0)
-                {
-                    if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                    if(!aggregator.accept(origin))
+                        continue;
+                
+                    direction = m_displayed_directions[i];
+                    float len = direction.length();
+                
+                    if(len!=0)
                     {
-                        direction=direction/len*m_normalizedLength->value();
-                    }
+                        if(m_normalizeLength->value() && m_normalizedLength->value()!= 0)
+                        {
+                            direction=direction/len*m_normalizedLength->value();
+                        }
                     
-                    target = origin + direction;
+                        target = origin + direction;
                     
-                    float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
+                        float normalized_weight = std::min(1.0f,std::max(0.0f,(current_length - m_minLength->value())/(m_maxLength->value() - m_minLength->value())));
                     
-                    if(m_useColorForWeight->value())
-                    {
-                       normalized_weight = std::min(1.0f,std::max(0.0f,(current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
-                    }
+                        if(m_useColorForWeight->value())
+                        {
+                           normalized_weight = std::min(1.0f,std::max(0.0f,(current_weight - m_minWeight->value())/(m_maxWeight->value() - m_minWeight->value())));
+                        }
                     
-                    m_vector_drawer.paint(painter, origin, target, normalized_weight);
+                        m_vector_drawer.addToBatch(origin, target, normalized_weight);
+                    }
                 }
             }
         }
+        m_vector_drawer.paintBatch(painter);
         painter->restore();
     }
     
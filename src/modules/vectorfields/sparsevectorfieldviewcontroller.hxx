@@ -131,6 +131,33 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseVectorfield2DViewController
          */
         void mousePressEvent (QGraphicsSceneMouseEvent * event);
     
+        /**
+         * Computes the directions of all vectors, which are shown by this view.
+         * Specialized for the alternative directions of multi vectorfields.
+         *
+         * \param directions Will be filled with the complete directions, which are
+         *                   used for the length filtering and coloring.
+         * \param displayed_directions Will be filled with the displayed directions
+         *                   w.r.t. the current motion display mode.
+         */
+        virtual void computeDirections(std::vector<QPointFX>& directions, std::vector<QPointFX>& displayed_directions) const;
+    
+        /**
+         * Rebuilds the cached lengths, displayed directions and the spatial index
+         * of all vectors, if the model or the parameters have changed since the
+         * last call.
+         */
+        void updateSpatialIndex();
+    
+        /**
+         * Finds all vectors, which need to be painted for the current paint call.
+         *
+         * \param option The style options of the current paint call.
+         * \param visible Will be filled with the indices of all vectors, which intersect
+         *                the exposed rectangle.
+         */
+        void visibleVectors(const QStyleOptionGraphicsItem * option, std::vector<unsigned int>& visible);
+    
 		/** Statistics **/
 		SparseVectorfield2DStatistics * m_stats;
     
@@ -160,6 +187,15 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseVectorfield2DViewController
     
         /** Drawing vectors **/
         VectorDrawer m_vector_drawer;
+    
+        /** Cached lengths of the (complete) directions of all vectors **/
+        std::vector<float> m_lengths;
+        /** Cached displayed directions of all vectors **/
+        std::vector<QPointFX> m_displayed_directions;
+        /** Spatial index of all displayed vectors **/
+        SpatialIndex2D m_spatial_index;
+        /** Needs the spatial index to be rebuilt? **/
+        bool m_spatial_index_dirty;
 };
 
 
@@ -331,6 +367,17 @@ class GRAIPE_VECTORFIELDS_EXPORT SparseMultiVectorfield2DViewController
          */
         void mousePressEvent (QGraphicsSceneMouseEvent * event);
     
+        /**
+         * Computes the directions of all vectors, which are shown by this view.
+         * Specialized to show the selected alternative directions.
+         *
+         * \param directions Will be filled with the complete directions, which are
+         *                   used for the length filtering and coloring.
+         * \param displayed_directions Will be filled with the displayed directions
+         *                   w.r.t. the current motion display mode.
+         */
+        void computeDirections(std::vector<QPointFX>& directions, std::vector<QPointFX>& displayed_directions) const;
+    
 		/** Statistics **/
 		SparseMultiVectorfield2DStatistics * m_stats;
     
@@ -35,6 +35,8 @@
 
 #include "vectorfields/vectordrawer.hxx"
 
+#include <algorithm>
+
 namespace graipe {
 
 /**
@@ -46,7 +48,10 @@ namespace graipe {
  */
 
 VectorDrawer::VectorDrawer(float line_width, float head_size, QVector<QRgb> colorTable)
-: m_arrow_brush(colorTable[0])
+: m_arrow_brush(colorTable[0]),
+  m_groups(256),
+  m_batch_valid(false),
+  m_batch_lod(0)
 {
     setLineWidth(line_width);
     setHeadSize(head_size);
@@ -67,6 +72,9 @@ void VectorDrawer::setHeadSize(float new_head_size)
 {
     m_head_size = new_head_size;
     updateHeadTriangle();
+    
+    //The batched arrow heads depend on the head size
+    invalidateBatch();
 }
 
 float VectorDrawer::headSize() const
@@ -113,6 +121,90 @@ void VectorDrawer::paint(QPainter * painter, const QPointFX& origin, const QPoin
     painter->drawConvexPolygon(t.map(m_triangle));
 }
 
+void VectorDrawer::beginBatch(const QRectF& region, qreal lod)
+{
+    for(GlyphGroup& group : m_groups)
+    {
+        group.lines.resize(0);
+        group.heads = QPainterPath();
+        //Overlapping heads shall not cancel out each other
+        group.heads.setFillRule(Qt::WindingFill);
+    }
+    
+    m_batch_region = region;
+    m_batch_lod    = lod;
+    m_batch_valid  = true;
+}
+
+void VectorDrawer::addToBatch(const QPointFX& origin, const QPointFX& target, float normalized_weight)
+{
+    QPointFX direction = target-origin;
+    
+    float len = direction.length();
+    
+    if(len == 0)
+        return;
+    
+    GlyphGroup& group = m_groups[std::min(255, std::max(0, int(normalized_weight*255)))];
+    
+    //Unit direction and its normal, which correspond to the rotation of the head triangle
+    QPointF d = direction/len,
+            n(-d.y(), d.x());
+    
+    float line_length = len - 2*m_head_size;
+    
+    if(line_length > 0)
+    {
+        group.lines.append(QLineF(origin, origin + d*line_length));
+    }
+    
+    QPointF base = target - d*(2*m_head_size);
+    
+    group.heads.moveTo(target);
+    group.heads.lineTo(base - n*(m_head_size*0.6));
+    group.heads.lineTo(base + n*(m_head_size*0.6));
+    group.heads.closeSubpath();
+}
+
+void VectorDrawer::paintBatch(QPainter * painter) const
+{
+    QPen line_pen(m_line_pen);
+    
+    for(unsigned int c=0; c<m_groups.size(); ++c)
+    {
+        const GlyphGroup& group = m_groups[c];
+        
+        if(group.lines.isEmpty() && group.heads.isEmpty())
+            continue;
+        
+        QColor current_color = QColor(m_colorTable[c]);
+        
+        if(!group.lines.isEmpty())
+        {
+            line_pen.setColor(current_color);
+            painter->setPen(line_pen);
+            painter->setBrush(QBrush());
+            painter->drawLines(group.lines);
+        }
+        if(!group.heads.isEmpty())
+        {
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(current_color);
+            painter->drawPath(group.heads);
+        }
+    }
+}
+
+void VectorDrawer::invalidateBatch()
+{
+    m_batch_valid = false;
+}
+
+bool VectorDrawer::isBatchValid(const QRectF& region, qreal lod) const
+{
+    return m_batch_valid && m_batch_region == region && m_batch_lod == lod;
+}
+
 void VectorDrawer::updateHeadTriangle()
 {
    QPolygonF new_polygon;
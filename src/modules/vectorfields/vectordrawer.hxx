@@ -42,9 +42,15 @@
 
 #include <QBrush>
 #include <QColor>
+#include <QLineF>
 #include <QPainter>
+#include <QPainterPath>
 #include <QPen>
 #include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+#include <vector>
 
 namespace graipe {
 
@@ -59,7 +65,11 @@ namespace graipe {
 /**
  * This class encapsulates the drawing of vectors by means of arrows with a triangle
  * as arrow head. The line width and the head size might be set and the painting is
- * carried out on arbitrary origin and target using a QPainter
+ * carried out on arbitrary origin and target using a QPainter.
+ *
+ * Besides the painting of single vectors, many vectors may be collected in a batch,
+ * which groups the arrow geometry by (quantized) color. The batch is kept until it
+ * is invalidated or rebuilt and is painted with two calls per used color.
  */
 class GRAIPE_VECTORFIELDS_EXPORT VectorDrawer
 {
@@ -127,7 +137,60 @@ public:
      */
     void paint(QPainter * painter, const QPointFX& origin, const QPointFX& target, float normalized_weight);
     
+    /**
+     * Removes all vectors from the batch and starts a new one. The region and level
+     * of detail are only stored to decide if the batch may be reused later on.
+     *
+     * \param region the region, for which the batch is built
+     * \param lod the level of detail, for which the batch is built
+     */
+    void beginBatch(const QRectF& region = QRectF(), qreal lod = 0);
+    
+    /**
+     * Adds the arrow geometry of a vector to the batch. The arguments are the same
+     * as for the paint function.
+     *
+     * \param origin the starting position of the vector
+     * \param target the final point of the vector
+     * \param normalized_weight a normalized weight in the range of {0.0, ..., 1.0}
+     */
+    void addToBatch(const QPointFX& origin, const QPointFX& target, float normalized_weight);
+    
+    /**
+     * Paints all vectors of the batch using the current line width and color table.
+     *
+     * \param painter the painter which carries out the drawing
+     */
+    void paintBatch(QPainter * painter) const;
+    
+    /**
+     * Marks the batch as outdated, e.g. if the view parameters or the model have changed.
+     */
+    void invalidateBatch();
+    
+    /**
+     * Checks if the batch is still valid for a given region and level of detail.
+     *
+     * \param region the region, which shall be painted
+     * \param lod the level of detail, which shall be painted
+     * \return true, if the batch has been built for the same region and level of detail
+     *         and has not been invalidated since then.
+     */
+    bool isBatchValid(const QRectF& region = QRectF(), qreal lod = 0) const;
+    
 private:
+    /**
+     * The arrow geometry of all batched vectors of one color.
+     */
+    struct GlyphGroup
+    {
+        /** The lines of the arrows **/
+        QVector<QLineF> lines;
+        /** The heads of the arrows **/
+        QPainterPath heads;
+    };
+    
+
     /**
      * Updates the unrotated variant of the arrow head. This will be neccessary, if
      * the head size is changed.
@@ -148,6 +211,18 @@ private:
     
     /** copy of the used colorTable for painting **/
     QVector<QRgb>  m_colorTable;
+    
+    /** The batched vectors, one group per color index **/
+    std::vector<GlyphGroup> m_groups;
+    
+    /** Is the batch valid? **/
+    bool m_batch_valid;
+    
+    /** The region, for which the batch has been built **/
+    QRectF m_batch_region;
+    
+    /** The level of detail, for which the batch has been built **/
+    qreal m_batch_lod;
 };
 
 /**
@@ -129,5 +129,86 @@ void Vectorfield2D::setTarget(unsigned int index, const PointType& new_t)
 	setDirection(index, new_t - origin(index));
     //SetDirection needs to call updateModel()!
 }
-    
+
+void Vectorfield2D::copyOrigins(std::vector<PointType>& origins) const
+{
+    origins.resize(size());
+
+    for(unsigned int i=0; i<origins.size(); ++i)
+    {
+        origins[i] = origin(i);
+    }
+}
+
+void Vectorfield2D::copyDirections(std::vector<PointType>& directions) const
+{
+    directions.resize(size());
+
+    for(unsigned int i=0; i<directions.size(); ++i)
+    {
+        directions[i] = direction(i);
+    }
+}
+
+void Vectorfield2D::globalDirections(std::vector<PointType>& global_dirs) const
+{
+    std::vector<PointType> origins;
+    copyOrigins(origins);
+
+    global_dirs.resize(origins.size());
+    decomposeMotion(globalMotion(), origins.data(), NULL, origins.size(), global_dirs.data(), NULL);
+}
+
+void Vectorfield2D::localDirections(std::vector<PointType>& local_dirs) const
+{
+    std::vector<PointType> origins, directions;
+    copyOrigins(origins);
+    copyDirections(directions);
+
+    local_dirs.resize(origins.size());
+    decomposeMotion(globalMotion(), origins.data(), directions.data(), origins.size(), NULL, local_dirs.data());
+}
+
+void Vectorfield2D::decomposeMotion(const QTransform& trans,
+                                    const PointType* origins, const PointType* directions, unsigned int count,
+                                    PointType* global_dirs, PointType* local_dirs)
+{
+    if(!trans.isAffine())
+    {
+        for(unsigned int i=0; i<count; ++i)
+        {
+            PointType global_dir = trans.map(origins[i]) - origins[i];
+
+            if(global_dirs)
+                global_dirs[i] = global_dir;
+            if(local_dirs)
+                local_dirs[i] = directions[i] - global_dir;
+        }
+        return;
+    }
+
+    //Affine case: x' = m11*x + m21*y + dx, y' = m12*x + m22*y + dy
+    const qreal a = trans.m11() - 1.0, b = trans.m21(), tx = trans.dx(),
+                c = trans.m12(),       d = trans.m22() - 1.0, ty = trans.dy();
+
+    if(global_dirs)
+    {
+        for(unsigned int i=0; i<count; ++i)
+        {
+            const qreal x = origins[i].x(), y = origins[i].y();
+            global_dirs[i].rx() = a*x + b*y + tx;
+            global_dirs[i].ry() = c*x + d*y + ty;
+        }
+    }
+    if(local_dirs)
+    {
+        for(unsigned int i=0; i<count; ++i)
+        {
+            const qreal x = origins[i].x(), y = origins[i].y();
+            local_dirs[i].rx() = directions[i].x() - (a*x + b*y + tx);
+            local_dirs[i].ry() = directions[i].y() - (c*x + d*y + ty);
+        }
+    }
+}
+
 } //end of namespace graipe
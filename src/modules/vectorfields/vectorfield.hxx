@@ -234,8 +234,62 @@ class GRAIPE_VECTORFIELDS_EXPORT Vectorfield2D
          * \return The direction of the vector at the given index.
          */
         virtual void setTarget(unsigned int index, const PointType& new_t);
-    
+
+        /**
+         * Bulk copy of the origins of all vectors of this vectorfield.
+         * Use this instead of origin(index) inside loops over all vectors,
+         * since the subclasses copy their storage without per-vector calls.
+         *
+         * \param origins Will be resized to size() and filled with the origins.
+         */
+        virtual void copyOrigins(std::vector<PointType>& origins) const;
+
+        /**
+         * Bulk copy of the directions of all vectors of this vectorfield.
+         * Use this instead of direction(index) inside loops over all vectors,
+         * since the subclasses copy their storage without per-vector calls.
+         *
+         * \param directions Will be resized to size() and filled with the directions.
+         */
+        virtual void copyDirections(std::vector<PointType>& directions) const;
+
+        /**
+         * Batch computation of the global directions of all vectors w.r.t. the
+         * transformation matrix given in globalMotion(). The matrix is only
+         * read once for all vectors.
+         *
+         * \param global_dirs Will be resized to size() and filled with the global directions.
+         */
+        virtual void globalDirections(std::vector<PointType>& global_dirs) const;
+
+        /**
+         * Batch computation of the local directions of all vectors w.r.t. the
+         * transformation matrix given in globalMotion(). The matrix is only
+         * read once for all vectors.
+         *
+         * \param local_dirs Will be resized to size() and filled with the local directions.
+         */
+        virtual void localDirections(std::vector<PointType>& local_dirs) const;
+
     protected:
+        /**
+         * Decomposition of a range of vectors into their global and local motion
+         * w.r.t. a given transformation. For affine transformations, the
+         * decomposition is computed by means of plain loops over the coefficients,
+         * which may be vectorized by the compiler.
+         *
+         * \param trans       The global motion transformation.
+         * \param origins     Pointer to the first origin.
+         * \param directions  Pointer to the first direction, may be NULL if local_dirs is NULL.
+         * \param count       The count of vectors.
+         * \param global_dirs Pointer to the first global direction output, may be NULL.
+         * \param local_dirs  Pointer to the first local direction output, may be NULL.
+         */
+        static void decomposeMotion(const QTransform& trans,
+                                    const PointType* origins, const PointType* directions, unsigned int count,
+                                    PointType* global_dirs, PointType* local_dirs);
+
+
         /**
          * @{
          * Additional parameters
@@ -51,10 +51,13 @@
 #include "vectorfields/sparsevectorfield.hxx"
 #include "vectorfields/sparsevectorfieldstatistics.hxx"
 #include "vectorfields/sparsevectorfieldviewcontroller.hxx"
+#include "vectorfields/compactarray.hxx"
 #include "vectorfields/densevectorfield.hxx"
+#include "vectorfields/densevectorfieldsampler.hxx"
 #include "vectorfields/densevectorfieldstatistics.hxx"
 #include "vectorfields/densevectorfieldviewcontroller.hxx"
 #include "vectorfields/densevectorfieldimpex.hxx"
+#include "vectorfields/particleengine.hxx"
 
 /**
  * @}
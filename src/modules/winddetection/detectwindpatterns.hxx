@@ -47,6 +47,7 @@
 #include <vigra/affinegeometry.hxx>
 
 //GRAIPE components needed
+#include "images/pooledarray.hxx"
 #include "vectorfields/vectorfields.h"
 
 namespace graipe {
@@ -93,12 +94,14 @@ class FourierSpectrumWindDetectionFunctor
         void operator()(const vigra::MultiArrayView<2,T> & src, float & angle, float & quality)
         {
             // compute Fourier transform
-            vigra::MultiArray<2, vigra::FFTWComplex<T> > fourier(src.shape());
+            //The buffers are reused for each patch by means of the current BufferPool
+            PooledArray<2, vigra::FFTWComplex<T> > fourier(src.shape());
             
             vigra::fourierTransform(src, fourier);
             vigra::moveDCToCenter(fourier);
             
-            vigra::MultiArray<2, float> temp = vigra::multi_math::norm(fourier);
+            PooledArray<2, float> temp(src.shape());
+            temp = vigra::multi_math::norm(fourier);
             
             if(m_smoothing > 0.5)
             {
@@ -337,7 +340,7 @@ class GradientHistogramWindDetectionFunctor
                          h   = (unsigned int)src.height(),
                         bins = (unsigned int)hist.width();
             
-            vigra::MultiArray<2, vigra::TinyVector<float, 2> > grad(w,h);
+            PooledArray<2, vigra::TinyVector<float, 2> > grad(vigra::Shape2(w,h));
             
             // calculate gradient vector at given scale
             vigra::gaussianGradientMultiArray(src, grad, m_scale);
@@ -400,6 +403,9 @@ SparseWeightedVectorfield2D* estimateWindDirectionFromSARImage(const vigra::Mult
 	//Create resulting vectorfield
 	SparseWeightedVectorfield2D* result_vf = new SparseWeightedVectorfield2D(wsp);
 	
+	//Coalesce all additions into one model update
+	ModelTransaction transaction(result_vf);
+	
 	unsigned int y_step = image_height/y_res,
                  x_step = image_width/x_res;
 	